@@ -58,6 +58,15 @@ namespace detail {
       _list = std::make_shared<ListT>();
     }
 
+    /// Replaces the list with an empty one and returns the previous list.
+    /// Every value pushed is either in the list returned or in the new one.
+    std::shared_ptr<const ListT> Take() {
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto list = Load();
+      _list = std::make_shared<ListT>();
+      return list;
+    }
+
     /// Returns a pointer to the list.
     std::shared_ptr<const ListT> Load() const {
       return _list.load();
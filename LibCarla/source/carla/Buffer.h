@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "carla/BufferAllocator.h"
 #include "carla/Debug.h"
 #include "carla/Exception.h"
 #include "carla/Logging.h"
@@ -34,6 +35,10 @@ namespace carla {
   /// the old one is deleted. This means that by default the buffer can only
   /// grow. To release the memory use `clear` or `pop`.
   ///
+  /// The memory comes from the BufferAllocator, it is not initialized and its
+  /// capacity is rounded up to a size class. Deleted memory goes back to the
+  /// allocator to be reused by any other buffer.
+  ///
   /// This is a move-only type, meant to be cheap to pass by value. If the
   /// buffer is retrieved from a BufferPool, the memory is automatically pushed
   /// back to the pool on destruction.
@@ -67,11 +72,11 @@ namespace carla {
     /// Create an empty buffer.
     Buffer() = default;
 
-    /// Create a buffer with @a size bytes allocated.
+    /// Create a buffer with @a size bytes allocated, not initialized.
     explicit Buffer(size_type size)
       : _size(size),
-        _capacity(size),
-        _data(std::make_unique<value_type[]>(size)) {}
+        _capacity(static_cast<size_type>(BufferAllocator::GetCapacity(size))),
+        _data(BufferAllocator::Allocate(size)) {}
 
     /// @copydoc Buffer(size_type)
     explicit Buffer(uint64_t size)
@@ -247,13 +252,15 @@ namespace carla {
   public:
 
     /// Reset the size of this buffer. If the capacity is not enough, the
-    /// current memory is discarded and a new block of size @a size is
-    /// allocated.
+    /// current memory is discarded and a new block of at least @a size bytes
+    /// is allocated, not initialized.
     void reset(size_type size) {
       if (_capacity < size) {
-        log_debug("allocating buffer of", size, "bytes");
-        _data = std::make_unique<value_type[]>(size);
-        _capacity = size;
+        // Release the current memory first, so that the buffer is left empty
+        // if the allocation throws.
+        clear();
+        _data = BufferAllocator::Allocate(size);
+        _capacity = static_cast<size_type>(BufferAllocator::GetCapacity(size));
       }
       _size = size;
     }
@@ -270,17 +277,17 @@ namespace carla {
     /// allocated if the capacity is not enough and the data is copied.
     void resize(uint64_t size) {
       if(_capacity < size) {
-        std::unique_ptr<value_type[]> data = std::move(_data);
-        uint64_t old_size = size;
+        const size_type old_size = _size;
+        BufferAllocator::unique_ptr data = pop();
         reset(size);
-        copy_from(data.get(), static_cast<size_type>(old_size));
+        copy_from(data.get(), old_size);
       }
       _size = static_cast<size_type>(size);
     }
 
     /// Release the contents of this buffer and set its size and capacity to
     /// zero.
-    std::unique_ptr<value_type[]> pop() noexcept {
+    BufferAllocator::unique_ptr pop() noexcept {
       _size = 0u;
       _capacity = 0u;
       return std::move(_data);
@@ -369,7 +376,7 @@ namespace carla {
 
     size_type _capacity = 0u;
 
-    std::unique_ptr<value_type[]> _data = nullptr;
+    BufferAllocator::unique_ptr _data = nullptr;
   };
 
 } // namespace carla
@@ -0,0 +1,195 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/BufferAllocator.h"
+
+#include "carla/Exception.h"
+#include "carla/Logging.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#if defined(__linux__)
+#  include <sys/mman.h>
+#endif
+
+namespace carla {
+
+  // 64 bytes, smaller requests share the smallest class.
+  static constexpr size_t MIN_SIZE_CLASS = 6u;
+
+  // 2 GiB, bigger blocks are allocated with their exact size and not kept.
+  static constexpr size_t MAX_SIZE_CLASS = 31u;
+
+  static constexpr size_t HUGE_PAGE_SIZE = 2u << 20u;
+
+  struct SizeClass {
+    std::mutex mutex;
+    std::vector<BufferAllocator::value_type *> blocks;
+  };
+
+  struct AllocatorState {
+    SizeClass classes[MAX_SIZE_CLASS + 1u];
+    std::atomic<uint64_t> hits{0u};
+    std::atomic<uint64_t> misses{0u};
+    std::atomic<uint64_t> evictions{0u};
+    std::atomic<uint64_t> bytes_held{0u};
+    std::atomic<uint64_t> blocks_held{0u};
+    std::atomic<uint64_t> bytes_allocated{0u};
+    std::atomic<size_t> max_bytes_held{BufferAllocator::DEFAULT_MAX_BYTES_HELD};
+    std::atomic<size_t> huge_page_threshold{0u};
+  };
+
+  // Never destroyed, buffers held by static objects are freed after any
+  // static object of this file would be.
+  static AllocatorState &GetState() {
+    static AllocatorState *state = new AllocatorState;
+    return *state;
+  }
+
+  static size_t GetSizeClass(size_t size) {
+    size_t index = MIN_SIZE_CLASS;
+    while ((index <= MAX_SIZE_CLASS) && ((size_t(1u) << index) < size)) {
+      ++index;
+    }
+    return index;
+  }
+
+  static BufferAllocator::value_type *SystemAllocate(size_t capacity, size_t huge_page_threshold) {
+    void *data = nullptr;
+#if defined(__linux__)
+    if ((huge_page_threshold > 0u) && (capacity >= huge_page_threshold) &&
+        (posix_memalign(&data, HUGE_PAGE_SIZE, capacity) == 0)) {
+      // Only a hint, the kernel may not have transparent huge pages enabled.
+      madvise(data, capacity, MADV_HUGEPAGE);
+      return static_cast<BufferAllocator::value_type *>(data);
+    }
+#else
+    (void) huge_page_threshold;
+#endif // __linux__
+    data = std::malloc(capacity);
+    if (data == nullptr) {
+      throw_exception(std::bad_alloc());
+    }
+    return static_cast<BufferAllocator::value_type *>(data);
+  }
+
+  size_t BufferAllocator::GetCapacity(size_t size) {
+    if (size == 0u) {
+      return 0u;
+    }
+    const size_t index = GetSizeClass(size);
+    return index <= MAX_SIZE_CLASS ? (size_t(1u) << index) : size;
+  }
+
+  BufferAllocator::unique_ptr BufferAllocator::Allocate(size_t size) {
+    if (size == 0u) {
+      return unique_ptr();
+    }
+    auto &state = GetState();
+    const size_t capacity = GetCapacity(size);
+    const size_t index = GetSizeClass(size);
+    if (index <= MAX_SIZE_CLASS) {
+      auto &size_class = state.classes[index];
+      value_type *data = nullptr;
+      {
+        std::lock_guard<std::mutex> lock(size_class.mutex);
+        if (!size_class.blocks.empty()) {
+          data = size_class.blocks.back();
+          size_class.blocks.pop_back();
+        }
+      }
+      if (data != nullptr) {
+        state.bytes_held -= capacity;
+        --state.blocks_held;
+        ++state.hits;
+        return unique_ptr(data, Deleter(capacity));
+      }
+    }
+    log_debug("allocating buffer of", capacity, "bytes");
+    auto *data = SystemAllocate(capacity, state.huge_page_threshold);
+    ++state.misses;
+    state.bytes_allocated += capacity;
+    return unique_ptr(data, Deleter(capacity));
+  }
+
+  void BufferAllocator::Deallocate(value_type *data, size_t capacity) {
+    if (data == nullptr) {
+      return;
+    }
+    auto &state = GetState();
+    const size_t index = GetSizeClass(capacity);
+    if ((index <= MAX_SIZE_CLASS) && ((size_t(1u) << index) == capacity)) {
+      if (state.bytes_held.fetch_add(capacity) + capacity <= state.max_bytes_held) {
+        auto &size_class = state.classes[index];
+        std::lock_guard<std::mutex> lock(size_class.mutex);
+        size_class.blocks.push_back(data);
+        ++state.blocks_held;
+        return;
+      }
+      state.bytes_held -= capacity;
+      ++state.evictions;
+    }
+    std::free(data);
+    state.bytes_allocated -= capacity;
+  }
+
+  BufferAllocator::Stats BufferAllocator::GetStats() {
+    auto &state = GetState();
+    Stats stats;
+    stats.hits = state.hits;
+    stats.misses = state.misses;
+    stats.evictions = state.evictions;
+    stats.bytes_held = state.bytes_held;
+    stats.blocks_held = state.blocks_held;
+    stats.bytes_allocated = state.bytes_allocated;
+    return stats;
+  }
+
+  void BufferAllocator::SetMaxBytesHeld(size_t max_bytes) {
+    GetState().max_bytes_held = max_bytes;
+    Trim(max_bytes);
+  }
+
+  size_t BufferAllocator::GetMaxBytesHeld() {
+    return GetState().max_bytes_held;
+  }
+
+  void BufferAllocator::Trim(size_t max_bytes) {
+    auto &state = GetState();
+    for (size_t index = MAX_SIZE_CLASS; index >= MIN_SIZE_CLASS; --index) {
+      const size_t capacity = size_t(1u) << index;
+      auto &size_class = state.classes[index];
+      while (state.bytes_held > max_bytes) {
+        value_type *data = nullptr;
+        {
+          std::lock_guard<std::mutex> lock(size_class.mutex);
+          if (size_class.blocks.empty()) {
+            break;
+          }
+          data = size_class.blocks.back();
+          size_class.blocks.pop_back();
+        }
+        state.bytes_held -= capacity;
+        --state.blocks_held;
+        std::free(data);
+        state.bytes_allocated -= capacity;
+      }
+    }
+  }
+
+  void BufferAllocator::SetHugePageThreshold(size_t threshold) {
+    GetState().huge_page_threshold = threshold;
+  }
+
+  size_t BufferAllocator::GetHugePageThreshold() {
+    return GetState().huge_page_threshold;
+  }
+
+} // namespace carla
@@ -0,0 +1,97 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace carla {
+
+  /// Allocates the memory of every Buffer of the process.
+  ///
+  /// The memory is not initialized, buffers are overwritten right after being
+  /// allocated. Requests are rounded up to power-of-two size classes and the
+  /// blocks freed are kept in a free list per class, so a buffer of the same
+  /// size reuses them. The free lists are shared by all the buffers of the
+  /// process and bounded by GetMaxBytesHeld(), blocks that do not fit are
+  /// returned to the system.
+  ///
+  /// Optionally, blocks from GetHugePageThreshold() bytes on are aligned to
+  /// transparent huge pages (Linux only), which saves TLB misses when copying
+  /// multi-megabyte frames.
+  class BufferAllocator {
+  public:
+
+    using value_type = unsigned char;
+
+    static constexpr size_t DEFAULT_MAX_BYTES_HELD = 256u << 20u;
+
+    /// Returns a block to the allocator, it travels with the block.
+    class Deleter {
+    public:
+
+      Deleter() = default;
+
+      explicit Deleter(size_t capacity) : _capacity(capacity) {}
+
+      void operator()(value_type *data) const {
+        Deallocate(data, _capacity);
+      }
+
+    private:
+
+      size_t _capacity = 0u;
+    };
+
+    using unique_ptr = std::unique_ptr<value_type[], Deleter>;
+
+    struct Stats {
+      /// Allocations served from a free list.
+      uint64_t hits = 0u;
+      /// Allocations served by the system.
+      uint64_t misses = 0u;
+      /// Blocks released to the system because the free lists were full.
+      uint64_t evictions = 0u;
+      /// Bytes in the free lists.
+      uint64_t bytes_held = 0u;
+      /// Blocks in the free lists.
+      uint64_t blocks_held = 0u;
+      /// Bytes allocated and not yet freed, including the ones held.
+      uint64_t bytes_allocated = 0u;
+    };
+
+    /// Capacity of the block allocated for @a size bytes.
+    static size_t GetCapacity(size_t size);
+
+    /// Allocate a block of at least @a size bytes, its capacity is
+    /// GetCapacity(size).
+    static unique_ptr Allocate(size_t size);
+
+    static Stats GetStats();
+
+    /// Bound the bytes kept in the free lists, trimming them if needed.
+    static void SetMaxBytesHeld(size_t max_bytes);
+
+    static size_t GetMaxBytesHeld();
+
+    /// Release blocks to the system, largest first, until at most
+    /// @a max_bytes are held.
+    static void Trim(size_t max_bytes = 0u);
+
+    /// Blocks of at least @a threshold bytes are backed by huge pages, zero
+    /// disables it (default).
+    static void SetHugePageThreshold(size_t threshold);
+
+    static size_t GetHugePageThreshold();
+
+  private:
+
+    static void Deallocate(value_type *data, size_t capacity);
+  };
+
+} // namespace carla
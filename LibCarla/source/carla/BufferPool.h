@@ -24,15 +24,21 @@ namespace carla {
   /// A pool of Buffer. Buffers popped from this pool automatically return to
   /// the pool on destruction so the allocated memory can be reused.
   ///
+  /// The pool keeps at most @a max_size buffers, the memory of the rest goes
+  /// back to the BufferAllocator, that is shared by the whole process.
+  ///
   /// @warning Buffers adjust their size only by growing, they never shrink
-  /// unless explicitly cleared. The allocated memory is only deleted when this
-  /// pool is destroyed.
+  /// unless explicitly cleared.
   class BufferPool : public std::enable_shared_from_this<BufferPool> {
   public:
 
+    static constexpr size_t DEFAULT_MAX_SIZE = 16u;
+
     BufferPool() = default;
 
-    explicit BufferPool(size_t estimated_size) : _queue(estimated_size) {}
+    explicit BufferPool(size_t estimated_size, size_t max_size = DEFAULT_MAX_SIZE)
+      : _queue(estimated_size),
+        _max_size(max_size) {}
 
     /// Pop a Buffer from the queue, creates a new one if the queue is empty.
     Buffer Pop() {
@@ -51,10 +57,15 @@ namespace carla {
     friend class Buffer;
 
     void Push(Buffer &&buffer) {
-      _queue.enqueue(std::move(buffer));
+      // Approximate, the bound may be exceeded by concurrent pushes.
+      if (_queue.size_approx() < _max_size) {
+        _queue.enqueue(std::move(buffer));
+      }
     }
 
     moodycamel::ConcurrentQueue<Buffer> _queue;
+
+    const size_t _max_size = DEFAULT_MAX_SIZE;
   };
 
 } // namespace carla
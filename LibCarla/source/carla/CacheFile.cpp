@@ -0,0 +1,193 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/CacheFile.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <utility>
+
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+namespace carla {
+
+  /// Written as is, a cache from a platform with another byte order does not
+  /// match.
+  static constexpr uint32_t CACHE_BYTE_ORDER = 0x01020304u;
+
+  struct CacheFileHeader {
+    char magic[8u];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t hash;
+  };
+
+  static_assert(sizeof(CacheFileHeader) == CacheFile::HEADER_SIZE, "Unexpected padding in cache header");
+  static_assert(CacheFile::HEADER_SIZE % 8u == 0u, "Cache content is not aligned after the header");
+
+  // Map the whole file, or return nullptr if it cannot be opened or is empty.
+  static void *MapFile(const std::string &path, size_t &size) {
+#ifdef _WIN32
+    HANDLE file = ::CreateFileA(
+        path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_DELETE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+      return nullptr;
+    }
+    LARGE_INTEGER file_size;
+    void *address = nullptr;
+    if (::GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+      HANDLE mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0u, 0u, nullptr);
+      if (mapping != nullptr) {
+        // The view keeps the mapping alive once the handles are closed.
+        address = ::MapViewOfFile(mapping, FILE_MAP_READ, 0u, 0u, 0u);
+        ::CloseHandle(mapping);
+      }
+      size = static_cast<size_t>(file_size.QuadPart);
+    }
+    ::CloseHandle(file);
+    return address;
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return nullptr;
+    }
+    struct stat file_stat;
+    void *address = nullptr;
+    if (::fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+      size = static_cast<size_t>(file_stat.st_size);
+      address = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+      if (address == MAP_FAILED) {
+        address = nullptr;
+      }
+    }
+    // The mapping keeps the file alive once the descriptor is closed.
+    ::close(fd);
+    return address;
+#endif
+  }
+
+  static void UnmapFile(void *address, size_t size) {
+#ifdef _WIN32
+    (void) size;
+    ::UnmapViewOfFile(address);
+#else
+    ::munmap(address, size);
+#endif
+  }
+
+  bool CacheFile::Write(
+      const std::string &path,
+      const Magic &magic,
+      const uint32_t version,
+      const uint64_t hash,
+      const std::function<void(std::ostream &)> &write_content) {
+    CacheFileHeader header;
+    std::memcpy(header.magic, magic, sizeof(header.magic));
+    header.version = version;
+    header.byte_order = CACHE_BYTE_ORDER;
+    header.hash = hash;
+
+    // Write aside and rename, other processes may be mapping the cache.
+    const std::string temp_path = path + "." + std::to_string(std::random_device{}()) + ".tmp";
+    {
+      std::ofstream out(temp_path, std::ios::trunc | std::ios::binary);
+      out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+      write_content(out);
+      out.close();
+      if (!out.good()) {
+        std::remove(temp_path.c_str());
+        return false;
+      }
+    }
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+      // Renaming does not replace an existing file on Windows.
+      std::remove(path.c_str());
+      if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        std::remove(temp_path.c_str());
+        return false;
+      }
+    }
+    return true;
+  }
+
+  CacheFile::CacheFile(CacheFile &&rhs) noexcept
+    : _address(rhs._address),
+      _size(rhs._size) {
+    rhs._address = nullptr;
+    rhs._size = 0u;
+  }
+
+  CacheFile &CacheFile::operator=(CacheFile &&rhs) noexcept {
+    if (this != &rhs) {
+      Close();
+      std::swap(_address, rhs._address);
+      std::swap(_size, rhs._size);
+    }
+    return *this;
+  }
+
+  CacheFile::~CacheFile() {
+    Close();
+  }
+
+  bool CacheFile::Open(
+      const std::string &path,
+      const Magic &magic,
+      const uint32_t version,
+      const uint64_t hash) {
+    Close();
+    size_t size = 0u;
+    void *address = MapFile(path, size);
+    if (address == nullptr) {
+      return false;
+    }
+    CacheFileHeader header;
+    if (size >= sizeof(header)) {
+      std::memcpy(&header, address, sizeof(header));
+    }
+    if (size < sizeof(header) ||
+        std::memcmp(header.magic, magic, sizeof(header.magic)) != 0 ||
+        header.version != version ||
+        header.byte_order != CACHE_BYTE_ORDER ||
+        header.hash != hash) {
+      UnmapFile(address, size);
+      return false;
+    }
+    _address = address;
+    _size = size;
+    return true;
+  }
+
+  void CacheFile::Close() {
+    if (_address != nullptr) {
+      UnmapFile(_address, _size);
+      _address = nullptr;
+      _size = 0u;
+    }
+  }
+
+} // namespace carla
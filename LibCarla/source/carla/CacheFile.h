@@ -0,0 +1,89 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+
+namespace carla {
+
+  /// Read-only memory mapping of a binary cache file.
+  ///
+  /// A cache file starts with a fixed header identifying its format (magic and
+  /// version), the byte order of the platform that wrote it and the hash of
+  /// the content it was computed from. The header is followed by the cached
+  /// data, which is used in place from the mapping.
+  ///
+  /// Errors are reported by return value, never by exceptions, so it can be
+  /// used in the libraries built without exception support.
+  class CacheFile : private MovableNonCopyable {
+  public:
+
+    using Magic = char[8u];
+
+    /// Size of the header, the content of a cache starts at this offset in
+    /// the file, aligned to 8 bytes.
+    static constexpr size_t HEADER_SIZE = 24u;
+
+    /// Write to @a path the header of a cache of format @a magic and
+    /// @a version, computed from content with @a hash, followed by what
+    /// @a write_content writes to the stream.
+    ///
+    /// The file is written aside and renamed, so other processes never map a
+    /// half written cache. Return false if the file could not be written.
+    static bool Write(
+        const std::string &path,
+        const Magic &magic,
+        uint32_t version,
+        uint64_t hash,
+        const std::function<void(std::ostream &)> &write_content);
+
+    CacheFile() = default;
+
+    CacheFile(CacheFile &&rhs) noexcept;
+
+    CacheFile &operator=(CacheFile &&rhs) noexcept;
+
+    ~CacheFile();
+
+    /// Map in memory the cache file at @a path. Return false, leaving the
+    /// file closed, if it does not exist or its header does not match
+    /// @a magic, @a version, the byte order of this platform and @a hash.
+    bool Open(
+        const std::string &path,
+        const Magic &magic,
+        uint32_t version,
+        uint64_t hash);
+
+    void Close();
+
+    bool IsOpen() const {
+      return _address != nullptr;
+    }
+
+    /// Cached data following the header.
+    const char *GetContent() const {
+      return static_cast<const char *>(_address) + HEADER_SIZE;
+    }
+
+    size_t GetContentSize() const {
+      return _size - HEADER_SIZE;
+    }
+
+  private:
+
+    void *_address = nullptr;
+
+    size_t _size = 0u;
+  };
+
+} // namespace carla
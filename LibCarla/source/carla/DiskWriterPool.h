@@ -0,0 +1,131 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Logging.h"
+#include "carla/NonCopyable.h"
+#include "carla/ThreadGroup.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+
+namespace carla {
+
+  /// Pool of threads that encode and write data to disk in the background, so
+  /// that the thread producing the data never waits for them.
+  ///
+  /// The number of pending writes, queued or running, is bounded to limit the
+  /// memory they hold. A write posted while the pool is full is dropped and
+  /// counted instead of blocking the caller.
+  class DiskWriterPool : private NonCopyable {
+  public:
+
+    using Write = std::function<void()>;
+
+    DiskWriterPool(size_t worker_threads, size_t max_pending_writes)
+      : _max_pending_writes(std::max<size_t>(max_pending_writes, 1u)) {
+      _workers.CreateThreads(std::max<size_t>(worker_threads, 1u), [this]() { Run(); });
+    }
+
+    /// Finishes the pending writes and joins all the threads.
+    ~DiskWriterPool() {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+      }
+      _pending_condition.notify_all();
+      _workers.JoinAll();
+    }
+
+    /// Queue @a write to run in one of the threads. Return false if it was
+    /// dropped because the pool is full.
+    bool Post(Write write) {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_queue.size() + _running >= _max_pending_writes) {
+          ++_dropped_writes;
+          return false;
+        }
+        _queue.emplace_back(std::move(write));
+      }
+      _pending_condition.notify_one();
+      return true;
+    }
+
+    /// Block until every write posted so far is done.
+    void Flush() {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _done_condition.wait(lock, [this]() { return _queue.empty() && (_running == 0u); });
+    }
+
+    size_t GetPendingWrites() const {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _queue.size() + _running;
+    }
+
+    /// Number of writes dropped because the pool was full.
+    size_t GetDroppedWrites() const {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _dropped_writes;
+    }
+
+  private:
+
+    void Run() {
+      std::unique_lock<std::mutex> lock(_mutex);
+      while (true) {
+        _pending_condition.wait(lock, [this]() { return _stop || !_queue.empty(); });
+        if (_queue.empty()) {
+          return;
+        }
+        Write write = std::move(_queue.front());
+        _queue.pop_front();
+        ++_running;
+        lock.unlock();
+#ifndef LIBCARLA_NO_EXCEPTIONS
+        try {
+          write();
+        } catch (const std::exception &e) {
+          log_error("disk writer: failed to write:", e.what());
+        }
+#else
+        write();
+#endif // LIBCARLA_NO_EXCEPTIONS
+        // Release what the write holds before reporting it done.
+        write = nullptr;
+        lock.lock();
+        --_running;
+        if (_queue.empty() && (_running == 0u)) {
+          _done_condition.notify_all();
+        }
+      }
+    }
+
+    const size_t _max_pending_writes;
+
+    mutable std::mutex _mutex;
+
+    std::condition_variable _pending_condition;
+
+    std::condition_variable _done_condition;
+
+    std::deque<Write> _queue;
+
+    size_t _running = 0u;
+
+    size_t _dropped_writes = 0u;
+
+    bool _stop = false;
+
+    ThreadGroup _workers;
+  };
+
+} // namespace carla
@@ -0,0 +1,36 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace carla {
+
+  /// Incremental 64-bit FNV-1a hash. It is not cryptographic, it is meant to
+  /// detect content that changed.
+  class Fnv1aHash {
+  public:
+
+    void Update(const void *data, size_t size) {
+      const auto *bytes = static_cast<const uint8_t *>(data);
+      for (size_t i = 0u; i < size; ++i) {
+        _hash ^= bytes[i];
+        _hash *= 1099511628211ull;
+      }
+    }
+
+    uint64_t Get() const {
+      return _hash;
+    }
+
+  private:
+
+    uint64_t _hash = 14695981039346656037ull;
+  };
+
+} // namespace carla
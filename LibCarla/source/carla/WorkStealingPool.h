@@ -0,0 +1,240 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/ThreadGroup.h"
+#include "carla/profiler/Tracer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace carla {
+
+  /// A fork-join thread pool for data-parallel loops. The index range given
+  /// to ParallelFor is split into chunks that are distributed among per-thread
+  /// queues; a thread that runs out of chunks steals from the others. The
+  /// thread calling ParallelFor takes part in the work and the call returns
+  /// once every index has been processed, so consecutive calls are separated
+  /// by a barrier.
+  ///
+  /// Calls to ParallelFor are serialized. A ParallelFor issued from inside a
+  /// running job is executed sequentially in the calling thread.
+  class WorkStealingPool : private NonCopyable {
+  public:
+
+    /// Launch @a worker_threads threads. With zero worker threads every loop
+    /// runs sequentially in the calling thread.
+    explicit WorkStealingPool(size_t worker_threads) {
+      // One queue per worker plus one for the thread calling ParallelFor.
+      _queues.reserve(worker_threads + 1u);
+      for (size_t i = 0u; i < worker_threads + 1u; ++i) {
+        _queues.emplace_back(std::make_unique<Queue>());
+      }
+      for (size_t i = 0u; i < worker_threads; ++i) {
+        _workers.CreateThread([this, i]() { WorkerLoop(i); });
+      }
+    }
+
+    /// Stops the pool and joins all its threads.
+    ~WorkStealingPool() {
+      Stop();
+    }
+
+    /// Number of threads taking part in a loop, including the caller.
+    size_t size() const {
+      return _queues.size();
+    }
+
+    /// Call @a functor(i) for every i in [begin, end) and block until all the
+    /// calls have returned. Indices are processed in chunks of @a grain_size
+    /// consecutive elements.
+    ///
+    /// If @a functor throws, the remaining chunks are still processed and the
+    /// first exception is rethrown in the calling thread.
+    template <typename F>
+    void ParallelFor(size_t begin, size_t end, size_t grain_size, F &&functor) {
+      if (end <= begin) {
+        return;
+      }
+      grain_size = std::max<size_t>(grain_size, 1u);
+      if (_queues.size() == 1u || (end - begin) <= grain_size || IsInsideJob()) {
+        for (size_t i = begin; i < end; ++i) {
+          functor(i);
+        }
+        return;
+      }
+
+      std::lock_guard<std::mutex> submit_lock(_submit_mutex);
+      _job = [&functor](size_t chunk_begin, size_t chunk_end) {
+        for (size_t i = chunk_begin; i < chunk_end; ++i) {
+          functor(i);
+        }
+      };
+
+      // Each queue receives a contiguous block of chunks so that, unless work
+      // is stolen, a thread walks through neighbouring indices.
+      const size_t number_of_chunks = (end - begin + grain_size - 1u) / grain_size;
+      const size_t number_of_queues = _queues.size();
+      _pending_chunks = number_of_chunks;
+      for (size_t q = 0u; q < number_of_queues; ++q) {
+        const size_t first_chunk = (q * number_of_chunks) / number_of_queues;
+        const size_t last_chunk = ((q + 1u) * number_of_chunks) / number_of_queues;
+        std::lock_guard<std::mutex> queue_lock(_queues[q]->mutex);
+        for (size_t c = first_chunk; c < last_chunk; ++c) {
+          const size_t chunk_begin = begin + c * grain_size;
+          _queues[q]->chunks.push_back({chunk_begin, std::min(chunk_begin + grain_size, end)});
+        }
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_generation;
+      }
+      _job_condition.notify_all();
+
+      RunChunks(number_of_queues - 1u);
+
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _done_condition.wait(lock, [this]() { return _pending_chunks == 0u; });
+      }
+      _job = nullptr;
+
+#ifndef LIBCARLA_NO_EXCEPTIONS
+      std::exception_ptr exception;
+      std::swap(exception, _exception);
+      if (exception) {
+        std::rethrow_exception(exception);
+      }
+#endif // LIBCARLA_NO_EXCEPTIONS
+    }
+
+    /// Stop the pool and join all its threads. Loops submitted afterwards run
+    /// sequentially.
+    void Stop() {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+      }
+      _job_condition.notify_all();
+      _workers.JoinAll();
+      _queues.resize(1u);
+    }
+
+  private:
+
+    struct Chunk {
+      size_t begin;
+      size_t end;
+    };
+
+    struct Queue {
+      std::mutex mutex;
+      std::deque<Chunk> chunks;
+    };
+
+    static bool &IsInsideJob() {
+      static thread_local bool inside_job = false;
+      return inside_job;
+    }
+
+    /// Take a chunk from the front of our own queue, or steal one from the
+    /// back of another thread's queue.
+    bool TakeChunk(size_t slot, Chunk &chunk) {
+      const size_t number_of_queues = _queues.size();
+      for (size_t i = 0u; i < number_of_queues; ++i) {
+        Queue &queue = *_queues[(slot + i) % number_of_queues];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.chunks.empty()) {
+          if (i == 0u) {
+            chunk = queue.chunks.front();
+            queue.chunks.pop_front();
+          } else {
+            chunk = queue.chunks.back();
+            queue.chunks.pop_back();
+          }
+          return true;
+        }
+      }
+      return false;
+    }
+
+    void RunChunks(size_t slot) {
+      IsInsideJob() = true;
+      Chunk chunk;
+      while (TakeChunk(slot, chunk)) {
+        CARLA_TRACE_SCOPE("work_stealing_pool", "Chunk");
+#ifndef LIBCARLA_NO_EXCEPTIONS
+        try {
+          _job(chunk.begin, chunk.end);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(_mutex);
+          if (!_exception) {
+            _exception = std::current_exception();
+          }
+        }
+#else
+        _job(chunk.begin, chunk.end);
+#endif // LIBCARLA_NO_EXCEPTIONS
+        if (_pending_chunks.fetch_sub(1u) == 1u) {
+          std::lock_guard<std::mutex> lock(_mutex);
+          _done_condition.notify_all();
+        }
+      }
+      IsInsideJob() = false;
+    }
+
+    void WorkerLoop(size_t slot) {
+      uint64_t last_generation = 0u;
+      for (;;) {
+        {
+          std::unique_lock<std::mutex> lock(_mutex);
+          _job_condition.wait(lock, [&]() { return _stop || _generation != last_generation; });
+          if (_stop) {
+            return;
+          }
+          last_generation = _generation;
+        }
+        RunChunks(slot);
+      }
+    }
+
+    std::vector<std::unique_ptr<Queue>> _queues;
+
+    std::function<void(size_t, size_t)> _job;
+
+    std::atomic<size_t> _pending_chunks{0u};
+
+    std::mutex _submit_mutex;
+
+    std::mutex _mutex;
+
+    std::condition_variable _job_condition;
+
+    std::condition_variable _done_condition;
+
+    uint64_t _generation = 0u;
+
+    bool _stop = false;
+
+#ifndef LIBCARLA_NO_EXCEPTIONS
+    std::exception_ptr _exception;
+#endif // LIBCARLA_NO_EXCEPTIONS
+
+    ThreadGroup _workers;
+  };
+
+} // namespace carla
@@ -41,6 +41,13 @@ namespace client {
       return _simulator->GetNetworkingTimeout();
     }
 
+    /// Whether to receive the data of all the sensors through a single
+    /// connection instead of a connection per sensor. Applies to sensors
+    /// listened to afterwards.
+    void SetStreamingMultiplexing(bool enabled) {
+      _simulator->SetStreamingMultiplexing(enabled);
+    }
+
     /// Return the version string of this client API.
     std::string GetClientVersion() const {
       return _simulator->GetClientVersion();
@@ -5,8 +5,11 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #include "FileTransfer.h"
+#include "carla/Fnv1aHash.h"
 #include "carla/Version.h"
 
+#include <cstdio>
+
 namespace carla {
 namespace client {
 
@@ -22,7 +25,9 @@ namespace client {
     // Check that the path ends in a slash, add it otherwise
     if (path[path.size() - 1] != '/' && path[path.size() - 1] != '\\') {
       _filesBaseFolder = path + "/";
-  }
+    } else {
+      _filesBaseFolder = path;
+    }
 
     return true;
   }
@@ -34,21 +39,22 @@ namespace client {
   bool FileTransfer::FileExists(std::string file) {
     // Check if the file exists or not
     struct stat buffer;
+    std::string fullpath = GetFullPath(file);
+
+    return (stat(fullpath.c_str(), &buffer) == 0);
+  }
+
+  std::string FileTransfer::GetFullPath(const std::string &file) {
     std::string fullpath = _filesBaseFolder;
     fullpath += "/";
     fullpath += ::carla::version();
     fullpath += "/";
     fullpath += file;
-
-    return (stat(fullpath.c_str(), &buffer) == 0);
+    return fullpath;
   }
 
   bool FileTransfer::WriteFile(std::string path, std::vector<uint8_t> content) {
-    std::string writePath = _filesBaseFolder;
-    writePath += "/";
-    writePath += ::carla::version();
-    writePath += "/";
-    writePath += path;
+    std::string writePath = GetFullPath(path);
 
     // Validate and create the file path
     carla::FileSystem::ValidateFilePath(writePath);
@@ -67,16 +73,72 @@ namespace client {
   }
 
   std::vector<uint8_t> FileTransfer::ReadFile(std::string path) {
-    std::string fullpath = _filesBaseFolder;
-    fullpath += "/";
-    fullpath += ::carla::version();
-    fullpath += "/";
-    fullpath += path;
+    std::string fullpath = GetFullPath(path);
     // Read the binary file from the base folder
     std::ifstream file(fullpath, std::ios::binary);
     std::vector<uint8_t> content(std::istreambuf_iterator<char>(file), {});
     return content;
   }
 
+  /// Hash the content of the file at @a fullpath, return false if it cannot
+  /// be read.
+  static bool HashFile(const std::string &fullpath, rpc::FileInfo &info) {
+    std::ifstream file(fullpath, std::ios::binary);
+    if (!file.good()) return false;
+    std::vector<char> buffer(1u << 20u);
+    Fnv1aHash hash;
+    info.size = 0u;
+    while (file) {
+      file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+      const auto count = static_cast<size_t>(file.gcount());
+      hash.Update(buffer.data(), count);
+      info.size += count;
+    }
+    info.hash = hash.Get();
+    return file.eof();
+  }
+
+  static uint64_t GetSize(const std::string &fullpath) {
+    struct stat buffer;
+    return stat(fullpath.c_str(), &buffer) == 0 ? static_cast<uint64_t>(buffer.st_size) : 0u;
+  }
+
+  bool FileTransfer::IsFileValid(const std::string &file, const rpc::FileInfo &info) {
+    const std::string fullpath = GetFullPath(file);
+    // Check the size first to avoid reading files that obviously changed.
+    if (!FileExists(file) || GetSize(fullpath) != info.size) return false;
+    rpc::FileInfo local;
+    return HashFile(fullpath, local) && (local.size == info.size) && (local.hash == info.hash);
+  }
+
+  std::string FileTransfer::GetPartialPath(const std::string &file, const rpc::FileInfo &info) {
+    char hash[17u];
+    std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(info.hash));
+    return GetFullPath(file) + "." + hash + ".part";
+  }
+
+  uint64_t FileTransfer::GetPartialSize(const std::string &file, const rpc::FileInfo &info) {
+    const std::string partial = GetPartialPath(file, info);
+    const uint64_t size = GetSize(partial);
+    if (size > info.size) {
+      std::remove(partial.c_str());
+      return 0u;
+    }
+    return size;
+  }
+
+  bool FileTransfer::CommitPartial(const std::string &file, const rpc::FileInfo &info) {
+    const std::string partial = GetPartialPath(file, info);
+    rpc::FileInfo local;
+    if (!HashFile(partial, local) || (local.size != info.size) || (local.hash != info.hash)) {
+      std::remove(partial.c_str());
+      return false;
+    }
+    const std::string fullpath = GetFullPath(file);
+    // Windows does not rename over an existing file.
+    std::remove(fullpath.c_str());
+    return std::rename(partial.c_str(), fullpath.c_str()) == 0;
+  }
+
 } // namespace client
 } // namespace carla
@@ -7,12 +7,14 @@
 #pragma once
 
 #include "carla/FileSystem.h"
+#include "carla/rpc/FileInfo.h"
 
 #include <fstream>
 #include <iostream>
 #include <string>
 #include <sys/stat.h>
 #include <cstdint>
+#include <vector>
 
 namespace carla {
 namespace client {
@@ -29,10 +31,28 @@ namespace client {
 
     static bool FileExists(std::string file);
 
+    /// Full path of @a file in the cache folder of this version.
+    static std::string GetFullPath(const std::string &file);
+
     static bool WriteFile(std::string path, std::vector<uint8_t> content);
 
     static std::vector<uint8_t> ReadFile(std::string path);
 
+    /// Whether @a file is in the cache with the size and content hash of
+    /// @a info.
+    static bool IsFileValid(const std::string &file, const rpc::FileInfo &info);
+
+    /// Full path where @a file is downloaded until complete. It is named after
+    /// the content hash, so a download of other content is never resumed.
+    static std::string GetPartialPath(const std::string &file, const rpc::FileInfo &info);
+
+    /// Bytes of @a file already downloaded, from which the download resumes.
+    static uint64_t GetPartialSize(const std::string &file, const rpc::FileInfo &info);
+
+    /// Move the complete download of @a file to the cache if its content
+    /// matches @a info. Otherwise discard it and return false.
+    static bool CommitPartial(const std::string &file, const rpc::FileInfo &info);
+
   private:
 
     static std::string _filesBaseFolder;
@@ -6,6 +6,8 @@
 
 #include "carla/client/Map.h"
 
+#include "carla/FileSystem.h"
+#include "carla/client/FileTransfer.h"
 #include "carla/client/Junction.h"
 #include "carla/client/Waypoint.h"
 #include "carla/opendrive/OpenDriveParser.h"
@@ -13,14 +15,24 @@
 #include "carla/road/RoadTypes.h"
 #include "carla/trafficmanager/InMemoryMap.h"
 
-#include <sstream>
 
 namespace carla {
 namespace client {
 
-  static auto MakeMap(const std::string &opendrive_contents) {
-    auto stream = std::istringstream(opendrive_contents);
-    auto map = opendrive::OpenDriveParser::Load(stream.str());
+  static auto MakeMap(const std::string &name, const std::string &opendrive_contents) {
+    // Reuse the map cached by a previous client next to the downloaded files.
+    std::string cache_path;
+    if (!name.empty()) {
+      cache_path = FileTransfer::GetFullPath(name + ".mapcache");
+      try {
+        FileSystem::ValidateFilePath(cache_path);
+      } catch (const std::exception &) {
+        cache_path.clear();
+      }
+    }
+    auto map = cache_path.empty() ?
+        opendrive::OpenDriveParser::Load(opendrive_contents) :
+        opendrive::OpenDriveParser::Load(opendrive_contents, cache_path);
     if (!map.has_value()) {
       throw_exception(std::runtime_error("failed to generate map"));
     }
@@ -29,7 +41,7 @@ namespace client {
 
   Map::Map(rpc::MapInfo description, std::string xodr_content)
     : _description(std::move(description)),
-      _map(MakeMap(xodr_content)){
+      _map(MakeMap(_description.name, xodr_content)){
     open_drive_file = xodr_content;
   }
   Map::Map(std::string name, std::string xodr_content)
@@ -56,6 +68,23 @@ namespace client {
     nullptr;
   }
 
+  std::vector<SharedPtr<Waypoint>> Map::GetWaypoints(
+      const std::vector<geom::Location> &locations,
+      bool project_to_road,
+      int32_t lane_type) const {
+    const auto waypoints = project_to_road ?
+        _map.GetClosestWaypointsOnRoad(locations, lane_type) :
+        _map.GetWaypoints(locations, lane_type);
+    std::vector<SharedPtr<Waypoint>> result;
+    result.reserve(waypoints.size());
+    for (const auto &waypoint : waypoints) {
+      result.emplace_back(waypoint.has_value() ?
+          SharedPtr<Waypoint>(new Waypoint{shared_from_this(), *waypoint}) :
+          nullptr);
+    }
+    return result;
+  }
+
   SharedPtr<Waypoint> Map::GetWaypointXODR(
       carla::road::RoadId road_id,
       carla::road::LaneId lane_id,
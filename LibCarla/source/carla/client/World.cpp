@@ -175,6 +175,10 @@ namespace client {
     _episode.Lock()->SetPedestriansSeed(seed);
   }
 
+  void World::SetPedestriansCrowdSettings(unsigned int max_agents, float tile_size, unsigned int worker_threads) {
+    _episode.Lock()->SetPedestriansCrowdSettings(max_agents, tile_size, worker_threads);
+  }
+
   SharedPtr<Actor> World::GetTrafficSign(const Landmark& landmark) const {
     SharedPtr<ActorList> actors = GetActors();
     SharedPtr<TrafficSign> result;
@@ -157,6 +157,10 @@ namespace client {
     /// set the seed to use with random numbers in the pedestrians module
     void SetPedestriansSeed(unsigned int seed);
 
+    /// set the maximum number of pedestrians per crowd tile, the size of the tiles in meters (zero keeps
+    /// a single crowd) and the number of threads updating the tiles
+    void SetPedestriansCrowdSettings(unsigned int max_agents, float tile_size, unsigned int worker_threads);
+
     SharedPtr<Actor> GetTrafficSign(const Landmark& landmark) const;
 
     SharedPtr<Actor> GetTrafficLight(const Landmark& landmark) const;
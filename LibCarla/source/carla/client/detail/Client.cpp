@@ -7,6 +7,8 @@
 #include "carla/client/detail/Client.h"
 
 #include "carla/Exception.h"
+#include "carla/FileSystem.h"
+#include "carla/ThreadGroup.h"
 #include "carla/Version.h"
 #include "carla/client/FileTransfer.h"
 #include "carla/client/TimeoutException.h"
@@ -15,6 +17,7 @@
 #include "carla/rpc/BoneTransformDataIn.h"
 #include "carla/rpc/Client.h"
 #include "carla/rpc/DebugShape.h"
+#include "carla/rpc/FileInfo.h"
 #include "carla/rpc/Response.h"
 #include "carla/rpc/VehicleAckermannControl.h"
 #include "carla/rpc/VehicleControl.h"
@@ -26,12 +29,27 @@
 
 #include <rpc/rpc_error.h>
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <fstream>
+#include <mutex>
 #include <thread>
 
 namespace carla {
 namespace client {
 namespace detail {
 
+  /// Bytes requested per call when transferring files, small enough to be
+  /// well within the RPC timeout.
+  static constexpr uint64_t FILE_CHUNK_SIZE = 4u << 20u;
+
+  /// Consecutive timeouts of a chunk before giving up, the download can still
+  /// be resumed later.
+  static constexpr size_t MAX_FILE_CHUNK_TIMEOUTS = 3u;
+
+  static constexpr size_t MAX_PARALLEL_FILE_TRANSFERS = 4u;
+
   template <typename T>
   static T Get(carla::rpc::Response<T> &response) {
     return response.Get();
@@ -132,6 +150,10 @@ namespace detail {
     return _pimpl->GetTimeout();
   }
 
+  void Client::SetStreamingMultiplexing(bool enabled) {
+    _pimpl->streaming_client.SetMultiplexed(enabled);
+  }
+
   const std::string Client::GetEndpoint() const {
     return _pimpl->endpoint;
   }
@@ -207,24 +229,80 @@ namespace detail {
     auto requiredFiles = _pimpl->CallAndWait<std::vector<std::string>>("get_required_files", folder);
 
     if (download) {
-
-      // For each required file, check if it exists and request it otherwise
-      for (auto requiredFile : requiredFiles) {
-        if (!FileTransfer::FileExists(requiredFile)) {
-          RequestFile(requiredFile);
-          log_info("Could not find the required file in cache, downloading... ", requiredFile);
-        } else {
-          log_info("Found the required file in cache! ", requiredFile);
-        }
+      // Check and download the files in parallel, each one in a single thread.
+      std::atomic_size_t next{0u};
+      std::mutex mutex;
+      std::exception_ptr error;
+      ThreadGroup workers;
+      workers.CreateThreads(
+          std::min(requiredFiles.size(), MAX_PARALLEL_FILE_TRANSFERS),
+          [&]() {
+            for (auto i = next++; i < requiredFiles.size(); i = next++) {
+              try {
+                RequestFile(requiredFiles[i]);
+              } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (error == nullptr) {
+                  error = std::current_exception();
+                }
+              }
+            }
+          });
+      workers.JoinAll();
+      if (error != nullptr) {
+        std::rethrow_exception(error);
       }
     }
     return requiredFiles;
   }
 
   void Client::RequestFile(const std::string &name) const {
-    // Download the binary content of the file from the server and write it on the client
-    auto content = _pimpl->CallAndWait<std::vector<uint8_t>>("request_file", name);
-    FileTransfer::WriteFile(name, content);
+    // The name is a path in the cache folder, never write outside of it.
+    if (name.find("..") != std::string::npos) {
+      throw_exception(std::invalid_argument("file transfer: invalid file name " + name));
+    }
+    const auto info = _pimpl->CallAndWait<rpc::FileInfo>("get_file_info", name);
+    if (FileTransfer::IsFileValid(name, info)) {
+      log_info("Found the required file in cache! ", name);
+      return;
+    }
+    log_info("Could not find the required file in cache, downloading... ", name);
+
+    // Download the file in chunks to its partial file, resuming from whatever a
+    // previous transfer left there.
+    const std::string partial = FileTransfer::GetPartialPath(name, info);
+    uint64_t offset = FileTransfer::GetPartialSize(name, info);
+    std::string path = partial;
+    FileSystem::ValidateFilePath(path);
+    std::ofstream out(partial, std::ios::binary | std::ios::app);
+    size_t timeouts = 0u;
+    while (offset < info.size) {
+      const auto size = static_cast<uint32_t>(std::min<uint64_t>(FILE_CHUNK_SIZE, info.size - offset));
+      std::vector<uint8_t> chunk;
+      try {
+        chunk = _pimpl->CallAndWait<std::vector<uint8_t>>("request_file_chunk", name, offset, size);
+      } catch (const TimeoutException &) {
+        if (++timeouts > MAX_FILE_CHUNK_TIMEOUTS) {
+          throw;
+        }
+        log_warning("file transfer: timeout downloading", name, "at byte", offset, ", retrying");
+        continue;
+      }
+      if (chunk.empty()) {
+        throw_exception(std::runtime_error("file transfer: " + name + " is shorter than expected"));
+      }
+      out.write(reinterpret_cast<const char *>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+      if (!out.good()) {
+        throw_exception(std::runtime_error("file transfer: unable to write " + partial));
+      }
+      offset += chunk.size();
+      timeouts = 0u;
+    }
+    out.close();
+
+    if (!FileTransfer::CommitPartial(name, info)) {
+      throw_exception(std::runtime_error("file transfer: " + name + " does not match the hash of the server"));
+    }
   }
 
   std::vector<uint8_t> Client::GetCacheFile(const std::string &name, const bool request_otherwise) const {
@@ -719,6 +797,10 @@ namespace detail {
     return _pimpl->CallAndWait<uint64_t>("tick_cue");
   }
 
+  void Client::RequestEpisodeKeyframe() {
+    _pimpl->AsyncCall("request_episode_keyframe");
+  }
+
   std::vector<rpc::LightState> Client::QueryLightsStateToServer() const {
     using return_t = std::vector<rpc::LightState>;
     return _pimpl->CallAndWait<return_t>("query_lights_state", _pimpl->endpoint);
@@ -93,6 +93,8 @@ namespace detail {
 
     time_duration GetTimeout() const;
 
+    void SetStreamingMultiplexing(bool enabled);
+
     const std::string GetEndpoint() const;
 
     std::string GetClientVersion();
@@ -128,10 +130,15 @@ namespace detail {
 
     bool SetFilesBaseFolder(const std::string &path);
 
+    /// If @a download, the files missing in the cache or with content other
+    /// than the server's are downloaded, several at a time.
     std::vector<std::string> GetRequiredFiles(const std::string &folder = "", const bool download = true) const;
 
     std::string GetMapData() const;
 
+    /// Download @a name to the cache unless the cached file has the same
+    /// content hash. The file is transferred in chunks and a transfer that
+    /// failed is resumed.
     void RequestFile(const std::string &name) const;
 
     std::vector<uint8_t> GetCacheFile(const std::string &name, const bool request_otherwise = true) const;
@@ -447,6 +454,10 @@ namespace detail {
 
     uint64_t SendTickCue();
 
+    /// Ask the server to send the whole episode state in the next tick, after
+    /// missing a frame of the delta encoded state.
+    void RequestEpisodeKeyframe();
+
     std::vector<rpc::LightState> QueryLightsStateToServer() const;
 
     void UpdateServerLightsState(
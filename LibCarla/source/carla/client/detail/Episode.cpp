@@ -7,12 +7,15 @@
 #include "carla/client/detail/Episode.h"
 
 #include "carla/Logging.h"
+#include "carla/profiler/Tracer.h"
 #include "carla/client/detail/Client.h"
 #include "carla/client/detail/WalkerNavigation.h"
 #include "carla/sensor/Deserializer.h"
 #include "carla/trafficmanager/TrafficManager.h"
 
 #include <exception>
+#include <stdexcept>
+#include <string>
 
 namespace carla {
 namespace client {
@@ -56,11 +59,26 @@ using namespace std::chrono_literals;
     _client.SubscribeToStream(_token, [weak](auto buffer) {
       auto self = weak.lock();
       if (self != nullptr) {
+        CARLA_TRACE_SCOPE("episode", "Tick");
 
         auto data = sensor::Deserializer::Deserialize(std::move(buffer));
-        auto next = std::make_shared<const EpisodeState>(CastData(*data));
+        const auto &raw_state = CastData(*data);
         auto prev = self->GetState();
 
+        std::shared_ptr<const EpisodeState> next = EpisodeState::MakeNext(*prev, raw_state);
+        if (next == nullptr) {
+          // We missed the frame this delta is based on. Ask for a keyframe,
+          // sent with the next frame, and make the threads waiting for this
+          // one fail instead of timing out.
+          log_debug("episode: missed frame", raw_state.GetBaseFrame(), ", requesting a keyframe");
+          self->_last_missed_frame = raw_state.GetFrame();
+          self->_client.RequestEpisodeKeyframe();
+          self->_snapshot.SetException(std::runtime_error(
+              "missed frame " + std::to_string(raw_state.GetFrame()) +
+              " of the episode state, the next frame will be complete"));
+          return;
+        }
+
         // TODO: Update how the map change is detected
         bool HasMapChanged = next->HasMapChanged();
         bool UpdateLights = next->IsLightUpdatePending();
@@ -150,17 +168,36 @@ using namespace std::chrono_literals;
   }
 
   std::shared_ptr<WalkerNavigation> Episode::CreateNavigationIfMissing() {
-    std::shared_ptr<WalkerNavigation> nav;
-    do {
+    auto nav = _walker_navigation.load();
+    if (nav == nullptr) {
+      // critical section
+      std::lock_guard<std::mutex> lock(_walker_navigation_mutex);
       nav = _walker_navigation.load();
       if (nav == nullptr) {
-        auto new_nav = std::make_shared<WalkerNavigation>(_simulator);
-        _walker_navigation.compare_exchange(&nav, new_nav);
+        nav = std::make_shared<WalkerNavigation>(_simulator, GetOpenDriveParameters());
+        _walker_navigation.store(nav);
       }
-    } while (nav == nullptr);
+    }
     return nav;
   }
 
+  void Episode::SetOpenDriveParameters(const rpc::OpendriveGenerationParameters &params) {
+    // critical section
+    std::lock_guard<std::mutex> lock(_opendrive_parameters_mutex);
+    _opendrive_parameters = params;
+    _opendrive_parameters_episode_id = GetId();
+  }
+
+  boost::optional<rpc::OpendriveGenerationParameters> Episode::GetOpenDriveParameters() const {
+    // critical section
+    std::lock_guard<std::mutex> lock(_opendrive_parameters_mutex);
+    // another client may have loaded a new world since
+    if (_opendrive_parameters_episode_id != GetId()) {
+      return boost::none;
+    }
+    return _opendrive_parameters;
+  }
+
 } // namespace detail
 } // namespace client
 } // namespace carla
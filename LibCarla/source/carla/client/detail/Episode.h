@@ -16,7 +16,10 @@
 #include "carla/client/detail/EpisodeState.h"
 #include "carla/client/detail/EpisodeProxy.h"
 #include "carla/rpc/EpisodeInfo.h"
+#include "carla/rpc/OpendriveGenerationParameters.h"
 
+#include <atomic>
+#include <mutex>
 #include <vector>
 
 namespace carla {
@@ -60,10 +63,19 @@ namespace detail {
 
     std::vector<rpc::Actor> GetActors();
 
+    /// Wait for the state of the next frame. Throws if the frame is missed
+    /// while the state is delta encoded; the state of the episode stays at
+    /// the previous frame until the server sends the keyframe requested, with
+    /// the next frame.
     boost::optional<WorldSnapshot> WaitForState(time_duration timeout) {
       return _snapshot.WaitFor(timeout);
     }
 
+    /// Last frame whose delta encoded state could not be applied.
+    uint64_t GetLastMissedFrame() const {
+      return _last_missed_frame;
+    }
+
     size_t RegisterOnTickEvent(std::function<void(WorldSnapshot)> callback) {
       return _on_tick_callbacks.Push(std::move(callback));
     }
@@ -99,8 +111,18 @@ namespace detail {
 
     bool HasMapChangedSinceLastCall();
 
+    /// Create the walker navigation of the episode the first time it is
+    /// needed. It may build the navigation mesh, so it is created only once.
     std::shared_ptr<WalkerNavigation> CreateNavigationIfMissing();
 
+    /// Record the parameters this client generated the current OpenDRIVE
+    /// world with.
+    void SetOpenDriveParameters(const rpc::OpendriveGenerationParameters &params);
+
+    /// Parameters the current world was generated with, if it is an OpenDRIVE
+    /// world loaded by this client.
+    boost::optional<rpc::OpendriveGenerationParameters> GetOpenDriveParameters() const;
+
   private:
 
     Episode(Client &client, const rpc::EpisodeInfo &info, std::weak_ptr<Simulator> simulator);
@@ -127,10 +149,20 @@ namespace detail {
 
     AtomicSharedPtr<WalkerNavigation> _walker_navigation;
 
+    std::mutex _walker_navigation_mutex;
+
+    mutable std::mutex _opendrive_parameters_mutex;
+
+    boost::optional<rpc::OpendriveGenerationParameters> _opendrive_parameters;
+
+    uint64_t _opendrive_parameters_episode_id = 0u;
+
     const streaming::Token _token;
 
     bool _pending_exceptions = false;
 
+    std::atomic<uint64_t> _last_missed_frame { 0u };
+
     bool _should_update_map = true;
 
     std::weak_ptr<Simulator> _simulator;
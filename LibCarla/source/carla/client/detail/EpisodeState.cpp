@@ -6,10 +6,29 @@
 
 #include "carla/client/detail/EpisodeState.h"
 
+#include <algorithm>
+
 namespace carla {
 namespace client {
 namespace detail {
 
+  static ActorSnapshot MakeActorSnapshot(const sensor::data::ActorDynamicState &actor) {
+    return ActorSnapshot{
+        actor.id,
+        actor.actor_state,
+        actor.transform,
+        actor.velocity,
+        actor.angular_velocity,
+        actor.acceleration,
+        actor.state};
+  }
+
+  EpisodeState::EpisodeState(uint64_t episode_id)
+    : _episode_id(episode_id) {
+    static const auto empty_bucket = std::make_shared<const ActorMap>();
+    _buckets.fill(empty_bucket);
+  }
+
   EpisodeState::EpisodeState(const sensor::data::RawEpisodeState &state)
     : _episode_id(state.GetEpisodeId()),
       _timestamp(
@@ -18,22 +37,71 @@ namespace detail {
           state.GetDeltaSeconds(),
           state.GetPlatformTimeStamp()),
       _map_origin(state.GetMapOrigin()),
-      _simulation_state(state.GetSimulationState()) {
-    _actors.reserve(state.size());
+      _simulation_state(state.GetSimulationState()),
+      _size(state.size()) {
+    DEBUG_ASSERT(!state.IsDeltaFrame());
+    std::array<std::shared_ptr<ActorMap>, BUCKET_COUNT> buckets;
+    for (auto &bucket : buckets) {
+      bucket = std::make_shared<ActorMap>();
+      bucket->reserve(_size / BUCKET_COUNT + 1u);
+    }
     for (auto &&actor : state) {
       DEBUG_ONLY(auto result = )
-      _actors.emplace(
-          actor.id,
-          ActorSnapshot{
-              actor.id,
-              actor.actor_state,
-              actor.transform,
-              actor.velocity,
-              actor.angular_velocity,
-              actor.acceleration,
-              actor.state});
+      buckets[GetBucketIndex(actor.id)]->emplace(actor.id, MakeActorSnapshot(actor));
       DEBUG_ASSERT(result.second);
     }
+    std::copy(buckets.begin(), buckets.end(), _buckets.begin());
+  }
+
+  EpisodeState::EpisodeState(
+      const EpisodeState &previous,
+      const sensor::data::RawEpisodeState &delta)
+    : _episode_id(delta.GetEpisodeId()),
+      _timestamp(
+          delta.GetFrame(),
+          delta.GetGameTimeStamp(),
+          delta.GetDeltaSeconds(),
+          delta.GetPlatformTimeStamp()),
+      _map_origin(delta.GetMapOrigin()),
+      _simulation_state(delta.GetSimulationState()),
+      _buckets(previous._buckets),
+      _size(previous._size) {
+    DEBUG_ASSERT(delta.IsDeltaFrame());
+    DEBUG_ASSERT(delta.GetBaseFrame() == previous.GetFrame());
+    // Buckets copied so far, the others are still shared with previous.
+    std::array<std::shared_ptr<ActorMap>, BUCKET_COUNT> copies;
+    auto get_bucket_copy = [&](ActorId id) -> ActorMap & {
+      const auto index = GetBucketIndex(id);
+      if (copies[index] == nullptr) {
+        copies[index] = std::make_shared<ActorMap>(*_buckets[index]);
+        _buckets[index] = copies[index];
+      }
+      return *copies[index];
+    };
+    for (auto id : delta.GetDestroyedActorIds()) {
+      _size -= get_bucket_copy(id).erase(id);
+    }
+    for (auto &&actor : delta) {
+      auto result = get_bucket_copy(actor.id).emplace(actor.id, MakeActorSnapshot(actor));
+      if (result.second) {
+        ++_size;
+      } else {
+        result.first->second = MakeActorSnapshot(actor);
+      }
+    }
+  }
+
+  std::shared_ptr<const EpisodeState> EpisodeState::MakeNext(
+      const EpisodeState &previous,
+      const sensor::data::RawEpisodeState &raw_state) {
+    if (!raw_state.IsDeltaFrame()) {
+      return std::make_shared<const EpisodeState>(raw_state);
+    }
+    if ((raw_state.GetEpisodeId() == previous.GetEpisodeId()) &&
+        (raw_state.GetBaseFrame() == previous.GetFrame())) {
+      return std::make_shared<const EpisodeState>(previous, raw_state);
+    }
+    return nullptr;
   }
 
 } // namespace detail
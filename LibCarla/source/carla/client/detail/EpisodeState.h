@@ -14,8 +14,10 @@
 #include "carla/geom/Vector3DInt.h"
 #include "carla/sensor/data/RawEpisodeState.h"
 
+#include <boost/iterator/iterator_facade.hpp>
 #include <boost/optional.hpp>
 
+#include <array>
 #include <memory>
 #include <unordered_map>
 
@@ -24,18 +26,95 @@ namespace client {
 namespace detail {
 
   /// Represents the state of all the actors of an episode at a given frame.
+  ///
+  /// The actors are split in buckets by id. A state built from a delta frame
+  /// copies only the buckets the delta modifies and shares the rest with the
+  /// previous state.
   class EpisodeState
     : public std::enable_shared_from_this<EpisodeState>,
       private NonCopyable {
 
       using SimulationState = sensor::s11n::EpisodeStateSerializer::SimulationState;
 
+      using ActorMap = std::unordered_map<ActorId, ActorSnapshot>;
+
+      static constexpr size_t BUCKET_COUNT = 64u;
+
+      using Buckets = std::array<std::shared_ptr<const ActorMap>, BUCKET_COUNT>;
+
+      /// Iterator over the (id, snapshot) pairs of every bucket.
+      class ActorIterator
+        : public boost::iterator_facade<
+              ActorIterator,
+              const ActorMap::value_type,
+              boost::forward_traversal_tag> {
+      public:
+
+        ActorIterator() = default;
+
+        ActorIterator(const Buckets &buckets, size_t bucket)
+          : _buckets(&buckets),
+            _bucket(bucket) {
+          if (_bucket < BUCKET_COUNT) {
+            _it = buckets[_bucket]->begin();
+            SkipEmptyBuckets();
+          }
+        }
+
+      private:
+
+        friend class boost::iterator_core_access;
+
+        void SkipEmptyBuckets() {
+          while ((_bucket < BUCKET_COUNT) && (_it == (*_buckets)[_bucket]->end())) {
+            if (++_bucket < BUCKET_COUNT) {
+              _it = (*_buckets)[_bucket]->begin();
+            }
+          }
+        }
+
+        void increment() {
+          ++_it;
+          SkipEmptyBuckets();
+        }
+
+        bool equal(const ActorIterator &rhs) const {
+          return (_bucket == rhs._bucket) && ((_bucket == BUCKET_COUNT) || (_it == rhs._it));
+        }
+
+        const ActorMap::value_type &dereference() const {
+          return *_it;
+        }
+
+        const Buckets *_buckets = nullptr;
+
+        size_t _bucket = BUCKET_COUNT;
+
+        ActorMap::const_iterator _it;
+      };
+
   public:
 
-    explicit EpisodeState(uint64_t episode_id) : _episode_id(episode_id) {}
+    explicit EpisodeState(uint64_t episode_id);
 
+    /// Build the state of a keyframe.
     explicit EpisodeState(const sensor::data::RawEpisodeState &state);
 
+    /// Build the state of a delta frame by applying it to @a previous.
+    ///
+    /// @pre delta.IsDeltaFrame() and delta.GetBaseFrame() is the frame of @a
+    /// previous.
+    EpisodeState(const EpisodeState &previous, const sensor::data::RawEpisodeState &delta);
+
+    /// Build the state of @a raw_state, the frame received after @a previous.
+    ///
+    /// Return nullptr if @a raw_state is a delta frame based on another frame
+    /// than @a previous, i.e. a frame was missed and the state cannot be built
+    /// until the next keyframe.
+    static std::shared_ptr<const EpisodeState> MakeNext(
+        const EpisodeState &previous,
+        const sensor::data::RawEpisodeState &raw_state);
+
     auto GetEpisodeId() const {
       return _episode_id;
     }
@@ -61,7 +140,8 @@ namespace detail {
     }
 
     bool ContainsActorSnapshot(ActorId actor_id) const {
-      return _actors.find(actor_id) != _actors.end();
+      const auto &bucket = GetBucket(actor_id);
+      return bucket.find(actor_id) != bucket.end();
     }
 
     ActorSnapshot GetActorSnapshot(ActorId id) const {
@@ -78,28 +158,43 @@ namespace detail {
 
     auto GetActorIds() const {
       return MakeListView(
-          iterator::make_map_keys_const_iterator(_actors.begin()),
-          iterator::make_map_keys_const_iterator(_actors.end()));
+          iterator::make_map_keys_const_iterator(ActorIterator{_buckets, 0u}),
+          iterator::make_map_keys_const_iterator(ActorIterator{_buckets, BUCKET_COUNT}));
     }
 
     size_t size() const {
-      return _actors.size();
+      return _size;
+    }
+
+    /// Whether the actor @a id is stored in the same bucket as in @a other,
+    /// i.e. the bucket was not copied when building one state from the other.
+    bool SharesBucketWith(const EpisodeState &other, ActorId id) const {
+      return _buckets[GetBucketIndex(id)] == other._buckets[GetBucketIndex(id)];
     }
 
     auto begin() const {
-      return iterator::make_map_values_const_iterator(_actors.begin());
+      return iterator::make_map_values_const_iterator(ActorIterator{_buckets, 0u});
     }
 
     auto end() const {
-      return iterator::make_map_values_const_iterator(_actors.end());
+      return iterator::make_map_values_const_iterator(ActorIterator{_buckets, BUCKET_COUNT});
     }
 
   private:
 
+    static size_t GetBucketIndex(ActorId id) {
+      return id % BUCKET_COUNT;
+    }
+
+    const ActorMap &GetBucket(ActorId id) const {
+      return *_buckets[GetBucketIndex(id)];
+    }
+
     template <typename T>
     void CopyActorSnapshotIfPresent(ActorId id, T &value) const {
-      auto it = _actors.find(id);
-      if (it != _actors.end()) {
+      const auto &bucket = GetBucket(id);
+      auto it = bucket.find(id);
+      if (it != bucket.end()) {
         value = it->second;
       }
     }
@@ -110,9 +205,11 @@ namespace detail {
 
     geom::Vector3DInt _map_origin;
 
-    SimulationState _simulation_state;
+    SimulationState _simulation_state = SimulationState::None;
+
+    Buckets _buckets;
 
-    std::unordered_map<ActorId, ActorSnapshot> _actors;
+    size_t _size = 0u;
   };
 
 } // namespace detail
@@ -22,6 +22,8 @@
 #include "carla/sensor/Deserializer.h"
 
 #include <exception>
+#include <stdexcept>
+#include <string>
 #include <thread>
 
 using namespace std::string_literals;
@@ -50,6 +52,11 @@ namespace detail {
     bool result = true;
     auto start = std::chrono::system_clock::now();
     while (frame > episode.GetState()->GetTimestamp().frame) {
+      if (episode.GetLastMissedFrame() >= frame) {
+        throw_exception(std::runtime_error(
+            "missed frame " + std::to_string(frame) +
+            " of the episode state, the next frame will be complete"));
+      }
       std::this_thread::yield();
       auto end = std::chrono::system_clock::now();
       auto diff = std::chrono::duration_cast<std::chrono::milliseconds>(end-start);
@@ -126,7 +133,9 @@ namespace detail {
     // It will load the last sended OpenDRIVE by client's "LoadOpenDriveEpisode()"
     constexpr auto custom_opendrive_map = "OpenDriveMap";
     _client.CopyOpenDriveToServer(std::move(opendrive), params);
-    return LoadEpisode(custom_opendrive_map, reset_settings);
+    auto episode = LoadEpisode(custom_opendrive_map, reset_settings);
+    _episode->SetOpenDriveParameters(params);
+    return episode;
   }
 
   // ===========================================================================
@@ -344,6 +353,12 @@ EpisodeProxy Simulator::GetCurrentEpisode() {
     nav->SetPedestriansSeed(seed);
   }
 
+  void Simulator::SetPedestriansCrowdSettings(unsigned int max_agents, float tile_size, unsigned int worker_threads) {
+    DEBUG_ASSERT(_episode != nullptr);
+    auto nav = _episode->CreateNavigationIfMissing();
+    nav->SetPedestriansCrowdSettings(max_agents, tile_size, worker_threads);
+  }
+
   // ===========================================================================
   // -- General operations with actors -----------------------------------------
   // ===========================================================================
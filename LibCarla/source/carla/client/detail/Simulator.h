@@ -175,6 +175,10 @@ namespace detail {
       return _client.GetTimeout();
     }
 
+    void SetStreamingMultiplexing(bool enabled) {
+      _client.SetStreamingMultiplexing(enabled);
+    }
+
     std::string GetClientVersion() {
       return _client.GetClientVersion();
     }
@@ -320,6 +324,8 @@ namespace detail {
 
     void SetPedestriansSeed(unsigned int seed);
 
+    void SetPedestriansCrowdSettings(unsigned int max_agents, float tile_size, unsigned int worker_threads);
+
     /// @}
     // =========================================================================
     /// @name General operations with actors
@@ -6,31 +6,52 @@
 
 #include "carla/client/detail/WalkerNavigation.h"
 
+#include "carla/Logging.h"
 #include "carla/client/detail/Client.h"
 #include "carla/client/detail/Episode.h"
 #include "carla/client/detail/EpisodeState.h"
 #include "carla/client/detail/Simulator.h"
+#include "carla/client/Map.h"
+#include "carla/nav/NavMeshBuilder.h"
 #include "carla/nav/Navigation.h"
+#include "carla/profiler/Tracer.h"
 #include "carla/rpc/Command.h"
 #include "carla/rpc/DebugShape.h"
 #include "carla/rpc/WalkerControl.h"
 
 #include <sstream>
+#include <vector>
 
 namespace carla {
 namespace client {
 namespace detail {
 
-  WalkerNavigation::WalkerNavigation(std::weak_ptr<Simulator> simulator) : _simulator(simulator), _next_check_index(0) {
+  WalkerNavigation::WalkerNavigation(
+      std::weak_ptr<Simulator> simulator,
+      boost::optional<rpc::OpendriveGenerationParameters> opendrive_parameters)
+    : _simulator(simulator),
+      _next_check_index(0) {
     _nav.SetSimulator(simulator);
     // Here call the server to retrieve the navmesh data.
     auto files = _simulator.lock()->GetRequiredFiles("Nav");
     if (!files.empty()) {
       _nav.Load(_simulator.lock()->GetCacheFile(files[0], true));
+    } else if (opendrive_parameters.has_value() && opendrive_parameters->enable_pedestrian_navigation) {
+      // the server may have no navigation mesh for an OpenDRIVE world, build
+      // it from the roads of the map as the server would have
+      log_info("Nav: building the navigation mesh of the map");
+      nav::NavMeshBuilder builder;
+      const auto map = _simulator.lock()->GetCurrentMap();
+      if (builder.Build(nav::NavMeshBuilder::GenerateInputMesh(
+              map->GetMap(),
+              opendrive_parameters->vertex_distance))) {
+        _nav.Load(builder.Serialize());
+      }
     }
   }
 
   void WalkerNavigation::Tick(std::shared_ptr<Episode> episode) {
+    CARLA_TRACE_SCOPE("walker_navigation", "Tick");
     auto walkers = _walkers.Load();
     if (walkers->empty()) {
       return;
@@ -48,25 +69,30 @@ namespace detail {
     // update crowd in navigation module
     _nav.UpdateCrowd(*state);
 
-    carla::geom::Transform trans;
+    // the state of the walkers published by the crowd update is read without locking the crowd
+    std::shared_ptr<const nav::WalkerStates> walker_states = _nav.GetWalkerStates();
+
     using Cmd = rpc::Command;
     std::vector<Cmd> commands;
     commands.reserve(walkers->size());
     for (auto handle : *walkers) {
       // get the transform of the walker
-      if (_nav.GetWalkerTransform(handle.walker, trans)) {
-        float speed = _nav.GetWalkerSpeed(handle.walker);
-        commands.emplace_back(Cmd::ApplyWalkerState{ handle.walker, trans, speed });
+      auto walker_state = walker_states->find(handle.walker);
+      if (walker_state != walker_states->end() && walker_state->second.active) {
+        commands.emplace_back(Cmd::ApplyWalkerState{
+            handle.walker,
+            walker_state->second.transform,
+            walker_state->second.speed });
       }
     }
     _simulator.lock()->ApplyBatchSync(std::move(commands), false);
 
     // check if any agent has been killed
-    bool alive;
     for (auto handle : *walkers) {
       // get the agent state
-      if (_nav.IsWalkerAlive(handle.walker, alive)) {
-        if (!alive) {
+      auto walker_state = walker_states->find(handle.walker);
+      if (walker_state != walker_states->end()) {
+        if (!walker_state->second.alive) {
           _simulator.lock()->SetActorCollisions(handle.walker, true);
           _simulator.lock()->SetActorDead(handle.walker);
           // remove from the crowd
@@ -123,67 +149,60 @@ namespace detail {
 
     // optional debug info
     if (show_debug) {
-      if (_nav.GetCrowd() == nullptr) return;
-
-      // draw bounding boxes for debug
-      for (int i = 0; i < _nav.GetCrowd()->getAgentCount(); ++i) {
-        // get the agent
-        const dtCrowdAgent *agent = _nav.GetCrowd()->getAgent(i);
-        if (agent && agent->params.useObb) {
-          // draw for debug
+      // the shapes are collected with the crowd locked and drawn after
+      std::vector<carla::rpc::DebugShape> shapes;
+      _nav.ForEachAgent([&shapes](const dtCrowdAgent &agent) {
+        // draw bounding boxes for debug
+        if (agent.params.useObb) {
           carla::geom::Location p1, p2, p3, p4;
-          p1.x = agent->params.obb[0];
-          p1.z = agent->params.obb[1];
-          p1.y = agent->params.obb[2];
-          p2.x = agent->params.obb[3];
-          p2.z = agent->params.obb[4];
-          p2.y = agent->params.obb[5];
-          p3.x = agent->params.obb[6];
-          p3.z = agent->params.obb[7];
-          p3.y = agent->params.obb[8];
-          p4.x = agent->params.obb[9];
-          p4.z = agent->params.obb[10];
-          p4.y = agent->params.obb[11];
+          p1.x = agent.params.obb[0];
+          p1.z = agent.params.obb[1];
+          p1.y = agent.params.obb[2];
+          p2.x = agent.params.obb[3];
+          p2.z = agent.params.obb[4];
+          p2.y = agent.params.obb[5];
+          p3.x = agent.params.obb[6];
+          p3.z = agent.params.obb[7];
+          p3.y = agent.params.obb[8];
+          p4.x = agent.params.obb[9];
+          p4.z = agent.params.obb[10];
+          p4.y = agent.params.obb[11];
           carla::rpc::DebugShape line1;
           line1.life_time = 0.01f;
           line1.persistent_lines = false;
           // line 1
           line1.primitive = carla::rpc::DebugShape::Line {p1, p2, 0.2f};
           line1.color = { 0, 255, 0 };
-          _simulator.lock()->DrawDebugShape(line1);
+          shapes.emplace_back(line1);
           // line 2
           line1.primitive = carla::rpc::DebugShape::Line {p2, p3, 0.2f};
           line1.color = { 255, 0, 0 };
-          _simulator.lock()->DrawDebugShape(line1);
+          shapes.emplace_back(line1);
           // line 3
           line1.primitive = carla::rpc::DebugShape::Line {p3, p4, 0.2f};
           line1.color = { 0, 0, 255 };
-          _simulator.lock()->DrawDebugShape(line1);
+          shapes.emplace_back(line1);
           // line 4
           line1.primitive = carla::rpc::DebugShape::Line {p4, p1, 0.2f};
           line1.color = { 255, 255, 0 };
-          _simulator.lock()->DrawDebugShape(line1);
+          shapes.emplace_back(line1);
         }
-      }
 
-      // draw some text for debug
-      for (int i = 0; i < _nav.GetCrowd()->getAgentCount(); ++i) {
-        // get the agent
-        const dtCrowdAgent *agent = _nav.GetCrowd()->getAgent(i);
-        if (agent) {
-          // draw for debug
-          carla::geom::Location p1(agent->npos[0], agent->npos[2], agent->npos[1] + 1);
-          if (agent->params.userData) {
-            std::ostringstream out;
-            out << *(reinterpret_cast<const float *>(agent->params.userData));
-            carla::rpc::DebugShape text;
-            text.life_time = 0.01f;
-            text.persistent_lines = false;
-            text.primitive = carla::rpc::DebugShape::String {p1, out.str(), false};
-            text.color = { 0, 255, 0 };
-            _simulator.lock()->DrawDebugShape(text);
-          }
+        // draw some text for debug
+        if (agent.params.userData) {
+          carla::geom::Location p1(agent.npos[0], agent.npos[2], agent.npos[1] + 1);
+          std::ostringstream out;
+          out << *(reinterpret_cast<const float *>(agent.params.userData));
+          carla::rpc::DebugShape text;
+          text.life_time = 0.01f;
+          text.persistent_lines = false;
+          text.primitive = carla::rpc::DebugShape::String {p1, out.str(), false};
+          text.color = { 0, 255, 0 };
+          shapes.emplace_back(text);
         }
+      });
+      for (auto &&shape : shapes) {
+        _simulator.lock()->DrawDebugShape(shape);
       }
     }
   }
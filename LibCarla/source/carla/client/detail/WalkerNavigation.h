@@ -11,6 +11,9 @@
 #include "carla/NonCopyable.h"
 #include "carla/client/Timestamp.h"
 #include "carla/rpc/ActorId.h"
+#include "carla/rpc/OpendriveGenerationParameters.h"
+
+#include <boost/optional.hpp>
 
 #include <memory>
 
@@ -27,7 +30,12 @@ namespace detail {
     private NonCopyable {
   public:
 
-    explicit WalkerNavigation(std::weak_ptr<Simulator> simulator);
+    /// Load the navigation mesh of the current map from the server. If it
+    /// has none and the map was generated by this client from OpenDRIVE, with
+    /// @a opendrive_parameters, build it from the roads of the map.
+    WalkerNavigation(
+        std::weak_ptr<Simulator> simulator,
+        boost::optional<rpc::OpendriveGenerationParameters> opendrive_parameters = boost::none);
 
     void RegisterWalker(ActorId walker_id, ActorId controller_id) {
       // add to list
@@ -88,6 +96,11 @@ namespace detail {
       _nav.SetSeed(seed);
     }
 
+    // set the capacity, tile size and threads of the crowd
+    void SetPedestriansCrowdSettings(unsigned int max_agents, float tile_size, unsigned int worker_threads) {
+      _nav.SetCrowdSettings(max_agents, tile_size, worker_threads);
+    }
+
   private:
 
     std::weak_ptr<Simulator> _simulator;
@@ -0,0 +1,611 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/geom/MeshExporter.h"
+
+#include "carla/Fnv1aHash.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+namespace carla {
+namespace geom {
+
+namespace {
+
+  // Both formats are little-endian, as are all the platforms we build for, so
+  // the values are written with their in-memory representation.
+
+  /// Accumulates small writes and gives them to the callback in chunks of, at
+  /// most, the given size.
+  class ChunkWriter {
+  public:
+
+    ChunkWriter(const MeshExporter::WriteCallback &write, size_t chunk_size)
+      : _write(write),
+        _buffer(std::max<size_t>(chunk_size, 64u)) {}
+
+    void Write(const void *data, size_t size) {
+      const auto *bytes = static_cast<const unsigned char *>(data);
+      while (size > 0u) {
+        if (_size == _buffer.size()) {
+          Flush();
+        }
+        const size_t count = std::min(size, _buffer.size() - _size);
+        std::memcpy(_buffer.data() + _size, bytes, count);
+        _size += count;
+        bytes += count;
+        size -= count;
+      }
+    }
+
+    template <typename T>
+    void Write(const T &value) {
+      Write(&value, sizeof(T));
+    }
+
+    void Write(const std::string &str) {
+      Write(str.data(), str.size());
+    }
+
+    void Flush() {
+      if (_size > 0u) {
+        _write(_buffer.data(), _size);
+        _size = 0u;
+      }
+    }
+
+  private:
+
+    const MeshExporter::WriteCallback &_write;
+
+    std::vector<unsigned char> _buffer;
+
+    size_t _size = 0u;
+  };
+
+  /// The vertices, normals and uvs of a mesh after welding, and the faces
+  /// grouped by material.
+  class ExportData {
+  public:
+
+    ExportData(const Mesh &mesh, const MeshExportOptions &options)
+      : _mesh(mesh),
+        _has_normals(mesh.GetNormals().size() == mesh.GetVerticesNum()),
+        _has_uvs(mesh.GetUVs().size() == mesh.GetVerticesNum()) {
+      if (options.weld_vertices) {
+        Weld(options.weld_tolerance);
+      }
+      AssignMaterials();
+    }
+
+    bool HasNormals() const {
+      return _has_normals;
+    }
+
+    bool HasUVs() const {
+      return _has_uvs;
+    }
+
+    /// Number of vertices after welding.
+    size_t GetVertexCount() const {
+      return _source.empty() ? _mesh.GetVerticesNum() : _source.size();
+    }
+
+    /// Vertex of the mesh the exported vertex @a i comes from.
+    size_t GetSource(size_t i) const {
+      return _source.empty() ? i : _source[i];
+    }
+
+    size_t GetFaceCount() const {
+      return _mesh.GetIndexesNum() / 3u;
+    }
+
+    /// Exported, 0-based, index of the vertex at @a i in the index list.
+    uint32_t GetIndex(size_t i) const {
+      const size_t vertex = _mesh.GetIndexes()[i] - 1u;
+      return static_cast<uint32_t>(_remap.empty() ? vertex : _remap[vertex]);
+    }
+
+    /// Names of the materials, without repetitions.
+    const std::vector<std::string> &GetMaterials() const {
+      return _materials;
+    }
+
+    /// Index in GetMaterials() of the material of @a face, -1 if none.
+    int GetFaceMaterial(size_t face) const {
+      return _face_materials.empty() ? -1 : _face_materials[face];
+    }
+
+  private:
+
+    struct WeldKey {
+      int64_t position[3];
+      uint32_t normal[3];
+      uint32_t uv[2];
+      uint32_t unused;
+    };
+
+    static uint32_t Bits(float value) {
+      // +0 and -0 must weld
+      value = value + 0.0f;
+      uint32_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+      return bits;
+    }
+
+    static int64_t Quantize(float value, float tolerance) {
+      if (tolerance > 0.0f) {
+        return static_cast<int64_t>(std::llround(static_cast<double>(value) / tolerance));
+      }
+      return static_cast<int64_t>(Bits(value));
+    }
+
+    /// Vertices are sorted so equal ones are contiguous, cheaper than a hash
+    /// map with millions of vertices. Welded vertices keep the order
+    /// of their first occurrence.
+    void Weld(float tolerance) {
+      const auto &vertices = _mesh.GetVertices();
+      const auto &normals = _mesh.GetNormals();
+      const auto &uvs = _mesh.GetUVs();
+      std::vector<WeldKey> keys(vertices.size());
+      std::memset(keys.data(), 0, keys.size() * sizeof(WeldKey));
+      for (size_t i = 0u; i < vertices.size(); ++i) {
+        auto &key = keys[i];
+        key.position[0] = Quantize(vertices[i].x, tolerance);
+        key.position[1] = Quantize(vertices[i].y, tolerance);
+        key.position[2] = Quantize(vertices[i].z, tolerance);
+        if (_has_normals) {
+          key.normal[0] = Bits(normals[i].x);
+          key.normal[1] = Bits(normals[i].y);
+          key.normal[2] = Bits(normals[i].z);
+        }
+        if (_has_uvs) {
+          key.uv[0] = Bits(uvs[i].x);
+          key.uv[1] = Bits(uvs[i].y);
+        }
+      }
+      auto equal = [&keys](uint32_t lhs, uint32_t rhs) {
+        return std::memcmp(&keys[lhs], &keys[rhs], sizeof(WeldKey)) == 0;
+      };
+      // sorted by hash first, comparing the keys only when the hashes match
+      std::vector<std::pair<uint64_t, uint32_t>> sorted(vertices.size());
+      for (size_t i = 0u; i < sorted.size(); ++i) {
+        Fnv1aHash hash;
+        hash.Update(&keys[i], sizeof(WeldKey));
+        sorted[i] = {hash.Get(), static_cast<uint32_t>(i)};
+      }
+      std::sort(sorted.begin(), sorted.end(), [&keys](const auto &lhs, const auto &rhs) {
+        if (lhs.first != rhs.first) {
+          return lhs.first < rhs.first;
+        }
+        const int result = std::memcmp(&keys[lhs.second], &keys[rhs.second], sizeof(WeldKey));
+        return result < 0 || (result == 0 && lhs.second < rhs.second);
+      });
+      // first occurrence of each vertex, the first one of its run
+      std::vector<uint32_t> first(vertices.size());
+      for (size_t i = 0u; i < sorted.size(); ++i) {
+        const uint32_t vertex = sorted[i].second;
+        const bool starts_run = i == 0u || !equal(sorted[i - 1u].second, vertex);
+        first[vertex] = starts_run ? vertex : first[sorted[i - 1u].second];
+      }
+      _remap.resize(vertices.size());
+      _source.reserve(vertices.size());
+      for (size_t i = 0u; i < vertices.size(); ++i) {
+        if (first[i] == i) {
+          _remap[i] = static_cast<uint32_t>(_source.size());
+          _source.emplace_back(i);
+        } else {
+          _remap[i] = _remap[first[i]];
+        }
+      }
+    }
+
+    void AssignMaterials() {
+      const auto &materials = _mesh.GetMaterials();
+      if (materials.empty()) {
+        return;
+      }
+      _face_materials.assign(GetFaceCount(), -1);
+      for (const auto &material : materials) {
+        const auto found = std::find(_materials.begin(), _materials.end(), material.name);
+        const int index = static_cast<int>(found - _materials.begin());
+        if (found == _materials.end()) {
+          _materials.emplace_back(material.name);
+        }
+        const size_t end = std::min(material.index_end / 3u, _face_materials.size());
+        for (size_t face = material.index_start / 3u; face < end; ++face) {
+          _face_materials[face] = index;
+        }
+      }
+    }
+
+    const Mesh &_mesh;
+
+    const bool _has_normals;
+
+    const bool _has_uvs;
+
+    /// welded vertex of each mesh vertex, empty if not welded
+    std::vector<uint32_t> _remap;
+
+    /// mesh vertex of each welded vertex, empty if not welded
+    std::vector<size_t> _source;
+
+    std::vector<std::string> _materials;
+
+    std::vector<int> _face_materials;
+  };
+
+  bool CanExport(const Mesh &mesh) {
+    return mesh.IsValid() &&
+        mesh.GetVerticesNum() <= std::numeric_limits<uint32_t>::max();
+  }
+
+  bool SaveToFile(const std::string &filename, const std::function<bool(const MeshExporter::WriteCallback &)> &save) {
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out.good()) {
+      return false;
+    }
+    const bool result = save([&out](const unsigned char *data, size_t size) {
+      out.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(size));
+    });
+    out.close();
+    return result && out.good();
+  }
+
+  std::string EscapeJSON(const std::string &str) {
+    std::ostringstream out;
+    for (const char c : str) {
+      switch (c) {
+        case '"':  out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        case '\r': out << "\\r"; break;
+        case '\t': out << "\\t"; break;
+        default:
+          if (static_cast<unsigned char>(c) < 0x20u) {
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                << static_cast<int>(static_cast<unsigned char>(c)) << std::dec;
+          } else {
+            out << c;
+          }
+      }
+    }
+    return out.str();
+  }
+
+  // glTF component types and buffer view targets.
+  constexpr int GLTF_FLOAT = 5126;
+  constexpr int GLTF_UNSIGNED_INT = 5125;
+  constexpr int GLTF_ARRAY_BUFFER = 34962;
+  constexpr int GLTF_ELEMENT_ARRAY_BUFFER = 34963;
+  constexpr int GLTF_POINTS = 0;
+  constexpr int GLTF_TRIANGLES = 4;
+
+  /// Part of the glTF buffer, with a single accessor.
+  struct GLTFView {
+    size_t offset;
+    size_t count;
+    const char *type;
+    int component_type;
+    int target;
+    size_t stride;
+  };
+
+} // namespace
+
+  bool MeshExporter::WritePLY(
+      const Mesh &mesh,
+      const WriteCallback &write,
+      const MeshExportOptions &options) {
+    if (!CanExport(mesh)) {
+      return false;
+    }
+    const ExportData data(mesh, options);
+    const auto &materials = data.GetMaterials();
+
+    std::ostringstream header;
+    header << "ply\n"
+           << "format binary_little_endian 1.0\n"
+           << "comment Generated by CARLA\n";
+    for (size_t i = 0u; i < materials.size(); ++i) {
+      header << "comment material " << i << ' ' << materials[i] << '\n';
+    }
+    header << "element vertex " << data.GetVertexCount() << '\n'
+           << "property float x\n"
+           << "property float y\n"
+           << "property float z\n";
+    if (data.HasNormals()) {
+      header << "property float nx\n"
+             << "property float ny\n"
+             << "property float nz\n";
+    }
+    if (data.HasUVs()) {
+      header << "property float s\n"
+             << "property float t\n";
+    }
+    header << "element face " << data.GetFaceCount() << '\n'
+           << "property list uchar uint vertex_indices\n";
+    if (!materials.empty()) {
+      header << "property short material_index\n";
+    }
+    header << "end_header\n";
+
+    ChunkWriter out(write, options.chunk_size);
+    out.Write(header.str());
+
+    const auto &vertices = mesh.GetVertices();
+    const auto &normals = mesh.GetNormals();
+    const auto &uvs = mesh.GetUVs();
+    for (size_t i = 0u; i < data.GetVertexCount(); ++i) {
+      const size_t source = data.GetSource(i);
+      const auto &v = vertices[source];
+      const float position[3] = {v.x, v.y, v.z};
+      out.Write(position);
+      if (data.HasNormals()) {
+        const auto &n = normals[source];
+        const float normal[3] = {n.x, n.y, n.z};
+        out.Write(normal);
+      }
+      if (data.HasUVs()) {
+        const float uv[2] = {uvs[source].x, uvs[source].y};
+        out.Write(uv);
+      }
+    }
+
+    for (size_t face = 0u; face < data.GetFaceCount(); ++face) {
+      out.Write(static_cast<uint8_t>(3u));
+      const uint32_t indices[3] = {
+          data.GetIndex(3u * face),
+          data.GetIndex(3u * face + 1u),
+          data.GetIndex(3u * face + 2u)};
+      out.Write(indices);
+      if (!materials.empty()) {
+        out.Write(static_cast<int16_t>(data.GetFaceMaterial(face)));
+      }
+    }
+
+    out.Flush();
+    return true;
+  }
+
+  bool MeshExporter::SavePLY(
+      const Mesh &mesh,
+      const std::string &filename,
+      const MeshExportOptions &options) {
+    return SaveToFile(filename, [&](const WriteCallback &write) {
+      return WritePLY(mesh, write, options);
+    });
+  }
+
+  bool MeshExporter::WriteGLTF(
+      const Mesh &mesh,
+      const std::string &buffer_uri,
+      const WriteCallback &write_json,
+      const WriteCallback &write_buffer,
+      const MeshExportOptions &options) {
+    if (!CanExport(mesh)) {
+      return false;
+    }
+    const ExportData data(mesh, options);
+    const size_t vertex_count = data.GetVertexCount();
+    const size_t face_count = data.GetFaceCount();
+    const auto &materials = data.GetMaterials();
+
+    // Faces sorted by material, faces without one go last. Each group becomes
+    // a primitive.
+    const size_t group_count = materials.size() + 1u;
+    auto group_of = [&](size_t face) {
+      const int material = data.GetFaceMaterial(face);
+      return material < 0 ? materials.size() : static_cast<size_t>(material);
+    };
+    std::vector<size_t> group_start(group_count + 1u, 0u);
+    for (size_t face = 0u; face < face_count; ++face) {
+      ++group_start[group_of(face) + 1u];
+    }
+    for (size_t group = 0u; group < group_count; ++group) {
+      group_start[group + 1u] += group_start[group];
+    }
+    std::vector<size_t> sorted_faces(face_count);
+    {
+      std::vector<size_t> next(group_start.begin(), group_start.end() - 1);
+      for (size_t face = 0u; face < face_count; ++face) {
+        sorted_faces[next[group_of(face)]++] = face;
+      }
+    }
+
+    // Layout of the buffer: positions, normals, uvs and the indices of each
+    // group, all of them 4 bytes aligned.
+    std::vector<GLTFView> views;
+    size_t offset = 0u;
+    auto add_view = [&](size_t count, const char *type, size_t components, int component_type, int target) {
+      views.push_back({offset, count, type, component_type, target, 0u});
+      if (target == GLTF_ARRAY_BUFFER) {
+        views.back().stride = 4u * components;
+      }
+      offset += 4u * components * count;
+    };
+    add_view(vertex_count, "VEC3", 3u, GLTF_FLOAT, GLTF_ARRAY_BUFFER);
+    if (data.HasNormals()) {
+      add_view(vertex_count, "VEC3", 3u, GLTF_FLOAT, GLTF_ARRAY_BUFFER);
+    }
+    if (data.HasUVs()) {
+      add_view(vertex_count, "VEC2", 2u, GLTF_FLOAT, GLTF_ARRAY_BUFFER);
+    }
+    std::vector<int> group_view(group_count, -1);
+    for (size_t group = 0u; group < group_count; ++group) {
+      const size_t count = group_start[group + 1u] - group_start[group];
+      if (count > 0u) {
+        group_view[group] = static_cast<int>(views.size());
+        add_view(3u * count, "SCALAR", 1u, GLTF_UNSIGNED_INT, GLTF_ELEMENT_ARRAY_BUFFER);
+      }
+    }
+    const size_t buffer_size = offset;
+
+    // glTF is right-handed with y up: swap y and z, and the winding with them.
+    const auto &vertices = mesh.GetVertices();
+    const auto &normals = mesh.GetNormals();
+    const auto &uvs = mesh.GetUVs();
+    float min[3] = {0.0f, 0.0f, 0.0f};
+    float max[3] = {0.0f, 0.0f, 0.0f};
+    {
+      ChunkWriter out(write_buffer, options.chunk_size);
+      for (size_t i = 0u; i < vertex_count; ++i) {
+        const auto &v = vertices[data.GetSource(i)];
+        const float position[3] = {v.x, v.z, v.y};
+        for (size_t axis = 0u; axis < 3u; ++axis) {
+          min[axis] = i == 0u ? position[axis] : std::min(min[axis], position[axis]);
+          max[axis] = i == 0u ? position[axis] : std::max(max[axis], position[axis]);
+        }
+        out.Write(position);
+      }
+      if (data.HasNormals()) {
+        for (size_t i = 0u; i < vertex_count; ++i) {
+          const auto &n = normals[data.GetSource(i)];
+          const float normal[3] = {n.x, n.z, n.y};
+          out.Write(normal);
+        }
+      }
+      if (data.HasUVs()) {
+        // glTF has the origin of the uvs in the top left corner
+        for (size_t i = 0u; i < vertex_count; ++i) {
+          const auto &uv = uvs[data.GetSource(i)];
+          const float st[2] = {uv.x, 1.0f - uv.y};
+          out.Write(st);
+        }
+      }
+      for (const size_t face : sorted_faces) {
+        const uint32_t indices[3] = {
+            data.GetIndex(3u * face),
+            data.GetIndex(3u * face + 2u),
+            data.GetIndex(3u * face + 1u)};
+        out.Write(indices);
+      }
+      out.Flush();
+    }
+
+    std::ostringstream json;
+    json << std::setprecision(std::numeric_limits<float>::max_digits10);
+    json << "{\"asset\":{\"version\":\"2.0\",\"generator\":\"CARLA\"},"
+         << "\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}],"
+         << "\"meshes\":[{\"primitives\":[";
+    bool first = true;
+    auto write_attributes = [&]() {
+      json << "\"attributes\":{\"POSITION\":0";
+      size_t accessor = 1u;
+      if (data.HasNormals()) {
+        json << ",\"NORMAL\":" << accessor++;
+      }
+      if (data.HasUVs()) {
+        json << ",\"TEXCOORD_0\":" << accessor++;
+      }
+      json << '}';
+    };
+    for (size_t group = 0u; group < group_count; ++group) {
+      if (group_view[group] < 0) {
+        continue;
+      }
+      json << (first ? "{" : ",{");
+      first = false;
+      write_attributes();
+      json << ",\"indices\":" << group_view[group];
+      if (group < materials.size()) {
+        json << ",\"material\":" << group;
+      }
+      json << ",\"mode\":" << GLTF_TRIANGLES << '}';
+    }
+    if (first) {
+      // a mesh without faces is a point cloud
+      json << '{';
+      write_attributes();
+      json << ",\"mode\":" << GLTF_POINTS << '}';
+    }
+    json << "]}]";
+
+    if (!materials.empty()) {
+      json << ",\"materials\":[";
+      for (size_t i = 0u; i < materials.size(); ++i) {
+        json << (i == 0u ? "" : ",") << "{\"name\":\"" << EscapeJSON(materials[i]) << "\"}";
+      }
+      json << ']';
+    }
+
+    json << ",\"buffers\":[{\"uri\":\"" << EscapeJSON(buffer_uri)
+         << "\",\"byteLength\":" << buffer_size << "}]";
+
+    json << ",\"bufferViews\":[";
+    for (size_t i = 0u; i < views.size(); ++i) {
+      const auto &view = views[i];
+      const size_t next = i + 1u < views.size() ? views[i + 1u].offset : buffer_size;
+      json << (i == 0u ? "" : ",")
+           << "{\"buffer\":0,\"byteOffset\":" << view.offset
+           << ",\"byteLength\":" << (next - view.offset);
+      if (view.stride > 0u) {
+        json << ",\"byteStride\":" << view.stride;
+      }
+      json << ",\"target\":" << view.target << '}';
+    }
+    json << ']';
+
+    json << ",\"accessors\":[";
+    for (size_t i = 0u; i < views.size(); ++i) {
+      const auto &view = views[i];
+      json << (i == 0u ? "" : ",")
+           << "{\"bufferView\":" << i
+           << ",\"componentType\":" << view.component_type
+           << ",\"count\":" << view.count
+           << ",\"type\":\"" << view.type << '"';
+      if (i == 0u) {
+        json << ",\"min\":[" << min[0] << ',' << min[1] << ',' << min[2] << ']'
+             << ",\"max\":[" << max[0] << ',' << max[1] << ',' << max[2] << ']';
+      }
+      json << '}';
+    }
+    json << "]}";
+
+    ChunkWriter out(write_json, options.chunk_size);
+    out.Write(json.str());
+    out.Flush();
+    return true;
+  }
+
+  bool MeshExporter::SaveGLTF(
+      const Mesh &mesh,
+      const std::string &filename,
+      const MeshExportOptions &options) {
+    const size_t name_start = filename.find_last_of("/\\") + 1u;
+    size_t extension = filename.find_last_of('.');
+    if (extension == std::string::npos || extension < name_start) {
+      extension = filename.size();
+    }
+    const std::string buffer_filename = filename.substr(0u, extension) + ".bin";
+    const std::string buffer_uri = buffer_filename.substr(name_start);
+
+    std::ofstream buffer(buffer_filename, std::ios::binary | std::ios::trunc);
+    if (!buffer.good()) {
+      return false;
+    }
+    const bool result = SaveToFile(filename, [&](const WriteCallback &write_json) {
+      return WriteGLTF(mesh, buffer_uri, write_json,
+          [&buffer](const unsigned char *data, size_t size) {
+            buffer.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(size));
+          },
+          options);
+    });
+    buffer.close();
+    return result && buffer.good();
+  }
+
+} // namespace geom
+} // namespace carla
@@ -0,0 +1,74 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/geom/Mesh.h"
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace carla {
+namespace geom {
+
+  struct MeshExportOptions {
+    /// Merge the vertices with the same position, normal and uv, as the ones
+    /// repeated by Mesh::AddTriangleStrip between consecutive strips.
+    bool weld_vertices = false;
+    /// Positions are snapped to a grid of this size, in meters, before being
+    /// compared. Zero welds only identical vertices.
+    float weld_tolerance = 0.0f;
+    /// Maximum size of the chunks given to the write callback.
+    size_t chunk_size = 1u << 20;
+  };
+
+  /// Binary exporters of a Mesh that stream their output in chunks, instead
+  /// of formatting the whole mesh as text in memory as Mesh::GenerateOBJ does.
+  ///
+  /// Faces keep the material of the Mesh::AddMaterial range they belong to;
+  /// materials with the same name are exported as a single one.
+  class MeshExporter {
+  public:
+
+    /// Receives the exported bytes, in order.
+    using WriteCallback = std::function<void(const unsigned char *data, size_t size)>;
+
+    /// Binary little-endian PLY, in Unreal space as Mesh::GenerateOBJ. The
+    /// material names are listed in "comment material <index> <name>" lines
+    /// and each face has the index of its material, -1 if none. Returns false
+    /// if the mesh is not valid.
+    static bool WritePLY(
+        const Mesh &mesh,
+        const WriteCallback &write,
+        const MeshExportOptions &options = MeshExportOptions());
+
+    static bool SavePLY(
+        const Mesh &mesh,
+        const std::string &filename,
+        const MeshExportOptions &options = MeshExportOptions());
+
+    /// glTF 2.0, right-handed with y up: @a write_json receives the document,
+    /// referencing a buffer with uri @a buffer_uri whose content is given to
+    /// @a write_buffer. Each material is a primitive of a single mesh. Returns
+    /// false if the mesh is not valid.
+    static bool WriteGLTF(
+        const Mesh &mesh,
+        const std::string &buffer_uri,
+        const WriteCallback &write_json,
+        const WriteCallback &write_buffer,
+        const MeshExportOptions &options = MeshExportOptions());
+
+    /// Writes @a filename and, next to it, the buffer with the same name and
+    /// ".bin" extension.
+    static bool SaveGLTF(
+        const Mesh &mesh,
+        const std::string &filename,
+        const MeshExportOptions &options = MeshExportOptions());
+  };
+
+} // namespace geom
+} // namespace carla
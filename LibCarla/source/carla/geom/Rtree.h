@@ -102,6 +102,18 @@ namespace geom {
       _rtree.insert(elements.begin(), elements.end());
     }
 
+    /// Replace the content of the tree with the elements in [first, last),
+    /// built at once with the packing algorithm.
+    template <typename Iterator>
+    void BulkLoad(Iterator first, Iterator last) {
+      _rtree = RtreeType(first, last);
+    }
+
+    /// Return a copy of all the elements in the tree, in no particular order.
+    std::vector<TreeElement> GetElements() const {
+      return std::vector<TreeElement>(_rtree.begin(), _rtree.end());
+    }
+
     /// Return nearest neighbors with a user defined filter.
     /// The filter reveices as an argument a TreeElement value and needs to
     /// return a bool to accept or reject the value
@@ -146,7 +158,9 @@ namespace geom {
 
   private:
 
-    boost::geometry::index::rtree<TreeElement, boost::geometry::index::linear<16>> _rtree;
+    using RtreeType = boost::geometry::index::rtree<TreeElement, boost::geometry::index::linear<16>>;
+
+    RtreeType _rtree;
 
   };
 
@@ -0,0 +1,374 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/image/ColorConverterKernels.h"
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#  define LIBCARLA_COLOR_KERNELS_X86_64
+#  include <immintrin.h>
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#    define LIBCARLA_TARGET_AVX2
+#  else
+#    define LIBCARLA_TARGET_AVX2 __attribute__((target("avx2")))
+#  endif
+#endif
+
+namespace carla {
+namespace image {
+
+  using Color = sensor::data::Color;
+  using InstructionSet = ColorConverterKernels::InstructionSet;
+
+  // The vectorized kernels load the pixels as little-endian 32-bit integers.
+  static_assert(sizeof(Color) == sizeof(uint32_t), "Invalid color size!");
+
+  namespace {
+
+    constexpr float MAX_DEPTH = static_cast<float>(256 * 256 * 256 - 1);
+
+    // =========================================================================
+    // -- Scalar ---------------------------------------------------------------
+    // =========================================================================
+
+    // These follow the arithmetic of the Boost.GIL converters, including the
+    // rounding of channel_convert from float to uint8_t.
+
+    uint8_t ToChannel(float value) {
+      return static_cast<uint8_t>(value * 255.0f + 0.5f);
+    }
+
+    Color ToGray(uint8_t value) {
+      return Color{value, value, value, 255u};
+    }
+
+    float NormalizedDepth(const Color &color) {
+      const float depth = static_cast<float>(color.r + (color.g * 256) + (color.b * 256 * 256));
+      return depth / MAX_DEPTH;
+    }
+
+    float LogarithmicLinear(float normalized) {
+      const float value = 1.0f + std::log(normalized) / 5.70378f;
+      return std::max(std::min(value, 1.0f), 0.005f);
+    }
+
+    void DepthScalar(Color *begin, Color *end) {
+      for (; begin != end; ++begin) {
+        *begin = ToGray(ToChannel(NormalizedDepth(*begin)));
+      }
+    }
+
+    void LogarithmicDepthScalar(Color *begin, Color *end) {
+      for (; begin != end; ++begin) {
+        *begin = ToGray(ToChannel(LogarithmicLinear(NormalizedDepth(*begin))));
+      }
+    }
+
+    /// The palette of every possible tag, already in BGRA.
+    const std::array<Color, 256u> &GetPaletteTable() {
+      static const auto table = []() {
+        std::array<Color, 256u> result;
+        for (auto tag = 0u; tag < result.size(); ++tag) {
+          const auto color = CityScapesPalette::GetColor(static_cast<uint8_t>(tag));
+          result[tag] = Color{color[0u], color[1u], color[2u], 255u};
+        }
+        return result;
+      }();
+      return table;
+    }
+
+    void CityScapesPaletteScalar(Color *begin, Color *end) {
+      const auto &table = GetPaletteTable();
+      for (; begin != end; ++begin) {
+        *begin = table[begin->r];
+      }
+    }
+
+#ifdef LIBCARLA_COLOR_KERNELS_X86_64
+
+    // =========================================================================
+    // -- SSE2 -----------------------------------------------------------------
+    // =========================================================================
+
+    // Logarithm polynomial of Cephes' logf, accurate to a couple of ulps for
+    // the normalized depths.
+    constexpr float LOG_SQRTHF = 0.707106781186547524f;
+    constexpr float LOG_P0 = 7.0376836292E-2f;
+    constexpr float LOG_P1 = -1.1514610310E-1f;
+    constexpr float LOG_P2 = 1.1676998740E-1f;
+    constexpr float LOG_P3 = -1.2420140846E-1f;
+    constexpr float LOG_P4 = 1.4249322787E-1f;
+    constexpr float LOG_P5 = -1.6668057665E-1f;
+    constexpr float LOG_P6 = 2.0000714765E-1f;
+    constexpr float LOG_P7 = -2.4999993993E-1f;
+    constexpr float LOG_P8 = 3.3333331174E-1f;
+    constexpr float LOG_Q1 = -2.12194440e-4f;
+    constexpr float LOG_Q2 = 0.693359375f;
+
+    /// Decode four BGRA pixels into their normalized depth.
+    __m128 NormalizedDepthSSE2(__m128i pixels) {
+      const __m128i byte = _mm_set1_epi32(0xFF);
+      const __m128i r = _mm_and_si128(_mm_srli_epi32(pixels, 16), byte);
+      const __m128i g = _mm_and_si128(pixels, _mm_set1_epi32(0xFF00));
+      const __m128i b = _mm_slli_epi32(_mm_and_si128(pixels, byte), 16);
+      const __m128i depth = _mm_or_si128(_mm_or_si128(r, g), b);
+      return _mm_div_ps(_mm_cvtepi32_ps(depth), _mm_set1_ps(MAX_DEPTH));
+    }
+
+    /// Round four values in [0, 1] to channels and expand them to gray BGRA.
+    __m128i ToGraySSE2(__m128 value) {
+      const __m128i channel = _mm_cvttps_epi32(
+          _mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+      const __m128i gray = _mm_or_si128(
+          _mm_or_si128(channel, _mm_slli_epi32(channel, 8)),
+          _mm_slli_epi32(channel, 16));
+      return _mm_or_si128(gray, _mm_set1_epi32(static_cast<int>(0xFF000000u)));
+    }
+
+    /// Natural logarithm of four positive normal floats.
+    __m128 LogSSE2(__m128 x) {
+      const __m128 one = _mm_set1_ps(1.0f);
+      const __m128i bits = _mm_castps_si128(x);
+      __m128 e = _mm_add_ps(
+          _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(0x7F))),
+          one);
+      // Mantissa in [0.5, 1).
+      x = _mm_castsi128_ps(_mm_or_si128(
+          _mm_and_si128(bits, _mm_set1_epi32(~0x7F800000)),
+          _mm_castps_si128(_mm_set1_ps(0.5f))));
+      const __m128 mask = _mm_cmplt_ps(x, _mm_set1_ps(LOG_SQRTHF));
+      e = _mm_sub_ps(e, _mm_and_ps(one, mask));
+      x = _mm_add_ps(_mm_sub_ps(x, one), _mm_and_ps(x, mask));
+      const __m128 z = _mm_mul_ps(x, x);
+      __m128 y = _mm_set1_ps(LOG_P0);
+      y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(LOG_P1));
+      y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(LOG_P2));
+      y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(LOG_P3));
+      y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(LOG_P4));
+      y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(LOG_P5));
+      y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(LOG_P6));
+      y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(LOG_P7));
+      y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(LOG_P8));
+      y = _mm_mul_ps(_mm_mul_ps(y, x), z);
+      y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(LOG_Q1)));
+      y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+      return _mm_add_ps(_mm_add_ps(x, y), _mm_mul_ps(e, _mm_set1_ps(LOG_Q2)));
+    }
+
+    void DepthSSE2(Color *begin, Color *end) {
+      for (; end - begin >= 4; begin += 4) {
+        auto *data = reinterpret_cast<__m128i *>(begin);
+        const __m128 normalized = NormalizedDepthSSE2(_mm_loadu_si128(data));
+        _mm_storeu_si128(data, ToGraySSE2(normalized));
+      }
+      DepthScalar(begin, end);
+    }
+
+    void LogarithmicDepthSSE2(Color *begin, Color *end) {
+      for (; end - begin >= 4; begin += 4) {
+        auto *data = reinterpret_cast<__m128i *>(begin);
+        // A depth of zero goes to the lower clamp as -infinity would.
+        const __m128 normalized = _mm_max_ps(
+            NormalizedDepthSSE2(_mm_loadu_si128(data)),
+            _mm_set1_ps(FLT_MIN));
+        const __m128 value = _mm_add_ps(
+            _mm_set1_ps(1.0f),
+            _mm_div_ps(LogSSE2(normalized), _mm_set1_ps(5.70378f)));
+        const __m128 clamped = _mm_max_ps(
+            _mm_min_ps(value, _mm_set1_ps(1.0f)),
+            _mm_set1_ps(0.005f));
+        _mm_storeu_si128(data, ToGraySSE2(clamped));
+      }
+      LogarithmicDepthScalar(begin, end);
+    }
+
+    // SSE2 has no gather, the scalar table lookup is used instead.
+
+    // =========================================================================
+    // -- AVX2 -----------------------------------------------------------------
+    // =========================================================================
+
+    LIBCARLA_TARGET_AVX2 __m256 NormalizedDepthAVX2(__m256i pixels) {
+      const __m256i byte = _mm256_set1_epi32(0xFF);
+      const __m256i r = _mm256_and_si256(_mm256_srli_epi32(pixels, 16), byte);
+      const __m256i g = _mm256_and_si256(pixels, _mm256_set1_epi32(0xFF00));
+      const __m256i b = _mm256_slli_epi32(_mm256_and_si256(pixels, byte), 16);
+      const __m256i depth = _mm256_or_si256(_mm256_or_si256(r, g), b);
+      return _mm256_div_ps(_mm256_cvtepi32_ps(depth), _mm256_set1_ps(MAX_DEPTH));
+    }
+
+    LIBCARLA_TARGET_AVX2 __m256i ToGrayAVX2(__m256 value) {
+      const __m256i channel = _mm256_cvttps_epi32(
+          _mm256_add_ps(_mm256_mul_ps(value, _mm256_set1_ps(255.0f)), _mm256_set1_ps(0.5f)));
+      const __m256i gray = _mm256_or_si256(
+          _mm256_or_si256(channel, _mm256_slli_epi32(channel, 8)),
+          _mm256_slli_epi32(channel, 16));
+      return _mm256_or_si256(gray, _mm256_set1_epi32(static_cast<int>(0xFF000000u)));
+    }
+
+    LIBCARLA_TARGET_AVX2 __m256 LogAVX2(__m256 x) {
+      const __m256 one = _mm256_set1_ps(1.0f);
+      const __m256i bits = _mm256_castps_si256(x);
+      __m256 e = _mm256_add_ps(
+          _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(0x7F))),
+          one);
+      x = _mm256_castsi256_ps(_mm256_or_si256(
+          _mm256_and_si256(bits, _mm256_set1_epi32(~0x7F800000)),
+          _mm256_castps_si256(_mm256_set1_ps(0.5f))));
+      const __m256 mask = _mm256_cmp_ps(x, _mm256_set1_ps(LOG_SQRTHF), _CMP_LT_OS);
+      e = _mm256_sub_ps(e, _mm256_and_ps(one, mask));
+      x = _mm256_add_ps(_mm256_sub_ps(x, one), _mm256_and_ps(x, mask));
+      const __m256 z = _mm256_mul_ps(x, x);
+      __m256 y = _mm256_set1_ps(LOG_P0);
+      y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(LOG_P1));
+      y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(LOG_P2));
+      y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(LOG_P3));
+      y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(LOG_P4));
+      y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(LOG_P5));
+      y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(LOG_P6));
+      y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(LOG_P7));
+      y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(LOG_P8));
+      y = _mm256_mul_ps(_mm256_mul_ps(y, x), z);
+      y = _mm256_add_ps(y, _mm256_mul_ps(e, _mm256_set1_ps(LOG_Q1)));
+      y = _mm256_sub_ps(y, _mm256_mul_ps(z, _mm256_set1_ps(0.5f)));
+      return _mm256_add_ps(_mm256_add_ps(x, y), _mm256_mul_ps(e, _mm256_set1_ps(LOG_Q2)));
+    }
+
+    LIBCARLA_TARGET_AVX2 void DepthAVX2(Color *begin, Color *end) {
+      for (; end - begin >= 8; begin += 8) {
+        auto *data = reinterpret_cast<__m256i *>(begin);
+        const __m256 normalized = NormalizedDepthAVX2(_mm256_loadu_si256(data));
+        _mm256_storeu_si256(data, ToGrayAVX2(normalized));
+      }
+      DepthScalar(begin, end);
+    }
+
+    LIBCARLA_TARGET_AVX2 void LogarithmicDepthAVX2(Color *begin, Color *end) {
+      for (; end - begin >= 8; begin += 8) {
+        auto *data = reinterpret_cast<__m256i *>(begin);
+        const __m256 normalized = _mm256_max_ps(
+            NormalizedDepthAVX2(_mm256_loadu_si256(data)),
+            _mm256_set1_ps(FLT_MIN));
+        const __m256 value = _mm256_add_ps(
+            _mm256_set1_ps(1.0f),
+            _mm256_div_ps(LogAVX2(normalized), _mm256_set1_ps(5.70378f)));
+        const __m256 clamped = _mm256_max_ps(
+            _mm256_min_ps(value, _mm256_set1_ps(1.0f)),
+            _mm256_set1_ps(0.005f));
+        _mm256_storeu_si256(data, ToGrayAVX2(clamped));
+      }
+      LogarithmicDepthScalar(begin, end);
+    }
+
+    LIBCARLA_TARGET_AVX2 void CityScapesPaletteAVX2(Color *begin, Color *end) {
+      const auto *table = reinterpret_cast<const int *>(GetPaletteTable().data());
+      for (; end - begin >= 8; begin += 8) {
+        auto *data = reinterpret_cast<__m256i *>(begin);
+        const __m256i tags = _mm256_and_si256(
+            _mm256_srli_epi32(_mm256_loadu_si256(data), 16),
+            _mm256_set1_epi32(0xFF));
+        _mm256_storeu_si256(data, _mm256_i32gather_epi32(table, tags, 4));
+      }
+      CityScapesPaletteScalar(begin, end);
+    }
+
+    bool CPUSupportsAVX2() {
+#ifdef _MSC_VER
+      int info[4];
+      __cpuid(info, 1);
+      const bool os_saves_avx =
+          ((info[2] & (1 << 27)) != 0) &&   // OSXSAVE
+          ((info[2] & (1 << 28)) != 0) &&   // AVX
+          ((_xgetbv(0) & 0x6) == 0x6);      // XMM and YMM state
+      if (!os_saves_avx) {
+        return false;
+      }
+      __cpuidex(info, 7, 0);
+      return (info[1] & (1 << 5)) != 0;
+#else
+      return __builtin_cpu_supports("avx2");
+#endif // _MSC_VER
+    }
+
+#endif // LIBCARLA_COLOR_KERNELS_X86_64
+
+    InstructionSet DetectInstructionSet() {
+#ifdef LIBCARLA_COLOR_KERNELS_X86_64
+      return CPUSupportsAVX2() ? InstructionSet::AVX2 : InstructionSet::SSE2;
+#else
+      return InstructionSet::Scalar;
+#endif // LIBCARLA_COLOR_KERNELS_X86_64
+    }
+
+    InstructionSet Supported(InstructionSet requested) {
+      const auto best = ColorConverterKernels::GetInstructionSet();
+      return static_cast<int>(requested) < static_cast<int>(best) ? requested : best;
+    }
+
+  } // namespace
+
+  ColorConverterKernels::InstructionSet ColorConverterKernels::GetInstructionSet() {
+    static const InstructionSet instruction_set = DetectInstructionSet();
+    return instruction_set;
+  }
+
+  const char *ColorConverterKernels::GetInstructionSetName(InstructionSet instruction_set) {
+    switch (instruction_set) {
+      case InstructionSet::SSE2: return "SSE2";
+      case InstructionSet::AVX2: return "AVX2";
+      default:                   return "Scalar";
+    }
+  }
+
+  void ColorConverterKernels::ConvertInPlace(
+      Color *begin,
+      Color *end,
+      ColorConverter::Depth,
+      InstructionSet instruction_set) {
+    switch (Supported(instruction_set)) {
+#ifdef LIBCARLA_COLOR_KERNELS_X86_64
+      case InstructionSet::AVX2: return DepthAVX2(begin, end);
+      case InstructionSet::SSE2: return DepthSSE2(begin, end);
+#endif // LIBCARLA_COLOR_KERNELS_X86_64
+      default:                   return DepthScalar(begin, end);
+    }
+  }
+
+  void ColorConverterKernels::ConvertInPlace(
+      Color *begin,
+      Color *end,
+      ColorConverter::LogarithmicDepth,
+      InstructionSet instruction_set) {
+    switch (Supported(instruction_set)) {
+#ifdef LIBCARLA_COLOR_KERNELS_X86_64
+      case InstructionSet::AVX2: return LogarithmicDepthAVX2(begin, end);
+      case InstructionSet::SSE2: return LogarithmicDepthSSE2(begin, end);
+#endif // LIBCARLA_COLOR_KERNELS_X86_64
+      default:                   return LogarithmicDepthScalar(begin, end);
+    }
+  }
+
+  void ColorConverterKernels::ConvertInPlace(
+      Color *begin,
+      Color *end,
+      ColorConverter::CityScapesPalette,
+      InstructionSet instruction_set) {
+    switch (Supported(instruction_set)) {
+#ifdef LIBCARLA_COLOR_KERNELS_X86_64
+      case InstructionSet::AVX2: return CityScapesPaletteAVX2(begin, end);
+#endif // LIBCARLA_COLOR_KERNELS_X86_64
+      default:                   return CityScapesPaletteScalar(begin, end);
+    }
+  }
+
+} // namespace image
+} // namespace carla
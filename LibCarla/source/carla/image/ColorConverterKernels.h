@@ -0,0 +1,61 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/image/ColorConverter.h"
+#include "carla/sensor/data/Color.h"
+
+namespace carla {
+namespace image {
+
+  /// Color conversions applied in place to contiguous BGRA pixels, as the
+  /// cameras send them. They produce the same pixels as
+  /// ImageConverter::ConvertInPlace on a BGRA view, but process several
+  /// pixels per instruction with the widest instruction set supported by the
+  /// CPU.
+  ///
+  /// Depth and CityScapesPalette are bit-exact with the Boost.GIL converters.
+  /// LogarithmicDepth uses a polynomial approximation of the logarithm in the
+  /// vectorized paths, channels may differ by one where the exact value falls
+  /// on a rounding boundary.
+  class ColorConverterKernels {
+  public:
+
+    enum class InstructionSet {
+      Scalar,
+      SSE2,
+      AVX2
+    };
+
+    /// Widest instruction set supported by this build and this CPU.
+    static InstructionSet GetInstructionSet();
+
+    static const char *GetInstructionSetName(InstructionSet instruction_set);
+
+    /// Convert the pixels in [@a begin, @a end). An @a instruction_set not
+    /// supported is replaced by the widest one supported.
+    static void ConvertInPlace(
+        sensor::data::Color *begin,
+        sensor::data::Color *end,
+        ColorConverter::Depth,
+        InstructionSet instruction_set = GetInstructionSet());
+
+    static void ConvertInPlace(
+        sensor::data::Color *begin,
+        sensor::data::Color *end,
+        ColorConverter::LogarithmicDepth,
+        InstructionSet instruction_set = GetInstructionSet());
+
+    static void ConvertInPlace(
+        sensor::data::Color *begin,
+        sensor::data::Color *end,
+        ColorConverter::CityScapesPalette,
+        InstructionSet instruction_set = GetInstructionSet());
+  };
+
+} // namespace image
+} // namespace carla
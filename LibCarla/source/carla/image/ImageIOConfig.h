@@ -312,6 +312,11 @@ namespace detail {
   template <typename DefaultIO, typename... IOs>
   struct io_any : detail::io_impl<DefaultIO, IOs...> {
     static_assert(DefaultIO::is_supported, "Default IO needs to be supported.");
+
+    /// Extension appended to paths that have none.
+    static constexpr const char *get_default_extension() {
+      return DefaultIO::get_default_extension();
+    }
   };
 
 } // namespace detail
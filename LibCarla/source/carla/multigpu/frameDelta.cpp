@@ -0,0 +1,197 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/multigpu/frameDelta.h"
+
+#include "carla/Logging.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace carla {
+namespace multigpu {
+
+  // Unchanged runs shorter than this are sent as changed bytes, two varints
+  // cost more than the bytes they would save.
+  static constexpr size_t MIN_UNCHANGED_RUN = 4u;
+
+  static void WriteVarint(std::vector<unsigned char> &out, size_t value) {
+    while (value >= 0x80u) {
+      out.push_back(static_cast<unsigned char>(value | 0x80u));
+      value >>= 7u;
+    }
+    out.push_back(static_cast<unsigned char>(value));
+  }
+
+  static bool ReadVarint(const unsigned char *&it, const unsigned char *end, size_t &value) {
+    value = 0u;
+    for (auto shift = 0u; shift < 8u * sizeof(uint32_t); shift += 7u) {
+      if (it == end) {
+        return false;
+      }
+      const auto byte = *it++;
+      value |= static_cast<size_t>(byte & 0x7fu) << shift;
+      if ((byte & 0x80u) == 0u) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  static void WriteHeader(std::vector<unsigned char> &out, const FrameDeltaHeader &header) {
+    const auto *begin = reinterpret_cast<const unsigned char *>(&header);
+    out.insert(out.end(), begin, begin + sizeof(FrameDeltaHeader));
+  }
+
+  // ===========================================================================
+  // -- FrameDeltaEncoder ------------------------------------------------------
+  // ===========================================================================
+
+  Buffer FrameDeltaEncoder::EncodeKeyFrame(const Buffer &frame) const {
+    FrameDeltaHeader header;
+    header.type = FrameDeltaHeader::Type::KeyFrame;
+    header.sequence = _sequence + 1u;
+    header.size = frame.size();
+    Buffer result(sizeof(FrameDeltaHeader) + frame.size());
+    std::memcpy(result.data(), &header, sizeof(FrameDeltaHeader));
+    if (!frame.empty()) {
+      std::memcpy(result.data() + sizeof(FrameDeltaHeader), frame.data(), frame.size());
+    }
+    return result;
+  }
+
+  Buffer FrameDeltaEncoder::EncodeDelta(const Buffer &frame) const {
+    const auto sequence = _sequence + 1u;
+    if ((_sequence == 0u) || ((sequence % KEY_FRAME_INTERVAL) == 0u)) {
+      return Buffer();
+    }
+
+    std::vector<unsigned char> out;
+    out.reserve(sizeof(FrameDeltaHeader) + frame.size() / 4u);
+    FrameDeltaHeader header;
+    header.type = FrameDeltaHeader::Type::Delta;
+    header.sequence = sequence;
+    header.size = frame.size();
+    WriteHeader(out, header);
+
+    const auto *current = frame.data();
+    const auto *reference = _reference.data();
+    const size_t size = frame.size();
+    const size_t common_size = std::min<size_t>(size, _reference.size());
+
+    auto unchanged_run = [&](size_t i) {
+      size_t j = i;
+      while ((j < common_size) && (current[j] == reference[j])) {
+        ++j;
+      }
+      return j - i;
+    };
+
+    size_t i = 0u;
+    while (i < size) {
+      const size_t unchanged = unchanged_run(i);
+      const size_t changed_begin = i + unchanged;
+      size_t changed_end = changed_begin;
+      while (changed_end < size) {
+        const size_t run = unchanged_run(changed_end);
+        if ((run >= MIN_UNCHANGED_RUN) || (changed_end + run == size)) {
+          break;
+        }
+        changed_end += std::max<size_t>(run, 1u);
+      }
+      WriteVarint(out, unchanged);
+      WriteVarint(out, changed_end - changed_begin);
+      out.insert(out.end(), current + changed_begin, current + changed_end);
+      if (out.size() >= sizeof(FrameDeltaHeader) + size) {
+        return Buffer();
+      }
+      i = changed_end;
+    }
+    return Buffer(out);
+  }
+
+  void FrameDeltaEncoder::Advance(Buffer frame) {
+    ++_sequence;
+    // Zero means "no reference", skip it on wrap around.
+    if (_sequence == 0u) {
+      ++_sequence;
+    }
+    _reference = std::move(frame);
+  }
+
+  // ===========================================================================
+  // -- FrameDeltaDecoder ------------------------------------------------------
+  // ===========================================================================
+
+  bool FrameDeltaDecoder::IsEncoded(const Buffer &message) {
+    uint32_t magic = 0u;
+    if (message.size() < sizeof(FrameDeltaHeader)) {
+      return false;
+    }
+    std::memcpy(&magic, message.data(), sizeof(magic));
+    return magic == FrameDeltaHeader::MAGIC;
+  }
+
+  bool FrameDeltaDecoder::Decode(const Buffer &message, Buffer &frame) {
+    if (!IsEncoded(message)) {
+      return false;
+    }
+    FrameDeltaHeader header;
+    std::memcpy(&header, message.data(), sizeof(FrameDeltaHeader));
+    const auto *it = message.data() + sizeof(FrameDeltaHeader);
+    const auto *end = message.data() + message.size();
+
+    if (header.type == FrameDeltaHeader::Type::KeyFrame) {
+      if (static_cast<size_t>(end - it) != header.size) {
+        log_error("multi-gpu: malformed key frame", header.sequence);
+        _has_reference = false;
+        return false;
+      }
+      _reference.assign(it, end);
+    } else if (header.type == FrameDeltaHeader::Type::Delta) {
+      if (!_has_reference || (header.sequence != _sequence + 1u)) {
+        log_error("multi-gpu: missing the reference of frame delta", header.sequence);
+        _has_reference = false;
+        return false;
+      }
+      std::vector<unsigned char> decoded(header.size);
+      size_t i = 0u;
+      while (it != end) {
+        size_t unchanged = 0u;
+        size_t changed = 0u;
+        if (!ReadVarint(it, end, unchanged) ||
+            !ReadVarint(it, end, changed) ||
+            (i + unchanged > std::min(decoded.size(), _reference.size())) ||
+            (i + unchanged + changed > decoded.size()) ||
+            (static_cast<size_t>(end - it) < changed)) {
+          log_error("multi-gpu: malformed frame delta", header.sequence);
+          _has_reference = false;
+          return false;
+        }
+        std::copy_n(_reference.data() + i, unchanged, decoded.data() + i);
+        i += unchanged;
+        std::copy_n(it, changed, decoded.data() + i);
+        it += changed;
+        i += changed;
+      }
+      if (i != decoded.size()) {
+        log_error("multi-gpu: truncated frame delta", header.sequence);
+        _has_reference = false;
+        return false;
+      }
+      _reference = std::move(decoded);
+    } else {
+      log_error("multi-gpu: unknown frame type", static_cast<uint32_t>(header.type));
+      return false;
+    }
+    _has_reference = true;
+    _sequence = header.sequence;
+    frame = Buffer(_reference);
+    return true;
+  }
+
+} // namespace multigpu
+} // namespace carla
@@ -0,0 +1,94 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace carla {
+namespace multigpu {
+
+  /// Header of the frame data sent by the primary server to the secondary
+  /// servers. A key frame carries the whole frame, a delta carries only the
+  /// bytes that changed since the previous frame.
+  struct FrameDeltaHeader {
+    static constexpr uint32_t MAGIC = 0x544c4446u; // "FDLT"
+
+    enum class Type : uint32_t {
+      KeyFrame,
+      Delta
+    };
+
+    uint32_t magic = MAGIC;
+
+    Type type = Type::KeyFrame;
+
+    /// Sequence number of the frame, a delta applies only on top of the frame
+    /// with the previous sequence number.
+    uint32_t sequence = 0u;
+
+    /// Size of the decoded frame.
+    uint32_t size = 0u;
+  };
+
+  static_assert(sizeof(FrameDeltaHeader) == 16u, "Invalid frame delta header size.");
+
+  /// Encodes each frame as the runs of bytes that differ from the previous
+  /// frame. The frame data keeps the actors in the same order between frames,
+  /// so most of a frame matches the previous one at the same offset.
+  ///
+  /// The body of a delta is a sequence of (unchanged length, changed length,
+  /// changed bytes) with the lengths as LEB128 varints.
+  class FrameDeltaEncoder {
+  public:
+
+    /// Frames between two consecutive key frames. A secondary server that
+    /// lost its reference frame recovers on the next key frame.
+    static constexpr uint32_t KEY_FRAME_INTERVAL = 300u;
+
+    /// Encode @a frame as a key frame.
+    Buffer EncodeKeyFrame(const Buffer &frame) const;
+
+    /// Encode @a frame as a delta against the previous frame. Return an empty
+    /// buffer if there is no previous frame, a key frame is due, or the delta
+    /// is not smaller than the frame.
+    Buffer EncodeDelta(const Buffer &frame) const;
+
+    /// Make @a frame the reference of the next one.
+    void Advance(Buffer frame);
+
+  private:
+
+    uint32_t _sequence = 0u;
+
+    Buffer _reference;
+  };
+
+  /// Decodes the frames encoded by FrameDeltaEncoder.
+  class FrameDeltaDecoder {
+  public:
+
+    static bool IsEncoded(const Buffer &message);
+
+    /// Decode @a message into @a frame. Return false if @a message is
+    /// malformed or is a delta against a frame this decoder does not have;
+    /// the decoder then waits for the next key frame.
+    bool Decode(const Buffer &message, Buffer &frame);
+
+  private:
+
+    bool _has_reference = false;
+
+    uint32_t _sequence = 0u;
+
+    std::vector<unsigned char> _reference;
+  };
+
+} // namespace multigpu
+} // namespace carla
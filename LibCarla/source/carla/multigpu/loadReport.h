@@ -0,0 +1,81 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace carla {
+namespace multigpu {
+
+  /// Load of a secondary server, sent unsolicited to the primary server after
+  /// each frame it renders.
+  ///
+  /// The answers to the commands are sent without header on the same channel,
+  /// so a report is identified by its size and its magic number; none of the
+  /// answers has this size.
+  struct LoadReport {
+    static constexpr uint32_t MAGIC = 0x44414f4cu; // "LOAD"
+
+    uint32_t magic = MAGIC;
+
+    /// Frame counter of the secondary server.
+    uint32_t frame = 0u;
+
+    /// Time the secondary server took to play and render its last frame,
+    /// without the time it waited for the frame.
+    uint32_t frame_time_us = 0u;
+
+    /// Frames received from the primary server not yet rendered.
+    uint32_t queue_depth = 0u;
+
+    Buffer ToBuffer() const {
+      return Buffer(reinterpret_cast<const Buffer::value_type *>(this), sizeof(LoadReport));
+    }
+
+    /// Return true and fill @a report if @a buffer holds a load report.
+    static bool FromBuffer(const Buffer &buffer, LoadReport &report) {
+      if (buffer.size() != sizeof(LoadReport)) {
+        return false;
+      }
+      LoadReport result;
+      std::memcpy(&result, buffer.data(), sizeof(LoadReport));
+      if (result.magic != MAGIC) {
+        return false;
+      }
+      report = result;
+      return true;
+    }
+  };
+
+  static_assert(sizeof(LoadReport) == 16u, "Invalid load report size.");
+
+  class Primary;
+
+  /// Load of a secondary server as seen by the primary server.
+  struct SecondaryLoad {
+    std::weak_ptr<Primary> session;
+
+    /// False until the secondary server sends its first report, older
+    /// secondary servers never send them.
+    bool has_report = false;
+
+    /// Last reported frame counter.
+    uint32_t frame = 0u;
+
+    /// Exponential moving average of the reported frame times.
+    float frame_time_ms = 0.0f;
+
+    /// Last reported queue depth.
+    uint32_t queue_depth = 0u;
+  };
+
+} // namespace multigpu
+} // namespace carla
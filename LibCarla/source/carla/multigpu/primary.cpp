@@ -136,7 +136,6 @@ namespace multigpu {
           // Move the buffer to the callback function and start reading the next
           // piece of data.
           self->_on_response(self, message->pop());
-          std::cout << "Getting data on listener\n";
           self->ReadData();
         } else {
           // As usual, if anything fails start over from the very top.
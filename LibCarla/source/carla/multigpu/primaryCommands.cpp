@@ -30,7 +30,9 @@ void PrimaryCommands::set_router(std::shared_ptr<Router> router) {
 
 // broadcast to all secondary servers the frame data
 void PrimaryCommands::SendFrameData(carla::Buffer buffer) {
-  _router->Write(MultiGPUCommand::SEND_FRAME, std::move(buffer));
+  auto delta = _encoder.EncodeDelta(buffer);
+  _router->WriteFrame(std::move(delta), [&]() { return _encoder.EncodeKeyFrame(buffer); });
+  _encoder.Advance(std::move(buffer));
   // log_info("sending frame command");
 }
 
@@ -41,11 +43,11 @@ void PrimaryCommands::SendLoadMap(std::string map) {
 }
 
 // send to who the router wants the request for a token
-token_type PrimaryCommands::SendGetToken(stream_id sensor_id) {
+token_type PrimaryCommands::SendGetToken(std::weak_ptr<Primary> server, stream_id sensor_id) {
   log_info("asking for a token");
   carla::Buffer buf((carla::Buffer::value_type *) &sensor_id,
                     (size_t) sizeof(stream_id));
-  auto fut = _router->WriteToNext(MultiGPUCommand::GET_TOKEN, std::move(buf));
+  auto fut = _router->WriteToOne(server, MultiGPUCommand::GET_TOKEN, std::move(buf));
 
   auto response = fut.get();
   token_type new_token(*reinterpret_cast<carla::streaming::detail::token_data *>(response.buffer.data()));
@@ -110,6 +112,52 @@ bool PrimaryCommands::SendIsEnabledForROS(stream_id sensor_id) {
   }
 }
 
+size_t PrimaryCommands::ChooseLeastLoaded(
+    const std::vector<SecondaryLoad> &loads,
+    const std::vector<size_t> &sensors) {
+  DEBUG_ASSERT(loads.size() == sensors.size());
+  auto cost = [&](size_t i) {
+    const auto &load = loads[i];
+    return load.has_report ?
+        load.frame_time_ms * static_cast<float>(1u + load.queue_depth) :
+        0.0f;
+  };
+  size_t best = loads.size();
+  for (size_t i = 0u; i < loads.size(); ++i) {
+    if ((best == loads.size()) ||
+        (cost(i) < cost(best)) ||
+        ((cost(i) == cost(best)) && (sensors[i] < sensors[best]))) {
+      best = i;
+    }
+  }
+  return best;
+}
+
+std::weak_ptr<Primary> PrimaryCommands::ChooseServer() {
+  if (_placement_policy == PlacementPolicy::RoundRobin) {
+    return _router->GetNextServer();
+  }
+  auto loads = _router->GetLoads();
+  // count the sensors already placed on each secondary server
+  std::vector<size_t> sensors(loads.size(), 0u);
+  for (auto &server : _servers) {
+    auto session = server.second.lock();
+    for (size_t i = 0u; i < loads.size(); ++i) {
+      if (session != nullptr && session == loads[i].session.lock()) {
+        ++sensors[i];
+        break;
+      }
+    }
+  }
+  const auto best = ChooseLeastLoaded(loads, sensors);
+  if (best == loads.size()) {
+    return std::weak_ptr<Primary>();
+  }
+  log_info("placing sensor on secondary server", best,
+      "frame time", loads[best].frame_time_ms, "ms, queue", loads[best].queue_depth);
+  return loads[best].session;
+}
+
 token_type PrimaryCommands::GetToken(stream_id sensor_id) {
   // search if the sensor has been activated in any secondary server
   auto it = _tokens.find(sensor_id);
@@ -120,8 +168,8 @@ token_type PrimaryCommands::GetToken(stream_id sensor_id) {
   }
   else {
     // enable the sensor on one secondary server
-    auto server = _router->GetNextServer();
-    auto token = SendGetToken(sensor_id);
+    auto server = ChooseServer();
+    auto token = SendGetToken(server, sensor_id);
     // add to the maps
     _tokens[sensor_id] = token;
     _servers[sensor_id] = server;
@@ -8,11 +8,16 @@
 
 // #include "carla/Logging.h"
 #include "carla/multigpu/commands.h"
+#include "carla/multigpu/frameDelta.h"
+#include "carla/multigpu/loadReport.h"
 #include "carla/multigpu/primary.h"
 #include "carla/streaming/detail/tcp/Message.h"
 #include "carla/streaming/detail/Token.h"
 #include "carla/streaming/detail/Types.h"
 
+#include <unordered_map>
+#include <vector>
+
 namespace carla {
 namespace multigpu {
 
@@ -23,16 +28,24 @@ using stream_id = carla::streaming::detail::stream_id_type;
 
 class Router;
 
+/// How new sensors are assigned to the secondary servers.
+enum class PlacementPolicy {
+  /// Each secondary server in turn.
+  RoundRobin,
+  /// The secondary server with the lowest reported load.
+  LeastLoaded
+};
+
 class PrimaryCommands {
   public:
 
-
     PrimaryCommands();
     PrimaryCommands(std::shared_ptr<Router> router);
 
     void set_router(std::shared_ptr<Router> router);
 
-    // broadcast to all secondary servers the frame data
+    // broadcast to all secondary servers the frame data, as a delta against
+    // the previous frame when they have it
     void SendFrameData(carla::Buffer buffer);
 
     // broadcast to all secondary servers the map to load
@@ -49,10 +62,29 @@ class PrimaryCommands {
 
     bool IsEnabledForROS(stream_id sensor_id);
 
+    void SetPlacementPolicy(PlacementPolicy policy) {
+      _placement_policy = policy;
+    }
+
+    PlacementPolicy GetPlacementPolicy() const {
+      return _placement_policy;
+    }
+
+    /// Index in @a loads of the secondary server with the lowest load, the
+    /// expected time to render the frames already queued and the next one.
+    /// Ties, and secondary servers that did not report yet, go to the one
+    /// with fewer sensors in @a sensors. Return @a loads.size() if empty.
+    static size_t ChooseLeastLoaded(
+        const std::vector<SecondaryLoad> &loads,
+        const std::vector<size_t> &sensors);
+
   private:
 
+    // choose the secondary server for a new sensor
+    std::weak_ptr<Primary> ChooseServer();
+
     // send to one secondary to get the token of a sensor
-    token_type SendGetToken(carla::streaming::detail::stream_id_type sensor_id);
+    token_type SendGetToken(std::weak_ptr<Primary> server, stream_id sensor_id);
 
     // manage ROS enable/disable of sensor
     void SendEnableForROS(stream_id sensor_id);
@@ -63,6 +95,8 @@ class PrimaryCommands {
     std::shared_ptr<Router> _router;
     std::unordered_map<stream_id, token_type> _tokens;
     std::unordered_map<stream_id, std::weak_ptr<Primary>> _servers;
+    PlacementPolicy _placement_policy = PlacementPolicy::LeastLoaded;
+    FrameDeltaEncoder _encoder;
 };
 
 } // namespace multigpu
@@ -54,6 +54,12 @@ void Router::SetCallbacks() {
       auto self = weak.lock();
       if (!self) return;
       std::lock_guard<std::mutex> lock(self->_mutex);
+      // load reports come unsolicited, they never answer a command
+      LoadReport report;
+      if (LoadReport::FromBuffer(buffer, report)) {
+        self->UpdateLoad(session.get(), report);
+        return;
+      }
       auto prom =self-> _promises.find(session.get());
       if (prom != self->_promises.end()) {
         log_info("Got data from secondary (with promise): ", buffer.size());
@@ -86,6 +92,8 @@ boost::asio::ip::tcp::endpoint Router::GetLocalEndpoint() const {
 void Router::ConnectSession(std::shared_ptr<Primary> session) {
   DEBUG_ASSERT(session != nullptr);
   std::lock_guard<std::mutex> lock(_mutex);
+  _loads[session.get()].session = session;
+  _sessions_without_key_frame.insert(session.get());
   _sessions.emplace_back(std::move(session));
   log_info("Connected secondary servers:", _sessions.size());
   // run external callback for new connections
@@ -97,6 +105,8 @@ void Router::DisconnectSession(std::shared_ptr<Primary> session) {
   DEBUG_ASSERT(session != nullptr);
   std::lock_guard<std::mutex> lock(_mutex);
   if (_sessions.size() == 0) return;
+  _loads.erase(session.get());
+  _sessions_without_key_frame.erase(session.get());
   _sessions.erase(
       std::remove(_sessions.begin(), _sessions.end(), session),
       _sessions.end());
@@ -106,10 +116,14 @@ void Router::DisconnectSession(std::shared_ptr<Primary> session) {
 void Router::ClearSessions() {
   std::lock_guard<std::mutex> lock(_mutex);
   _sessions.clear();
+  _loads.clear();
+  _sessions_without_key_frame.clear();
   log_info("Disconnecting all secondary servers");
 }
 
-void Router::Write(MultiGPUCommand id, Buffer &&buffer) {
+std::shared_ptr<const carla::streaming::detail::tcp::Message> Router::MakeCommandMessage(
+    MultiGPUCommand id,
+    Buffer &&buffer) {
   // define the command header
   CommandHeader header;
   header.id = id;
@@ -119,6 +133,11 @@ void Router::Write(MultiGPUCommand id, Buffer &&buffer) {
   auto view_header = carla::BufferView::CreateFrom(std::move(buf_header));
   auto view_data = carla::BufferView::CreateFrom(std::move(buffer));
   auto message = Primary::MakeMessage(view_header, view_data);
+  return message;
+}
+
+void Router::Write(MultiGPUCommand id, Buffer &&buffer) {
+  auto message = MakeCommandMessage(id, std::move(buffer));
 
   // write to multiple servers
   std::lock_guard<std::mutex> lock(_mutex);
@@ -129,16 +148,36 @@ void Router::Write(MultiGPUCommand id, Buffer &&buffer) {
   }
 }
 
-std::future<SessionInfo> Router::WriteToNext(MultiGPUCommand id, Buffer &&buffer) {
-  // define the command header
-  CommandHeader header;
-  header.id = id;
-  header.size = buffer.size();
-  Buffer buf_header((uint8_t *) &header, sizeof(header));
+void Router::WriteFrame(Buffer &&delta, std::function<Buffer()> make_key_frame) {
+  std::shared_ptr<const carla::streaming::detail::tcp::Message> delta_message;
+  std::shared_ptr<const carla::streaming::detail::tcp::Message> key_frame_message;
+  if (!delta.empty()) {
+    delta_message = MakeCommandMessage(MultiGPUCommand::SEND_FRAME, std::move(delta));
+  }
 
-  auto view_header = carla::BufferView::CreateFrom(std::move(buf_header));
-  auto view_data = carla::BufferView::CreateFrom(std::move(buffer));
-  auto message = Primary::MakeMessage(view_header, view_data);
+  // write to multiple servers, the key frame is encoded only if needed
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (auto &s : _sessions) {
+    if (s == nullptr) {
+      continue;
+    }
+    auto it = _sessions_without_key_frame.find(s.get());
+    if (delta_message != nullptr && it == _sessions_without_key_frame.end()) {
+      s->Write(delta_message);
+    } else {
+      if (key_frame_message == nullptr) {
+        key_frame_message = MakeCommandMessage(MultiGPUCommand::SEND_FRAME, make_key_frame());
+      }
+      s->Write(key_frame_message);
+      if (it != _sessions_without_key_frame.end()) {
+        _sessions_without_key_frame.erase(it);
+      }
+    }
+  }
+}
+
+std::future<SessionInfo> Router::WriteToNext(MultiGPUCommand id, Buffer &&buffer) {
+  auto message = MakeCommandMessage(id, std::move(buffer));
 
   // create the promise for the posible answer
   auto response = std::make_shared<std::promise<SessionInfo>>();
@@ -162,15 +201,7 @@ std::future<SessionInfo> Router::WriteToNext(MultiGPUCommand id, Buffer &&buffer
 }
 
 std::future<SessionInfo> Router::WriteToOne(std::weak_ptr<Primary> server, MultiGPUCommand id, Buffer &&buffer) {
-  // define the command header
-  CommandHeader header;
-  header.id = id;
-  header.size = buffer.size();
-  Buffer buf_header((uint8_t *) &header, sizeof(header));
-
-  auto view_header = carla::BufferView::CreateFrom(std::move(buf_header));
-  auto view_data = carla::BufferView::CreateFrom(std::move(buffer));
-  auto message = Primary::MakeMessage(view_header, view_data);
+  auto message = MakeCommandMessage(id, std::move(buffer));
 
   // create the promise for the posible answer
   auto response = std::make_shared<std::promise<SessionInfo>>();
@@ -191,11 +222,41 @@ std::weak_ptr<Primary> Router::GetNextServer() {
     _next = 0;
   }
   if (_next < _sessions.size()) {
-    return std::weak_ptr<Primary>(_sessions[_next]);
+    return std::weak_ptr<Primary>(_sessions[_next++]);
   } else {
     return std::weak_ptr<Primary>();
   }
 }
 
+std::vector<SecondaryLoad> Router::GetLoads() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  std::vector<SecondaryLoad> result;
+  result.reserve(_sessions.size());
+  for (auto &s : _sessions) {
+    auto it = _loads.find(s.get());
+    if (it != _loads.end()) {
+      result.emplace_back(it->second);
+    }
+  }
+  return result;
+}
+
+void Router::UpdateLoad(Primary *session, const LoadReport &report) {
+  // smooth the frame time so a single slow frame does not move the sensors
+  constexpr float alpha = 0.1f;
+  auto it = _loads.find(session);
+  if (it == _loads.end()) {
+    return;
+  }
+  auto &load = it->second;
+  const float frame_time_ms = 1e-3f * static_cast<float>(report.frame_time_us);
+  load.frame_time_ms = load.has_report ?
+      load.frame_time_ms + alpha * (frame_time_ms - load.frame_time_ms) :
+      frame_time_ms;
+  load.has_report = true;
+  load.frame = report.frame;
+  load.queue_depth = report.queue_depth;
+}
+
 } // namespace multigpu
 } // namespace carla
@@ -12,14 +12,17 @@
 #include "carla/multigpu/primary.h"
 #include "carla/multigpu/primaryCommands.h"
 #include "carla/multigpu/commands.h"
+#include "carla/multigpu/loadReport.h"
 
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
 
+#include <functional>
 #include <mutex>
 #include <vector>
 #include <sstream>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace carla {
 namespace multigpu {
@@ -40,6 +43,10 @@ namespace multigpu {
     ~Router();
 
     void Write(MultiGPUCommand id, Buffer &&buffer);
+    /// Broadcast a frame, @a delta to the secondary servers that have the
+    /// previous frame and the result of @a make_key_frame to the others. An
+    /// empty @a delta sends the key frame to every secondary server.
+    void WriteFrame(Buffer &&delta, std::function<Buffer()> make_key_frame);
     std::future<SessionInfo> WriteToNext(MultiGPUCommand id, Buffer &&buffer);
     std::future<SessionInfo> WriteToOne(std::weak_ptr<Primary> server, MultiGPUCommand id, Buffer &&buffer);
     void Stop();
@@ -59,9 +66,19 @@ namespace multigpu {
       return _commander;
     }
 
+    /// Next secondary server in round-robin order.
     std::weak_ptr<Primary> GetNextServer();
 
+    /// Last load reported by each connected secondary server.
+    std::vector<SecondaryLoad> GetLoads();
+
   private:
+    static std::shared_ptr<const carla::streaming::detail::tcp::Message> MakeCommandMessage(
+        MultiGPUCommand id,
+        Buffer &&buffer);
+
+    void UpdateLoad(Primary *session, const LoadReport &report);
+
     void ConnectSession(std::shared_ptr<Primary> session);
     void DisconnectSession(std::shared_ptr<Primary> session);
     void ClearSessions();
@@ -74,6 +91,8 @@ namespace multigpu {
     std::shared_ptr<Listener>               _listener;
     uint32_t                                _next;
     std::unordered_map<Primary *, std::shared_ptr<std::promise<SessionInfo>>> _promises;
+    std::unordered_map<Primary *, SecondaryLoad> _loads;
+    std::unordered_set<Primary *>           _sessions_without_key_frame;
     PrimaryCommands                         _commander;
     std::function<void(void)>               _callback;
   };
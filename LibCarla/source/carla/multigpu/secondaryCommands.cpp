@@ -4,8 +4,10 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
-// #include "carla/Logging.h"
 #include "carla/multigpu/secondaryCommands.h"
+
+#include "carla/Logging.h"
+#include "carla/multigpu/secondary.h"
 // #include "carla/streaming/detail/tcp/Message.h"
 
 namespace carla {
@@ -26,11 +28,27 @@ void SecondaryCommands::process_command(Buffer buffer) {
   
   // send only data to the callback
   Buffer data(buffer.data() + sizeof(CommandHeader), header->size);
+
+  // rebuild the frame from the delta against the previous one, a frame that
+  // cannot be decoded is dropped until the next key frame
+  if (header->id == MultiGPUCommand::SEND_FRAME && FrameDeltaDecoder::IsEncoded(data)) {
+    Buffer frame;
+    if (!_frame_decoder.Decode(data, frame)) {
+      return;
+    }
+    data = std::move(frame);
+  }
+
   _callback(header->id, std::move(data));
 
   // log_info("Secondary got a command to process");
 }
 
+void SecondaryCommands::SendLoadReport(const LoadReport &report) {
+  if (_secondary) {
+    _secondary->Write(report.ToBuffer());
+  }
+}
 
 } // namespace multigpu
 } // namespace carla
@@ -9,6 +9,8 @@
 // #include "carla/Logging.h"
 #include "carla/Buffer.h"
 #include "carla/multigpu/commands.h"
+#include "carla/multigpu/frameDelta.h"
+#include "carla/multigpu/loadReport.h"
 #include <functional>
 
 namespace carla {
@@ -25,9 +27,13 @@ class SecondaryCommands {
   void set_callback(callback_type callback);
   void process_command(Buffer buffer);
 
+  // report to the primary server the load of this secondary server
+  void SendLoadReport(const LoadReport &report);
+
   private:
   std::shared_ptr<Secondary>  _secondary;
   callback_type               _callback;
+  FrameDeltaDecoder           _frame_decoder;
 };
 
 } // namespace multigpu
@@ -0,0 +1,495 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/nav/NavMeshBuilder.h"
+
+#include "carla/Logging.h"
+#include "carla/nav/NavMeshSet.h"
+#include "carla/nav/Navigation.h"
+#include "carla/road/Map.h"
+
+#include <recast/Recast.h>
+#include <recast/DetourCommon.h>
+#include <recast/DetourNavMesh.h>
+#include <recast/DetourNavMeshBuilder.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <thread>
+
+namespace carla {
+namespace nav {
+
+  // a navigation mesh with 32 bits references has 22 bits for the tile and
+  // polygon indices, up to 14 of them for the tile
+  static const unsigned int MAX_TILE_BITS = 14u;
+  static const unsigned int TILE_AND_POLY_BITS = 22u;
+
+  static size_t GetWorkerThreads(unsigned int worker_threads) {
+    if (worker_threads > 0u) {
+      return worker_threads;
+    }
+    return std::max(std::thread::hardware_concurrency(), 1u) - 1u;
+  }
+
+  static unsigned char GetMaterialArea(const std::string &name) {
+    if (name.find("sidewalk") != std::string::npos) {
+      return CARLA_AREA_SIDEWALK;
+    } else if (name.find("crosswalk") != std::string::npos) {
+      return CARLA_AREA_CROSSWALK;
+    } else if (name.find("grass") != std::string::npos) {
+      return CARLA_AREA_GRASS;
+    } else if (name.find("road") != std::string::npos) {
+      return CARLA_AREA_ROAD;
+    }
+    return CARLA_AREA_BLOCK;
+  }
+
+  static unsigned short GetAreaFlags(unsigned char area) {
+    switch (area) {
+      case CARLA_AREA_SIDEWALK:   return CARLA_TYPE_SIDEWALK;
+      case CARLA_AREA_CROSSWALK:  return CARLA_TYPE_CROSSWALK;
+      case CARLA_AREA_ROAD:       return CARLA_TYPE_ROAD;
+      case CARLA_AREA_GRASS:      return CARLA_TYPE_GRASS;
+      default:                    return CARLA_TYPE_NONE;
+    }
+  }
+
+  NavMeshBuilder::NavMeshBuilder(NavMeshSettings settings)
+    : _settings(settings),
+      _pool(GetWorkerThreads(settings.worker_threads)) {}
+
+  NavMeshBuilder::~NavMeshBuilder() {
+    dtFreeNavMesh(_nav_mesh);
+  }
+
+  geom::Mesh NavMeshBuilder::GenerateInputMesh(const road::Map &map, double vertex_distance) {
+    return map.GenerateMesh(vertex_distance) + map.GetAllCrosswalkMesh();
+  }
+
+  bool NavMeshBuilder::Build(const geom::Mesh &mesh) {
+    dtFreeNavMesh(_nav_mesh);
+    _nav_mesh = nullptr;
+    _tiles_x = 0;
+    _tiles_y = 0;
+    _tile_triangles.clear();
+
+    if (!SetGeometry(mesh) || !CreateGrid()) {
+      return false;
+    }
+    AssignTrianglesToTiles();
+
+    std::vector<std::pair<int, int>> tiles;
+    tiles.reserve(GetGridSize());
+    for (int y = 0; y < _tiles_y; ++y) {
+      for (int x = 0; x < _tiles_x; ++x) {
+        tiles.emplace_back(x, y);
+      }
+    }
+    BuildTiles(tiles);
+
+    if (GetTileCount() == 0u) {
+      logging::log("Nav: the mesh has no walkable area");
+      return false;
+    }
+    return true;
+  }
+
+  size_t NavMeshBuilder::Rebuild(
+      const geom::Mesh &mesh,
+      const geom::Location &min,
+      const geom::Location &max) {
+    if (_nav_mesh == nullptr) {
+      return Build(mesh) ? GetGridSize() : 0u;
+    }
+    if (!SetGeometry(mesh)) {
+      return 0u;
+    }
+    if (!IsInsideGrid()) {
+      return Build(mesh) ? GetGridSize() : 0u;
+    }
+    AssignTrianglesToTiles();
+
+    // the geometry in the border of a tile is rasterized with it, so the
+    // neighbours of the changed region may change too
+    const float margin = static_cast<float>(GetBorderSize()) * _settings.cell_size;
+    auto to_tile = [this](float value, float origin, int tiles) {
+      const int tile = static_cast<int>(std::floor((value - origin) / _tile_width));
+      return std::min(std::max(tile, 0), tiles - 1);
+    };
+    // from CARLA to Recast space
+    const int x0 = to_tile(std::min(min.x, max.x) - margin, _origin[0], _tiles_x);
+    const int x1 = to_tile(std::max(min.x, max.x) + margin, _origin[0], _tiles_x);
+    const int y0 = to_tile(std::min(min.y, max.y) - margin, _origin[2], _tiles_y);
+    const int y1 = to_tile(std::max(min.y, max.y) + margin, _origin[2], _tiles_y);
+
+    std::vector<std::pair<int, int>> tiles;
+    for (int y = y0; y <= y1; ++y) {
+      for (int x = x0; x <= x1; ++x) {
+        tiles.emplace_back(x, y);
+      }
+    }
+    BuildTiles(tiles);
+    return tiles.size();
+  }
+
+  std::vector<uint8_t> NavMeshBuilder::Serialize() const {
+    std::vector<uint8_t> out;
+    if (_nav_mesh == nullptr) {
+      return out;
+    }
+    const dtNavMesh *mesh = _nav_mesh;
+
+    NavMeshSetHeader header;
+    header.magic = NAVMESHSET_MAGIC;
+    header.version = NAVMESHSET_VERSION;
+    header.num_tiles = static_cast<int>(GetTileCount());
+    std::memcpy(&header.params, mesh->getParams(), sizeof(dtNavMeshParams));
+
+    size_t size = sizeof(header);
+    for (int i = 0; i < mesh->getMaxTiles(); ++i) {
+      const dtMeshTile *tile = mesh->getTile(i);
+      if (tile != nullptr && tile->header != nullptr && tile->dataSize > 0) {
+        size += sizeof(NavMeshTileHeader) + static_cast<size_t>(tile->dataSize);
+      }
+    }
+    out.reserve(size);
+
+    auto append = [&out](const void *data, size_t bytes) {
+      const uint8_t *begin = static_cast<const uint8_t *>(data);
+      out.insert(out.end(), begin, begin + bytes);
+    };
+    append(&header, sizeof(header));
+    for (int i = 0; i < mesh->getMaxTiles(); ++i) {
+      const dtMeshTile *tile = mesh->getTile(i);
+      if (tile == nullptr || tile->header == nullptr || tile->dataSize <= 0) {
+        continue;
+      }
+      NavMeshTileHeader tile_header;
+      tile_header.tile_ref = mesh->getTileRef(tile);
+      tile_header.data_size = tile->dataSize;
+      append(&tile_header, sizeof(tile_header));
+      append(tile->data, static_cast<size_t>(tile->dataSize));
+    }
+    return out;
+  }
+
+  bool NavMeshBuilder::Save(const std::string &filename) const {
+    const auto content = Serialize();
+    if (content.empty()) {
+      return false;
+    }
+    std::ofstream f(filename, std::ios::binary);
+    if (!f.is_open()) {
+      return false;
+    }
+    f.write(reinterpret_cast<const char *>(content.data()), static_cast<std::streamsize>(content.size()));
+    return f.good();
+  }
+
+  size_t NavMeshBuilder::GetTileCount() const {
+    if (_nav_mesh == nullptr) {
+      return 0u;
+    }
+    const dtNavMesh *mesh = _nav_mesh;
+    size_t count = 0u;
+    for (int i = 0; i < mesh->getMaxTiles(); ++i) {
+      const dtMeshTile *tile = mesh->getTile(i);
+      if (tile != nullptr && tile->header != nullptr && tile->dataSize > 0) {
+        ++count;
+      }
+    }
+    return count;
+  }
+
+  bool NavMeshBuilder::SetGeometry(const geom::Mesh &mesh) {
+    const auto &vertices = mesh.GetVertices();
+    const auto &indexes = mesh.GetIndexes();
+    const auto &materials = mesh.GetMaterials();
+    if (vertices.empty() || indexes.size() < 3u) {
+      logging::log("Nav: the mesh has no triangles");
+      return false;
+    }
+
+    // swap y and z for Recast, as the OBJ export does
+    _vertices.resize(vertices.size() * 3u);
+    for (size_t i = 0u; i < vertices.size(); ++i) {
+      _vertices[i * 3u + 0u] = vertices[i].x;
+      _vertices[i * 3u + 1u] = vertices[i].z;
+      _vertices[i * 3u + 2u] = vertices[i].y;
+    }
+    rcCalcBounds(_vertices.data(), static_cast<int>(vertices.size()), _bmin, _bmax);
+
+    // the indices start at 1, and the winding changes with the space
+    const size_t num_triangles = indexes.size() / 3u;
+    _triangles.resize(num_triangles * 3u);
+    _areas.resize(num_triangles);
+    auto material = materials.begin();
+    unsigned char area = CARLA_AREA_BLOCK;
+    for (size_t i = 0u; i < num_triangles; ++i) {
+      // a triangle keeps the last material started before it, as in the OBJ
+      while (material != materials.end() && material->index_start <= i * 3u) {
+        area = GetMaterialArea(material->name);
+        ++material;
+      }
+      _triangles[i * 3u + 0u] = static_cast<int>(indexes[i * 3u + 0u]) - 1;
+      _triangles[i * 3u + 1u] = static_cast<int>(indexes[i * 3u + 2u]) - 1;
+      _triangles[i * 3u + 2u] = static_cast<int>(indexes[i * 3u + 1u]) - 1;
+      _areas[i] = area;
+    }
+    return true;
+  }
+
+  bool NavMeshBuilder::CreateGrid() {
+    int grid_width = 0;
+    int grid_height = 0;
+    rcCalcGridSize(_bmin, _bmax, _settings.cell_size, &grid_width, &grid_height);
+
+    // grow the tiles until the grid fits in the tile bits of the references
+    _tile_size = std::max(_settings.tile_size, 16);
+    unsigned int tile_bits = 0u;
+    while (true) {
+      _tiles_x = (grid_width + _tile_size - 1) / _tile_size;
+      _tiles_y = (grid_height + _tile_size - 1) / _tile_size;
+      const auto num_tiles = static_cast<unsigned int>(std::max(_tiles_x * _tiles_y, 1));
+      tile_bits = dtIlog2(dtNextPow2(num_tiles));
+      if (tile_bits <= MAX_TILE_BITS) {
+        break;
+      }
+      _tile_size *= 2;
+    }
+    if (_tile_size != _settings.tile_size) {
+      logging::log("Nav: using tiles of", _tile_size, "cells to fit the map");
+    }
+    _tile_width = static_cast<float>(_tile_size) * _settings.cell_size;
+    std::copy(_bmin, _bmin + 3, _origin);
+
+    dtNavMeshParams params;
+    std::copy(_origin, _origin + 3, params.orig);
+    params.tileWidth = _tile_width;
+    params.tileHeight = _tile_width;
+    params.maxTiles = 1 << tile_bits;
+    params.maxPolys = 1 << (TILE_AND_POLY_BITS - tile_bits);
+
+    _nav_mesh = dtAllocNavMesh();
+    if (_nav_mesh == nullptr || dtStatusFailed(_nav_mesh->init(&params))) {
+      logging::log("Nav: could not init the navigation mesh");
+      dtFreeNavMesh(_nav_mesh);
+      _nav_mesh = nullptr;
+      return false;
+    }
+    return true;
+  }
+
+  void NavMeshBuilder::AssignTrianglesToTiles() {
+    _tile_triangles.assign(GetGridSize(), {});
+    const float margin = static_cast<float>(GetBorderSize()) * _settings.cell_size;
+    auto to_tile = [this](float value, float origin, int tiles) {
+      const int tile = static_cast<int>(std::floor((value - origin) / _tile_width));
+      return std::min(std::max(tile, 0), tiles - 1);
+    };
+    const int num_triangles = static_cast<int>(_areas.size());
+    for (int i = 0; i < num_triangles; ++i) {
+      float min_x = std::numeric_limits<float>::max();
+      float min_z = std::numeric_limits<float>::max();
+      float max_x = std::numeric_limits<float>::lowest();
+      float max_z = std::numeric_limits<float>::lowest();
+      for (int j = 0; j < 3; ++j) {
+        const float *v = &_vertices[static_cast<size_t>(_triangles[i * 3 + j]) * 3u];
+        min_x = std::min(min_x, v[0]);
+        max_x = std::max(max_x, v[0]);
+        min_z = std::min(min_z, v[2]);
+        max_z = std::max(max_z, v[2]);
+      }
+      const int x0 = to_tile(min_x - margin, _origin[0], _tiles_x);
+      const int x1 = to_tile(max_x + margin, _origin[0], _tiles_x);
+      const int y0 = to_tile(min_z - margin, _origin[2], _tiles_y);
+      const int y1 = to_tile(max_z + margin, _origin[2], _tiles_y);
+      for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+          _tile_triangles[static_cast<size_t>(y * _tiles_x + x)].push_back(i);
+        }
+      }
+    }
+  }
+
+  bool NavMeshBuilder::IsInsideGrid() const {
+    const float max_x = _origin[0] + static_cast<float>(_tiles_x) * _tile_width;
+    const float max_z = _origin[2] + static_cast<float>(_tiles_y) * _tile_width;
+    return _bmin[0] >= _origin[0] && _bmin[2] >= _origin[2] &&
+           _bmax[0] <= max_x && _bmax[2] <= max_z;
+  }
+
+  void NavMeshBuilder::BuildTiles(const std::vector<std::pair<int, int>> &tiles) {
+    std::vector<TileData> results(tiles.size());
+    _pool.ParallelFor(0u, tiles.size(), 1u, [&](size_t i) {
+      results[i] = BuildTile(tiles[i].first, tiles[i].second);
+    });
+
+    // the navigation mesh is modified in order from this thread, so the
+    // result does not depend on the number of threads
+    for (size_t i = 0u; i < tiles.size(); ++i) {
+      const dtTileRef old_tile = _nav_mesh->getTileRefAt(tiles[i].first, tiles[i].second, 0);
+      if (old_tile != 0) {
+        _nav_mesh->removeTile(old_tile, nullptr, nullptr);
+      }
+      if (results[i].data == nullptr) {
+        continue;
+      }
+      const dtStatus status = _nav_mesh->addTile(
+          results[i].data, results[i].size, DT_TILE_FREE_DATA, 0, nullptr);
+      if (dtStatusFailed(status)) {
+        dtFree(results[i].data);
+      }
+    }
+  }
+
+  int NavMeshBuilder::GetBorderSize() const {
+    const int walkable_radius = static_cast<int>(std::ceil(_settings.agent_radius / _settings.cell_size));
+    return walkable_radius + 3;
+  }
+
+  NavMeshBuilder::TileData NavMeshBuilder::BuildTile(int tile_x, int tile_y) const {
+    const auto &tile_triangles = _tile_triangles[static_cast<size_t>(tile_y * _tiles_x + tile_x)];
+    if (tile_triangles.empty()) {
+      return {};
+    }
+
+    rcConfig cfg;
+    std::memset(&cfg, 0, sizeof(cfg));
+    cfg.cs = _settings.cell_size;
+    cfg.ch = _settings.cell_height;
+    cfg.walkableSlopeAngle = _settings.agent_max_slope;
+    cfg.walkableHeight = static_cast<int>(std::ceil(_settings.agent_height / cfg.ch));
+    cfg.walkableClimb = static_cast<int>(std::floor(_settings.agent_max_climb / cfg.ch));
+    cfg.walkableRadius = static_cast<int>(std::ceil(_settings.agent_radius / cfg.cs));
+    cfg.maxEdgeLen = static_cast<int>(_settings.edge_max_length / cfg.cs);
+    cfg.maxSimplificationError = _settings.edge_max_error;
+    cfg.minRegionArea = rcSqr(_settings.region_min_size);
+    cfg.mergeRegionArea = rcSqr(_settings.region_merge_size);
+    cfg.maxVertsPerPoly = _settings.verts_per_poly;
+    cfg.tileSize = _tile_size;
+    cfg.borderSize = GetBorderSize();
+    cfg.width = cfg.tileSize + cfg.borderSize * 2;
+    cfg.height = cfg.tileSize + cfg.borderSize * 2;
+    cfg.detailSampleDist = _settings.detail_sample_distance < 0.9f ? 0.0f :
+        cfg.cs * _settings.detail_sample_distance;
+    cfg.detailSampleMaxError = cfg.ch * _settings.detail_sample_max_error;
+
+    // bounds of the tile, with its border
+    const float border = static_cast<float>(cfg.borderSize) * cfg.cs;
+    cfg.bmin[0] = _origin[0] + static_cast<float>(tile_x) * _tile_width - border;
+    cfg.bmin[1] = _bmin[1];
+    cfg.bmin[2] = _origin[2] + static_cast<float>(tile_y) * _tile_width - border;
+    cfg.bmax[0] = _origin[0] + static_cast<float>(tile_x + 1) * _tile_width + border;
+    cfg.bmax[1] = _bmax[1];
+    cfg.bmax[2] = _origin[2] + static_cast<float>(tile_y + 1) * _tile_width + border;
+
+    // the context only collects logs and timers, one per tile
+    rcContext ctx(false);
+
+    std::vector<int> triangles;
+    std::vector<unsigned char> areas;
+    triangles.reserve(tile_triangles.size() * 3u);
+    areas.reserve(tile_triangles.size());
+    for (int i : tile_triangles) {
+      triangles.insert(triangles.end(), &_triangles[i * 3], &_triangles[i * 3] + 3);
+      areas.push_back(_areas[static_cast<size_t>(i)]);
+    }
+    const int num_vertices = static_cast<int>(_vertices.size() / 3u);
+    const int num_triangles = static_cast<int>(areas.size());
+
+    // voxelize the walkable triangles
+    std::unique_ptr<rcHeightfield, void (*)(rcHeightfield *)> solid(rcAllocHeightfield(), rcFreeHeightField);
+    if (!solid || !rcCreateHeightfield(&ctx, *solid, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs, cfg.ch)) {
+      return {};
+    }
+    rcClearUnwalkableTriangles(&ctx, cfg.walkableSlopeAngle, _vertices.data(), num_vertices,
+        triangles.data(), num_triangles, areas.data());
+    rcRasterizeTriangles(&ctx, _vertices.data(), num_vertices, triangles.data(), areas.data(),
+        num_triangles, *solid, cfg.walkableClimb);
+    rcFilterLowHangingWalkableObstacles(&ctx, cfg.walkableClimb, *solid);
+    rcFilterLedgeSpans(&ctx, cfg.walkableHeight, cfg.walkableClimb, *solid);
+    rcFilterWalkableLowHeightSpans(&ctx, cfg.walkableHeight, *solid);
+
+    // regions of walkable space
+    std::unique_ptr<rcCompactHeightfield, void (*)(rcCompactHeightfield *)> chf(
+        rcAllocCompactHeightfield(), rcFreeCompactHeightfield);
+    if (!chf || !rcBuildCompactHeightfield(&ctx, cfg.walkableHeight, cfg.walkableClimb, *solid, *chf)) {
+      return {};
+    }
+    solid.reset();
+    if (!rcErodeWalkableArea(&ctx, cfg.walkableRadius, *chf) ||
+        !rcBuildDistanceField(&ctx, *chf) ||
+        !rcBuildRegions(&ctx, *chf, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea)) {
+      return {};
+    }
+
+    // polygons
+    std::unique_ptr<rcContourSet, void (*)(rcContourSet *)> cset(rcAllocContourSet(), rcFreeContourSet);
+    if (!cset || !rcBuildContours(&ctx, *chf, cfg.maxSimplificationError, cfg.maxEdgeLen, *cset)) {
+      return {};
+    }
+    if (cset->nconts == 0) {
+      return {};
+    }
+    std::unique_ptr<rcPolyMesh, void (*)(rcPolyMesh *)> pmesh(rcAllocPolyMesh(), rcFreePolyMesh);
+    if (!pmesh || !rcBuildPolyMesh(&ctx, *cset, cfg.maxVertsPerPoly, *pmesh)) {
+      return {};
+    }
+    std::unique_ptr<rcPolyMeshDetail, void (*)(rcPolyMeshDetail *)> dmesh(
+        rcAllocPolyMeshDetail(), rcFreePolyMeshDetail);
+    if (!dmesh || !rcBuildPolyMeshDetail(&ctx, *pmesh, *chf, cfg.detailSampleDist,
+        cfg.detailSampleMaxError, *dmesh)) {
+      return {};
+    }
+    // Detour uses 16 bits vertex indices
+    if (pmesh->nverts == 0 || pmesh->nverts >= 0xffff) {
+      return {};
+    }
+    for (int i = 0; i < pmesh->npolys; ++i) {
+      pmesh->flags[i] = GetAreaFlags(pmesh->areas[i]);
+    }
+
+    dtNavMeshCreateParams params;
+    std::memset(&params, 0, sizeof(params));
+    params.verts = pmesh->verts;
+    params.vertCount = pmesh->nverts;
+    params.polys = pmesh->polys;
+    params.polyAreas = pmesh->areas;
+    params.polyFlags = pmesh->flags;
+    params.polyCount = pmesh->npolys;
+    params.nvp = pmesh->nvp;
+    params.detailMeshes = dmesh->meshes;
+    params.detailVerts = dmesh->verts;
+    params.detailVertsCount = dmesh->nverts;
+    params.detailTris = dmesh->tris;
+    params.detailTriCount = dmesh->ntris;
+    params.walkableHeight = _settings.agent_height;
+    params.walkableRadius = _settings.agent_radius;
+    params.walkableClimb = _settings.agent_max_climb;
+    params.tileX = tile_x;
+    params.tileY = tile_y;
+    params.tileLayer = 0;
+    std::copy(pmesh->bmin, pmesh->bmin + 3, params.bmin);
+    std::copy(pmesh->bmax, pmesh->bmax + 3, params.bmax);
+    params.cs = cfg.cs;
+    params.ch = cfg.ch;
+    params.buildBvTree = true;
+
+    TileData tile;
+    if (!dtCreateNavMeshData(&params, &tile.data, &tile.size)) {
+      return {};
+    }
+    return tile;
+  }
+
+} // namespace nav
+} // namespace carla
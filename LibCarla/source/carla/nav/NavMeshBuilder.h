@@ -0,0 +1,144 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/WorkStealingPool.h"
+#include "carla/geom/Location.h"
+#include "carla/geom/Mesh.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class dtNavMesh;
+
+namespace carla {
+namespace road {
+  class Map;
+} // namespace road
+namespace nav {
+
+  /// Parameters of the navigation mesh. Distances are in meters, the agent
+  /// size must match the one used by Navigation.
+  struct NavMeshSettings {
+    /// size of the voxels used to rasterize the geometry
+    float cell_size = 0.1f;
+    float cell_height = 0.1f;
+    float agent_height = 1.8f;
+    float agent_radius = 0.3f;
+    /// highest step an agent can climb, enough for the curbs
+    float agent_max_climb = 0.3f;
+    /// steepest walkable slope, in degrees
+    float agent_max_slope = 45.0f;
+    /// regions smaller than this (in cells squared) are removed
+    int region_min_size = 8;
+    /// regions smaller than this (in cells squared) are merged with a neighbour
+    int region_merge_size = 20;
+    float edge_max_length = 12.0f;
+    float edge_max_error = 1.3f;
+    int verts_per_poly = 6;
+    float detail_sample_distance = 6.0f;
+    float detail_sample_max_error = 1.0f;
+    /// width of a tile in cells; it is doubled if the map needs more tiles
+    /// than a navigation mesh can hold
+    int tile_size = 256;
+    /// threads building tiles besides the calling one, zero to use one per
+    /// core
+    unsigned int worker_threads = 0u;
+  };
+
+  /// Builds a tiled Detour navigation mesh in-process from a mesh in CARLA
+  /// coordinates, as the output of road::Map::GenerateMesh, instead of going
+  /// through an OBJ file and RecastBuilder. The area of each triangle is taken
+  /// from the name of its material ("road", "sidewalk", "crosswalk", "grass"),
+  /// with the same rules than the OBJ export; other triangles are not walkable.
+  ///
+  /// Tiles are built in parallel. After a change in the geometry only the
+  /// tiles overlapping the changed region need to be rebuilt. The result can
+  /// be serialized in the format read by Navigation::Load.
+  ///
+  /// This class is not thread-safe.
+  class NavMeshBuilder : private NonCopyable {
+  public:
+
+    explicit NavMeshBuilder(NavMeshSettings settings = NavMeshSettings());
+    ~NavMeshBuilder();
+
+    /// Mesh with the roads, sidewalks and crosswalks of @a map, the input
+    /// RecastBuilder is given for an OpenDRIVE map.
+    static geom::Mesh GenerateInputMesh(const road::Map &map, double vertex_distance = 2.0);
+
+    /// Build all the tiles from @a mesh, discarding the previous ones. Return
+    /// false if there is nothing walkable or the mesh is too big.
+    bool Build(const geom::Mesh &mesh);
+
+    /// Replace the geometry with @a mesh, that differs from the previous one
+    /// only inside the box from @a min to @a max, and rebuild only the tiles
+    /// affected by that box. If @a mesh goes beyond the bounds of the previous
+    /// one all the tiles are rebuilt. Return the number of tiles rebuilt.
+    size_t Rebuild(const geom::Mesh &mesh, const geom::Location &min, const geom::Location &max);
+
+    /// Navigation mesh in the format read by Navigation::Load, empty if
+    /// nothing has been built.
+    std::vector<uint8_t> Serialize() const;
+
+    /// Write the serialized navigation mesh to @a filename.
+    bool Save(const std::string &filename) const;
+
+    /// Number of tiles with some walkable area.
+    size_t GetTileCount() const;
+
+    /// Number of tiles of the grid.
+    size_t GetGridSize() const {
+      return static_cast<size_t>(_tiles_x) * static_cast<size_t>(_tiles_y);
+    }
+
+  private:
+
+    struct TileData {
+      unsigned char *data { nullptr };
+      int size { 0 };
+    };
+
+    /// convert the mesh to Recast space, returns false if it has no triangles
+    bool SetGeometry(const geom::Mesh &mesh);
+    /// the tile grid covers the bounds of the current geometry
+    bool CreateGrid();
+    /// list the triangles touching each tile, including its border
+    void AssignTrianglesToTiles();
+    bool IsInsideGrid() const;
+    /// build the given tiles in parallel and replace them in the mesh
+    void BuildTiles(const std::vector<std::pair<int, int>> &tiles);
+    TileData BuildTile(int tile_x, int tile_y) const;
+    /// border of a tile in cells, geometry this close is rasterized with it
+    int GetBorderSize() const;
+
+    NavMeshSettings _settings;
+
+    /// input geometry in Recast space (y up)
+    std::vector<float> _vertices;
+    std::vector<int> _triangles;
+    std::vector<unsigned char> _areas;
+    float _bmin[3] { 0.0f, 0.0f, 0.0f };
+    float _bmax[3] { 0.0f, 0.0f, 0.0f };
+
+    /// tile grid
+    float _origin[3] { 0.0f, 0.0f, 0.0f };
+    float _tile_width { 0.0f };
+    int _tile_size { 0 };
+    int _tiles_x { 0 };
+    int _tiles_y { 0 };
+    std::vector<std::vector<int>> _tile_triangles;
+
+    dtNavMesh *_nav_mesh { nullptr };
+
+    WorkStealingPool _pool;
+  };
+
+} // namespace nav
+} // namespace carla
@@ -0,0 +1,37 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <recast/DetourNavMesh.h>
+
+namespace carla {
+namespace nav {
+
+  /// Binary format of a tiled navigation mesh, as written by RecastBuilder
+  /// and NavMeshBuilder: a NavMeshSetHeader followed, for each tile, by a
+  /// NavMeshTileHeader and the Detour tile data.
+  static const int NAVMESHSET_MAGIC = 'M' << 24 | 'S' << 16 | 'E' << 8 | 'T'; // 'MSET';
+  static const int NAVMESHSET_VERSION = 1;
+
+#pragma pack(push, 1)
+
+  struct NavMeshSetHeader {
+    int magic;
+    int version;
+    int num_tiles;
+    dtNavMeshParams params;
+  };
+
+  struct NavMeshTileHeader {
+    dtTileRef tile_ref;
+    int data_size;
+  };
+
+#pragma pack(pop)
+
+} // namespace nav
+} // namespace carla
@@ -10,11 +10,15 @@
 
 #include "carla/Logging.h"
 #include "carla/nav/Navigation.h"
+#include "carla/nav/NavMeshSet.h"
 #include "carla/nav/WalkerManager.h"
 #include "carla/geom/Math.h"
 
+#include <algorithm>
+#include <climits>
 #include <iterator>
 #include <fstream>
+#include <limits>
 #include <mutex>
 
 namespace carla {
@@ -31,7 +35,7 @@ namespace nav {
   // these settings are the same than in RecastBuilder, so if you change the height of the agent, 
   // you should do the same in RecastBuilder
   static const int   MAX_POLYS = 256;
-  static const int   MAX_AGENTS = 500;
+  static const int   DEFAULT_MAX_AGENTS = 500;
   static const int   MAX_QUERY_SEARCH_NODES = 2048;
   static const float AGENT_HEIGHT = 1.8f;
   static const float AGENT_RADIUS = 0.3f;
@@ -40,6 +44,11 @@ namespace nav {
   static const float AGENT_UNBLOCK_DISTANCE_SQUARED = AGENT_UNBLOCK_DISTANCE * AGENT_UNBLOCK_DISTANCE;
   static const float AGENT_UNBLOCK_TIME = 4.0f;
 
+  // initial capacity of a tile crowd when the crowd is split in tiles, it grows up to the max agents
+  static const int   TILE_INITIAL_AGENTS = 64;
+  // walkers and vehicles closer than this to a tile get a ghost agent in it
+  static const float TILE_GHOST_DISTANCE = 3.0f;
+
   static const float AREA_GRASS_COST =  1.0f;
   static const float AREA_ROAD_COST  = 10.0f;
 
@@ -48,7 +57,7 @@ namespace nav {
     return static_cast<float>(rand()) / static_cast<float>(RAND_MAX);
   }
 
-  Navigation::Navigation() {
+  Navigation::Navigation() : _max_agents(DEFAULT_MAX_AGENTS) {
     // assign walker manager
     _walker_manager.SetNav(this);
   }
@@ -58,11 +67,12 @@ namespace nav {
     _time_to_unblock = 0.0f;
     _mapped_walkers_id.clear();
     _mapped_vehicles_id.clear();
+    _walkers_ghosts.clear();
     _mapped_by_index.clear();
     _walkers_blocked_position.clear();
     _yaw_walkers.clear();
     _binary_mesh.clear();
-    dtFreeCrowd(_crowd);
+    FreeTiles(_tiles);
     dtFreeNavMeshQuery(_nav_query);
     dtFreeNavMesh(_nav_mesh);
   }
@@ -82,14 +92,15 @@ namespace nav {
   // load navigation data
   bool Navigation::Load(const std::string &filename) {
     std::ifstream f;
-    std::istream_iterator<uint8_t> start(f), end;
 
     // read the whole file
     f.open(filename, std::ios::binary);
     if (!f.is_open()) {
       return false;
     }
-    std::vector<uint8_t> content(start, end);
+    std::vector<uint8_t> content(
+        (std::istreambuf_iterator<char>(f)),
+        std::istreambuf_iterator<char>());
     f.close();
 
     // parse the content
@@ -98,21 +109,7 @@ namespace nav {
 
   // load navigation data from memory
   bool Navigation::Load(std::vector<uint8_t> content) {
-    const int NAVMESHSET_MAGIC = 'M' << 24 | 'S' << 16 | 'E' << 8 | 'T'; // 'MSET';
-    const int NAVMESHSET_VERSION = 1;
-#pragma pack(push, 1)
-
-    struct NavMeshSetHeader {
-      int magic;
-      int version;
-      int num_tiles;
-      dtNavMeshParams params;
-    } header;
-    struct NavMeshTileHeader {
-      dtTileRef tile_ref;
-      int data_size;
-    };
-#pragma pack(pop)
+    NavMeshSetHeader header;
 
     // check size for header
     if (content.size() < sizeof(header)) {
@@ -205,54 +202,192 @@ namespace nav {
       return;
     }
 
-    DEBUG_ASSERT(_crowd == nullptr);
+    DEBUG_ASSERT(_tiles.empty());
+
+    CreateTiles();
+
+    // a single crowd is created up front, tiles get their crowd when the first agent enters them
+    if (_tiles.size() == 1u) {
+      CreateTileCrowd(_tiles[0], _max_agents);
+    }
+  }
+
+  // set the maximum agents per tile, the tile size and the threads updating the tiles
+  void Navigation::SetCrowdSettings(unsigned int max_agents, float tile_size, unsigned int worker_threads) {
+    // critical section, force single thread running this
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    if (worker_threads > 1u) {
+      if (_pool == nullptr || _pool->size() != worker_threads) {
+        _pool = std::make_unique<WorkStealingPool>(worker_threads - 1u);
+      }
+    } else {
+      _pool.reset();
+    }
+
+    const int new_max_agents = static_cast<int>(std::min(std::max(max_agents, 1u), static_cast<unsigned int>(INT_MAX)));
+    const float new_tile_size = std::max(tile_size, 0.0f);
+    if (new_max_agents == _max_agents && new_tile_size == _tile_size) {
+      return;
+    }
+    const int old_max_agents = _max_agents;
+    _max_agents = new_max_agents;
+    _tile_size = new_tile_size;
+
+    // the tiles are created when the navigation is loaded
+    if (!_ready) {
+      return;
+    }
+
+    // move the walkers to the new tiles, vehicles are added again in the next update
+    std::vector<CrowdTile> old_tiles = std::move(_tiles);
+    std::unordered_map<ActorId, int> walkers = std::move(_mapped_walkers_id);
+    _tiles.clear();
+    _mapped_walkers_id.clear();
+    _mapped_vehicles_id.clear();
+    _walkers_ghosts.clear();
+    _mapped_by_index.clear();
+
+    CreateTiles();
+    if (_tiles.size() == 1u) {
+      CreateTileCrowd(_tiles[0], _max_agents);
+    }
+
+    for (auto &&entry : walkers) {
+      const CrowdTile &old_tile = old_tiles[static_cast<size_t>(entry.second / old_max_agents)];
+      const dtCrowdAgent *agent = old_tile.crowd->getAgent(entry.second % old_max_agents);
+      int index = CopyAgentToTile(*agent, GetTileAt(agent->npos[0], agent->npos[2]), true);
+      if (index == -1) {
+        logging::log("Nav: walker", entry.first, "does not fit in the crowd");
+        _walker_manager.RemoveWalker(entry.first);
+        continue;
+      }
+      _mapped_walkers_id[entry.first] = index;
+      _mapped_by_index[index] = entry.first;
+    }
+
+    FreeTiles(old_tiles);
+  }
+
+  size_t Navigation::GetCrowdCount() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _tiles.size();
+  }
+
+  void Navigation::ForEachAgent(const std::function<void(const dtCrowdAgent &agent)> &callback) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (const auto &tile : _tiles) {
+      for (int i = 0; tile.crowd != nullptr && i < tile.capacity; ++i) {
+        const dtCrowdAgent *agent = tile.crowd->getAgent(i);
+        if (agent != nullptr && agent->active) {
+          callback(*agent);
+        }
+      }
+    }
+  }
+
+  // create the grid of tiles covering the navigation mesh
+  void Navigation::CreateTiles() {
+    _tiles_x = 1;
+    _tiles_y = 1;
+    _tiles_origin_x = 0.0f;
+    _tiles_origin_y = 0.0f;
+
+    if (_tile_size > 0.0f && _nav_mesh != nullptr) {
+      // bounds of the mesh in Unreal coordinates (recast is x, z, y)
+      float min_x = std::numeric_limits<float>::max();
+      float min_y = std::numeric_limits<float>::max();
+      float max_x = std::numeric_limits<float>::lowest();
+      float max_y = std::numeric_limits<float>::lowest();
+      const dtNavMesh *mesh = _nav_mesh;
+      for (int i = 0; i < mesh->getMaxTiles(); ++i) {
+        const dtMeshTile *tile = mesh->getTile(i);
+        if (tile == nullptr || tile->header == nullptr) {
+          continue;
+        }
+        min_x = std::min(min_x, tile->header->bmin[0]);
+        min_y = std::min(min_y, tile->header->bmin[2]);
+        max_x = std::max(max_x, tile->header->bmax[0]);
+        max_y = std::max(max_y, tile->header->bmax[2]);
+      }
+      if (min_x <= max_x && min_y <= max_y) {
+        const int tiles_x = std::max(1, static_cast<int>(std::ceil((max_x - min_x) / _tile_size)));
+        const int tiles_y = std::max(1, static_cast<int>(std::ceil((max_y - min_y) / _tile_size)));
+        // the global index of the agents must fit in an int
+        if (static_cast<long long>(tiles_x) * tiles_y * _max_agents <= INT_MAX) {
+          _tiles_x = tiles_x;
+          _tiles_y = tiles_y;
+          _tiles_origin_x = min_x;
+          _tiles_origin_y = min_y;
+        } else {
+          logging::log("Nav: too many crowd tiles, using a single crowd");
+        }
+      }
+    }
+
+    _tiles.clear();
+    _tiles.resize(static_cast<size_t>(_tiles_x * _tiles_y));
+  }
+
+  void Navigation::FreeTiles(std::vector<CrowdTile> &tiles) {
+    for (auto &tile : tiles) {
+      dtFreeCrowd(tile.crowd);
+      tile.crowd = nullptr;
+      tile.capacity = 0;
+    }
+    tiles.clear();
+  }
+
+  bool Navigation::CreateTileCrowd(CrowdTile &tile, int capacity) {
+    DEBUG_ASSERT(tile.crowd == nullptr);
 
     // create and init
-    _crowd = dtAllocCrowd();
+    dtCrowd *crowd = dtAllocCrowd();
     // these radius should be the maximum size of the vehicles (CarlaCola for Carla)
     const float max_agent_radius = AGENT_RADIUS * 20;
-    if (!_crowd->init(MAX_AGENTS, max_agent_radius, _nav_mesh)) {
+    if (crowd == nullptr || !crowd->init(capacity, max_agent_radius, _nav_mesh)) {
       logging::log("Nav: failed to create crowd");
-      return;
+      dtFreeCrowd(crowd);
+      return false;
     }
 
     // set different filters
     // filter 0 can not walk on roads
-    _crowd->getEditableFilter(0)->setIncludeFlags(CARLA_TYPE_WALKABLE);
-    _crowd->getEditableFilter(0)->setExcludeFlags(CARLA_TYPE_ROAD);
-    _crowd->getEditableFilter(0)->setAreaCost(CARLA_AREA_ROAD, AREA_ROAD_COST);
-    _crowd->getEditableFilter(0)->setAreaCost(CARLA_AREA_GRASS, AREA_GRASS_COST);
+    crowd->getEditableFilter(0)->setIncludeFlags(CARLA_TYPE_WALKABLE);
+    crowd->getEditableFilter(0)->setExcludeFlags(CARLA_TYPE_ROAD);
+    crowd->getEditableFilter(0)->setAreaCost(CARLA_AREA_ROAD, AREA_ROAD_COST);
+    crowd->getEditableFilter(0)->setAreaCost(CARLA_AREA_GRASS, AREA_GRASS_COST);
     // filter 1 can walk on roads
-    _crowd->getEditableFilter(1)->setIncludeFlags(CARLA_TYPE_WALKABLE);
-    _crowd->getEditableFilter(1)->setExcludeFlags(CARLA_TYPE_NONE);
-    _crowd->getEditableFilter(1)->setAreaCost(CARLA_AREA_ROAD, AREA_ROAD_COST);
-    _crowd->getEditableFilter(1)->setAreaCost(CARLA_AREA_GRASS, AREA_GRASS_COST);
+    crowd->getEditableFilter(1)->setIncludeFlags(CARLA_TYPE_WALKABLE);
+    crowd->getEditableFilter(1)->setExcludeFlags(CARLA_TYPE_NONE);
+    crowd->getEditableFilter(1)->setAreaCost(CARLA_AREA_ROAD, AREA_ROAD_COST);
+    crowd->getEditableFilter(1)->setAreaCost(CARLA_AREA_GRASS, AREA_GRASS_COST);
 
     // Setup local avoidance params to different qualities.
     dtObstacleAvoidanceParams params;
     // Use mostly default settings, copy from dtCrowd.
-    memcpy(&params, _crowd->getObstacleAvoidanceParams(0), sizeof(dtObstacleAvoidanceParams));
+    memcpy(&params, crowd->getObstacleAvoidanceParams(0), sizeof(dtObstacleAvoidanceParams));
 
     // Low (11)
     params.velBias = 0.5f;
     params.adaptiveDivs = 5;
     params.adaptiveRings = 2;
     params.adaptiveDepth = 1;
-    _crowd->setObstacleAvoidanceParams(0, &params);
+    crowd->setObstacleAvoidanceParams(0, &params);
 
     // Medium (22)
     params.velBias = 0.5f;
     params.adaptiveDivs = 5;
     params.adaptiveRings = 2;
     params.adaptiveDepth = 2;
-    _crowd->setObstacleAvoidanceParams(1, &params);
+    crowd->setObstacleAvoidanceParams(1, &params);
 
     // Good (45)
     params.velBias = 0.5f;
     params.adaptiveDivs = 7;
     params.adaptiveRings = 2;
     params.adaptiveDepth = 3;
-    _crowd->setObstacleAvoidanceParams(2, &params);
+    crowd->setObstacleAvoidanceParams(2, &params);
 
     // High (66)
     params.velBias = 0.5f;
@@ -260,7 +395,263 @@ namespace nav {
     params.adaptiveRings = 3;
     params.adaptiveDepth = 3;
 
-    _crowd->setObstacleAvoidanceParams(3, &params);
+    crowd->setObstacleAvoidanceParams(3, &params);
+
+    tile.crowd = crowd;
+    tile.capacity = capacity;
+    return true;
+  }
+
+  // return the tile containing a point (Unreal coordinates)
+  int Navigation::GetTileAt(float x, float y) const {
+    if (_tiles.size() <= 1u) {
+      return 0;
+    }
+    const int tile_x = geom::Math::Clamp(
+        static_cast<int>(std::floor((x - _tiles_origin_x) / _tile_size)), 0, _tiles_x - 1);
+    const int tile_y = geom::Math::Clamp(
+        static_cast<int>(std::floor((y - _tiles_origin_y) / _tile_size)), 0, _tiles_y - 1);
+    return tile_y * _tiles_x + tile_x;
+  }
+
+  // return the tiles overlapping a rectangle (Unreal coordinates)
+  std::vector<int> Navigation::GetTilesIn(float min_x, float min_y, float max_x, float max_y) const {
+    const int first = GetTileAt(min_x, min_y);
+    const int last = GetTileAt(max_x, max_y);
+    std::vector<int> result;
+    for (int tile_y = first / _tiles_x; tile_y <= last / _tiles_x; ++tile_y) {
+      for (int tile_x = first % _tiles_x; tile_x <= last % _tiles_x; ++tile_x) {
+        result.emplace_back(tile_y * _tiles_x + tile_x);
+      }
+    }
+    return result;
+  }
+
+  const dtCrowdAgent *Navigation::GetAgent(int index) const {
+    if (index < 0) {
+      return nullptr;
+    }
+    const size_t tile = static_cast<size_t>(index / _max_agents);
+    const int local = index % _max_agents;
+    if (tile >= _tiles.size() || _tiles[tile].crowd == nullptr || local >= _tiles[tile].capacity) {
+      return nullptr;
+    }
+    return _tiles[tile].crowd->getAgent(local);
+  }
+
+  dtCrowdAgent *Navigation::GetEditableAgent(int index) {
+    if (index < 0) {
+      return nullptr;
+    }
+    const size_t tile = static_cast<size_t>(index / _max_agents);
+    const int local = index % _max_agents;
+    if (tile >= _tiles.size() || _tiles[tile].crowd == nullptr || local >= _tiles[tile].capacity) {
+      return nullptr;
+    }
+    return _tiles[tile].crowd->getEditableAgent(local);
+  }
+
+  int Navigation::AddAgentToTile(int tile, const float *pos, const dtCrowdAgentParams &params, bool grow) {
+    CrowdTile &crowd_tile = _tiles[static_cast<size_t>(tile)];
+    if (crowd_tile.crowd == nullptr &&
+        !CreateTileCrowd(crowd_tile, std::min(_max_agents, TILE_INITIAL_AGENTS))) {
+      return -1;
+    }
+    int index = crowd_tile.crowd->addAgent(pos, &params);
+    if (index == -1 && grow && GrowTile(tile)) {
+      index = _tiles[static_cast<size_t>(tile)].crowd->addAgent(pos, &params);
+    }
+    return (index == -1) ? -1 : tile * _max_agents + index;
+  }
+
+  void Navigation::RemoveAgentByIndex(int index) {
+    const size_t tile = static_cast<size_t>(index / _max_agents);
+    if (tile < _tiles.size() && _tiles[tile].crowd != nullptr) {
+      _tiles[tile].crowd->removeAgent(index % _max_agents);
+    }
+    _mapped_by_index.erase(index);
+  }
+
+  int Navigation::CopyAgentToTile(const dtCrowdAgent &agent, int tile, bool grow) {
+    int index = AddAgentToTile(tile, agent.npos, agent.params, grow);
+    if (index == -1) {
+      return -1;
+    }
+
+    // copy the state
+    dtCrowdAgent *copy = GetEditableAgent(index);
+    dtVcopy(copy->vel, agent.vel);
+    dtVcopy(copy->nvel, agent.nvel);
+    dtVcopy(copy->dvel, agent.dvel);
+    copy->state = agent.state;
+    copy->paused = agent.paused;
+    copy->dead = agent.dead;
+
+    // keep going to the same target
+    dtCrowd *crowd = _tiles[static_cast<size_t>(tile)].crowd;
+    if (agent.targetState == DT_CROWDAGENT_TARGET_VELOCITY) {
+      crowd->requestMoveVelocity(index % _max_agents, agent.targetPos);
+    } else if (agent.targetState != DT_CROWDAGENT_TARGET_NONE &&
+        agent.targetState != DT_CROWDAGENT_TARGET_FAILED &&
+        agent.targetRef) {
+      crowd->requestMoveTarget(index % _max_agents, agent.targetRef, agent.targetPos);
+    }
+
+    return index;
+  }
+
+  bool Navigation::GrowTile(int tile) {
+    CrowdTile &crowd_tile = _tiles[static_cast<size_t>(tile)];
+    if (crowd_tile.crowd == nullptr || crowd_tile.capacity >= _max_agents) {
+      return false;
+    }
+
+    CrowdTile grown;
+    if (!CreateTileCrowd(grown, std::min(crowd_tile.capacity * 2, _max_agents))) {
+      return false;
+    }
+    const CrowdTile old = crowd_tile;
+    crowd_tile = grown;
+
+    // agents are copied in order, so the new index is never taken by an agent not yet copied
+    for (int i = 0; i < old.capacity; ++i) {
+      const dtCrowdAgent *agent = old.crowd->getAgent(i);
+      if (!agent->active) {
+        continue;
+      }
+      const int index = CopyAgentToTile(*agent, tile, false);
+      DEBUG_ASSERT(index != -1);
+      RemapIndex(tile * _max_agents + i, index);
+    }
+
+    dtFreeCrowd(old.crowd);
+    return true;
+  }
+
+  void Navigation::RemapIndex(int old_index, int new_index) {
+    if (old_index == new_index) {
+      return;
+    }
+    auto it = _mapped_by_index.find(old_index);
+    if (it == _mapped_by_index.end()) {
+      return;
+    }
+    const ActorId id = it->second;
+    _mapped_by_index.erase(it);
+    _mapped_by_index[new_index] = id;
+
+    auto walker = _mapped_walkers_id.find(id);
+    if (walker != _mapped_walkers_id.end() && walker->second == old_index) {
+      walker->second = new_index;
+      return;
+    }
+    for (auto *mapping : { &_mapped_vehicles_id, &_walkers_ghosts }) {
+      auto entry = mapping->find(id);
+      if (entry != mapping->end()) {
+        std::replace(entry->second.begin(), entry->second.end(), old_index, new_index);
+      }
+    }
+  }
+
+  // move the walkers that left their tile to the tile containing them
+  void Navigation::HandOffWalkers() {
+    if (_tiles.size() <= 1u) {
+      return;
+    }
+
+    std::vector<std::pair<ActorId, int>> moves;
+    for (auto &&entry : _mapped_walkers_id) {
+      const dtCrowdAgent *agent = GetAgent(entry.second);
+      if (agent == nullptr || !agent->active) {
+        continue;
+      }
+      const int tile = GetTileAt(agent->npos[0], agent->npos[2]);
+      if (tile != entry.second / _max_agents) {
+        moves.emplace_back(entry.first, tile);
+      }
+    }
+
+    for (auto &&move : moves) {
+      const int old_index = _mapped_walkers_id[move.first];
+      const int index = CopyAgentToTile(*GetAgent(old_index), move.second, true);
+      if (index == -1) {
+        // it stays in its tile until there is room
+        continue;
+      }
+      RemoveAgentByIndex(old_index);
+      _mapped_walkers_id[move.first] = index;
+      _mapped_by_index[index] = move.first;
+    }
+  }
+
+  // add or remove the ghosts of the walkers near the border of their tile and copy their state
+  void Navigation::SyncWalkerGhosts() {
+    if (_tiles.size() <= 1u) {
+      return;
+    }
+
+    for (auto &&entry : _mapped_walkers_id) {
+      const dtCrowdAgent *agent = GetAgent(entry.second);
+      if (agent == nullptr || !agent->active) {
+        continue;
+      }
+      const int home = entry.second / _max_agents;
+      std::vector<int> tiles = GetTilesIn(
+          agent->npos[0] - TILE_GHOST_DISTANCE,
+          agent->npos[2] - TILE_GHOST_DISTANCE,
+          agent->npos[0] + TILE_GHOST_DISTANCE,
+          agent->npos[2] + TILE_GHOST_DISTANCE);
+      tiles.erase(std::remove(tiles.begin(), tiles.end(), home), tiles.end());
+
+      auto ghosts_it = _walkers_ghosts.find(entry.first);
+      if (tiles.empty() && ghosts_it == _walkers_ghosts.end()) {
+        continue;
+      }
+      std::vector<int> &ghosts = _walkers_ghosts[entry.first];
+
+      // remove the ghosts of tiles the walker is no longer near of
+      ghosts.erase(std::remove_if(ghosts.begin(), ghosts.end(), [&](int ghost) {
+        if (std::find(tiles.begin(), tiles.end(), ghost / _max_agents) == tiles.end()) {
+          RemoveAgentByIndex(ghost);
+          return true;
+        }
+        return false;
+      }), ghosts.end());
+
+      // add the missing ghosts, they are moved only by this function
+      for (int tile : tiles) {
+        auto has_ghost = [&](int ghost) { return ghost / _max_agents == tile; };
+        if (std::any_of(ghosts.begin(), ghosts.end(), has_ghost)) {
+          continue;
+        }
+        dtCrowdAgentParams params = GetAgent(entry.second)->params;
+        params.maxAcceleration = 0.0f;
+        params.collisionQueryRange = 0;
+        params.obstacleAvoidanceType = 0;
+        params.updateFlags = 0;
+        const int index = AddAgentToTile(tile, GetAgent(entry.second)->npos, params, true);
+        if (index == -1) {
+          continue;
+        }
+        GetEditableAgent(index)->state = DT_CROWDAGENT_STATE_WALKING;
+        ghosts.emplace_back(index);
+        _mapped_by_index[index] = entry.first;
+      }
+
+      // copy the state of the walker
+      agent = GetAgent(entry.second);
+      for (int ghost : ghosts) {
+        dtCrowdAgent *copy = GetEditableAgent(ghost);
+        dtVcopy(copy->npos, agent->npos);
+        dtVcopy(copy->vel, agent->vel);
+        dtVcopy(copy->nvel, agent->nvel);
+        dtVcopy(copy->dvel, agent->dvel);
+      }
+
+      if (ghosts.empty()) {
+        _walkers_ghosts.erase(entry.first);
+      }
+    }
   }
 
   // return the path points to go from one position to another
@@ -393,15 +784,21 @@ namespace nav {
     float poly_pick_ext[3] = {2,4,2};
 
     // get current filter from agent
-    auto it = _mapped_walkers_id.find(id);
-    if (it == _mapped_walkers_id.end())
-      return false;
-
-    const dtQueryFilter *filter;
+    dtQueryFilter filter;
     {
       // critical section, force single thread running this
       std::lock_guard<std::mutex> lock(_mutex);
-      filter = _crowd->getFilter(_crowd->getAgent(it->second)->params.queryFilterType);
+      auto it = _mapped_walkers_id.find(id);
+      if (it == _mapped_walkers_id.end()) {
+        return false;
+      }
+      const dtCrowdAgent *agent = GetAgent(it->second);
+      dtCrowd *crowd = GetCrowd(static_cast<size_t>(it->second / _max_agents));
+      if (agent == nullptr || crowd == nullptr) {
+        return false;
+      }
+      // copied, the crowd is replaced if its tile grows
+      filter = *crowd->getFilter(agent->params.queryFilterType);
     }
 
     // set the points
@@ -412,8 +809,8 @@ namespace nav {
     {
       // critical section, force single thread running this
       std::lock_guard<std::mutex> lock(_mutex);
-      _nav_query->findNearestPoly(start_pos, poly_pick_ext, filter, &start_ref, 0);
-      _nav_query->findNearestPoly(end_pos, poly_pick_ext, filter, &end_ref, 0);
+      _nav_query->findNearestPoly(start_pos, poly_pick_ext, &filter, &start_ref, 0);
+      _nav_query->findNearestPoly(end_pos, poly_pick_ext, &filter, &end_ref, 0);
     }
     if (!start_ref || !end_ref) {
       return false;
@@ -423,7 +820,7 @@ namespace nav {
     {
       // critical section, force single thread running this
       std::lock_guard<std::mutex> lock(_mutex);
-      _nav_query->findPath(start_ref, end_ref, start_pos, end_pos, filter, polys, &num_polys, MAX_POLYS);
+      _nav_query->findPath(start_ref, end_ref, start_pos, end_pos, &filter, polys, &num_polys, MAX_POLYS);
     }
 
     // get the path of points
@@ -478,7 +875,7 @@ namespace nav {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
+    DEBUG_ASSERT(!_tiles.empty());
 
     // set parameters
     memset(&params, 0, sizeof(params));
@@ -507,22 +904,28 @@ namespace nav {
     // (unreal) to bottom (recast))
     float point_from[3] = { from.x, from.z - (AGENT_HEIGHT / 2.0f), from.y };
     // add walker
-    int index;
     {
       // critical section, force single thread running this
       std::lock_guard<std::mutex> lock(_mutex);
-      index = _crowd->addAgent(point_from, &params);
+      // the walker goes to the tile containing it, or to any tile with room until it is handed off
+      const int tile = GetTileAt(from.x, from.y);
+      int index = AddAgentToTile(tile, point_from, params, true);
+      for (int other = 0; index == -1 && other < static_cast<int>(_tiles.size()); ++other) {
+        if (other != tile && _tiles[static_cast<size_t>(other)].crowd != nullptr) {
+          index = AddAgentToTile(other, point_from, params, false);
+        }
+      }
       if (index == -1) {
         return false;
       }
-    }
 
-    // save the id
-    _mapped_walkers_id[id] = index;
-    _mapped_by_index[index] = id;
+      // save the id
+      _mapped_walkers_id[id] = index;
+      _mapped_by_index[index] = id;
 
-    // init yaw
-    _yaw_walkers[id] = 0.0f;
+      // init yaw
+      _yaw_walkers[id] = 0.0f;
+    }
 
     // add walker for the route planning
     _walker_manager.AddWalker(id);
@@ -540,7 +943,7 @@ namespace nav {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
+    DEBUG_ASSERT(!_tiles.empty());
 
     // get the bounding box extension plus some space around
     float marge = 0.8f;
@@ -563,19 +966,34 @@ namespace nav {
     box_corner3 += vehicle.transform.location;
     box_corner4 += vehicle.transform.location;
 
-    // check if this actor exists
-    auto it = _mapped_vehicles_id.find(vehicle.id);
-    if (it != _mapped_vehicles_id.end()) {
-      // get the index found
-      int index = it->second;
-      if (index != -1) {
+    // the vehicle has an agent in each tile near its bounding box
+    const std::vector<int> tiles = GetTilesIn(
+        std::min({box_corner1.x, box_corner2.x, box_corner3.x, box_corner4.x}) - TILE_GHOST_DISTANCE,
+        std::min({box_corner1.y, box_corner2.y, box_corner3.y, box_corner4.y}) - TILE_GHOST_DISTANCE,
+        std::max({box_corner1.x, box_corner2.x, box_corner3.x, box_corner4.x}) + TILE_GHOST_DISTANCE,
+        std::max({box_corner1.y, box_corner2.y, box_corner3.y, box_corner4.y}) + TILE_GHOST_DISTANCE);
+
+    // critical section, force single thread running this
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    std::vector<int> &indices = _mapped_vehicles_id[vehicle.id];
+
+    // remove the agents of the tiles the vehicle is no longer near of
+    indices.erase(std::remove_if(indices.begin(), indices.end(), [&](int index) {
+      if (std::find(tiles.begin(), tiles.end(), index / _max_agents) == tiles.end()) {
+        RemoveAgentByIndex(index);
+        return true;
+      }
+      return false;
+    }), indices.end());
+
+    for (int tile : tiles) {
+      auto it = std::find_if(indices.begin(), indices.end(), [&](int index) {
+        return index / _max_agents == tile;
+      });
+      if (it != indices.end()) {
         // get the agent
-        dtCrowdAgent *agent;
-        {
-          // critical section, force single thread running this
-          std::lock_guard<std::mutex> lock(_mutex);
-          agent = _crowd->getEditableAgent(index);
-        }
+        dtCrowdAgent *agent = GetEditableAgent(*it);
         if (agent) {
           // update its position
           agent->npos[0] = vehicle.transform.location.x;
@@ -595,66 +1013,66 @@ namespace nav {
           agent->params.obb[10] = box_corner4.z;
           agent->params.obb[11] = box_corner4.y;
         }
-        return true;
+        continue;
       }
-    }
-
-    // set parameters
-    memset(&params, 0, sizeof(params));
-    params.radius = 2;
-    params.height = AGENT_HEIGHT;
-    params.maxAcceleration = 0.0f;
-    params.maxSpeed = 1.47f;
-    params.collisionQueryRange = 0;
-    params.obstacleAvoidanceType = 0;
-    params.separationWeight = 100.0f;
-
-    // flags
-    params.updateFlags = 0;
-    params.updateFlags |= DT_CROWD_SEPARATION;
-
-    // update its oriented bounding box
-    // data: [x][y][z] [x][y][z] [x][y][z] [x][y][z]
-    params.useObb = true;
-    params.obb[0]  = box_corner1.x;
-    params.obb[1]  = box_corner1.z;
-    params.obb[2]  = box_corner1.y;
-    params.obb[3]  = box_corner2.x;
-    params.obb[4]  = box_corner2.z;
-    params.obb[5]  = box_corner2.y;
-    params.obb[6]  = box_corner3.x;
-    params.obb[7]  = box_corner3.z;
-    params.obb[8]  = box_corner3.y;
-    params.obb[9]  = box_corner4.x;
-    params.obb[10] = box_corner4.z;
-    params.obb[11] = box_corner4.y;
-
-    // from Unreal coordinates (vertical is Z) to Recast coordinates (vertical is Y)
-    float point_from[3] = { vehicle.transform.location.x,
-                            vehicle.transform.location.z,
-                            vehicle.transform.location.y };
 
-    // add walker
-    int index;
-    {
-      // critical section, force single thread running this
-      std::lock_guard<std::mutex> lock(_mutex);
-      index = _crowd->addAgent(point_from, &params);
+      // set parameters
+      memset(&params, 0, sizeof(params));
+      params.radius = 2;
+      params.height = AGENT_HEIGHT;
+      params.maxAcceleration = 0.0f;
+      params.maxSpeed = 1.47f;
+      params.collisionQueryRange = 0;
+      params.obstacleAvoidanceType = 0;
+      params.separationWeight = 100.0f;
+
+      // flags
+      params.updateFlags = 0;
+      params.updateFlags |= DT_CROWD_SEPARATION;
+
+      // update its oriented bounding box
+      // data: [x][y][z] [x][y][z] [x][y][z] [x][y][z]
+      params.useObb = true;
+      params.obb[0]  = box_corner1.x;
+      params.obb[1]  = box_corner1.z;
+      params.obb[2]  = box_corner1.y;
+      params.obb[3]  = box_corner2.x;
+      params.obb[4]  = box_corner2.z;
+      params.obb[5]  = box_corner2.y;
+      params.obb[6]  = box_corner3.x;
+      params.obb[7]  = box_corner3.z;
+      params.obb[8]  = box_corner3.y;
+      params.obb[9]  = box_corner4.x;
+      params.obb[10] = box_corner4.z;
+      params.obb[11] = box_corner4.y;
+
+      // from Unreal coordinates (vertical is Z) to Recast coordinates (vertical is Y)
+      float point_from[3] = { vehicle.transform.location.x,
+                              vehicle.transform.location.z,
+                              vehicle.transform.location.y };
+
+      // add vehicle
+      int index = AddAgentToTile(tile, point_from, params, true);
       if (index == -1) {
         logging::log("Vehicle agent not added to the crowd by some problem!");
-        return false;
+        continue;
       }
 
       // mark as valid
-      dtCrowdAgent *agent = _crowd->getEditableAgent(index);
+      dtCrowdAgent *agent = GetEditableAgent(index);
       if (agent) {
         agent->state = DT_CROWDAGENT_STATE_WALKING;
       }
+
+      // save the id
+      indices.emplace_back(index);
+      _mapped_by_index[index] = vehicle.id;
     }
 
-    // save the id
-    _mapped_vehicles_id[vehicle.id] = index;
-    _mapped_by_index[index] = vehicle.id;
+    if (indices.empty()) {
+      _mapped_vehicles_id.erase(vehicle.id);
+      return false;
+    }
 
     return true;
   }
@@ -667,37 +1085,40 @@ namespace nav {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
+    DEBUG_ASSERT(!_tiles.empty());
+
+    // critical section, force single thread running this
+    std::lock_guard<std::mutex> lock(_mutex);
 
     // get the internal walker index
     auto it = _mapped_walkers_id.find(id);
     if (it != _mapped_walkers_id.end()) {
       // remove from crowd
-      {
-        // critical section, force single thread running this
-        std::lock_guard<std::mutex> lock(_mutex);
-        _crowd->removeAgent(it->second);
+      RemoveAgentByIndex(it->second);
+      auto ghosts = _walkers_ghosts.find(id);
+      if (ghosts != _walkers_ghosts.end()) {
+        for (int ghost : ghosts->second) {
+          RemoveAgentByIndex(ghost);
+        }
+        _walkers_ghosts.erase(ghosts);
       }
       _walker_manager.RemoveWalker(id);
       // remove from mapping
       _mapped_walkers_id.erase(it);
-      _mapped_by_index.erase(it->second);
+      _walkers_blocked_position.erase(id);
 
       return true;
     }
 
-    // get the internal vehicle index
-    it = _mapped_vehicles_id.find(id);
-    if (it != _mapped_vehicles_id.end()) {
+    // get the internal vehicle indices
+    auto vehicle = _mapped_vehicles_id.find(id);
+    if (vehicle != _mapped_vehicles_id.end()) {
       // remove from crowd
-      {
-        // critical section, force single thread running this
-        std::lock_guard<std::mutex> lock(_mutex);
-        _crowd->removeAgent(it->second);
+      for (int index : vehicle->second) {
+        RemoveAgentByIndex(index);
       }
       // remove from mapping
-      _mapped_vehicles_id.erase(it);
-      _mapped_by_index.erase(it->second);
+      _mapped_vehicles_id.erase(vehicle);
 
       return true;
     }
@@ -710,8 +1131,12 @@ namespace nav {
     std::unordered_set<carla::rpc::ActorId> updated;
 
     // add all current mapped vehicles in the set
-    for (auto &&entry : _mapped_vehicles_id) {
-      updated.insert(entry.first);
+    {
+      // critical section, force single thread running this
+      std::lock_guard<std::mutex> lock(_mutex);
+      for (auto &&entry : _mapped_vehicles_id) {
+        updated.insert(entry.first);
+      }
     }
 
     // add all vehicles (if already exists, it gets updated only)
@@ -739,19 +1164,18 @@ namespace nav {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
-
-    // get the internal index
-    auto it = _mapped_walkers_id.find(id);
-    if (it == _mapped_walkers_id.end()) {
-      return false;
-    }
+    DEBUG_ASSERT(!_tiles.empty());
 
     // get the agent
     {
       // critical section, force single thread running this
       std::lock_guard<std::mutex> lock(_mutex);
-      dtCrowdAgent *agent = _crowd->getEditableAgent(it->second);
+      // get the internal index
+      auto it = _mapped_walkers_id.find(id);
+      if (it == _mapped_walkers_id.end()) {
+        return false;
+      }
+      dtCrowdAgent *agent = GetEditableAgent(it->second);
       if (agent) {
         agent->params.maxSpeed = max_speed;
         return true;
@@ -786,13 +1210,18 @@ namespace nav {
       return false;
     }
 
+    DEBUG_ASSERT(!_tiles.empty());
+
+    // critical section, force single thread running this
+    std::lock_guard<std::mutex> lock(_mutex);
+
     // get the internal index
     auto it = _mapped_walkers_id.find(id);
     if (it == _mapped_walkers_id.end()) {
       return false;
     }
 
-    return SetWalkerDirectTargetIndex(it->second, to);
+    return SetAgentTarget(it->second, to);
   }
 
   // set a new target point to go directly without events
@@ -803,49 +1232,74 @@ namespace nav {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
+    DEBUG_ASSERT(!_tiles.empty());
+
+    // critical section, force single thread running this
+    std::lock_guard<std::mutex> lock(_mutex);
+    return SetAgentTarget(index, to);
+  }
+
+  bool Navigation::SetAgentTarget(int index, carla::geom::Location to) {
     DEBUG_ASSERT(_nav_query != nullptr);
 
     if (index == -1) {
       return false;
     }
 
+    dtCrowd *crowd = GetCrowd(static_cast<size_t>(index / _max_agents));
+    if (crowd == nullptr) {
+      return false;
+    }
+
     // set target position
     float point_to[3] = { to.x, to.z, to.y };
     float nearest[3];
-    bool res;
-    {
-      // critical section, force single thread running this
-      std::lock_guard<std::mutex> lock(_mutex);
-      const dtQueryFilter *filter = _crowd->getFilter(0);
-      dtPolyRef target_ref;
-      _nav_query->findNearestPoly(point_to, _crowd->getQueryHalfExtents(), filter, &target_ref, nearest);
-      if (!target_ref) {
-        return false;
-      }
-
-      res = _crowd->requestMoveTarget(index, target_ref, point_to);
+    const dtQueryFilter *filter = crowd->getFilter(0);
+    dtPolyRef target_ref;
+    _nav_query->findNearestPoly(point_to, crowd->getQueryHalfExtents(), filter, &target_ref, nearest);
+    if (!target_ref) {
+      return false;
     }
 
-    return res;
+    return crowd->requestMoveTarget(index % _max_agents, target_ref, point_to);
   }
 
   // update all walkers in crowd
   void Navigation::UpdateCrowd(const client::detail::EpisodeState &state) {
+    UpdateCrowd(state.GetTimestamp().delta_seconds);
+  }
+
+  void Navigation::UpdateCrowd(double delta_seconds) {
 
     // check if all is ready
     if (!_ready) {
       return;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
+    DEBUG_ASSERT(!_tiles.empty());
 
     // update crowd agents
-    _delta_seconds = state.GetTimestamp().delta_seconds;
+    _delta_seconds = delta_seconds;
     {
       // critical section, force single thread running this
       std::lock_guard<std::mutex> lock(_mutex);
-      _crowd->update(static_cast<float>(_delta_seconds), nullptr);
+      // each tile crowd has its own queries, so the tiles can be updated in parallel
+      const float tile_delta_seconds = static_cast<float>(_delta_seconds);
+      auto update_tile = [this, tile_delta_seconds](size_t tile) {
+        if (_tiles[tile].crowd != nullptr) {
+          _tiles[tile].crowd->update(tile_delta_seconds, nullptr);
+        }
+      };
+      if (_pool != nullptr) {
+        _pool->ParallelFor(0u, _tiles.size(), 1u, update_tile);
+      } else {
+        for (size_t tile = 0u; tile < _tiles.size(); ++tile) {
+          update_tile(tile);
+        }
+      }
+      HandOffWalkers();
+      SyncWalkerGhosts();
+      PublishWalkerStates();
     }
 
     // update the walkers route
@@ -853,69 +1307,59 @@ namespace nav {
 
     // update the time to check for blocked agents
     _time_to_unblock += _delta_seconds;
+    if (_time_to_unblock < AGENT_UNBLOCK_TIME) {
+      return;
+    }
+    _time_to_unblock = 0.0f;
 
-    // check all active agents
-    int total_unblocked = 0;
-    int total_agents;
+    // check all active agents, the new routes are set after releasing the lock as the walker
+    // manager calls back into this class
+    std::vector<ActorId> blocked;
     {
       // critical section, force single thread running this
       std::lock_guard<std::mutex> lock(_mutex);
-      total_agents = _crowd->getAgentCount();
-    }
-    const dtCrowdAgent *ag;
-    for (int i = 0; i < total_agents; ++i) {
-      {
-        // critical section, force single thread running this
-        std::lock_guard<std::mutex> lock(_mutex);
-        ag = _crowd->getAgent(i);
-      }
+      for (size_t tile = 0u; tile < _tiles.size(); ++tile) {
+        for (int i = 0; i < _tiles[tile].capacity; ++i) {
+          const int index = static_cast<int>(tile) * _max_agents + i;
+          const dtCrowdAgent *ag = GetAgent(index);
 
-      if (!ag->active || ag->paused || ag->dead) {
-        continue;
-      }
+          if (ag == nullptr || !ag->active || ag->paused || ag->dead) {
+            continue;
+          }
 
-      // check only pedestrians not paused, and no vehicles
-      if (!ag->params.useObb && !ag->paused) {
-        bool reset_target_pos = false;
-        bool use_same_filter = false;
-
-        // check for unblocking actors
-        if (_time_to_unblock >= AGENT_UNBLOCK_TIME) {
-          // get the distance moved by each actor
-          carla::geom::Vector3D previous = _walkers_blocked_position[i];
-          carla::geom::Vector3D current = carla::geom::Vector3D(ag->npos[0], ag->npos[1], ag->npos[2]);
-          carla::geom::Vector3D distance = current - previous;
-          float d = distance.SquaredLength();
-          if (d < AGENT_UNBLOCK_DISTANCE_SQUARED) {
-            ++total_unblocked;
-            reset_target_pos = true;
-            use_same_filter = true;
+          // skip vehicles and ghosts
+          auto mapped = _mapped_by_index.find(index);
+          if (mapped == _mapped_by_index.end()) {
+            continue;
+          }
+          const ActorId id = mapped->second;
+          auto walker = _mapped_walkers_id.find(id);
+          if (walker == _mapped_walkers_id.end() || walker->second != index) {
+            continue;
           }
-          // update with current position
-          _walkers_blocked_position[i] = current;
-
-          // check to assign a new target position
-          if (reset_target_pos) {
-            // set if the agent can cross roads or not
-            if (!use_same_filter) {
-              if (frand() <= _probability_crossing) {
-                SetAgentFilter(i, 1);
-              } else {
-                SetAgentFilter(i, 0);
-              }
+
+          // check only pedestrians not paused, and no vehicles
+          if (!ag->params.useObb && !ag->paused) {
+            // get the distance moved by each actor
+            carla::geom::Vector3D previous = _walkers_blocked_position[id];
+            carla::geom::Vector3D current = carla::geom::Vector3D(ag->npos[0], ag->npos[1], ag->npos[2]);
+            carla::geom::Vector3D distance = current - previous;
+            float d = distance.SquaredLength();
+            if (d < AGENT_UNBLOCK_DISTANCE_SQUARED) {
+              blocked.emplace_back(id);
             }
-            // set a new random target
-            carla::geom::Location location;
-            GetRandomLocation(location, nullptr);
-            _walker_manager.SetWalkerRoute(_mapped_by_index[i], location);
+            // update with current position
+            _walkers_blocked_position[id] = current;
           }
         }
       }
     }
 
-    // check for resetting time
-    if (_time_to_unblock >= AGENT_UNBLOCK_TIME) {
-      _time_to_unblock = 0.0f;
+    // set a new random target to the blocked walkers, keeping their filter
+    for (ActorId id : blocked) {
+      carla::geom::Location location;
+      GetRandomLocation(location, nullptr);
+      _walker_manager.SetWalkerRoute(id, location);
     }
   }
 
@@ -927,7 +1371,10 @@ namespace nav {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
+    DEBUG_ASSERT(!_tiles.empty());
+
+    // critical section, the crowd of the tile may be replaced by other threads
+    std::lock_guard<std::mutex> lock(_mutex);
 
     // get the internal index
     auto it = _mapped_walkers_id.find(id);
@@ -942,14 +1389,9 @@ namespace nav {
     }
 
     // get the walker
-    const dtCrowdAgent *agent;
-    {
-      // critical section, force single thread running this
-      std::lock_guard<std::mutex> lock(_mutex);
-      agent = _crowd->getAgent(index);
-    }
+    const dtCrowdAgent *agent = GetAgent(index);
 
-    if (!agent->active) {
+    if (agent == nullptr || !agent->active) {
       return false;
     }
 
@@ -958,29 +1400,59 @@ namespace nav {
     trans.location.y = agent->npos[2];
     trans.location.z = agent->npos[1];
 
-    // set its rotation
+    // the rotation is interpolated once per crowd update
+    auto yaw = _yaw_walkers.find(id);
+    trans.rotation.yaw = yaw != _yaw_walkers.end() ? yaw->second : 0.0f;
+
+    return true;
+  }
+
+  float Navigation::UpdateWalkerYaw(ActorId id, const dtCrowdAgent &agent) {
     float yaw;
     float speed = 0.0f;
     float min = 0.1f;
-    if (agent->vel[0] < -min || agent->vel[0] > min ||
-        agent->vel[2] < -min || agent->vel[2] > min) {
-      yaw = atan2f(agent->vel[2], agent->vel[0]) * (180.0f / static_cast<float>(M_PI));
-      speed = sqrtf(agent->vel[0] * agent->vel[0] + agent->vel[1] * agent->vel[1] + agent->vel[2] * agent->vel[2]);
+    if (agent.vel[0] < -min || agent.vel[0] > min ||
+        agent.vel[2] < -min || agent.vel[2] > min) {
+      yaw = atan2f(agent.vel[2], agent.vel[0]) * (180.0f / static_cast<float>(M_PI));
+      speed = sqrtf(agent.vel[0] * agent.vel[0] + agent.vel[1] * agent.vel[1] + agent.vel[2] * agent.vel[2]);
     } else {
-      yaw = atan2f(agent->dvel[2], agent->dvel[0]) * (180.0f / static_cast<float>(M_PI));
-      speed = sqrtf(agent->dvel[0] * agent->dvel[0] + agent->dvel[1] * agent->dvel[1] + agent->dvel[2] * agent->dvel[2]);
+      yaw = atan2f(agent.dvel[2], agent.dvel[0]) * (180.0f / static_cast<float>(M_PI));
+      speed = sqrtf(agent.dvel[0] * agent.dvel[0] + agent.dvel[1] * agent.dvel[1] + agent.dvel[2] * agent.dvel[2]);
     }
 
     // interpolate current and target angle
-    float shortest_angle = fmod(yaw - _yaw_walkers[id] + 540.0f, 360.0f) - 180.0f;
+    float &current_yaw = _yaw_walkers[id];
+    float shortest_angle = fmod(yaw - current_yaw + 540.0f, 360.0f) - 180.0f;
     float per = (speed / 1.5f);
     if (per > 1.0f) per = 1.0f;
     float rotation_speed = per * 6.0f;
-    trans.rotation.yaw = _yaw_walkers[id] +
-    (shortest_angle * rotation_speed * static_cast<float>(_delta_seconds));
-    _yaw_walkers[id] = trans.rotation.yaw;
+    current_yaw += shortest_angle * rotation_speed * static_cast<float>(_delta_seconds);
+    return current_yaw;
+  }
 
-    return true;
+  void Navigation::PublishWalkerStates() {
+    auto states = std::make_shared<WalkerStates>();
+    states->reserve(_mapped_walkers_id.size());
+    for (auto &&walker : _mapped_walkers_id) {
+      const dtCrowdAgent *agent = walker.second == -1 ? nullptr : GetAgent(walker.second);
+      if (agent == nullptr) {
+        continue;
+      }
+
+      WalkerState state;
+      state.transform.location.x = agent->npos[0];
+      state.transform.location.y = agent->npos[2];
+      state.transform.location.z = agent->npos[1];
+      state.speed = sqrtf(agent->vel[0] * agent->vel[0] + agent->vel[1] * agent->vel[1] + agent->vel[2] *
+      agent->vel[2]);
+      state.active = agent->active;
+      state.alive = !agent->dead;
+      if (agent->active) {
+        state.transform.rotation.yaw = UpdateWalkerYaw(walker.first, *agent);
+      }
+      states->emplace(walker.first, state);
+    }
+    _walker_states = std::move(states);
   }
 
   // get the walker current location
@@ -991,7 +1463,10 @@ namespace nav {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
+    DEBUG_ASSERT(!_tiles.empty());
+
+    // critical section, the crowd of the tile may be replaced by other threads
+    std::lock_guard<std::mutex> lock(_mutex);
 
     // get the internal index
     auto it = _mapped_walkers_id.find(id);
@@ -1006,14 +1481,9 @@ namespace nav {
     }
 
     // get the walker
-    const dtCrowdAgent *agent;
-    {
-      // critical section, force single thread running this
-      std::lock_guard<std::mutex> lock(_mutex);
-      agent = _crowd->getAgent(index);
-    }
+    const dtCrowdAgent *agent = GetAgent(index);
 
-    if (!agent->active) {
+    if (agent == nullptr || !agent->active) {
       return false;
     }
 
@@ -1032,7 +1502,10 @@ namespace nav {
       return 0.0f;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
+    DEBUG_ASSERT(!_tiles.empty());
+
+    // critical section, the crowd of the tile may be replaced by other threads
+    std::lock_guard<std::mutex> lock(_mutex);
 
     // get the internal index
     auto it = _mapped_walkers_id.find(id);
@@ -1047,11 +1520,10 @@ namespace nav {
     }
 
     // get the walker
-    const dtCrowdAgent *agent;
-    {
-      // critical section, force single thread running this
-      std::lock_guard<std::mutex> lock(_mutex);
-      agent = _crowd->getAgent(index);
+    const dtCrowdAgent *agent = GetAgent(index);
+
+    if (agent == nullptr) {
+      return 0.0f;
     }
 
     return sqrt(agent->vel[0] * agent->vel[0] + agent->vel[1] * agent->vel[1] + agent->vel[2] *
@@ -1102,14 +1574,13 @@ namespace nav {
   // assign a filter index to an agent
   void Navigation::SetAgentFilter(int agent_index, int filter_index)
   {
+    // critical section, force single thread running this
+    std::lock_guard<std::mutex> lock(_mutex);
     // get the walker
-    dtCrowdAgent *agent;
-    {
-      // critical section, force single thread running this
-      std::lock_guard<std::mutex> lock(_mutex);
-      agent = _crowd->getEditableAgent(agent_index);
+    dtCrowdAgent *agent = GetEditableAgent(agent_index);
+    if (agent) {
+      agent->params.queryFilterType = static_cast<unsigned char>(filter_index);
     }
-    agent->params.queryFilterType = static_cast<unsigned char>(filter_index);
   }
 
   // set the probability that an agent could cross the roads in its path following
@@ -1128,7 +1599,10 @@ namespace nav {
       return;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
+    DEBUG_ASSERT(!_tiles.empty());
+
+    // critical section, force single thread running this
+    std::lock_guard<std::mutex> lock(_mutex);
 
     // get the internal index
     auto it = _mapped_walkers_id.find(id);
@@ -1143,53 +1617,61 @@ namespace nav {
     }
 
     // get the walker
-    dtCrowdAgent *agent;
-    {
-      // critical section, force single thread running this
-      std::lock_guard<std::mutex> lock(_mutex);
-      agent = _crowd->getEditableAgent(index);
+    dtCrowdAgent *agent = GetEditableAgent(index);
+    if (agent) {
+      // mark
+      agent->paused = pause;
     }
-
-    // mark
-    agent->paused = pause;
   }
 
   bool Navigation::HasVehicleNear(ActorId id, float distance, carla::geom::Location direction) {
-    // get the internal index (walker or vehicle)
-    auto it = _mapped_walkers_id.find(id);
-    if (it == _mapped_walkers_id.end()) {
-      it = _mapped_vehicles_id.find(id);
-      if (it == _mapped_vehicles_id.end()) {
-        return false;
-      }
-    }
-
     float dir[3] = { direction.x, direction.z, direction.y };
     bool result;
     {
       // critical section, force single thread running this
       std::lock_guard<std::mutex> lock(_mutex);
-      result = _crowd->hasVehicleNear(it->second, distance * distance, dir, false);
+      // get the internal index (walker or vehicle)
+      int index;
+      auto it = _mapped_walkers_id.find(id);
+      if (it != _mapped_walkers_id.end()) {
+        index = it->second;
+      } else {
+        auto vehicle = _mapped_vehicles_id.find(id);
+        if (vehicle == _mapped_vehicles_id.end() || vehicle->second.empty()) {
+          return false;
+        }
+        index = vehicle->second.front();
+      }
+      dtCrowd *crowd = GetCrowd(static_cast<size_t>(index / _max_agents));
+      if (crowd == nullptr) {
+        return false;
+      }
+      result = crowd->hasVehicleNear(index % _max_agents, distance * distance, dir, false);
     }
     return result;
   }
 
   /// make agent look at some location
   bool Navigation::SetWalkerLookAt(ActorId id, carla::geom::Location location) {
+    // critical section, force single thread running this
+    std::lock_guard<std::mutex> lock(_mutex);
+
     // get the internal index (walker or vehicle)
+    int index;
     auto it = _mapped_walkers_id.find(id);
-    if (it == _mapped_walkers_id.end()) {
-      it = _mapped_vehicles_id.find(id);
-      if (it == _mapped_vehicles_id.end()) {
+    if (it != _mapped_walkers_id.end()) {
+      index = it->second;
+    } else {
+      auto vehicle = _mapped_vehicles_id.find(id);
+      if (vehicle == _mapped_vehicles_id.end() || vehicle->second.empty()) {
         return false;
       }
+      index = vehicle->second.front();
     }
 
-    dtCrowdAgent *agent;
-    {
-      // critical section, force single thread running this
-      std::lock_guard<std::mutex> lock(_mutex);
-      agent = _crowd->getEditableAgent(it->second);
+    dtCrowdAgent *agent = GetEditableAgent(index);
+    if (agent == nullptr) {
+      return false;
     }
 
     // get the position
@@ -1217,7 +1699,10 @@ namespace nav {
       return false;
     }
 
-    DEBUG_ASSERT(_crowd != nullptr);
+    DEBUG_ASSERT(!_tiles.empty());
+
+    // critical section, the crowd of the tile may be replaced by other threads
+    std::lock_guard<std::mutex> lock(_mutex);
 
     // get the internal index
     auto it = _mapped_walkers_id.find(id);
@@ -1232,11 +1717,10 @@ namespace nav {
     }
 
     // get the walker
-    const dtCrowdAgent *agent;
-    {
-      // critical section, force single thread running this
-      std::lock_guard<std::mutex> lock(_mutex);
-      agent = _crowd->getAgent(index);
+    const dtCrowdAgent *agent = GetAgent(index);
+
+    if (agent == nullptr) {
+      return false;
     }
 
     // mark
@@ -7,6 +7,8 @@
 #pragma once
 
 #include "carla/AtomicList.h"
+#include "carla/AtomicSharedPtr.h"
+#include "carla/WorkStealingPool.h"
 #include "carla/client/detail/EpisodeState.h"
 #include "carla/geom/BoundingBox.h"
 #include "carla/geom/Location.h"
@@ -20,6 +22,10 @@
 #include <recast/DetourNavMeshQuery.h>
 #include <recast/DetourCommon.h>
 
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
 namespace carla {
 namespace nav {
 
@@ -50,10 +56,29 @@ namespace nav {
     carla::geom::BoundingBox bounding;
   };
 
+  /// state of a walker at the end of a crowd update
+  struct WalkerState {
+    carla::geom::Transform transform;
+    float speed { 0.0f };
+    bool active { false };
+    bool alive { true };
+  };
+  using WalkerStates = std::unordered_map<carla::rpc::ActorId, WalkerState>;
+
   /// Manage the pedestrians navigation, using the Recast & Detour library for low level calculations.
   ///
   /// This class gets the binary content of the map from the server, which is required for the path finding.
   /// Then this class can add or remove pedestrians, and also set target points to walk for each one.
+  ///
+  /// The crowd can be split in square tiles, each one with its own dtCrowd, that are updated in parallel.
+  /// A walker is simulated in the tile containing it and handed off to the next tile when it crosses the
+  /// border. Walkers near a border and vehicles are also copied as ghost agents to the neighbour tiles so
+  /// the agents of each tile can avoid them.
+  ///
+  /// Agents are identified by a global index, tile * max_agents + index of the agent in the tile crowd.
+  /// The crowd of a tile is replaced when it grows or the settings change, so every access to the tiles
+  /// takes the mutex. The state of all the walkers is published at the end of each crowd update, to be
+  /// read once per tick without taking it.
   class Navigation : private NonCopyable {
 
   public:
@@ -77,6 +102,10 @@ namespace nav {
     void SetSeed(unsigned int seed);
     /// create the crowd object
     void CreateCrowd(void);
+    /// set the maximum number of agents per crowd tile, the size of the tiles in meters (zero for a
+    /// single crowd) and the number of threads updating the tiles. Agents already in the crowd are moved
+    /// to the new tiles
+    void SetCrowdSettings(unsigned int max_agents, float tile_size, unsigned int worker_threads);
     /// create a new walker
     bool AddWalker(ActorId id, carla::geom::Location from);
     /// create a new vehicle in crowd to be avoided by walkers
@@ -92,14 +121,18 @@ namespace nav {
     // set a new target point to go directly without events
     bool SetWalkerDirectTarget(ActorId id, carla::geom::Location to);
     bool SetWalkerDirectTargetIndex(int index, carla::geom::Location to);
-    /// get the walker current transform
+    /// get the walker current location, with the rotation of the last crowd update
     bool GetWalkerTransform(ActorId id, carla::geom::Transform &trans);
     /// get the walker current location
     bool GetWalkerPosition(ActorId id, carla::geom::Location &location);
-    /// get the walker current transform
+    /// get the walker current speed
     float GetWalkerSpeed(ActorId id);
+    /// get the state of all the walkers at the end of the last crowd update, it does not lock the crowd
+    std::shared_ptr<const WalkerStates> GetWalkerStates() const { return _walker_states.load(); }
     /// update all walkers in crowd
     void UpdateCrowd(const client::detail::EpisodeState &state);
+    /// update all walkers in crowd for a step of @a delta_seconds
+    void UpdateCrowd(double delta_seconds);
     /// get a random location for navigation
     bool GetRandomLocation(carla::geom::Location &location, dtQueryFilter * filter = nullptr) const;
     /// set the probability that an agent could cross the roads in its path following
@@ -113,7 +146,11 @@ namespace nav {
     /// return if the agent has been killed by a vehicle
     bool IsWalkerAlive(ActorId id, bool &alive);
 
-    dtCrowd *GetCrowd() { return _crowd; };
+    /// return the number of crowd tiles
+    size_t GetCrowdCount() const;
+    /// call @a callback with each active agent of all the tiles, with the crowd locked; the callback must
+    /// not call this class
+    void ForEachAgent(const std::function<void(const dtCrowdAgent &agent)> &callback) const;
 
     /// return the last delta seconds
     double GetDeltaSeconds() { return _delta_seconds; };
@@ -126,17 +163,33 @@ namespace nav {
     /// meshes
     dtNavMesh *_nav_mesh { nullptr };
     dtNavMeshQuery *_nav_query { nullptr };
-    /// crowd
-    dtCrowd *_crowd { nullptr };
+    /// crowd tiles
+    struct CrowdTile {
+      dtCrowd *crowd { nullptr };
+      int capacity { 0 };
+    };
+    std::vector<CrowdTile> _tiles;
+    int _tiles_x { 1 };
+    int _tiles_y { 1 };
+    float _tiles_origin_x { 0.0f };
+    float _tiles_origin_y { 0.0f };
+    float _tile_size { 0.0f };
+    int _max_agents;
+    std::unique_ptr<WorkStealingPool> _pool;
     /// mapping Id
     std::unordered_map<ActorId, int> _mapped_walkers_id;
-    std::unordered_map<ActorId, int> _mapped_vehicles_id;
+    /// vehicles have one agent in each tile they are near of
+    std::unordered_map<ActorId, std::vector<int>> _mapped_vehicles_id;
+    /// ghost agents of the walkers near the border of their tile
+    std::unordered_map<ActorId, std::vector<int>> _walkers_ghosts;
     // mapping by index also
     std::unordered_map<int, ActorId> _mapped_by_index;
     /// store walkers yaw angle from previous tick
     std::unordered_map<ActorId, float> _yaw_walkers;
+    /// state of the walkers published by the last crowd update
+    AtomicSharedPtr<const WalkerStates> _walker_states { std::make_shared<const WalkerStates>() };
     /// saves the position of each actor at intervals and check if any is blocked
-    std::unordered_map<int, carla::geom::Vector3D> _walkers_blocked_position;
+    std::unordered_map<ActorId, carla::geom::Vector3D> _walkers_blocked_position;
     double _time_to_unblock { 0.0 };
 
     /// walker manager for the route planning with events
@@ -150,6 +203,34 @@ namespace nav {
 
     /// assign a filter index to an agent
     void SetAgentFilter(int agent_index, int filter_index);
+
+    /// crowd tiles helpers, they must be called with the mutex locked
+    dtCrowd *GetCrowd(size_t tile) { return tile < _tiles.size() ? _tiles[tile].crowd : nullptr; };
+    bool SetAgentTarget(int index, carla::geom::Location to);
+    void CreateTiles();
+    void FreeTiles(std::vector<CrowdTile> &tiles);
+    bool CreateTileCrowd(CrowdTile &tile, int capacity);
+    int GetTileAt(float x, float y) const;
+    std::vector<int> GetTilesIn(float min_x, float min_y, float max_x, float max_y) const;
+    const dtCrowdAgent *GetAgent(int index) const;
+    dtCrowdAgent *GetEditableAgent(int index);
+    /// add an agent to a tile, growing the tile crowd if it is full and @a grow is set, returns the
+    /// global index or -1
+    int AddAgentToTile(int tile, const float *pos, const dtCrowdAgentParams &params, bool grow);
+    void RemoveAgentByIndex(int index);
+    /// add a copy of an agent (state and target) to a tile, returns the global index or -1
+    int CopyAgentToTile(const dtCrowdAgent &agent, int tile, bool grow);
+    /// double the capacity of a tile crowd, moving its agents
+    bool GrowTile(int tile);
+    /// replace an agent index in all the mappings
+    void RemapIndex(int old_index, int new_index);
+    /// move the walkers that left their tile and update the ghost agents
+    void HandOffWalkers();
+    void SyncWalkerGhosts();
+    /// turn the walker towards its velocity for a crowd update, returns the new yaw
+    float UpdateWalkerYaw(ActorId id, const dtCrowdAgent &agent);
+    /// publish the state of all the walkers after a crowd update
+    void PublishWalkerStates();
   };
 
 } // namespace nav
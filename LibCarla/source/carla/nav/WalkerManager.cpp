@@ -278,6 +278,9 @@ namespace nav {
         static bool AlreadyCalculated = false;
         if (AlreadyCalculated) return;
 
+        // no simulator when the crowd is used on its own
+        if (_simulator.expired()) return;
+
         // the world
         carla::client::World world = _simulator.lock()->GetWorld();
 
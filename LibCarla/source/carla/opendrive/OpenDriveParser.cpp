@@ -18,13 +18,16 @@
 #include "carla/opendrive/parser/SignalParser.h"
 #include "carla/opendrive/parser/TrafficGroupParser.h"
 #include "carla/road/MapBuilder.h"
+#include "carla/road/MapCache.h"
 
 #include <pugixml/pugixml.hpp>
 
 namespace carla {
 namespace opendrive {
 
-  boost::optional<road::Map> OpenDriveParser::Load(const std::string &opendrive) {
+  static boost::optional<road::Map> Parse(
+      const std::string &opendrive,
+      const road::MapCache *cache) {
     pugi::xml_document xml;
     pugi::xml_parse_result parse_result = xml.load_string(opendrive.c_str());
 
@@ -46,7 +49,28 @@ namespace opendrive {
     parser::ObjectParser::Parse(xml, map_builder);
     parser::ControllerParser::Parse(xml, map_builder);
 
-    return map_builder.Build();
+    return map_builder.Build(cache);
+  }
+
+  boost::optional<road::Map> OpenDriveParser::Load(const std::string &opendrive) {
+    return Parse(opendrive, nullptr);
+  }
+
+  boost::optional<road::Map> OpenDriveParser::Load(
+      const std::string &opendrive,
+      const std::string &cache_path) {
+    const auto hash = road::MapCache::Hash(opendrive);
+    {
+      road::MapCache cache(cache_path, hash);
+      if (cache.IsValid()) {
+        return Parse(opendrive, &cache);
+      }
+    }
+    auto map = Parse(opendrive, nullptr);
+    if (map.has_value() && !road::MapCache::Save(*map, hash, cache_path)) {
+      log_warning("unable to write the map cache", cache_path);
+    }
+    return map;
   }
 
 } // namespace opendrive
@@ -19,6 +19,16 @@ namespace opendrive {
   public:
 
     static boost::optional<road::Map> Load(const std::string &opendrive);
+
+    /// Same as Load(opendrive), but reuses the binary map cache at
+    /// @a cache_path if it was built from the same OpenDRIVE content, and
+    /// writes it otherwise.
+    ///
+    /// @note The cache only holds the R-tree of the map. The OpenDRIVE
+    /// content is still parsed and the map data built on every call.
+    static boost::optional<road::Map> Load(
+        const std::string &opendrive,
+        const std::string &cache_path);
   };
 
 } // namespace opendrive
@@ -6,11 +6,14 @@
 
 #pragma once
 
+#include "carla/Debug.h"
 #include "carla/FileSystem.h"
 
+#include <cstdint>
 #include <fstream>
 #include <iterator>
 #include <iomanip>
+#include <type_traits>
 
 namespace carla {
 namespace pointcloud {
@@ -20,7 +23,7 @@ namespace pointcloud {
   public:
     template <typename PointIt>
     static void Dump(std::ostream &out, PointIt begin, PointIt end) {
-      WriteHeader(out, begin, end);
+      WriteHeader(out, "ascii", begin, end);
       for (; begin != end; ++begin) {
         begin->WriteDetection(out);
         out << '\n';
@@ -35,11 +38,37 @@ namespace pointcloud {
       return path;
     }
 
+    /// Write the points as a binary PLY. The detections are written as they
+    /// are laid out in memory, so their layout must match the properties
+    /// declared by WritePlyHeaderInfo, without padding.
+    template <typename PointT>
+    static void DumpBinary(std::ostream &out, const PointT *begin, const PointT *end) {
+      static_assert(std::is_trivially_copyable<PointT>::value, "Points must be trivially copyable");
+      WriteHeader(out, IsLittleEndian() ? "binary_little_endian" : "binary_big_endian", begin, end);
+      out.write(
+          reinterpret_cast<const char *>(begin),
+          static_cast<std::streamsize>(sizeof(PointT) * static_cast<size_t>(end - begin)));
+    }
+
+    template <typename PointT>
+    static std::string SaveBinaryToDisk(std::string path, const PointT *begin, const PointT *end) {
+      FileSystem::ValidateFilePath(path, ".ply");
+      std::ofstream out(path, std::ios::binary);
+      DumpBinary(out, begin, end);
+      return path;
+    }
+
   private:
-    template <typename PointIt> static void WriteHeader(std::ostream &out, PointIt begin, PointIt end) {
+    static bool IsLittleEndian() {
+      const uint16_t one = 1u;
+      return *reinterpret_cast<const uint8_t *>(&one) == 1u;
+    }
+
+    template <typename PointIt>
+    static void WriteHeader(std::ostream &out, const char *format, PointIt begin, PointIt end) {
       DEBUG_ASSERT(std::distance(begin, end) >= 0);
       out << "ply\n"
-           "format ascii 1.0\n"
+           "format " << format << " 1.0\n"
            "element vertex " << std::to_string(static_cast<size_t>(std::distance(begin, end))) << "\n";
       begin->WritePlyHeaderInfo(out);
       out << "\nend_header\n";
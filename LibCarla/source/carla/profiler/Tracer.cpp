@@ -0,0 +1,332 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/profiler/Tracer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace carla {
+namespace profiler {
+
+  constexpr size_t Tracer::DEFAULT_EVENTS_PER_THREAD;
+
+  std::atomic_bool Tracer::_enabled{false};
+
+  namespace {
+
+    enum class EventType : uint8_t {
+      Span,
+      Counter
+    };
+
+    /// Fields are relaxed atomics, free on the supported platforms, so that
+    /// exporting while the owner thread overwrites the event is not a data
+    /// race. Torn events are detected and discarded by the exporter.
+    struct Event {
+      std::atomic<const char *> category;
+      std::atomic<const char *> name;
+      std::atomic<uint64_t> timestamp;
+      /// Duration in nanoseconds of a span or bits of the value of a counter.
+      std::atomic<uint64_t> payload;
+      std::atomic<EventType> type;
+    };
+
+    struct EventCopy {
+      const char *category;
+      const char *name;
+      uint64_t timestamp;
+      uint64_t payload;
+      EventType type;
+    };
+
+    /// Ring buffer written by a single thread and read by the exporter.
+    class ThreadEvents {
+    public:
+
+      ThreadEvents(uint32_t thread_id, size_t capacity)
+        : id(thread_id),
+          _events(new Event[capacity]),
+          _mask(capacity - 1u) {}
+
+      void Push(const char *category, const char *event_name, uint64_t timestamp, uint64_t payload, EventType type) {
+        const uint64_t head = _head.load(std::memory_order_relaxed);
+        Event &event = _events[head & _mask];
+        event.category.store(category, std::memory_order_relaxed);
+        event.name.store(event_name, std::memory_order_relaxed);
+        event.timestamp.store(timestamp, std::memory_order_relaxed);
+        event.payload.store(payload, std::memory_order_relaxed);
+        event.type.store(type, std::memory_order_relaxed);
+        _head.store(head + 1u, std::memory_order_release);
+      }
+
+      void Clear() {
+        _first.store(_head.load(std::memory_order_acquire), std::memory_order_relaxed);
+      }
+
+      /// Copy the events recorded since the last Clear that were not
+      /// overwritten while copying.
+      std::vector<EventCopy> Copy() const {
+        const uint64_t capacity = _mask + 1u;
+        const uint64_t head = _head.load(std::memory_order_acquire);
+        const uint64_t first = _first.load(std::memory_order_relaxed);
+        uint64_t begin = std::max(first, head > capacity ? head - capacity : 0u);
+        std::vector<EventCopy> events;
+        events.reserve(static_cast<size_t>(head - begin));
+        for (uint64_t i = begin; i < head; ++i) {
+          const Event &event = _events[i & _mask];
+          events.push_back(EventCopy{
+              event.category.load(std::memory_order_relaxed),
+              event.name.load(std::memory_order_relaxed),
+              event.timestamp.load(std::memory_order_relaxed),
+              event.payload.load(std::memory_order_relaxed),
+              event.type.load(std::memory_order_relaxed)});
+        }
+        // Events the owner thread started writing while copying are torn.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t new_head = _head.load(std::memory_order_relaxed);
+        const uint64_t overwritten = new_head + 1u > capacity ? new_head + 1u - capacity : 0u;
+        if (overwritten > begin) {
+          const size_t discarded = static_cast<size_t>(std::min(overwritten, head) - begin);
+          events.erase(events.begin(), events.begin() + static_cast<std::ptrdiff_t>(discarded));
+        }
+        return events;
+      }
+
+      const uint32_t id;
+
+      /// Guarded by the registry mutex.
+      std::string name;
+
+    private:
+
+      std::unique_ptr<Event[]> _events;
+
+      const uint64_t _mask;
+
+      std::atomic<uint64_t> _head{0u};
+
+      std::atomic<uint64_t> _first{0u};
+    };
+
+    /// Buffers of every thread that recorded an event, kept after the thread
+    /// exits so its events can still be exported.
+    struct Registry {
+      std::mutex mutex;
+      std::vector<std::shared_ptr<ThreadEvents>> threads;
+      std::unordered_set<std::string> names;
+      size_t events_per_thread = Tracer::DEFAULT_EVENTS_PER_THREAD;
+    };
+
+    Registry &GetRegistry() {
+      static Registry registry;
+      return registry;
+    }
+
+    /// Name given to the calling thread, kept until its buffer is created.
+    std::string &GetThreadName() {
+      static thread_local std::string name;
+      return name;
+    }
+
+    std::shared_ptr<ThreadEvents> &GetThreadEventsPtr() {
+      static thread_local std::shared_ptr<ThreadEvents> events;
+      return events;
+    }
+
+    /// Buffers are created on the first event, threads that never record
+    /// while the tracer is enabled do not allocate one.
+    ThreadEvents &GetThreadEvents() {
+      auto &events = GetThreadEventsPtr();
+      if (events == nullptr) {
+        Registry &registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        const auto id = static_cast<uint32_t>(registry.threads.size() + 1u);
+        events = std::make_shared<ThreadEvents>(id, registry.events_per_thread);
+        events->name = GetThreadName();
+        registry.threads.push_back(events);
+      }
+      return *events;
+    }
+
+    const auto EPOCH = std::chrono::steady_clock::now();
+
+    void WriteEscaped(std::string &out, const char *text) {
+      for (const char *c = text; *c != '\0'; ++c) {
+        switch (*c) {
+          case '"':  out += "\\\""; break;
+          case '\\': out += "\\\\"; break;
+          case '\n': out += "\\n"; break;
+          case '\t': out += "\\t"; break;
+          default:
+            if (static_cast<unsigned char>(*c) < 0x20u) {
+              char escaped[8u];
+              std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(*c));
+              out += escaped;
+            } else {
+              out += *c;
+            }
+        }
+      }
+    }
+
+    /// Chrome traces are in microseconds, keep the nanoseconds as decimals.
+    void WriteMicroseconds(std::string &out, uint64_t nanoseconds) {
+      char buffer[32u];
+      std::snprintf(buffer, sizeof(buffer), "%llu.%03u",
+          static_cast<unsigned long long>(nanoseconds / 1000u),
+          static_cast<unsigned>(nanoseconds % 1000u));
+      out += buffer;
+    }
+
+  } // namespace
+
+  void Tracer::Enable(size_t events_per_thread) {
+    size_t capacity = 2u;
+    while (capacity < events_per_thread) {
+      capacity *= 2u;
+    }
+    {
+      Registry &registry = GetRegistry();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      registry.events_per_thread = capacity;
+    }
+    _enabled.store(true);
+  }
+
+  void Tracer::Disable() {
+    _enabled.store(false);
+  }
+
+  void Tracer::Clear() {
+    Registry &registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (auto &thread : registry.threads) {
+      thread->Clear();
+    }
+  }
+
+  void Tracer::SetThreadName(const std::string &name) {
+    GetThreadName() = name;
+    auto &events = GetThreadEventsPtr();
+    if (events != nullptr) {
+      Registry &registry = GetRegistry();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      events->name = name;
+    }
+  }
+
+  uint64_t Tracer::Now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - EPOCH).count());
+  }
+
+  const char *Tracer::Intern(const std::string &name) {
+    // Look up first in a per-thread cache to avoid locking.
+    static thread_local std::unordered_map<std::string, const char *> cache;
+    const auto it = cache.find(name);
+    if (it != cache.end()) {
+      return it->second;
+    }
+    const char *interned = nullptr;
+    {
+      Registry &registry = GetRegistry();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      interned = registry.names.insert(name).first->c_str();
+    }
+    cache.emplace(name, interned);
+    return interned;
+  }
+
+  void Tracer::RecordSpan(const char *category, const char *name, uint64_t begin) {
+    const uint64_t end = Now();
+    GetThreadEvents().Push(category, name, begin, end - begin, EventType::Span);
+  }
+
+  void Tracer::RecordCounter(const char *category, const char *name, double value) {
+    uint64_t payload;
+    static_assert(sizeof(payload) == sizeof(value), "Unexpected size of double");
+    std::memcpy(&payload, &value, sizeof(payload));
+    GetThreadEvents().Push(category, name, Now(), payload, EventType::Counter);
+  }
+
+  std::string Tracer::GetChromeTrace() {
+    std::vector<std::shared_ptr<ThreadEvents>> threads;
+    std::vector<std::string> thread_names;
+    {
+      Registry &registry = GetRegistry();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      threads = registry.threads;
+      for (const auto &thread : threads) {
+        thread_names.push_back(thread->name);
+      }
+    }
+
+    std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first_event = true;
+    auto begin_event = [&]() {
+      out += first_event ? "\n" : ",\n";
+      first_event = false;
+    };
+    for (size_t i = 0u; i < threads.size(); ++i) {
+      const std::string tid = std::to_string(threads[i]->id);
+      if (!thread_names[i].empty()) {
+        begin_event();
+        out += "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" + tid + ",\"args\":{\"name\":\"";
+        WriteEscaped(out, thread_names[i].c_str());
+        out += "\"}}";
+      }
+      for (const EventCopy &event : threads[i]->Copy()) {
+        begin_event();
+        out += "{\"cat\":\"";
+        WriteEscaped(out, event.category);
+        out += "\",\"name\":\"";
+        WriteEscaped(out, event.name);
+        out += "\",\"pid\":1,\"tid\":" + tid + ",\"ts\":";
+        WriteMicroseconds(out, event.timestamp);
+        if (event.type == EventType::Span) {
+          out += ",\"ph\":\"X\",\"dur\":";
+          WriteMicroseconds(out, event.payload);
+          out += "}";
+        } else {
+          double value;
+          std::memcpy(&value, &event.payload, sizeof(value));
+          out += ",\"ph\":\"C\",\"args\":{\"value\":";
+          if (std::isfinite(value)) {
+            char buffer[32u];
+            std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+            out += buffer;
+          } else {
+            // JSON has no representation for NaN and infinity.
+            out += "null";
+          }
+          out += "}}";
+        }
+      }
+    }
+    out += "\n]}\n";
+    return out;
+  }
+
+  bool Tracer::SaveChromeTrace(const std::string &path) {
+    const std::string trace = GetChromeTrace();
+    std::ofstream out(path, std::ios::trunc | std::ios::binary);
+    out.write(trace.data(), static_cast<std::streamsize>(trace.size()));
+    out.close();
+    return out.good();
+  }
+
+} // namespace profiler
+} // namespace carla
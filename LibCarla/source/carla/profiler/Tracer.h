@@ -0,0 +1,135 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace carla {
+namespace profiler {
+
+  /// Timeline of what every thread of the process is doing, to find out why a
+  /// given frame was slow.
+  ///
+  /// Each thread records spans and counters in its own ring buffer without
+  /// locking. When the buffer is full the oldest events are overwritten. The
+  /// recorded events can be exported at any time, from any thread, in the
+  /// Chrome trace event format that chrome://tracing and Perfetto open.
+  ///
+  /// The tracer is disabled by default, a disabled trace point costs a single
+  /// relaxed atomic load. Defining LIBCARLA_DISABLE_TRACING removes the trace
+  /// points at compile time.
+  class Tracer {
+  public:
+
+    static constexpr size_t DEFAULT_EVENTS_PER_THREAD = 1u << 16u;
+
+    /// Start recording events. @a events_per_thread, rounded up to a power of
+    /// two, is the capacity of the buffers of threads that record their first
+    /// event from now on.
+    static void Enable(size_t events_per_thread = DEFAULT_EVENTS_PER_THREAD);
+
+    static void Disable();
+
+    static bool IsEnabled() {
+      return _enabled.load(std::memory_order_relaxed);
+    }
+
+    /// Discard the events recorded so far.
+    static void Clear();
+
+    /// Name of the calling thread in the exported trace.
+    static void SetThreadName(const std::string &name);
+
+    /// Nanoseconds elapsed since the tracer was loaded, monotonic.
+    static uint64_t Now();
+
+    /// Return a pointer to a copy of @a name that lives as long as the
+    /// process, so names built at run time can be recorded.
+    static const char *Intern(const std::string &name);
+
+    /// Record a span that started at @a begin and ends now. @a category and
+    /// @a name must outlive the tracer, string literals or interned names.
+    static void RecordSpan(const char *category, const char *name, uint64_t begin);
+
+    /// Record the value of a counter at this moment.
+    static void RecordCounter(const char *category, const char *name, double value);
+
+    /// Return the recorded events as a Chrome trace JSON document.
+    static std::string GetChromeTrace();
+
+    /// Write the recorded events as a Chrome trace JSON document to @a path.
+    /// Return false if the file could not be written.
+    static bool SaveChromeTrace(const std::string &path);
+
+  private:
+
+    static std::atomic_bool _enabled;
+  };
+
+namespace detail {
+
+  class ScopedTrace {
+  public:
+
+    ScopedTrace(const char *category, const char *name)
+      : _enabled(Tracer::IsEnabled()),
+        _category(category),
+        _name(name),
+        _begin(_enabled ? Tracer::Now() : 0u) {}
+
+    ScopedTrace(const char *category, const std::string &name)
+      : _enabled(Tracer::IsEnabled()),
+        _category(category),
+        _name(_enabled ? Tracer::Intern(name) : nullptr),
+        _begin(_enabled ? Tracer::Now() : 0u) {}
+
+    ScopedTrace(const ScopedTrace &) = delete;
+    ScopedTrace &operator=(const ScopedTrace &) = delete;
+
+    ~ScopedTrace() {
+      if (_enabled) {
+        Tracer::RecordSpan(_category, _name, _begin);
+      }
+    }
+
+  private:
+
+    /// Whether the tracer was enabled when the scope was entered.
+    const bool _enabled;
+
+    const char *_category;
+
+    const char *_name;
+
+    const uint64_t _begin;
+  };
+
+} // namespace detail
+} // namespace profiler
+} // namespace carla
+
+#define CARLA_TRACE_CONCAT_IMPL(lhs, rhs) lhs ## rhs
+#define CARLA_TRACE_CONCAT(lhs, rhs) CARLA_TRACE_CONCAT_IMPL(lhs, rhs)
+
+#ifdef LIBCARLA_DISABLE_TRACING
+#  define CARLA_TRACE_SCOPE(category, name)
+#  define CARLA_TRACE_COUNTER(category, name, value)
+#else
+/// Record a span from this point to the end of the enclosing scope. @a name
+/// is either a string literal or a std::string, interned while tracing.
+#  define CARLA_TRACE_SCOPE(category, name) \
+    ::carla::profiler::detail::ScopedTrace CARLA_TRACE_CONCAT(carla_trace_scope_, __LINE__)(category, name)
+#  define CARLA_TRACE_COUNTER(category, name, value) \
+    do { \
+      if (::carla::profiler::Tracer::IsEnabled()) { \
+        ::carla::profiler::Tracer::RecordCounter(category, name, static_cast<double>(value)); \
+      } \
+    } while (false)
+#endif // LIBCARLA_DISABLE_TRACING
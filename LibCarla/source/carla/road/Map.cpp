@@ -6,9 +6,11 @@
 
 #include "carla/road/Map.h"
 #include "carla/Exception.h"
+#include "carla/WorkStealingPool.h"
 #include "carla/geom/Math.h"
 #include "carla/geom/Vector3D.h"
 #include "carla/road/MeshFactory.h"
+#include "carla/road/MapCache.h"
 #include "carla/road/Deformation.h"
 #include "carla/road/element/LaneCrossingCalculator.h"
 #include "carla/road/element/RoadInfoCrosswalk.h"
@@ -22,6 +24,8 @@
 
 #include "marchingcube/MeshReconstruction.h"
 
+#include <algorithm>
+#include <array>
 #include <vector>
 #include <unordered_map>
 #include <stdexcept>
@@ -152,12 +156,167 @@ namespace road {
     }
   }
 
+  /// Returns the waypoint at @a delta_s from @a start along the lane, as long
+  /// as it does not go past @a end.
+  static Waypoint GetWaypointInSegment(
+      const Map &map,
+      const Waypoint &start,
+      const Waypoint &end,
+      double delta_s) {
+    if (start.lane_id < 0) {
+      double final_s = start.s + delta_s;
+      if (final_s >= end.s) {
+        return end;
+      } else if (delta_s <= 0) {
+        return start;
+      } else {
+        return map.GetNext(start, delta_s).front();
+      }
+    } else {
+      double final_s = start.s - delta_s;
+      if (final_s <= end.s) {
+        return end;
+      } else if (delta_s <= 0) {
+        return start;
+      } else {
+        return map.GetNext(start, delta_s).front();
+      }
+    }
+  }
+
+  /// Whether @a pos lies within half the lane width of @a waypoint.
+  static bool IsInsideLane(
+      const Map &map,
+      const Waypoint &waypoint,
+      const geom::Location &pos) {
+    const auto dist = geom::Math::Distance2D(map.ComputeTransform(waypoint).location, pos);
+    const auto lane_width_info = map.GetLane(waypoint).GetInfo<RoadInfoLaneWidth>(waypoint.s);
+    const auto half_lane_width =
+        lane_width_info->GetPolynomial().Evaluate(waypoint.s) * 0.5;
+    return dist < half_lane_width;
+  }
+
+  /// Interleaves the bits of the grid cell containing @a pos, sorting by this
+  /// key visits nearby locations consecutively.
+  static uint64_t GetMortonKey(const geom::Location &pos) {
+    constexpr float cell_size = 8.0f; // [meters]
+    constexpr float max_cell = static_cast<float>(1 << 30);
+    auto cell = [](float value) {
+      const float index = geom::Math::Clamp(std::floor(value / cell_size), -max_cell, max_cell);
+      return static_cast<uint64_t>(static_cast<int64_t>(index) + (int64_t(1) << 31));
+    };
+    auto spread = [](uint64_t value) {
+      value &= 0xFFFFFFFFu;
+      value = (value | (value << 16u)) & 0x0000FFFF0000FFFFu;
+      value = (value | (value << 8u)) & 0x00FF00FF00FF00FFu;
+      value = (value | (value << 4u)) & 0x0F0F0F0F0F0F0F0Fu;
+      value = (value | (value << 2u)) & 0x3333333333333333u;
+      value = (value | (value << 1u)) & 0x5555555555555555u;
+      return value;
+    };
+    return spread(cell(pos.x)) | (spread(cell(pos.y)) << 1u);
+  }
+
+  /// Remembers the result of the lane type filter for the lanes recently
+  /// visited by the nearest neighbour queries of a batch.
+  class LaneTypeFilterCache {
+  public:
+
+    LaneTypeFilterCache(const Map &map, int32_t lane_type)
+      : _map(map),
+        _lane_type(lane_type) {}
+
+    bool operator()(const Waypoint &waypoint) {
+      auto &entry = _entries[
+          (waypoint.road_id * 31u + waypoint.section_id * 7u +
+          static_cast<uint32_t>(waypoint.lane_id)) % _entries.size()];
+      if (!entry.valid ||
+          entry.road_id != waypoint.road_id ||
+          entry.section_id != waypoint.section_id ||
+          entry.lane_id != waypoint.lane_id) {
+        const Lane &lane = _map.GetLane(waypoint);
+        entry.road_id = waypoint.road_id;
+        entry.section_id = waypoint.section_id;
+        entry.lane_id = waypoint.lane_id;
+        entry.accepted = (_lane_type & static_cast<int32_t>(lane.GetType())) > 0;
+        entry.valid = true;
+      }
+      return entry.accepted;
+    }
+
+  private:
+
+    struct Entry {
+      RoadId road_id = 0u;
+      SectionId section_id = 0u;
+      LaneId lane_id = 0;
+      bool accepted = false;
+      bool valid = false;
+    };
+
+    const Map &_map;
+
+    const int32_t _lane_type;
+
+    std::array<Entry, 64u> _entries;
+  };
+
   /// Assumes road_id and section_id are valid.
   static bool IsLanePresent(const MapData &data, Waypoint waypoint) {
     const auto &section = data.GetRoad(waypoint.road_id).GetLaneSectionById(waypoint.section_id);
     return section.ContainsLane(waypoint.lane_id);
   }
 
+  using LaneTypeMeshes = std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>>;
+
+  /// Pool shared by all the mesh generation functions.
+  static WorkStealingPool &GetMeshGenerationPool() {
+    static WorkStealingPool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1u);
+    return pool;
+  }
+
+  /// Call @a generate(i) for every i in [0, count) on the mesh generation
+  /// pool, one road or junction per task so long roads are balanced among the
+  /// threads. The results are returned in index order, merging them in that
+  /// order gives the same output than a sequential loop.
+  template <typename T, typename FuncT>
+  static std::vector<T> GenerateInParallel(size_t count, FuncT &&generate) {
+    std::vector<T> results(count);
+    GetMeshGenerationPool().ParallelFor(0u, count, 1u, [&](size_t i) {
+      results[i] = generate(i);
+    });
+    return results;
+  }
+
+  static void AppendMeshes(LaneTypeMeshes &out, LaneTypeMeshes &meshes) {
+    for (auto &&pair : meshes) {
+      auto &list = out[pair.first];
+      list.insert(
+          list.end(),
+          std::make_move_iterator(pair.second.begin()),
+          std::make_move_iterator(pair.second.end()));
+    }
+  }
+
+  /// Roads outside junctions, in the order they are stored in the map.
+  static std::vector<const Road *> GetRoadsOutsideJunctions(const MapData &data) {
+    std::vector<const Road *> roads;
+    for (auto &&pair : data.GetRoads()) {
+      if (!pair.second.IsJunction()) {
+        roads.emplace_back(&pair.second);
+      }
+    }
+    return roads;
+  }
+
+  static std::vector<const Junction *> GetJunctions(const MapData &data) {
+    std::vector<const Junction *> junctions;
+    for (auto &&pair : data.GetJunctions()) {
+      junctions.emplace_back(&pair.second);
+    }
+    return junctions;
+  }
+
   // ===========================================================================
   // -- Map: Geometry ----------------------------------------------------------
   // ===========================================================================
@@ -183,30 +342,11 @@ namespace road {
         geom::Vector3D(s1.get<0>(), s1.get<1>(), s1.get<2>()),
         geom::Vector3D(s2.get<0>(), s2.get<1>(), s2.get<2>()));
 
-    Waypoint result_start = query_result.front().second.first;
-    Waypoint result_end = query_result.front().second.second;
-
-    if (result_start.lane_id < 0) {
-      double delta_s = distance_to_segment.first;
-      double final_s = result_start.s + delta_s;
-      if (final_s >= result_end.s) {
-        return result_end;
-      } else if (delta_s <= 0) {
-        return result_start;
-      } else {
-        return GetNext(result_start, delta_s).front();
-      }
-    } else {
-      double delta_s = distance_to_segment.first;
-      double final_s = result_start.s - delta_s;
-      if (final_s <= result_end.s) {
-        return result_end;
-      } else if (delta_s <= 0) {
-        return result_start;
-      } else {
-        return GetNext(result_start, delta_s).front();
-      }
-    }
+    return GetWaypointInSegment(
+        *this,
+        query_result.front().second.first,
+        query_result.front().second.second,
+        distance_to_segment.first);
   }
 
   boost::optional<Waypoint> Map::GetWaypoint(
@@ -218,18 +358,92 @@ namespace road {
       return w;
     }
 
-    const auto dist = geom::Math::Distance2D(ComputeTransform(*w).location, pos);
-    const auto lane_width_info = GetLane(*w).GetInfo<RoadInfoLaneWidth>(w->s);
-    const auto half_lane_width =
-        lane_width_info->GetPolynomial().Evaluate(w->s) * 0.5;
-
-    if (dist < half_lane_width) {
+    if (IsInsideLane(*this, *w, pos)) {
       return w;
     }
 
     return boost::optional<Waypoint>{};
   }
 
+  std::vector<boost::optional<Waypoint>> Map::GetClosestWaypointsOnRoad(
+      const std::vector<geom::Location> &locations,
+      int32_t lane_type) const {
+    std::vector<boost::optional<Waypoint>> result(locations.size());
+
+    // Visit the locations in Morton order, consecutive queries then traverse
+    // the same branches of the tree and filter the same lanes.
+    std::vector<std::pair<uint64_t, size_t>> order;
+    order.reserve(locations.size());
+    for (size_t i = 0u; i < locations.size(); ++i) {
+      order.emplace_back(GetMortonKey(locations[i]), i);
+    }
+    std::sort(order.begin(), order.end());
+
+    LaneTypeFilterCache filter(*this, lane_type);
+    std::vector<size_t> found;
+    std::vector<std::pair<Waypoint, Waypoint>> segment_ends;
+    std::vector<float> px, py, ax, ay, bx, by;
+    found.reserve(locations.size());
+    segment_ends.reserve(locations.size());
+    for (auto *v : {&px, &py, &ax, &ay, &bx, &by}) {
+      v->reserve(locations.size());
+    }
+    for (const auto &item : order) {
+      const auto &pos = locations[item.second];
+      std::vector<Rtree::TreeElement> query_result =
+          _rtree.GetNearestNeighboursWithFilter(Rtree::BPoint(pos.x, pos.y, pos.z),
+          [&](Rtree::TreeElement const &element) {
+            return filter(element.second.first);
+          });
+      if (query_result.size() == 0) {
+        continue;
+      }
+      const auto &segment = query_result.front().first;
+      found.emplace_back(item.second);
+      segment_ends.emplace_back(query_result.front().second);
+      px.emplace_back(pos.x);
+      py.emplace_back(pos.y);
+      ax.emplace_back(segment.first.get<0>());
+      ay.emplace_back(segment.first.get<1>());
+      bx.emplace_back(segment.second.get<0>());
+      by.emplace_back(segment.second.get<1>());
+    }
+
+    // Same computation as geom::Math::DistanceSegmentToPoint, written without
+    // branches so the compiler can vectorize it.
+    const size_t count = found.size();
+    std::vector<float> delta_s(count);
+    for (size_t i = 0u; i < count; ++i) {
+      const float wx = bx[i] - ax[i];
+      const float wy = by[i] - ay[i];
+      const float l2 = wx * wx + wy * wy;
+      const float dot = (px[i] - ax[i]) * wx + (py[i] - ay[i]) * wy;
+      const float t = std::min(std::max(dot / std::max(l2, std::numeric_limits<float>::min()), 0.0f), 1.0f);
+      delta_s[i] = t * std::sqrt(l2);
+    }
+
+    for (size_t i = 0u; i < count; ++i) {
+      result[found[i]] = GetWaypointInSegment(
+          *this,
+          segment_ends[i].first,
+          segment_ends[i].second,
+          delta_s[i]);
+    }
+    return result;
+  }
+
+  std::vector<boost::optional<Waypoint>> Map::GetWaypoints(
+      const std::vector<geom::Location> &locations,
+      int32_t lane_type) const {
+    auto result = GetClosestWaypointsOnRoad(locations, lane_type);
+    for (size_t i = 0u; i < result.size(); ++i) {
+      if (result[i].has_value() && !IsInsideLane(*this, *result[i], locations[i])) {
+        result[i] = boost::none;
+      }
+    }
+    return result;
+  }
+
   boost::optional<Waypoint> Map::GetWaypoint(
       RoadId road_id,
       LaneId lane_id,
@@ -884,6 +1098,31 @@ namespace road {
     }
   }
 
+  Map::Map(MapData m, const MapCache &cache) : _data(std::move(m)) {
+    DEBUG_ASSERT(cache.IsValid());
+    std::vector<Rtree::TreeElement> rtree_elements;
+    rtree_elements.reserve(cache._size);
+    for (size_t i = 0u; i < cache._size; ++i) {
+      const auto &element = cache._elements[i];
+      rtree_elements.emplace_back(
+          Rtree::BSegment(
+              Rtree::BPoint(element.start[0u], element.start[1u], element.start[2u]),
+              Rtree::BPoint(element.end[0u], element.end[1u], element.end[2u])),
+          std::make_pair(
+              Waypoint{
+                  element.start_waypoint.road_id,
+                  element.start_waypoint.section_id,
+                  element.start_waypoint.lane_id,
+                  element.start_waypoint.s},
+              Waypoint{
+                  element.end_waypoint.road_id,
+                  element.end_waypoint.section_id,
+                  element.end_waypoint.lane_id,
+                  element.end_waypoint.s}));
+    }
+    _rtree.BulkLoad(rtree_elements.begin(), rtree_elements.end());
+  }
+
   void Map::CreateRtree() {
     const double epsilon = 0.000001; // small delta in the road (set to 1
                                      // micrometer to prevent numeric errors)
@@ -1013,18 +1252,18 @@ namespace road {
     mesh_factory.road_param.resolution = static_cast<float>(distance);
     mesh_factory.road_param.extra_lane_width = extra_width;
 
-    // Generate roads outside junctions
-    for (auto &&pair : _data.GetRoads()) {
-      const auto &road = pair.second;
-      if (road.IsJunction()) {
-        continue;
+    const auto roads = GetRoadsOutsideJunctions(_data);
+    const auto junctions = GetJunctions(_data);
+
+    auto meshes = GenerateInParallel<std::unique_ptr<geom::Mesh>>(
+        roads.size() + junctions.size(), [&](size_t i) {
+      // Generate roads outside junctions
+      if (i < roads.size()) {
+        return mesh_factory.Generate(*roads[i]);
       }
-      out_mesh += *mesh_factory.Generate(road);
-    }
 
-    // Generate roads within junctions and smooth them
-    for (const auto &junc_pair : _data.GetJunctions()) {
-      const auto &junction = junc_pair.second;
+      // Generate roads within junctions and smooth them
+      const auto &junction = *junctions[i - roads.size()];
       std::vector<std::unique_ptr<geom::Mesh>> lane_meshes;
       for(const auto &connection_pair : junction.GetConnections()) {
         const auto &connection = connection_pair.second;
@@ -1036,14 +1275,17 @@ namespace road {
         }
       }
       if(smooth_junctions) {
-        out_mesh += *mesh_factory.MergeAndSmooth(lane_meshes);
-      } else {
-        geom::Mesh junction_mesh;
-        for(auto& lane : lane_meshes) {
-          junction_mesh += *lane;
-        }
-        out_mesh += junction_mesh;
+        return mesh_factory.MergeAndSmooth(lane_meshes);
       }
+      auto junction_mesh = std::make_unique<geom::Mesh>();
+      for(auto& lane : lane_meshes) {
+        *junction_mesh += *lane;
+      }
+      return junction_mesh;
+    });
+
+    for (auto &mesh : meshes) {
+      out_mesh += *mesh;
     }
 
     return out_mesh;
@@ -1053,25 +1295,18 @@ namespace road {
   std::vector<std::unique_ptr<geom::Mesh>> Map::GenerateChunkedMesh(
       const rpc::OpendriveGenerationParameters& params) const {
     geom::MeshFactory mesh_factory(params);
-    std::vector<std::unique_ptr<geom::Mesh>> out_mesh_list;
 
-    std::unordered_map<JuncId, geom::Mesh> junction_map;
-    for (auto &&pair : _data.GetRoads()) {
-      const auto &road = pair.second;
-      if (!road.IsJunction()) {
-        std::vector<std::unique_ptr<geom::Mesh>> road_mesh_list =
-            mesh_factory.GenerateAllWithMaxLen(road);
+    const auto roads = GetRoadsOutsideJunctions(_data);
+    const auto junctions = GetJunctions(_data);
 
-        out_mesh_list.insert(
-            out_mesh_list.end(),
-            std::make_move_iterator(road_mesh_list.begin()),
-            std::make_move_iterator(road_mesh_list.end()));
+    auto mesh_lists = GenerateInParallel<std::vector<std::unique_ptr<geom::Mesh>>>(
+        roads.size() + junctions.size(), [&](size_t i) {
+      if (i < roads.size()) {
+        return mesh_factory.GenerateAllWithMaxLen(*roads[i]);
       }
-    }
 
-    // Generate roads within junctions and smooth them
-    for (const auto &junc_pair : _data.GetJunctions()) {
-      const auto &junction = junc_pair.second;
+      // Generate roads within junctions and smooth them
+      const auto &junction = *junctions[i - roads.size()];
       std::vector<std::unique_ptr<geom::Mesh>> lane_meshes;
       std::vector<std::unique_ptr<geom::Mesh>> sidewalk_lane_meshes;
       for(const auto &connection_pair : junction.GetConnections()) {
@@ -1088,12 +1323,13 @@ namespace road {
           }
         }
       }
+      std::vector<std::unique_ptr<geom::Mesh>> junction_mesh_list;
       if(params.smooth_junctions) {
         auto merged_mesh = mesh_factory.MergeAndSmooth(lane_meshes);
         for(auto& lane : sidewalk_lane_meshes) {
           *merged_mesh += *lane;
         }
-        out_mesh_list.push_back(std::move(merged_mesh));
+        junction_mesh_list.push_back(std::move(merged_mesh));
       } else {
         std::unique_ptr<geom::Mesh> junction_mesh = std::make_unique<geom::Mesh>();
         for(auto& lane : lane_meshes) {
@@ -1102,8 +1338,17 @@ namespace road {
         for(auto& lane : sidewalk_lane_meshes) {
           *junction_mesh += *lane;
         }
-        out_mesh_list.push_back(std::move(junction_mesh));
+        junction_mesh_list.push_back(std::move(junction_mesh));
       }
+      return junction_mesh_list;
+    });
+
+    std::vector<std::unique_ptr<geom::Mesh>> out_mesh_list;
+    for (auto &mesh_list : mesh_lists) {
+      out_mesh_list.insert(
+          out_mesh_list.end(),
+          std::make_move_iterator(mesh_list.begin()),
+          std::make_move_iterator(mesh_list.end()));
     }
 
     auto min_pos = geom::Vector2D(
@@ -1141,63 +1386,31 @@ namespace road {
   {
 
     geom::MeshFactory mesh_factory(params);
-    std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>> road_out_mesh_list;
-    std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>> junction_out_mesh_list;
-
-    std::thread juntction_thread( &Map::GenerateJunctions, this, mesh_factory, params,
-      minpos, maxpos, &junction_out_mesh_list);
 
     const std::vector<RoadId> RoadsIDToGenerate = FilterRoadsByPosition(minpos, maxpos);
-
-    size_t num_roads = RoadsIDToGenerate.size();
-    size_t num_roads_per_thread = 30;
-    size_t num_threads = (num_roads / num_roads_per_thread) + 1;
-    num_threads = num_threads > 1 ? num_threads : 1;
-    std::vector<std::thread> workers;
-    std::mutex write_mutex;
-    std::cout << "Generating " << std::to_string(num_roads) << " roads" << std::endl;
-
-    for ( size_t i = 0; i < num_threads; ++i ) {
-      std::thread neworker(
-        [this, &write_mutex, &mesh_factory, &RoadsIDToGenerate, &road_out_mesh_list, i, num_roads_per_thread]() {
-        std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>> Current =
-          std::move(GenerateRoadsMultithreaded(mesh_factory, RoadsIDToGenerate,i, num_roads_per_thread ));
-        std::lock_guard<std::mutex> guard(write_mutex);
-        for ( auto&& pair : Current ) {
-          if (road_out_mesh_list.find(pair.first) != road_out_mesh_list.end()) {
-            road_out_mesh_list[pair.first].insert(road_out_mesh_list[pair.first].end(),
-              std::make_move_iterator(pair.second.begin()),
-              std::make_move_iterator(pair.second.end()));
-          } else {
-            road_out_mesh_list[pair.first] = std::move(pair.second);
-          }
+    const std::vector<JuncId> JunctionsToGenerate = FilterJunctionsByPosition(minpos, maxpos);
+    const size_t num_roads = RoadsIDToGenerate.size();
+    std::cout << "Generating " << std::to_string(num_roads) << " roads and "
+        << std::to_string(JunctionsToGenerate.size()) << " junctions" << std::endl;
+
+    auto mesh_lists = GenerateInParallel<LaneTypeMeshes>(
+        num_roads + JunctionsToGenerate.size(), [&](size_t i) {
+      LaneTypeMeshes out;
+      if (i < num_roads) {
+        const auto& road = _data.GetRoads().at(RoadsIDToGenerate[i]);
+        if (!road.IsJunction()) {
+          mesh_factory.GenerateAllOrderedWithMaxLen(road, out);
         }
-      });
-      workers.push_back(std::move(neworker));
-    }
-
-    for (size_t i = 0; i < workers.size(); ++i) {
-      workers[i].join();
-    }
-    workers.clear();
-    for (size_t i = 0; i < workers.size(); ++i) {
-      if (workers[i].joinable()) {
-        workers[i].join();
+      } else {
+        GenerateSingleJunction(mesh_factory, JunctionsToGenerate[i - num_roads], &out);
       }
-    }
+      return out;
+    });
 
-    juntction_thread.join();
-    for (auto&& pair : junction_out_mesh_list) {
-      if (road_out_mesh_list.find(pair.first) != road_out_mesh_list.end())
-      {
-        road_out_mesh_list[pair.first].insert(road_out_mesh_list[pair.first].end(),
-          std::make_move_iterator(pair.second.begin()),
-          std::make_move_iterator(pair.second.end()));
-      }
-      else
-      {
-        road_out_mesh_list[pair.first] = std::move(pair.second);
-      }
+    // Roads first and then junctions, in the order they were filtered
+    LaneTypeMeshes road_out_mesh_list;
+    for (auto &mesh_list : mesh_lists) {
+      AppendMeshes(road_out_mesh_list, mesh_list);
     }
     std::cout << "Generated " << std::to_string(num_roads) << " roads" << std::endl;
 
@@ -1297,18 +1510,34 @@ namespace road {
     const geom::Vector3D& maxpos,
     std::vector<std::string>& outinfo ) const
   {
-    std::vector<std::unique_ptr<geom::Mesh>> LineMarks;
     geom::MeshFactory mesh_factory(params);
 
+    struct RoadLineMarkings {
+      std::vector<std::unique_ptr<geom::Mesh>> meshes;
+      std::vector<std::string> info;
+    };
+
     const std::vector<RoadId> RoadsIDToGenerate = FilterRoadsByPosition(minpos, maxpos);
-    for ( RoadId id : RoadsIDToGenerate ) {
-      const auto& road = _data.GetRoads().at(id);
+    auto road_markings = GenerateInParallel<RoadLineMarkings>(
+        RoadsIDToGenerate.size(), [&](size_t i) {
+      RoadLineMarkings markings;
+      const auto& road = _data.GetRoads().at(RoadsIDToGenerate[i]);
       if (!road.IsJunction()) {
-        mesh_factory.GenerateLaneMarkForRoad(road, LineMarks, outinfo);
+        mesh_factory.GenerateLaneMarkForRoad(road, markings.meshes, markings.info);
       }
+      return markings;
+    });
+
+    std::vector<std::unique_ptr<geom::Mesh>> LineMarks;
+    for (auto &markings : road_markings) {
+      LineMarks.insert(
+          LineMarks.end(),
+          std::make_move_iterator(markings.meshes.begin()),
+          std::make_move_iterator(markings.meshes.end()));
+      outinfo.insert(outinfo.end(), markings.info.begin(), markings.info.end());
     }
 
-    return std::move(LineMarks);
+    return LineMarks;
   }
 
   std::vector<carla::geom::BoundingBox> Map::GetJunctionsBoundingBoxes() const {
@@ -1328,90 +1557,6 @@ namespace road {
       geom::deformation::GetBumpDeformation(posx,posy);
   }
 
-  std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>>
-      Map::GenerateRoadsMultithreaded( const carla::geom::MeshFactory& mesh_factory,
-                                        const std::vector<RoadId>& RoadsId,
-                                        const size_t index, const size_t number_of_roads_per_thread) const
-  {
-    std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>> out;
-
-    size_t start = index * number_of_roads_per_thread;
-    size_t endoffset = (index+1) * number_of_roads_per_thread;
-    size_t end = RoadsId.size();
-
-    for (int i = start; i < endoffset && i < end; ++i) {
-      const auto& road = _data.GetRoads().at(RoadsId[i]);
-      if (!road.IsJunction()) {
-        mesh_factory.GenerateAllOrderedWithMaxLen(road, out);
-      }
-    }
-    std::cout << "Generated roads from " + std::to_string(index * number_of_roads_per_thread) + " to " + std::to_string((index+1) * number_of_roads_per_thread ) << std::endl;
-    return out;
-  }
-
-  void Map::GenerateJunctions(const carla::geom::MeshFactory& mesh_factory,
-    const rpc::OpendriveGenerationParameters& params,
-    const geom::Vector3D& minpos,
-    const geom::Vector3D& maxpos,
-    std::map<road::Lane::LaneType,
-    std::vector<std::unique_ptr<geom::Mesh>>>* junction_out_mesh_list) const {
-
-    std::vector<JuncId> JunctionsToGenerate = FilterJunctionsByPosition(minpos, maxpos);
-    size_t num_junctions = JunctionsToGenerate.size();
-    std::cout << "Generating " << std::to_string(num_junctions) << " junctions" << std::endl;
-    size_t junctionindex = 0;
-    size_t num_junctions_per_thread = 5;
-    size_t num_threads = (num_junctions / num_junctions_per_thread) + 1;
-    num_threads = num_threads > 1 ? num_threads : 1;
-    std::vector<std::thread> workers;
-    std::mutex write_mutex;
-
-    for ( size_t i = 0; i < num_threads; ++i ) {
-      std::thread neworker(
-        [this, &write_mutex, &mesh_factory, &junction_out_mesh_list, JunctionsToGenerate, i, num_junctions_per_thread, num_junctions]() {
-        std::map<road::Lane::LaneType,
-          std::vector<std::unique_ptr<geom::Mesh>>> junctionsofthisthread;
-
-        size_t minimum = 0;
-        if( (i + 1) * num_junctions_per_thread < num_junctions ){
-          minimum = (i + 1) * num_junctions_per_thread;
-        }else{
-          minimum = num_junctions;
-        }
-        std::cout << "Generating Junctions between  " << std::to_string(i * num_junctions_per_thread) << " and " << std::to_string(minimum) << std::endl;
-
-        for ( size_t junctionindex = i * num_junctions_per_thread;
-                        junctionindex < minimum;
-                        ++junctionindex )
-        {
-          GenerateSingleJunction(mesh_factory, JunctionsToGenerate[junctionindex], &junctionsofthisthread);
-        }
-        std::cout << "Generated Junctions between  " << std::to_string(i * num_junctions_per_thread) << " and " << std::to_string(minimum) << std::endl;
-        std::lock_guard<std::mutex> guard(write_mutex);
-        for ( auto&& pair : junctionsofthisthread ) {
-          if ((*junction_out_mesh_list).find(pair.first) != (*junction_out_mesh_list).end()) {
-            (*junction_out_mesh_list)[pair.first].insert((*junction_out_mesh_list)[pair.first].end(),
-              std::make_move_iterator(pair.second.begin()),
-              std::make_move_iterator(pair.second.end()));
-          } else {
-            (*junction_out_mesh_list)[pair.first] = std::move(pair.second);
-          }
-        }
-      });
-      workers.push_back(std::move(neworker));
-    }
-
-    for (size_t i = 0; i < workers.size(); ++i) {
-      workers[i].join();
-    }
-    workers.clear();
-    for (size_t i = 0; i < workers.size(); ++i) {
-      if (workers[i].joinable()) {
-        workers[i].join();
-      }
-    }
-  }
-
   std::vector<JuncId> Map::FilterJunctionsByPosition( const geom::Vector3D& minpos,
     const geom::Vector3D& maxpos ) const {
 
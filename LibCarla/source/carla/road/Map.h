@@ -26,6 +26,8 @@
 namespace carla {
 namespace road {
 
+  class MapCache;
+
   class Map : private MovableNonCopyable {
   public:
 
@@ -39,6 +41,10 @@ namespace road {
       CreateRtree();
     }
 
+    /// Create the map loading the R-tree from a valid @a cache instead of
+    /// computing it.
+    Map(MapData m, const MapCache &cache);
+
     /// ========================================================================
     /// -- Georeference --------------------------------------------------------
     /// ========================================================================
@@ -64,6 +70,18 @@ namespace road {
         LaneId lane_id,
         float s) const;
 
+    /// Same as GetClosestWaypointOnRoad for each location. The queries are
+    /// reordered so nearby locations are looked up consecutively, and the
+    /// distances to the nearest segments are computed in a single pass.
+    std::vector<boost::optional<element::Waypoint>> GetClosestWaypointsOnRoad(
+        const std::vector<geom::Location> &locations,
+        int32_t lane_type = static_cast<int32_t>(Lane::LaneType::Driving)) const;
+
+    /// Same as GetWaypoint for each location.
+    std::vector<boost::optional<element::Waypoint>> GetWaypoints(
+        const std::vector<geom::Location> &locations,
+        int32_t lane_type = static_cast<int32_t>(Lane::LaneType::Driving)) const;
+
     geom::Transform ComputeTransform(Waypoint waypoint) const;
 
     /// ========================================================================
@@ -204,6 +222,7 @@ namespace road {
 private:
 
     friend MapBuilder;
+    friend MapCache;
     MapData _data;
 
     using Rtree = geom::SegmentCloudRtree<Waypoint>;
@@ -228,19 +247,6 @@ private:
 public:
     inline float GetZPosInDeformation(float posx, float posy) const;
 
-    std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>>
-      GenerateRoadsMultithreaded( const carla::geom::MeshFactory& mesh_factory,
-        const std::vector<RoadId>& RoadsID,
-        const size_t index,
-        const size_t number_of_roads_per_thread) const;
-
-    void GenerateJunctions(const carla::geom::MeshFactory& mesh_factory,
-      const rpc::OpendriveGenerationParameters& params,
-      const geom::Vector3D& minpos,
-      const geom::Vector3D& maxpos,
-      std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>>*
-      juntion_out_mesh_list) const;
-
     void GenerateSingleJunction(const carla::geom::MeshFactory& mesh_factory,
       const JuncId Id,
       std::map<road::Lane::LaneType, std::vector<std::unique_ptr<geom::Mesh>>>*
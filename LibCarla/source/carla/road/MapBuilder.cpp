@@ -35,7 +35,7 @@ using namespace carla::road::element;
 namespace carla {
 namespace road {
 
-  boost::optional<Map> MapBuilder::Build() {
+  boost::optional<Map> MapBuilder::Build(const MapCache *cache) {
 
     CreatePointersBetweenRoadSegments();
     RemoveZeroLaneValiditySignalReferences();
@@ -62,7 +62,9 @@ namespace road {
     // _map_data is a memeber of MapBuilder so you must especify if
     // you want to keep it (will return copy -> Map(const Map &))
     // or move it (will return move -> Map(Map &&))
-    Map map(std::move(_map_data));
+    Map map = (cache != nullptr) ?
+        Map(std::move(_map_data), *cache) :
+        Map(std::move(_map_data));
     CreateJunctionBoundingBoxes(map);
     ComputeJunctionRoadConflicts(map);
     CheckSignalsOnRoads(map);
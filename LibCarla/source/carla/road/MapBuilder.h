@@ -20,7 +20,8 @@ namespace road {
   class MapBuilder {
   public:
 
-    boost::optional<Map> Build();
+    /// Build the map, loading its R-tree from @a cache if given.
+    boost::optional<Map> Build(const MapCache *cache = nullptr);
 
     // called from road parser
     carla::road::Road *AddRoad(
@@ -0,0 +1,103 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/MapCache.h"
+
+#include "carla/Fnv1aHash.h"
+#include "carla/road/Map.h"
+
+#include <cstring>
+#include <vector>
+
+namespace carla {
+namespace road {
+
+  static constexpr char CACHE_MAGIC[8u] = {'C', 'A', 'R', 'L', 'A', 'M', 'A', 'P'};
+
+  /// Increase it whenever the layout of the file or the way the R-tree is
+  /// computed changes, so older caches are discarded.
+  static constexpr uint32_t CACHE_VERSION = 1u;
+
+  /// Follows the CacheFile header.
+  struct MapCache::Header {
+    uint64_t size;
+    uint32_t element_size;
+    uint32_t padding;
+  };
+
+  uint64_t MapCache::Hash(const std::string &opendrive) {
+    Fnv1aHash hash;
+    hash.Update(opendrive.data(), opendrive.size());
+    return hash.Get();
+  }
+
+  bool MapCache::Save(const Map &map, uint64_t hash, const std::string &path) {
+    namespace bg = boost::geometry;
+    static_assert(sizeof(Waypoint) == 24u, "Unexpected padding in map cache waypoint");
+    static_assert(sizeof(Element) == 72u, "Unexpected padding in map cache element");
+    static_assert((CacheFile::HEADER_SIZE + sizeof(Header)) % alignof(Element) == 0u,
+        "Map cache elements are not aligned after the header");
+
+    const auto rtree_elements = map._rtree.GetElements();
+    std::vector<Element> elements;
+    elements.reserve(rtree_elements.size());
+    for (const auto &rtree_element : rtree_elements) {
+      const auto &segment = rtree_element.first;
+      const auto &start = rtree_element.second.first;
+      const auto &end = rtree_element.second.second;
+      Element element;
+      element.start[0u] = bg::get<0, 0>(segment);
+      element.start[1u] = bg::get<0, 1>(segment);
+      element.start[2u] = bg::get<0, 2>(segment);
+      element.end[0u] = bg::get<1, 0>(segment);
+      element.end[1u] = bg::get<1, 1>(segment);
+      element.end[2u] = bg::get<1, 2>(segment);
+      element.start_waypoint = Waypoint{start.road_id, start.section_id, start.lane_id, 0u, start.s};
+      element.end_waypoint = Waypoint{end.road_id, end.section_id, end.lane_id, 0u, end.s};
+      elements.emplace_back(element);
+    }
+
+    Header header;
+    header.size = elements.size();
+    header.element_size = sizeof(Element);
+    header.padding = 0u;
+
+    return CacheFile::Write(path, CACHE_MAGIC, CACHE_VERSION, hash, [&](std::ostream &out) {
+      out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+      out.write(
+          reinterpret_cast<const char *>(elements.data()),
+          static_cast<std::streamsize>(elements.size() * sizeof(Element)));
+    });
+  }
+
+  MapCache::MapCache(const std::string &path, uint64_t hash) {
+    if (!_file.Open(path, CACHE_MAGIC, CACHE_VERSION, hash)) {
+      // Missing file or written by another version, platform or content.
+      return;
+    }
+
+    const size_t content_size = _file.GetContentSize();
+    if (content_size < sizeof(Header)) {
+      _file.Close();
+      return;
+    }
+    const char *data = _file.GetContent();
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+    const size_t size = (content_size - sizeof(Header)) / sizeof(Element);
+    if (header.element_size != sizeof(Element) ||
+        header.size != size ||
+        sizeof(Header) + size * sizeof(Element) != content_size) {
+      _file.Close();
+      return;
+    }
+
+    _elements = reinterpret_cast<const Element *>(data + sizeof(Header));
+    _size = size;
+  }
+
+} // namespace road
+} // namespace carla
@@ -0,0 +1,77 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/CacheFile.h"
+#include "carla/NonCopyable.h"
+#include "carla/road/RoadTypes.h"
+
+#include <cstdint>
+#include <string>
+
+namespace carla {
+namespace road {
+
+  class Map;
+
+  /// Binary cache of the R-tree computed when building a Map from its
+  /// OpenDRIVE content, stored in a file keyed by a hash of that content.
+  /// The MapData is not cached, it is still parsed from the OpenDRIVE.
+  ///
+  /// The file holds a fixed header followed by a flat array of the R-tree
+  /// segments, so it is memory mapped and bulk loaded in the tree without
+  /// parsing. A file of another version, platform or OpenDRIVE content is
+  /// reported as not valid and should be written again.
+  class MapCache : private NonCopyable {
+  public:
+
+    /// Hash of the OpenDRIVE content the cache is keyed by (64-bit FNV-1a).
+    static uint64_t Hash(const std::string &opendrive);
+
+    /// Write the cache of @a map, built from content with @a hash, to @a path.
+    /// The file is written aside and renamed, so other processes never map a
+    /// half written cache. Return false if the file could not be written.
+    static bool Save(const Map &map, uint64_t hash, const std::string &path);
+
+    /// Map in memory the cache at @a path, it is valid only if the file exists
+    /// and was built from OpenDRIVE content with @a hash.
+    MapCache(const std::string &path, uint64_t hash);
+
+    bool IsValid() const {
+      return _elements != nullptr;
+    }
+
+  private:
+
+    friend Map;
+
+    struct Waypoint {
+      RoadId road_id;
+      SectionId section_id;
+      LaneId lane_id;
+      uint32_t padding;
+      double s;
+    };
+
+    struct Element {
+      float start[3u];
+      float end[3u];
+      Waypoint start_waypoint;
+      Waypoint end_waypoint;
+    };
+
+    struct Header;
+
+    CacheFile _file;
+
+    const Element *_elements = nullptr;
+
+    size_t _size = 0u;
+  };
+
+} // namespace road
+} // namespace carla
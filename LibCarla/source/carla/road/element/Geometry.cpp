@@ -19,6 +19,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
 #include <stdexcept>
 
 namespace carla {
@@ -99,21 +100,77 @@ namespace element {
     return p;
   }
 
-  /// @todo
   std::pair<float, float> GeometrySpiral::DistanceTo(const geom::Location &location) const {
-    // Not analytic, discretize and find nearest point
-    // throw_exception(std::runtime_error("not implemented"));
-    return {location.x - _start_position.x, location.y - _start_position.y};
+    if (_table.Size() < 2u) {
+      return {0.0f, geom::Math::Distance2D(_start_position, location)};
+    }
+    std::pair<float, float> nearest = {0.0f, std::numeric_limits<float>::max()};
+    for (size_t i = 0u; i + 1u < _table.Size(); ++i) {
+      auto dist = geom::Math::DistanceSegmentToPoint(
+          location,
+          _table.GetSample(i),
+          _table.GetSample(i + 1u));
+      if (dist.second < nearest.second) {
+        nearest = {static_cast<float>(_table.GetS(i)) + dist.first, dist.second};
+      }
+    }
+    nearest.first = std::min(nearest.first, static_cast<float>(_length));
+    return nearest;
   }
 
-  DirectedPoint GeometryPoly3::PosFromDist(double dist) const {
-    auto result = _rtree.GetNearestNeighbours(
-        Rtree::BPoint(static_cast<float>(dist))).front();
+  void GeometrySpiral::PreComputeSpline() {
+    if (_length <= 0.0) {
+      return;
+    }
+    // Maximum distance between the polyline and the spiral in m
+    constexpr double tolerance = 0.01;
+    const double max_curvature =
+        std::max(std::fabs(_curve_start), std::fabs(_curve_end));
+    // The sagitta of a chord of length h is roughly k * h^2 / 8
+    const double interval_size = max_curvature > 0.0 ?
+        geom::Math::Clamp(std::sqrt(8.0 * tolerance / max_curvature), 0.1, 2.0) :
+        2.0;
+    const size_t number_intervals =
+        std::max(static_cast<size_t>(std::ceil(_length / interval_size)), size_t(1));
+    _table.Reserve(number_intervals + 1u);
+    for (size_t i = 0u; i <= number_intervals; ++i) {
+      const double s = _length * static_cast<double>(i) / static_cast<double>(number_intervals);
+      _table.Add(s, PosFromDist(s).location);
+    }
+  }
 
-    auto &val1 = result.second.first;
-    auto &val2 = result.second.second;
+  /// Returns the pair {s, distance} of the point in the polyline of @a table,
+  /// given by the {u, v} members of its samples, closest to @a p. Only the
+  /// segments starting before @a length are considered.
+  template <typename T>
+  static std::pair<float, float> DistanceToTable(
+      const ArcLengthTable<T> &table,
+      double length,
+      const geom::Vector2D &p) {
+    const geom::Location local(p.x, p.y, 0.0f);
+    std::pair<float, float> nearest = {0.0f, std::numeric_limits<float>::max()};
+    for (size_t i = 0u; i + 1u < table.Size() && table.GetS(i) < length; ++i) {
+      const auto &val1 = table.GetSample(i);
+      const auto &val2 = table.GetSample(i + 1u);
+      auto dist = geom::Math::DistanceSegmentToPoint(
+          local,
+          geom::Location(static_cast<float>(val1.u), static_cast<float>(val1.v), 0.0f),
+          geom::Location(static_cast<float>(val2.u), static_cast<float>(val2.v), 0.0f));
+      if (dist.second < nearest.second) {
+        nearest = {static_cast<float>(table.GetS(i)) + dist.first, dist.second};
+      }
+    }
+    nearest.first = std::min(nearest.first, static_cast<float>(length));
+    return nearest;
+  }
+
+  DirectedPoint GeometryPoly3::Interpolate(size_t segment, double dist) const {
+    const double s1 = _table.GetS(segment);
+    const double s2 = _table.GetS(segment + 1u);
+    auto &val1 = _table.GetSample(segment);
+    auto &val2 = _table.GetSample(segment + 1u);
 
-    double rate = (val2.s - dist) / (val2.s - val1.s);
+    double rate = (s2 - dist) / (s2 - s1);
     double u = rate * val1.u + (1.0 - rate) * val2.u;
     double v = rate * val1.v + (1.0 - rate) * val2.v;
     double tangent = atan((rate * val1.t + (1.0 - rate) * val2.t)); // ?
@@ -125,10 +182,26 @@ namespace element {
     return p;
   }
 
-  std::pair<float, float> GeometryPoly3::DistanceTo(const geom::Location & /*p*/) const {
-    // No analytical expression (Newton-Raphson?/point search)
-    // throw_exception(std::runtime_error("not implemented"));
-    return {_start_position.x, _start_position.y};
+  DirectedPoint GeometryPoly3::PosFromDist(double dist) const {
+    return Interpolate(_table.FindSegment(dist), dist);
+  }
+
+  std::vector<DirectedPoint> GeometryPoly3::PosFromDist(const std::vector<double> &dists) const {
+    std::vector<DirectedPoint> result;
+    result.reserve(dists.size());
+    size_t segment = 0u;
+    for (auto dist : dists) {
+      segment = _table.FindSegment(dist, segment);
+      result.emplace_back(Interpolate(segment, dist));
+    }
+    return result;
+  }
+
+  std::pair<float, float> GeometryPoly3::DistanceTo(const geom::Location &p) const {
+    return DistanceToTable(_table, _length, RotatebyAngle(
+        -_heading,
+        p.x - _start_position.x,
+        p.y - _start_position.y));
   }
 
   void GeometryPoly3::PreComputeSpline() {
@@ -139,8 +212,7 @@ namespace element {
     double current_u = 0;
     double last_u = 0;
     double last_v = _poly.Evaluate(current_u);
-    double last_s = 0;
-    RtreeValue last_val{last_u, last_v, last_s, _poly.Tangent(current_u)};
+    _table.Add(0.0, Sample{last_u, last_v, _poly.Tangent(current_u)});
     while (current_s < _length + delta_u) {
       current_u += delta_u;
       double current_v = _poly.Evaluate(current_u);
@@ -148,28 +220,20 @@ namespace element {
       double dv = current_v - last_v;
       double ds = sqrt(du * du + dv * dv);
       current_s += ds;
-      double current_t = _poly.Tangent(current_u);
-      RtreeValue current_val{current_u, current_v, current_s, current_t};
-
-      Rtree::BPoint p1(static_cast<float>(last_s));
-      Rtree::BPoint p2(static_cast<float>(current_s));
-      _rtree.InsertElement(Rtree::BSegment(p1, p2), last_val, current_val);
+      _table.Add(current_s, Sample{current_u, current_v, _poly.Tangent(current_u)});
 
       last_u = current_u;
       last_v = current_v;
-      last_s = current_s;
-      last_val = current_val;
-
     }
   }
 
-  DirectedPoint GeometryParamPoly3::PosFromDist(double dist) const {
-    auto result = _rtree.GetNearestNeighbours(
-        Rtree::BPoint(static_cast<float>(dist))).front();
+  DirectedPoint GeometryParamPoly3::Interpolate(size_t segment, double dist) const {
+    const double s1 = _table.GetS(segment);
+    const double s2 = _table.GetS(segment + 1u);
+    auto &val1 = _table.GetSample(segment);
+    auto &val2 = _table.GetSample(segment + 1u);
 
-    auto &val1 = result.second.first;
-    auto &val2 = result.second.second;
-    double rate = (val2.s - dist) / (val2.s - val1.s);
+    double rate = (s2 - dist) / (s2 - s1);
     double u = rate * val1.u + (1.0 - rate) * val2.u;
     double v = rate * val1.v + (1.0 - rate) * val2.v;
     double t_u = (rate * val1.t_u + (1.0 - rate) * val2.t_u);
@@ -182,10 +246,27 @@ namespace element {
     p.location.y += pos.y;
     return p;
   }
-  std::pair<float, float> GeometryParamPoly3::DistanceTo(const geom::Location &) const {
-    // No analytical expression (Newton-Raphson?/point search)
-    // throw_exception(std::runtime_error("not implemented"));
-    return {_start_position.x, _start_position.y};
+
+  DirectedPoint GeometryParamPoly3::PosFromDist(double dist) const {
+    return Interpolate(_table.FindSegment(dist), dist);
+  }
+
+  std::vector<DirectedPoint> GeometryParamPoly3::PosFromDist(const std::vector<double> &dists) const {
+    std::vector<DirectedPoint> result;
+    result.reserve(dists.size());
+    size_t segment = 0u;
+    for (auto dist : dists) {
+      segment = _table.FindSegment(dist, segment);
+      result.emplace_back(Interpolate(segment, dist));
+    }
+    return result;
+  }
+
+  std::pair<float, float> GeometryParamPoly3::DistanceTo(const geom::Location &p) const {
+    return DistanceToTable(_table, _length, RotatebyAngle(
+        -_heading,
+        p.x - _start_position.x,
+        p.y - _start_position.y));
   }
 
   void GeometryParamPoly3::PreComputeSpline() {
@@ -201,13 +282,12 @@ namespace element {
     double current_s = 0;
     double last_u = _polyU.Evaluate(param_p);
     double last_v = _polyV.Evaluate(param_p);
-    double last_s = 0;
-    RtreeValue last_val{
+    _table.Reserve(number_intervals + 1u);
+    _table.Add(0.0, Sample{
         last_u,
         last_v,
-        last_s,
         _polyU.Tangent(param_p),
-        _polyV.Tangent(param_p) };
+        _polyV.Tangent(param_p) });
     for(size_t i = 0; i < number_intervals; ++i) {
       param_p += delta_p;
       double current_u = _polyU.Evaluate(param_p);
@@ -216,23 +296,14 @@ namespace element {
       double dv = current_v - last_v;
       double ds = sqrt(du * du + dv * dv);
       current_s += ds;
-      double current_t_u = _polyU.Tangent(param_p);
-      double current_t_v = _polyV.Tangent(param_p);
-      RtreeValue current_val{
+      _table.Add(current_s, Sample{
           current_u,
           current_v,
-          current_s,
-          current_t_u,
-          current_t_v };
-
-      Rtree::BPoint p1(static_cast<float>(last_s));
-      Rtree::BPoint p2(static_cast<float>(current_s));
-      _rtree.InsertElement(Rtree::BSegment(p1, p2), last_val, current_val);
+          _polyU.Tangent(param_p),
+          _polyV.Tangent(param_p) });
 
       last_u = current_u;
       last_v = current_v;
-      last_s = current_s;
-      last_val = current_val;
 
       if(current_s > _length){
         break;
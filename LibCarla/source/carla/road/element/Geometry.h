@@ -6,10 +6,13 @@
 
 #pragma once
 
+#include "carla/Debug.h"
 #include "carla/geom/Location.h"
 #include "carla/geom/Math.h"
 #include "carla/geom/CubicPolynomial.h"
-#include "carla/geom/Rtree.h"
+
+#include <algorithm>
+#include <vector>
 
 namespace carla {
 namespace road {
@@ -46,6 +49,66 @@ namespace element {
     }
   };
 
+  /// Sorted table of samples along a geometry indexed by their arc length.
+  /// The arc lengths are stored apart from the samples so the lookups only
+  /// touch a contiguous array of doubles.
+  template <typename T>
+  class ArcLengthTable {
+  public:
+
+    void Reserve(size_t size) {
+      _s.reserve(size);
+      _samples.reserve(size);
+    }
+
+    /// Appends a sample, @a s must not be less than the last one inserted.
+    void Add(double s, const T &sample) {
+      DEBUG_ASSERT(_s.empty() || _s.back() <= s);
+      _s.emplace_back(s);
+      _samples.emplace_back(sample);
+    }
+
+    size_t Size() const {
+      return _s.size();
+    }
+
+    double GetS(size_t i) const {
+      return _s[i];
+    }
+
+    const T &GetSample(size_t i) const {
+      return _samples[i];
+    }
+
+    /// Returns the index i of the segment [s_i, s_i+1] containing @a s,
+    /// clamped to the first and last segments. The search starts at @a hint,
+    /// which allows evaluating increasing distances in a single pass.
+    size_t FindSegment(double s, size_t hint = 0u) const {
+      DEBUG_ASSERT(_s.size() >= 2u);
+      const size_t last = _s.size() - 2u;
+      if (hint > last || s < _s[hint]) {
+        hint = 0u;
+      }
+      // The segments are short, a query is usually a few samples away from
+      // the previous one.
+      for (size_t steps = 0u; steps < 4u && hint < last; ++steps) {
+        if (s < _s[hint + 1u]) {
+          return hint;
+        }
+        ++hint;
+      }
+      const auto it = std::upper_bound(_s.begin() + hint, _s.end(), s);
+      const auto index = static_cast<size_t>(it - _s.begin());
+      return index == 0u ? 0u : std::min(index - 1u, last);
+    }
+
+  private:
+
+    std::vector<double> _s;
+
+    std::vector<T> _samples;
+  };
+
   class Geometry {
   public:
 
@@ -70,6 +133,17 @@ namespace element {
 
     virtual DirectedPoint PosFromDist(double dist) const = 0;
 
+    /// Evaluates PosFromDist for every distance in @a dists. Sorted distances
+    /// are evaluated in a single pass over the geometry.
+    virtual std::vector<DirectedPoint> PosFromDist(const std::vector<double> &dists) const {
+      std::vector<DirectedPoint> result;
+      result.reserve(dists.size());
+      for (auto dist : dists) {
+        result.emplace_back(PosFromDist(dist));
+      }
+      return result;
+    }
+
     virtual std::pair<float, float> DistanceTo(const geom::Location &p) const = 0;
 
   protected:
@@ -107,6 +181,8 @@ namespace element {
         const geom::Location &start_pos)
       : Geometry(GeometryType::LINE, start_offset, length, heading, start_pos) {}
 
+    using Geometry::PosFromDist;
+
     DirectedPoint PosFromDist(double dist) const override;
 
     /// Returns a pair containing:
@@ -136,6 +212,8 @@ namespace element {
       : Geometry(GeometryType::ARC, start_offset, length, heading, start_pos),
         _curvature(curv) {}
 
+    using Geometry::PosFromDist;
+
     DirectedPoint PosFromDist(double dist) const override;
 
     /// Returns a pair containing:
@@ -173,7 +251,9 @@ namespace element {
         double curv_e)
       : Geometry(GeometryType::SPIRAL, start_offset, length, heading, start_pos),
         _curve_start(curv_s),
-        _curve_end(curv_e) {}
+        _curve_end(curv_e) {
+      PreComputeSpline();
+    }
 
     double GetCurveStart() {
       return _curve_start;
@@ -183,14 +263,27 @@ namespace element {
       return _curve_end;
     }
 
+    using Geometry::PosFromDist;
+
     DirectedPoint PosFromDist(double dist) const override;
 
-    std::pair<float, float> DistanceTo(const geom::Location &) const override;
+    /// Returns a pair containing:
+    /// - @b first:  distance to the nearest point in this spiral from the
+    ///              beginning of the shape.
+    /// - @b second: Euclidean distance from the nearest point in this spiral
+    ///              to p.
+    ///   @param p point to calculate the distance
+    std::pair<float, float> DistanceTo(const geom::Location &p) const override;
 
   private:
 
     double _curve_start;
     double _curve_end;
+
+    /// Polyline of the spiral in world coordinates, used to find the closest
+    /// point. PosFromDist stays analytic.
+    ArcLengthTable<geom::Location> _table;
+    void PreComputeSpline();
   };
 
   class GeometryPoly3 final : public Geometry {
@@ -227,9 +320,19 @@ namespace element {
       return _d;
     }
 
+    using Geometry::PosFromDist;
+
     DirectedPoint PosFromDist(double dist) const override;
 
-    std::pair<float, float> DistanceTo(const geom::Location &) const override;
+    std::vector<DirectedPoint> PosFromDist(const std::vector<double> &dists) const override;
+
+    /// Returns a pair containing:
+    /// - @b first:  distance to the nearest point in this polynomial from the
+    ///              beginning of the shape.
+    /// - @b second: Euclidean distance from the nearest point in this
+    ///              polynomial to p.
+    ///   @param p point to calculate the distance
+    std::pair<float, float> DistanceTo(const geom::Location &p) const override;
 
   private:
 
@@ -240,16 +343,15 @@ namespace element {
     double _c;
     double _d;
 
-    struct RtreeValue {
+    struct Sample {
       double u = 0;
       double v = 0;
-      double s = 0;
       double t = 0;
     };
-    using Rtree = geom::SegmentCloudRtree<RtreeValue, 1>;
-    using TreeElement = Rtree::TreeElement;
-    Rtree _rtree;
+    ArcLengthTable<Sample> _table;
     void PreComputeSpline();
+
+    DirectedPoint Interpolate(size_t segment, double dist) const;
   };
 
   class GeometryParamPoly3 final : public Geometry {
@@ -309,9 +411,19 @@ namespace element {
       return _dV;
     }
 
+    using Geometry::PosFromDist;
+
     DirectedPoint PosFromDist(double dist) const override;
 
-    std::pair<float, float> DistanceTo(const geom::Location &) const override;
+    std::vector<DirectedPoint> PosFromDist(const std::vector<double> &dists) const override;
+
+    /// Returns a pair containing:
+    /// - @b first:  distance to the nearest point in this polynomial from the
+    ///              beginning of the shape.
+    /// - @b second: Euclidean distance from the nearest point in this
+    ///              polynomial to p.
+    ///   @param p point to calculate the distance
+    std::pair<float, float> DistanceTo(const geom::Location &p) const override;
 
   private:
 
@@ -327,17 +439,16 @@ namespace element {
     double _dV;
     bool _arcLength;
 
-    struct RtreeValue {
+    struct Sample {
       double u = 0;
       double v = 0;
-      double s = 0;
       double t_u = 0;
       double t_v = 0;
     };
-    using Rtree = geom::SegmentCloudRtree<RtreeValue, 1>;
-    using TreeElement = Rtree::TreeElement;
-    Rtree _rtree;
+    ArcLengthTable<Sample> _table;
     void PreComputeSpline();
+
+    DirectedPoint Interpolate(size_t segment, double dist) const;
   };
 
 } // namespace element
@@ -6,6 +6,7 @@
 
 #include "carla/Logging.h"
 #include "carla/ros2/ROS2.h"
+#include "carla/ros2/ROS2PublishQueue.h"
 #include "carla/geom/GeoLocation.h"
 #include "carla/geom/Vector3D.h"
 #include "carla/sensor/data/DVSEvent.h"
@@ -39,6 +40,8 @@
 #include "subscribers/CarlaSubscriber.h"
 #include "subscribers/CarlaEgoVehicleControlSubscriber.h"
 
+#include <algorithm>
+#include <thread>
 #include <vector>
 
 namespace carla {
@@ -47,6 +50,9 @@ namespace ros2 {
 // static fields
 std::shared_ptr<ROS2> ROS2::_instance;
 
+// Samples of a publisher waiting to be sent, older ones are dropped.
+static constexpr size_t MAX_PENDING_SAMPLES_PER_PUBLISHER = 2u;
+
 // list of sensors (should be equal to the list of SensorsRegistry
 enum ESensors {
   CollisionSensor,
@@ -73,6 +79,12 @@ enum ESensors {
 void ROS2::Enable(bool enable) {
   _enabled = enable;
   log_info("ROS2 enabled: ", _enabled);
+  if (_enabled && !_publish_queue) {
+    // Publishing shares the cores with the simulation, a few threads are
+    // enough to keep the sensors of one frame apart.
+    const size_t threads = std::max(2u, std::min(4u, std::thread::hardware_concurrency() / 4u));
+    _publish_queue = std::make_shared<ROS2PublishQueue>(threads, MAX_PENDING_SAMPLES_PER_PUBLISHER);
+  }
   _clock_publisher = std::make_shared<CarlaClockPublisher>("clock", "");
   _clock_publisher->Init();
 }
@@ -475,6 +487,50 @@ std::pair<std::shared_ptr<CarlaPublisher>, std::shared_ptr<CarlaTransformPublish
   return { publisher, transform };
 }
 
+// Job that publishes an image of a camera from the sensor buffer, the buffer
+// is kept alive until the job runs.
+template <typename PublisherT, typename SerializerT, typename PixelT>
+static ROS2PublishQueue::Job MakeCameraJob(
+    std::shared_ptr<CarlaPublisher> base_publisher,
+    int32_t seconds,
+    uint32_t nanoseconds,
+    int W, int H, float Fov,
+    carla::SharedBufferView buffer) {
+  // GetOrCreateSensor creates the publisher of the type of the sensor.
+  auto publisher = std::static_pointer_cast<PublisherT>(std::move(base_publisher));
+  return [=]() {
+    const typename SerializerT::ImageHeader *header =
+      reinterpret_cast<const typename SerializerT::ImageHeader *>(buffer->data());
+    if (!header)
+      return;
+    if (!publisher->HasBeenInitialized())
+      publisher->InitInfoData(0, 0, H, W, Fov, true);
+    publisher->SetImageData(seconds, nanoseconds, header->height, header->width, reinterpret_cast<const PixelT *>(buffer->data() + SerializerT::header_offset));
+    publisher->SetCameraInfoData(seconds, nanoseconds);
+    publisher->Publish();
+  };
+}
+
+void ROS2::PostJob(const void *publisher, std::function<void()> job) {
+  if (_publish_queue) {
+    _publish_queue->Post(publisher, std::move(job));
+  } else {
+    job();
+  }
+}
+
+void ROS2::PostTransform(
+    std::shared_ptr<CarlaTransformPublisher> publisher,
+    const carla::geom::Transform &sensor_transform) {
+  if (!publisher)
+    return;
+  const void *key = publisher.get();
+  PostJob(key, [publisher, seconds = _seconds, nanoseconds = _nanoseconds, sensor_transform]() {
+    publisher->SetData(seconds, nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);
+    publisher->Publish();
+  });
+}
+
 void ROS2::ProcessDataFromCamera(
     uint64_t sensor_type,
     carla::streaming::detail::stream_id_type stream_id,
@@ -482,337 +538,203 @@ void ROS2::ProcessDataFromCamera(
     int W, int H, float Fov,
     const carla::SharedBufferView buffer,
     void *actor) {
+  using carla::sensor::s11n::ImageSerializer;
+  using carla::sensor::s11n::OpticalFlowImageSerializer;
 
+  std::pair<std::shared_ptr<CarlaPublisher>, std::shared_ptr<CarlaTransformPublisher>> sensors;
+  ROS2PublishQueue::Job job;
   switch (sensor_type) {
-    case ESensors::CollisionSensor:
-      log_info("Sensor Collision to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());
-      break;
     case ESensors::DepthCamera:
-      {
-        log_info("Sensor DepthCamera to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());
-        auto sensors = GetOrCreateSensor(ESensors::DepthCamera, stream_id, actor);
-        if (sensors.first) {
-          std::shared_ptr<CarlaDepthCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaDepthCameraPublisher>(sensors.first);
-          const carla::sensor::s11n::ImageSerializer::ImageHeader *header =
-            reinterpret_cast<const carla::sensor::s11n::ImageSerializer::ImageHeader *>(buffer->data());
-          if (!header)
-            return;
-          if (!publisher->HasBeenInitialized())
-            publisher->InitInfoData(0, 0, H, W, Fov, true);
-          publisher->SetImageData(_seconds, _nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));
-          publisher->SetCameraInfoData(_seconds, _nanoseconds);
-          publisher->Publish();
-        }
-        if (sensors.second) {
-          std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);
-          publisher->Publish();
-        }
-      }
+      sensors = GetOrCreateSensor(ESensors::DepthCamera, stream_id, actor);
+      if (sensors.first)
+        job = MakeCameraJob<CarlaDepthCameraPublisher, ImageSerializer, uint8_t>(sensors.first, _seconds, _nanoseconds, W, H, Fov, buffer);
       break;
     case ESensors::NormalsCamera:
-      log_info("Sensor NormalsCamera to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());
-      {
-        auto sensors = GetOrCreateSensor(ESensors::NormalsCamera, stream_id, actor);
-        if (sensors.first) {
-          std::shared_ptr<CarlaNormalsCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaNormalsCameraPublisher>(sensors.first);
-          const carla::sensor::s11n::ImageSerializer::ImageHeader *header =
-            reinterpret_cast<const carla::sensor::s11n::ImageSerializer::ImageHeader *>(buffer->data());
-          if (!header)
-            return;
-          if (!publisher->HasBeenInitialized())
-            publisher->InitInfoData(0, 0, H, W, Fov, true);
-          publisher->SetImageData(_seconds, _nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));
-          publisher->SetCameraInfoData(_seconds, _nanoseconds);
-          publisher->Publish();
-        }
-        if (sensors.second) {
-          std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);
-          publisher->Publish();
-        }
-      }
+      sensors = GetOrCreateSensor(ESensors::NormalsCamera, stream_id, actor);
+      if (sensors.first)
+        job = MakeCameraJob<CarlaNormalsCameraPublisher, ImageSerializer, uint8_t>(sensors.first, _seconds, _nanoseconds, W, H, Fov, buffer);
       break;
     case ESensors::LaneInvasionSensor:
-      log_info("Sensor LaneInvasionSensor to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());
-      {
-        auto sensors = GetOrCreateSensor(ESensors::LaneInvasionSensor, stream_id, actor);
-        if (sensors.first) {
-          std::shared_ptr<CarlaLineInvasionPublisher> publisher = std::dynamic_pointer_cast<CarlaLineInvasionPublisher>(sensors.first);
-          publisher->SetData(_seconds, _nanoseconds, (const int32_t*) buffer->data());
-          publisher->Publish();
-        }
-        if (sensors.second) {
-          std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);
+      sensors = GetOrCreateSensor(ESensors::LaneInvasionSensor, stream_id, actor);
+      if (sensors.first) {
+        auto publisher = std::static_pointer_cast<CarlaLineInvasionPublisher>(sensors.first);
+        job = [publisher, seconds = _seconds, nanoseconds = _nanoseconds, buffer]() {
+          publisher->SetData(seconds, nanoseconds, (const int32_t*) buffer->data());
           publisher->Publish();
-        }
+        };
       }
       break;
     case ESensors::OpticalFlowCamera:
-      log_info("Sensor OpticalFlowCamera to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());
-      {
-        auto sensors = GetOrCreateSensor(ESensors::OpticalFlowCamera, stream_id, actor);
-        if (sensors.first) {
-          std::shared_ptr<CarlaOpticalFlowCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaOpticalFlowCameraPublisher>(sensors.first);
-          const carla::sensor::s11n::OpticalFlowImageSerializer::ImageHeader *header =
-            reinterpret_cast<const carla::sensor::s11n::OpticalFlowImageSerializer::ImageHeader *>(buffer->data());
-          if (!header)
-            return;
-          if (!publisher->HasBeenInitialized())
-            publisher->InitInfoData(0, 0, H, W, Fov, true);
-          publisher->SetImageData(_seconds, _nanoseconds, header->height, header->width, (const float*) (buffer->data() + carla::sensor::s11n::OpticalFlowImageSerializer::header_offset));
-          publisher->SetCameraInfoData(_seconds, _nanoseconds);
-          publisher->Publish();
-        }
-        if (sensors.second) {
-          std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);
-          publisher->Publish();
-        }
-      }
-      break;
-    case ESensors::RssSensor:
-      log_info("Sensor RssSensor to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());
+      sensors = GetOrCreateSensor(ESensors::OpticalFlowCamera, stream_id, actor);
+      if (sensors.first)
+        job = MakeCameraJob<CarlaOpticalFlowCameraPublisher, OpticalFlowImageSerializer, float>(sensors.first, _seconds, _nanoseconds, W, H, Fov, buffer);
       break;
     case ESensors::SceneCaptureCamera:
-    {
-      log_info("Sensor SceneCaptureCamera to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());
-      {
-        auto sensors = GetOrCreateSensor(ESensors::SceneCaptureCamera, stream_id, actor);
-        if (sensors.first) {
-          std::shared_ptr<CarlaRGBCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaRGBCameraPublisher>(sensors.first);
-          const carla::sensor::s11n::ImageSerializer::ImageHeader *header =
-            reinterpret_cast<const carla::sensor::s11n::ImageSerializer::ImageHeader *>(buffer->data());
-          if (!header)
-            return;
-          if (!publisher->HasBeenInitialized())
-            publisher->InitInfoData(0, 0, H, W, Fov, true);
-          publisher->SetImageData(_seconds, _nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));
-          publisher->SetCameraInfoData(_seconds, _nanoseconds);
-          publisher->Publish();
-        }
-        if (sensors.second) {
-          std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);
-          publisher->Publish();
-        }
-      }
+      sensors = GetOrCreateSensor(ESensors::SceneCaptureCamera, stream_id, actor);
+      if (sensors.first)
+        job = MakeCameraJob<CarlaRGBCameraPublisher, ImageSerializer, uint8_t>(sensors.first, _seconds, _nanoseconds, W, H, Fov, buffer);
       break;
-    }
     case ESensors::SemanticSegmentationCamera:
-      log_info("Sensor SemanticSegmentationCamera to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());
-      {
-        auto sensors = GetOrCreateSensor(ESensors::SemanticSegmentationCamera, stream_id, actor);
-        if (sensors.first) {
-          std::shared_ptr<CarlaSSCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaSSCameraPublisher>(sensors.first);
-          const carla::sensor::s11n::ImageSerializer::ImageHeader *header =
-            reinterpret_cast<const carla::sensor::s11n::ImageSerializer::ImageHeader *>(buffer->data());
-          if (!header)
-            return;
-          if (!publisher->HasBeenInitialized())
-            publisher->InitInfoData(0, 0, H, W, Fov, true);
-          publisher->SetImageData(_seconds, _nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));
-          publisher->SetCameraInfoData(_seconds, _nanoseconds);
-          publisher->Publish();
-        }
-        if (sensors.second) {
-          std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);
-          publisher->Publish();
-        }
-      }
+      sensors = GetOrCreateSensor(ESensors::SemanticSegmentationCamera, stream_id, actor);
+      if (sensors.first)
+        job = MakeCameraJob<CarlaSSCameraPublisher, ImageSerializer, uint8_t>(sensors.first, _seconds, _nanoseconds, W, H, Fov, buffer);
       break;
     case ESensors::InstanceSegmentationCamera:
-      log_info("Sensor InstanceSegmentationCamera to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());
-      {
-        auto sensors = GetOrCreateSensor(ESensors::InstanceSegmentationCamera, stream_id, actor);
-        if (sensors.first) {
-          std::shared_ptr<CarlaISCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaISCameraPublisher>(sensors.first);
-          const carla::sensor::s11n::ImageSerializer::ImageHeader *header =
-            reinterpret_cast<const carla::sensor::s11n::ImageSerializer::ImageHeader *>(buffer->data());
-          if (!header)
-            return;
-          if (!publisher->HasBeenInitialized())
-            publisher->InitInfoData(0, 0, H, W, Fov, true);
-          publisher->SetImageData(_seconds, _nanoseconds, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));
-          publisher->SetCameraInfoData(_seconds, _nanoseconds);
-          publisher->Publish();
-        }
-        if (sensors.second) {
-          std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);
-          publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);
-          publisher->Publish();
-        }
-      }
-      break;
-    case ESensors::WorldObserver:
-      log_info("Sensor WorldObserver to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());
-      break;
-    case ESensors::CameraGBufferUint8:
-      log_info("Sensor CameraGBufferUint8 to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());
-      break;
-    case ESensors::CameraGBufferFloat:
-      log_info("Sensor CameraGBufferFloat to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());
+      sensors = GetOrCreateSensor(ESensors::InstanceSegmentationCamera, stream_id, actor);
+      if (sensors.first)
+        job = MakeCameraJob<CarlaISCameraPublisher, ImageSerializer, uint8_t>(sensors.first, _seconds, _nanoseconds, W, H, Fov, buffer);
       break;
     default:
-      log_info("Sensor to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "buffer.", buffer->size());
+      // No publisher for this sensor.
+      return;
   }
+  if (job)
+    PostJob(sensors.first.get(), std::move(job));
+  PostTransform(std::move(sensors.second), sensor_transform);
 }
 
 void ROS2::ProcessDataFromGNSS(
-    uint64_t sensor_type,
+    uint64_t /*sensor_type*/,
     carla::streaming::detail::stream_id_type stream_id,
     const carla::geom::Transform sensor_transform,
     const carla::geom::GeoLocation &data,
     void *actor) {
-  log_info("Sensor GnssSensor to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "geo.", data.latitude, data.longitude, data.altitude);
   auto sensors = GetOrCreateSensor(ESensors::GnssSensor, stream_id, actor);
   if (sensors.first) {
-    std::shared_ptr<CarlaGNSSPublisher> publisher = std::dynamic_pointer_cast<CarlaGNSSPublisher>(sensors.first);
-    publisher->SetData(_seconds, _nanoseconds, reinterpret_cast<const double*>(&data));
-    publisher->Publish();
-  }
-  if (sensors.second) {
-    std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);
-    publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);
-    publisher->Publish();
+    auto publisher = std::static_pointer_cast<CarlaGNSSPublisher>(sensors.first);
+    PostJob(publisher.get(), [publisher, seconds = _seconds, nanoseconds = _nanoseconds, data]() {
+      publisher->SetData(seconds, nanoseconds, reinterpret_cast<const double*>(&data));
+      publisher->Publish();
+    });
   }
+  PostTransform(std::move(sensors.second), sensor_transform);
 }
 
 void ROS2::ProcessDataFromIMU(
-    uint64_t sensor_type,
+    uint64_t /*sensor_type*/,
     carla::streaming::detail::stream_id_type stream_id,
     const carla::geom::Transform sensor_transform,
     carla::geom::Vector3D accelerometer,
     carla::geom::Vector3D gyroscope,
     float compass,
     void *actor) {
-  log_info("Sensor InertialMeasurementUnit to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "imu.", accelerometer.x, gyroscope.x, compass);
   auto sensors = GetOrCreateSensor(ESensors::InertialMeasurementUnit, stream_id, actor);
   if (sensors.first) {
-    std::shared_ptr<CarlaIMUPublisher> publisher = std::dynamic_pointer_cast<CarlaIMUPublisher>(sensors.first);
-    publisher->SetData(_seconds, _nanoseconds, reinterpret_cast<float*>(&accelerometer), reinterpret_cast<float*>(&gyroscope), compass);
-    publisher->Publish();
-  }
-  if (sensors.second) {
-    std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);
-    publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);
-    publisher->Publish();
+    auto publisher = std::static_pointer_cast<CarlaIMUPublisher>(sensors.first);
+    PostJob(publisher.get(), [publisher, seconds = _seconds, nanoseconds = _nanoseconds, accelerometer, gyroscope, compass]() mutable {
+      publisher->SetData(seconds, nanoseconds, reinterpret_cast<float*>(&accelerometer), reinterpret_cast<float*>(&gyroscope), compass);
+      publisher->Publish();
+    });
   }
+  PostTransform(std::move(sensors.second), sensor_transform);
 }
 
 void ROS2::ProcessDataFromDVS(
-    uint64_t sensor_type,
+    uint64_t /*sensor_type*/,
     carla::streaming::detail::stream_id_type stream_id,
     const carla::geom::Transform sensor_transform,
     const carla::SharedBufferView buffer,
     int W, int H, float Fov,
     void *actor) {
-  log_info("Sensor DVS to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id);
   auto sensors = GetOrCreateSensor(ESensors::DVSCamera, stream_id, actor);
   if (sensors.first) {
-    std::shared_ptr<CarlaDVSCameraPublisher> publisher = std::dynamic_pointer_cast<CarlaDVSCameraPublisher>(sensors.first);
-    const carla::sensor::s11n::ImageSerializer::ImageHeader *header =
-      reinterpret_cast<const carla::sensor::s11n::ImageSerializer::ImageHeader *>(buffer->data());
-    if (!header)
-      return;
-    if (!publisher->HasBeenInitialized())
-      publisher->InitInfoData(0, 0, H, W, Fov, true);
-    size_t elements = (buffer->size() - carla::sensor::s11n::ImageSerializer::header_offset) / sizeof(carla::sensor::data::DVSEvent);
-    publisher->SetImageData(_seconds, _nanoseconds, elements, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));
-    publisher->SetCameraInfoData(_seconds, _nanoseconds);
-    publisher->SetPointCloudData(1, elements * sizeof(carla::sensor::data::DVSEvent), elements, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));
-    publisher->Publish();
-  }
-  if (sensors.second) {
-    std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);
-    publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);
-    publisher->Publish();
+    auto publisher = std::static_pointer_cast<CarlaDVSCameraPublisher>(sensors.first);
+    PostJob(publisher.get(), [publisher, seconds = _seconds, nanoseconds = _nanoseconds, buffer, W, H, Fov]() {
+      const carla::sensor::s11n::ImageSerializer::ImageHeader *header =
+        reinterpret_cast<const carla::sensor::s11n::ImageSerializer::ImageHeader *>(buffer->data());
+      if (!header)
+        return;
+      if (!publisher->HasBeenInitialized())
+        publisher->InitInfoData(0, 0, H, W, Fov, true);
+      size_t elements = (buffer->size() - carla::sensor::s11n::ImageSerializer::header_offset) / sizeof(carla::sensor::data::DVSEvent);
+      publisher->SetImageData(seconds, nanoseconds, elements, header->height, header->width, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));
+      publisher->SetCameraInfoData(seconds, nanoseconds);
+      publisher->SetPointCloudData(1, elements * sizeof(carla::sensor::data::DVSEvent), elements, (const uint8_t*) (buffer->data() + carla::sensor::s11n::ImageSerializer::header_offset));
+      publisher->Publish();
+    });
   }
+  PostTransform(std::move(sensors.second), sensor_transform);
 }
 
 void ROS2::ProcessDataFromLidar(
-    uint64_t sensor_type,
+    uint64_t /*sensor_type*/,
     carla::streaming::detail::stream_id_type stream_id,
     const carla::geom::Transform sensor_transform,
     carla::sensor::data::LidarData &data,
     void *actor) {
-  log_info("Sensor Lidar to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "points.", data._points.size());
   auto sensors = GetOrCreateSensor(ESensors::RayCastLidar, stream_id, actor);
   if (sensors.first) {
-    std::shared_ptr<CarlaLidarPublisher> publisher = std::dynamic_pointer_cast<CarlaLidarPublisher>(sensors.first);
+    auto publisher = std::static_pointer_cast<CarlaLidarPublisher>(sensors.first);
     size_t width = data._points.size();
     size_t height = 1;
-    publisher->SetData(_seconds, _nanoseconds, height, width, (float*)data._points.data());
-    publisher->Publish();
-  }
-  if (sensors.second) {
-    std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);
-    publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);
-    publisher->Publish();
+    // The lidar reuses its points the next frame, copy them once here.
+    const auto *points = reinterpret_cast<const uint8_t*>(data._points.data());
+    std::vector<uint8_t> points_data(points, points + width * sizeof(float));
+    PostJob(publisher.get(), [publisher, seconds = _seconds, nanoseconds = _nanoseconds, height, width, points_data = std::move(points_data)]() mutable {
+      publisher->SetData(seconds, nanoseconds, height, width, std::move(points_data));
+      publisher->Publish();
+    });
   }
+  PostTransform(std::move(sensors.second), sensor_transform);
 }
 
 void ROS2::ProcessDataFromSemanticLidar(
-    uint64_t sensor_type,
+    uint64_t /*sensor_type*/,
     carla::streaming::detail::stream_id_type stream_id,
     const carla::geom::Transform sensor_transform,
     carla::sensor::data::SemanticLidarData &data,
     void *actor) {
   static_assert(sizeof(float) == sizeof(uint32_t), "Invalid float size");
-  log_info("Sensor SemanticLidar to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "points.", data._ser_points.size());
+  static_assert(sizeof(carla::sensor::data::SemanticLidarDetection) == 6 * sizeof(float), "Invalid detection size");
   auto sensors = GetOrCreateSensor(ESensors::RayCastSemanticLidar, stream_id, actor);
   if (sensors.first) {
-    std::shared_ptr<CarlaSemanticLidarPublisher> publisher = std::dynamic_pointer_cast<CarlaSemanticLidarPublisher>(sensors.first);
+    auto publisher = std::static_pointer_cast<CarlaSemanticLidarPublisher>(sensors.first);
     size_t width = data._ser_points.size();
     size_t height = 1;
-    publisher->SetData(_seconds, _nanoseconds, 6, height, width, (float*)data._ser_points.data());
-    publisher->Publish();
-  }
-  if (sensors.second) {
-    std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);
-    publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);
-    publisher->Publish();
+    const auto *points = reinterpret_cast<const uint8_t*>(data._ser_points.data());
+    std::vector<uint8_t> points_data(points, points + width * sizeof(carla::sensor::data::SemanticLidarDetection));
+    PostJob(publisher.get(), [publisher, seconds = _seconds, nanoseconds = _nanoseconds, height, width, points_data = std::move(points_data)]() mutable {
+      publisher->SetData(seconds, nanoseconds, 6, height, width, std::move(points_data));
+      publisher->Publish();
+    });
   }
+  PostTransform(std::move(sensors.second), sensor_transform);
 }
 
 void ROS2::ProcessDataFromRadar(
-    uint64_t sensor_type,
+    uint64_t /*sensor_type*/,
     carla::streaming::detail::stream_id_type stream_id,
     const carla::geom::Transform sensor_transform,
     const carla::sensor::data::RadarData &data,
     void *actor) {
-  log_info("Sensor Radar to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "points.", data._detections.size());
   auto sensors = GetOrCreateSensor(ESensors::Radar, stream_id, actor);
   if (sensors.first) {
-    std::shared_ptr<CarlaRadarPublisher> publisher = std::dynamic_pointer_cast<CarlaRadarPublisher>(sensors.first);
+    auto publisher = std::static_pointer_cast<CarlaRadarPublisher>(sensors.first);
     size_t elements = data.GetDetectionCount();
     size_t width = elements * sizeof(carla::sensor::data::RadarDetection);
     size_t height = 1;
-    publisher->SetData(_seconds, _nanoseconds, height, width, elements, (const uint8_t*)data._detections.data());
-    publisher->Publish();
-  }
-  if (sensors.second) {
-    std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);
-    publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);
-    publisher->Publish();
+    std::vector<carla::sensor::data::RadarDetection> detections = data._detections;
+    PostJob(publisher.get(), [publisher, seconds = _seconds, nanoseconds = _nanoseconds, height, width, elements, detections = std::move(detections)]() {
+      publisher->SetData(seconds, nanoseconds, height, width, elements, (const uint8_t*)detections.data());
+      publisher->Publish();
+    });
   }
+  PostTransform(std::move(sensors.second), sensor_transform);
 }
 
 void ROS2::ProcessDataFromObstacleDetection(
-    uint64_t sensor_type,
-    carla::streaming::detail::stream_id_type stream_id,
-    const carla::geom::Transform sensor_transform,
-    AActor *first_ctor,
-    AActor *second_actor,
-    float distance,
-    void *actor) {
-  log_info("Sensor ObstacleDetector to ROS data: frame.", _frame, "sensor.", sensor_type, "stream.", stream_id, "distance.", distance);
+    uint64_t /*sensor_type*/,
+    carla::streaming::detail::stream_id_type /*stream_id*/,
+    const carla::geom::Transform /*sensor_transform*/,
+    AActor * /*first_ctor*/,
+    AActor * /*second_actor*/,
+    float /*distance*/,
+    void * /*actor*/) {
+  // No publisher for this sensor.
 }
 
 void ROS2::ProcessDataFromCollisionSensor(
-    uint64_t sensor_type,
+    uint64_t /*sensor_type*/,
     carla::streaming::detail::stream_id_type stream_id,
     const carla::geom::Transform sensor_transform,
     uint32_t other_actor,
@@ -820,18 +742,18 @@ void ROS2::ProcessDataFromCollisionSensor(
     void* actor) {
   auto sensors = GetOrCreateSensor(ESensors::CollisionSensor, stream_id, actor);
   if (sensors.first) {
-    std::shared_ptr<CarlaCollisionPublisher> publisher = std::dynamic_pointer_cast<CarlaCollisionPublisher>(sensors.first);
-    publisher->SetData(_seconds, _nanoseconds, other_actor, impulse.x, impulse.y, impulse.z);
-    publisher->Publish();
-  }
-  if (sensors.second) {
-    std::shared_ptr<CarlaTransformPublisher> publisher = std::dynamic_pointer_cast<CarlaTransformPublisher>(sensors.second);
-    publisher->SetData(_seconds, _nanoseconds, (const float*)&sensor_transform.location, (const float*)&sensor_transform.rotation);
-    publisher->Publish();
+    auto publisher = std::static_pointer_cast<CarlaCollisionPublisher>(sensors.first);
+    PostJob(publisher.get(), [publisher, seconds = _seconds, nanoseconds = _nanoseconds, other_actor, impulse]() {
+      publisher->SetData(seconds, nanoseconds, other_actor, impulse.x, impulse.y, impulse.z);
+      publisher->Publish();
+    });
   }
+  PostTransform(std::move(sensors.second), sensor_transform);
 }
 
 void ROS2::Shutdown() {
+  // Stop the publishing threads before destroying the publishers they use.
+  _publish_queue.reset();
   for (auto& element : _publishers) {
     element.second.reset();
   }
@@ -12,6 +12,7 @@
 #include "carla/ros2/ROS2CallbackData.h"
 #include "carla/streaming/detail/Types.h"
 
+#include <functional>
 #include <unordered_set>
 #include <unordered_map>
 #include <memory>
@@ -41,6 +42,7 @@ namespace ros2 {
   class CarlaTransformPublisher;
   class CarlaClockPublisher;
   class CarlaEgoVehicleControlSubscriber;
+  class ROS2PublishQueue;
 
 class ROS2
 {
@@ -144,6 +146,10 @@ void ProcessDataFromCollisionSensor(
   private:
   std::pair<std::shared_ptr<CarlaPublisher>, std::shared_ptr<CarlaTransformPublisher>> GetOrCreateSensor(int type, carla::streaming::detail::stream_id_type id, void* actor);
 
+  // publishing in the publishing threads, in order for each publisher
+  void PostJob(const void *publisher, std::function<void()> job);
+  void PostTransform(std::shared_ptr<CarlaTransformPublisher> publisher, const carla::geom::Transform &sensor_transform);
+
   // sigleton
   ROS2() {};
 
@@ -161,6 +167,7 @@ void ProcessDataFromCollisionSensor(
   std::unordered_map<void *, std::shared_ptr<CarlaTransformPublisher>> _transforms;
   std::unordered_set<carla::streaming::detail::stream_id_type> _publish_stream;
   std::unordered_map<void *, ActorCallback> _actor_callbacks;
+  std::shared_ptr<ROS2PublishQueue> _publish_queue;
 };
 
 } // namespace ros2
@@ -0,0 +1,150 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Logging.h"
+#include "carla/NonCopyable.h"
+#include "carla/ThreadGroup.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+namespace carla {
+namespace ros2 {
+
+  /// Publishes the sensor data in worker threads, so the thread that produces
+  /// the data only hands it over.
+  ///
+  /// The jobs posted for the same publisher run in order and never at the
+  /// same time, as the publishers are not thread-safe; jobs of different
+  /// publishers run in parallel. A publisher that falls behind drops its
+  /// oldest pending samples, a sensor consumer wants the latest one.
+  class ROS2PublishQueue : private NonCopyable {
+  public:
+
+    using Job = std::function<void()>;
+
+    ROS2PublishQueue(size_t worker_threads, size_t max_pending_per_publisher)
+      : _max_pending_per_publisher(std::max<size_t>(max_pending_per_publisher, 1u)) {
+      _workers.CreateThreads(std::max<size_t>(worker_threads, 1u), [this]() { Run(); });
+    }
+
+    /// Discards the pending jobs, waits for the running ones and joins all
+    /// the threads.
+    ~ROS2PublishQueue() {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+      }
+      _pending_condition.notify_all();
+      _workers.JoinAll();
+    }
+
+    /// Queue @a job to run after the jobs already posted for @a publisher.
+    void Post(const void *publisher, Job job) {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto &queue = _queues[publisher];
+        if (queue.jobs.size() >= _max_pending_per_publisher) {
+          queue.jobs.pop_front();
+          ++_dropped_samples;
+        }
+        queue.jobs.emplace_back(std::move(job));
+        if (queue.scheduled) {
+          return;
+        }
+        queue.scheduled = true;
+        _ready.emplace_back(publisher);
+      }
+      _pending_condition.notify_one();
+    }
+
+    /// Block until every job posted so far is done.
+    void Flush() {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _done_condition.wait(lock, [this]() { return _queues.empty(); });
+    }
+
+    /// Number of samples dropped because their publisher was behind.
+    size_t GetDroppedSamples() const {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _dropped_samples;
+    }
+
+  private:
+
+    struct PublisherQueue {
+      std::deque<Job> jobs;
+      /// In the ready list or running a job.
+      bool scheduled = false;
+    };
+
+    void Run() {
+      std::unique_lock<std::mutex> lock(_mutex);
+      while (true) {
+        _pending_condition.wait(lock, [this]() { return _stop || !_ready.empty(); });
+        if (_stop) {
+          return;
+        }
+        const void *publisher = _ready.front();
+        _ready.pop_front();
+        auto &queue = _queues[publisher];
+        Job job = std::move(queue.jobs.front());
+        queue.jobs.pop_front();
+        lock.unlock();
+#ifndef LIBCARLA_NO_EXCEPTIONS
+        try {
+          job();
+        } catch (const std::exception &e) {
+          log_error("ros2: failed to publish:", e.what());
+        }
+#else
+        job();
+#endif // LIBCARLA_NO_EXCEPTIONS
+        // Release what the job holds, as the sensor buffer, before taking the
+        // lock.
+        job = nullptr;
+        lock.lock();
+        auto it = _queues.find(publisher);
+        if (it->second.jobs.empty()) {
+          _queues.erase(it);
+          if (_queues.empty()) {
+            _done_condition.notify_all();
+          }
+        } else {
+          _ready.emplace_back(publisher);
+          _pending_condition.notify_one();
+        }
+      }
+    }
+
+    const size_t _max_pending_per_publisher;
+
+    mutable std::mutex _mutex;
+
+    std::condition_variable _pending_condition;
+
+    std::condition_variable _done_condition;
+
+    std::unordered_map<const void *, PublisherQueue> _queues;
+
+    std::deque<const void *> _ready;
+
+    size_t _dropped_samples = 0u;
+
+    bool _stop = false;
+
+    ThreadGroup _workers;
+  };
+
+} // namespace ros2
+} // namespace carla
@@ -150,11 +150,6 @@ namespace ros2 {
 
 
 void CarlaLidarPublisher::SetData(int32_t seconds, uint32_t nanoseconds, size_t height, size_t width, float* data) {
-    float* it = data;
-    float* end = &data[height * width];
-    for (++it; it < end; it += 4) {
-        *it *= -1.0f;
-    }
     std::vector<uint8_t> vector_data;
     const size_t size = height * width * sizeof(float);
     vector_data.resize(size);
@@ -163,6 +158,12 @@ void CarlaLidarPublisher::SetData(int32_t seconds, uint32_t nanoseconds, size_t
   }
 
   void CarlaLidarPublisher::SetData(int32_t seconds, uint32_t nanoseconds, size_t height, size_t width, std::vector<uint8_t>&& data) {
+    float* it = reinterpret_cast<float*>(data.data());
+    float* end = it + height * width;
+    for (++it; it < end; it += 4) {
+        *it *= -1.0f;
+    }
+
     builtin_interfaces::msg::Time time;
     time.sec(seconds);
     time.nanosec(nanoseconds);
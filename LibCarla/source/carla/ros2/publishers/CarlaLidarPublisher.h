@@ -27,10 +27,9 @@ namespace ros2 {
       bool Init();
       bool Publish();
       void SetData(int32_t seconds, uint32_t nanoseconds, size_t height, size_t width, float* data);
-      const char* type() const override { return "lidar"; }
-
-    private:
+      /// Takes the points without copying them.
       void SetData(int32_t seconds, uint32_t nanoseconds, size_t height, size_t width, std::vector<uint8_t>&& data);
+      const char* type() const override { return "lidar"; }
 
     private:
       std::shared_ptr<CarlaLidarPublisherImpl> _impl;
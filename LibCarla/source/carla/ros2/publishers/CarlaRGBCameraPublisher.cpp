@@ -292,10 +292,10 @@ namespace ros2 {
   }
 
 void CarlaRGBCameraPublisher::SetImageData(int32_t seconds, uint32_t nanoseconds, uint32_t height, uint32_t width, const uint8_t* data) {
-    std::vector<uint8_t> vector_data;
+    // copy into the storage of the previous sample, it keeps its capacity
+    std::vector<uint8_t> vector_data = std::move(_impl->_image.data());
     const size_t size = height * width * 4;
-    vector_data.resize(size);
-    std::memcpy(&vector_data[0], &data[0], size);
+    vector_data.assign(data, data + size);
     SetImageData(seconds, nanoseconds, height, width, std::move(vector_data));
   }
 
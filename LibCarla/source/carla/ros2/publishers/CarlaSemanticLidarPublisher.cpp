@@ -149,20 +149,20 @@ namespace ros2 {
   }
 
 void CarlaSemanticLidarPublisher::SetData(int32_t seconds, uint32_t nanoseconds, size_t elements, size_t height, size_t width, float* data) {
-    float* it = data;
-    float* end = &data[height * width * elements];
-    for (++it; it < end; it += elements) {
-        *it *= -1.0f;
-    }
-
     std::vector<uint8_t> vector_data;
     const size_t size = height * width * sizeof(float) * elements;
     vector_data.resize(size);
     std::memcpy(&vector_data[0], &data[0], size);
-    SetData(seconds, nanoseconds, height, width, std::move(vector_data));
+    SetData(seconds, nanoseconds, elements, height, width, std::move(vector_data));
 }
 
-void CarlaSemanticLidarPublisher::SetData(int32_t seconds, uint32_t nanoseconds, size_t height, size_t width, std::vector<uint8_t>&& data) {
+void CarlaSemanticLidarPublisher::SetData(int32_t seconds, uint32_t nanoseconds, size_t elements, size_t height, size_t width, std::vector<uint8_t>&& data) {
+    float* it = reinterpret_cast<float*>(data.data());
+    float* end = it + height * width * elements;
+    for (++it; it < end; it += elements) {
+        *it *= -1.0f;
+    }
+
     builtin_interfaces::msg::Time time;
     time.sec(seconds);
     time.nanosec(nanoseconds);
@@ -27,11 +27,10 @@ namespace ros2 {
       bool Init();
       bool Publish();
       void SetData(int32_t seconds, uint32_t nanoseconds, size_t elements, size_t height, size_t width, float* data);
+      /// Takes the points without copying them.
+      void SetData(int32_t seconds, uint32_t nanoseconds, size_t elements, size_t height, size_t width, std::vector<uint8_t>&& data);
       const char* type() const override { return "semantic lidar"; }
 
-    private:
-      void SetData(int32_t seconds, uint32_t nanoseconds, size_t height, size_t width, std::vector<uint8_t>&& data);
-
     private:
       std::shared_ptr<CarlaSemanticLidarPublisherImpl> _impl;
   };
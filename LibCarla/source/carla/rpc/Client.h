@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "carla/profiler/Tracer.h"
 #include "carla/rpc/Metadata.h"
 
 #include <rpc/client.h>
@@ -30,11 +31,13 @@ namespace rpc {
 
     template <typename... Args>
     auto call(const std::string &function, Args &&... args) {
+      CARLA_TRACE_SCOPE("rpc", function);
       return _client.call(function, Metadata::MakeSync(), std::forward<Args>(args)...);
     }
 
     template <typename... Args>
     void async_call(const std::string &function, Args &&... args) {
+      CARLA_TRACE_SCOPE("rpc", function);
       _client.async_call(function, Metadata::MakeAsync(), std::forward<Args>(args)...);
     }
 
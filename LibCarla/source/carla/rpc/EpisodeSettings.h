@@ -49,9 +49,13 @@ namespace rpc {
 
     bool spectator_as_ego = true;
 
+    /// Send only the actors that changed between keyframes in the episode
+    /// state stream.
+    bool delta_episode_state = false;
+
     MSGPACK_DEFINE_ARRAY(synchronous_mode, no_rendering_mode, fixed_delta_seconds, substepping,
         max_substep_delta_time, max_substeps, max_culling_distance, deterministic_ragdolls,
-        tile_stream_distance, actor_active_distance, spectator_as_ego);
+        tile_stream_distance, actor_active_distance, spectator_as_ego, delta_episode_state);
 
     // =========================================================================
     // -- Constructors ---------------------------------------------------------
@@ -70,7 +74,8 @@ namespace rpc {
         bool deterministic_ragdolls = true,
         float tile_stream_distance = 3000.f,
         float actor_active_distance = 2000.f,
-        bool spectator_as_ego = true)
+        bool spectator_as_ego = true,
+        bool delta_episode_state = false)
       : synchronous_mode(synchronous_mode),
         no_rendering_mode(no_rendering_mode),
         fixed_delta_seconds(
@@ -82,7 +87,8 @@ namespace rpc {
         deterministic_ragdolls(deterministic_ragdolls),
         tile_stream_distance(tile_stream_distance),
         actor_active_distance(actor_active_distance),
-        spectator_as_ego(spectator_as_ego) {}
+        spectator_as_ego(spectator_as_ego),
+        delta_episode_state(delta_episode_state) {}
 
     // =========================================================================
     // -- Comparison operators -------------------------------------------------
@@ -100,7 +106,8 @@ namespace rpc {
           (deterministic_ragdolls == rhs.deterministic_ragdolls) &&
           (tile_stream_distance == rhs.tile_stream_distance) &&
           (actor_active_distance == rhs.actor_active_distance) &&
-          (spectator_as_ego == rhs.spectator_as_ego);
+          (spectator_as_ego == rhs.spectator_as_ego) &&
+          (delta_episode_state == rhs.delta_episode_state);
     }
 
     bool operator!=(const EpisodeSettings &rhs) const {
@@ -125,7 +132,8 @@ namespace rpc {
             Settings.bDeterministicRagdolls,
             Settings.TileStreamingDistance,
             Settings.ActorActiveDistance,
-            Settings.SpectatorAsEgo) {
+            Settings.SpectatorAsEgo,
+            Settings.bDeltaEpisodeState) {
       constexpr float CMTOM = 1.f/100.f;
       tile_stream_distance = CMTOM * Settings.TileStreamingDistance;
       actor_active_distance = CMTOM * Settings.ActorActiveDistance;
@@ -147,6 +155,7 @@ namespace rpc {
       Settings.TileStreamingDistance = MTOCM * tile_stream_distance;
       Settings.ActorActiveDistance = MTOCM * actor_active_distance;
       Settings.SpectatorAsEgo = spectator_as_ego;
+      Settings.bDeltaEpisodeState = delta_episode_state;
 
       return Settings;
     }
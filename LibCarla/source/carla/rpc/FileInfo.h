@@ -0,0 +1,29 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+
+#include <cstdint>
+
+namespace carla {
+namespace rpc {
+
+  /// Size and content hash of a file the server can transfer, see
+  /// carla::Fnv1aHash.
+  class FileInfo {
+  public:
+
+    uint64_t size = 0u;
+
+    uint64_t hash = 0u;
+
+    MSGPACK_DEFINE_ARRAY(size, hash);
+  };
+
+} // namespace rpc
+} // namespace carla
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "carla/Debug.h"
+#include "carla/ListView.h"
 #include "carla/sensor/data/ActorDynamicState.h"
 #include "carla/sensor/data/Array.h"
 #include "carla/sensor/s11n/EpisodeStateSerializer.h"
@@ -25,7 +26,9 @@ namespace data {
     friend Serializer;
 
     explicit RawEpisodeState(RawData &&data)
-      : Super(Serializer::header_offset, std::move(data)) {}
+      : Super(std::move(data), [](const RawData &d) {
+          return Serializer::GetActorsOffset(d);
+        }) {}
 
   private:
 
@@ -66,6 +69,30 @@ namespace data {
       return GetHeader().simulation_state;
     }
 
+    /// Whether this is a delta frame, i.e. contains only the actors that
+    /// changed since GetBaseFrame(), or a keyframe containing every actor.
+    bool IsDeltaFrame() const {
+      return Serializer::IsDeltaFrame(Super::GetRawData());
+    }
+
+    /// Frame this delta applies to.
+    ///
+    /// @pre IsDeltaFrame().
+    uint64_t GetBaseFrame() const {
+      DEBUG_ASSERT(IsDeltaFrame());
+      return Serializer::DeserializeDeltaHeader(Super::GetRawData()).base_frame;
+    }
+
+    /// Actors destroyed since GetBaseFrame(), empty for keyframes.
+    auto GetDestroyedActorIds() const {
+      const auto &raw_data = Super::GetRawData();
+      const ActorId *begin = IsDeltaFrame() ? Serializer::GetDestroyedActorIds(raw_data) : nullptr;
+      const ActorId *end = IsDeltaFrame() ?
+          begin + Serializer::DeserializeDeltaHeader(raw_data).destroyed_count :
+          nullptr;
+      return MakeListView(begin, end);
+    }
+
   };
 
 } // namespace data
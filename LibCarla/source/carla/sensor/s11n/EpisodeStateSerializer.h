@@ -14,7 +14,9 @@
 #include "carla/sensor/RawData.h"
 #include "carla/sensor/data/ActorDynamicState.h"
 
+#include <cmath>
 #include <cstdint>
+#include <cstring>
 
 namespace carla {
 namespace sensor {
@@ -24,15 +26,32 @@ namespace sensor {
 namespace s11n {
 
   /// Serializes the current state of the whole episode.
+  ///
+  /// A message is either a keyframe, containing the state of every actor, or
+  /// a delta frame (DeltaFrame flag set), containing only the actors created
+  /// or changed since the frame it is based on, followed by the ids of the
+  /// actors destroyed meanwhile:
+  ///
+  ///   Header | [DeltaHeader | ActorId * destroyed_count] | ActorDynamicState *
   class EpisodeStateSerializer {
   public:
 
     enum SimulationState {
       None               = (0x0 << 0),
       MapChange          = (0x1 << 0),
-      PendingLightUpdate = (0x1 << 1)
+      PendingLightUpdate = (0x1 << 1),
+      DeltaFrame         = (0x1 << 2)
     };
 
+    /// Maximum number of frames sent between two keyframes in delta mode.
+    static constexpr uint64_t KEYFRAME_INTERVAL = 100u;
+
+    /// Minimum changes, in meters, degrees and meters per second, for an
+    /// actor to be sent in a delta frame.
+    static constexpr float LOCATION_THRESHOLD = 1e-3f;
+    static constexpr float ROTATION_THRESHOLD = 1e-2f;
+    static constexpr float VELOCITY_THRESHOLD = 1e-3f;
+
 #pragma pack(push, 1)
     struct Header {
       uint64_t episode_id;
@@ -41,6 +60,12 @@ namespace s11n {
       geom::Vector3DInt map_origin;
       SimulationState simulation_state = SimulationState::None;
     };
+
+    struct DeltaHeader {
+      /// Frame of the message this delta applies to.
+      uint64_t base_frame;
+      uint32_t destroyed_count;
+    };
 #pragma pack(pop)
 
     constexpr static auto header_offset = sizeof(Header);
@@ -49,6 +74,55 @@ namespace s11n {
       return *reinterpret_cast<const Header *>(message.begin());
     }
 
+    static bool IsDeltaFrame(const RawData &message) {
+      return (DeserializeHeader(message).simulation_state & SimulationState::DeltaFrame) != 0;
+    }
+
+    /// @pre IsDeltaFrame(message).
+    static const DeltaHeader &DeserializeDeltaHeader(const RawData &message) {
+      return *reinterpret_cast<const DeltaHeader *>(message.begin() + header_offset);
+    }
+
+    /// @pre IsDeltaFrame(message).
+    static const ActorId *GetDestroyedActorIds(const RawData &message) {
+      return reinterpret_cast<const ActorId *>(
+          message.begin() + header_offset + sizeof(DeltaHeader));
+    }
+
+    /// Offset of the array of ActorDynamicState in @a message.
+    static size_t GetActorsOffset(const RawData &message) {
+      if (!IsDeltaFrame(message)) {
+        return header_offset;
+      }
+      return header_offset + sizeof(DeltaHeader) +
+          sizeof(ActorId) * DeserializeDeltaHeader(message).destroyed_count;
+    }
+
+    /// Whether @a current differs enough from @a previous, the state last sent
+    /// of the same actor, to be included in a delta frame.
+    static bool HasChanged(
+        const data::ActorDynamicState &previous,
+        const data::ActorDynamicState &current) {
+      auto differs = [](const geom::Vector3D &lhs, const geom::Vector3D &rhs, float threshold) {
+        return (std::abs(lhs.x - rhs.x) > threshold) ||
+               (std::abs(lhs.y - rhs.y) > threshold) ||
+               (std::abs(lhs.z - rhs.z) > threshold);
+      };
+      const auto &prev_rotation = previous.transform.rotation;
+      const auto &rotation = current.transform.rotation;
+      return
+          (previous.actor_state != current.actor_state) ||
+          differs(previous.transform.location, current.transform.location, LOCATION_THRESHOLD) ||
+          differs(
+              geom::Vector3D{prev_rotation.pitch, prev_rotation.yaw, prev_rotation.roll},
+              geom::Vector3D{rotation.pitch, rotation.yaw, rotation.roll},
+              ROTATION_THRESHOLD) ||
+          differs(previous.velocity, current.velocity, VELOCITY_THRESHOLD) ||
+          differs(previous.angular_velocity, current.angular_velocity, VELOCITY_THRESHOLD) ||
+          differs(previous.acceleration, current.acceleration, VELOCITY_THRESHOLD) ||
+          (std::memcmp(&previous.state, &current.state, sizeof(current.state)) != 0);
+    }
+
     template <typename SensorT>
     static Buffer Serialize(const SensorT &, Buffer &&buffer) {
       return std::move(buffer);
@@ -44,6 +44,12 @@ namespace streaming {
       _client.UnSubscribe(token);
     }
 
+    /// Whether to receive all the streams of a server through a single
+    /// connection. Applies to streams subscribed afterwards.
+    void SetMultiplexed(bool enabled) {
+      _client.SetMultiplexed(enabled);
+    }
+
     void Run() {
       _service.Run();
     }
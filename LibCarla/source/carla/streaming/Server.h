@@ -71,6 +71,14 @@ namespace streaming {
       _server.SetSynchronousMode(is_synchro);
     }
 
+    void SetSendQueueSize(size_t size) {
+      _server.SetSendQueueSize(size);
+    }
+
+    void SetDropPolicy(detail::DropPolicy policy) {
+      _server.SetDropPolicy(policy);
+    }
+
     token_type GetToken(stream_id sensor_id) {
       return _server.GetToken(sensor_id);
     }
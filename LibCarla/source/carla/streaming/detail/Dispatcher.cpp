@@ -37,6 +37,10 @@ namespace detail {
   carla::streaming::Stream Dispatcher::MakeStream() {
     std::lock_guard<std::mutex> lock(_mutex);
     ++_cached_token._token.stream_id; // id zero only happens in overflow.
+    if (_cached_token._token.stream_id == tcp::multiplexed::HANDSHAKE_STREAM_ID) {
+      // Reserved to request multiplexed sessions.
+      ++_cached_token._token.stream_id;
+    }
     log_debug("New stream:", _cached_token._token.stream_id);
     std::shared_ptr<MultiStreamState> ptr;
     auto search = _stream_map.find(_cached_token.get_stream_id());
@@ -72,31 +76,43 @@ namespace detail {
   }
 
   bool Dispatcher::RegisterSession(std::shared_ptr<Session> session) {
+    DEBUG_ASSERT(session != nullptr);
+    const auto stream_id = session->get_stream_id();
+    return RegisterSession(std::move(session), stream_id);
+  }
+
+  bool Dispatcher::RegisterSession(std::shared_ptr<Session> session, stream_id_type stream_id) {
     DEBUG_ASSERT(session != nullptr);
     std::lock_guard<std::mutex> lock(_mutex);
-    auto search = _stream_map.find(session->get_stream_id());
+    auto search = _stream_map.find(stream_id);
     if (search != _stream_map.end()) {
       auto stream_state = search->second;
       if (stream_state) {
-        log_debug("Connecting session (stream ", session->get_stream_id(), ")");
+        log_debug("Connecting session (stream ", stream_id, ")");
         stream_state->ConnectSession(std::move(session));
         log_debug("Current streams: ", _stream_map.size());
         return true;
       }
     }
-    log_error("Invalid session: no stream available with id", session->get_stream_id());
+    log_error("Invalid session: no stream available with id", stream_id);
     return false;
   }
 
   void Dispatcher::DeregisterSession(std::shared_ptr<Session> session) {
+    DEBUG_ASSERT(session != nullptr);
+    const auto stream_id = session->get_stream_id();
+    DeregisterSession(std::move(session), stream_id);
+  }
+
+  void Dispatcher::DeregisterSession(std::shared_ptr<Session> session, stream_id_type stream_id) {
     DEBUG_ASSERT(session != nullptr);
     std::lock_guard<std::mutex> lock(_mutex);
-    log_debug("Calling DeregisterSession for ", session->get_stream_id());
-    auto search = _stream_map.find(session->get_stream_id());
+    log_debug("Calling DeregisterSession for ", stream_id);
+    auto search = _stream_map.find(stream_id);
     if (search != _stream_map.end()) {
       auto stream_state = search->second;
       if (stream_state) {
-        log_debug("Disconnecting session (stream ", session->get_stream_id(), ")");
+        log_debug("Disconnecting session (stream ", stream_id, ")");
         stream_state->DisconnectSession(session);
         log_debug("Current streams: ", _stream_map.size());
       }
@@ -39,8 +39,14 @@ namespace detail {
 
     bool RegisterSession(std::shared_ptr<Session> session);
 
+    /// Connect @a session to the stream @a stream_id. Used by multiplexed
+    /// sessions, which carry several streams.
+    bool RegisterSession(std::shared_ptr<Session> session, stream_id_type stream_id);
+
     void DeregisterSession(std::shared_ptr<Session> session);
 
+    void DeregisterSession(std::shared_ptr<Session> session, stream_id_type stream_id);
+
     token_type GetToken(stream_id_type sensor_id);
 
     void EnableForROS(stream_id_type sensor_id) {
@@ -6,13 +6,11 @@
 
 #pragma once
 
-#include "carla/AtomicSharedPtr.h"
+#include "carla/AtomicList.h"
 #include "carla/Logging.h"
 #include "carla/streaming/detail/StreamStateBase.h"
 #include "carla/streaming/detail/tcp/Message.h"
 
-#include <mutex>
-#include <vector>
 #include <atomic>
 
 namespace carla {
@@ -21,41 +19,25 @@ namespace detail {
 
   /// A stream state that can hold any number of sessions.
   ///
-  /// @todo Lacking some optimization.
+  /// The list of sessions is copied on each connection and disconnection, so
+  /// writing a message never waits for other threads. Each session queues the
+  /// message and applies its own drop policy, see tcp::ServerSession.
   class MultiStreamState final : public StreamStateBase {
   public:
 
     using StreamStateBase::StreamStateBase;
 
-    MultiStreamState(const token_type &token) :
-      StreamStateBase(token),
-      _session(nullptr)
-      {};
-
     template <typename... Buffers>
     void Write(Buffers... buffers) {
-      // try write single stream
-      auto session = _session.load();
-      if (session != nullptr) {
-        auto message = Session::MakeMessage(buffers...);
-        session->Write(std::move(message));
-        log_debug("sensor ", session->get_stream_id()," data sent");
-        // Return here, _session is only valid if we have a
-        // single session.
+      auto sessions = _sessions.Load();
+      if (sessions->empty()) {
         return;
       }
-
-      // try write multiple stream
-      std::lock_guard<std::mutex> lock(_mutex);
-      if (_sessions.size() > 0) {
-        auto message = Session::MakeMessage(buffers...);
-        for (auto &s : _sessions) {
-          if (s != nullptr) {
-            s->Write(message);
-            log_debug("sensor ", s->get_stream_id()," data sent ");
-         }
-        }
+      auto message = Session::MakeMessage(buffers...);
+      for (auto &s : *sessions) {
+        s->Write(token().get_stream_id(), message);
       }
+      log_debug("sensor ", token().get_stream_id(), " data sent to", sessions->size(), "sessions");
     }
 
     void ForceActive() {
@@ -75,70 +57,63 @@ namespace detail {
     }
 
     bool AreClientsListening() {
-      return (_sessions.size() > 0 || _force_active || _enabled_for_ros);
+      return (!_sessions.Load()->empty() || _force_active || _enabled_for_ros);
+    }
+
+    /// Number of sessions connected to this stream so far. Lets streams whose
+    /// messages depend on the previous ones notice new subscribers.
+    size_t GetConnectionCount() const {
+      return _connection_count;
+    }
+
+    /// Number of messages of all the sessions currently connected that were
+    /// discarded because their clients could not keep up.
+    size_t GetDroppedMessageCount() const {
+      size_t count = 0u;
+      for (auto &s : *_sessions.Load()) {
+        count += s->GetDroppedMessageCount();
+      }
+      return count;
     }
 
     void ConnectSession(std::shared_ptr<Session> session) final {
       DEBUG_ASSERT(session != nullptr);
-      std::lock_guard<std::mutex> lock(_mutex);
-      _sessions.emplace_back(std::move(session));
-      log_debug("Connecting multistream sessions:", _sessions.size());
-      if (_sessions.size() == 1) {
-        _session.store(_sessions[0]);
-      }
-      else if (_sessions.size() > 1) {
-        _session.store(nullptr);
-      }
+      _sessions.Push(std::move(session));
+      ++_connection_count;
+      log_debug("Connecting multistream sessions:", _sessions.Load()->size());
     }
 
     void DisconnectSession(std::shared_ptr<Session> session) final {
       DEBUG_ASSERT(session != nullptr);
-      std::lock_guard<std::mutex> lock(_mutex);
-      log_debug("Calling DisconnectSession for ", session->get_stream_id());
-      if (_sessions.size() == 0) return;
-      if (_sessions.size() == 1) {
-        DEBUG_ASSERT(session == _session.load());
-        _session.store(nullptr);
-        _sessions.clear();
+      log_debug("Calling DisconnectSession for ", token().get_stream_id());
+      _sessions.DeleteByValue(session);
+      if (_sessions.Load()->empty()) {
         _force_active = false;
         log_debug("Last session disconnected");
-      } else {
-        _sessions.erase(
-            std::remove(_sessions.begin(), _sessions.end(), session),
-            _sessions.end());
-
-        // set single session if only one
-        if (_sessions.size() == 1)
-          _session.store(_sessions[0]);
-        else
-          _session.store(nullptr);
       }
-      log_debug("Disconnecting multistream sessions:", _sessions.size());
+      log_debug("Disconnecting multistream sessions:", _sessions.Load()->size());
     }
 
     void ClearSessions() final {
-      std::lock_guard<std::mutex> lock(_mutex);
-      for (auto &s : _sessions) {
-        if (s != nullptr) {
-          s->Close();
-        }
-      }
-      _sessions.clear();
+      // Take the list at once, a session connected meanwhile is either closed
+      // here or left connected.
+      auto sessions = _sessions.Take();
       _force_active = false;
-      _session.store(nullptr);
+      for (auto &s : *sessions) {
+        s->CloseStream(token().get_stream_id());
+      }
       log_debug("Disconnecting all multistream sessions");
     }
 
   private:
 
-    std::mutex _mutex;
+    client::detail::AtomicList<std::shared_ptr<Session>> _sessions;
+
+    std::atomic_bool _force_active {false};
+
+    std::atomic_bool _enabled_for_ros {false};
 
-    // if there is only one session, then we use atomic
-    AtomicSharedPtr<Session> _session;
-    // if there are more than one session, we use vector of sessions with mutex
-    std::vector<std::shared_ptr<Session>> _sessions;
-    bool _force_active {false};
-    bool _enabled_for_ros {false};
+    std::atomic_size_t _connection_count {0u};
   };
 
 } // namespace detail
@@ -67,6 +67,16 @@ namespace detail {
       return _shared_state ? _shared_state->AreClientsListening() : false;
     }
 
+    size_t GetConnectionCount() const
+    {
+      return _shared_state ? _shared_state->GetConnectionCount() : 0u;
+    }
+
+    size_t GetDroppedMessageCount() const
+    {
+      return _shared_state ? _shared_state->GetDroppedMessageCount() : 0u;
+    }
+
   private:
 
     friend class detail::Dispatcher;
@@ -23,6 +23,19 @@ namespace detail {
       std::is_same<message_size_type, Buffer::size_type>::value,
       "uint type mismatch!");
 
+  /// What a server session does with a new message when its send queue for
+  /// that stream is full.
+  enum class DropPolicy : uint8_t {
+    /// Block in synchronous mode, drop the new message otherwise.
+    Default,
+    /// Discard the oldest message waiting in the queue.
+    DropOldest,
+    /// Discard the new message.
+    DropNewest,
+    /// Wait until the queue has room for the new message.
+    Block
+  };
+
 } // namespace detail
 } // namespace streaming
 } // namespace carla
@@ -6,11 +6,12 @@
 
 #include "carla/streaming/detail/tcp/Client.h"
 
-#include "carla/BufferPool.h"
+#include "carla/Buffer.h"
 #include "carla/Debug.h"
 #include "carla/Exception.h"
 #include "carla/Logging.h"
 #include "carla/Time.h"
+#include "carla/profiler/Tracer.h"
 
 #include <boost/asio/connect.hpp>
 #include <boost/asio/read.hpp>
@@ -74,8 +75,7 @@ namespace tcp {
       _callback(std::move(callback)),
       _socket(io_context),
       _strand(io_context),
-      _connection_timer(io_context),
-      _buffer_pool(std::make_shared<BufferPool>()) {
+      _connection_timer(io_context) {
     if (!_token.protocol_is_tcp()) {
       throw_exception(std::invalid_argument("invalid token, only TCP tokens supported"));
     }
@@ -166,7 +166,8 @@ namespace tcp {
 
       // log_debug("streaming client: Client::ReadData");
 
-      auto message = std::make_shared<IncomingMessage>(_buffer_pool->Pop());
+      // The memory is reused from the buffers freed by any client.
+      auto message = std::make_shared<IncomingMessage>(Buffer());
 
       auto handle_read_data = [this, self, message](boost::system::error_code ec, size_t DEBUG_ONLY(bytes)) {
         DEBUG_ONLY(log_debug("streaming client: Client::ReadData.handle_read_data", bytes, "bytes"));
@@ -176,7 +177,11 @@ namespace tcp {
           // Move the buffer to the callback function and start reading the next
           // piece of data.
           // log_debug("streaming client: success reading data, calling the callback");
-          self->_callback(message->pop());
+          {
+            CARLA_TRACE_SCOPE("streaming", "Callback");
+            CARLA_TRACE_COUNTER("streaming", "MessageSize", message->size());
+            self->_callback(message->pop());
+          }
           ReadData();
         } else {
           // As usual, if anything fails start over from the very top.
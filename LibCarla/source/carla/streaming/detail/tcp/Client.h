@@ -22,9 +22,6 @@
 #include <memory>
 
 namespace carla {
-
-  class BufferPool;
-
 namespace streaming {
 namespace detail {
 namespace tcp {
@@ -74,8 +71,6 @@ namespace tcp {
 
     boost::asio::deadline_timer _connection_timer;
 
-    std::shared_ptr<BufferPool> _buffer_pool;
-
     std::atomic_bool _done{false};
   };
 
@@ -0,0 +1,350 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/tcp/MultiplexedClient.h"
+
+#include "carla/Buffer.h"
+#include "carla/Debug.h"
+#include "carla/Logging.h"
+#include "carla/Time.h"
+
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+#include <vector>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+  MultiplexedClient::MultiplexedClient(boost::asio::io_context &io_context, endpoint ep)
+    : LIBCARLA_INITIALIZE_LIFETIME_PROFILER(std::string("tcp multiplexed client")),
+      _io_context(io_context),
+      _endpoint(std::move(ep)),
+      _socket(io_context),
+      _strand(io_context),
+      _connection_timer(io_context) {}
+
+  MultiplexedClient::~MultiplexedClient() = default;
+
+  void MultiplexedClient::Subscribe(const token_type &token, callback_function_type callback) {
+    DEBUG_ASSERT(token.to_tcp_endpoint() == _endpoint);
+    const stream_id_type stream_id = token.get_stream_id();
+    auto subscription = std::make_shared<Subscription>();
+    subscription->token = token;
+    subscription->callback = std::move(callback);
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _subscriptions[stream_id] = subscription;
+    }
+    auto self = shared_from_this();
+    boost::asio::post(_strand, [this, self, stream_id, subscription]() {
+      if (_done) {
+        return;
+      }
+      switch (_mode) {
+        case Mode::Multiplexed:
+          SendControlMessage(multiplexed::Command::Subscribe, stream_id, multiplexed::DEFAULT_WINDOW);
+          break;
+        case Mode::Fallback: {
+          std::lock_guard<std::mutex> lock(_mutex);
+          if (subscription->fallback_client == nullptr) {
+            subscription->fallback_client = std::make_shared<Client>(
+                _io_context,
+                subscription->token,
+                subscription->callback);
+            subscription->fallback_client->Connect();
+          }
+          break;
+        }
+        case Mode::Negotiating:
+          // Subscribed once the server accepts the multiplexed session.
+          break;
+      }
+    });
+  }
+
+  void MultiplexedClient::UnSubscribe(stream_id_type stream_id) {
+    std::shared_ptr<Client> fallback_client;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto it = _subscriptions.find(stream_id);
+      if (it == _subscriptions.end()) {
+        return;
+      }
+      fallback_client = std::move(it->second->fallback_client);
+      _subscriptions.erase(it);
+    }
+    if (fallback_client != nullptr) {
+      fallback_client->Stop();
+      return;
+    }
+    auto self = shared_from_this();
+    boost::asio::post(_strand, [this, self, stream_id]() {
+      if (!_done && (_mode == Mode::Multiplexed)) {
+        SendControlMessage(multiplexed::Command::Unsubscribe, stream_id, 0u);
+      }
+    });
+  }
+
+  void MultiplexedClient::Connect() {
+    auto self = shared_from_this();
+    boost::asio::post(_strand, [this, self]() {
+      if (_done || (_mode == Mode::Fallback)) {
+        return;
+      }
+
+      using boost::system::error_code;
+
+      if (_socket.is_open()) {
+        _socket.close();
+      }
+      // Handlers of the previous connection are ignored from now on.
+      const size_t connection = ++_connection_count;
+      _mode = Mode::Negotiating;
+      _control_queue.clear();
+      _is_writing_control = false;
+
+      auto handle_connect = [this, self, connection](error_code ec) {
+        if (_done || (connection != _connection_count)) {
+          return;
+        }
+        if (ec) {
+          log_info("streaming client: connection failed:", ec.message());
+          Reconnect();
+          return;
+        }
+        // This forces not using Nagle's algorithm.
+        // Improves the sync mode velocity on Linux by a factor of ~3.
+        _socket.set_option(boost::asio::ip::tcp::no_delay(true));
+        log_debug("streaming client: connected to", _endpoint, ", requesting multiplexed session");
+        static const stream_id_type handshake = multiplexed::HANDSHAKE_STREAM_ID;
+        boost::asio::async_write(
+            _socket,
+            boost::asio::buffer(&handshake, sizeof(handshake)),
+            boost::asio::bind_executor(_strand, [this, self, connection](error_code ec2, size_t) {
+              if (_done || (connection != _connection_count)) {
+                return;
+              }
+              if (ec2) {
+                log_debug("streaming client: failed to send handshake:", ec2.message());
+                Connect();
+              } else {
+                ReadFrame(connection);
+              }
+            }));
+      };
+
+      log_debug("streaming client: connecting to", _endpoint);
+      _socket.async_connect(_endpoint, boost::asio::bind_executor(_strand, handle_connect));
+    });
+  }
+
+  void MultiplexedClient::Stop() {
+    _connection_timer.cancel();
+    _done = true;
+    std::vector<std::shared_ptr<Client>> fallback_clients;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      for (auto &subscription : _subscriptions) {
+        if (subscription.second->fallback_client != nullptr) {
+          fallback_clients.emplace_back(std::move(subscription.second->fallback_client));
+        }
+      }
+      _subscriptions.clear();
+    }
+    for (auto &client : fallback_clients) {
+      client->Stop();
+    }
+    if (_socket.is_open()) {
+      _socket.close();
+    }
+  }
+
+  void MultiplexedClient::Reconnect() {
+    auto self = shared_from_this();
+    _connection_timer.expires_from_now(time_duration::seconds(1u));
+    _connection_timer.async_wait([this, self](boost::system::error_code ec) {
+      if (!ec) {
+        Connect();
+      }
+    });
+  }
+
+  void MultiplexedClient::FallBack() {
+    log_info("streaming client: server", _endpoint, "does not support multiplexing, using a connection per stream");
+    _mode = Mode::Fallback;
+    if (_socket.is_open()) {
+      _socket.close();
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto &item : _subscriptions) {
+      Subscription &subscription = *item.second;
+      if (subscription.fallback_client == nullptr) {
+        subscription.fallback_client = std::make_shared<Client>(
+            _io_context,
+            subscription.token,
+            subscription.callback);
+        subscription.fallback_client->Connect();
+      }
+    }
+  }
+
+  void MultiplexedClient::ReadFrame(const size_t connection) {
+    if (_done || (connection != _connection_count)) {
+      return;
+    }
+    auto self = shared_from_this();
+    auto header = std::make_shared<multiplexed::FrameHeader>();
+
+    auto handle_read_header = [this, self, header, connection](
+        boost::system::error_code ec,
+        size_t) {
+      if (_done || (connection != _connection_count)) {
+        return;
+      }
+      if (ec) {
+        if (_mode != Mode::Negotiating) {
+          log_debug("streaming client: failed to read header:", ec.message());
+          Connect();
+        } else if (ec != boost::asio::error::eof) {
+          log_debug("streaming client: failed to read handshake:", ec.message());
+          Reconnect();
+        } else if (++_refused_handshakes >= multiplexed::MAX_REFUSED_HANDSHAKES) {
+          // The server keeps closing the connection instead of accepting the
+          // session, as servers without multiplexing do.
+          FallBack();
+        } else {
+          log_debug("streaming client: handshake closed by", _endpoint, ", retrying");
+          Reconnect();
+        }
+        return;
+      }
+
+      if (_mode == Mode::Negotiating) {
+        if ((header->stream_id != multiplexed::HANDSHAKE_STREAM_ID) ||
+            (header->size < multiplexed::PROTOCOL_VERSION)) {
+          FallBack();
+          return;
+        }
+        log_debug("streaming client: multiplexed session accepted by", _endpoint);
+        _mode = Mode::Multiplexed;
+        _refused_handshakes = 0u;
+        std::vector<stream_id_type> stream_ids;
+        {
+          std::lock_guard<std::mutex> lock(_mutex);
+          for (auto &subscription : _subscriptions) {
+            subscription.second->consumed = 0u;
+            stream_ids.emplace_back(subscription.first);
+          }
+        }
+        for (auto stream_id : stream_ids) {
+          SendControlMessage(multiplexed::Command::Subscribe, stream_id, multiplexed::DEFAULT_WINDOW);
+        }
+        ReadFrame(connection);
+        return;
+      }
+
+      if (header->size == 0u) {
+        log_debug("streaming client: received empty frame");
+        Connect();
+        return;
+      }
+
+      std::shared_ptr<Subscription> subscription;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _subscriptions.find(header->stream_id);
+        if (it != _subscriptions.end()) {
+          subscription = it->second;
+        }
+      }
+
+      // Now that we know the size of the coming buffer, we can allocate our
+      // buffer and start putting data into it.
+      // The memory is reused from the buffers freed by any client.
+      auto message = std::make_shared<Buffer>();
+      message->reset(header->size);
+      auto handle_read_data = [this, self, header, message, subscription, connection](
+          boost::system::error_code ec2,
+          size_t) {
+        if (_done || (connection != _connection_count)) {
+          return;
+        }
+        if (ec2) {
+          log_debug("streaming client: failed to read data:", ec2.message());
+          Connect();
+          return;
+        }
+        // Messages of streams unsubscribed meanwhile are dropped.
+        if (subscription != nullptr) {
+          subscription->callback(std::move(*message));
+          // Return the credit in batches to save control messages.
+          if (++subscription->consumed >= (multiplexed::DEFAULT_WINDOW + 1u) / 2u) {
+            SendControlMessage(
+                multiplexed::Command::Credit,
+                header->stream_id,
+                subscription->consumed);
+            subscription->consumed = 0u;
+          }
+        }
+        ReadFrame(connection);
+      };
+
+      boost::asio::async_read(
+          _socket,
+          message->buffer(),
+          boost::asio::bind_executor(_strand, handle_read_data));
+    };
+
+    boost::asio::async_read(
+        _socket,
+        boost::asio::buffer(header.get(), sizeof(multiplexed::FrameHeader)),
+        boost::asio::bind_executor(_strand, handle_read_header));
+  }
+
+  void MultiplexedClient::SendControlMessage(
+      multiplexed::Command command,
+      stream_id_type stream_id,
+      uint32_t value) {
+    _control_queue.push_back(multiplexed::ControlMessage{command, stream_id, value});
+    WriteControlMessages();
+  }
+
+  void MultiplexedClient::WriteControlMessages() {
+    if (_is_writing_control || _control_queue.empty()) {
+      return;
+    }
+    _is_writing_control = true;
+    auto self = shared_from_this();
+    const size_t connection = _connection_count;
+    boost::asio::async_write(
+        _socket,
+        boost::asio::buffer(&_control_queue.front(), sizeof(multiplexed::ControlMessage)),
+        boost::asio::bind_executor(_strand, [this, self, connection](
+            boost::system::error_code ec,
+            size_t) {
+          if (_done || (connection != _connection_count)) {
+            return;
+          }
+          _is_writing_control = false;
+          if (ec) {
+            // The reading side notices the broken connection and reconnects.
+            log_debug("streaming client: failed to send control message:", ec.message());
+            return;
+          }
+          _control_queue.pop_front();
+          WriteControlMessages();
+        }));
+  }
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,134 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Buffer.h"
+#include "carla/NonCopyable.h"
+#include "carla/profiler/LifetimeProfiled.h"
+#include "carla/streaming/detail/Token.h"
+#include "carla/streaming/detail/Types.h"
+#include "carla/streaming/detail/tcp/Client.h"
+#include "carla/streaming/detail/tcp/MultiplexedProtocol.h"
+
+#include <boost/asio/deadline_timer.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/strand.hpp>
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+
+  /// A client that receives any number of streams of the same server through
+  /// a single connection. See MultiplexedProtocol.h.
+  ///
+  /// If the server does not support multiplexing, the client falls back to a
+  /// regular Client, i.e. one connection, per stream. Transient I/O errors
+  /// while negotiating only retry the negotiation.
+  ///
+  /// @warning This client should be stopped before releasing the shared pointer
+  /// or won't be destroyed.
+  class MultiplexedClient
+    : public std::enable_shared_from_this<MultiplexedClient>,
+      private profiler::LifetimeProfiled,
+      private NonCopyable {
+  public:
+
+    using endpoint = boost::asio::ip::tcp::endpoint;
+    using protocol_type = endpoint::protocol_type;
+    using callback_function_type = std::function<void (Buffer)>;
+
+    MultiplexedClient(boost::asio::io_context &io_context, endpoint ep);
+
+    ~MultiplexedClient();
+
+    /// Subscribe to the stream of @a token, which must belong to the server
+    /// this client connects to.
+    void Subscribe(const token_type &token, callback_function_type callback);
+
+    void UnSubscribe(stream_id_type stream_id);
+
+    void Connect();
+
+    void Stop();
+
+    /// Whether the server accepted a multiplexed session. False while
+    /// connecting and after falling back to a connection per stream.
+    bool IsMultiplexed() const {
+      return _mode == Mode::Multiplexed;
+    }
+
+  private:
+
+    enum class Mode {
+      Negotiating,
+      Multiplexed,
+      Fallback
+    };
+
+    struct Subscription {
+      token_type token;
+      callback_function_type callback;
+      /// Messages received since credit was last granted.
+      uint32_t consumed = 0u;
+      /// Connection used after falling back to a connection per stream.
+      std::shared_ptr<Client> fallback_client;
+    };
+
+    void Reconnect();
+
+    void FallBack();
+
+    void ReadFrame(size_t connection);
+
+    void SendControlMessage(multiplexed::Command command, stream_id_type stream_id, uint32_t value);
+
+    void WriteControlMessages();
+
+    boost::asio::io_context &_io_context;
+
+    const endpoint _endpoint;
+
+    boost::asio::ip::tcp::socket _socket;
+
+    boost::asio::io_context::strand _strand;
+
+    boost::asio::deadline_timer _connection_timer;
+
+    std::mutex _mutex;
+
+    std::unordered_map<stream_id_type, std::shared_ptr<Subscription>> _subscriptions;
+
+    std::atomic<Mode> _mode{Mode::Negotiating};
+
+    /// Number of connections attempted, only accessed from the strand.
+    size_t _connection_count = 0u;
+
+    /// Consecutive handshakes closed by the server, only accessed from the
+    /// strand.
+    size_t _refused_handshakes = 0u;
+
+    /// Control messages waiting to be written, only accessed from the strand.
+    std::deque<multiplexed::ControlMessage> _control_queue;
+
+    bool _is_writing_control = false;
+
+    std::atomic_bool _done{false};
+  };
+
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -0,0 +1,85 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/streaming/detail/Types.h"
+
+#include <cstdint>
+#include <limits>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace tcp {
+namespace multiplexed {
+
+  // ===========================================================================
+  // -- Multiplexed protocol ---------------------------------------------------
+  // ===========================================================================
+  //
+  // A regular client sends a stream id right after connecting and receives the
+  // messages of that stream only. A multiplexing client sends
+  // HANDSHAKE_STREAM_ID instead. A server supporting multiplexing replies with
+  // a frame header containing HANDSHAKE_STREAM_ID and PROTOCOL_VERSION. Older
+  // servers close the connection in an orderly way, which the client takes as
+  // a refusal; after MAX_REFUSED_HANDSHAKES consecutive refusals, or on a reply
+  // with a different stream id or an older version, the client falls back to a
+  // connection per stream. Any other I/O error during the handshake is treated
+  // as transient and the negotiation is retried.
+  //
+  // After the handshake the client sends ControlMessages to subscribe and
+  // unsubscribe to streams and to grant credit, and the server sends frames
+  // made of a FrameHeader followed by the message. The server sends a message
+  // of a stream only if the client granted credit for it, so a slow stream
+  // cannot hold back the others.
+
+  /// Stream id sent to request a multiplexed session. Never assigned to a
+  /// stream.
+  constexpr stream_id_type HANDSHAKE_STREAM_ID = std::numeric_limits<stream_id_type>::max();
+
+  constexpr uint32_t PROTOCOL_VERSION = 1u;
+
+  /// Consecutive handshakes closed by the server before the client gives up on
+  /// multiplexing.
+  constexpr size_t MAX_REFUSED_HANDSHAKES = 3u;
+
+  /// Credit, in messages, granted to every stream on subscription.
+  constexpr uint32_t DEFAULT_WINDOW = 4u;
+
+  /// Maximum number of frames gathered in a single socket write.
+  constexpr size_t MAX_FRAMES_PER_WRITE = 16u;
+
+  enum class Command : uint32_t {
+    Subscribe = 1u,
+    Unsubscribe = 2u,
+    Credit = 3u
+  };
+
+#pragma pack(push, 1)
+
+  struct ControlMessage {
+    Command command;
+    stream_id_type stream_id;
+    /// Credit granted, in messages. Unused for Unsubscribe.
+    uint32_t value;
+  };
+
+  struct FrameHeader {
+    stream_id_type stream_id;
+    message_size_type size;
+  };
+
+#pragma pack(pop)
+
+  static_assert(sizeof(ControlMessage) == 12u, "Invalid control message size.");
+  static_assert(sizeof(FrameHeader) == 8u, "Invalid frame header size.");
+
+} // namespace multiplexed
+} // namespace tcp
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -26,14 +26,15 @@ namespace tcp {
   void Server::OpenSession(
       time_duration timeout,
       ServerSession::callback_function_type on_opened,
-      ServerSession::callback_function_type on_closed) {
+      ServerSession::callback_function_type on_closed,
+      ServerSession::subscription_callback_type on_subscription) {
     using boost::system::error_code;
 
     auto session = std::make_shared<ServerSession>(_io_context, timeout, *this);
 
-    auto handle_query = [on_opened, on_closed, session](const error_code &ec) {
+    auto handle_query = [on_opened, on_closed, on_subscription, session](const error_code &ec) {
       if (!ec) {
-        session->Open(std::move(on_opened), std::move(on_closed));
+        session->Open(std::move(on_opened), std::move(on_closed), std::move(on_subscription));
       } else {
         log_error("tcp accept stream error:", ec.message());
       }
@@ -42,7 +43,7 @@ namespace tcp {
     _acceptor.async_accept(session->_socket, [=](error_code ec) {
       // Handle query and open a new session immediately.
       boost::asio::post(_io_context, [=]() { handle_query(ec); });
-      OpenSession(timeout, on_opened, on_closed);
+      OpenSession(timeout, on_opened, on_closed, on_subscription);
     });
   }
 
@@ -14,6 +14,7 @@
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/post.hpp>
 
+#include <algorithm>
 #include <atomic>
 
 namespace carla {
@@ -43,17 +44,32 @@ namespace tcp {
 
     /// Start listening for connections. On each new connection, @a
     /// on_session_opened is called, and @a on_session_closed when the session
-    /// is closed.
-    template <typename FunctorT1, typename FunctorT2>
-    void Listen(FunctorT1 on_session_opened, FunctorT2 on_session_closed) {
+    /// is closed. Multiplexed sessions call @a on_stream_subscription each
+    /// time they subscribe to or unsubscribe from a stream.
+    template <typename FunctorT1, typename FunctorT2, typename FunctorT3>
+    void Listen(
+        FunctorT1 on_session_opened,
+        FunctorT2 on_session_closed,
+        FunctorT3 on_stream_subscription) {
       boost::asio::post(_io_context, [=]() {
         OpenSession(
             _timeout,
             std::move(on_session_opened),
-            std::move(on_session_closed));
+            std::move(on_session_closed),
+            std::move(on_stream_subscription));
       });
     }
 
+    /// Start listening for connections. Multiplexed sessions are accepted but
+    /// cannot subscribe to any stream.
+    template <typename FunctorT1, typename FunctorT2>
+    void Listen(FunctorT1 on_session_opened, FunctorT2 on_session_closed) {
+      Listen(
+          std::move(on_session_opened),
+          std::move(on_session_closed),
+          [](std::shared_ptr<ServerSession>, stream_id_type, bool) { return false; });
+    }
+
     void SetSynchronousMode(bool is_synchro) {
       _synchronous = is_synchro;
     }
@@ -62,12 +78,37 @@ namespace tcp {
       return _synchronous;
     }
 
+    /// Set how many messages of each stream a session queues while the client
+    /// is receiving previous ones. Beyond that, the drop policy applies.
+    void SetSendQueueSize(size_t size) {
+      _send_queue_size = std::max<size_t>(size, 1u);
+    }
+
+    size_t GetSendQueueSize() const {
+      return _send_queue_size;
+    }
+
+    void SetDropPolicy(DropPolicy policy) {
+      _drop_policy = policy;
+    }
+
+    /// Drop policy in effect, DropPolicy::Default is resolved according to
+    /// the synchronous mode.
+    DropPolicy GetDropPolicy() const {
+      const DropPolicy policy = _drop_policy;
+      if (policy != DropPolicy::Default) {
+        return policy;
+      }
+      return IsSynchronousMode() ? DropPolicy::Block : DropPolicy::DropNewest;
+    }
+
   private:
 
     void OpenSession(
         time_duration timeout,
         ServerSession::callback_function_type on_session_opened,
-        ServerSession::callback_function_type on_session_closed);
+        ServerSession::callback_function_type on_session_closed,
+        ServerSession::subscription_callback_type on_stream_subscription);
 
     boost::asio::io_context &_io_context;
 
@@ -76,6 +117,10 @@ namespace tcp {
     std::atomic<time_duration> _timeout;
 
     bool _synchronous;
+
+    std::atomic_size_t _send_queue_size{1u};
+
+    std::atomic<DropPolicy> _drop_policy{DropPolicy::Default};
   };
 
 } // namespace tcp
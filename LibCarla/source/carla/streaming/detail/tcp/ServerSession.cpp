@@ -15,8 +15,8 @@
 #include <boost/asio/bind_executor.hpp>
 #include <boost/asio/post.hpp>
 
+#include <algorithm>
 #include <atomic>
-#include <thread>
 
 namespace carla {
 namespace streaming {
@@ -40,9 +40,11 @@ namespace tcp {
 
   void ServerSession::Open(
       callback_function_type on_opened,
-      callback_function_type on_closed) {
-    DEBUG_ASSERT(on_opened && on_closed);
+      callback_function_type on_closed,
+      subscription_callback_type on_subscription) {
+    DEBUG_ASSERT(on_opened && on_closed && on_subscription);
     _on_closed = std::move(on_closed);
+    _on_subscription = std::move(on_subscription);
 
     // This forces not using Nagle's algorithm.
     // Improves the sync mode velocity on Linux by a factor of ~3.
@@ -58,6 +60,10 @@ namespace tcp {
           size_t DEBUG_ONLY(bytes_received)) {
         if (!ec) {
           DEBUG_ASSERT_EQ(bytes_received, sizeof(_stream_id));
+          if (_stream_id == multiplexed::HANDSHAKE_STREAM_ID) {
+            StartMultiplexing();
+            return;
+          }
           log_debug("session", _session_id, "for stream", _stream_id, " started");
           boost::asio::post(_strand.context(), [=]() { callback(self); });
         } else {
@@ -78,46 +84,131 @@ namespace tcp {
   void ServerSession::Write(std::shared_ptr<const Message> message) {
     DEBUG_ASSERT(message != nullptr);
     DEBUG_ASSERT(!message->empty());
-    auto self = shared_from_this();
-      if (!_socket.is_open()) {
+    {
+      std::unique_lock<std::mutex> lock(_queue_mutex);
+      auto get_queue = [this]() -> MessageQueue * {
+        return _is_closed ? nullptr : &_send_queue;
+      };
+      if (!PushMessage(lock, get_queue, std::move(message)) || _is_writing) {
+        // Otherwise the message is picked up once the ongoing write completes.
         return;
       }
-      if (_is_writing) {
-        if (_server.IsSynchronousMode()) {
-          // wait until previous message has been sent
-          while (_is_writing) {
-            std::this_thread::yield();
-          }
-        } else {
-          // ignore this message
-          log_debug("session", _session_id, ": connection too slow: message discarded");
-          return;
-        }
-      }
       _is_writing = true;
+    }
+    boost::asio::post(_strand, [self=shared_from_this()]() { self->WriteNextMessage(); });
+  }
 
-      auto handle_sent = [this, self, message](const boost::system::error_code &ec, size_t DEBUG_ONLY(bytes)) {
+  void ServerSession::WriteNextMessage() {
+    std::shared_ptr<const Message> message;
+    {
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      if (_is_closed || _send_queue.empty()) {
         _is_writing = false;
-        if (ec) {
-          log_info("session", _session_id, ": error sending data :", ec.message());
-          CloseNow(ec);
-        } else {
-          DEBUG_ONLY(log_debug("session", _session_id, ": successfully sent", bytes, "bytes"));
-          DEBUG_ASSERT_EQ(bytes, sizeof(message_size_type) + message->size());
-        }
-      };
+        return;
+      }
+      message = std::move(_send_queue.front());
+      _send_queue.pop_front();
+    }
+    _queue_condition.notify_all();
+
+    auto self = shared_from_this();
+    auto handle_sent = [this, self, message](const boost::system::error_code &ec, size_t DEBUG_ONLY(bytes)) {
+      if (ec) {
+        log_info("session", _session_id, ": error sending data :", ec.message());
+        CloseNow(ec);
+      } else {
+        DEBUG_ONLY(log_debug("session", _session_id, ": successfully sent", bytes, "bytes"));
+        DEBUG_ASSERT_EQ(bytes, sizeof(message_size_type) + message->size());
+        WriteNextMessage();
+      }
+    };
 
-      log_debug("session", _session_id, ": sending message of", message->size(), "bytes");
+    log_debug("session", _session_id, ": sending message of", message->size(), "bytes");
 
-      _deadline.expires_from_now(_timeout);
-      boost::asio::async_write(_socket, message->GetBufferSequence(), 
+    _deadline.expires_from_now(_timeout);
+    boost::asio::async_write(
+        _socket,
+        message->GetBufferSequence(),
         boost::asio::bind_executor(_strand, handle_sent));
   }
 
+  void ServerSession::Write(stream_id_type stream_id, std::shared_ptr<const Message> message) {
+    if (!_is_multiplexed) {
+      Write(std::move(message));
+      return;
+    }
+    DEBUG_ASSERT(message != nullptr);
+    DEBUG_ASSERT(!message->empty());
+    bool start_writing = false;
+    {
+      std::unique_lock<std::mutex> lock(_queue_mutex);
+      auto get_queue = [this, stream_id]() -> MessageQueue * {
+        auto channel = _channels.find(stream_id);
+        return (channel != _channels.end()) ? &channel->second.pending : nullptr;
+      };
+      if (!PushMessage(lock, get_queue, std::move(message))) {
+        return;
+      }
+      MarkChannelReady(stream_id, _channels.at(stream_id));
+      start_writing = !_is_writing_frames && !_ready_channels.empty();
+    }
+    // Otherwise the frame is picked up once the ongoing write completes.
+    if (start_writing) {
+      boost::asio::post(_strand, [self=shared_from_this()]() { self->WritePendingFrames(); });
+    }
+  }
+
+  template <typename GetQueueT>
+  bool ServerSession::PushMessage(
+      std::unique_lock<std::mutex> &lock,
+      GetQueueT get_queue,
+      std::shared_ptr<const Message> message) {
+    MessageQueue *queue = get_queue();
+    if (queue == nullptr) {
+      return false;
+    }
+    if (queue->size() >= _server.GetSendQueueSize()) {
+      switch (_server.GetDropPolicy()) {
+        case DropPolicy::DropOldest:
+          while (queue->size() >= _server.GetSendQueueSize()) {
+            queue->pop_front();
+            ++_dropped_messages;
+          }
+          log_debug("session", _session_id, ": connection too slow: oldest message discarded");
+          break;
+        case DropPolicy::Block:
+          // Wait until the client catches up or the queue is removed.
+          _queue_condition.wait(lock, [&]() {
+            queue = get_queue();
+            return (queue == nullptr) || (queue->size() < _server.GetSendQueueSize());
+          });
+          if (queue == nullptr) {
+            return false;
+          }
+          break;
+        default:
+          ++_dropped_messages;
+          log_debug("session", _session_id, ": connection too slow: message discarded");
+          return false;
+      }
+    }
+    queue->emplace_back(std::move(message));
+    return true;
+  }
+
   void ServerSession::Close() {
     boost::asio::post(_strand, [self=shared_from_this()]() { self->CloseNow(); });
   }
 
+  void ServerSession::CloseStream(stream_id_type stream_id) {
+    if (!_is_multiplexed) {
+      Close();
+      return;
+    }
+    log_debug("session", _session_id, ": closing stream", stream_id);
+    EraseChannel(stream_id);
+  }
+
   void ServerSession::StartTimer() {
     if (_deadline.expires_at() <= boost::asio::deadline_timer::traits_type::now()) {
       log_debug("session", _session_id, "timed out");
@@ -135,6 +226,22 @@ namespace tcp {
 
   void ServerSession::CloseNow(boost::system::error_code ec) {
     _deadline.cancel();
+    // Unsubscribe from every stream, only once even if closed repeatedly.
+    std::vector<stream_id_type> stream_ids;
+    {
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      _is_closed = true;
+      _send_queue.clear();
+      for (const auto &channel : _channels) {
+        stream_ids.emplace_back(channel.first);
+      }
+      _channels.clear();
+      _ready_channels.clear();
+    }
+    _queue_condition.notify_all();
+    for (auto stream_id : stream_ids) {
+      _on_subscription(shared_from_this(), stream_id, false);
+    }
     if (!ec)
     {
       if (_socket.is_open()) {
@@ -144,7 +251,187 @@ namespace tcp {
       }
     }
     _on_closed(shared_from_this());
-    log_debug("session", _session_id, "closed");
+    log_debug("session", _session_id, "closed,", _dropped_messages, "messages discarded");
+  }
+
+  // ===========================================================================
+  // -- Multiplexed session ----------------------------------------------------
+  // ===========================================================================
+
+  void ServerSession::StartMultiplexing() {
+    _is_multiplexed = true;
+    log_debug("session", _session_id, ": multiplexed session started");
+    auto self = shared_from_this();
+    auto handshake = std::make_shared<multiplexed::FrameHeader>();
+    handshake->stream_id = multiplexed::HANDSHAKE_STREAM_ID;
+    handshake->size = multiplexed::PROTOCOL_VERSION;
+    _deadline.expires_from_now(_timeout);
+    boost::asio::async_write(
+        _socket,
+        boost::asio::buffer(handshake.get(), sizeof(multiplexed::FrameHeader)),
+        boost::asio::bind_executor(_strand, [this, self, handshake](
+            const boost::system::error_code &ec,
+            size_t) {
+          if (ec) {
+            log_info("session", _session_id, ": error sending handshake :", ec.message());
+            CloseNow(ec);
+          } else {
+            ReadControlMessage();
+          }
+        }));
+  }
+
+  void ServerSession::ReadControlMessage() {
+    auto self = shared_from_this();
+    boost::asio::async_read(
+        _socket,
+        boost::asio::buffer(&_control, sizeof(_control)),
+        boost::asio::bind_executor(_strand, [this, self](
+            const boost::system::error_code &ec,
+            size_t DEBUG_ONLY(bytes)) {
+          if (ec) {
+            log_debug("session", _session_id, ": error reading control message :", ec.message());
+            CloseNow(ec);
+            return;
+          }
+          DEBUG_ASSERT_EQ(bytes, sizeof(_control));
+          _deadline.expires_from_now(_timeout);
+          HandleControlMessage(_control);
+          ReadControlMessage();
+        }));
+  }
+
+  void ServerSession::HandleControlMessage(const multiplexed::ControlMessage &control) {
+    const stream_id_type stream_id = control.stream_id;
+    switch (control.command) {
+      case multiplexed::Command::Subscribe: {
+        bool is_new_channel = false;
+        {
+          std::lock_guard<std::mutex> lock(_queue_mutex);
+          is_new_channel = (_channels.find(stream_id) == _channels.end());
+          auto &channel = _channels[stream_id];
+          channel.credits = control.value;
+          MarkChannelReady(stream_id, channel);
+        }
+        WritePendingFrames();
+        if (is_new_channel) {
+          log_debug("session", _session_id, ": subscribing to stream", stream_id);
+          if (!_on_subscription(shared_from_this(), stream_id, true)) {
+            EraseChannel(stream_id);
+          }
+        }
+        break;
+      }
+      case multiplexed::Command::Unsubscribe:
+        log_debug("session", _session_id, ": unsubscribing from stream", stream_id);
+        if (EraseChannel(stream_id)) {
+          _on_subscription(shared_from_this(), stream_id, false);
+        }
+        break;
+      case multiplexed::Command::Credit: {
+        {
+          std::lock_guard<std::mutex> lock(_queue_mutex);
+          auto channel = _channels.find(stream_id);
+          if (channel != _channels.end()) {
+            channel->second.credits += control.value;
+            MarkChannelReady(stream_id, channel->second);
+          }
+        }
+        WritePendingFrames();
+        break;
+      }
+      default:
+        log_error("session", _session_id, ": invalid control message");
+        break;
+    }
+  }
+
+  bool ServerSession::EraseChannel(stream_id_type stream_id) {
+    bool erased = false;
+    {
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      erased = (_channels.erase(stream_id) > 0u);
+      _ready_channels.erase(
+          std::remove(_ready_channels.begin(), _ready_channels.end(), stream_id),
+          _ready_channels.end());
+    }
+    _queue_condition.notify_all();
+    return erased;
+  }
+
+  void ServerSession::MarkChannelReady(stream_id_type stream_id, Channel &channel) {
+    if (!channel.is_ready && (channel.credits > 0u) && !channel.pending.empty()) {
+      channel.is_ready = true;
+      _ready_channels.push_back(stream_id);
+    }
+  }
+
+  void ServerSession::WritePendingFrames() {
+    struct Batch {
+      std::vector<stream_id_type> stream_ids;
+      std::vector<std::shared_ptr<const Message>> messages;
+      std::vector<boost::asio::const_buffer> buffers;
+    };
+    auto batch = std::make_shared<Batch>();
+    {
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      if (_is_writing_frames || !_socket.is_open()) {
+        return;
+      }
+      // Take one message of each ready channel in turn, so every stream gets
+      // its share of the connection.
+      batch->stream_ids.reserve(multiplexed::MAX_FRAMES_PER_WRITE);
+      batch->messages.reserve(multiplexed::MAX_FRAMES_PER_WRITE);
+      while (!_ready_channels.empty() &&
+             (batch->messages.size() < multiplexed::MAX_FRAMES_PER_WRITE)) {
+        const stream_id_type stream_id = _ready_channels.front();
+        _ready_channels.pop_front();
+        auto &channel = _channels.at(stream_id);
+        DEBUG_ASSERT(!channel.pending.empty());
+        DEBUG_ASSERT(channel.credits > 0u);
+        channel.is_ready = false;
+        batch->stream_ids.emplace_back(stream_id);
+        batch->messages.emplace_back(std::move(channel.pending.front()));
+        channel.pending.pop_front();
+        --channel.credits;
+        MarkChannelReady(stream_id, channel);
+      }
+      if (batch->messages.empty()) {
+        return;
+      }
+      _is_writing_frames = true;
+    }
+    _queue_condition.notify_all();
+
+    // Each frame is the stream id followed by the message, which begins with
+    // its size.
+    for (auto i = 0u; i < batch->messages.size(); ++i) {
+      batch->buffers.emplace_back(boost::asio::buffer(&batch->stream_ids[i], sizeof(stream_id_type)));
+      for (const auto &buffer : batch->messages[i]->GetBufferSequence()) {
+        batch->buffers.emplace_back(buffer);
+      }
+    }
+
+    auto self = shared_from_this();
+    _deadline.expires_from_now(_timeout);
+    boost::asio::async_write(
+        _socket,
+        batch->buffers,
+        boost::asio::bind_executor(_strand, [this, self, batch](
+            const boost::system::error_code &ec,
+            size_t DEBUG_ONLY(bytes)) {
+          {
+            std::lock_guard<std::mutex> lock(_queue_mutex);
+            _is_writing_frames = false;
+          }
+          if (ec) {
+            log_info("session", _session_id, ": error sending data :", ec.message());
+            CloseNow(ec);
+          } else {
+            DEBUG_ONLY(log_debug("session", _session_id, ": successfully sent", bytes, "bytes"));
+            WritePendingFrames();
+          }
+        }));
   }
 
 } // namespace tcp
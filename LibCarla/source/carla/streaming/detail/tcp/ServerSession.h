@@ -12,6 +12,7 @@
 #include "carla/profiler/LifetimeProfiled.h"
 #include "carla/streaming/detail/Types.h"
 #include "carla/streaming/detail/tcp/Message.h"
+#include "carla/streaming/detail/tcp/MultiplexedProtocol.h"
 
 #if defined(__clang__)
 #  pragma clang diagnostic push
@@ -25,8 +26,14 @@
 #  pragma clang diagnostic pop
 #endif
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace carla {
 namespace streaming {
@@ -38,6 +45,15 @@ namespace tcp {
   /// A TCP server session. When a session opens, it reads from the socket a
   /// stream id object and passes itself to the callback functor. The session
   /// closes itself after @a timeout of inactivity is met.
+  ///
+  /// If the client requests a multiplexed session instead, the session carries
+  /// any number of streams. The client subscribes to streams through control
+  /// messages, and each subscription is passed to the subscription callback.
+  /// See MultiplexedProtocol.h.
+  ///
+  /// Messages wait in a queue per stream until the socket, and in multiplexed
+  /// sessions the client credit, allows sending them. When a queue is full the
+  /// drop policy of the server applies, so a slow client only affects itself.
   class ServerSession
     : public std::enable_shared_from_this<ServerSession>,
       private profiler::LifetimeProfiled,
@@ -46,6 +62,9 @@ namespace tcp {
 
     using socket_type = boost::asio::ip::tcp::socket;
     using callback_function_type = std::function<void(std::shared_ptr<ServerSession>)>;
+    /// Called with true when a multiplexed session subscribes to a stream and
+    /// with false when it unsubscribes. Returns whether the stream exists.
+    using subscription_callback_type = std::function<bool(std::shared_ptr<ServerSession>, stream_id_type, bool)>;
 
     explicit ServerSession(
         boost::asio::io_context &io_context,
@@ -53,10 +72,12 @@ namespace tcp {
         Server &server);
 
     /// Starts the session and calls @a on_opened after successfully reading the
-    /// stream id, and @a on_closed once the session is closed.
+    /// stream id, and @a on_closed once the session is closed. Multiplexed
+    /// sessions call @a on_subscription instead of @a on_opened.
     void Open(
         callback_function_type on_opened,
-        callback_function_type on_closed);
+        callback_function_type on_closed,
+        subscription_callback_type on_subscription);
 
     /// @warning This function should only be called after the session is
     /// opened. It is safe to call this function from within the @a callback.
@@ -64,6 +85,12 @@ namespace tcp {
       return _stream_id;
     }
 
+    /// @warning This function should only be called after the session is
+    /// opened.
+    bool IsMultiplexed() const {
+      return _is_multiplexed;
+    }
+
     template <typename... Buffers>
     static auto MakeMessage(Buffers... buffers) {
       static_assert(
@@ -75,6 +102,10 @@ namespace tcp {
     /// Writes some data to the socket.
     void Write(std::shared_ptr<const Message> message);
 
+    /// Writes some data of stream @a stream_id to the socket. Multiplexed
+    /// sessions tag the message with the stream id, others ignore it.
+    void Write(stream_id_type stream_id, std::shared_ptr<const Message> message);
+
     /// Writes some data to the socket.
     template <typename... Buffers>
     void Write(Buffers... buffers) {
@@ -84,12 +115,57 @@ namespace tcp {
     /// Post a job to close the session.
     void Close();
 
+    /// Stop sending stream @a stream_id through this session. Closes the
+    /// session unless it is multiplexed.
+    void CloseStream(stream_id_type stream_id);
+
+    /// Number of messages discarded so far because the client could not keep
+    /// up with them.
+    size_t GetDroppedMessageCount() const {
+      return _dropped_messages;
+    }
+
   private:
 
+    using MessageQueue = std::deque<std::shared_ptr<const Message>>;
+
+    /// A stream of a multiplexed session.
+    struct Channel {
+      /// Number of messages the client is willing to receive.
+      uint32_t credits = 0u;
+      MessageQueue pending;
+      /// Whether the channel is in _ready_channels.
+      bool is_ready = false;
+    };
+
+    /// Queue @a message in the queue returned by @a get_queue, applying the
+    /// drop policy if it is full. @a get_queue returns nullptr once the queue
+    /// no longer exists. Returns whether the message was queued.
+    template <typename GetQueueT>
+    bool PushMessage(
+        std::unique_lock<std::mutex> &lock,
+        GetQueueT get_queue,
+        std::shared_ptr<const Message> message);
+
+    void WriteNextMessage();
+
     void StartTimer();
 
     void CloseNow(boost::system::error_code ec = boost::system::error_code());
 
+    void StartMultiplexing();
+
+    void ReadControlMessage();
+
+    void HandleControlMessage(const multiplexed::ControlMessage &control);
+
+    bool EraseChannel(stream_id_type stream_id);
+
+    /// Add @a channel to the channels served if it has messages and credit.
+    void MarkChannelReady(stream_id_type stream_id, Channel &channel);
+
+    void WritePendingFrames();
+
     friend class Server;
 
     Server &_server;
@@ -108,7 +184,33 @@ namespace tcp {
 
     callback_function_type _on_closed;
 
+    subscription_callback_type _on_subscription;
+
+    bool _is_multiplexed = false;
+
+    multiplexed::ControlMessage _control;
+
+    /// Guards the queues and the channels.
+    std::mutex _queue_mutex;
+
+    /// Notified when a queue has room or is removed.
+    std::condition_variable _queue_condition;
+
+    /// Queue of a session that is not multiplexed.
+    MessageQueue _send_queue;
+
     bool _is_writing = false;
+
+    bool _is_closed = false;
+
+    std::atomic_size_t _dropped_messages{0u};
+
+    std::unordered_map<stream_id_type, Channel> _channels;
+
+    /// Channels with pending messages, in the order they are served.
+    std::deque<stream_id_type> _ready_channels;
+
+    bool _is_writing_frames = false;
   };
 
 } // namespace tcp
@@ -8,9 +8,12 @@
 
 #include "carla/streaming/detail/Token.h"
 #include "carla/streaming/detail/tcp/Client.h"
+#include "carla/streaming/detail/tcp/MultiplexedClient.h"
 
 #include <boost/asio/io_context.hpp>
 
+#include <atomic>
+#include <map>
 #include <memory>
 #include <unordered_map>
 
@@ -21,6 +24,9 @@ namespace low_level {
   /// A client able to subscribe to multiple streams. Accepts an external
   /// io_context.
   ///
+  /// By default every stream uses its own connection. With multiplexing
+  /// enabled, the streams of the same server share a single connection.
+  ///
   /// @warning The client should not be destroyed before the @a io_context is
   /// stopped.
   template <typename T>
@@ -44,6 +50,20 @@ namespace low_level {
       for (auto &pair : _clients) {
         pair.second->Stop();
       }
+      for (auto &pair : _multiplexed_clients) {
+        pair.second->Stop();
+      }
+    }
+
+    /// Whether to receive the streams of the same server through a single
+    /// connection. Applies to streams subscribed afterwards. Servers not
+    /// supporting it are handled with a connection per stream.
+    void SetMultiplexed(bool enabled) {
+      _multiplexed = enabled;
+    }
+
+    bool IsMultiplexed() const {
+      return _multiplexed;
     }
 
     /// @warning cannot subscribe twice to the same stream (even if it's a
@@ -54,9 +74,21 @@ namespace low_level {
         token_type token,
         Functor &&callback) {
       DEBUG_ASSERT_EQ(_clients.find(token.get_stream_id()), _clients.end());
+      DEBUG_ASSERT_EQ(_multiplexed_streams.find(token.get_stream_id()), _multiplexed_streams.end());
       if (!token.has_address()) {
         token.set_address(_fallback_address);
       }
+      if (_multiplexed && token.protocol_is_tcp()) {
+        const auto ep = token.to_tcp_endpoint();
+        auto &client = _multiplexed_clients[ep];
+        if (client == nullptr) {
+          client = std::make_shared<multiplexed_client>(io_context, ep);
+          client->Connect();
+        }
+        client->Subscribe(token, std::forward<Functor>(callback));
+        _multiplexed_streams.emplace(token.get_stream_id(), client);
+        return;
+      }
       auto client = std::make_shared<underlying_client>(
           io_context,
           token,
@@ -72,12 +104,30 @@ namespace low_level {
         it->second->Stop();
         _clients.erase(it);
       }
+      auto multiplexed = _multiplexed_streams.find(token.get_stream_id());
+      if (multiplexed != _multiplexed_streams.end()) {
+        // The connection is kept open for other streams of the same server.
+        multiplexed->second->UnSubscribe(token.get_stream_id());
+        _multiplexed_streams.erase(multiplexed);
+      }
     }
 
   private:
 
+    using multiplexed_client = detail::tcp::MultiplexedClient;
+
     boost::asio::ip::address _fallback_address;
 
+    std::atomic_bool _multiplexed{false};
+
+    std::map<
+        boost::asio::ip::tcp::endpoint,
+        std::shared_ptr<multiplexed_client>> _multiplexed_clients;
+
+    std::unordered_map<
+        detail::stream_id_type,
+        std::shared_ptr<multiplexed_client>> _multiplexed_streams;
+
     std::unordered_map<
         detail::stream_id_type,
         std::shared_ptr<underlying_client>> _clients;
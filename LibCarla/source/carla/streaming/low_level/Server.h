@@ -77,6 +77,14 @@ namespace low_level {
       _server.SetSynchronousMode(is_synchro);
     }
 
+    void SetSendQueueSize(size_t size) {
+      _server.SetSendQueueSize(size);
+    }
+
+    void SetDropPolicy(detail::DropPolicy policy) {
+      _server.SetDropPolicy(policy);
+    }
+
     token_type GetToken(stream_id sensor_id) {
       return _dispatcher.GetToken(sensor_id);
     }
@@ -105,7 +113,14 @@ namespace low_level {
         log_debug("on_session_closed called");
         _dispatcher.DeregisterSession(session);
       };
-      _server.Listen(on_session_opened, on_session_closed);
+      auto on_stream_subscription = [this](auto session, auto stream_id, bool subscribe) {
+        if (subscribe) {
+          return _dispatcher.RegisterSession(session, stream_id);
+        }
+        _dispatcher.DeregisterSession(session, stream_id);
+        return true;
+      };
+      _server.Listen(on_session_opened, on_session_closed, on_stream_subscription);
     }
 
     underlying_server _server;
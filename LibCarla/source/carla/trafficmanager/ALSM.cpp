@@ -46,15 +46,20 @@ void ALSM::Update() {
 
   bool hybrid_physics_mode = parameters.GetHybridPhysicsMode();
 
-  std::set<ActorId> world_vehicle_ids;
-  std::set<ActorId> world_pedestrian_ids;
-  std::vector<ActorId> unregistered_list_to_be_deleted;
-
-  current_timestamp = world.GetSnapshot().GetTimestamp();
-  ActorList world_actors = world.GetActors();
+  // Index the state of every actor in a single pass over the world snapshot,
+  // instead of querying each actor.
+  const cc::WorldSnapshot world_snapshot = world.GetSnapshot();
+  current_timestamp = world_snapshot.GetTimestamp();
+  actor_snapshots.clear();
+  std::vector<ActorId> current_ids;
+  current_ids.reserve(world_snapshot.size());
+  for (const cc::ActorSnapshot &actor_snapshot : world_snapshot) {
+    actor_snapshots.emplace(actor_snapshot.id, &actor_snapshot);
+    current_ids.push_back(actor_snapshot.id);
+  }
 
   // Find destroyed actors and perform clean up.
-  const ALSM::DestroyeddActors destroyed_actors = IdentifyDestroyedActors(world_actors);
+  const ALSM::DestroyeddActors destroyed_actors = IdentifyDestroyedActors();
 
   const ActorIdSet &destroyed_registered = destroyed_actors.first;
   for (const auto &deletion_id: destroyed_registered) {
@@ -83,8 +88,10 @@ void ALSM::Update() {
     }
   }
 
-  // Scan for new unregistered actors.
-  IdentifyNewActors(world_actors);
+  // Scan for new unregistered actors. This is done after the removals, which
+  // forget the actors still alive, e.g. an unregistered hero vehicle that
+  // has just been registered, so that they are identified again right away.
+  IdentifyNewActors(known_actors.IdentifyCreated(current_ids));
 
   // Update dynamic state and static attributes for all registered vehicles.
   ALSM::IdleInfo max_idle_time = std::make_pair(0u, current_timestamp.elapsed_seconds);
@@ -110,46 +117,58 @@ void ALSM::Update() {
 
   // Update dynamic state and static attributes for unregistered actors.
   UpdateUnregisteredActorsData();
+
+  // The snapshot the states point to is released on return.
+  actor_snapshots.clear();
 }
 
-void ALSM::IdentifyNewActors(const ActorList &actor_list) {
-  for (auto iter = actor_list->begin(); iter != actor_list->end(); ++iter) {
+void ALSM::IdentifyNewActors(const std::vector<ActorId> &created_ids) {
+  if (created_ids.empty()) {
+    return;
+  }
+  ActorList created_actors = world.GetActors(created_ids);
+  for (auto iter = created_actors->begin(); iter != created_actors->end(); ++iter) {
     ActorPtr actor = *iter;
     ActorId actor_id = actor->GetId();
-    // Identify any new hero vehicle
-    if (actor->GetTypeId().front() == 'v') {
-     if (hero_actors.size() == 0u || hero_actors.find(actor_id) == hero_actors.end()) {
-      for (auto&& attribute: actor->GetAttributes()) {
-        if (attribute.GetId() == "role_name" && attribute.GetValue() == "hero") {
-          hero_actors.insert({actor_id, actor});
+    const std::string &type_id = actor->GetTypeId();
+    ActorType actor_type = ActorType::Any;
+    if (type_id.front() == 'v') {
+      actor_type = ActorType::Vehicle;
+      // Identify any new hero vehicle
+      if (hero_actors.find(actor_id) == hero_actors.end()) {
+        for (auto&& attribute: actor->GetAttributes()) {
+          if (attribute.GetId() == "role_name" && attribute.GetValue() == "hero") {
+            hero_actors.insert({actor_id, actor});
+          }
         }
       }
+    } else if (type_id.front() == 'w') {
+      actor_type = ActorType::Pedestrian;
     }
-  }
-    if (!registered_vehicles.Contains(actor_id)
+    if (actor_type != ActorType::Any
+        && !registered_vehicles.Contains(actor_id)
         && unregistered_actors.find(actor_id) == unregistered_actors.end()) {
 
-      unregistered_actors.insert({actor_id, actor});
+      unregistered_actors.insert({actor_id, {actor_type, actor->GetBoundingBox().extent}});
     }
   }
 }
 
-ALSM::DestroyeddActors ALSM::IdentifyDestroyedActors(const ActorList &actor_list) {
+ALSM::DestroyeddActors ALSM::IdentifyDestroyedActors() {
 
   ALSM::DestroyeddActors destroyed_actors;
   ActorIdSet &deleted_registered = destroyed_actors.first;
   ActorIdSet &deleted_unregistered = destroyed_actors.second;
 
-  // Building hash set of actors present in current frame.
-  ActorIdSet current_actors;
-  for  (auto iter = actor_list->begin(); iter != actor_list->end(); ++iter) {
-    current_actors.insert((*iter)->GetId());
-  }
+  // Forgetting actors no longer present in current frame.
+  known_actors.ForgetDestroyed([this](const ActorId actor_id) {
+    return actor_snapshots.find(actor_id) != actor_snapshots.end();
+  });
 
   // Searching for destroyed registered actors.
   std::vector<ActorId> registered_ids = registered_vehicles.GetIDList();
   for (const ActorId &actor_id : registered_ids) {
-    if (current_actors.find(actor_id) == current_actors.end()) {
+    if (actor_snapshots.find(actor_id) == actor_snapshots.end()) {
       deleted_registered.insert(actor_id);
     }
   }
@@ -157,7 +176,7 @@ ALSM::DestroyeddActors ALSM::IdentifyDestroyedActors(const ActorList &actor_list
   // Searching for destroyed unregistered actors.
   for (const auto &actor_info: unregistered_actors) {
     const ActorId &actor_id = actor_info.first;
-     if (current_actors.find(actor_id) == current_actors.end()
+     if (actor_snapshots.find(actor_id) == actor_snapshots.end()
          || registered_vehicles.Contains(actor_id)) {
       deleted_unregistered.insert(actor_id);
     }
@@ -166,6 +185,12 @@ ALSM::DestroyeddActors ALSM::IdentifyDestroyedActors(const ActorList &actor_list
   return destroyed_actors;
 }
 
+const cc::ActorSnapshot &ALSM::GetActorSnapshot(const ActorId actor_id) const {
+  static const cc::ActorSnapshot missing_actor{};
+  const auto it = actor_snapshots.find(actor_id);
+  return it != actor_snapshots.end() ? *it->second : missing_actor;
+}
+
 void ALSM::UpdateRegisteredActorsData(const bool hybrid_physics_mode, ALSM::IdleInfo &max_idle_time) {
 
   std::vector<ActorPtr> vehicle_list = registered_vehicles.GetList();
@@ -179,7 +204,7 @@ void ALSM::UpdateRegisteredActorsData(const bool hybrid_physics_mode, ALSM::Idle
   // Update first the information regarding any hero vehicle.
   for (auto &hero_actor_info: hero_actors){
     if (is_respawn_vehicles) {
-      track_traffic.SetHeroLocation(hero_actor_info.second->GetTransform().location);
+      track_traffic.SetHeroLocation(GetActorSnapshot(hero_actor_info.first).transform.location);
     }
     UpdateData(hybrid_physics_mode, hero_actor_info.second, hero_actor_present, physics_radius_square);
   }
@@ -197,10 +222,10 @@ void ALSM::UpdateData(const bool hybrid_physics_mode, const Actor &vehicle,
                       const bool hero_actor_present, const float physics_radius_square) {
 
   ActorId actor_id = vehicle->GetId();
-  cg::Transform vehicle_transform = vehicle->GetTransform();
-  cg::Location vehicle_location = vehicle_transform.location;
-  cg::Rotation vehicle_rotation = vehicle_transform.rotation;
-  cg::Vector3D vehicle_velocity = vehicle->GetVelocity();
+  const cc::ActorSnapshot &actor_snapshot = GetActorSnapshot(actor_id);
+  cg::Location vehicle_location = actor_snapshot.transform.location;
+  cg::Rotation vehicle_rotation = actor_snapshot.transform.rotation;
+  cg::Vector3D vehicle_velocity = actor_snapshot.velocity;
   bool state_entry_present = simulation_state.ContainsActor(actor_id);
 
   // Initializing idle times.
@@ -245,13 +270,14 @@ void ALSM::UpdateData(const bool hybrid_physics_mode, const Actor &vehicle,
   }
 
   // Updated kinematic state object.
-  auto vehicle_ptr = boost::static_pointer_cast<cc::Vehicle>(vehicle);
+  const auto vehicle_data = actor_snapshot.state.vehicle_data;
+  const bool is_dormant = actor_snapshot.actor_state == rpc::ActorState::Dormant;
   KinematicState kinematic_state{vehicle_location, vehicle_rotation,
-                                  vehicle_velocity, vehicle_ptr->GetSpeedLimit(),
-                                  enable_physics, vehicle->IsDormant(), cg::Location()};
+                                  vehicle_velocity, vehicle_data.speed_limit,
+                                  enable_physics, is_dormant, cg::Location()};
 
   // Updated traffic light state object.
-  TrafficLightState tl_state = {vehicle_ptr->GetTrafficLightState(), vehicle_ptr->IsAtTrafficLight()};
+  TrafficLightState tl_state = {vehicle_data.traffic_light_state, vehicle_data.has_traffic_light};
 
   // Update simulation state.
   if (state_entry_present) {
@@ -259,7 +285,7 @@ void ALSM::UpdateData(const bool hybrid_physics_mode, const Actor &vehicle,
     simulation_state.UpdateTrafficLightState(actor_id, tl_state);
   }
   else {
-    cg::Vector3D dimensions = vehicle_ptr->GetBoundingBox().extent;
+    cg::Vector3D dimensions = vehicle->GetBoundingBox().extent;
     StaticAttributes attributes{ActorType::Vehicle, dimensions.x, dimensions.y, dimensions.z};
 
     simulation_state.AddActor(actor_id, kinematic_state, attributes, tl_state);
@@ -271,31 +297,29 @@ void ALSM::UpdateUnregisteredActorsData() {
   for (auto &actor_info: unregistered_actors) {
 
     const ActorId actor_id = actor_info.first;
-    const ActorPtr actor_ptr = actor_info.second;
-    const std::string type_id = actor_ptr->GetTypeId();
+    const UnregisteredActor &unregistered_actor = actor_info.second;
+    const cc::ActorSnapshot &actor_snapshot = GetActorSnapshot(actor_id);
 
-    const cg::Transform actor_transform = actor_ptr->GetTransform();
+    const cg::Transform &actor_transform = actor_snapshot.transform;
     const cg::Location actor_location = actor_transform.location;
     const cg::Rotation actor_rotation = actor_transform.rotation;
-    const cg::Vector3D actor_velocity = actor_ptr->GetVelocity();
-    const bool actor_is_dormant = actor_ptr->IsDormant();
+    const cg::Vector3D actor_velocity = actor_snapshot.velocity;
+    const bool actor_is_dormant = actor_snapshot.actor_state == rpc::ActorState::Dormant;
     KinematicState kinematic_state {actor_location, actor_rotation, actor_velocity, -1.0f, true, actor_is_dormant, cg::Location()};
 
     TrafficLightState tl_state;
-    ActorType actor_type = ActorType::Any;
-    cg::Vector3D dimensions;
-    std::vector<SimpleWaypointPtr> nearest_waypoints;
+    const ActorType actor_type = unregistered_actor.type;
+    const cg::Vector3D &dimensions = unregistered_actor.extent;
+    std::vector<WaypointIndex> nearest_waypoints;
 
     bool state_entry_not_present = !simulation_state.ContainsActor(actor_id);
-    if (type_id.front() == 'v') {
-      auto vehicle_ptr = boost::static_pointer_cast<cc::Vehicle>(actor_ptr);
-      kinematic_state.speed_limit = vehicle_ptr->GetSpeedLimit();
+    if (actor_type == ActorType::Vehicle) {
+      const auto vehicle_data = actor_snapshot.state.vehicle_data;
+      kinematic_state.speed_limit = vehicle_data.speed_limit;
 
-      tl_state = {vehicle_ptr->GetTrafficLightState(), vehicle_ptr->IsAtTrafficLight()};
+      tl_state = {vehicle_data.traffic_light_state, vehicle_data.has_traffic_light};
 
       if (state_entry_not_present) {
-        dimensions = vehicle_ptr->GetBoundingBox().extent;
-        actor_type = ActorType::Vehicle;
         StaticAttributes attributes {actor_type, dimensions.x, dimensions.y, dimensions.z};
 
         simulation_state.AddActor(actor_id, kinematic_state, attributes, tl_state);
@@ -305,22 +329,16 @@ void ALSM::UpdateUnregisteredActorsData() {
       }
 
       // Identify occupied waypoints.
-      cg::Vector3D extent = vehicle_ptr->GetBoundingBox().extent;
-      cg::Vector3D heading_vector = vehicle_ptr->GetTransform().GetForwardVector();
-      std::vector<cg::Location> corners = {actor_location + cg::Location(extent.x * heading_vector),
+      cg::Vector3D heading_vector = actor_transform.GetForwardVector();
+      std::vector<cg::Location> corners = {actor_location + cg::Location(dimensions.x * heading_vector),
                                            actor_location,
-                                           actor_location + cg::Location(-extent.x * heading_vector)};
+                                           actor_location + cg::Location(-dimensions.x * heading_vector)};
       for (cg::Location &vertex: corners) {
-        SimpleWaypointPtr nearest_waypoint = local_map->GetWaypoint(vertex);
-        nearest_waypoints.push_back(nearest_waypoint);
+        nearest_waypoints.push_back(local_map->GetWaypointIndex(vertex));
       }
     }
-    else if (type_id.front() == 'w') {
-      auto walker_ptr = boost::static_pointer_cast<cc::Walker>(actor_ptr);
-
+    else {
       if (state_entry_not_present) {
-        dimensions = walker_ptr->GetBoundingBox().extent;
-        actor_type = ActorType::Pedestrian;
         StaticAttributes attributes {actor_type, dimensions.x, dimensions.y, dimensions.z};
 
         simulation_state.AddActor(actor_id, kinematic_state, attributes, tl_state);
@@ -329,11 +347,10 @@ void ALSM::UpdateUnregisteredActorsData() {
       }
 
       // Identify occupied waypoints.
-      SimpleWaypointPtr nearest_waypoint = local_map->GetWaypoint(actor_location);
-      nearest_waypoints.push_back(nearest_waypoint);
+      nearest_waypoints.push_back(local_map->GetWaypointIndex(actor_location));
     }
 
-    track_traffic.UpdateUnregisteredGridPosition(actor_id, nearest_waypoints);
+    track_traffic.UpdateUnregisteredGridPosition(actor_id, nearest_waypoints, local_map->GetGraph());
   }
 }
 
@@ -379,6 +396,8 @@ void ALSM::RemoveActor(const ActorId actor_id, const bool registered_actor) {
     unregistered_actors.erase(actor_id);
     hero_actors.erase(actor_id);
   }
+  // Forget the actor so that, if still alive, it is identified again.
+  known_actors.Forget(actor_id);
 
   track_traffic.DeleteActor(actor_id);
   simulation_state.RemoveActor(actor_id);
@@ -386,6 +405,7 @@ void ALSM::RemoveActor(const ActorId actor_id, const bool registered_actor) {
 
 void ALSM::Reset() {
   unregistered_actors.clear();
+  known_actors.Clear();
   idle_time.clear();
   hero_actors.clear();
   elapsed_last_actor_destruction = 0.0;
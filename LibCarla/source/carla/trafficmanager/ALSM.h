@@ -4,14 +4,17 @@
 #include <memory>
 
 #include "carla/client/ActorList.h"
+#include "carla/client/ActorSnapshot.h"
 #include "carla/client/Timestamp.h"
 #include "carla/client/World.h"
+#include "carla/client/WorldSnapshot.h"
 #include "carla/Memory.h"
 
 #include "carla/trafficmanager/AtomicActorSet.h"
 #include "carla/trafficmanager/CollisionStage.h"
 #include "carla/trafficmanager/DataStructures.h"
 #include "carla/trafficmanager/InMemoryMap.h"
+#include "carla/trafficmanager/KnownActors.h"
 #include "carla/trafficmanager/LocalizationStage.h"
 #include "carla/trafficmanager/MotionPlanStage.h"
 #include "carla/trafficmanager/Parameters.h"
@@ -35,6 +38,14 @@ using ActorMap = std::unordered_map<ActorId, ActorPtr>;
 using IdleTimeMap = std::unordered_map<ActorId, double>;
 using LocalMapPtr = std::shared_ptr<InMemoryMap>;
 
+/// Static attributes of a vehicle or pedestrian not registered with the
+/// traffic manager, queried once when the actor appears in the world.
+struct UnregisteredActor {
+  ActorType type;
+  cg::Vector3D extent;
+};
+using UnregisteredActorMap = std::unordered_map<ActorId, UnregisteredActor>;
+
 /// ALSM: Agent Lifecycle and State Managerment
 /// This class has functionality to update the local cache of kinematic states
 /// and manage memory and cleanup for varying number of vehicles in the simulation.
@@ -42,8 +53,12 @@ class ALSM {
 
 private:
   AtomicActorSet &registered_vehicles;
-  // Structure containing vehicles in the simulator not registered with the traffic manager.
-  ActorMap unregistered_actors;
+  // Structure containing vehicles and pedestrians in the simulator not registered with the traffic manager.
+  UnregisteredActorMap unregistered_actors;
+  // Ids of the actors seen in the world, to find created and destroyed actors.
+  KnownActors known_actors;
+  // State of every actor in the world snapshot, valid during Update.
+  std::unordered_map<ActorId, const cc::ActorSnapshot *> actor_snapshots;
   BufferMap &buffer_map;
   // Structure keeping track of duration of vehicles stuck in a location.
   IdleTimeMap idle_time;
@@ -72,13 +87,18 @@ private:
   // Method to determine if a vehicle is stuck at a place for too long.
   bool IsVehicleStuck(const ActorId& actor_id);
 
-  // Method to identify actors newly spawned in the simulation since last tick.
-  void IdentifyNewActors(const ActorList &actor_list);
+  // Method to query once the static attributes of actors newly spawned in
+  // the simulation since last tick.
+  void IdentifyNewActors(const std::vector<ActorId> &created_ids);
 
   using DestroyeddActors = std::pair<ActorIdSet, ActorIdSet>;
   // Method to identify actors deleted in the last frame.
   // Arrays of registered and unregistered actors are returned separately.
-  DestroyeddActors IdentifyDestroyedActors(const ActorList &actor_list);
+  DestroyeddActors IdentifyDestroyedActors();
+
+  // Method to get the state of an actor in the world snapshot of the
+  // current update, a default state if the actor is not in it.
+  const cc::ActorSnapshot &GetActorSnapshot(const ActorId actor_id) const;
 
   using IdleInfo = std::pair<ActorId, double>;
   void UpdateRegisteredActorsData(const bool hybrid_physics_mode, IdleInfo &max_idle_time);
@@ -53,6 +53,31 @@ namespace traffic_manager {
       map.erase(key);
     }
 
+    /// Calls @a functor with every key and value, the map is locked only once.
+    template <typename Functor>
+    void ForEach(Functor &&functor) const {
+
+      std::lock_guard<std::mutex> lock(map_mutex);
+      for (const auto &entry : map) {
+        functor(entry.first, entry.second);
+      }
+    }
+
+    /// Removes the entries for which @a predicate returns true, the map is
+    /// locked only once.
+    template <typename Predicate>
+    void RemoveIf(Predicate &&predicate) {
+
+      std::lock_guard<std::mutex> lock(map_mutex);
+      for (auto it = map.begin(); it != map.end();) {
+        if (predicate(it->first, it->second)) {
+          it = map.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
+
   };
 
 } // namespace traffic_manager
@@ -22,14 +22,16 @@ CollisionStage::CollisionStage(
   const TrackTraffic &track_traffic,
   const Parameters &parameters,
   CollisionFrame &output_array,
-  RandomGenerator &random_device)
+  RandomGeneratorMap &random_devices,
+  const LocalMapPtr &local_map)
   : vehicle_id_list(vehicle_id_list),
     simulation_state(simulation_state),
     buffer_map(buffer_map),
     track_traffic(track_traffic),
     parameters(parameters),
     output_array(output_array),
-    random_device(random_device) {}
+    local_map(local_map),
+    random_devices(random_devices) {}
 
 void CollisionStage::Update(const unsigned long index) {
   ActorId obstacle_id = 0u;
@@ -37,19 +39,28 @@ void CollisionStage::Update(const unsigned long index) {
   float available_distance_margin = std::numeric_limits<float>::infinity();
 
   const ActorId ego_actor_id = vehicle_id_list.at(index);
+  boost::optional<CollisionLock> ego_lock;
+  if (collision_locks.find(ego_actor_id) != collision_locks.end()) {
+    ego_lock = collision_locks.at(ego_actor_id);
+  }
+
   if (simulation_state.ContainsActor(ego_actor_id)) {
-    const cg::Location ego_location = simulation_state.GetLocation(ego_actor_id);
+    RandomGenerator &random_device = random_devices.at(ego_actor_id);
+    // The slot of every registered vehicle in the simulation state is its index.
+    const cg::Location ego_location = simulation_state.GetLocationAt(index);
     const Buffer &ego_buffer = buffer_map.at(ego_actor_id);
-    const unsigned long look_ahead_index = GetTargetWaypoint(ego_buffer, JUNCTION_LOOK_AHEAD).second;
-    const float velocity = simulation_state.GetVelocity(ego_actor_id).Length();
+    const unsigned long look_ahead_index = GetTargetWaypoint(local_map->GetGraph(), ego_buffer, JUNCTION_LOOK_AHEAD).second;
+    const float velocity = simulation_state.GetVelocityAt(index).Length();
 
     ActorIdSet overlapping_actors = track_traffic.GetOverlappingVehicles(ego_actor_id);
-    std::vector<ActorId> collision_candidate_ids;
+    // Squared distance to the ego vehicle and id of every collision candidate.
+    std::vector<std::pair<float, ActorId>> collision_candidates;
     // Run through vehicles with overlapping paths and filter them;
-    const float distance_to_leading = parameters.GetDistanceToLeadingVehicle(ego_actor_id);
+    const VehicleParameters &ego_parameters = parameters.GetSnapshot().GetVehicle(index);
+    const float distance_to_leading = ego_parameters.distance_to_leading_vehicle;
     float collision_radius_square = SQUARE(COLLISION_RADIUS_RATE * velocity + COLLISION_RADIUS_MIN);
     if (velocity < 2.0f) {
-      const float length = simulation_state.GetDimensions(ego_actor_id).x;
+      const float length = simulation_state.GetDimensionsAt(index).x;
       const float collision_radius_stop = COLLISION_RADIUS_STOP + length;
       collision_radius_square = SQUARE(collision_radius_stop);
     }
@@ -59,41 +70,41 @@ void CollisionStage::Update(const unsigned long index) {
 
     for (ActorId overlapping_actor_id : overlapping_actors) {
       // If actor is within maximum collision avoidance and vertical overlap range.
-      const cg::Location &overlapping_actor_location = simulation_state.GetLocation(overlapping_actor_id);
+      const size_t overlapping_actor_slot = simulation_state.GetSlot(overlapping_actor_id);
+      const cg::Location &overlapping_actor_location = simulation_state.GetLocationAt(overlapping_actor_slot);
+      const float distance_square = cg::Math::DistanceSquared(overlapping_actor_location, ego_location);
       if (overlapping_actor_id != ego_actor_id
-          && cg::Math::DistanceSquared(overlapping_actor_location, ego_location) < collision_radius_square
+          && distance_square < collision_radius_square
           && std::abs(ego_location.z - overlapping_actor_location.z) < VERTICAL_OVERLAP_THRESHOLD) {
-        collision_candidate_ids.push_back(overlapping_actor_id);
+        collision_candidates.emplace_back(distance_square, overlapping_actor_id);
       }
     }
 
     // Sorting collision candidates in accending order of distance to current vehicle.
-    std::sort(collision_candidate_ids.begin(), collision_candidate_ids.end(),
-              [this, &ego_location](const ActorId &a_id_1, const ActorId &a_id_2) {
-                const cg::Location &e_loc = ego_location;
-                const cg::Location &loc_1 = simulation_state.GetLocation(a_id_1);
-                const cg::Location &loc_2 = simulation_state.GetLocation(a_id_2);
-                return (cg::Math::DistanceSquared(e_loc, loc_1) < cg::Math::DistanceSquared(e_loc, loc_2));
-              });
+    std::sort(collision_candidates.begin(), collision_candidates.end());
 
     // Check every actor in the vicinity if it poses a collision hazard.
-    for (auto iter = collision_candidate_ids.begin();
-         iter != collision_candidate_ids.end() && !collision_hazard;
+    for (auto iter = collision_candidates.begin();
+         iter != collision_candidates.end() && !collision_hazard;
          ++iter) {
-      const ActorId other_actor_id = *iter;
+      const ActorId other_actor_id = iter->second;
       const ActorType other_actor_type = simulation_state.GetType(other_actor_id);
 
-      if (parameters.GetCollisionDetection(ego_actor_id, other_actor_id)
+      if (parameters.GetSnapshot().GetCollisionDetection(index, other_actor_id)
           && buffer_map.find(ego_actor_id) != buffer_map.end()
           && simulation_state.ContainsActor(other_actor_id)) {
         std::pair<bool, float> negotiation_result = NegotiateCollision(ego_actor_id,
                                                                        other_actor_id,
-                                                                       look_ahead_index);
+                                                                       look_ahead_index,
+                                                                       ego_lock);
+        if (!parallel_update) {
+          StoreCollisionLock(ego_actor_id, ego_lock);
+        }
         if (negotiation_result.first) {
           if ((other_actor_type == ActorType::Vehicle
-               && parameters.GetPercentageIgnoreVehicles(ego_actor_id) <= random_device.next())
+               && ego_parameters.perc_ignore_vehicles <= random_device.next())
               || (other_actor_type == ActorType::Pedestrian
-                  && parameters.GetPercentageIgnoreWalkers(ego_actor_id) <= random_device.next())) {
+                  && ego_parameters.perc_ignore_walkers <= random_device.next())) {
             collision_hazard = true;
             obstacle_id = other_actor_id;
             available_distance_margin = negotiation_result.second;
@@ -103,12 +114,38 @@ void CollisionStage::Update(const unsigned long index) {
     }
   }
 
+  if (parallel_update) {
+    parallel_locks.at(index) = ego_lock;
+  }
+
   CollisionHazardData &output_element = output_array.at(index);
   output_element.hazard_actor_id = obstacle_id;
   output_element.hazard = collision_hazard;
   output_element.available_distance_margin = available_distance_margin;
 }
 
+void CollisionStage::BeginParallelUpdate() {
+  parallel_locks.clear();
+  parallel_locks.resize(vehicle_id_list.size());
+  parallel_update = true;
+}
+
+void CollisionStage::EndParallelUpdate() {
+  parallel_update = false;
+  for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
+    StoreCollisionLock(vehicle_id_list.at(index), parallel_locks.at(index));
+  }
+  parallel_locks.clear();
+}
+
+void CollisionStage::StoreCollisionLock(const ActorId actor_id, const boost::optional<CollisionLock> &lock) {
+  if (lock) {
+    collision_locks[actor_id] = *lock;
+  } else {
+    collision_locks.erase(actor_id);
+  }
+}
+
 void CollisionStage::RemoveActor(const ActorId actor_id) {
   collision_locks.erase(actor_id);
 }
@@ -138,6 +175,17 @@ float CollisionStage::GetBoundingBoxExtention(const ActorId actor_id) {
   return bbox_extension;
 }
 
+float CollisionStage::GetDistanceToLeadingVehicle(const ActorId actor_id) const {
+  // The slot of every registered vehicle in the simulation state is its
+  // index in the snapshot.
+  const size_t slot = simulation_state.GetSlot(actor_id);
+  const ParameterSnapshot &snapshot = parameters.GetSnapshot();
+  if (slot < snapshot.Size()) {
+    return snapshot.GetVehicle(slot).distance_to_leading_vehicle;
+  }
+  return parameters.GetDistanceToLeadingVehicle(actor_id);
+}
+
 LocationVector CollisionStage::GetBoundary(const ActorId actor_id) {
   const ActorType actor_type = simulation_state.GetType(actor_id);
   const cg::Vector3D heading_vector = simulation_state.GetHeading(actor_id);
@@ -172,14 +220,16 @@ LocationVector CollisionStage::GetBoundary(const ActorId actor_id) {
 LocationVector CollisionStage::GetGeodesicBoundary(const ActorId actor_id) {
   LocationVector geodesic_boundary;
 
+  std::unique_lock<std::mutex> cache_lock(cache_mutex);
   if (geodesic_boundary_map.find(actor_id) != geodesic_boundary_map.end()) {
     geodesic_boundary = geodesic_boundary_map.at(actor_id);
   } else {
+    cache_lock.unlock();
     const LocationVector bbox = GetBoundary(actor_id);
 
     if (buffer_map.find(actor_id) != buffer_map.end()) {
       float bbox_extension = GetBoundingBoxExtention(actor_id);
-      const float specific_lead_distance = parameters.GetDistanceToLeadingVehicle(actor_id);
+      const float specific_lead_distance = GetDistanceToLeadingVehicle(actor_id);
       bbox_extension = std::max(specific_lead_distance, bbox_extension);
       const float bbox_extension_square = SQUARE(bbox_extension);
 
@@ -189,26 +239,27 @@ LocationVector CollisionStage::GetGeodesicBoundary(const ActorId actor_id) {
       const float width = dimensions.y;
       const float length = dimensions.x;
 
+      const WaypointGraph &graph = local_map->GetGraph();
       const Buffer &waypoint_buffer = buffer_map.at(actor_id);
-      const TargetWPInfo target_wp_info = GetTargetWaypoint(waypoint_buffer, length);
-      const SimpleWaypointPtr boundary_start = target_wp_info.first;
+      const TargetWPInfo target_wp_info = GetTargetWaypoint(graph, waypoint_buffer, length);
+      const WaypointIndex boundary_start = target_wp_info.first;
       const uint64_t boundary_start_index = target_wp_info.second;
 
       // At non-signalized junctions, we extend the boundary across the junction
       // and in all other situations, boundary length is velocity-dependent.
-      SimpleWaypointPtr boundary_end = nullptr;
-      SimpleWaypointPtr current_point = waypoint_buffer.at(boundary_start_index);
+      WaypointIndex boundary_end = INVALID_WAYPOINT_INDEX;
+      WaypointIndex current_point = waypoint_buffer.at(boundary_start_index);
       bool reached_distance = false;
       for (uint64_t j = boundary_start_index; !reached_distance && (j < waypoint_buffer.size()); ++j) {
-        if (boundary_start->DistanceSquared(current_point) > bbox_extension_square || j == waypoint_buffer.size() - 1) {
+        if (graph.DistanceSquared(boundary_start, current_point) > bbox_extension_square || j == waypoint_buffer.size() - 1) {
           reached_distance = true;
         }
-        if (boundary_end == nullptr
-            || cg::Math::Dot(boundary_end->GetForwardVector(), current_point->GetForwardVector()) < COS_10_DEGREES
+        if (boundary_end == INVALID_WAYPOINT_INDEX
+            || cg::Math::Dot(graph.GetForwardVector(boundary_end), graph.GetForwardVector(current_point)) < COS_10_DEGREES
             || reached_distance) {
 
-          const cg::Vector3D heading_vector = current_point->GetForwardVector();
-          const cg::Location location = current_point->GetLocation();
+          const cg::Vector3D heading_vector = graph.GetForwardVector(current_point);
+          const cg::Location location = graph.GetLocation(current_point);
           cg::Vector3D perpendicular_vector = cg::Vector3D(-heading_vector.y, heading_vector.x, 0.0f);
           perpendicular_vector = perpendicular_vector.MakeSafeUnitVector(EPSILON);
           // Direction determined for the left-handed system.
@@ -236,6 +287,7 @@ LocationVector CollisionStage::GetGeodesicBoundary(const ActorId actor_id) {
       geodesic_boundary = bbox;
     }
 
+    cache_lock.lock();
     geodesic_boundary_map.insert({actor_id, geodesic_boundary});
   }
 
@@ -271,20 +323,22 @@ GeometryComparison CollisionStage::GetGeometryBetweenActors(const ActorId refere
 
   GeometryComparison comparision_result{-1.0, -1.0, -1.0, -1.0};
 
+  // Results are computed and cached with the lowest actor id as reference,
+  // so they do not depend on which of the two vehicles is processed first.
+  std::unique_lock<std::mutex> cache_lock(cache_mutex);
   if (geometry_cache.find(actor_id_key) != geometry_cache.end()) {
 
     comparision_result = geometry_cache.at(actor_id_key);
-    double mref_veh_other = comparision_result.reference_vehicle_to_other_geodesic;
-    comparision_result.reference_vehicle_to_other_geodesic = comparision_result.other_vehicle_to_reference_geodesic;
-    comparision_result.other_vehicle_to_reference_geodesic = mref_veh_other;
+    cache_lock.unlock();
   } else {
+    cache_lock.unlock();
 
-    const Polygon reference_polygon = GetPolygon(GetBoundary(reference_vehicle_id));
-    const Polygon other_polygon = GetPolygon(GetBoundary(other_actor_id));
+    const Polygon reference_polygon = GetPolygon(GetBoundary(key_parts.first));
+    const Polygon other_polygon = GetPolygon(GetBoundary(key_parts.second));
 
-    const Polygon reference_geodesic_polygon = GetPolygon(GetGeodesicBoundary(reference_vehicle_id));
+    const Polygon reference_geodesic_polygon = GetPolygon(GetGeodesicBoundary(key_parts.first));
 
-    const Polygon other_geodesic_polygon = GetPolygon(GetGeodesicBoundary(other_actor_id));
+    const Polygon other_geodesic_polygon = GetPolygon(GetGeodesicBoundary(key_parts.second));
 
     const double reference_vehicle_to_other_geodesic = bg::distance(reference_polygon, other_geodesic_polygon);
     const double other_vehicle_to_reference_geodesic = bg::distance(other_polygon, reference_geodesic_polygon);
@@ -296,7 +350,14 @@ GeometryComparison CollisionStage::GetGeometryBetweenActors(const ActorId refere
               inter_geodesic_distance,
               inter_bbox_distance};
 
+    cache_lock.lock();
     geometry_cache.insert({actor_id_key, comparision_result});
+    cache_lock.unlock();
+  }
+
+  if (reference_vehicle_id != key_parts.first) {
+    std::swap(comparision_result.reference_vehicle_to_other_geodesic,
+              comparision_result.other_vehicle_to_reference_geodesic);
   }
 
   return comparision_result;
@@ -304,7 +365,8 @@ GeometryComparison CollisionStage::GetGeometryBetweenActors(const ActorId refere
 
 std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId reference_vehicle_id,
                                                           const ActorId other_actor_id,
-                                                          const uint64_t reference_junction_look_ahead_index) {
+                                                          const uint64_t reference_junction_look_ahead_index,
+                                                          boost::optional<CollisionLock> &reference_lock) {
   // Output variables for the method.
   bool hazard = false;
   float available_distance_margin = std::numeric_limits<float>::infinity();
@@ -341,13 +403,14 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
   float reference_heading_to_other_dot = cg::Math::Dot(reference_heading, reference_to_other);
   bool other_vehicle_in_front = reference_heading_to_other_dot > 0;
   const Buffer &reference_vehicle_buffer = buffer_map.at(reference_vehicle_id);
-  SimpleWaypointPtr closest_point = reference_vehicle_buffer.front();
-  bool ego_inside_junction = closest_point->CheckJunction();
+  const WaypointGraph &graph = local_map->GetGraph();
+  const WaypointIndex closest_point = reference_vehicle_buffer.front();
+  bool ego_inside_junction = graph.CheckJunction(closest_point);
   TrafficLightState reference_tl_state = simulation_state.GetTLS(reference_vehicle_id);
   bool ego_at_traffic_light = reference_tl_state.at_traffic_light;
   bool ego_stopped_by_light = reference_tl_state.tl_state != TLS::Green && reference_tl_state.tl_state != TLS::Off;
-  SimpleWaypointPtr look_ahead_point = reference_vehicle_buffer.at(reference_junction_look_ahead_index);
-  bool ego_at_junction_entrance = !closest_point->CheckJunction() && look_ahead_point->CheckJunction();
+  const WaypointIndex look_ahead_point = reference_vehicle_buffer.at(reference_junction_look_ahead_index);
+  bool ego_at_junction_entrance = !graph.CheckJunction(closest_point) && graph.CheckJunction(look_ahead_point);
 
   // Conditions to consider collision negotiation.
   if (!(ego_at_junction_entrance && ego_at_traffic_light && ego_stopped_by_light)
@@ -374,7 +437,7 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
 
       hazard = true;
 
-      const float reference_lead_distance = parameters.GetDistanceToLeadingVehicle(reference_vehicle_id);
+      const float reference_lead_distance = GetDistanceToLeadingVehicle(reference_vehicle_id);
       const float specific_distance_margin = std::max(reference_lead_distance, MIN_REFERENCE_DISTANCE);
       available_distance_margin = static_cast<float>(std::max(geometry_comparison.reference_vehicle_to_other_geodesic
                                                               - static_cast<double>(specific_distance_margin), 0.0));
@@ -385,8 +448,8 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
       // This enables us to smoothly approach the lead vehicle.
 
       // When possible collision found, check if an entry for collision lock present.
-      if (collision_locks.find(reference_vehicle_id) != collision_locks.end()) {
-        CollisionLock &lock = collision_locks.at(reference_vehicle_id);
+      if (reference_lock) {
+        CollisionLock &lock = *reference_lock;
         // Check if the same vehicle is under lock.
         if (other_actor_id == lock.lead_vehicle_id) {
           // If the body of the lead vehicle is touching the reference vehicle bounding box.
@@ -403,17 +466,16 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
         }
       } else {
         // Insert and initialize lock entry if not present.
-        collision_locks.insert({reference_vehicle_id,
-                                {geometry_comparison.inter_bbox_distance,
-                                 geometry_comparison.inter_bbox_distance,
-                                 other_actor_id}});
+        reference_lock = CollisionLock{geometry_comparison.inter_bbox_distance,
+                                       geometry_comparison.inter_bbox_distance,
+                                       other_actor_id};
       }
     }
   }
 
   // If no collision hazard detected, then flush collision lock held by the vehicle.
-  if (!hazard && collision_locks.find(reference_vehicle_id) != collision_locks.end()) {
-    collision_locks.erase(reference_vehicle_id);
+  if (!hazard && reference_lock) {
+    reference_lock = boost::none;
   }
 
   return {hazard, available_distance_margin};
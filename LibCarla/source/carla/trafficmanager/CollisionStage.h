@@ -2,6 +2,9 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
+
+#include <boost/optional.hpp>
 
 #if defined(__clang__)
 #  pragma clang diagnostic push
@@ -16,6 +19,7 @@
 #endif
 
 #include "carla/trafficmanager/DataStructures.h"
+#include "carla/trafficmanager/InMemoryMap.h"
 #include "carla/trafficmanager/Parameters.h"
 #include "carla/trafficmanager/RandomGenerator.h"
 #include "carla/trafficmanager/SimulationState.h"
@@ -41,7 +45,7 @@ using CollisionLockMap = std::unordered_map<ActorId, CollisionLock>;
 namespace cc = carla::client;
 namespace bg = boost::geometry;
 
-using Buffer = std::deque<std::shared_ptr<SimpleWaypoint>>;
+using LocalMapPtr = std::shared_ptr<InMemoryMap>;
 using BufferMap = std::unordered_map<carla::ActorId, Buffer>;
 using LocationVector = std::vector<cg::Location>;
 using GeodesicBoundaryMap = std::unordered_map<ActorId, LocationVector>;
@@ -57,6 +61,7 @@ private:
   const TrackTraffic &track_traffic;
   const Parameters &parameters;
   CollisionFrame &output_array;
+  const LocalMapPtr &local_map;
   // Structure keeping track of blocking lead vehicles.
   CollisionLockMap collision_locks;
   // Structures to cache geodesic boundaries of vehicle and
@@ -64,12 +69,26 @@ private:
   // to avoid repeated computation within a cycle.
   GeometryComparisonMap geometry_cache;
   GeodesicBoundaryMap geodesic_boundary_map;
-  RandomGenerator &random_device;
+  // Guards the cycle caches, which are shared between threads.
+  std::mutex cache_mutex;
+  RandomGeneratorMap &random_devices;
+  // Whether vehicles are being updated concurrently. In that case every
+  // vehicle sees the collision locks as they were at the beginning of the
+  // update, and the new locks are stored once every vehicle is done.
+  bool parallel_update = false;
+  std::vector<boost::optional<CollisionLock>> parallel_locks;
 
   // Method to determine if a vehicle is on a collision path to another.
   std::pair<bool, float> NegotiateCollision(const ActorId reference_vehicle_id,
                                             const ActorId other_actor_id,
-                                            const uint64_t reference_junction_look_ahead_index);
+                                            const uint64_t reference_junction_look_ahead_index,
+                                            boost::optional<CollisionLock> &reference_lock);
+
+  void StoreCollisionLock(const ActorId actor_id, const boost::optional<CollisionLock> &lock);
+
+  // Method to get the distance a registered vehicle keeps to the leading
+  // vehicle, from the parameter snapshot of the cycle.
+  float GetDistanceToLeadingVehicle(const ActorId actor_id) const;
 
   // Method to calculate bounding box extention length ahead of the vehicle.
   float GetBoundingBoxExtention(const ActorId actor_id);
@@ -97,10 +116,18 @@ public:
                  const TrackTraffic &track_traffic,
                  const Parameters &parameters,
                  CollisionFrame &output_array,
-                 RandomGenerator &random_device);
+                 RandomGeneratorMap &random_devices,
+                 const LocalMapPtr &local_map);
 
   void Update (const unsigned long index) override;
 
+  /// Prepares the stage for Update to be called concurrently for different
+  /// vehicles.
+  void BeginParallelUpdate();
+
+  /// Stores the collision locks computed since BeginParallelUpdate.
+  void EndParallelUpdate();
+
   void RemoveActor(const ActorId actor_id) override;
 
   void Reset() override;
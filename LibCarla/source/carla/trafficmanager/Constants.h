@@ -160,6 +160,11 @@ static const uint64_t BUFFER_STEP_THROUGH = 5;
 static const float INV_BUFFER_STEP_THROUGH = 1.0f / static_cast<float>(BUFFER_STEP_THROUGH);
 } // namespace TrackTraffic
 
+namespace ParallelExecution {
+/// Number of consecutive vehicles handed to a worker thread at once.
+static const size_t VEHICLES_PER_CHUNK = 4u;
+} // namespace ParallelExecution
+
 } // namespace constants
 } // namespace traffic_manager
 } // namespace carla
@@ -20,7 +20,9 @@ namespace traffic_manager {
   using RawNodeList = std::vector<WaypointPtr>;
 
   InMemoryMap::InMemoryMap(WorldMap world_map) : _world_map(world_map) {}
-  InMemoryMap::~InMemoryMap() {}
+  InMemoryMap::~InMemoryMap() {
+    ClearDenseTopology();
+  }
 
   SegmentId InMemoryMap::GetSegmentId(const WaypointPtr &wp) const {
     return std::make_tuple(wp->GetRoadId(), wp->GetLaneId(), wp->GetSectionId());
@@ -75,6 +77,7 @@ namespace traffic_manager {
   }
 
   void InMemoryMap::Save(const std::string& path) {
+    SetUpDenseTopologyFromGraph();
     std::string filename;
     if (path.empty()) {
       filename = this->GetMapName() + ".bin";
@@ -160,9 +163,35 @@ namespace traffic_manager {
     // create spatial tree
     SetUpSpatialTree();
 
+    SetUpGraph();
+
+    return true;
+  }
+
+  bool InMemoryMap::LoadCache(const std::string& path, uint64_t hash) {
+    if (!graph.Load(path, hash)) {
+      return false;
+    }
+    carla_waypoints.assign(graph.Size(), nullptr);
+
+    // Bulk load the spatial tree from the mapped locations.
+    std::vector<SpatialTreeEntry> entries;
+    entries.reserve(graph.Size());
+    for (WaypointIndex i = 0u; i < graph.Size(); ++i) {
+      const cg::Location &loc = graph.GetLocation(i);
+      entries.emplace_back(Point3D(loc.x, loc.y, loc.z), i);
+    }
+    rtree = Rtree(entries.begin(), entries.end());
+
+    ClearDenseTopology();
+    dense_topology_pending = true;
     return true;
   }
 
+  bool InMemoryMap::SaveCache(const std::string& path, uint64_t hash) const {
+    return graph.Save(path, hash);
+  }
+
   void InMemoryMap::SetUp() {
 
     // 1. Building segment topology (i.e., defining set of segment predecessors and successors)
@@ -363,14 +392,83 @@ namespace traffic_manager {
 
     // Specifying a RoadOption for each SimpleWaypoint
     SetUpRoadOption();
+
+    SetUpGraph();
+  }
+
+  void InMemoryMap::SetUpGraph() {
+    graph.Build(dense_topology);
+    carla_waypoints.clear();
+    carla_waypoints.reserve(dense_topology.size());
+    for (auto &swp : dense_topology) {
+      carla_waypoints.push_back(swp->GetWaypoint());
+    }
+    // The stages use the graph, release the dense topology until something
+    // asks for it, as when the map is loaded from a cache.
+    ClearDenseTopology();
+    dense_topology_pending = true;
+  }
+
+  void InMemoryMap::ClearDenseTopology() const {
+    for (auto &swp : dense_topology) {
+      swp->ClearLinks();
+    }
+    dense_topology.clear();
+    dense_topology.shrink_to_fit();
+  }
+
+  void InMemoryMap::SetUpDenseTopologyFromGraph() const {
+    if (!dense_topology_pending) {
+      return;
+    }
+    // critical section, the stages may ask for waypoints concurrently
+    std::lock_guard<std::mutex> lock(dense_topology_mutex);
+    if (!dense_topology_pending) {
+      return;
+    }
+
+    NodeList nodes;
+    nodes.reserve(graph.Size());
+    for (WaypointIndex i = 0u; i < graph.Size(); ++i) {
+      SimpleWaypointPtr swp = std::make_shared<SimpleWaypoint>(GetCarlaWaypoint(i));
+      swp->SetGeodesicGridId(graph.GetGeodesicGridId(i));
+      swp->SetIsJunction(graph.CheckJunction(i));
+      swp->SetRoadOption(graph.GetRoadOption(i));
+      nodes.push_back(swp);
+    }
+
+    // connect waypoints
+    auto get_nodes = [&nodes](WaypointRange range) {
+      std::vector<SimpleWaypointPtr> result;
+      result.reserve(range.size());
+      for (WaypointIndex index : range) {
+        result.push_back(nodes[index]);
+      }
+      return result;
+    };
+    for (WaypointIndex i = 0u; i < graph.Size(); ++i) {
+      SimpleWaypointPtr &swp = nodes[i];
+      swp->SetNextWaypoint(get_nodes(graph.GetNextWaypoints(i)));
+      swp->SetPreviousWaypoint(get_nodes(graph.GetPreviousWaypoints(i)));
+      if (graph.GetLeftWaypoint(i) != INVALID_WAYPOINT_INDEX) {
+        swp->SetLeftWaypoint(nodes[graph.GetLeftWaypoint(i)]);
+      }
+      if (graph.GetRightWaypoint(i) != INVALID_WAYPOINT_INDEX) {
+        swp->SetRightWaypoint(nodes[graph.GetRightWaypoint(i)]);
+      }
+    }
+
+    dense_topology = std::move(nodes);
+    dense_topology_pending = false;
   }
 
   void InMemoryMap::SetUpSpatialTree() {
-    for (auto &simple_waypoint: dense_topology) {
+    for (size_t i = 0u; i < dense_topology.size(); ++i) {
+      const SimpleWaypointPtr &simple_waypoint = dense_topology[i];
       if (simple_waypoint != nullptr) {
         const cg::Location loc = simple_waypoint->GetLocation();
         Point3D point(loc.x, loc.y, loc.z);
-        rtree.insert(std::make_pair(point, simple_waypoint));
+        rtree.insert(std::make_pair(point, static_cast<WaypointIndex>(i)));
       }
     }
   }
@@ -466,18 +564,39 @@ namespace traffic_manager {
 
   SimpleWaypointPtr InMemoryMap::GetWaypoint(const cg::Location loc) const {
 
+    SetUpDenseTopologyFromGraph();
+    return dense_topology.at(GetWaypointIndex(loc));
+  }
+
+  WaypointIndex InMemoryMap::GetWaypointIndex(const cg::Location loc) const {
+
     Point3D query_point(loc.x, loc.y, loc.z);
     std::vector<SpatialTreeEntry> result_1;
 
     rtree.query(bgi::nearest(query_point, 1), std::back_inserter(result_1));
 
-    SpatialTreeEntry &closest_entry = result_1.front();
-    SimpleWaypointPtr &closest_point = closest_entry.second;
+    return result_1.front().second;
+  }
+
+  WaypointPtr InMemoryMap::GetCarlaWaypoint(const WaypointIndex index) const {
 
-    return closest_point;
+    // Stages ask for waypoints concurrently, two of them may create the same
+    // waypoint but never see a half written pointer.
+    WaypointPtr waypoint = boost::atomic_load(&carla_waypoints.at(index));
+    if (waypoint == nullptr) {
+      waypoint = _world_map->GetWaypointXODR(graph.GetRoadId(index), graph.GetLaneId(index),
+          static_cast<float>(graph.GetDistance(index)));
+      boost::atomic_store(&carla_waypoints.at(index), waypoint);
+    }
+    return waypoint;
   }
 
-  NodeList InMemoryMap::GetWaypointsInDelta(const cg::Location loc, const uint16_t n_points, const float random_sample) const {
+  const WaypointGraph &InMemoryMap::GetGraph() const {
+
+    return graph;
+  }
+
+  std::vector<WaypointIndex> InMemoryMap::GetWaypointsInDelta(const cg::Location loc, const uint16_t n_points, const float random_sample) const {
     Point3D query_point(loc.x, loc.y, loc.z);
 
     Point3D lower_p1(loc.x + random_sample, loc.y + random_sample, loc.z + Z_DELTA);
@@ -488,12 +607,12 @@ namespace traffic_manager {
     Box lower_query_box(lower_p2, lower_p1);
     Box upper_query_box(upper_p2, upper_p1);
 
-    NodeList result;
+    std::vector<WaypointIndex> result;
     uint8_t x = 0;
     for (Rtree::const_query_iterator
         it = rtree.qbegin(bgi::within(upper_query_box)
         && !bgi::within(lower_query_box)
-        && bgi::satisfies([&](SpatialTreeEntry const& v) { return !v.second->CheckJunction();}));
+        && bgi::satisfies([&](SpatialTreeEntry const& v) { return !graph.CheckJunction(v.second);}));
         it != rtree.qend();
         ++it) {
     x++;
@@ -506,6 +625,7 @@ namespace traffic_manager {
   }
 
   NodeList InMemoryMap::GetDenseTopology() const {
+    SetUpDenseTopologyFromGraph();
     return dense_topology;
   }
 
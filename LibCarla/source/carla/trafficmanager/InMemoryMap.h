@@ -6,8 +6,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -32,6 +34,7 @@
 #include "carla/trafficmanager/RandomGenerator.h"
 #include "carla/trafficmanager/SimpleWaypoint.h"
 #include "carla/trafficmanager/CachedSimpleWaypoint.h"
+#include "carla/trafficmanager/WaypointGraph.h"
 
 namespace carla {
 namespace traffic_manager {
@@ -50,7 +53,7 @@ namespace bgi = boost::geometry::index;
 
   using Point3D = bg::model::point<float, 3, bg::cs::cartesian>;
   using Box = bg::model::box<Point3D>;
-  using SpatialTreeEntry = std::pair<Point3D, SimpleWaypointPtr>;
+  using SpatialTreeEntry = std::pair<Point3D, WaypointIndex>;
 
   using SegmentId = std::tuple<crd::RoadId, crd::LaneId, crd::SectionId>;
   using SegmentTopology = std::map<SegmentId, std::pair<std::vector<SegmentId>, std::vector<SegmentId>>>;
@@ -67,8 +70,17 @@ namespace bgi = boost::geometry::index;
     /// Object to hold the world map received by the constructor.
     WorldMap _world_map;
     /// Structure to hold all custom waypoint objects after interpolation of
-    /// sparse topology.
-    NodeList dense_topology;
+    /// sparse topology. Released once the graph is built, and created again
+    /// from it on first use.
+    mutable NodeList dense_topology;
+    /// Whether the dense topology has to be created from the graph.
+    mutable std::atomic_bool dense_topology_pending{false};
+    mutable std::mutex dense_topology_mutex;
+    /// Flat copy of the dense topology, indexed the same, used by the stages.
+    WaypointGraph graph;
+    /// Carla waypoint of every waypoint of the graph, created on first use
+    /// when the map is loaded from a cache.
+    mutable std::vector<WaypointPtr> carla_waypoints;
     /// Spatial quadratic R-tree for indexing and querying waypoints.
     Rtree rtree;
 
@@ -82,14 +94,31 @@ namespace bgi = boost::geometry::index;
     //bool Load(const std::string& filename);
     bool Load(const std::vector<uint8_t>& content);
 
+    /// Map in memory the local map cached at @a path, valid only if it was
+    /// built from OpenDRIVE content with @a hash. Only the graph is loaded,
+    /// the dense topology is created from it the first time it is needed.
+    bool LoadCache(const std::string& path, uint64_t hash);
+
+    /// Write the graph of the local map to the cache at @a path.
+    bool SaveCache(const std::string& path, uint64_t hash) const;
+
     /// This method constructs the local map with a resolution of sampling_resolution.
     void SetUp();
 
     /// This method returns the closest waypoint to a given location on the map.
     SimpleWaypointPtr GetWaypoint(const cg::Location loc) const;
 
+    /// This method returns the index of the closest waypoint to a given location on the map.
+    WaypointIndex GetWaypointIndex(const cg::Location loc) const;
+
+    /// This method returns the carla waypoint at the given index of the graph.
+    WaypointPtr GetCarlaWaypoint(const WaypointIndex index) const;
+
+    /// This method returns the flat graph of the dense topology.
+    const WaypointGraph &GetGraph() const;
+
     /// This method returns n waypoints in an delta area with a certain distance from the ego vehicle.
-    NodeList GetWaypointsInDelta(const cg::Location loc, const uint16_t n_points, const float random_sample) const;
+    std::vector<WaypointIndex> GetWaypointsInDelta(const cg::Location loc, const uint16_t n_points, const float random_sample) const;
 
     /// This method returns the full list of discrete samples of the map in the local cache.
     NodeList GetDenseTopology() const;
@@ -104,6 +133,11 @@ namespace bgi = boost::geometry::index;
     void SetUpDenseTopology();
     void SetUpSpatialTree();
     void SetUpRoadOption();
+    void SetUpGraph();
+    /// Releases the dense topology, it can be created again from the graph.
+    void ClearDenseTopology() const;
+    /// Creates the dense topology from the graph if the map was loaded from a cache.
+    void SetUpDenseTopologyFromGraph() const;
 
     /// This method is used to find and place lane change links.
     void FindAndLinkLaneChange(SimpleWaypointPtr reference_waypoint);
@@ -0,0 +1,66 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <unordered_set>
+#include <vector>
+
+#include "carla/rpc/ActorId.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  using ActorId = carla::ActorId;
+
+  /// Ids of the actors seen in the world snapshots, to find the actors
+  /// created and destroyed since the previous update by comparing them with
+  /// the ids of the current snapshot.
+  class KnownActors {
+  public:
+
+    /// Forgets the actors for which @a is_alive returns false.
+    template <typename IsAliveT>
+    void ForgetDestroyed(IsAliveT &&is_alive) {
+      for (auto it = _ids.begin(); it != _ids.end();) {
+        if (!is_alive(*it)) {
+          it = _ids.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
+
+    /// Forgets an actor, so that if it is still alive the next call to
+    /// IdentifyCreated returns it again.
+    void Forget(ActorId actor_id) {
+      _ids.erase(actor_id);
+    }
+
+    /// Returns the ids in @a current_ids not known yet, and remembers them.
+    /// Call it after the removals of an update, so that the actors forgotten
+    /// by them are identified again in the same update.
+    std::vector<ActorId> IdentifyCreated(const std::vector<ActorId> &current_ids) {
+      std::vector<ActorId> created_ids;
+      for (const ActorId actor_id : current_ids) {
+        if (_ids.insert(actor_id).second) {
+          created_ids.push_back(actor_id);
+        }
+      }
+      return created_ids;
+    }
+
+    void Clear() {
+      _ids.clear();
+    }
+
+  private:
+
+    std::unordered_set<ActorId> _ids;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
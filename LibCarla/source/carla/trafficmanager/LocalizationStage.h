@@ -1,7 +1,9 @@
 
 #pragma once
 
+#include <algorithm>
 #include <memory>
+#include <mutex>
 
 #include "carla/trafficmanager/DataStructures.h"
 #include "carla/trafficmanager/InMemoryMap.h"
@@ -18,7 +20,7 @@ namespace traffic_manager {
 namespace cc = carla::client;
 
 using LocalMapPtr = std::shared_ptr<InMemoryMap>;
-using LaneChangeSWptMap = std::unordered_map<ActorId, SimpleWaypointPtr>;
+using LaneChangeSWptMap = std::unordered_map<ActorId, WaypointIndex>;
 using WaypointPtr = carla::SharedPtr<cc::Waypoint>;
 using Action = std::pair<RoadOption, WaypointPtr>;
 using ActionBuffer = std::vector<Action>;
@@ -42,14 +44,30 @@ private:
   LocalizationFrame &output_array;
   LaneChangeSWptMap last_lane_change_swpt;
   ActorIdSet vehicles_at_junction;
-  using SimpleWaypointPair = std::pair<SimpleWaypointPtr, SimpleWaypointPtr>;
-  std::unordered_map<ActorId, SimpleWaypointPair> vehicles_at_junction_entrance;
-  RandomGenerator &random_device;
-
-  SimpleWaypointPtr AssignLaneChange(const ActorId actor_id,
-                                     const cg::Location vehicle_location,
-                                     const float vehicle_speed,
-                                     bool force, bool direction);
+  using WaypointIndexPair = std::pair<WaypointIndex, WaypointIndex>;
+  std::unordered_map<ActorId, WaypointIndexPair> vehicles_at_junction_entrance;
+  /// Guards last_lane_change_swpt and vehicles_at_junction_entrance.
+  mutable std::mutex lane_change_mutex;
+  RandomGeneratorMap &random_devices;
+  /// Whether vehicles are being updated concurrently.
+  bool parallel_update = false;
+  /// Front of every buffer at the beginning of a parallel update, so that
+  /// vehicles do not read buffers being modified by other threads.
+  std::unordered_map<ActorId, WaypointIndex> buffer_fronts;
+  /// Vehicles marked for removal during a parallel update.
+  std::vector<ActorId> parallel_removals;
+  std::mutex removal_mutex;
+
+  /// Returns INVALID_WAYPOINT_INDEX if the vehicle has no buffer.
+  WaypointIndex GetBufferFront(const ActorId actor_id) const;
+
+  void MarkForRemoval(const ActorId actor_id);
+
+  /// Returns INVALID_WAYPOINT_INDEX if no lane change is viable.
+  WaypointIndex AssignLaneChange(const ActorId actor_id,
+                                 const cg::Location vehicle_location,
+                                 const float vehicle_speed,
+                                 bool force, bool direction);
 
   void ExtendAndFindSafeSpace(const ActorId actor_id,
                               const bool is_at_junction_entrance,
@@ -74,10 +92,19 @@ public:
                     Parameters &parameters,
                     std::vector<ActorId>& marked_for_removal,
                     LocalizationFrame &output_array,
-                    RandomGenerator &random_device);
+                    RandomGeneratorMap &random_devices);
 
   void Update(const unsigned long index) override;
 
+  /// Prepares the stage for Update to be called concurrently for different
+  /// vehicles. Vehicles then see the traffic tracking state and the buffers
+  /// of other vehicles as they were before the update started.
+  void BeginParallelUpdate();
+
+  /// Applies the traffic tracking updates and removals recorded since
+  /// BeginParallelUpdate, in vehicle order.
+  void EndParallelUpdate();
+
   void RemoveActor(const ActorId actor_id) override;
 
   void Reset() override;
@@ -4,6 +4,7 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
+#include <algorithm>
 #include <limits>
 
 #include "carla/client/TrafficSign.h"
@@ -41,7 +42,7 @@ MotionPlanStage::MotionPlanStage(
   const TLFrame &tl_frame,
   const cc::World &world,
   ControlFrame &output_array,
-  RandomGenerator &random_device,
+  RandomGeneratorMap &random_devices,
   const LocalMapPtr &local_map)
     : vehicle_id_list(vehicle_id_list),
     simulation_state(simulation_state),
@@ -57,23 +58,24 @@ MotionPlanStage::MotionPlanStage(
     tl_frame(tl_frame),
     world(world),
     output_array(output_array),
-    random_device(random_device),
+    random_devices(random_devices),
     local_map(local_map) {}
 
 void MotionPlanStage::Update(const unsigned long index) {
+  // The slot of every registered vehicle in the simulation state is its index.
   const ActorId actor_id = vehicle_id_list.at(index);
-  const cg::Location vehicle_location = simulation_state.GetLocation(actor_id);
-  const cg::Vector3D vehicle_velocity = simulation_state.GetVelocity(actor_id);
-  const cg::Rotation vehicle_rotation = simulation_state.GetRotation(actor_id);
+  const cg::Location vehicle_location = simulation_state.GetLocationAt(index);
+  const cg::Vector3D vehicle_velocity = simulation_state.GetVelocityAt(index);
+  const cg::Rotation vehicle_rotation = simulation_state.GetRotationAt(index);
   const float vehicle_speed = vehicle_velocity.Length();
-  const cg::Vector3D vehicle_heading = simulation_state.GetHeading(actor_id);
-  const bool vehicle_physics_enabled = simulation_state.IsPhysicsEnabled(actor_id);
-  const float vehicle_speed_limit = simulation_state.GetSpeedLimit(actor_id);
+  const cg::Vector3D vehicle_heading = simulation_state.GetHeadingAt(index);
+  const bool vehicle_physics_enabled = simulation_state.IsPhysicsEnabledAt(index);
+  const float vehicle_speed_limit = simulation_state.GetSpeedLimitAt(index);
   const Buffer &waypoint_buffer = buffer_map.at(actor_id);
   const LocalizationData &localization = localization_frame.at(index);
   const CollisionHazardData &collision_hazard = collision_frame.at(index);
-  const bool &tl_hazard = tl_frame.at(index);
-  current_timestamp = world.GetSnapshot().GetTimestamp();
+  const bool tl_hazard = tl_frame.at(index);
+  const cc::Timestamp current_timestamp = world.GetSnapshot().GetTimestamp();
   StateEntry current_state;
 
   // Instanciating teleportation transform as current vehicle transform.
@@ -83,33 +85,39 @@ void MotionPlanStage::Update(const unsigned long index) {
   cg::Location hero_location = track_traffic.GetHeroLocation();
   bool is_hero_alive = hero_location != cg::Location(0, 0, 0);
 
-  if (simulation_state.IsDormant(actor_id) && parameters.GetRespawnDormantVehicles() && is_hero_alive) {
+  const ParameterSnapshot &snapshot = parameters.GetSnapshot();
+  if (simulation_state.IsDormantAt(index) && snapshot.GetRespawnDormantVehicles() && is_hero_alive) {
+    if (parallel_update) {
+      std::lock_guard<std::mutex> lock(respawn_mutex);
+      deferred_respawns.push_back(index);
+      return;
+    }
+
     // Flushing controller state for vehicle.
     current_state = {current_timestamp,
                     0.0f, 0.0f,
                     0.0f};
 
     // Add entry to teleportation duration clock table if not present.
-    if (teleportation_instance.find(actor_id) == teleportation_instance.end()) {
-      teleportation_instance.insert({actor_id, current_timestamp});
-    }
+    const cc::Timestamp &teleportation_timestamp = GetTeleportationInstance(actor_id, current_timestamp);
 
     // Get lower and upper bound for teleporting vehicle.
-    float lower_bound = parameters.GetLowerBoundaryRespawnDormantVehicles();
-    float upper_bound = parameters.GetUpperBoundaryRespawnDormantVehicles();
+    float lower_bound = snapshot.GetLowerBoundaryRespawnDormantVehicles();
+    float upper_bound = snapshot.GetUpperBoundaryRespawnDormantVehicles();
     float dilate_factor = (upper_bound-lower_bound)/100.0f;
 
     // Measuring time elapsed since last teleportation for the vehicle.
-    double elapsed_time = current_timestamp.elapsed_seconds - teleportation_instance.at(actor_id).elapsed_seconds;
+    double elapsed_time = current_timestamp.elapsed_seconds - teleportation_timestamp.elapsed_seconds;
 
-    if (parameters.GetSynchronousMode() || elapsed_time > HYBRID_MODE_DT) {
-      float random_sample = (static_cast<float>(random_device.next())*dilate_factor) + lower_bound;
-      NodeList teleport_waypoint_list = local_map->GetWaypointsInDelta(hero_location, ATTEMPTS_TO_TELEPORT, random_sample);
+    if (snapshot.GetSynchronousMode() || elapsed_time > HYBRID_MODE_DT) {
+      float random_sample = (static_cast<float>(random_devices.at(actor_id).next())*dilate_factor) + lower_bound;
+      const WaypointGraph &graph = local_map->GetGraph();
+      std::vector<WaypointIndex> teleport_waypoint_list = local_map->GetWaypointsInDelta(hero_location, ATTEMPTS_TO_TELEPORT, random_sample);
       if (!teleport_waypoint_list.empty()) {
-        for (auto &teleport_waypoint : teleport_waypoint_list) {
-          GeoGridId geogrid_id = teleport_waypoint->GetGeodesicGridId();
+        for (const WaypointIndex teleport_waypoint : teleport_waypoint_list) {
+          GeoGridId geogrid_id = graph.GetGeodesicGridId(teleport_waypoint);
           if (track_traffic.IsGeoGridFree(geogrid_id)) {
-            teleportation_transform = teleport_waypoint->GetTransform();
+            teleportation_transform = graph.GetTransform(teleport_waypoint);
             teleportation_transform.location.z += 0.5f;
             track_traffic.AddTakenGrid(geogrid_id, actor_id);
             break;
@@ -123,7 +131,7 @@ void MotionPlanStage::Update(const unsigned long index) {
     KinematicState kinematic_state{teleportation_transform.location,
                                    teleportation_transform.rotation,
                                    vehicle_velocity, vehicle_speed_limit,
-                                   vehicle_physics_enabled, simulation_state.IsDormant(actor_id),
+                                   vehicle_physics_enabled, simulation_state.IsDormantAt(index),
                                    teleportation_transform.location};
     simulation_state.UpdateKinematicState(actor_id, kinematic_state);
   }
@@ -131,10 +139,10 @@ void MotionPlanStage::Update(const unsigned long index) {
   else {
 
     // Target velocity for vehicle.
-    float max_target_velocity = parameters.GetVehicleTargetVelocity(actor_id, vehicle_speed_limit) / 3.6f;
+    float max_target_velocity = snapshot.GetVehicleTargetVelocity(index, vehicle_speed_limit) / 3.6f;
 
     // Algorithm to reduce speed near landmarks
-    float max_landmark_target_velocity = GetLandmarkTargetVelocity(*(waypoint_buffer.at(0)), vehicle_location, actor_id, max_target_velocity);
+    float max_landmark_target_velocity = GetLandmarkTargetVelocity(*local_map->GetCarlaWaypoint(waypoint_buffer.front()), vehicle_location, index, max_target_velocity);
 
     // Algorithm to reduce speed near turns
     float max_turn_target_velocity = GetTurnTargetVelocity(waypoint_buffer, max_target_velocity);
@@ -152,16 +160,17 @@ void MotionPlanStage::Update(const unsigned long index) {
     // In case of collision or traffic light hazard.
     bool emergency_stop = tl_hazard || collision_emergency_stop || !safe_after_junction;
 
-    if (vehicle_physics_enabled && !simulation_state.IsDormant(actor_id)) {
+    if (vehicle_physics_enabled && !simulation_state.IsDormantAt(index)) {
       ActuationSignal actuation_signal{0.0f, 0.0f, 0.0f};
 
       const float target_point_distance = std::max(vehicle_speed * TARGET_WAYPOINT_TIME_HORIZON,
                                                   MIN_TARGET_WAYPOINT_DISTANCE);
-      const SimpleWaypointPtr &target_waypoint = GetTargetWaypoint(waypoint_buffer, target_point_distance).first;
-      cg::Location target_location = target_waypoint->GetLocation();
+      const WaypointGraph &graph = local_map->GetGraph();
+      const WaypointIndex target_waypoint = GetTargetWaypoint(graph, waypoint_buffer, target_point_distance).first;
+      cg::Location target_location = graph.GetLocation(target_waypoint);
 
-      float offset = parameters.GetLaneOffset(actor_id);
-      auto right_vector = target_waypoint->GetTransform().GetRightVector();
+      float offset = snapshot.GetVehicle(index).lane_offset;
+      auto right_vector = graph.GetTransform(target_waypoint).GetRightVector();
       auto offset_location = cg::Location(cg::Vector3D(offset*right_vector.x, offset*right_vector.y, 0.0f));
       target_location = target_location + offset_location;
 
@@ -174,14 +183,11 @@ void MotionPlanStage::Update(const unsigned long index) {
       const float angular_deviation = dot_product;
       const float velocity_deviation = (dynamic_target_velocity - vehicle_speed) / dynamic_target_velocity;
       // If previous state for vehicle not found, initialize state entry.
-      if (pid_state_map.find(actor_id) == pid_state_map.end()) {
-        const auto initial_state = StateEntry{current_timestamp, 0.0f, 0.0f, 0.0f};
-        pid_state_map.insert({actor_id, initial_state});
-      }
+      StateEntry &state = GetPIDState(actor_id, current_timestamp);
 
       // Retrieving the previous state.
       traffic_manager::StateEntry previous_state;
-      previous_state = pid_state_map.at(actor_id);
+      previous_state = state;
 
       // Select PID parameters.
       std::vector<float> longitudinal_parameters;
@@ -218,7 +224,6 @@ void MotionPlanStage::Update(const unsigned long index) {
 
       // Updating PID state.
       current_state.steer = actuation_signal.steer;
-      StateEntry &state = pid_state_map.at(actor_id);
       state = current_state;
     }
     // For physics-less vehicles, determine position and orientation for teleportation.
@@ -229,20 +234,18 @@ void MotionPlanStage::Update(const unsigned long index) {
                       0.0f};
 
       // Add entry to teleportation duration clock table if not present.
-      if (teleportation_instance.find(actor_id) == teleportation_instance.end()) {
-        teleportation_instance.insert({actor_id, current_timestamp});
-      }
+      const cc::Timestamp &teleportation_timestamp = GetTeleportationInstance(actor_id, current_timestamp);
 
       // Measuring time elapsed since last teleportation for the vehicle.
-      double elapsed_time = current_timestamp.elapsed_seconds - teleportation_instance.at(actor_id).elapsed_seconds;
+      double elapsed_time = current_timestamp.elapsed_seconds - teleportation_timestamp.elapsed_seconds;
 
       // Find a location ahead of the vehicle for teleportation to achieve intended velocity.
-      if (!emergency_stop && (parameters.GetSynchronousMode() || elapsed_time > HYBRID_MODE_DT)) {
+      if (!emergency_stop && (snapshot.GetSynchronousMode() || elapsed_time > HYBRID_MODE_DT)) {
 
         // Target displacement magnitude to achieve target velocity.
         const float target_displacement = dynamic_target_velocity * HYBRID_MODE_DT_FL;
-        SimpleWaypointPtr teleport_target = waypoint_buffer.front();
-        cg::Transform target_base_transform = teleport_target->GetTransform();
+        const WaypointIndex teleport_target = waypoint_buffer.front();
+        cg::Transform target_base_transform = local_map->GetGraph().GetTransform(teleport_target);
         cg::Location target_base_location = target_base_transform.location;
         cg::Vector3D target_heading = target_base_transform.GetForwardVector();
         cg::Vector3D correct_heading = (target_base_location - vehicle_location).MakeSafeUnitVector(EPSILON);
@@ -258,7 +261,7 @@ void MotionPlanStage::Update(const unsigned long index) {
       // In case of an emergency stop, stay in the same location.
       // Also, teleport only once every dt in asynchronous mode.
       } else {
-        teleportation_transform = cg::Transform(vehicle_location, simulation_state.GetRotation(actor_id));
+        teleportation_transform = cg::Transform(vehicle_location, vehicle_rotation);
       }
       // Constructing the actuation signal.
       output_array.at(index) = carla::rpc::Command::ApplyTransform(actor_id, teleportation_transform);
@@ -267,22 +270,56 @@ void MotionPlanStage::Update(const unsigned long index) {
   }
 }
 
+void MotionPlanStage::BeginParallelUpdate() {
+  deferred_respawns.clear();
+  parallel_update = true;
+}
+
+void MotionPlanStage::EndParallelUpdate() {
+  parallel_update = false;
+  std::sort(deferred_respawns.begin(), deferred_respawns.end());
+  for (const unsigned long index : deferred_respawns) {
+    Update(index);
+  }
+  deferred_respawns.clear();
+}
+
+StateEntry &MotionPlanStage::GetPIDState(const ActorId actor_id, const cc::Timestamp &current_timestamp) {
+  // References to map elements stay valid when other entries are inserted.
+  std::lock_guard<std::mutex> lock(state_mutex);
+  auto it = pid_state_map.find(actor_id);
+  if (it == pid_state_map.end()) {
+    it = pid_state_map.insert({actor_id, StateEntry{current_timestamp, 0.0f, 0.0f, 0.0f}}).first;
+  }
+  return it->second;
+}
+
+cc::Timestamp &MotionPlanStage::GetTeleportationInstance(const ActorId actor_id, const cc::Timestamp &current_timestamp) {
+  std::lock_guard<std::mutex> lock(state_mutex);
+  auto it = teleportation_instance.find(actor_id);
+  if (it == teleportation_instance.end()) {
+    it = teleportation_instance.insert({actor_id, current_timestamp}).first;
+  }
+  return it->second;
+}
+
 bool MotionPlanStage::SafeAfterJunction(const LocalizationData &localization,
                                         const bool tl_hazard,
                                         const bool collision_emergency_stop) {
 
-  SimpleWaypointPtr junction_end_point = localization.junction_end_point;
-  SimpleWaypointPtr safe_point = localization.safe_point;
+  const WaypointGraph &graph = local_map->GetGraph();
+  const WaypointIndex junction_end_point = localization.junction_end_point;
+  const WaypointIndex safe_point = localization.safe_point;
 
   bool safe_after_junction = true;
   if (!tl_hazard && !collision_emergency_stop
       && localization.is_at_junction_entrance
-      && junction_end_point != nullptr && safe_point != nullptr
-      && junction_end_point->DistanceSquared(safe_point) > SQUARE(MIN_SAFE_INTERVAL_LENGTH)) {
+      && junction_end_point != INVALID_WAYPOINT_INDEX && safe_point != INVALID_WAYPOINT_INDEX
+      && graph.DistanceSquared(junction_end_point, safe_point) > SQUARE(MIN_SAFE_INTERVAL_LENGTH)) {
 
-    ActorIdSet passing_safe_point = track_traffic.GetPassingVehicles(safe_point->GetId());
-    ActorIdSet passing_junction_end_point = track_traffic.GetPassingVehicles(junction_end_point->GetId());
-    cg::Location mid_point = (junction_end_point->GetLocation() + safe_point->GetLocation())/2.0f;
+    ActorIdSet passing_safe_point = track_traffic.GetPassingVehicles(safe_point);
+    ActorIdSet passing_junction_end_point = track_traffic.GetPassingVehicles(junction_end_point);
+    cg::Location mid_point = (graph.GetLocation(junction_end_point) + graph.GetLocation(safe_point))/2.0f;
 
     // Only check for vehicles that have the safe point in their passing waypoint, but not
     // the junction end point.
@@ -358,16 +395,16 @@ std::pair<bool, float> MotionPlanStage::CollisionHandling(const CollisionHazardD
   return {collision_emergency_stop, dynamic_target_velocity};
 }
 
-float MotionPlanStage::GetLandmarkTargetVelocity(const SimpleWaypoint& waypoint,
+float MotionPlanStage::GetLandmarkTargetVelocity(const cc::Waypoint& waypoint,
                                                  const cg::Location vehicle_location,
-                                                 const ActorId actor_id,
+                                                 const unsigned long index,
                                                  float max_target_velocity) {
 
     auto const max_distance = LANDMARK_DETECTION_TIME * max_target_velocity;
 
     float landmark_target_velocity = std::numeric_limits<float>::max();
 
-    auto all_landmarks = waypoint.GetWaypoint()->GetAllLandmarksInDistance(max_distance, false);
+    auto all_landmarks = waypoint.GetAllLandmarksInDistance(max_distance, false);
 
     for (auto &landmark: all_landmarks) {
 
@@ -388,7 +425,7 @@ float MotionPlanStage::GetLandmarkTargetVelocity(const SimpleWaypoint& waypoint,
         minimum_velocity = YIELD_TARGET_VELOCITY;
       } else if (landmark_type == "274") {  // Speed limit
         float value = static_cast<float>(landmark->GetValue()) / 3.6f;
-        value = parameters.GetVehicleTargetVelocity(actor_id, value);
+        value = parameters.GetSnapshot().GetVehicleTargetVelocity(index, value);
         minimum_velocity = (value < max_target_velocity) ? value : max_target_velocity;
       } else {
         continue;
@@ -408,13 +445,14 @@ float MotionPlanStage::GetTurnTargetVelocity(const Buffer &waypoint_buffer,
     return max_target_velocity;
   }
   else {
-    const SimpleWaypointPtr first_waypoint = waypoint_buffer.front();
-    const SimpleWaypointPtr last_waypoint = waypoint_buffer.back();
-    const SimpleWaypointPtr middle_waypoint = waypoint_buffer.at(static_cast<uint16_t>(waypoint_buffer.size() / 2));
-
-    float radius = GetThreePointCircleRadius(first_waypoint->GetLocation(),
-                                             middle_waypoint->GetLocation(),
-                                             last_waypoint->GetLocation());
+    const WaypointGraph &graph = local_map->GetGraph();
+    const WaypointIndex first_waypoint = waypoint_buffer.front();
+    const WaypointIndex last_waypoint = waypoint_buffer.back();
+    const WaypointIndex middle_waypoint = waypoint_buffer.at(static_cast<uint16_t>(waypoint_buffer.size() / 2));
+
+    float radius = GetThreePointCircleRadius(graph.GetLocation(first_waypoint),
+                                             graph.GetLocation(middle_waypoint),
+                                             graph.GetLocation(last_waypoint));
 
     // Return the max velocity at the turn
     return std::sqrt(radius * FRICTION * GRAVITY);
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <mutex>
+
 #include "carla/trafficmanager/DataStructures.h"
 #include "carla/trafficmanager/InMemoryMap.h"
 #include "carla/trafficmanager/LocalizationUtils.h"
@@ -40,10 +42,21 @@ private:
   // Structure to keep track of duration between teleportation
   // in hybrid physics mode.
   std::unordered_map<ActorId, cc::Timestamp> teleportation_instance;
+  // Guards insertions in pid_state_map and teleportation_instance.
+  std::mutex state_mutex;
   ControlFrame &output_array;
-  cc::Timestamp current_timestamp;
-  RandomGenerator &random_device;
+  RandomGeneratorMap &random_devices;
   const LocalMapPtr &local_map;
+  // Whether vehicles are being updated concurrently.
+  bool parallel_update = false;
+  // Dormant vehicles to respawn once the parallel update is over. They are
+  // handled sequentially because they compete for free geodesic grids.
+  std::vector<unsigned long> deferred_respawns;
+  std::mutex respawn_mutex;
+
+  StateEntry &GetPIDState(const ActorId actor_id, const cc::Timestamp &current_timestamp);
+
+  cc::Timestamp &GetTeleportationInstance(const ActorId actor_id, const cc::Timestamp &current_timestamp);
 
   std::pair<bool, float> CollisionHandling(const CollisionHazardData &collision_hazard,
                                            const bool tl_hazard,
@@ -55,9 +68,9 @@ private:
                          const bool tl_hazard,
                          const bool collision_emergency_stop);
 
-  float GetLandmarkTargetVelocity(const SimpleWaypoint& waypoint,
+  float GetLandmarkTargetVelocity(const cc::Waypoint& waypoint,
                                   const cg::Location vehicle_location,
-                                  const ActorId actor_id,
+                                  const unsigned long index,
                                   float max_target_velocity);
 
   float GetTurnTargetVelocity(const Buffer &waypoint_buffer,
@@ -82,11 +95,19 @@ public:
                   const TLFrame &tl_frame,
                   const cc::World &world,
                   ControlFrame &output_array,
-                  RandomGenerator &random_device,
+                  RandomGeneratorMap &random_devices,
                   const LocalMapPtr &local_map);
 
   void Update(const unsigned long index);
 
+  /// Prepares the stage for Update to be called concurrently for different
+  /// vehicles.
+  void BeginParallelUpdate();
+
+  /// Respawns, in vehicle order, the dormant vehicles found during the
+  /// parallel update.
+  void EndParallelUpdate();
+
   void RemoveActor(const ActorId actor_id);
 
   void Reset();
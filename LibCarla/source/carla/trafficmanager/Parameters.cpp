@@ -7,6 +7,8 @@
 #include "carla/trafficmanager/Parameters.h"
 #include "carla/trafficmanager/Constants.h"
 
+#include <algorithm>
+
 namespace carla {
 namespace traffic_manager {
 
@@ -193,6 +195,10 @@ void Parameters::SetOSMMode(const bool mode_switch) {
   osm_mode.store(mode_switch);
 }
 
+void Parameters::SetWorkerThreads(const uint32_t count) {
+  worker_threads.store(std::max(count, 1u));
+}
+
 void Parameters::SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer) {
   const auto entry = std::make_pair(actor->GetId(), path);
   custom_path.AddEntry(entry);
@@ -235,6 +241,117 @@ void Parameters::UpdateImportedRoute(const ActorId &actor_id, const Route route)
   custom_route.AddEntry(entry);
 }
 
+//////////////////////////////////// SNAPSHOT /////////////////////////////////
+
+float ParameterSnapshot::GetVehicleTargetVelocity(const size_t index, const float speed_limit) const {
+
+  const VehicleParameters &vehicle = vehicles.at(index);
+  if (vehicle.desired_speed >= 0.0f) {
+    return vehicle.desired_speed;
+  }
+  return speed_limit * (1.0f - vehicle.percentage_speed_difference / 100.0f);
+}
+
+bool ParameterSnapshot::GetCollisionDetection(const size_t index, const ActorId other_actor_id) const {
+
+  return !std::binary_search(
+      ignored_collisions.begin(),
+      ignored_collisions.end(),
+      std::make_pair(index, other_actor_id));
+}
+
+void Parameters::UpdateSnapshot(const std::vector<ActorId> &vehicle_ids) {
+
+  snapshot_indices.clear();
+  for (size_t index = 0u; index < vehicle_ids.size(); ++index) {
+    snapshot_indices.emplace(vehicle_ids[index], index);
+  }
+
+  // Start from the global values, then apply the ones set for each vehicle.
+  // Every map is locked once instead of once per vehicle and query.
+  VehicleParameters defaults;
+  defaults.percentage_speed_difference = global_percentage_difference_from_limit.load();
+  defaults.lane_offset = global_lane_offset.load();
+  defaults.distance_to_leading_vehicle = distance_margin.load();
+  snapshot.vehicles.assign(vehicle_ids.size(), defaults);
+
+  auto apply = [this](const auto &map, auto member) {
+    map.ForEach([this, member](const ActorId actor_id, const auto &value) {
+      const auto it = snapshot_indices.find(actor_id);
+      if (it != snapshot_indices.end()) {
+        snapshot.vehicles[it->second].*member = value;
+      }
+    });
+  };
+  apply(exact_desired_speed, &VehicleParameters::desired_speed);
+  apply(lane_offset, &VehicleParameters::lane_offset);
+  apply(distance_to_leading_vehicle, &VehicleParameters::distance_to_leading_vehicle);
+  apply(auto_lane_change, &VehicleParameters::auto_lane_change);
+  apply(perc_run_traffic_light, &VehicleParameters::perc_run_traffic_light);
+  apply(perc_run_traffic_sign, &VehicleParameters::perc_run_traffic_sign);
+  apply(perc_ignore_walkers, &VehicleParameters::perc_ignore_walkers);
+  apply(perc_ignore_vehicles, &VehicleParameters::perc_ignore_vehicles);
+  apply(perc_keep_right, &VehicleParameters::perc_keep_right);
+  apply(perc_random_left, &VehicleParameters::perc_random_left);
+  apply(perc_random_right, &VehicleParameters::perc_random_right);
+  apply(auto_update_vehicle_lights, &VehicleParameters::auto_update_vehicle_lights);
+
+  // A percentage takes precedence over a desired speed.
+  percentage_difference_from_speed_limit.ForEach([this](const ActorId actor_id, const float percentage) {
+    const auto it = snapshot_indices.find(actor_id);
+    if (it != snapshot_indices.end()) {
+      VehicleParameters &vehicle = snapshot.vehicles[it->second];
+      vehicle.percentage_speed_difference = percentage;
+      vehicle.desired_speed = -1.0f;
+    }
+  });
+
+  // Force lane change commands are consumed by the snapshot.
+  force_lane_change.RemoveIf([this](const ActorId actor_id, const ChangeLaneInfo &info) {
+    const auto it = snapshot_indices.find(actor_id);
+    if (it == snapshot_indices.end()) {
+      return false;
+    }
+    snapshot.vehicles[it->second].force_lane_change = info;
+    return true;
+  });
+
+  custom_path.ForEach([this](const ActorId actor_id, const Path &path) {
+    const auto it = snapshot_indices.find(actor_id);
+    if (it != snapshot_indices.end()) {
+      snapshot.vehicles[it->second].has_custom_path = !path.empty();
+    }
+  });
+  custom_route.ForEach([this](const ActorId actor_id, const Route &route) {
+    const auto it = snapshot_indices.find(actor_id);
+    if (it != snapshot_indices.end()) {
+      snapshot.vehicles[it->second].has_imported_route = !route.empty();
+    }
+  });
+
+  snapshot.ignored_collisions.clear();
+  ignore_collision.ForEach([this](const ActorId actor_id, const std::shared_ptr<AtomicActorSet> &actor_set) {
+    const auto it = snapshot_indices.find(actor_id);
+    if (it != snapshot_indices.end()) {
+      for (const ActorId other_actor_id : actor_set->GetIDList()) {
+        snapshot.ignored_collisions.emplace_back(it->second, other_actor_id);
+      }
+    }
+  });
+  std::sort(snapshot.ignored_collisions.begin(), snapshot.ignored_collisions.end());
+
+  snapshot.synchronous_mode = synchronous_mode.load();
+  snapshot.osm_mode = osm_mode.load();
+  snapshot.respawn_dormant_vehicles = respawn_dormant_vehicles.load();
+  snapshot.respawn_lower_bound = respawn_lower_bound.load();
+  snapshot.respawn_upper_bound = respawn_upper_bound.load();
+}
+
+const ParameterSnapshot &Parameters::GetSnapshot() const {
+
+  return snapshot;
+}
+
 //////////////////////////////////// GETTERS //////////////////////////////////
 
 float Parameters::GetHybridPhysicsRadius() const {
@@ -434,6 +551,11 @@ bool Parameters::GetOSMMode() const {
   return osm_mode.load();
 }
 
+uint32_t Parameters::GetWorkerThreads() const {
+
+  return worker_threads.load();
+}
+
 bool Parameters::GetUploadPath(const ActorId &actor_id) const {
 
   bool custom_path_bool = false;
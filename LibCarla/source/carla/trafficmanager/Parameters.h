@@ -10,6 +10,8 @@
 #include <chrono>
 #include <random>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "carla/client/Actor.h"
 #include "carla/client/Vehicle.h"
@@ -34,6 +36,89 @@ struct ChangeLaneInfo {
   bool direction = false;
 };
 
+/// Parameters of a registered vehicle, with the global values already
+/// applied where the vehicle has no specific one.
+struct VehicleParameters {
+  /// % difference from the speed limit, used if there is no desired speed.
+  float percentage_speed_difference = 0.0f;
+  /// Exact desired velocity, negative if not set.
+  float desired_speed = -1.0f;
+  float lane_offset = 0.0f;
+  float distance_to_leading_vehicle = 0.0f;
+  ChangeLaneInfo force_lane_change;
+  bool auto_lane_change = true;
+  float perc_run_traffic_light = 0.0f;
+  float perc_run_traffic_sign = 0.0f;
+  float perc_ignore_walkers = 0.0f;
+  float perc_ignore_vehicles = 0.0f;
+  float perc_keep_right = -1.0f;
+  float perc_random_left = -1.0f;
+  float perc_random_right = -1.0f;
+  bool auto_update_vehicle_lights = false;
+  /// Whether a custom path or route is set, they are retrieved from the
+  /// Parameters only in that case.
+  bool has_custom_path = false;
+  bool has_imported_route = false;
+};
+
+/// Immutable copy of the parameters taken at the beginning of every cycle
+/// of the traffic manager. The stages read it without locking, indexed the
+/// same as the vehicle list, while the changes made in the meantime through
+/// the Parameters are applied in the snapshot of the next cycle.
+class ParameterSnapshot {
+
+  friend class Parameters;
+
+private:
+  std::vector<VehicleParameters> vehicles;
+  /// Pairs of vehicle index and actor ignored by that vehicle during
+  /// collision detection, sorted.
+  std::vector<std::pair<size_t, ActorId>> ignored_collisions;
+  bool synchronous_mode = false;
+  bool osm_mode = true;
+  bool respawn_dormant_vehicles = false;
+  float respawn_lower_bound = 0.0f;
+  float respawn_upper_bound = 0.0f;
+
+public:
+  /// Parameters of the vehicle at @a index in the vehicle list.
+  const VehicleParameters &GetVehicle(const size_t index) const {
+    return vehicles.at(index);
+  }
+
+  /// Number of vehicles in the snapshot.
+  size_t Size() const {
+    return vehicles.size();
+  }
+
+  /// Method to query target velocity for the vehicle at @a index.
+  float GetVehicleTargetVelocity(const size_t index, const float speed_limit) const;
+
+  /// Method to query collision avoidance rule between the vehicle at
+  /// @a index and another actor.
+  bool GetCollisionDetection(const size_t index, const ActorId other_actor_id) const;
+
+  bool GetSynchronousMode() const {
+    return synchronous_mode;
+  }
+
+  bool GetOSMMode() const {
+    return osm_mode;
+  }
+
+  bool GetRespawnDormantVehicles() const {
+    return respawn_dormant_vehicles;
+  }
+
+  float GetLowerBoundaryRespawnDormantVehicles() const {
+    return respawn_lower_bound;
+  }
+
+  float GetUpperBoundaryRespawnDormantVehicles() const {
+    return respawn_upper_bound;
+  }
+};
+
 class Parameters {
 
 private:
@@ -44,9 +129,9 @@ private:
   /// Target velocity map for individual vehicles, based on a desired velocity.
   AtomicMap<ActorId, float> exact_desired_speed;
   /// Global target velocity limit % difference.
-  float global_percentage_difference_from_limit = 0;
+  std::atomic<float> global_percentage_difference_from_limit{0.0f};
   /// Global lane offset
-  float global_lane_offset = 0;
+  std::atomic<float> global_lane_offset{0.0f};
   /// Map containing a set of actors to be ignored during collision detection.
   AtomicMap<ActorId, std::shared_ptr<AtomicActorSet>> ignore_collision;
   /// Map containing distance to leading vehicle command.
@@ -91,6 +176,8 @@ private:
   std::atomic<float> hybrid_physics_radius {70.0};
   /// Parameter specifying Open Street Map mode.
   std::atomic<bool> osm_mode {true};
+  /// Number of threads running the stages.
+  std::atomic<uint32_t> worker_threads {1u};
   /// Parameter specifying if importing a custom path.
   AtomicMap<ActorId, bool> upload_path;
   /// Structure to hold all custom paths.
@@ -99,6 +186,10 @@ private:
   AtomicMap<ActorId, bool> upload_route;
   /// Structure to hold all custom routes.
   AtomicMap<ActorId, Route> custom_route;
+  /// Snapshot of the parameters for the current cycle.
+  ParameterSnapshot snapshot;
+  /// Index of every vehicle in the snapshot, kept to reuse its memory.
+  std::unordered_map<ActorId, size_t> snapshot_indices;
 
 public:
   Parameters();
@@ -184,6 +275,9 @@ public:
   /// Method to set Open Street Map mode.
   void SetOSMMode(const bool mode_switch);
 
+  /// Method to set the number of threads running the stages.
+  void SetWorkerThreads(const uint32_t count);
+
   /// Method to set if we are automatically respawning vehicles.
   void SetRespawnDormantVehicles(const bool mode_switch);
 
@@ -211,6 +305,16 @@ public:
   /// Method to update an already set route.
   void UpdateImportedRoute(const ActorId &actor_id, const Route route);
 
+  ///////////////////////////////// SNAPSHOT ////////////////////////////////////
+
+  /// Method to take the snapshot of the parameters for the vehicles in
+  /// @a vehicle_ids. To be called at the beginning of every cycle, before
+  /// the stages run, from the thread running the traffic manager.
+  void UpdateSnapshot(const std::vector<ActorId> &vehicle_ids);
+
+  /// Method to get the snapshot of the parameters for the current cycle.
+  const ParameterSnapshot &GetSnapshot() const;
+
   ///////////////////////////////// GETTERS /////////////////////////////////////
 
   /// Method to retrieve hybrid physics radius.
@@ -279,6 +383,9 @@ public:
   /// Method to get Open Street Map mode.
   bool GetOSMMode() const;
 
+  /// Method to get the number of threads running the stages.
+  uint32_t GetWorkerThreads() const;
+
   /// Method to get if we are uploading a path.
   bool GetUploadPath(const ActorId &actor_id) const;
 
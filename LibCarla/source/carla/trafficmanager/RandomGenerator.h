@@ -1,8 +1,9 @@
-
 #pragma once
 
 #include <random>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "carla/rpc/ActorId.h"
 
@@ -12,11 +13,47 @@ namespace traffic_manager {
 class RandomGenerator {
 public:
     RandomGenerator(const uint64_t seed): mt(std::mt19937(seed)), dist(0.0, 100.0) {}
+    RandomGenerator(std::seed_seq &seed): mt(std::mt19937(seed)), dist(0.0, 100.0) {}
     double next() { return dist(mt); }
 private:
     std::mt19937 mt;
     std::uniform_real_distribution<double> dist;
 };
 
+/// Holds one random generator per vehicle, each seeded from the traffic
+/// manager seed and the vehicle id. The numbers drawn for a vehicle then do
+/// not depend on the order in which vehicles are processed, so results are
+/// reproducible when the stages run on several threads.
+class RandomGeneratorMap {
+public:
+    RandomGeneratorMap(const uint64_t _seed): seed(_seed) {}
+
+    /// Creates the generators of new vehicles and drops those of vehicles no
+    /// longer in the list. Must not run concurrently with at().
+    void Update(const std::vector<ActorId> &vehicle_id_list) {
+        for (const ActorId actor_id : vehicle_id_list) {
+            if (generators.find(actor_id) == generators.end()) {
+                std::seed_seq vehicle_seed{static_cast<uint32_t>(seed),
+                                           static_cast<uint32_t>(seed >> 32),
+                                           static_cast<uint32_t>(actor_id)};
+                generators.emplace(actor_id, RandomGenerator(vehicle_seed));
+            }
+        }
+        if (generators.size() > vehicle_id_list.size()) {
+            const std::unordered_set<ActorId> current_ids(vehicle_id_list.begin(), vehicle_id_list.end());
+            for (auto it = generators.begin(); it != generators.end();) {
+                it = current_ids.count(it->first) ? std::next(it) : generators.erase(it);
+            }
+        }
+    }
+
+    /// Random generator of a vehicle present in the last Update.
+    RandomGenerator &at(const ActorId actor_id) { return generators.at(actor_id); }
+
+private:
+    uint64_t seed;
+    std::unordered_map<ActorId, RandomGenerator> generators;
+};
+
 } // namespace traffic_manager
 } // namespace carla
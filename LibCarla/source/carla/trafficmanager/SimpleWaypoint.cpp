@@ -84,6 +84,13 @@ namespace traffic_manager {
     }
   }
 
+  void SimpleWaypoint::ClearLinks() {
+    next_waypoints.clear();
+    previous_waypoints.clear();
+    next_left_waypoint.reset();
+    next_right_waypoint.reset();
+  }
+
   float SimpleWaypoint::Distance(const cg::Location &location) const {
     return GetLocation().Distance(location);
   }
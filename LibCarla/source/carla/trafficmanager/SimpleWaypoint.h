@@ -93,6 +93,10 @@ namespace traffic_manager {
     /// This method is used to set the closest right waypoint for a lane change.
     void SetRightWaypoint(SimpleWaypointPtr &waypoint);
 
+    /// This method is used to remove the links to the other waypoints, which
+    /// otherwise keep each other alive.
+    void ClearLinks();
+
     /// This method is used to get the closest left waypoint for a lane change.
     SimpleWaypointPtr GetLeftWaypoint();
 
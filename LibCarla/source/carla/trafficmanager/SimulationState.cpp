@@ -1,4 +1,6 @@
 
+#include <utility>
+
 #include "carla/trafficmanager/SimulationState.h"
 
 namespace carla {
@@ -10,93 +12,192 @@ void SimulationState::AddActor(ActorId actor_id,
                                KinematicState kinematic_state,
                                StaticAttributes attributes,
                                TrafficLightState tl_state) {
-  actor_set.insert(actor_id);
-  kinematic_state_map.insert({actor_id, kinematic_state});
-  static_attribute_map.insert({actor_id, attributes});
-  tl_state_map.insert({actor_id, tl_state});
+  if (ContainsActor(actor_id)) {
+    return;
+  }
+  const size_t slot = actor_ids.size();
+  actor_slots.insert({actor_id, slot});
+  actor_ids.push_back(actor_id);
+  locations.emplace_back();
+  rotations.emplace_back();
+  headings.emplace_back();
+  velocities.emplace_back();
+  speed_limits.emplace_back();
+  physics_enabled.emplace_back();
+  is_dormant.emplace_back();
+  hybrid_end_locations.emplace_back();
+  SetKinematicState(slot, kinematic_state);
+  tl_states.push_back(tl_state);
+  actor_types.push_back(attributes.actor_type);
+  dimensions.emplace_back(attributes.half_length, attributes.half_width, attributes.half_height);
 }
 
 bool SimulationState::ContainsActor(ActorId actor_id) const {
-  return actor_set.find(actor_id) != actor_set.end();
+  return actor_slots.find(actor_id) != actor_slots.end();
 }
 
 void SimulationState::RemoveActor(ActorId actor_id) {
-  actor_set.erase(actor_id);
-  kinematic_state_map.erase(actor_id);
-  static_attribute_map.erase(actor_id);
-  tl_state_map.erase(actor_id);
+  auto slot_entry = actor_slots.find(actor_id);
+  if (slot_entry == actor_slots.end()) {
+    return;
+  }
+  // Move the last actor to the freed slot to keep the arrays dense.
+  const size_t slot = slot_entry->second;
+  const size_t last_slot = actor_ids.size() - 1u;
+  if (slot != last_slot) {
+    SwapSlots(slot, last_slot);
+  }
+  actor_slots.erase(actor_id);
+  actor_ids.pop_back();
+  locations.pop_back();
+  rotations.pop_back();
+  headings.pop_back();
+  velocities.pop_back();
+  speed_limits.pop_back();
+  physics_enabled.pop_back();
+  is_dormant.pop_back();
+  hybrid_end_locations.pop_back();
+  tl_states.pop_back();
+  actor_types.pop_back();
+  dimensions.pop_back();
 }
 
 void SimulationState::Reset() {
-  actor_set.clear();
-  kinematic_state_map.clear();
-  static_attribute_map.clear();
-  tl_state_map.clear();
+  actor_slots.clear();
+  actor_ids.clear();
+  locations.clear();
+  rotations.clear();
+  headings.clear();
+  velocities.clear();
+  speed_limits.clear();
+  physics_enabled.clear();
+  is_dormant.clear();
+  hybrid_end_locations.clear();
+  tl_states.clear();
+  actor_types.clear();
+  dimensions.clear();
+}
+
+size_t SimulationState::ArrangeSlots(const std::vector<ActorId> &ordered_actor_ids) {
+  // Slots before the next one already hold the actors arranged so far, so the
+  // slot of the next actor is never lower than it.
+  size_t next_slot = 0u;
+  for (const ActorId actor_id : ordered_actor_ids) {
+    auto slot_entry = actor_slots.find(actor_id);
+    if (slot_entry == actor_slots.end()) {
+      continue;
+    }
+    SwapSlots(next_slot, slot_entry->second);
+    ++next_slot;
+  }
+  return next_slot;
+}
+
+size_t SimulationState::GetSlot(const ActorId actor_id) const {
+  return actor_slots.at(actor_id);
+}
+
+ActorId SimulationState::GetActorId(const size_t slot) const {
+  return actor_ids.at(slot);
+}
+
+size_t SimulationState::Size() const {
+  return actor_ids.size();
+}
+
+void SimulationState::SetKinematicState(const size_t slot, const KinematicState &state) {
+  locations[slot] = state.location;
+  rotations[slot] = state.rotation;
+  headings[slot] = state.rotation.GetForwardVector();
+  velocities[slot] = state.velocity;
+  speed_limits[slot] = state.speed_limit;
+  physics_enabled[slot] = state.physics_enabled;
+  is_dormant[slot] = state.is_dormant;
+  hybrid_end_locations[slot] = state.hybrid_end_location;
+}
+
+void SimulationState::SwapSlots(const size_t slot_1, const size_t slot_2) {
+  if (slot_1 == slot_2) {
+    return;
+  }
+  std::swap(actor_ids[slot_1], actor_ids[slot_2]);
+  actor_slots[actor_ids[slot_1]] = slot_1;
+  actor_slots[actor_ids[slot_2]] = slot_2;
+  std::swap(locations[slot_1], locations[slot_2]);
+  std::swap(rotations[slot_1], rotations[slot_2]);
+  std::swap(headings[slot_1], headings[slot_2]);
+  std::swap(velocities[slot_1], velocities[slot_2]);
+  std::swap(speed_limits[slot_1], speed_limits[slot_2]);
+  std::swap(physics_enabled[slot_1], physics_enabled[slot_2]);
+  std::swap(is_dormant[slot_1], is_dormant[slot_2]);
+  std::swap(hybrid_end_locations[slot_1], hybrid_end_locations[slot_2]);
+  std::swap(tl_states[slot_1], tl_states[slot_2]);
+  std::swap(actor_types[slot_1], actor_types[slot_2]);
+  std::swap(dimensions[slot_1], dimensions[slot_2]);
 }
 
 void SimulationState::UpdateKinematicState(ActorId actor_id, KinematicState state) {
-  kinematic_state_map.at(actor_id) = state;
+  SetKinematicState(actor_slots.at(actor_id), state);
 }
 
 void SimulationState::UpdateKinematicHybridEndLocation(ActorId actor_id, cg::Location location) {
-  kinematic_state_map.at(actor_id).hybrid_end_location = location;
+  hybrid_end_locations[actor_slots.at(actor_id)] = location;
 }
 
 void SimulationState::UpdateTrafficLightState(ActorId actor_id, TrafficLightState state) {
   // The green-yellow state transition is not notified to the vehicle. This is done to avoid
   // having vehicles stopped very near the intersection when only the rear part of the vehicle
   // is colliding with the trigger volume of the traffic light.
-  auto previous_tl_state = GetTLS(actor_id);
+  TrafficLightState &previous_tl_state = tl_states[actor_slots.at(actor_id)];
   if (previous_tl_state.at_traffic_light && previous_tl_state.tl_state == TLS::Green) {
     state.tl_state = TLS::Green;
   }
 
-  tl_state_map.at(actor_id) = state;
+  previous_tl_state = state;
 }
 
 cg::Location SimulationState::GetLocation(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).location;
+  return locations[actor_slots.at(actor_id)];
 }
 
 cg::Location SimulationState::GetHybridEndLocation(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).hybrid_end_location;
+  return hybrid_end_locations[actor_slots.at(actor_id)];
 }
 
 cg::Rotation SimulationState::GetRotation(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).rotation;
+  return rotations[actor_slots.at(actor_id)];
 }
 
 cg::Vector3D SimulationState::GetHeading(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).rotation.GetForwardVector();
+  return headings[actor_slots.at(actor_id)];
 }
 
 cg::Vector3D SimulationState::GetVelocity(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).velocity;
+  return velocities[actor_slots.at(actor_id)];
 }
 
 float SimulationState::GetSpeedLimit(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).speed_limit;
+  return speed_limits[actor_slots.at(actor_id)];
 }
 
 bool SimulationState::IsPhysicsEnabled(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).physics_enabled;
+  return physics_enabled[actor_slots.at(actor_id)] != 0u;
 }
 
 bool SimulationState::IsDormant(ActorId actor_id) const {
-  return kinematic_state_map.at(actor_id).is_dormant;
+  return is_dormant[actor_slots.at(actor_id)] != 0u;
 }
 
 TrafficLightState SimulationState::GetTLS(ActorId actor_id) const {
-  return tl_state_map.at(actor_id);
+  return tl_states[actor_slots.at(actor_id)];
 }
 
 ActorType SimulationState::GetType(ActorId actor_id) const {
-  return static_attribute_map.at(actor_id).actor_type;
+  return actor_types[actor_slots.at(actor_id)];
 }
 
 cg::Vector3D SimulationState::GetDimensions(ActorId actor_id) const {
-  const StaticAttributes &attributes = static_attribute_map.at(actor_id);
-  return cg::Vector3D(attributes.half_length, attributes.half_width, attributes.half_height);
+  return dimensions[actor_slots.at(actor_id)];
 }
 
 } // namespace  traffic_manager
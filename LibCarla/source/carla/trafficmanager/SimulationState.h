@@ -1,7 +1,8 @@
 
 #pragma once
 
-#include <unordered_set>
+#include <unordered_map>
+#include <vector>
 
 #include "carla/trafficmanager/DataStructures.h"
 
@@ -23,13 +24,11 @@ struct KinematicState {
   bool is_dormant;
   cg::Location hybrid_end_location;
 };
-using KinematicStateMap = std::unordered_map<ActorId, KinematicState>;
 
 struct TrafficLightState {
   TLS tl_state;
   bool at_traffic_light;
 };
-using TrafficLightStateMap = std::unordered_map<ActorId, TrafficLightState>;
 
 struct StaticAttributes {
   ActorType actor_type;
@@ -37,20 +36,35 @@ struct StaticAttributes {
   float half_width;
   float half_height;
 };
-using StaticAttributeMap = std::unordered_map<ActorId, StaticAttributes>;
 
 /// This class holds the state of all the vehicles in the simlation.
+/// The state is stored in dense arrays indexed by slot, with a table mapping
+/// every actor to its slot. After ArrangeSlots the slot of every registered
+/// vehicle matches its index in the vehicle list used by the stages, so that
+/// the stages can read the state of the vehicle they update by index.
 class SimulationState {
 
 private:
-  // Structure to hold ids of all actors in the simulation.
-  std::unordered_set<ActorId> actor_set;
-  // Structure containing dynamic motion related state of actors.
-  KinematicStateMap kinematic_state_map;
-  // Structure containing static attributes of actors.
-  StaticAttributeMap static_attribute_map;
-  // Structure containing dynamic traffic light related state of actors.
-  TrafficLightStateMap tl_state_map;
+  // Slot of every actor in the simulation state.
+  std::unordered_map<ActorId, size_t> actor_slots;
+  // Per-slot arrays, all of them with one element per actor.
+  std::vector<ActorId> actor_ids;
+  std::vector<cg::Location> locations;
+  std::vector<cg::Rotation> rotations;
+  // Forward vector of each rotation, computed when the rotation is updated.
+  std::vector<cg::Vector3D> headings;
+  std::vector<cg::Vector3D> velocities;
+  std::vector<float> speed_limits;
+  std::vector<uint8_t> physics_enabled;
+  std::vector<uint8_t> is_dormant;
+  std::vector<cg::Location> hybrid_end_locations;
+  std::vector<TrafficLightState> tl_states;
+  std::vector<ActorType> actor_types;
+  std::vector<cg::Vector3D> dimensions;
+
+  void SetKinematicState(const size_t slot, const KinematicState &state);
+
+  void SwapSlots(const size_t slot_1, const size_t slot_2);
 
 public :
   SimulationState();
@@ -70,6 +84,21 @@ public :
   // Method to flush all states and actors.
   void Reset();
 
+  // Method to move the given actors to the first slots, in the order of the
+  // list. Actors not present are skipped, so the slot of the i-th actor in
+  // the list is i only if all of them are present. Returns the number of
+  // actors arranged.
+  size_t ArrangeSlots(const std::vector<ActorId> &ordered_actor_ids);
+
+  // Method to get the slot of an actor.
+  size_t GetSlot(const ActorId actor_id) const;
+
+  // Method to get the actor occupying a slot.
+  ActorId GetActorId(const size_t slot) const;
+
+  // Number of actors in the simulation state.
+  size_t Size() const;
+
   void UpdateKinematicState(ActorId actor_id, KinematicState state);
 
   void UpdateKinematicHybridEndLocation(ActorId actor_id, cg::Location location);
@@ -100,6 +129,48 @@ public :
 
   cg::Vector3D GetDimensions(const ActorId actor_id) const;
 
+  // Accessors by slot, avoiding the lookup of the actor's slot.
+
+  const cg::Location &GetLocationAt(const size_t slot) const {
+    return locations[slot];
+  }
+
+  const cg::Rotation &GetRotationAt(const size_t slot) const {
+    return rotations[slot];
+  }
+
+  const cg::Vector3D &GetHeadingAt(const size_t slot) const {
+    return headings[slot];
+  }
+
+  const cg::Vector3D &GetVelocityAt(const size_t slot) const {
+    return velocities[slot];
+  }
+
+  float GetSpeedLimitAt(const size_t slot) const {
+    return speed_limits[slot];
+  }
+
+  bool IsPhysicsEnabledAt(const size_t slot) const {
+    return physics_enabled[slot] != 0u;
+  }
+
+  bool IsDormantAt(const size_t slot) const {
+    return is_dormant[slot] != 0u;
+  }
+
+  const TrafficLightState &GetTLSAt(const size_t slot) const {
+    return tl_states[slot];
+  }
+
+  ActorType GetTypeAt(const size_t slot) const {
+    return actor_types[slot];
+  }
+
+  const cg::Vector3D &GetDimensionsAt(const size_t slot) const {
+    return dimensions[slot];
+  }
+
 };
 
 } // namespace traffic_manager
@@ -12,16 +12,17 @@ using constants::TrackTraffic::INV_BUFFER_STEP_THROUGH;
 TrackTraffic::TrackTraffic() {}
 
 void TrackTraffic::UpdateUnregisteredGridPosition(const ActorId actor_id,
-                                                  const std::vector<SimpleWaypointPtr> waypoints) {
+                                                  const std::vector<WaypointIndex> &waypoints,
+                                                  const WaypointGraph &graph) {
 
     DeleteActor(actor_id);
 
     std::unordered_set<GeoGridId> current_grids;
     // Step through waypoints and update grid list for actor and actor list for grids.
-    for (auto &waypoint : waypoints) {
-        UpdatePassingVehicle(waypoint->GetId(), actor_id);
+    for (const WaypointIndex waypoint : waypoints) {
+        UpdatePassingVehicle(waypoint, actor_id);
 
-        GeoGridId ggid = waypoint->GetGeodesicGridId();
+        GeoGridId ggid = graph.GetGeodesicGridId(waypoint);
         current_grids.insert(ggid);
 
         if (grid_to_actors.find(ggid) != grid_to_actors.end()) {
@@ -37,44 +38,83 @@ void TrackTraffic::UpdateUnregisteredGridPosition(const ActorId actor_id,
     actor_to_grids.insert({actor_id, current_grids});
 }
 
-void TrackTraffic::UpdateGridPosition(const ActorId actor_id, const Buffer &buffer) {
+void TrackTraffic::UpdateGridPosition(const ActorId actor_id, const Buffer &buffer, const WaypointGraph &graph) {
     if (!buffer.empty()) {
 
-        // Clear current actor from all grids containing itself.
-        if (actor_to_grids.find(actor_id) != actor_to_grids.end()) {
-            std::unordered_set<GeoGridId> &current_grids = actor_to_grids.at(actor_id);
-            for (auto &grid_id : current_grids) {
-                if (grid_to_actors.find(grid_id) != grid_to_actors.end()) {
-                    ActorIdSet &actor_ids = grid_to_actors.at(grid_id);
-                    actor_ids.erase(actor_id);
-                }
-            }
+        // Step through buffer and collect the grids occupied by the actor.
+        std::unordered_set<GeoGridId> current_grids;
+        for (const WaypointIndex waypoint : buffer) {
+            current_grids.insert(graph.GetGeodesicGridId(waypoint));
+        }
 
-            actor_to_grids.erase(actor_id);
+        if (deferred) {
+            DeferredUpdates &updates = deferred_updates.at(actor_id);
+            updates.update_grids = true;
+            updates.grids = std::move(current_grids);
+        } else {
+            ApplyGridPosition(actor_id, std::move(current_grids));
         }
+    }
+}
 
-        // Step through buffer and update grid list for actor and actor list for grids.
-        std::unordered_set<GeoGridId> current_grids;
-        uint64_t buffer_size = buffer.size();
-        for (uint64_t i = 0u; i <= buffer_size - 1u; ++i) {
-            auto waypoint = buffer.at(i);
-            GeoGridId ggid = waypoint->GetGeodesicGridId();
-            current_grids.insert(ggid);
-            // Add grid entry if not present.
-            if (grid_to_actors.find(ggid) == grid_to_actors.end()) {
-                grid_to_actors.insert({ggid, {}});
-            }
+void TrackTraffic::ApplyGridPosition(const ActorId actor_id, std::unordered_set<GeoGridId> &&current_grids) {
 
-            ActorIdSet &actor_ids = grid_to_actors.at(ggid);
-            if (actor_ids.find(actor_id) == actor_ids.end()) {
-                actor_ids.insert(actor_id);
+    // Clear current actor from all grids containing itself.
+    if (actor_to_grids.find(actor_id) != actor_to_grids.end()) {
+        std::unordered_set<GeoGridId> &previous_grids = actor_to_grids.at(actor_id);
+        for (auto &grid_id : previous_grids) {
+            if (grid_to_actors.find(grid_id) != grid_to_actors.end()) {
+                ActorIdSet &actor_ids = grid_to_actors.at(grid_id);
+                actor_ids.erase(actor_id);
             }
         }
 
-        actor_to_grids.insert({actor_id, current_grids});
+        actor_to_grids.erase(actor_id);
     }
+
+    // Update actor list for grids.
+    for (const GeoGridId ggid : current_grids) {
+        // Add grid entry if not present.
+        if (grid_to_actors.find(ggid) == grid_to_actors.end()) {
+            grid_to_actors.insert({ggid, {}});
+        }
+
+        ActorIdSet &actor_ids = grid_to_actors.at(ggid);
+        if (actor_ids.find(actor_id) == actor_ids.end()) {
+            actor_ids.insert(actor_id);
+        }
+    }
+
+    actor_to_grids.insert({actor_id, std::move(current_grids)});
 }
 
+void TrackTraffic::BeginDeferredUpdates(const std::vector<ActorId> &vehicle_id_list) {
+    deferred_actors = vehicle_id_list;
+    deferred_updates.clear();
+    for (const ActorId actor_id : deferred_actors) {
+        deferred_updates[actor_id];
+    }
+    deferred = true;
+}
+
+void TrackTraffic::CommitDeferredUpdates() {
+    deferred = false;
+    for (const ActorId actor_id : deferred_actors) {
+        DeferredUpdates &updates = deferred_updates.at(actor_id);
+        for (const auto &passing_waypoint : updates.passing_waypoints) {
+            if (passing_waypoint.second) {
+                ApplyPassingVehicle(passing_waypoint.first, actor_id);
+            } else {
+                ApplyRemovePassingVehicle(passing_waypoint.first, actor_id);
+            }
+        }
+        if (updates.update_grids) {
+            ApplyGridPosition(actor_id, std::move(updates.grids));
+        }
+    }
+    deferred_actors.clear();
+    deferred_updates.clear();
+}
 
 bool TrackTraffic::IsGeoGridFree(const GeoGridId geogrid_id) const {
     if (grid_to_actors.find(geogrid_id) != grid_to_actors.end()) {
@@ -128,13 +168,21 @@ void TrackTraffic::DeleteActor(ActorId actor_id) {
 
     if (waypoint_occupied.find(actor_id) != waypoint_occupied.end()) {
         WaypointIdSet waypoint_id_set = waypoint_occupied.at(actor_id);
-        for (const uint64_t &waypoint_id : waypoint_id_set) {
+        for (const WaypointIndex waypoint_id : waypoint_id_set) {
             RemovePassingVehicle(waypoint_id, actor_id);
         }
     }
 }
 
-void TrackTraffic::UpdatePassingVehicle(uint64_t waypoint_id, ActorId actor_id) {
+void TrackTraffic::UpdatePassingVehicle(WaypointIndex waypoint_id, ActorId actor_id) {
+    if (deferred) {
+        deferred_updates.at(actor_id).passing_waypoints.emplace_back(waypoint_id, true);
+    } else {
+        ApplyPassingVehicle(waypoint_id, actor_id);
+    }
+}
+
+void TrackTraffic::ApplyPassingVehicle(WaypointIndex waypoint_id, ActorId actor_id) {
     if (waypoint_overlap_tracker.find(waypoint_id) != waypoint_overlap_tracker.end()) {
         ActorIdSet &actor_id_set = waypoint_overlap_tracker.at(waypoint_id);
         if (actor_id_set.find(actor_id) == actor_id_set.end()) {
@@ -154,7 +202,15 @@ void TrackTraffic::UpdatePassingVehicle(uint64_t waypoint_id, ActorId actor_id)
     }
 }
 
-void TrackTraffic::RemovePassingVehicle(uint64_t waypoint_id, ActorId actor_id) {
+void TrackTraffic::RemovePassingVehicle(WaypointIndex waypoint_id, ActorId actor_id) {
+    if (deferred) {
+        deferred_updates.at(actor_id).passing_waypoints.emplace_back(waypoint_id, false);
+    } else {
+        ApplyRemovePassingVehicle(waypoint_id, actor_id);
+    }
+}
+
+void TrackTraffic::ApplyRemovePassingVehicle(WaypointIndex waypoint_id, ActorId actor_id) {
     if (waypoint_overlap_tracker.find(waypoint_id) != waypoint_overlap_tracker.end()) {
         ActorIdSet &actor_id_set = waypoint_overlap_tracker.at(waypoint_id);
         actor_id_set.erase(actor_id);
@@ -174,7 +230,7 @@ void TrackTraffic::RemovePassingVehicle(uint64_t waypoint_id, ActorId actor_id)
     }
 }
 
-ActorIdSet TrackTraffic::GetPassingVehicles(uint64_t waypoint_id) const {
+ActorIdSet TrackTraffic::GetPassingVehicles(WaypointIndex waypoint_id) const {
 
     if (waypoint_overlap_tracker.find(waypoint_id) != waypoint_overlap_tracker.end()) {
         return waypoint_overlap_tracker.at(waypoint_id);
@@ -184,6 +240,9 @@ ActorIdSet TrackTraffic::GetPassingVehicles(uint64_t waypoint_id) const {
 }
 
 void TrackTraffic::Clear() {
+    deferred = false;
+    deferred_actors.clear();
+    deferred_updates.clear();
     waypoint_overlap_tracker.clear();
     waypoint_occupied.clear();
     actor_to_grids.clear();
@@ -1,10 +1,15 @@
 
 #pragma once
 
+#include <unordered_map>
+#include <unordered_set>
+
 #include "carla/road/RoadTypes.h"
 #include "carla/rpc/ActorId.h"
 
 #include "carla/trafficmanager/SimpleWaypoint.h"
+#include "carla/trafficmanager/WaypointBuffer.h"
+#include "carla/trafficmanager/WaypointGraph.h"
 
 namespace carla {
 namespace traffic_manager {
@@ -12,7 +17,7 @@ namespace traffic_manager {
 using ActorId = carla::ActorId;
 using ActorIdSet = std::unordered_set<ActorId>;
 using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>;
-using Buffer = std::deque<SimpleWaypointPtr>;
+using Buffer = WaypointBuffer;
 using GeoGridId = carla::road::JuncId;
 
 // This class is used to track the waypoint occupancy of all the actors.
@@ -20,11 +25,11 @@ class TrackTraffic {
 
 private:
     /// Structure to keep track of overlapping waypoints between vehicles.
-    using WaypointOverlap = std::unordered_map<uint64_t, ActorIdSet>;
+    using WaypointOverlap = std::unordered_map<WaypointIndex, ActorIdSet>;
     WaypointOverlap waypoint_overlap_tracker;
 
     /// Structure to keep track of waypoints occupied by vehicles;
-    using WaypointIdSet = std::unordered_set<uint64_t>;
+    using WaypointIdSet = std::unordered_set<WaypointIndex>;
     using WaypointOccupancyMap = std::unordered_map<ActorId, WaypointIdSet>;
     WaypointOccupancyMap waypoint_occupied;
 
@@ -35,18 +40,38 @@ private:
     /// Current hero location.
     cg::Location hero_location = cg::Location(0,0,0);
 
+    /// Changes recorded for a vehicle while updates are deferred.
+    struct DeferredUpdates {
+        /// Waypoints added (true) or removed (false) from the vehicle's path, in order.
+        std::vector<std::pair<WaypointIndex, bool>> passing_waypoints;
+        /// Whether the vehicle updated its grid position.
+        bool update_grids = false;
+        std::unordered_set<GeoGridId> grids;
+    };
+    /// Whether passing vehicle and grid updates are being deferred.
+    bool deferred = false;
+    /// Vehicles whose updates are recorded, in the order they are applied.
+    std::vector<ActorId> deferred_actors;
+    std::unordered_map<ActorId, DeferredUpdates> deferred_updates;
+
+    void ApplyPassingVehicle(WaypointIndex waypoint_id, ActorId actor_id);
+    void ApplyRemovePassingVehicle(WaypointIndex waypoint_id, ActorId actor_id);
+    void ApplyGridPosition(const ActorId actor_id, std::unordered_set<GeoGridId> &&current_grids);
+
 
 public:
     TrackTraffic();
 
     /// Methods to update, remove and retrieve vehicles passing through a waypoint.
-    void UpdatePassingVehicle(uint64_t waypoint_id, ActorId actor_id);
-    void RemovePassingVehicle(uint64_t waypoint_id, ActorId actor_id);
-    ActorIdSet GetPassingVehicles(uint64_t waypoint_id) const;
+    /// Waypoints are identified by their index in the WaypointGraph.
+    void UpdatePassingVehicle(WaypointIndex waypoint_id, ActorId actor_id);
+    void RemovePassingVehicle(WaypointIndex waypoint_id, ActorId actor_id);
+    ActorIdSet GetPassingVehicles(WaypointIndex waypoint_id) const;
 
-    void UpdateGridPosition(const ActorId actor_id, const Buffer &buffer);
+    void UpdateGridPosition(const ActorId actor_id, const Buffer &buffer, const WaypointGraph &graph);
     void UpdateUnregisteredGridPosition(const ActorId actor_id,
-                                        const std::vector<SimpleWaypointPtr> waypoints);
+                                        const std::vector<WaypointIndex> &waypoints,
+                                        const WaypointGraph &graph);
 
     ActorIdSet GetOverlappingVehicles(ActorId actor_id) const;
     bool IsGeoGridFree(const GeoGridId geogrid_id) const;
@@ -56,6 +81,16 @@ public:
     cg::Location GetHeroLocation() const;
 
 
+    /// Starts recording the passing vehicle and grid updates of the vehicles
+    /// in @a vehicle_id_list instead of applying them, so that the vehicles can
+    /// be updated concurrently while queries see the state at this point.
+    /// Each vehicle must only update its own entries.
+    void BeginDeferredUpdates(const std::vector<ActorId> &vehicle_id_list);
+
+    /// Applies the recorded updates vehicle by vehicle, following the order
+    /// given to BeginDeferredUpdates, and goes back to immediate updates.
+    void CommitDeferredUpdates();
+
     /// Method to delete actor data from tracking.
     void DeleteActor(ActorId actor_id);
 
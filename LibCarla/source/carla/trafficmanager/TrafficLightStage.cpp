@@ -19,20 +19,22 @@ TrafficLightStage::TrafficLightStage(
   const Parameters &parameters,
   const cc::World &world,
   TLFrame &output_array,
-  RandomGenerator &random_device)
+  RandomGeneratorMap &random_devices,
+  const LocalMapPtr &local_map)
   : vehicle_id_list(vehicle_id_list),
     simulation_state(simulation_state),
     buffer_map(buffer_map),
     parameters(parameters),
     world(world),
+    local_map(local_map),
     output_array(output_array),
-    random_device(random_device) {}
+    random_devices(random_devices) {}
 
 void TrafficLightStage::Update(const unsigned long index) {
   bool traffic_light_hazard = false;
 
   const ActorId ego_actor_id = vehicle_id_list.at(index);
-  if (!simulation_state.IsDormant(ego_actor_id)) {
+  if (!simulation_state.IsDormantAt(index)) {
 
     JunctionID current_junction_id = -1;
     if (vehicle_last_junction.find(ego_actor_id) != vehicle_last_junction.end()) {
@@ -42,7 +44,7 @@ void TrafficLightStage::Update(const unsigned long index) {
 
     current_timestamp = world.GetSnapshot().GetTimestamp();
 
-    const TrafficLightState tl_state = simulation_state.GetTLS(ego_actor_id);
+    const TrafficLightState &tl_state = simulation_state.GetTLSAt(index);
     const TLS traffic_light_state = tl_state.tl_state;
     const bool is_at_traffic_light = tl_state.at_traffic_light;
 
@@ -50,7 +52,7 @@ void TrafficLightStage::Update(const unsigned long index) {
     if (is_at_traffic_light &&
         traffic_light_state != TLS::Green &&
         traffic_light_state != TLS::Off &&
-        parameters.GetPercentageRunningLight(ego_actor_id) <= random_device.next()) {
+        parameters.GetSnapshot().GetVehicle(index).perc_run_traffic_light <= random_devices.at(ego_actor_id).next()) {
       // Remove actor from non-signalized junction if it is affected by a traffic light.
       if (current_junction_id != -1) {
         RemoveActor(ego_actor_id);
@@ -71,7 +73,7 @@ void TrafficLightStage::Update(const unsigned long index) {
     else if (affected_junction_id != -1 &&
             !is_at_traffic_light &&
             traffic_light_state != TLS::Green &&
-            parameters.GetPercentageRunningSign(ego_actor_id) <= random_device.next()) {
+            parameters.GetSnapshot().GetVehicle(index).perc_run_traffic_sign <= random_devices.at(ego_actor_id).next()) {
 
       AddActorToNonSignalisedJunction(ego_actor_id, affected_junction_id);
       traffic_light_hazard = true;
@@ -130,12 +132,13 @@ bool TrafficLightStage::HandleNonSignalisedJunction(const ActorId ego_actor_id,
 }
 
 JunctionID TrafficLightStage::GetAffectedJunctionId(const ActorId ego_actor_id) {
+    const WaypointGraph &graph = local_map->GetGraph();
     const Buffer &waypoint_buffer = buffer_map.at(ego_actor_id);
-    const SimpleWaypointPtr look_ahead_point = GetTargetWaypoint(waypoint_buffer, JUNCTION_LOOK_AHEAD).first;
-    const auto front_point = waypoint_buffer.front();
+    const WaypointIndex look_ahead_point = GetTargetWaypoint(graph, waypoint_buffer, JUNCTION_LOOK_AHEAD).first;
+    const WaypointIndex front_point = waypoint_buffer.front();
 
-    auto look_ahead_junction_id = look_ahead_point->GetJunctionId();
-    auto front_junction_id = front_point->GetJunctionId();
+    auto look_ahead_junction_id = graph.GetJunctionId(look_ahead_point);
+    auto front_junction_id = graph.GetJunctionId(front_point);
 
     // Check if the vehicle is currently at a non-signalized junction
     JunctionID current_junction_id = -1;
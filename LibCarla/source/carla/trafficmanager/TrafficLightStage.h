@@ -1,7 +1,10 @@
 
 #pragma once
 
+#include <deque>
+
 #include "carla/trafficmanager/DataStructures.h"
+#include "carla/trafficmanager/InMemoryMap.h"
 #include "carla/trafficmanager/Parameters.h"
 #include "carla/trafficmanager/RandomGenerator.h"
 #include "carla/trafficmanager/SimulationState.h"
@@ -10,6 +13,8 @@
 namespace carla {
 namespace traffic_manager {
 
+using LocalMapPtr = std::shared_ptr<InMemoryMap>;
+
 /// This class has functionality for responding to traffic lights
 /// and managing entry into non-signalized junctions.
 class TrafficLightStage: Stage {
@@ -19,6 +24,7 @@ private:
   const BufferMap &buffer_map;
   const Parameters &parameters;
   const cc::World &world;
+  const LocalMapPtr &local_map;
 
   /// Variables used to handle non signalized junctions
 
@@ -29,7 +35,7 @@ private:
   /// Map containing the timestamp at which the actor first stopped at a stop sign.
   std::unordered_map<ActorId, cc::Timestamp> vehicle_stop_time;
   TLFrame &output_array;
-  RandomGenerator &random_device;
+  RandomGeneratorMap &random_devices;
   cc::Timestamp current_timestamp;
 
   /// This controls all vehicle's interactions at non signalized junctions. Priorities are done by order of arrival
@@ -51,7 +57,8 @@ public:
                     const Parameters &parameters,
                     const cc::World &world,
                     TLFrame &output_array,
-                    RandomGenerator &random_device);
+                    RandomGeneratorMap &random_devices,
+                    const LocalMapPtr &local_map);
 
   void Update(const unsigned long index) override;
 
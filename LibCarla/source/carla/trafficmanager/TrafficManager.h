@@ -65,6 +65,15 @@ public:
     }
   }
 
+  /// Method to set the number of threads running the stages. With more than
+  /// one thread, vehicles are updated in parallel.
+  void SetWorkerThreads(const uint32_t count) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if (tm_ptr != nullptr) {
+      tm_ptr->SetWorkerThreads(count);
+    }
+  }
+
   /// Method to set our own imported path.
   void SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer) {
     TrafficManagerBase* tm_ptr = GetTM(_port);
@@ -237,6 +237,12 @@ public:
     _client->call("set_osm_mode", mode_switch);
   }
 
+  /// Method to set the number of threads running the stages.
+  void SetWorkerThreads(const uint32_t count) {
+    DEBUG_ASSERT(_client != nullptr);
+    _client->call("set_worker_threads", count);
+  }
+
   /// Method to set our own imported path.
   void SetCustomPath(const carla::rpc::Actor &actor, const Path path, const bool empty_buffer) {
     DEBUG_ASSERT(_client != nullptr);
@@ -6,9 +6,13 @@
 
 #include <algorithm>
 
+#include "carla/FileSystem.h"
 #include "carla/Logging.h"
 
+#include "carla/client/FileTransfer.h"
 #include "carla/client/detail/Simulator.h"
+#include "carla/profiler/Tracer.h"
+#include "carla/road/MapCache.h"
 
 #include "carla/trafficmanager/TrafficManagerLocal.h"
 
@@ -16,6 +20,7 @@ namespace carla {
 namespace traffic_manager {
 
 using namespace constants::FrameMemory;
+using constants::ParallelExecution::VEHICLES_PER_CHUNK;
 
 TrafficManagerLocal::TrafficManagerLocal(
   std::vector<float> longitudinal_PID_parameters,
@@ -34,23 +39,24 @@ TrafficManagerLocal::TrafficManagerLocal(
     episode_proxy(episode_proxy),
     world(cc::World(episode_proxy)),
 
-    localization_stage(LocalizationStage(vehicle_id_list,
-                                         buffer_map,
-                                         simulation_state,
-                                         track_traffic,
-                                         local_map,
-                                         parameters,
-                                         marked_for_removal,
-                                         localization_frame,
-                                         random_device)),
-
-    collision_stage(CollisionStage(vehicle_id_list,
-                                   simulation_state,
-                                   buffer_map,
-                                   track_traffic,
-                                   parameters,
-                                   collision_frame,
-                                   random_device)),
+    localization_stage(vehicle_id_list,
+                       buffer_map,
+                       simulation_state,
+                       track_traffic,
+                       local_map,
+                       parameters,
+                       marked_for_removal,
+                       localization_frame,
+                       random_devices),
+
+    collision_stage(vehicle_id_list,
+                    simulation_state,
+                    buffer_map,
+                    track_traffic,
+                    parameters,
+                    collision_frame,
+                    random_devices,
+                    local_map),
 
     traffic_light_stage(TrafficLightStage(vehicle_id_list,
                                           simulation_state,
@@ -58,30 +64,32 @@ TrafficManagerLocal::TrafficManagerLocal(
                                           parameters,
                                           world,
                                           tl_frame,
-                                          random_device)),
-
-    motion_plan_stage(MotionPlanStage(vehicle_id_list,
-                                      simulation_state,
-                                      parameters,
-                                      buffer_map,
-                                      track_traffic,
-                                      longitudinal_PID_parameters,
-                                      longitudinal_highway_PID_parameters,
-                                      lateral_PID_parameters,
-                                      lateral_highway_PID_parameters,
-                                      localization_frame,
-                                      collision_frame,
-                                      tl_frame,
-                                      world,
-                                      control_frame,
-                                      random_device,
-                                      local_map)),
+                                          random_devices,
+                                          local_map)),
+
+    motion_plan_stage(vehicle_id_list,
+                      simulation_state,
+                      parameters,
+                      buffer_map,
+                      track_traffic,
+                      longitudinal_PID_parameters,
+                      longitudinal_highway_PID_parameters,
+                      lateral_PID_parameters,
+                      lateral_highway_PID_parameters,
+                      localization_frame,
+                      collision_frame,
+                      tl_frame,
+                      world,
+                      control_frame,
+                      random_devices,
+                      local_map),
 
     vehicle_light_stage(VehicleLightStage(vehicle_id_list,
                                           buffer_map,
                                           parameters,
                                           world,
-                                          control_frame)),
+                                          control_frame,
+                                          local_map)),
 
     alsm(ALSM(registered_vehicles,
               buffer_map,
@@ -117,6 +125,19 @@ void TrafficManagerLocal::SetupLocalMap() {
   const carla::SharedPtr<const cc::Map> world_map = world.GetMap();
   local_map = std::make_shared<InMemoryMap>(world_map);
 
+  // Reuse the local map cached by a previous Traffic Manager next to the
+  // downloaded files, keyed by the OpenDRIVE content it was built from.
+  std::string cache_path = cc::FileTransfer::GetFullPath(world_map->GetName() + ".tmcache");
+  try {
+    FileSystem::ValidateFilePath(cache_path);
+  } catch (const std::exception &) {
+    cache_path.clear();
+  }
+  const uint64_t hash = road::MapCache::Hash(world_map->GetOpenDrive());
+  if (!cache_path.empty() && local_map->LoadCache(cache_path, hash)) {
+    return;
+  }
+
   auto files = episode_proxy.Lock()->GetRequiredFiles("TM");
   if (!files.empty()) {
     auto content = episode_proxy.Lock()->GetCacheFile(files[0], true);
@@ -130,6 +151,10 @@ void TrafficManagerLocal::SetupLocalMap() {
     log_warning("No InMemoryMap cache found. Setting up local map. This may take a while...");
     local_map->SetUp();
   }
+
+  if (!cache_path.empty() && !local_map->SaveCache(cache_path, hash)) {
+    log_warning("Could not write the local map cache to", cache_path);
+  }
 }
 
 void TrafficManagerLocal::Start() {
@@ -139,6 +164,8 @@ void TrafficManagerLocal::Start() {
 
 void TrafficManagerLocal::Run() {
 
+  carla::profiler::Tracer::SetThreadName("TrafficManager");
+
   localization_frame.reserve(INITIAL_SIZE);
   collision_frame.reserve(INITIAL_SIZE);
   tl_frame.reserve(INITIAL_SIZE);
@@ -179,9 +206,14 @@ void TrafficManagerLocal::Run() {
       last_frame = timestamp.frame;
     }
 
+    CARLA_TRACE_SCOPE("traffic_manager", "Cycle");
+
     std::unique_lock<std::mutex> registration_lock(registration_mutex);
     // Updating simulation state, actor life cycle and performing necessary cleanup.
-    alsm.Update();
+    {
+      CARLA_TRACE_SCOPE("traffic_manager", "ALSM");
+      alsm.Update();
+    }
 
     // Re-allocating inter-stage communication frames based on changed number of registered vehicles.
     int current_registered_vehicles_state = registered_vehicles.GetState();
@@ -202,6 +234,21 @@ void TrafficManagerLocal::Run() {
 
       registered_vehicles_state = registered_vehicles.GetState();
     }
+    // Give every registered vehicle the slot matching its index in the list.
+    if (simulation_state.ArrangeSlots(vehicle_id_list) != number_of_vehicles) {
+      // A vehicle registered after the ALSM update has no state yet, leave it
+      // out of this cycle. The list is taken again in the next one.
+      vehicle_id_list.erase(
+          std::remove_if(vehicle_id_list.begin(), vehicle_id_list.end(), [this](ActorId actor_id) {
+            return !simulation_state.ContainsActor(actor_id);
+          }),
+          vehicle_id_list.end());
+      number_of_vehicles = vehicle_id_list.size();
+    }
+    CARLA_TRACE_COUNTER("traffic_manager", "Vehicles", number_of_vehicles);
+    random_devices.Update(vehicle_id_list);
+    // Take the parameters the stages read during this cycle.
+    parameters.UpdateSnapshot(vehicle_id_list);
 
     // Reset frames for current cycle.
     localization_frame.clear();
@@ -219,23 +266,45 @@ void TrafficManagerLocal::Run() {
     control_frame.resize(number_of_vehicles);
 
     // Run core operation stages.
-    for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
-      localization_stage.Update(index);
-    }
-    for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
-      collision_stage.Update(index);
-    }
-    collision_stage.ClearCycleCache();
-    vehicle_light_stage.UpdateWorldInfo();
-    for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
-      traffic_light_stage.Update(index);
-      motion_plan_stage.Update(index);
-      vehicle_light_stage.Update(index);
+    const uint32_t worker_threads = parameters.GetWorkerThreads();
+    if (worker_threads > 1u) {
+      if (stage_pool == nullptr || stage_pool->size() != worker_threads) {
+        // The thread running the traffic manager also takes part.
+        stage_pool = std::make_unique<WorkStealingPool>(worker_threads - 1u);
+      }
+      RunStagesInParallel();
+    } else {
+      stage_pool.reset();
+      {
+        CARLA_TRACE_SCOPE("traffic_manager", "LocalizationStage");
+        for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
+          localization_stage.Update(index);
+        }
+      }
+      {
+        CARLA_TRACE_SCOPE("traffic_manager", "CollisionStage");
+        for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
+          collision_stage.Update(index);
+        }
+        collision_stage.ClearCycleCache();
+      }
+      {
+        // The last three stages run interleaved, vehicle by vehicle.
+        CARLA_TRACE_SCOPE("traffic_manager", "PlanningStages");
+        vehicle_light_stage.UpdateWorldInfo();
+        for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
+          traffic_light_stage.Update(index);
+          motion_plan_stage.Update(index);
+          vehicle_light_stage.Update(index);
+        }
+        vehicle_light_stage.AppendLightStateCommands();
+      }
     }
 
     registration_lock.unlock();
 
     // Sending the current cycle's batch command to the simulator.
+    CARLA_TRACE_SCOPE("traffic_manager", "ApplyBatch");
     if (synchronous_mode) {
       episode_proxy.Lock()->ApplyBatchSync(control_frame, false);
       step_end.store(true);
@@ -248,6 +317,56 @@ void TrafficManagerLocal::Run() {
   }
 }
 
+void TrafficManagerLocal::RunStagesInParallel() {
+  const size_t number_of_vehicles = vehicle_id_list.size();
+
+  {
+    CARLA_TRACE_SCOPE("traffic_manager", "LocalizationStage");
+    localization_stage.BeginParallelUpdate();
+    stage_pool->ParallelFor(0u, number_of_vehicles, VEHICLES_PER_CHUNK, [this](size_t index) {
+      localization_stage.Update(index);
+    });
+    localization_stage.EndParallelUpdate();
+  }
+
+  {
+    CARLA_TRACE_SCOPE("traffic_manager", "CollisionStage");
+    collision_stage.BeginParallelUpdate();
+    stage_pool->ParallelFor(0u, number_of_vehicles, VEHICLES_PER_CHUNK, [this](size_t index) {
+      collision_stage.Update(index);
+    });
+    collision_stage.EndParallelUpdate();
+    collision_stage.ClearCycleCache();
+  }
+
+  {
+    // Vehicles queue at non-signalized junctions in the order they are
+    // processed, so this stage keeps running sequentially.
+    CARLA_TRACE_SCOPE("traffic_manager", "TrafficLightStage");
+    for (unsigned long index = 0u; index < number_of_vehicles; ++index) {
+      traffic_light_stage.Update(index);
+    }
+  }
+
+  {
+    CARLA_TRACE_SCOPE("traffic_manager", "MotionPlanStage");
+    motion_plan_stage.BeginParallelUpdate();
+    stage_pool->ParallelFor(0u, number_of_vehicles, VEHICLES_PER_CHUNK, [this](size_t index) {
+      motion_plan_stage.Update(index);
+    });
+    motion_plan_stage.EndParallelUpdate();
+  }
+
+  {
+    CARLA_TRACE_SCOPE("traffic_manager", "VehicleLightStage");
+    vehicle_light_stage.UpdateWorldInfo();
+    stage_pool->ParallelFor(0u, number_of_vehicles, VEHICLES_PER_CHUNK, [this](size_t index) {
+      vehicle_light_stage.Update(index);
+    });
+    vehicle_light_stage.AppendLightStateCommands();
+  }
+}
+
 bool TrafficManagerLocal::SynchronousTick() {
   if (parameters.GetSynchronousMode()) {
     step_begin.store(true);
@@ -273,6 +392,7 @@ void TrafficManagerLocal::Stop() {
     }
     worker_thread.release();
   }
+  stage_pool.reset();
 
   vehicle_id_list.clear();
   registered_vehicles.Clear();
@@ -411,6 +531,10 @@ void TrafficManagerLocal::SetOSMMode(const bool mode_switch) {
   parameters.SetOSMMode(mode_switch);
 }
 
+void TrafficManagerLocal::SetWorkerThreads(const uint32_t count) {
+  parameters.SetWorkerThreads(count);
+}
+
 void TrafficManagerLocal::SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer) {
   parameters.SetCustomPath(actor, path, empty_buffer);
 }
@@ -486,8 +610,9 @@ std::vector<ActorId> TrafficManagerLocal::GetRegisteredVehiclesIDs() {
 }
 
 void TrafficManagerLocal::SetRandomDeviceSeed(const uint64_t _seed) {
+  std::lock_guard<std::mutex> registration_lock(registration_mutex);
   seed = _seed;
-  random_device = RandomGenerator(seed);
+  random_devices = RandomGeneratorMap(seed);
   world.ResetAllTrafficLights();
 }
 
@@ -14,23 +14,31 @@ VehicleLightStage::VehicleLightStage(
   const BufferMap &buffer_map,
   const Parameters &parameters,
   const cc::World &world,
-  ControlFrame& control_frame)
+  ControlFrame& control_frame,
+  const LocalMapPtr &local_map)
   : vehicle_id_list(vehicle_id_list),
     buffer_map(buffer_map),
     parameters(parameters),
     world(world),
-    control_frame(control_frame) {}
+    control_frame(control_frame),
+    local_map(local_map) {}
 
 void VehicleLightStage::UpdateWorldInfo() {
   // Get the global weather and all the vehicle light states at once
-  all_light_states = world.GetVehiclesLightStates();
+  all_light_states.clear();
+  for (auto &&vls : world.GetVehiclesLightStates()) {
+    all_light_states.insert(vls);
+  }
   weather = world.GetWeather();
+
+  light_state_updates.clear();
+  light_state_updates.resize(vehicle_id_list.size());
 }
 
 void VehicleLightStage::Update(const unsigned long index) {
   ActorId actor_id = vehicle_id_list.at(index);
 
-  if (!parameters.GetUpdateVehicleLights(actor_id))
+  if (!parameters.GetSnapshot().GetVehicle(index).auto_update_vehicle_lights)
     return; // this vehicle is not set to have automatic lights update
 
   rpc::VehicleLightState::flag_type light_states = uint32_t(-1);
@@ -43,38 +51,35 @@ void VehicleLightStage::Update(const unsigned long index) {
   bool fog_lights = false;
 
   // search the current light state of the vehicle
-  for (auto&& vls : all_light_states) {
-    if (vls.first == actor_id) {
-      light_states = vls.second;
-      break;
-    }
+  auto vls = all_light_states.find(actor_id);
+  if (vls != all_light_states.end()) {
+    light_states = vls->second;
   }
 
   // Determine if the vehicle is truning left or right by checking the close waypoints
 
+  const WaypointGraph &graph = local_map->GetGraph();
   const Buffer& waypoint_buffer = buffer_map.at(actor_id);
-  cg::Location front_location = waypoint_buffer.front()->GetLocation();
+  cg::Location front_location = graph.GetLocation(waypoint_buffer.front());
 
-  for (const SimpleWaypointPtr& waypoint : waypoint_buffer) {
-    if (waypoint->CheckJunction()) {
-      RoadOption target_ro = waypoint->GetRoadOption();
+  for (const WaypointIndex waypoint : waypoint_buffer) {
+    if (graph.CheckJunction(waypoint)) {
+      RoadOption target_ro = graph.GetRoadOption(waypoint);
       if (target_ro == RoadOption::Left) left_turn_indicator = true;
       else if (target_ro == RoadOption::Right) right_turn_indicator = true;
       break;
     }
-    if (cg::Math::DistanceSquared(front_location, waypoint->GetLocation()) > MAX_DISTANCE_LIGHT_CHECK) {
+    if (graph.DistanceSquared(waypoint, front_location) > MAX_DISTANCE_LIGHT_CHECK) {
       break;
     }
   }
 
-  // Determine brake light state
-  for (size_t cc = 0; cc < control_frame.size(); cc++) {
-    if (auto* maybe_ctrl = boost::variant2::get_if<carla::rpc::Command::ApplyVehicleControl>(&control_frame[cc].command)) {
-      carla::rpc::Command::ApplyVehicleControl& ctrl = *maybe_ctrl;
-      if (ctrl.actor == actor_id) {
-        brake_lights = (ctrl.control.brake > 0.5); // hard braking, avoid blinking for throttle control
-        break;
-      }
+  // Determine brake light state, the motion planner writes the vehicle's
+  // command at the same index.
+  if (auto* maybe_ctrl = boost::variant2::get_if<carla::rpc::Command::ApplyVehicleControl>(&control_frame.at(index).command)) {
+    carla::rpc::Command::ApplyVehicleControl& ctrl = *maybe_ctrl;
+    if (ctrl.actor == actor_id) {
+      brake_lights = (ctrl.control.brake > 0.5); // hard braking, avoid blinking for throttle control
     }
   }
 
@@ -143,7 +148,15 @@ void VehicleLightStage::Update(const unsigned long index) {
 
   // Update the vehicle light state if it has changed
   if (new_light_states != light_states)
-    control_frame.push_back(carla::rpc::Command::SetVehicleLightState(actor_id, new_light_states));
+    light_state_updates.at(index) = new_light_states;
+}
+
+void VehicleLightStage::AppendLightStateCommands() {
+  for (unsigned long index = 0u; index < light_state_updates.size(); ++index) {
+    if (light_state_updates[index]) {
+      control_frame.push_back(carla::rpc::Command::SetVehicleLightState(vehicle_id_list.at(index), *light_state_updates[index]));
+    }
+  }
 }
 
 void VehicleLightStage::RemoveActor(const ActorId) {
@@ -1,7 +1,10 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
+
 #include "carla/trafficmanager/DataStructures.h"
+#include "carla/trafficmanager/InMemoryMap.h"
 #include "carla/trafficmanager/Parameters.h"
 #include "carla/trafficmanager/RandomGenerator.h"
 #include "carla/trafficmanager/SimulationState.h"
@@ -10,6 +13,8 @@
 namespace carla {
 namespace traffic_manager {
 
+using LocalMapPtr = std::shared_ptr<InMemoryMap>;
+
 /// This class has functionality for turning on/off the vehicle lights
 /// according to the current vehicle state and its surrounding environment.
 class VehicleLightStage: Stage {
@@ -19,22 +24,30 @@ private:
   const Parameters &parameters;
   const cc::World &world;
   ControlFrame& control_frame;
+  const LocalMapPtr &local_map;
   /// All vehicle light states
-  rpc::VehicleLightStateList all_light_states;
+  std::unordered_map<ActorId, rpc::VehicleLightState::flag_type> all_light_states;
   /// Current weather parameters
   rpc::WeatherParameters weather;
+  /// New light state of each vehicle in vehicle_id_list, if it changed.
+  std::vector<boost::optional<rpc::VehicleLightState::flag_type>> light_state_updates;
 
 public:
   VehicleLightStage(const std::vector<ActorId> &vehicle_id_list,
                     const BufferMap &buffer_map,
                     const Parameters &parameters,
                     const cc::World &world,
-                    ControlFrame& control_frame);
+                    ControlFrame& control_frame,
+                    const LocalMapPtr &local_map);
 
   void UpdateWorldInfo();
 
   void Update(const unsigned long index) override;
 
+  /// Appends to the control frame, in vehicle order, the light state
+  /// commands computed since the last UpdateWorldInfo.
+  void AppendLightStateCommands();
+
   void RemoveActor(const ActorId actor_id) override;
 
   void Reset() override;
@@ -0,0 +1,141 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+#include "carla/Exception.h"
+
+#include "carla/trafficmanager/WaypointGraph.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  /// Path of a vehicle, a ring buffer of waypoint indices in the
+  /// WaypointGraph of the local map. Its capacity grows in powers of two and
+  /// is kept when waypoints are removed, so that a buffer extended and
+  /// purged every cycle does not allocate.
+  class WaypointBuffer {
+  public:
+
+    class const_iterator {
+    public:
+
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = WaypointIndex;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const WaypointIndex *;
+      using reference = WaypointIndex;
+
+      const_iterator(const WaypointBuffer &buffer, size_t position)
+        : _buffer(&buffer),
+          _position(position) {}
+
+      WaypointIndex operator*() const {
+        return (*_buffer)[_position];
+      }
+
+      const_iterator &operator++() {
+        ++_position;
+        return *this;
+      }
+
+      bool operator==(const const_iterator &rhs) const {
+        return _position == rhs._position;
+      }
+
+      bool operator!=(const const_iterator &rhs) const {
+        return !(*this == rhs);
+      }
+
+    private:
+
+      const WaypointBuffer *_buffer;
+
+      size_t _position;
+    };
+
+    bool empty() const {
+      return _size == 0u;
+    }
+
+    size_t size() const {
+      return _size;
+    }
+
+    WaypointIndex operator[](size_t i) const {
+      return _data[(_head + i) & (_data.size() - 1u)];
+    }
+
+    WaypointIndex at(size_t i) const {
+      if (i >= _size) {
+        throw_exception(std::out_of_range("waypoint buffer index out of range"));
+      }
+      return (*this)[i];
+    }
+
+    WaypointIndex front() const {
+      return (*this)[0u];
+    }
+
+    WaypointIndex back() const {
+      return (*this)[_size - 1u];
+    }
+
+    const_iterator begin() const {
+      return {*this, 0u};
+    }
+
+    const_iterator end() const {
+      return {*this, _size};
+    }
+
+    void push_back(WaypointIndex index) {
+      if (_size == _data.size()) {
+        Grow();
+      }
+      _data[(_head + _size) & (_data.size() - 1u)] = index;
+      ++_size;
+    }
+
+    void pop_front() {
+      _head = (_head + 1u) & (_data.size() - 1u);
+      --_size;
+    }
+
+    void pop_back() {
+      --_size;
+    }
+
+    void clear() {
+      _head = 0u;
+      _size = 0u;
+    }
+
+  private:
+
+    void Grow() {
+      std::vector<WaypointIndex> data(_data.empty() ? 64u : 2u * _data.size());
+      for (size_t i = 0u; i < _size; ++i) {
+        data[i] = (*this)[i];
+      }
+      _data.swap(data);
+      _head = 0u;
+    }
+
+    /// Its size is always zero or a power of two.
+    std::vector<WaypointIndex> _data;
+
+    size_t _head = 0u;
+
+    size_t _size = 0u;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
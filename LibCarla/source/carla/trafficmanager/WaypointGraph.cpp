@@ -0,0 +1,296 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/trafficmanager/WaypointGraph.h"
+
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+namespace carla {
+namespace traffic_manager {
+
+  static constexpr char CACHE_MAGIC[8u] = {'C', 'A', 'R', 'L', 'A', 'T', 'M', 'G'};
+
+  /// Increase it whenever the layout of the file or the way the local map is
+  /// computed changes, so older caches are discarded.
+  static constexpr uint32_t CACHE_VERSION = 1u;
+
+  /// Every array starts at a multiple of this in the file.
+  static constexpr size_t CACHE_ALIGNMENT = 8u;
+
+  /// Follows the CacheFile header.
+  struct WaypointGraph::CacheHeader {
+    uint64_t size;
+    uint64_t next_links;
+    uint64_t previous_links;
+  };
+
+  static size_t AlignedSize(size_t size) {
+    return (size + CACHE_ALIGNMENT - 1u) & ~(CACHE_ALIGNMENT - 1u);
+  }
+
+  void WaypointGraph::Build(const NodeList &dense_topology) {
+    Clear();
+
+    std::unordered_map<const SimpleWaypoint *, WaypointIndex> indices;
+    indices.reserve(dense_topology.size());
+    for (size_t i = 0u; i < dense_topology.size(); ++i) {
+      indices.emplace(dense_topology[i].get(), static_cast<WaypointIndex>(i));
+    }
+    auto get_index = [&indices](const SimpleWaypointPtr &swp) {
+      if (swp == nullptr) {
+        return INVALID_WAYPOINT_INDEX;
+      }
+      const auto it = indices.find(swp.get());
+      return it != indices.end() ? it->second : INVALID_WAYPOINT_INDEX;
+    };
+    auto append_links = [&get_index](
+        const std::vector<SimpleWaypointPtr> &links,
+        std::vector<uint32_t> &offsets,
+        std::vector<WaypointIndex> &targets) {
+      for (const SimpleWaypointPtr &link : links) {
+        const WaypointIndex index = get_index(link);
+        if (index != INVALID_WAYPOINT_INDEX) {
+          targets.push_back(index);
+        }
+      }
+      offsets.push_back(static_cast<uint32_t>(targets.size()));
+    };
+
+    const size_t size = dense_topology.size();
+    std::vector<cg::Transform> new_transforms;
+    std::vector<cg::Vector3D> new_forward_vectors;
+    std::vector<double> new_distances;
+    std::vector<crd::RoadId> new_road_ids;
+    std::vector<crd::LaneId> new_lane_ids;
+    std::vector<GeoGridId> new_geodesic_grid_ids;
+    std::vector<GeoGridId> new_junction_ids;
+    std::vector<uint8_t> new_is_junction;
+    std::vector<RoadOption> new_road_options;
+    std::vector<WaypointIndex> new_left_waypoints;
+    std::vector<WaypointIndex> new_right_waypoints;
+    std::vector<uint32_t> new_next_offsets;
+    std::vector<WaypointIndex> new_next_waypoints;
+    std::vector<uint32_t> new_previous_offsets;
+    std::vector<WaypointIndex> new_previous_waypoints;
+    new_transforms.reserve(size);
+    new_forward_vectors.reserve(size);
+    new_distances.reserve(size);
+    new_road_ids.reserve(size);
+    new_lane_ids.reserve(size);
+    new_geodesic_grid_ids.reserve(size);
+    new_junction_ids.reserve(size);
+    new_is_junction.reserve(size);
+    new_road_options.reserve(size);
+    new_left_waypoints.reserve(size);
+    new_right_waypoints.reserve(size);
+    new_next_offsets.reserve(size + 1u);
+    new_previous_offsets.reserve(size + 1u);
+    new_next_offsets.push_back(0u);
+    new_previous_offsets.push_back(0u);
+
+    for (const SimpleWaypointPtr &swp : dense_topology) {
+      const WaypointPtr waypoint = swp->GetWaypoint();
+      const cg::Transform transform = waypoint->GetTransform();
+      new_transforms.push_back(transform);
+      new_forward_vectors.push_back(transform.GetForwardVector());
+      new_distances.push_back(waypoint->GetDistance());
+      new_road_ids.push_back(waypoint->GetRoadId());
+      new_lane_ids.push_back(waypoint->GetLaneId());
+      new_geodesic_grid_ids.push_back(swp->GetGeodesicGridId());
+      new_junction_ids.push_back(swp->GetJunctionId());
+      new_is_junction.push_back(swp->CheckJunction() ? 1u : 0u);
+      new_road_options.push_back(swp->GetRoadOption());
+      new_left_waypoints.push_back(get_index(swp->GetLeftWaypoint()));
+      new_right_waypoints.push_back(get_index(swp->GetRightWaypoint()));
+      append_links(swp->GetNextWaypoint(), new_next_offsets, new_next_waypoints);
+      append_links(swp->GetPreviousWaypoint(), new_previous_offsets, new_previous_waypoints);
+    }
+    new_next_waypoints.shrink_to_fit();
+    new_previous_waypoints.shrink_to_fit();
+
+    transforms.Assign(std::move(new_transforms));
+    forward_vectors.Assign(std::move(new_forward_vectors));
+    distances.Assign(std::move(new_distances));
+    road_ids.Assign(std::move(new_road_ids));
+    lane_ids.Assign(std::move(new_lane_ids));
+    geodesic_grid_ids.Assign(std::move(new_geodesic_grid_ids));
+    junction_ids.Assign(std::move(new_junction_ids));
+    is_junction.Assign(std::move(new_is_junction));
+    road_options.Assign(std::move(new_road_options));
+    left_waypoints.Assign(std::move(new_left_waypoints));
+    right_waypoints.Assign(std::move(new_right_waypoints));
+    next_offsets.Assign(std::move(new_next_offsets));
+    next_waypoints.Assign(std::move(new_next_waypoints));
+    previous_offsets.Assign(std::move(new_previous_offsets));
+    previous_waypoints.Assign(std::move(new_previous_waypoints));
+  }
+
+  bool WaypointGraph::Save(const std::string &path, uint64_t hash) const {
+    static_assert(sizeof(cg::Transform) == 24u, "Unexpected padding in cached transforms");
+    static_assert(sizeof(cg::Vector3D) == 12u, "Unexpected padding in cached vectors");
+    static_assert((CacheFile::HEADER_SIZE + sizeof(CacheHeader)) % CACHE_ALIGNMENT == 0u,
+        "Waypoint graph arrays are not aligned after the header");
+
+    CacheHeader header;
+    header.size = Size();
+    header.next_links = next_waypoints.size();
+    header.previous_links = previous_waypoints.size();
+
+    return CacheFile::Write(path, CACHE_MAGIC, CACHE_VERSION, hash, [&](std::ostream &out) {
+      out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+      auto write = [&out](const auto &array) {
+        using T = typename std::decay_t<decltype(array)>::value_type;
+        static_assert(std::is_trivially_copyable<T>::value, "Cached arrays must be trivially copyable");
+        static const char padding[CACHE_ALIGNMENT] = {};
+        const size_t bytes = array.size() * sizeof(T);
+        out.write(reinterpret_cast<const char *>(array.data()), static_cast<std::streamsize>(bytes));
+        out.write(padding, static_cast<std::streamsize>(AlignedSize(bytes) - bytes));
+      };
+      write(transforms);
+      write(forward_vectors);
+      write(distances);
+      write(road_ids);
+      write(lane_ids);
+      write(geodesic_grid_ids);
+      write(junction_ids);
+      write(is_junction);
+      write(road_options);
+      write(left_waypoints);
+      write(right_waypoints);
+      write(next_offsets);
+      write(next_waypoints);
+      write(previous_offsets);
+      write(previous_waypoints);
+    });
+  }
+
+  bool WaypointGraph::Load(const std::string &path, uint64_t hash) {
+    Clear();
+
+    CacheFile file;
+    if (!file.Open(path, CACHE_MAGIC, CACHE_VERSION, hash)) {
+      // Missing file or written by another version, platform or content.
+      return false;
+    }
+
+    const size_t content_size = file.GetContentSize();
+    if (content_size < sizeof(CacheHeader)) {
+      return false;
+    }
+    const char *data = file.GetContent();
+    CacheHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.size >= INVALID_WAYPOINT_INDEX ||
+        header.next_links > std::numeric_limits<uint32_t>::max() ||
+        header.previous_links > std::numeric_limits<uint32_t>::max()) {
+      return false;
+    }
+
+    const size_t size = static_cast<size_t>(header.size);
+    size_t position = sizeof(CacheHeader);
+    bool fits = true;
+    auto view = [&](auto &array, size_t count) {
+      using T = typename std::decay_t<decltype(array)>::value_type;
+      const size_t bytes = AlignedSize(count * sizeof(T));
+      if (!fits || content_size - position < bytes) {
+        fits = false;
+        return;
+      }
+      array.View(reinterpret_cast<const T *>(data + position), count);
+      position += bytes;
+    };
+    view(transforms, size);
+    view(forward_vectors, size);
+    view(distances, size);
+    view(road_ids, size);
+    view(lane_ids, size);
+    view(geodesic_grid_ids, size);
+    view(junction_ids, size);
+    view(is_junction, size);
+    view(road_options, size);
+    view(left_waypoints, size);
+    view(right_waypoints, size);
+    view(next_offsets, size + 1u);
+    view(next_waypoints, static_cast<size_t>(header.next_links));
+    view(previous_offsets, size + 1u);
+    view(previous_waypoints, static_cast<size_t>(header.previous_links));
+    if (!fits || position != content_size || !IsValid()) {
+      Clear();
+      return false;
+    }
+
+    cache_file = std::move(file);
+    return true;
+  }
+
+  bool WaypointGraph::IsValid() const {
+    const size_t size = Size();
+    auto is_index = [size](WaypointIndex index) {
+      return index < size;
+    };
+    auto is_link = [size](WaypointIndex index) {
+      return index < size || index == INVALID_WAYPOINT_INDEX;
+    };
+    // Links of every waypoint must be a range of the links array.
+    auto are_offsets = [size](const WaypointArray<uint32_t> &offsets, size_t links) {
+      if (offsets[0u] != 0u || offsets[size] != links) {
+        return false;
+      }
+      for (size_t i = 0u; i < size; ++i) {
+        if (offsets[i] > offsets[i + 1u]) {
+          return false;
+        }
+      }
+      return true;
+    };
+    for (size_t i = 0u; i < size; ++i) {
+      if (!is_link(left_waypoints[i]) ||
+          !is_link(right_waypoints[i]) ||
+          road_options[i] > RoadOption::RoadEnd) {
+        return false;
+      }
+    }
+    for (size_t i = 0u; i < next_waypoints.size(); ++i) {
+      if (!is_index(next_waypoints[i])) {
+        return false;
+      }
+    }
+    for (size_t i = 0u; i < previous_waypoints.size(); ++i) {
+      if (!is_index(previous_waypoints[i])) {
+        return false;
+      }
+    }
+    return
+        next_offsets.size() == size + 1u &&
+        previous_offsets.size() == size + 1u &&
+        are_offsets(next_offsets, next_waypoints.size()) &&
+        are_offsets(previous_offsets, previous_waypoints.size());
+  }
+
+  void WaypointGraph::Clear() {
+    transforms.Assign({});
+    forward_vectors.Assign({});
+    distances.Assign({});
+    road_ids.Assign({});
+    lane_ids.Assign({});
+    geodesic_grid_ids.Assign({});
+    junction_ids.Assign({});
+    is_junction.Assign({});
+    road_options.Assign({});
+    left_waypoints.Assign({});
+    right_waypoints.Assign({});
+    next_offsets.Assign({});
+    next_waypoints.Assign({});
+    previous_offsets.Assign({});
+    previous_waypoints.Assign({});
+    cache_file.Close();
+  }
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,259 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "carla/CacheFile.h"
+#include "carla/NonCopyable.h"
+#include "carla/geom/Location.h"
+#include "carla/geom/Math.h"
+#include "carla/geom/Transform.h"
+#include "carla/geom/Vector3D.h"
+#include "carla/road/RoadTypes.h"
+
+#include "carla/trafficmanager/SimpleWaypoint.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  namespace cg = carla::geom;
+  namespace crd = carla::road;
+
+  using WaypointIndex = uint32_t;
+  using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>;
+  using NodeList = std::vector<SimpleWaypointPtr>;
+
+  /// Index used for missing links between waypoints.
+  static constexpr WaypointIndex INVALID_WAYPOINT_INDEX = std::numeric_limits<WaypointIndex>::max();
+
+  /// Contiguous list of waypoint indices stored in a WaypointGraph.
+  class WaypointRange {
+  public:
+
+    WaypointRange(const WaypointIndex *begin, const WaypointIndex *end)
+      : _begin(begin),
+        _end(end) {}
+
+    const WaypointIndex *begin() const {
+      return _begin;
+    }
+
+    const WaypointIndex *end() const {
+      return _end;
+    }
+
+    size_t size() const {
+      return static_cast<size_t>(_end - _begin);
+    }
+
+    bool empty() const {
+      return _begin == _end;
+    }
+
+    WaypointIndex front() const {
+      return *_begin;
+    }
+
+    WaypointIndex operator[](size_t i) const {
+      return _begin[i];
+    }
+
+  private:
+
+    const WaypointIndex *_begin;
+
+    const WaypointIndex *_end;
+  };
+
+  /// Array of a waypoint attribute, that either owns its values or points to
+  /// values owned by a memory mapped cache.
+  template <typename T>
+  class WaypointArray {
+  public:
+
+    using value_type = T;
+
+    WaypointArray() = default;
+
+    WaypointArray(const WaypointArray &) = delete;
+    WaypointArray &operator=(const WaypointArray &) = delete;
+
+    const T &operator[](size_t i) const {
+      return _data[i];
+    }
+
+    const T *data() const {
+      return _data;
+    }
+
+    size_t size() const {
+      return _size;
+    }
+
+    /// Takes ownership of @a values.
+    void Assign(std::vector<T> &&values) {
+      _values = std::move(values);
+      _data = _values.data();
+      _size = _values.size();
+    }
+
+    /// Points to @a size values that outlive the array.
+    void View(const T *data, size_t size) {
+      std::vector<T>().swap(_values);
+      _data = data;
+      _size = size;
+    }
+
+  private:
+
+    std::vector<T> _values;
+
+    const T *_data = nullptr;
+
+    size_t _size = 0u;
+  };
+
+  /// Flat representation of the waypoints of the local map. Every waypoint
+  /// is identified by its index in the dense topology. Its attributes are
+  /// stored in contiguous arrays and the links between waypoints in
+  /// compressed sparse row arrays, so that following a path neither chases
+  /// pointers nor touches reference counts.
+  ///
+  /// The arrays can be saved to a binary cache and mapped back in memory as
+  /// they are, without parsing or rebuilding the links.
+  class WaypointGraph : private NonCopyable {
+  public:
+
+    /// Builds the graph from the linked waypoints of @a dense_topology, the
+    /// index of each waypoint being its position in the list.
+    void Build(const NodeList &dense_topology);
+
+    /// Write the graph to the cache file at @a path, keyed by the @a hash of
+    /// the OpenDRIVE content the map was built from. The file is written
+    /// aside and renamed, so other processes never map a half written cache.
+    /// Return false if the file could not be written.
+    bool Save(const std::string &path, uint64_t hash) const;
+
+    /// Map in memory the cache file at @a path and point the graph to it.
+    /// Return false, leaving the graph empty, if the file does not exist, was
+    /// written by another version, platform or OpenDRIVE content, or links
+    /// waypoints out of the graph.
+    bool Load(const std::string &path, uint64_t hash);
+
+    void Clear();
+
+    size_t Size() const {
+      return transforms.size();
+    }
+
+    const cg::Transform &GetTransform(const WaypointIndex index) const {
+      return transforms[index];
+    }
+
+    const cg::Location &GetLocation(const WaypointIndex index) const {
+      return transforms[index].location;
+    }
+
+    const cg::Vector3D &GetForwardVector(const WaypointIndex index) const {
+      return forward_vectors[index];
+    }
+
+    crd::RoadId GetRoadId(const WaypointIndex index) const {
+      return road_ids[index];
+    }
+
+    crd::LaneId GetLaneId(const WaypointIndex index) const {
+      return lane_ids[index];
+    }
+
+    /// Distance along the road, together with the road and lane ids it
+    /// identifies the OpenDRIVE waypoint.
+    double GetDistance(const WaypointIndex index) const {
+      return distances[index];
+    }
+
+    GeoGridId GetGeodesicGridId(const WaypointIndex index) const {
+      return geodesic_grid_ids[index];
+    }
+
+    GeoGridId GetJunctionId(const WaypointIndex index) const {
+      return junction_ids[index];
+    }
+
+    bool CheckJunction(const WaypointIndex index) const {
+      return is_junction[index] != 0u;
+    }
+
+    RoadOption GetRoadOption(const WaypointIndex index) const {
+      return road_options[index];
+    }
+
+    /// Closest waypoint of the left lane, INVALID_WAYPOINT_INDEX if there is
+    /// no lane change to the left.
+    WaypointIndex GetLeftWaypoint(const WaypointIndex index) const {
+      return left_waypoints[index];
+    }
+
+    /// Closest waypoint of the right lane, INVALID_WAYPOINT_INDEX if there is
+    /// no lane change to the right.
+    WaypointIndex GetRightWaypoint(const WaypointIndex index) const {
+      return right_waypoints[index];
+    }
+
+    WaypointRange GetNextWaypoints(const WaypointIndex index) const {
+      return {next_waypoints.data() + next_offsets[index],
+              next_waypoints.data() + next_offsets[index + 1u]};
+    }
+
+    WaypointRange GetPreviousWaypoints(const WaypointIndex index) const {
+      return {previous_waypoints.data() + previous_offsets[index],
+              previous_waypoints.data() + previous_offsets[index + 1u]};
+    }
+
+    float DistanceSquared(const WaypointIndex index, const WaypointIndex other) const {
+      return cg::Math::DistanceSquared(GetLocation(index), GetLocation(other));
+    }
+
+    float DistanceSquared(const WaypointIndex index, const cg::Location &location) const {
+      return cg::Math::DistanceSquared(GetLocation(index), location);
+    }
+
+  private:
+
+    struct CacheHeader;
+
+    /// Whether every link and offset points into the graph.
+    bool IsValid() const;
+
+    WaypointArray<cg::Transform> transforms;
+    WaypointArray<cg::Vector3D> forward_vectors;
+    WaypointArray<double> distances;
+    WaypointArray<crd::RoadId> road_ids;
+    WaypointArray<crd::LaneId> lane_ids;
+    WaypointArray<GeoGridId> geodesic_grid_ids;
+    WaypointArray<GeoGridId> junction_ids;
+    WaypointArray<uint8_t> is_junction;
+    WaypointArray<RoadOption> road_options;
+    WaypointArray<WaypointIndex> left_waypoints;
+    WaypointArray<WaypointIndex> right_waypoints;
+    /// Links of waypoint i are in [offsets[i], offsets[i + 1]).
+    WaypointArray<uint32_t> next_offsets;
+    WaypointArray<WaypointIndex> next_waypoints;
+    WaypointArray<uint32_t> previous_offsets;
+    WaypointArray<WaypointIndex> previous_waypoints;
+
+    /// Cache file the arrays point to, if loaded from one.
+    CacheFile cache_file;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
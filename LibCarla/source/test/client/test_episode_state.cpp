@@ -0,0 +1,189 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/Buffer.h>
+#include <carla/client/detail/EpisodeState.h>
+#include <carla/sensor/Deserializer.h>
+#include <carla/sensor/SensorRegistry.h>
+#include <carla/sensor/data/RawEpisodeState.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+using namespace carla::client::detail;
+using carla::ActorId;
+using carla::sensor::data::ActorDynamicState;
+using carla::sensor::data::RawEpisodeState;
+using Serializer = carla::sensor::s11n::EpisodeStateSerializer;
+
+static constexpr uint64_t EPISODE_ID = 42u;
+
+static ActorDynamicState MakeActor(ActorId id, float x) {
+  ActorDynamicState actor{};
+  actor.id = id;
+  actor.transform.location.x = x;
+  return actor;
+}
+
+template <typename T>
+static void Append(std::vector<unsigned char> &bytes, const T &value) {
+  const auto *begin = reinterpret_cast<const unsigned char *>(&value);
+  bytes.insert(bytes.end(), begin, begin + sizeof(T));
+}
+
+/// Serialize a message of the episode state as the server does, a delta frame
+/// if @a base_frame is not zero.
+static carla::SharedPtr<RawEpisodeState> MakeRawState(
+    uint64_t frame,
+    const std::vector<ActorDynamicState> &actors,
+    uint64_t base_frame = 0u,
+    const std::vector<ActorId> &destroyed = {},
+    uint64_t episode_id = EPISODE_ID) {
+  using namespace carla::sensor;
+  std::vector<unsigned char> bytes;
+
+  s11n::SensorHeaderSerializer::Header sensor_header{};
+  sensor_header.sensor_type = SensorRegistry::get<FWorldObserver *>::index;
+  sensor_header.frame = frame;
+  sensor_header.timestamp = 0.05 * static_cast<double>(frame);
+  Append(bytes, sensor_header);
+
+  Serializer::Header header{};
+  header.episode_id = episode_id;
+  header.delta_seconds = 0.05f;
+  header.simulation_state = base_frame != 0u ?
+      Serializer::SimulationState::DeltaFrame :
+      Serializer::SimulationState::None;
+  Append(bytes, header);
+
+  if (base_frame != 0u) {
+    Serializer::DeltaHeader delta_header;
+    delta_header.base_frame = base_frame;
+    delta_header.destroyed_count = static_cast<uint32_t>(destroyed.size());
+    Append(bytes, delta_header);
+    for (auto id : destroyed) {
+      Append(bytes, id);
+    }
+  }
+  for (auto &&actor : actors) {
+    Append(bytes, actor);
+  }
+
+  carla::Buffer buffer(bytes.data(), bytes.size());
+  return boost::static_pointer_cast<RawEpisodeState>(
+      carla::sensor::Deserializer::Deserialize(std::move(buffer)));
+}
+
+static std::vector<ActorId> GetSortedIds(const EpisodeState &state) {
+  std::vector<ActorId> ids;
+  for (auto id : state.GetActorIds()) {
+    ids.emplace_back(id);
+  }
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+static std::vector<ActorId> GetIds(const RawEpisodeState &raw_state) {
+  auto ids = raw_state.GetDestroyedActorIds();
+  return {ids.begin(), ids.end()};
+}
+
+TEST(episode_state, keyframe) {
+  auto raw = MakeRawState(10u, {MakeActor(1u, 1.0f), MakeActor(2u, 2.0f), MakeActor(130u, 3.0f)});
+  ASSERT_FALSE(raw->IsDeltaFrame());
+  ASSERT_TRUE(raw->GetDestroyedActorIds().empty());
+
+  EpisodeState state(*raw);
+  ASSERT_EQ(state.GetEpisodeId(), EPISODE_ID);
+  ASSERT_EQ(state.GetFrame(), 10u);
+  ASSERT_EQ(state.size(), 3u);
+  ASSERT_EQ(GetSortedIds(state), (std::vector<ActorId>{1u, 2u, 130u}));
+  ASSERT_EQ(state.GetActorSnapshot(130u).transform.location.x, 3.0f);
+  ASSERT_FALSE(state.ContainsActorSnapshot(3u));
+}
+
+TEST(episode_state, destroyed_actor_ids) {
+  auto raw = MakeRawState(11u, {MakeActor(4u, 4.0f)}, 10u, {2u, 130u});
+  ASSERT_TRUE(raw->IsDeltaFrame());
+  ASSERT_EQ(raw->GetBaseFrame(), 10u);
+  ASSERT_EQ(GetIds(*raw), (std::vector<ActorId>{2u, 130u}));
+  // The actors follow the destroyed ids.
+  ASSERT_EQ(raw->size(), 1u);
+  ASSERT_EQ(raw->begin()->id, 4u);
+}
+
+TEST(episode_state, apply_delta) {
+  auto key = MakeRawState(10u, {MakeActor(1u, 1.0f), MakeActor(2u, 2.0f), MakeActor(130u, 3.0f)});
+  EpisodeState previous(*key);
+
+  // Actor 1 moves, 2 is destroyed, 4 is created and 130 does not change.
+  auto delta = MakeRawState(11u, {MakeActor(1u, 10.0f), MakeActor(4u, 4.0f)}, 10u, {2u});
+  EpisodeState next(previous, *delta);
+  ASSERT_EQ(next.GetFrame(), 11u);
+  ASSERT_EQ(next.size(), 3u);
+  ASSERT_EQ(GetSortedIds(next), (std::vector<ActorId>{1u, 4u, 130u}));
+  ASSERT_EQ(next.GetActorSnapshot(1u).transform.location.x, 10.0f);
+  ASSERT_EQ(next.GetActorSnapshot(4u).transform.location.x, 4.0f);
+  ASSERT_EQ(next.GetActorSnapshot(130u).transform.location.x, 3.0f);
+
+  // The previous state is not modified.
+  ASSERT_EQ(previous.size(), 3u);
+  ASSERT_EQ(GetSortedIds(previous), (std::vector<ActorId>{1u, 2u, 130u}));
+  ASSERT_EQ(previous.GetActorSnapshot(1u).transform.location.x, 1.0f);
+}
+
+TEST(episode_state, copy_on_write_buckets) {
+  std::vector<ActorDynamicState> actors;
+  for (ActorId id = 1u; id <= 256u; ++id) {
+    actors.emplace_back(MakeActor(id, static_cast<float>(id)));
+  }
+  EpisodeState previous(*MakeRawState(10u, actors));
+
+  auto delta = MakeRawState(11u, {MakeActor(5u, 0.0f), MakeActor(300u, 0.0f)}, 10u, {7u});
+  EpisodeState next(previous, *delta);
+  ASSERT_EQ(next.size(), 256u);
+
+  // Only the buckets of the actors in the delta are copied.
+  ASSERT_FALSE(next.SharesBucketWith(previous, 5u));
+  ASSERT_FALSE(next.SharesBucketWith(previous, 300u));
+  ASSERT_FALSE(next.SharesBucketWith(previous, 7u));
+  size_t shared = 0u;
+  for (ActorId id = 1u; id <= 256u; ++id) {
+    if (next.SharesBucketWith(previous, id)) {
+      ++shared;
+      ASSERT_EQ(next.GetActorSnapshot(id).transform.location.x, static_cast<float>(id));
+    }
+  }
+  ASSERT_GT(shared, 0u);
+  ASSERT_LT(shared, 256u);
+}
+
+TEST(episode_state, recover_after_missed_frame) {
+  auto previous = EpisodeState::MakeNext(
+      EpisodeState{EPISODE_ID},
+      *MakeRawState(10u, {MakeActor(1u, 1.0f), MakeActor(2u, 2.0f)}));
+  ASSERT_NE(previous, nullptr);
+  ASSERT_EQ(previous->GetFrame(), 10u);
+
+  // Frame 11 is missed, the delta of frame 12 cannot be applied.
+  ASSERT_EQ(EpisodeState::MakeNext(*previous, *MakeRawState(12u, {MakeActor(1u, 12.0f)}, 11u)), nullptr);
+  // Neither can a delta of another episode.
+  ASSERT_EQ(EpisodeState::MakeNext(*previous, *MakeRawState(11u, {}, 10u, {}, EPISODE_ID + 1u)), nullptr);
+
+  // The keyframe sent after the missed frame replaces the state.
+  auto keyframe = EpisodeState::MakeNext(*previous, *MakeRawState(13u, {MakeActor(1u, 13.0f)}));
+  ASSERT_NE(keyframe, nullptr);
+  ASSERT_EQ(keyframe->GetFrame(), 13u);
+  ASSERT_EQ(GetSortedIds(*keyframe), (std::vector<ActorId>{1u}));
+
+  // And the deltas that follow apply again.
+  auto next = EpisodeState::MakeNext(*keyframe, *MakeRawState(14u, {MakeActor(1u, 14.0f)}, 13u));
+  ASSERT_NE(next, nullptr);
+  ASSERT_EQ(next->GetActorSnapshot(1u).transform.location.x, 14.0f);
+}
@@ -0,0 +1,250 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/FileSystem.h>
+#include <carla/Fnv1aHash.h>
+#include <carla/client/FileTransfer.h>
+#include <carla/client/detail/Client.h>
+#include <carla/rpc/FileInfo.h>
+#include <carla/rpc/Response.h>
+#include <carla/rpc/Server.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using carla::client::FileTransfer;
+using carla::rpc::FileInfo;
+
+template <typename T>
+using R = carla::rpc::Response<T>;
+
+static constexpr size_t MiB = 1u << 20u;
+
+static uint16_t GetPort(uint16_t offset) {
+  return static_cast<uint16_t>((TESTING_PORT != 0u ? TESTING_PORT : 2017u) + offset);
+}
+
+static FileInfo GetInfo(const std::string &content) {
+  carla::Fnv1aHash hash;
+  hash.Update(content.data(), content.size());
+  FileInfo info;
+  info.size = content.size();
+  info.hash = hash.Get();
+  return info;
+}
+
+static std::string MakeContent(size_t size, char seed) {
+  std::string content(size, '\0');
+  for (size_t i = 0u; i < size; ++i) {
+    content[i] = static_cast<char>((i * 31u + static_cast<size_t>(seed)) % 251u);
+  }
+  return content;
+}
+
+static void WriteRaw(std::string path, const std::string &content) {
+  carla::FileSystem::ValidateFilePath(path);
+  std::ofstream out(path, std::ios::trunc | std::ios::binary);
+  out.write(content.data(), static_cast<std::streamsize>(content.size()));
+}
+
+static std::string ReadRaw(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+static bool Exists(const std::string &path) {
+  return std::ifstream(path).good();
+}
+
+/// Points the cache of the file transfer to a folder of the test for the
+/// lifetime of the object.
+class TestCacheFolder {
+public:
+
+  TestCacheFolder() : _previous(FileTransfer::GetFilesBaseFolder()) {
+    FileTransfer::SetFilesBaseFolder("test_file_transfer_cache");
+  }
+
+  ~TestCacheFolder() {
+    FileTransfer::SetFilesBaseFolder(_previous);
+  }
+
+private:
+
+  const std::string _previous;
+};
+
+/// Serves the files in @a files with the file transfer calls of the
+/// simulator, counting the bytes sent.
+class TestFileServer {
+public:
+
+  explicit TestFileServer(uint16_t port) : _server(port) {
+    _server.BindAsync("get_file_info", [this](std::string name) -> R<FileInfo> {
+      ++info_requests;
+      const auto it = files.find(name);
+      if ((name.find("..") != std::string::npos) || (it == files.end())) {
+        return carla::rpc::ResponseError("unable to open file");
+      }
+      return GetInfo(it->second);
+    });
+    _server.BindAsync("request_file_chunk", [this](std::string name, uint64_t offset, uint32_t size)
+        -> R<std::vector<uint8_t>> {
+      const auto it = files.find(name);
+      if ((it == files.end()) || (offset > it->second.size())) {
+        return carla::rpc::ResponseError("unable to read file");
+      }
+      const auto count = std::min<uint64_t>(size, it->second.size() - offset);
+      const auto begin = it->second.begin() + static_cast<std::ptrdiff_t>(offset);
+      bytes_sent += count;
+      return std::vector<uint8_t>(begin, begin + static_cast<std::ptrdiff_t>(count));
+    });
+    _server.AsyncRun(2u);
+  }
+
+  std::map<std::string, std::string> files;
+
+  std::atomic_size_t info_requests{0u};
+
+  std::atomic_size_t bytes_sent{0u};
+
+private:
+
+  carla::rpc::Server _server;
+};
+
+TEST(file_transfer, is_file_valid) {
+  TestCacheFolder folder;
+  const std::string name = "is_file_valid.bin";
+  const auto content = MakeContent(1000u, 1);
+  const auto info = GetInfo(content);
+  std::remove(FileTransfer::GetFullPath(name).c_str());
+  ASSERT_FALSE(FileTransfer::IsFileValid(name, info));
+
+  WriteRaw(FileTransfer::GetFullPath(name), content);
+  ASSERT_TRUE(FileTransfer::IsFileValid(name, info));
+  auto other_hash = info;
+  other_hash.hash += 1u;
+  ASSERT_FALSE(FileTransfer::IsFileValid(name, other_hash));
+  auto other_size = info;
+  other_size.size += 1u;
+  ASSERT_FALSE(FileTransfer::IsFileValid(name, other_size));
+  std::remove(FileTransfer::GetFullPath(name).c_str());
+}
+
+TEST(file_transfer, partial_file) {
+  TestCacheFolder folder;
+  const std::string name = "partial_file.bin";
+  const auto content = MakeContent(1000u, 2);
+  const auto info = GetInfo(content);
+  const auto partial = FileTransfer::GetPartialPath(name, info);
+  std::remove(FileTransfer::GetFullPath(name).c_str());
+  std::remove(partial.c_str());
+  ASSERT_EQ(FileTransfer::GetPartialSize(name, info), 0u);
+
+  // Another content is downloaded to another file.
+  const auto other_info = GetInfo(MakeContent(1000u, 3));
+  ASSERT_NE(FileTransfer::GetPartialPath(name, other_info), partial);
+
+  WriteRaw(partial, content.substr(0u, 400u));
+  ASSERT_EQ(FileTransfer::GetPartialSize(name, info), 400u);
+
+  // A partial file longer than the content is discarded.
+  WriteRaw(partial, content + "tail");
+  ASSERT_EQ(FileTransfer::GetPartialSize(name, info), 0u);
+  ASSERT_FALSE(Exists(partial));
+
+  // Content that does not match is discarded and not committed.
+  WriteRaw(partial, MakeContent(1000u, 4));
+  ASSERT_FALSE(FileTransfer::CommitPartial(name, info));
+  ASSERT_FALSE(Exists(partial));
+  ASSERT_FALSE(Exists(FileTransfer::GetFullPath(name)));
+
+  WriteRaw(partial, content);
+  ASSERT_TRUE(FileTransfer::CommitPartial(name, info));
+  ASSERT_FALSE(Exists(partial));
+  ASSERT_TRUE(FileTransfer::IsFileValid(name, info));
+  std::remove(FileTransfer::GetFullPath(name).c_str());
+}
+
+TEST(file_transfer, request_file_resumes_partial_file) {
+  TestCacheFolder folder;
+  const std::string name = "resume.bin";
+  const auto content = MakeContent(10u * MiB, 5);
+  const auto info = GetInfo(content);
+  std::remove(FileTransfer::GetFullPath(name).c_str());
+
+  TestFileServer server(GetPort(1u));
+  server.files[name] = content;
+  carla::client::detail::Client client("localhost", GetPort(1u));
+
+  // A previous transfer stopped after 5 MiB.
+  WriteRaw(FileTransfer::GetPartialPath(name, info), content.substr(0u, 5u * MiB));
+  client.RequestFile(name);
+  ASSERT_EQ(server.bytes_sent.load(), content.size() - 5u * MiB);
+  ASSERT_TRUE(FileTransfer::IsFileValid(name, info));
+  ASSERT_FALSE(Exists(FileTransfer::GetPartialPath(name, info)));
+  ASSERT_EQ(ReadRaw(FileTransfer::GetFullPath(name)), content);
+
+  // Already in the cache.
+  client.RequestFile(name);
+  ASSERT_EQ(server.bytes_sent.load(), content.size() - 5u * MiB);
+  std::remove(FileTransfer::GetFullPath(name).c_str());
+}
+
+TEST(file_transfer, request_file_downloads_again_on_hash_mismatch) {
+  TestCacheFolder folder;
+  const std::string name = "mismatch.bin";
+  const auto content = MakeContent(6u * MiB, 6);
+  const auto info = GetInfo(content);
+
+  TestFileServer server(GetPort(2u));
+  server.files[name] = content;
+  carla::client::detail::Client client("localhost", GetPort(2u));
+
+  // The cached file has the size of the server's but other content.
+  WriteRaw(FileTransfer::GetFullPath(name), MakeContent(6u * MiB, 7));
+  client.RequestFile(name);
+  ASSERT_EQ(server.bytes_sent.load(), content.size());
+  ASSERT_EQ(ReadRaw(FileTransfer::GetFullPath(name)), content);
+
+  // A corrupt partial file fails the hash check, it is discarded and the next
+  // request downloads the whole file.
+  std::remove(FileTransfer::GetFullPath(name).c_str());
+  WriteRaw(FileTransfer::GetPartialPath(name, info), MakeContent(MiB, 8));
+  server.bytes_sent = 0u;
+  ASSERT_THROW(client.RequestFile(name), std::runtime_error);
+  ASSERT_EQ(server.bytes_sent.load(), content.size() - MiB);
+  ASSERT_FALSE(Exists(FileTransfer::GetPartialPath(name, info)));
+  ASSERT_FALSE(Exists(FileTransfer::GetFullPath(name)));
+  server.bytes_sent = 0u;
+  client.RequestFile(name);
+  ASSERT_EQ(server.bytes_sent.load(), content.size());
+  ASSERT_TRUE(FileTransfer::IsFileValid(name, info));
+  std::remove(FileTransfer::GetFullPath(name).c_str());
+}
+
+TEST(file_transfer, request_file_rejects_parent_path) {
+  TestCacheFolder folder;
+  const std::string name = "../outside.bin";
+  TestFileServer server(GetPort(3u));
+  server.files[name] = MakeContent(1000u, 9);
+  carla::client::detail::Client client("localhost", GetPort(3u));
+
+  ASSERT_THROW(client.RequestFile(name), std::invalid_argument);
+  ASSERT_EQ(server.info_requests.load(), 0u);
+  ASSERT_FALSE(Exists(FileTransfer::GetFullPath(name)));
+}
@@ -6,11 +6,15 @@
 
 #include "test.h"
 
+#include <carla/image/ColorConverterKernels.h>
 #include <carla/image/ImageConverter.h>
 #include <carla/image/ImageIO.h>
 #include <carla/image/ImageView.h>
 
+#include <chrono>
 #include <memory>
+#include <random>
+#include <vector>
 
 template <typename ViewT, typename PixelT>
 struct TestImage {
@@ -186,3 +190,119 @@ TEST(image, semantic_segmentation) {
     }
   }
 }
+
+using carla::image::ColorConverterKernels;
+
+static std::vector<carla::sensor::data::Color> MakeRandomColors(size_t size) {
+  std::vector<carla::sensor::data::Color> colors(size);
+  std::mt19937 engine(42u);
+  std::uniform_int_distribution<int> distribution(0, 255);
+  auto channel = [&]() { return static_cast<uint8_t>(distribution(engine)); };
+  for (auto &color : colors) {
+    color = carla::sensor::data::Color{channel(), channel(), channel(), channel()};
+  }
+  return colors;
+}
+
+/// Convert @a colors with the Boost.GIL converter, as Image.convert did.
+template <typename CC>
+static void ConvertWithGil(std::vector<carla::sensor::data::Color> &colors, CC converter) {
+  using namespace carla::image;
+  auto view = boost::gil::interleaved_view(
+      colors.size(),
+      1u,
+      reinterpret_cast<boost::gil::bgra8_pixel_t *>(colors.data()),
+      static_cast<long>(sizeof(carla::sensor::data::Color) * colors.size()));
+  ImageConverter::ConvertInPlace(view, converter);
+}
+
+static std::vector<ColorConverterKernels::InstructionSet> GetSupportedInstructionSets() {
+  using InstructionSet = ColorConverterKernels::InstructionSet;
+  std::vector<InstructionSet> result;
+  for (auto instruction_set : {InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::AVX2}) {
+    if (static_cast<int>(instruction_set) <= static_cast<int>(ColorConverterKernels::GetInstructionSet())) {
+      result.push_back(instruction_set);
+    }
+  }
+  return result;
+}
+
+/// Compare every channel, including alpha, allowing a @a tolerance.
+template <typename CC>
+static void CheckKernels(CC converter, int tolerance) {
+  // Odd size to exercise the scalar tail of the vectorized kernels.
+  const auto source = MakeRandomColors(100003u);
+  auto expected = source;
+  ConvertWithGil(expected, converter);
+  for (auto instruction_set : GetSupportedInstructionSets()) {
+    auto colors = source;
+    ColorConverterKernels::ConvertInPlace(
+        colors.data(),
+        colors.data() + colors.size(),
+        converter,
+        instruction_set);
+    const auto *lhs = reinterpret_cast<const uint8_t *>(colors.data());
+    const auto *rhs = reinterpret_cast<const uint8_t *>(expected.data());
+    for (auto i = 0u; i < 4u * colors.size(); ++i) {
+      ASSERT_NEAR(int(lhs[i]), int(rhs[i]), tolerance)
+          << ColorConverterKernels::GetInstructionSetName(instruction_set)
+          << " at channel " << i;
+    }
+  }
+}
+
+TEST(image, kernels_depth) {
+  CheckKernels(carla::image::ColorConverter::Depth(), 0);
+}
+
+TEST(image, kernels_logarithmic_depth) {
+  CheckKernels(carla::image::ColorConverter::LogarithmicDepth(), 1);
+}
+
+TEST(image, kernels_semantic_segmentation) {
+  CheckKernels(carla::image::ColorConverter::CityScapesPalette(), 0);
+}
+
+TEST(image, kernels_benchmark) {
+#ifndef NDEBUG
+  carla::log_info("This test only happens in release (too slow).");
+#else
+  using namespace carla::image;
+  using clock = std::chrono::steady_clock;
+  constexpr auto number_of_frames = 20u;
+  const auto source = MakeRandomColors(1920u * 1080u);
+  auto colors = source;
+
+  auto benchmark = [&](const char *name, auto convert) {
+    auto elapsed = clock::duration::zero();
+    for (auto i = 0u; i < number_of_frames; ++i) {
+      colors = source;
+      const auto begin = clock::now();
+      convert();
+      elapsed += clock::now() - begin;
+    }
+    const auto ms = std::chrono::duration<double, std::milli>(elapsed).count() / number_of_frames;
+    carla::logging::log(name, "1920x1080:", ms, "ms");
+  };
+
+  auto run = [&](const char *name, auto converter) {
+    benchmark(name, [&]() { ConvertWithGil(colors, converter); });
+    for (auto instruction_set : GetSupportedInstructionSets()) {
+      benchmark(ColorConverterKernels::GetInstructionSetName(instruction_set), [&]() {
+        ColorConverterKernels::ConvertInPlace(
+            colors.data(),
+            colors.data() + colors.size(),
+            converter,
+            instruction_set);
+      });
+    }
+  };
+
+  carla::logging::log("-- Depth, Boost.GIL and kernels --");
+  run("Boost.GIL", ColorConverter::Depth());
+  carla::logging::log("-- LogarithmicDepth, Boost.GIL and kernels --");
+  run("Boost.GIL", ColorConverter::LogarithmicDepth());
+  carla::logging::log("-- CityScapesPalette, Boost.GIL and kernels --");
+  run("Boost.GIL", ColorConverter::CityScapesPalette());
+#endif // NDEBUG
+}
@@ -0,0 +1,59 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/trafficmanager/KnownActors.h>
+
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
+
+using namespace carla::traffic_manager;
+
+static std::vector<ActorId> Sorted(std::vector<ActorId> ids) {
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+TEST(known_actors, identify_created_once) {
+  KnownActors known_actors;
+  ASSERT_EQ(Sorted(known_actors.IdentifyCreated({3u, 1u, 2u})), (std::vector<ActorId>{1u, 2u, 3u}));
+  ASSERT_TRUE(known_actors.IdentifyCreated({3u, 1u, 2u}).empty());
+  ASSERT_EQ(known_actors.IdentifyCreated({1u, 2u, 3u, 4u}), (std::vector<ActorId>{4u}));
+}
+
+TEST(known_actors, forget_destroyed) {
+  KnownActors known_actors;
+  known_actors.IdentifyCreated({1u, 2u, 3u});
+  const std::unordered_set<ActorId> alive = {1u, 3u};
+  known_actors.ForgetDestroyed([&](ActorId id) { return alive.count(id) != 0u; });
+  // An actor id reused by the simulator after a destruction is new.
+  ASSERT_EQ(known_actors.IdentifyCreated({1u, 2u, 3u}), (std::vector<ActorId>{2u}));
+}
+
+// Follows the order of ALSM::Update when an unregistered hero vehicle is
+// registered: the actor is removed as unregistered, which forgets it, and
+// must be identified again, as a hero, in the same update.
+TEST(known_actors, identified_again_in_same_update_after_removal) {
+  KnownActors known_actors;
+  const std::vector<ActorId> current_ids = {10u, 11u};
+  known_actors.IdentifyCreated(current_ids);
+
+  known_actors.ForgetDestroyed([](ActorId) { return true; });
+  known_actors.Forget(11u);
+  ASSERT_EQ(known_actors.IdentifyCreated(current_ids), (std::vector<ActorId>{11u}));
+
+  known_actors.ForgetDestroyed([](ActorId) { return true; });
+  ASSERT_TRUE(known_actors.IdentifyCreated(current_ids).empty());
+}
+
+TEST(known_actors, clear) {
+  KnownActors known_actors;
+  known_actors.IdentifyCreated({1u, 2u});
+  known_actors.Clear();
+  ASSERT_EQ(Sorted(known_actors.IdentifyCreated({2u, 1u})), (std::vector<ActorId>{1u, 2u}));
+}
@@ -0,0 +1,209 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/geom/Location.h>
+#include <carla/geom/Mesh.h>
+#include <carla/geom/Transform.h>
+#include <carla/nav/NavMeshBuilder.h>
+#include <carla/nav/Navigation.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace carla::geom;
+using namespace carla::nav;
+using carla::ActorId;
+
+// Height of the walkers pivot over the ground.
+static constexpr float PIVOT = 0.9f;
+
+// Navigation mesh of a flat square sidewalk with a corner in the origin.
+static std::vector<uint8_t> MakeSidewalk(float size) {
+  Mesh mesh;
+  mesh.AddMaterial("sidewalk");
+  mesh.AddTriangleFan({
+      {0.0f, 0.0f, 0.0f},
+      {size, 0.0f, 0.0f},
+      {size, size, 0.0f},
+      {0.0f, size, 0.0f}});
+  mesh.EndMaterial();
+  NavMeshSettings settings;
+  settings.cell_size = 0.2f;
+  settings.tile_size = 64;
+  NavMeshBuilder builder(settings);
+  EXPECT_TRUE(builder.Build(mesh));
+  return builder.Serialize();
+}
+
+static float Distance2D(const Location &a, const Location &b) {
+  return Location(a.x - b.x, a.y - b.y, 0.0f).Length();
+}
+
+TEST(navigation, walkers_in_several_tiles) {
+  Navigation nav;
+  ASSERT_TRUE(nav.Load(MakeSidewalk(60.0f)));
+  nav.SetCrowdSettings(100u, 10.0f, 2u);
+  EXPECT_GT(nav.GetCrowdCount(), 1u);
+
+  // a walker near the right border of several tiles
+  std::vector<Location> starts;
+  for (float y = 5.0f; y < 60.0f; y += 20.0f) {
+    for (float x = 8.0f; x < 50.0f; x += 10.0f) {
+      starts.emplace_back(x, y, PIVOT);
+    }
+  }
+  for (size_t i = 0u; i < starts.size(); ++i) {
+    const ActorId id = static_cast<ActorId>(i + 1u);
+    ASSERT_TRUE(nav.AddWalker(id, starts[i]));
+    Location location;
+    ASSERT_TRUE(nav.GetWalkerPosition(id, location));
+    EXPECT_LT(Distance2D(location, starts[i]), 0.5f);
+  }
+
+  // walk into the next tile
+  for (size_t i = 0u; i < starts.size(); ++i) {
+    const Location target(starts[i].x + 6.0f, starts[i].y, PIVOT);
+    EXPECT_TRUE(nav.SetWalkerDirectTarget(static_cast<ActorId>(i + 1u), target));
+  }
+  for (int step = 0; step < 30; ++step) {
+    nav.UpdateCrowd(0.1);
+  }
+  std::vector<Location> ends(starts.size());
+  for (size_t i = 0u; i < starts.size(); ++i) {
+    const ActorId id = static_cast<ActorId>(i + 1u);
+    ASSERT_TRUE(nav.GetWalkerPosition(id, ends[i]));
+    EXPECT_GT(ends[i].x, starts[i].x + 3.0f);
+    EXPECT_NEAR(ends[i].y, starts[i].y, 1.0f);
+    bool alive = false;
+    ASSERT_TRUE(nav.IsWalkerAlive(id, alive));
+    EXPECT_TRUE(alive);
+  }
+
+  // back to a single crowd, the walkers keep their position
+  nav.SetCrowdSettings(100u, 0.0f, 1u);
+  EXPECT_EQ(nav.GetCrowdCount(), 1u);
+  for (size_t i = 0u; i < starts.size(); ++i) {
+    Location location;
+    ASSERT_TRUE(nav.GetWalkerPosition(static_cast<ActorId>(i + 1u), location));
+    EXPECT_LT(Distance2D(location, ends[i]), 0.1f);
+  }
+}
+
+TEST(navigation, tile_grows_up_to_max_agents) {
+  Navigation nav;
+  ASSERT_TRUE(nav.Load(MakeSidewalk(60.0f)));
+  nav.SetCrowdSettings(150u, 10.0f, 1u);
+
+  // more walkers than the initial capacity of a tile, all in the same tile
+  size_t added = 0u;
+  for (ActorId id = 1u; id <= 200u; ++id) {
+    const float offset = 0.02f * static_cast<float>(id);
+    if (nav.AddWalker(id, Location(4.0f + offset, 6.0f - offset, PIVOT))) {
+      ++added;
+    }
+  }
+  EXPECT_EQ(added, 150u);
+
+  size_t agents = 0u;
+  nav.ForEachAgent([&](const dtCrowdAgent &) { ++agents; });
+  EXPECT_EQ(agents, 150u);
+  for (ActorId id = 1u; id <= 150u; ++id) {
+    Location location;
+    ASSERT_TRUE(nav.GetWalkerPosition(id, location));
+    EXPECT_LT(location.x, 10.0f);
+    EXPECT_LT(location.y, 10.0f);
+  }
+  nav.UpdateCrowd(0.1);
+  for (ActorId id = 1u; id <= 150u; ++id) {
+    Transform transform;
+    EXPECT_TRUE(nav.GetWalkerTransform(id, transform));
+  }
+}
+
+TEST(navigation, walker_states_published_by_update) {
+  Navigation nav;
+  ASSERT_TRUE(nav.Load(MakeSidewalk(60.0f)));
+  nav.SetCrowdSettings(100u, 10.0f, 2u);
+
+  constexpr ActorId WALKERS = 20u;
+  for (ActorId id = 1u; id <= WALKERS; ++id) {
+    const float offset = 2.5f * static_cast<float>(id);
+    ASSERT_TRUE(nav.AddWalker(id, Location(offset, 30.0f, PIVOT)));
+  }
+  EXPECT_TRUE(nav.GetWalkerStates()->empty());
+
+  nav.UpdateCrowd(0.1);
+  const auto states = nav.GetWalkerStates();
+  ASSERT_EQ(states->size(), WALKERS);
+  for (ActorId id = 1u; id <= WALKERS; ++id) {
+    const WalkerState &state = states->at(id);
+    EXPECT_TRUE(state.active);
+    EXPECT_TRUE(state.alive);
+    Location location;
+    ASSERT_TRUE(nav.GetWalkerPosition(id, location));
+    EXPECT_EQ(state.transform.location, location);
+    Transform transform;
+    ASSERT_TRUE(nav.GetWalkerTransform(id, transform));
+    EXPECT_EQ(state.transform.rotation.yaw, transform.rotation.yaw);
+  }
+
+  // the published states are kept by the readers until the next update
+  ASSERT_TRUE(nav.RemoveAgent(1u));
+  EXPECT_EQ(states->count(1u), 1u);
+  nav.UpdateCrowd(0.1);
+  EXPECT_EQ(nav.GetWalkerStates()->count(1u), 0u);
+  EXPECT_EQ(nav.GetWalkerStates()->size(), WALKERS - 1u);
+}
+
+TEST(navigation, add_walkers_while_updating) {
+  Navigation nav;
+  ASSERT_TRUE(nav.Load(MakeSidewalk(60.0f)));
+  nav.SetCrowdSettings(1000u, 10.0f, 2u);
+
+  constexpr ActorId WALKERS = 300u;
+  std::atomic<ActorId> added{0u};
+  std::atomic_bool done{false};
+  // the tick thread reads the walkers while the user thread adds them, which grows the tile crowd
+  std::thread tick([&]() {
+    while (!done) {
+      nav.UpdateCrowd(0.001);
+      for (ActorId id = 1u; id <= added; ++id) {
+        Transform transform;
+        bool alive = false;
+        EXPECT_TRUE(nav.GetWalkerTransform(id, transform));
+        EXPECT_TRUE(nav.IsWalkerAlive(id, alive));
+        nav.GetWalkerSpeed(id);
+      }
+      for (auto &&state : *nav.GetWalkerStates()) {
+        EXPECT_LE(state.first, WALKERS);
+      }
+    }
+  });
+  for (ActorId id = 1u; id <= WALKERS; ++id) {
+    const float offset = 0.01f * static_cast<float>(id);
+    // no ASSERT while the tick thread is running, it would be left joinable
+    const bool walker_added = nav.AddWalker(id, Location(4.0f + offset, 6.0f - offset, PIVOT));
+    EXPECT_TRUE(walker_added);
+    if (!walker_added) {
+      break;
+    }
+    added = id;
+    if (id == WALKERS / 2u) {
+      nav.SetCrowdSettings(1000u, 20.0f, 2u);
+    }
+  }
+  done = true;
+  tick.join();
+
+  ASSERT_EQ(added, WALKERS);
+  for (ActorId id = 1u; id <= WALKERS; ++id) {
+    Location location;
+    EXPECT_TRUE(nav.GetWalkerPosition(id, location));
+  }
+}
@@ -0,0 +1,136 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/geom/Location.h>
+#include <carla/geom/Mesh.h>
+#include <carla/nav/NavMeshBuilder.h>
+#include <carla/nav/Navigation.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace carla::geom;
+using namespace carla::nav;
+
+// Flat sidewalk with its corners in (min_x, min_y) and (max_x, max_y).
+static Mesh MakeSidewalk(float min_x, float min_y, float max_x, float max_y) {
+  Mesh mesh;
+  mesh.AddMaterial("sidewalk");
+  mesh.AddTriangleFan({
+      {min_x, min_y, 0.0f},
+      {max_x, min_y, 0.0f},
+      {max_x, max_y, 0.0f},
+      {min_x, max_y, 0.0f}});
+  mesh.EndMaterial();
+  return mesh;
+}
+
+// Two sidewalks, 20 meters apart.
+static Mesh MakeTwoSidewalks() {
+  return MakeSidewalk(0.0f, 0.0f, 100.0f, 20.0f) + MakeSidewalk(0.0f, 40.0f, 100.0f, 60.0f);
+}
+
+static NavMeshSettings MakeSettings(unsigned int worker_threads) {
+  NavMeshSettings settings;
+  settings.cell_size = 0.2f;
+  settings.tile_size = 64;
+  settings.worker_threads = worker_threads;
+  return settings;
+}
+
+static bool HasPath(const std::vector<uint8_t> &content, Location from, Location to) {
+  Navigation nav;
+  if (!nav.Load(content)) {
+    return false;
+  }
+  std::vector<Location> path;
+  std::vector<unsigned char> area;
+  if (!nav.GetPath(from, to, nullptr, path, area) || path.empty()) {
+    return false;
+  }
+  return path.back().Distance(to) < 1.0f;
+}
+
+TEST(navmesh_builder, build_tiled_mesh) {
+  NavMeshBuilder builder(MakeSettings(2u));
+  ASSERT_TRUE(builder.Build(MakeSidewalk(0.0f, 0.0f, 100.0f, 60.0f)));
+  // 12.8 meters tiles
+  EXPECT_EQ(builder.GetGridSize(), 8u * 5u);
+  EXPECT_EQ(builder.GetTileCount(), 8u * 5u);
+
+  const auto content = builder.Serialize();
+  Navigation nav;
+  ASSERT_TRUE(nav.Load(content));
+  Location location;
+  ASSERT_TRUE(nav.GetRandomLocation(location));
+  EXPECT_GE(location.x, 0.0f);
+  EXPECT_LE(location.x, 100.0f);
+  EXPECT_GE(location.y, 0.0f);
+  EXPECT_LE(location.y, 60.0f);
+
+  // across several tiles
+  EXPECT_TRUE(HasPath(content, Location(5.0f, 5.0f, 0.0f), Location(95.0f, 55.0f, 0.0f)));
+}
+
+TEST(navmesh_builder, no_walkable_area) {
+  Mesh mesh;
+  mesh.AddMaterial("wall");
+  mesh.AddTriangleFan({{0.0f, 0.0f, 0.0f}, {10.0f, 0.0f, 0.0f}, {10.0f, 10.0f, 0.0f}});
+  mesh.EndMaterial();
+  NavMeshBuilder builder(MakeSettings(1u));
+  EXPECT_FALSE(builder.Build(mesh));
+  EXPECT_FALSE(builder.Build(Mesh()));
+  EXPECT_TRUE(builder.Serialize().empty());
+}
+
+TEST(navmesh_builder, same_result_with_any_number_of_threads) {
+  const auto mesh = MakeTwoSidewalks();
+  NavMeshBuilder builder_1(MakeSettings(1u));
+  NavMeshBuilder builder_4(MakeSettings(4u));
+  ASSERT_TRUE(builder_1.Build(mesh));
+  ASSERT_TRUE(builder_4.Build(mesh));
+  EXPECT_EQ(builder_1.Serialize(), builder_4.Serialize());
+}
+
+TEST(navmesh_builder, rebuild_changed_region) {
+  NavMeshBuilder builder(MakeSettings(2u));
+  ASSERT_TRUE(builder.Build(MakeTwoSidewalks()));
+  const Location from(50.0f, 10.0f, 0.0f);
+  const Location to(50.0f, 50.0f, 0.0f);
+  EXPECT_FALSE(HasPath(builder.Serialize(), from, to));
+
+  // join both sidewalks
+  const Location min(45.0f, 20.0f, 0.0f);
+  const Location max(55.0f, 40.0f, 0.0f);
+  const auto joined = MakeTwoSidewalks() + MakeSidewalk(min.x, min.y, max.x, max.y);
+  const size_t rebuilt = builder.Rebuild(joined, min, max);
+  EXPECT_GT(rebuilt, 0u);
+  EXPECT_LT(rebuilt, builder.GetGridSize());
+  EXPECT_TRUE(HasPath(builder.Serialize(), from, to));
+
+  NavMeshBuilder full(MakeSettings(2u));
+  ASSERT_TRUE(full.Build(joined));
+  EXPECT_EQ(builder.GetTileCount(), full.GetTileCount());
+
+  // geometry out of the grid needs all the tiles
+  const auto bigger = joined + MakeSidewalk(100.0f, 0.0f, 120.0f, 20.0f);
+  const size_t rebuilt_all = builder.Rebuild(
+      bigger, Location(100.0f, 0.0f, 0.0f), Location(120.0f, 20.0f, 0.0f));
+  EXPECT_EQ(rebuilt_all, builder.GetGridSize());
+}
+
+TEST(navmesh_builder, save_and_load_file) {
+  NavMeshBuilder builder(MakeSettings(2u));
+  ASSERT_TRUE(builder.Build(MakeTwoSidewalks()));
+  const std::string filename = "test_navmesh_builder.bin";
+  ASSERT_TRUE(builder.Save(filename));
+  Navigation nav;
+  EXPECT_TRUE(nav.Load(filename));
+  std::remove(filename.c_str());
+}
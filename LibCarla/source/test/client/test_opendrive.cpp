@@ -10,10 +10,13 @@
 
 #include <carla/StopWatch.h>
 #include <carla/ThreadPool.h>
+#include <carla/WorkStealingPool.h>
 #include <carla/geom/Location.h>
 #include <carla/geom/Math.h>
 #include <carla/opendrive/OpenDriveParser.h>
 #include <carla/road/MapBuilder.h>
+#include <carla/road/MapCache.h>
+#include <carla/road/element/Geometry.h>
 #include <carla/road/element/RoadInfoElevation.h>
 #include <carla/road/element/RoadInfoGeometry.h>
 #include <carla/road/element/RoadInfoMarkRecord.h>
@@ -21,6 +24,7 @@
 
 #include <pugixml/pugixml.hpp>
 
+#include <cstdio>
 #include <fstream>
 #include <string>
 
@@ -301,6 +305,34 @@ TEST(road, parse_geometry) {
 
 }
 
+TEST(road, geometry_arc_length_table) {
+  const GeometryPoly3 poly3(0.0, 50.0, 0.3, Location(10.0f, 5.0f, 0.0f), 0.0, 0.1, 0.01, -0.0002);
+  const GeometryParamPoly3 param_poly3(
+      0.0, 40.0, -0.5, Location(1.0f, 2.0f, 0.0f),
+      0.0, 1.0, 0.0, 0.0, 0.0, 0.0, 0.02, 0.0001, true);
+  const GeometrySpiral spiral(0.0, 30.0, 1.0, Location(3.0f, 4.0f, 0.0f), 0.0, 0.05);
+
+  for (const Geometry *geometry : {
+      static_cast<const Geometry *>(&poly3),
+      static_cast<const Geometry *>(&param_poly3),
+      static_cast<const Geometry *>(&spiral)}) {
+    std::vector<double> dists;
+    for (double s = 0.0; s < geometry->GetLength(); s += 0.37) {
+      dists.emplace_back(s);
+    }
+    const auto points = geometry->PosFromDist(dists);
+    ASSERT_EQ(points.size(), dists.size());
+    for (size_t i = 0u; i < dists.size(); ++i) {
+      auto point = geometry->PosFromDist(dists[i]);
+      ASSERT_EQ(point, points[i]);
+      point.ApplyLateralOffset(1.5f);
+      const auto distance = geometry->DistanceTo(point.location);
+      ASSERT_NEAR(distance.first, dists[i], 0.05);
+      ASSERT_NEAR(distance.second, 1.5, 0.01);
+    }
+  }
+}
+
 TEST(road, iterate_waypoints) {
   carla::ThreadPool pool;
   pool.AsyncRun();
@@ -424,3 +456,115 @@ TEST(road, get_waypoint) {
     result.get();
   }
 }
+
+TEST(road, get_waypoints_batched) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    auto &map = *m;
+    std::vector<Location> locations;
+    for (auto i = 0u; i < 10'000u; ++i) {
+      locations.emplace_back(Random::Location(-500.0f, 500.0f));
+    }
+
+    carla::StopWatch scalar_watch;
+    std::vector<boost::optional<Waypoint>> expected;
+    for (const auto &location : locations) {
+      expected.emplace_back(map.GetClosestWaypointOnRoad(location));
+    }
+    scalar_watch.Stop();
+
+    carla::StopWatch batch_watch;
+    auto waypoints = map.GetClosestWaypointsOnRoad(locations);
+    batch_watch.Stop();
+
+    ASSERT_TRUE(waypoints == expected);
+    carla::logging::log(
+        file,
+        "scalar:", 1e-3f * scalar_watch.GetElapsedTime(), "seconds,",
+        "batched:", 1e-3f * batch_watch.GetElapsedTime(), "seconds.");
+
+    expected.clear();
+    for (const auto &location : locations) {
+      expected.emplace_back(map.GetWaypoint(location));
+    }
+    ASSERT_TRUE(map.GetWaypoints(locations) == expected);
+  }
+}
+
+TEST(road, map_cache) {
+  const std::string cache_path = "test_opendrive_map_cache.bin";
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    std::remove(cache_path.c_str());
+    const auto opendrive = util::OpenDrive::Load(file);
+    const auto hash = carla::road::MapCache::Hash(opendrive);
+    ASSERT_FALSE(carla::road::MapCache(cache_path, hash).IsValid());
+
+    // First load parses and writes the cache, second load maps it.
+    auto parsed = OpenDriveParser::Load(opendrive, cache_path);
+    ASSERT_TRUE(parsed.has_value());
+    ASSERT_TRUE(carla::road::MapCache(cache_path, hash).IsValid());
+    ASSERT_FALSE(carla::road::MapCache(cache_path, hash + 1u).IsValid());
+    auto cached = OpenDriveParser::Load(opendrive, cache_path);
+    ASSERT_TRUE(cached.has_value());
+
+    for (auto i = 0u; i < 1'000u; ++i) {
+      const auto location = Random::Location(-500.0f, 500.0f);
+      auto expected = parsed->GetClosestWaypointOnRoad(location);
+      auto waypoint = cached->GetClosestWaypointOnRoad(location);
+      ASSERT_EQ(waypoint.has_value(), expected.has_value());
+      if (expected.has_value()) {
+        // Equidistant segments may resolve to a different lane, compare distances.
+        ASSERT_NEAR(
+            cached->ComputeTransform(*waypoint).location.Distance(location),
+            parsed->ComputeTransform(*expected).location.Distance(location),
+            1e-3f);
+      }
+    }
+  }
+  std::remove(cache_path.c_str());
+}
+
+static void assert_same_mesh(const carla::geom::Mesh &lhs, const carla::geom::Mesh &rhs) {
+  ASSERT_TRUE(lhs.GetVertices() == rhs.GetVertices());
+  ASSERT_TRUE(lhs.GetIndexes() == rhs.GetIndexes());
+  ASSERT_TRUE(lhs.GetUVs() == rhs.GetUVs());
+}
+
+TEST(road, mesh_generation_parallel) {
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    auto &map = *m;
+    carla::rpc::OpendriveGenerationParameters params;
+
+    // A ParallelFor issued from inside a running job runs sequentially, so
+    // the reference meshes are generated inside a job of another pool.
+    carla::geom::Mesh expected;
+    std::vector<std::unique_ptr<carla::geom::Mesh>> expected_chunks;
+    carla::StopWatch sequential_watch;
+    carla::WorkStealingPool sequential(1u);
+    sequential.ParallelFor(0u, 2u, 1u, [&](size_t i) {
+      if (i == 0u) {
+        expected = map.GenerateMesh(params.vertex_distance);
+        expected_chunks = map.GenerateChunkedMesh(params);
+      }
+    });
+    sequential_watch.Stop();
+
+    carla::StopWatch parallel_watch;
+    auto mesh = map.GenerateMesh(params.vertex_distance);
+    auto chunks = map.GenerateChunkedMesh(params);
+    parallel_watch.Stop();
+
+    assert_same_mesh(mesh, expected);
+    ASSERT_EQ(chunks.size(), expected_chunks.size());
+    for (auto i = 0u; i < chunks.size(); ++i) {
+      assert_same_mesh(*chunks[i], *expected_chunks[i]);
+    }
+    carla::logging::log(
+        file,
+        "sequential:", 1e-3f * sequential_watch.GetElapsedTime(), "seconds,",
+        "parallel:", 1e-3f * parallel_watch.GetElapsedTime(), "seconds.");
+  }
+}
@@ -0,0 +1,119 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/client/detail/ActorFactory.h>
+#include <carla/rpc/Actor.h>
+#include <carla/trafficmanager/Parameters.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace carla::traffic_manager;
+
+static ActorPtr MakeActor(ActorId actor_id) {
+  carla::rpc::Actor description;
+  description.id = actor_id;
+  return carla::client::detail::ActorFactory::MakeActor(
+      carla::client::detail::EpisodeProxy{},
+      description,
+      carla::client::GarbageCollectionPolicy::Disabled);
+}
+
+TEST(parameters, percentage_overrides_desired_speed) {
+  Parameters parameters;
+  auto vehicle = MakeActor(1u);
+  parameters.SetDesiredSpeed(vehicle, 15.0f);
+  parameters.UpdateSnapshot({1u});
+  ASSERT_EQ(parameters.GetSnapshot().GetVehicleTargetVelocity(0u, 50.0f), 15.0f);
+
+  parameters.SetPercentageSpeedDifference(vehicle, 20.0f);
+  parameters.UpdateSnapshot({1u});
+  const ParameterSnapshot &snapshot = parameters.GetSnapshot();
+  ASSERT_LT(snapshot.GetVehicle(0u).desired_speed, 0.0f);
+  ASSERT_EQ(snapshot.GetVehicle(0u).percentage_speed_difference, 20.0f);
+  ASSERT_FLOAT_EQ(snapshot.GetVehicleTargetVelocity(0u, 50.0f), 40.0f);
+}
+
+TEST(parameters, global_defaults) {
+  Parameters parameters;
+  parameters.SetGlobalPercentageSpeedDifference(10.0f);
+  parameters.SetGlobalLaneOffset(0.5f);
+  parameters.SetGlobalDistanceToLeadingVehicle(3.0f);
+  auto vehicle = MakeActor(2u);
+  parameters.SetLaneOffset(vehicle, -0.25f);
+  parameters.SetDistanceToLeadingVehicle(vehicle, 6.0f);
+
+  parameters.UpdateSnapshot({1u, 2u});
+  const ParameterSnapshot &snapshot = parameters.GetSnapshot();
+  ASSERT_EQ(snapshot.Size(), 2u);
+
+  // Vehicle 1 has no parameters of its own.
+  const VehicleParameters &defaults = snapshot.GetVehicle(0u);
+  ASSERT_EQ(defaults.percentage_speed_difference, 10.0f);
+  ASSERT_EQ(defaults.lane_offset, 0.5f);
+  ASSERT_EQ(defaults.distance_to_leading_vehicle, 3.0f);
+  ASSERT_LT(defaults.desired_speed, 0.0f);
+  ASSERT_FLOAT_EQ(snapshot.GetVehicleTargetVelocity(0u, 50.0f), 45.0f);
+
+  // Vehicle 2 keeps the global percentage only.
+  const VehicleParameters &overridden = snapshot.GetVehicle(1u);
+  ASSERT_EQ(overridden.percentage_speed_difference, 10.0f);
+  ASSERT_EQ(overridden.lane_offset, -0.25f);
+  ASSERT_EQ(overridden.distance_to_leading_vehicle, 6.0f);
+}
+
+TEST(parameters, force_lane_change_consumed_by_snapshot) {
+  Parameters parameters;
+  parameters.SetForceLaneChange(MakeActor(1u), true);
+  parameters.SetForceLaneChange(MakeActor(2u), false);
+
+  // Vehicle 2 is not in this snapshot, its command waits for the next one.
+  parameters.UpdateSnapshot({1u});
+  ASSERT_TRUE(parameters.GetSnapshot().GetVehicle(0u).force_lane_change.change_lane);
+  ASSERT_TRUE(parameters.GetSnapshot().GetVehicle(0u).force_lane_change.direction);
+
+  parameters.UpdateSnapshot({2u, 1u});
+  const ParameterSnapshot &snapshot = parameters.GetSnapshot();
+  ASSERT_TRUE(snapshot.GetVehicle(0u).force_lane_change.change_lane);
+  ASSERT_FALSE(snapshot.GetVehicle(0u).force_lane_change.direction);
+  ASSERT_FALSE(snapshot.GetVehicle(1u).force_lane_change.change_lane);
+
+  parameters.UpdateSnapshot({2u, 1u});
+  ASSERT_FALSE(parameters.GetSnapshot().GetVehicle(0u).force_lane_change.change_lane);
+}
+
+TEST(parameters, ignored_collisions) {
+  Parameters parameters;
+  std::vector<ActorPtr> vehicles;
+  for (ActorId id = 1u; id <= 4u; ++id) {
+    vehicles.emplace_back(MakeActor(id));
+  }
+  for (auto other : {9u, 3u, 7u, 1u}) {
+    parameters.SetCollisionDetection(vehicles[3u], MakeActor(other), false);
+    parameters.SetCollisionDetection(vehicles[0u], MakeActor(other + 10u), false);
+  }
+  parameters.SetCollisionDetection(vehicles[1u], MakeActor(5u), false);
+
+  // Vehicle 2 is not in the snapshot.
+  parameters.UpdateSnapshot({4u, 3u, 1u});
+  const ParameterSnapshot &snapshot = parameters.GetSnapshot();
+  for (auto other : {9u, 3u, 7u, 1u}) {
+    ASSERT_FALSE(snapshot.GetCollisionDetection(0u, other));
+    ASSERT_TRUE(snapshot.GetCollisionDetection(1u, other));
+    ASSERT_FALSE(snapshot.GetCollisionDetection(2u, other + 10u));
+  }
+  ASSERT_TRUE(snapshot.GetCollisionDetection(0u, 5u));
+  ASSERT_TRUE(snapshot.GetCollisionDetection(1u, 5u));
+  ASSERT_TRUE(snapshot.GetCollisionDetection(2u, 5u));
+
+  // Detecting collisions again.
+  parameters.SetCollisionDetection(vehicles[3u], MakeActor(7u), true);
+  parameters.UpdateSnapshot({4u, 3u, 1u});
+  ASSERT_TRUE(parameters.GetSnapshot().GetCollisionDetection(0u, 7u));
+  ASSERT_FALSE(parameters.GetSnapshot().GetCollisionDetection(0u, 9u));
+}
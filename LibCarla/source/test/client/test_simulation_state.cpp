@@ -0,0 +1,107 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/trafficmanager/SimulationState.h>
+
+#include <vector>
+
+using namespace carla::traffic_manager;
+
+static void AddVehicle(SimulationState &state, ActorId actor_id) {
+  KinematicState kinematic_state{};
+  kinematic_state.location = cg::Location(static_cast<float>(actor_id), 0.0f, 0.0f);
+  kinematic_state.speed_limit = static_cast<float>(actor_id);
+  StaticAttributes attributes{ActorType::Vehicle, 2.0f, 1.0f, 1.0f};
+  TrafficLightState tl_state{TLS::Green, false};
+  state.AddActor(actor_id, kinematic_state, attributes, tl_state);
+}
+
+// Checks that the data in every slot belongs to the actor in it.
+static void ExpectConsistent(const SimulationState &state) {
+  for (size_t slot = 0u; slot < state.Size(); ++slot) {
+    const ActorId actor_id = state.GetActorId(slot);
+    EXPECT_EQ(state.GetSlot(actor_id), slot);
+    EXPECT_EQ(state.GetLocationAt(slot).x, static_cast<float>(actor_id));
+    EXPECT_EQ(state.GetSpeedLimitAt(slot), static_cast<float>(actor_id));
+  }
+}
+
+TEST(simulation_state, add_actor) {
+  SimulationState state;
+  AddVehicle(state, 10u);
+  AddVehicle(state, 20u);
+  AddVehicle(state, 10u);
+  ASSERT_EQ(state.Size(), 2u);
+  ASSERT_EQ(state.GetSlot(10u), 0u);
+  ASSERT_EQ(state.GetSlot(20u), 1u);
+  ExpectConsistent(state);
+}
+
+TEST(simulation_state, remove_actor_swaps_with_last_slot) {
+  SimulationState state;
+  for (ActorId id = 1u; id <= 4u; ++id) {
+    AddVehicle(state, id);
+  }
+  state.RemoveActor(2u);
+  ASSERT_EQ(state.Size(), 3u);
+  ASSERT_FALSE(state.ContainsActor(2u));
+  // The last actor takes the freed slot, the others do not move.
+  ASSERT_EQ(state.GetSlot(1u), 0u);
+  ASSERT_EQ(state.GetSlot(4u), 1u);
+  ASSERT_EQ(state.GetSlot(3u), 2u);
+  ExpectConsistent(state);
+
+  // Removing the last actor moves nothing.
+  state.RemoveActor(3u);
+  ASSERT_EQ(state.Size(), 2u);
+  ASSERT_EQ(state.GetSlot(1u), 0u);
+  ASSERT_EQ(state.GetSlot(4u), 1u);
+  ExpectConsistent(state);
+
+  // Removing an unknown actor does nothing.
+  state.RemoveActor(42u);
+  ASSERT_EQ(state.Size(), 2u);
+}
+
+TEST(simulation_state, arrange_slots) {
+  SimulationState state;
+  for (ActorId id = 1u; id <= 5u; ++id) {
+    AddVehicle(state, id);
+  }
+  const std::vector<ActorId> ordered_ids = {4u, 1u, 5u};
+  ASSERT_EQ(state.ArrangeSlots(ordered_ids), ordered_ids.size());
+  for (size_t i = 0u; i < ordered_ids.size(); ++i) {
+    ASSERT_EQ(state.GetActorId(i), ordered_ids[i]);
+  }
+  // The actors not in the list take the remaining slots.
+  ASSERT_EQ(state.Size(), 5u);
+  ASSERT_TRUE(state.GetSlot(2u) >= ordered_ids.size());
+  ASSERT_TRUE(state.GetSlot(3u) >= ordered_ids.size());
+  ExpectConsistent(state);
+
+  // Arranging again in the same order does not move anything.
+  ASSERT_EQ(state.ArrangeSlots(ordered_ids), ordered_ids.size());
+  for (size_t i = 0u; i < ordered_ids.size(); ++i) {
+    ASSERT_EQ(state.GetActorId(i), ordered_ids[i]);
+  }
+  ExpectConsistent(state);
+}
+
+TEST(simulation_state, arrange_slots_skips_unknown_actors) {
+  SimulationState state;
+  for (ActorId id = 1u; id <= 3u; ++id) {
+    AddVehicle(state, id);
+  }
+  // Actor 7 was registered but has not been added to the state yet.
+  ASSERT_EQ(state.ArrangeSlots({3u, 7u, 1u}), 2u);
+  ASSERT_EQ(state.GetActorId(0u), 3u);
+  ASSERT_EQ(state.GetActorId(1u), 1u);
+  ASSERT_EQ(state.GetActorId(2u), 2u);
+  ASSERT_FALSE(state.ContainsActor(7u));
+  ExpectConsistent(state);
+}
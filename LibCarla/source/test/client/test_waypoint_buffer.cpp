@@ -0,0 +1,100 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/trafficmanager/WaypointBuffer.h>
+
+#include <deque>
+#include <stdexcept>
+#include <vector>
+
+using namespace carla::traffic_manager;
+
+static void ExpectEqual(const WaypointBuffer &buffer, const std::deque<WaypointIndex> &expected) {
+  ASSERT_EQ(buffer.size(), expected.size());
+  ASSERT_EQ(buffer.empty(), expected.empty());
+  for (size_t i = 0u; i < expected.size(); ++i) {
+    ASSERT_EQ(buffer[i], expected[i]);
+  }
+  const std::vector<WaypointIndex> iterated(buffer.begin(), buffer.end());
+  ASSERT_EQ(iterated, std::vector<WaypointIndex>(expected.begin(), expected.end()));
+  if (!expected.empty()) {
+    ASSERT_EQ(buffer.front(), expected.front());
+    ASSERT_EQ(buffer.back(), expected.back());
+  }
+}
+
+TEST(waypoint_buffer, pop_front_wraps_around) {
+  WaypointBuffer buffer;
+  std::deque<WaypointIndex> expected;
+  WaypointIndex next = 0u;
+  // The initial capacity is 64, keep the buffer below it while the head goes
+  // around the ring several times.
+  for (; next < 48u; ++next) {
+    buffer.push_back(next);
+    expected.push_back(next);
+  }
+  for (int cycle = 0; cycle < 200; ++cycle) {
+    buffer.pop_front();
+    expected.pop_front();
+    buffer.push_back(next);
+    expected.push_back(next);
+    ++next;
+  }
+  ExpectEqual(buffer, expected);
+
+  buffer.pop_back();
+  expected.pop_back();
+  ExpectEqual(buffer, expected);
+}
+
+TEST(waypoint_buffer, grow_after_head_wrapped) {
+  WaypointBuffer buffer;
+  std::deque<WaypointIndex> expected;
+  WaypointIndex next = 0u;
+  for (; next < 64u; ++next) {
+    buffer.push_back(next);
+    expected.push_back(next);
+  }
+  // Move the head to the middle of the ring, so that the waypoints wrap
+  // around its end.
+  for (int i = 0; i < 40; ++i) {
+    buffer.pop_front();
+    expected.pop_front();
+  }
+  for (int i = 0; i < 40; ++i, ++next) {
+    buffer.push_back(next);
+    expected.push_back(next);
+  }
+  ExpectEqual(buffer, expected);
+
+  // The buffer is full, the next waypoints grow it twice.
+  for (int i = 0; i < 100; ++i, ++next) {
+    buffer.push_back(next);
+    expected.push_back(next);
+  }
+  ExpectEqual(buffer, expected);
+}
+
+TEST(waypoint_buffer, clear) {
+  WaypointBuffer buffer;
+  for (WaypointIndex i = 0u; i < 100u; ++i) {
+    buffer.push_back(i);
+  }
+  for (int i = 0; i < 30; ++i) {
+    buffer.pop_front();
+  }
+  buffer.clear();
+  ExpectEqual(buffer, {});
+  ASSERT_THROW(buffer.at(0u), std::out_of_range);
+
+  buffer.push_back(7u);
+  buffer.push_back(8u);
+  ExpectEqual(buffer, {7u, 8u});
+  ASSERT_EQ(buffer.at(1u), 8u);
+  ASSERT_THROW(buffer.at(2u), std::out_of_range);
+}
@@ -0,0 +1,139 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+
+#include <carla/client/Map.h>
+#include <carla/road/MapCache.h>
+#include <carla/trafficmanager/InMemoryMap.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace carla::traffic_manager;
+
+static uint64_t GetId(const SimpleWaypointPtr &swp) {
+  return swp == nullptr ? 0u : swp->GetId();
+}
+
+static std::vector<uint64_t> GetIds(const std::vector<SimpleWaypointPtr> &waypoints) {
+  std::vector<uint64_t> ids;
+  for (const auto &swp : waypoints) {
+    ids.push_back(GetId(swp));
+  }
+  return ids;
+}
+
+static std::vector<WaypointIndex> GetIndices(const WaypointRange &range) {
+  return {range.begin(), range.end()};
+}
+
+static void AssertSameGraph(const WaypointGraph &lhs, const WaypointGraph &rhs) {
+  ASSERT_EQ(lhs.Size(), rhs.Size());
+  for (WaypointIndex i = 0u; i < lhs.Size(); ++i) {
+    ASSERT_EQ(lhs.GetLocation(i), rhs.GetLocation(i));
+    ASSERT_EQ(lhs.GetForwardVector(i), rhs.GetForwardVector(i));
+    ASSERT_EQ(lhs.GetRoadId(i), rhs.GetRoadId(i));
+    ASSERT_EQ(lhs.GetLaneId(i), rhs.GetLaneId(i));
+    ASSERT_EQ(lhs.GetDistance(i), rhs.GetDistance(i));
+    ASSERT_EQ(lhs.GetGeodesicGridId(i), rhs.GetGeodesicGridId(i));
+    ASSERT_EQ(lhs.GetJunctionId(i), rhs.GetJunctionId(i));
+    ASSERT_EQ(lhs.CheckJunction(i), rhs.CheckJunction(i));
+    ASSERT_EQ(lhs.GetRoadOption(i), rhs.GetRoadOption(i));
+    ASSERT_EQ(lhs.GetLeftWaypoint(i), rhs.GetLeftWaypoint(i));
+    ASSERT_EQ(lhs.GetRightWaypoint(i), rhs.GetRightWaypoint(i));
+    ASSERT_EQ(GetIndices(lhs.GetNextWaypoints(i)), GetIndices(rhs.GetNextWaypoints(i)));
+    ASSERT_EQ(GetIndices(lhs.GetPreviousWaypoints(i)), GetIndices(rhs.GetPreviousWaypoints(i)));
+  }
+}
+
+TEST(waypoint_graph, load_cache_as_built) {
+  const std::string cache_path = "test_waypoint_graph.tmcache";
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const auto opendrive = util::OpenDrive::Load(file);
+    const auto hash = carla::road::MapCache::Hash(opendrive);
+    auto world_map = carla::MakeShared<carla::client::Map>(file, opendrive);
+
+    InMemoryMap built(world_map);
+    built.SetUp();
+    std::remove(cache_path.c_str());
+    ASSERT_TRUE(built.SaveCache(cache_path, hash));
+
+    InMemoryMap loaded(world_map);
+    ASSERT_FALSE(loaded.LoadCache(cache_path, hash + 1u));
+    ASSERT_TRUE(loaded.LoadCache(cache_path, hash));
+    AssertSameGraph(built.GetGraph(), loaded.GetGraph());
+
+    // The dense topology is created back from the graph.
+    const auto built_topology = built.GetDenseTopology();
+    const auto loaded_topology = loaded.GetDenseTopology();
+    ASSERT_EQ(built_topology.size(), loaded_topology.size());
+    for (size_t i = 0u; i < built_topology.size(); ++i) {
+      const auto &expected = built_topology[i];
+      const auto &swp = loaded_topology[i];
+      ASSERT_EQ(swp->GetId(), expected->GetId());
+      ASSERT_EQ(swp->GetRoadOption(), expected->GetRoadOption());
+      ASSERT_EQ(swp->CheckJunction(), expected->CheckJunction());
+      ASSERT_EQ(GetIds(swp->GetNextWaypoint()), GetIds(expected->GetNextWaypoint()));
+      ASSERT_EQ(GetIds(swp->GetPreviousWaypoint()), GetIds(expected->GetPreviousWaypoint()));
+      ASSERT_EQ(GetId(swp->GetLeftWaypoint()), GetId(expected->GetLeftWaypoint()));
+      ASSERT_EQ(GetId(swp->GetRightWaypoint()), GetId(expected->GetRightWaypoint()));
+
+      const auto location = expected->GetLocation();
+      ASSERT_EQ(loaded.GetWaypoint(location)->GetId(), built.GetWaypoint(location)->GetId());
+      ASSERT_EQ(loaded.GetWaypointIndex(location), built.GetWaypointIndex(location));
+    }
+  }
+  std::remove(cache_path.c_str());
+}
+
+TEST(waypoint_graph, reject_links_out_of_graph) {
+  const std::string cache_path = "test_waypoint_graph_invalid.tmcache";
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const auto opendrive = util::OpenDrive::Load(file);
+    const auto hash = carla::road::MapCache::Hash(opendrive);
+    auto world_map = carla::MakeShared<carla::client::Map>(file, opendrive);
+
+    InMemoryMap built(world_map);
+    built.SetUp();
+    const auto &graph = built.GetGraph();
+    size_t previous_links = 0u;
+    for (WaypointIndex i = 0u; i < graph.Size(); ++i) {
+      previous_links += graph.GetPreviousWaypoints(i).size();
+    }
+    if (previous_links == 0u) {
+      continue;
+    }
+    std::remove(cache_path.c_str());
+    ASSERT_TRUE(built.SaveCache(cache_path, hash));
+
+    // The previous links are the last array of the file, padded to 8 bytes.
+    // Point the last one past the end of the graph.
+    std::vector<char> content;
+    {
+      std::ifstream in(cache_path, std::ios::binary);
+      content.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    const size_t padding = (previous_links % 2u) * sizeof(WaypointIndex);
+    const size_t offset = content.size() - padding - sizeof(WaypointIndex);
+    const WaypointIndex out_of_graph = static_cast<WaypointIndex>(graph.Size());
+    std::memcpy(content.data() + offset, &out_of_graph, sizeof(out_of_graph));
+    {
+      std::ofstream out(cache_path, std::ios::trunc | std::ios::binary);
+      out.write(content.data(), static_cast<std::streamsize>(content.size()));
+    }
+
+    InMemoryMap loaded(world_map);
+    ASSERT_FALSE(loaded.LoadCache(cache_path, hash));
+    ASSERT_EQ(loaded.GetGraph().Size(), 0u);
+  }
+  std::remove(cache_path.c_str());
+}
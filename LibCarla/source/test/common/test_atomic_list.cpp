@@ -0,0 +1,53 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/AtomicList.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using carla::client::detail::AtomicList;
+
+TEST(atomic_list, take) {
+  AtomicList<int> list;
+  list.Push(1);
+  list.Push(2);
+  auto taken = list.Take();
+  ASSERT_EQ(taken->size(), 2u);
+  ASSERT_EQ(taken->at(1u), 2);
+  ASSERT_TRUE(list.Load()->empty());
+  ASSERT_TRUE(list.Take()->empty());
+}
+
+TEST(atomic_list, take_while_pushing) {
+  constexpr int VALUES = 10000;
+  AtomicList<int> list;
+  std::atomic_bool done{false};
+  std::thread pusher([&]() {
+    for (int i = 0; i < VALUES; ++i) {
+      list.Push(i);
+    }
+    done = true;
+  });
+  // Every value pushed is taken exactly once.
+  std::vector<int> taken;
+  auto take = [&]() {
+    const auto values = list.Take();
+    taken.insert(taken.end(), values->begin(), values->end());
+  };
+  while (!done) {
+    take();
+  }
+  pusher.join();
+  take();
+  ASSERT_EQ(taken.size(), static_cast<size_t>(VALUES));
+  for (int i = 0; i < VALUES; ++i) {
+    ASSERT_EQ(taken[static_cast<size_t>(i)], i);
+  }
+}
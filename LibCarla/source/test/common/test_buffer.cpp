@@ -7,9 +7,11 @@
 #include "test.h"
 
 #include <carla/Buffer.h>
+#include <carla/BufferAllocator.h>
 #include <carla/BufferPool.h>
 
 #include <array>
+#include <cstring>
 #include <list>
 #include <set>
 #include <string>
@@ -134,3 +136,103 @@ TEST(buffer, buffer_pool) {
   // Now delete the pool to test the weak reference inside the buffers.
   pool.reset();
 }
+
+TEST(buffer, buffer_pool_is_bounded) {
+  auto pool = std::make_shared<carla::BufferPool>(4u, 2u);
+  {
+    std::vector<Buffer> buffers;
+    for (auto i = 0u; i < 5u; ++i) {
+      buffers.emplace_back(pool->Pop());
+      buffers.back().reset(1024u);
+    }
+  }
+  // only two buffers kept their memory
+  size_t with_memory = 0u;
+  std::vector<Buffer> buffers;
+  for (auto i = 0u; i < 5u; ++i) {
+    buffers.emplace_back(pool->Pop());
+    if (buffers.back().capacity() > 0u) {
+      ++with_memory;
+    }
+  }
+  ASSERT_EQ(with_memory, 2u);
+}
+
+TEST(buffer, allocator_size_classes) {
+  using carla::BufferAllocator;
+  ASSERT_EQ(BufferAllocator::GetCapacity(0u), 0u);
+  ASSERT_EQ(BufferAllocator::GetCapacity(1u), 64u);
+  ASSERT_EQ(BufferAllocator::GetCapacity(64u), 64u);
+  ASSERT_EQ(BufferAllocator::GetCapacity(65u), 128u);
+  ASSERT_EQ(BufferAllocator::GetCapacity(1920u * 1080u * 4u), 1u << 23u);
+  Buffer buffer(1000u);
+  ASSERT_EQ(buffer.size(), 1000u);
+  ASSERT_EQ(buffer.capacity(), 1024u);
+}
+
+TEST(buffer, allocator_reuses_memory) {
+  using carla::BufferAllocator;
+  // a size class no other test uses
+  constexpr size_t size = (1u << 25u) - 3u;
+  const auto before = BufferAllocator::GetStats();
+  const unsigned char *data = nullptr;
+  {
+    Buffer buffer(size);
+    data = buffer.data();
+  }
+  const auto freed = BufferAllocator::GetStats();
+  ASSERT_EQ(freed.misses, before.misses + 1u);
+  ASSERT_EQ(freed.bytes_held, before.bytes_held + (1u << 25u));
+  Buffer buffer;
+  buffer.reset(static_cast<Buffer::size_type>(size - 100u));
+  ASSERT_EQ(buffer.data(), data);
+  const auto reused = BufferAllocator::GetStats();
+  ASSERT_EQ(reused.hits, freed.hits + 1u);
+  ASSERT_EQ(reused.misses, freed.misses);
+  ASSERT_EQ(reused.bytes_held, before.bytes_held);
+}
+
+TEST(buffer, allocator_is_bounded) {
+  using carla::BufferAllocator;
+  const auto max_bytes_held = BufferAllocator::GetMaxBytesHeld();
+  BufferAllocator::Trim();
+  BufferAllocator::SetMaxBytesHeld(1u << 20u);
+  const auto before = BufferAllocator::GetStats();
+  {
+    std::vector<Buffer> buffers;
+    for (auto i = 0u; i < 4u; ++i) {
+      buffers.emplace_back(Buffer::size_type(1u << 19u));
+    }
+  }
+  auto stats = BufferAllocator::GetStats();
+  ASSERT_EQ(stats.bytes_held, 1u << 20u);
+  ASSERT_EQ(stats.blocks_held, 2u);
+  ASSERT_EQ(stats.evictions, before.evictions + 2u);
+  ASSERT_EQ(stats.bytes_allocated, before.bytes_allocated + (1u << 20u));
+  BufferAllocator::Trim();
+  stats = BufferAllocator::GetStats();
+  ASSERT_EQ(stats.bytes_held, 0u);
+  ASSERT_EQ(stats.blocks_held, 0u);
+  BufferAllocator::SetMaxBytesHeld(max_bytes_held);
+}
+
+TEST(buffer, allocator_huge_pages) {
+  using carla::BufferAllocator;
+  BufferAllocator::Trim();
+  BufferAllocator::SetHugePageThreshold(2u << 20u);
+  {
+    Buffer buffer(Buffer::size_type(4u << 20u));
+    std::memset(buffer.data(), 42, buffer.size());
+    ASSERT_EQ(buffer.data()[buffer.size() - 1u], 42u);
+  }
+  BufferAllocator::SetHugePageThreshold(0u);
+  BufferAllocator::Trim();
+}
+
+TEST(buffer, resize_keeps_data) {
+  const std::string str = "Hello buffer!";
+  Buffer buffer(str);
+  buffer.resize(4096u);
+  ASSERT_EQ(buffer.size(), 4096u);
+  ASSERT_EQ(std::string(reinterpret_cast<const char *>(buffer.data()), str.size()), str);
+}
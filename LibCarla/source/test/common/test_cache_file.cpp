@@ -0,0 +1,82 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/CacheFile.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utility>
+
+using carla::CacheFile;
+
+static constexpr char MAGIC[8u] = {'C', 'A', 'R', 'L', 'A', 'T', 'S', 'T'};
+
+static bool WriteContent(const std::string &path, uint32_t version, uint64_t hash, const std::string &content) {
+  return CacheFile::Write(path, MAGIC, version, hash, [&](std::ostream &out) {
+    out.write(content.data(), static_cast<std::streamsize>(content.size()));
+  });
+}
+
+TEST(cache_file, write_and_open) {
+  const std::string path = "test_cache_file.bin";
+  const std::string content = "cached content";
+  ASSERT_TRUE(WriteContent(path, 1u, 42u, content));
+
+  CacheFile file;
+  ASSERT_TRUE(file.Open(path, MAGIC, 1u, 42u));
+  ASSERT_EQ(file.GetContentSize(), content.size());
+  EXPECT_EQ(std::string(file.GetContent(), file.GetContentSize()), content);
+
+  // the mapping moves with the file and outlives the removal of the path
+  CacheFile moved = std::move(file);
+  EXPECT_FALSE(file.IsOpen());
+  ASSERT_TRUE(moved.IsOpen());
+  std::remove(path.c_str());
+  EXPECT_EQ(std::string(moved.GetContent(), moved.GetContentSize()), content);
+  moved.Close();
+  EXPECT_FALSE(moved.IsOpen());
+}
+
+TEST(cache_file, rewrite_existing) {
+  const std::string path = "test_cache_file_rewrite.bin";
+  ASSERT_TRUE(WriteContent(path, 1u, 1u, "old"));
+  ASSERT_TRUE(WriteContent(path, 1u, 2u, "new"));
+  CacheFile file;
+  ASSERT_TRUE(file.Open(path, MAGIC, 1u, 2u));
+  EXPECT_EQ(std::string(file.GetContent(), file.GetContentSize()), "new");
+  file.Close();
+  std::remove(path.c_str());
+}
+
+TEST(cache_file, invalid_files) {
+  const std::string path = "test_cache_file_invalid.bin";
+  CacheFile file;
+  std::remove(path.c_str());
+  EXPECT_FALSE(file.Open(path, MAGIC, 1u, 42u));
+
+  ASSERT_TRUE(WriteContent(path, 1u, 42u, ""));
+  EXPECT_TRUE(file.Open(path, MAGIC, 1u, 42u));
+  EXPECT_EQ(file.GetContentSize(), 0u);
+  EXPECT_FALSE(file.Open(path, MAGIC, 2u, 42u));
+  EXPECT_FALSE(file.IsOpen());
+  EXPECT_FALSE(file.Open(path, MAGIC, 1u, 43u));
+  const char other_magic[8u] = {'O', 'T', 'H', 'E', 'R', 'F', 'M', 'T'};
+  EXPECT_FALSE(file.Open(path, other_magic, 1u, 42u));
+
+  // empty and truncated files
+  { std::ofstream out(path, std::ios::trunc | std::ios::binary); }
+  EXPECT_FALSE(file.Open(path, MAGIC, 1u, 42u));
+  {
+    std::ofstream out(path, std::ios::trunc | std::ios::binary);
+    out.write(MAGIC, sizeof(MAGIC));
+  }
+  EXPECT_FALSE(file.Open(path, MAGIC, 1u, 42u));
+  std::remove(path.c_str());
+}
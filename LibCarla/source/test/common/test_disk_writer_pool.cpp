@@ -0,0 +1,51 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/DiskWriterPool.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+using carla::DiskWriterPool;
+
+TEST(disk_writer_pool, flush_waits_for_every_write) {
+  std::atomic_size_t count{0u};
+  DiskWriterPool pool(4u, 1000u);
+  for (size_t i = 0u; i < 1000u; ++i) {
+    ASSERT_TRUE(pool.Post([&]() { ++count; }));
+  }
+  pool.Flush();
+  ASSERT_EQ(count, 1000u);
+  ASSERT_EQ(pool.GetPendingWrites(), 0u);
+  ASSERT_EQ(pool.GetDroppedWrites(), 0u);
+}
+
+TEST(disk_writer_pool, drops_writes_when_full) {
+  std::mutex mutex;
+  std::condition_variable condition;
+  bool release = false;
+  DiskWriterPool pool(1u, 2u);
+  auto blocked_write = [&]() {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [&]() { return release; });
+  };
+  ASSERT_TRUE(pool.Post(blocked_write));
+  ASSERT_TRUE(pool.Post(blocked_write));
+  ASSERT_FALSE(pool.Post(blocked_write));
+  ASSERT_EQ(pool.GetPendingWrites(), 2u);
+  ASSERT_EQ(pool.GetDroppedWrites(), 1u);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    release = true;
+  }
+  condition.notify_all();
+  pool.Flush();
+  ASSERT_EQ(pool.GetPendingWrites(), 0u);
+  ASSERT_TRUE(pool.Post([]() {}));
+}
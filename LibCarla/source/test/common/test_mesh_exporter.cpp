@@ -0,0 +1,174 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/geom/Mesh.h>
+#include <carla/geom/MeshExporter.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace carla::geom;
+
+// Two consecutive strips of @a quads quads, sharing their middle row of
+// vertices, as the lanes of a road.
+static Mesh MakeTwoLanes(size_t quads) {
+  Mesh mesh;
+  for (int lane = 0; lane < 2; ++lane) {
+    mesh.AddMaterial(lane == 0 ? "road" : "sidewalk");
+    std::vector<Mesh::vertex_type> strip;
+    for (size_t i = 0u; i <= quads; ++i) {
+      strip.emplace_back(static_cast<float>(i), static_cast<float>(lane), 0.0f);
+      strip.emplace_back(static_cast<float>(i), static_cast<float>(lane + 1), 0.0f);
+    }
+    mesh.AddTriangleStrip(strip);
+    mesh.EndMaterial();
+  }
+  return mesh;
+}
+
+static std::vector<unsigned char> WritePLY(const Mesh &mesh, const MeshExportOptions &options) {
+  std::vector<unsigned char> result;
+  EXPECT_TRUE(MeshExporter::WritePLY(mesh, [&](const unsigned char *data, size_t size) {
+    result.insert(result.end(), data, data + size);
+  }, options));
+  return result;
+}
+
+static std::string GetHeader(const std::vector<unsigned char> &ply) {
+  const std::string content(ply.begin(), ply.end());
+  const auto end = content.find("end_header\n");
+  return end == std::string::npos ? "" : content.substr(0u, end + 11u);
+}
+
+template <typename T>
+static T Read(const std::vector<unsigned char> &data, size_t offset) {
+  T value;
+  std::memcpy(&value, data.data() + offset, sizeof(T));
+  return value;
+}
+
+TEST(mesh_exporter, ply) {
+  const auto mesh = MakeTwoLanes(10u);
+  const auto ply = WritePLY(mesh, MeshExportOptions());
+  const auto header = GetHeader(ply);
+  ASSERT_FALSE(header.empty());
+  EXPECT_EQ(header.find("ply\nformat binary_little_endian 1.0\n"), 0u);
+  EXPECT_NE(header.find("comment material 0 road\n"), std::string::npos);
+  EXPECT_NE(header.find("comment material 1 sidewalk\n"), std::string::npos);
+  EXPECT_NE(header.find("element vertex 44\n"), std::string::npos);
+  EXPECT_NE(header.find("element face 40\n"), std::string::npos);
+
+  // 3 floats per vertex, and count, 3 indices and material per face
+  const size_t face_size = 1u + 3u * 4u + 2u;
+  ASSERT_EQ(ply.size(), header.size() + 44u * 12u + 40u * face_size);
+  const size_t faces = header.size() + 44u * 12u;
+  for (size_t face = 0u; face < 40u; ++face) {
+    const size_t offset = faces + face * face_size;
+    EXPECT_EQ(ply[offset], 3u);
+    for (size_t i = 0u; i < 3u; ++i) {
+      const auto index = Read<uint32_t>(ply, offset + 1u + 4u * i);
+      EXPECT_EQ(index, mesh.GetIndexes()[3u * face + i] - 1u);
+    }
+    EXPECT_EQ(Read<int16_t>(ply, offset + 13u), face < 20u ? 0 : 1);
+  }
+}
+
+TEST(mesh_exporter, weld_strip_duplicates) {
+  const auto mesh = MakeTwoLanes(10u);
+  MeshExportOptions options;
+  options.weld_vertices = true;
+  const auto ply = WritePLY(mesh, options);
+  const auto header = GetHeader(ply);
+  // the 11 vertices between the lanes are shared
+  EXPECT_NE(header.find("element vertex 33\n"), std::string::npos);
+  EXPECT_NE(header.find("element face 40\n"), std::string::npos);
+  const size_t faces = header.size() + 33u * 12u;
+  for (size_t face = 0u; face < 40u; ++face) {
+    for (size_t i = 0u; i < 3u; ++i) {
+      const auto index = Read<uint32_t>(ply, faces + face * 15u + 1u + 4u * i);
+      ASSERT_LT(index, 33u);
+      const auto &expected = mesh.GetVertices()[mesh.GetIndexes()[3u * face + i] - 1u];
+      EXPECT_EQ(Read<float>(ply, header.size() + index * 12u), expected.x);
+      EXPECT_EQ(Read<float>(ply, header.size() + index * 12u + 4u), expected.y);
+    }
+  }
+
+  // vertices apart less than the tolerance
+  Mesh close;
+  close.AddTriangleFan({{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {1.0f, 1.0f, 0.0f}});
+  close.AddTriangleFan({{1.0001f, 1.0f, 0.0f}, {0.0001f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}});
+  EXPECT_NE(GetHeader(WritePLY(close, options)).find("element vertex 6\n"), std::string::npos);
+  options.weld_tolerance = 0.01f;
+  EXPECT_NE(GetHeader(WritePLY(close, options)).find("element vertex 4\n"), std::string::npos);
+}
+
+TEST(mesh_exporter, gltf) {
+  const auto mesh = MakeTwoLanes(10u);
+  std::string json;
+  std::vector<unsigned char> buffer;
+  ASSERT_TRUE(MeshExporter::WriteGLTF(mesh, "lanes.bin",
+      [&](const unsigned char *data, size_t size) { json.append(data, data + size); },
+      [&](const unsigned char *data, size_t size) { buffer.insert(buffer.end(), data, data + size); }));
+
+  EXPECT_NE(json.find("\"version\":\"2.0\""), std::string::npos);
+  EXPECT_NE(json.find("\"uri\":\"lanes.bin\",\"byteLength\":" + std::to_string(buffer.size())), std::string::npos);
+  EXPECT_NE(json.find("{\"name\":\"road\"},{\"name\":\"sidewalk\"}"), std::string::npos);
+  EXPECT_NE(json.find("\"indices\":1,\"material\":0"), std::string::npos);
+  EXPECT_NE(json.find("\"indices\":2,\"material\":1"), std::string::npos);
+  // positions and the indices of each material
+  ASSERT_EQ(buffer.size(), 44u * 12u + 2u * 20u * 12u);
+
+  // y up, with the winding reversed
+  const auto &vertex = mesh.GetVertices()[1];
+  EXPECT_EQ(Read<float>(buffer, 12u), vertex.x);
+  EXPECT_EQ(Read<float>(buffer, 16u), vertex.z);
+  EXPECT_EQ(Read<float>(buffer, 20u), vertex.y);
+  const size_t indices = 44u * 12u;
+  EXPECT_EQ(Read<uint32_t>(buffer, indices), mesh.GetIndexes()[0] - 1u);
+  EXPECT_EQ(Read<uint32_t>(buffer, indices + 4u), mesh.GetIndexes()[2] - 1u);
+  EXPECT_EQ(Read<uint32_t>(buffer, indices + 8u), mesh.GetIndexes()[1] - 1u);
+}
+
+TEST(mesh_exporter, chunks) {
+  const auto mesh = MakeTwoLanes(1000u);
+  MeshExportOptions options;
+  options.chunk_size = 1000u;
+  size_t total = 0u;
+  size_t calls = 0u;
+  ASSERT_TRUE(MeshExporter::WritePLY(mesh, [&](const unsigned char *, size_t size) {
+    EXPECT_GT(size, 0u);
+    EXPECT_LE(size, options.chunk_size);
+    total += size;
+    ++calls;
+  }, options));
+  EXPECT_EQ(total, WritePLY(mesh, MeshExportOptions()).size());
+  EXPECT_EQ(calls, (total + options.chunk_size - 1u) / options.chunk_size);
+}
+
+TEST(mesh_exporter, save_gltf) {
+  const auto mesh = MakeTwoLanes(10u);
+  ASSERT_TRUE(MeshExporter::SaveGLTF(mesh, "test_mesh_exporter.gltf"));
+  std::ifstream json("test_mesh_exporter.gltf");
+  const std::string content{std::istreambuf_iterator<char>(json), std::istreambuf_iterator<char>()};
+  EXPECT_NE(content.find("\"uri\":\"test_mesh_exporter.bin\""), std::string::npos);
+  std::ifstream buffer("test_mesh_exporter.bin", std::ios::binary | std::ios::ate);
+  EXPECT_EQ(static_cast<size_t>(buffer.tellg()), 44u * 12u + 40u * 12u);
+  std::remove("test_mesh_exporter.gltf");
+  std::remove("test_mesh_exporter.bin");
+}
+
+TEST(mesh_exporter, invalid_mesh) {
+  auto write = [](const unsigned char *, size_t) {};
+  EXPECT_FALSE(MeshExporter::WritePLY(Mesh(), write));
+  EXPECT_FALSE(MeshExporter::WriteGLTF(Mesh(), "empty.bin", write, write));
+}
@@ -0,0 +1,131 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/multigpu/frameDelta.h>
+#include <carla/multigpu/loadReport.h>
+#include <carla/multigpu/primaryCommands.h>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace carla::multigpu;
+
+static carla::Buffer MakeFrame(const std::vector<unsigned char> &data) {
+  return carla::Buffer(data);
+}
+
+static void ExpectSameFrame(const carla::Buffer &frame, const std::vector<unsigned char> &expected) {
+  ASSERT_EQ(frame.size(), expected.size());
+  ASSERT_TRUE(std::equal(frame.begin(), frame.end(), expected.begin()));
+}
+
+TEST(multigpu, frame_delta_round_trip) {
+  std::mt19937 engine(42u);
+  std::uniform_int_distribution<int> byte(0, 255);
+  std::uniform_int_distribution<size_t> index(0u, 9999u);
+
+  std::vector<unsigned char> data(10000u);
+  for (auto &value : data) {
+    value = static_cast<unsigned char>(byte(engine));
+  }
+
+  FrameDeltaEncoder encoder;
+  FrameDeltaDecoder decoder;
+  for (auto i = 0u; i < 50u; ++i) {
+    // change a few bytes, and grow or shrink the frame
+    for (auto j = 0u; j < 100u; ++j) {
+      data[index(engine) % data.size()] = static_cast<unsigned char>(byte(engine));
+    }
+    data.resize(data.size() + (i % 3u) * 16u - 16u, 0xAAu);
+
+    auto frame = MakeFrame(data);
+    auto delta = encoder.EncodeDelta(frame);
+    auto message = delta.empty() ? encoder.EncodeKeyFrame(frame) : std::move(delta);
+    if (i > 0u) {
+      ASSERT_LT(message.size(), data.size() / 2u);
+    }
+    ASSERT_TRUE(FrameDeltaDecoder::IsEncoded(message));
+    carla::Buffer decoded;
+    ASSERT_TRUE(decoder.Decode(message, decoded));
+    ExpectSameFrame(decoded, data);
+    encoder.Advance(std::move(frame));
+  }
+}
+
+TEST(multigpu, frame_delta_needs_reference) {
+  const std::vector<unsigned char> first(1000u, 1u);
+  std::vector<unsigned char> second = first;
+  second[500u] = 2u;
+
+  FrameDeltaEncoder encoder;
+  ASSERT_TRUE(encoder.EncodeDelta(MakeFrame(first)).empty());
+  auto key_frame = encoder.EncodeKeyFrame(MakeFrame(first));
+  encoder.Advance(MakeFrame(first));
+  auto delta = encoder.EncodeDelta(MakeFrame(second));
+  ASSERT_FALSE(delta.empty());
+
+  // a secondary server connected after the first frame cannot use the delta
+  FrameDeltaDecoder late;
+  carla::Buffer decoded;
+  ASSERT_FALSE(late.Decode(delta, decoded));
+
+  FrameDeltaDecoder decoder;
+  ASSERT_TRUE(decoder.Decode(key_frame, decoded));
+  ExpectSameFrame(decoded, first);
+  ASSERT_TRUE(decoder.Decode(delta, decoded));
+  ExpectSameFrame(decoded, second);
+  // the same delta twice is out of sequence
+  ASSERT_FALSE(decoder.Decode(delta, decoded));
+}
+
+TEST(multigpu, load_report) {
+  LoadReport report;
+  report.frame = 10u;
+  report.frame_time_us = 16000u;
+  report.queue_depth = 2u;
+  LoadReport result;
+  ASSERT_TRUE(LoadReport::FromBuffer(report.ToBuffer(), result));
+  ASSERT_EQ(result.frame, 10u);
+  ASSERT_EQ(result.frame_time_us, 16000u);
+  ASSERT_EQ(result.queue_depth, 2u);
+
+  // answers to commands are not reports
+  bool answer = true;
+  carla::Buffer buffer(reinterpret_cast<unsigned char *>(&answer), sizeof(answer));
+  ASSERT_FALSE(LoadReport::FromBuffer(buffer, result));
+  carla::streaming::detail::token_data token;
+  carla::Buffer token_buffer(reinterpret_cast<unsigned char *>(&token), sizeof(token));
+  ASSERT_FALSE(LoadReport::FromBuffer(token_buffer, result));
+}
+
+TEST(multigpu, choose_least_loaded) {
+  auto make_load = [](float frame_time_ms, uint32_t queue_depth) {
+    SecondaryLoad load;
+    load.has_report = true;
+    load.frame_time_ms = frame_time_ms;
+    load.queue_depth = queue_depth;
+    return load;
+  };
+  ASSERT_EQ(PrimaryCommands::ChooseLeastLoaded({}, {}), 0u);
+  ASSERT_EQ(PrimaryCommands::ChooseLeastLoaded(
+      {make_load(20.0f, 0u), make_load(10.0f, 0u), make_load(30.0f, 0u)},
+      {0u, 0u, 0u}), 1u);
+  // a queue of pending frames weighs as much as rendering them
+  ASSERT_EQ(PrimaryCommands::ChooseLeastLoaded(
+      {make_load(20.0f, 0u), make_load(10.0f, 3u)},
+      {0u, 0u}), 0u);
+  // ties go to the secondary server with fewer sensors
+  ASSERT_EQ(PrimaryCommands::ChooseLeastLoaded(
+      {make_load(10.0f, 0u), make_load(10.0f, 0u)},
+      {4u, 2u}), 1u);
+  // secondary servers without reports are used first
+  ASSERT_EQ(PrimaryCommands::ChooseLeastLoaded(
+      {make_load(10.0f, 0u), SecondaryLoad{}},
+      {1u, 0u}), 1u);
+}
@@ -0,0 +1,77 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/pointcloud/PointCloudIO.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using carla::pointcloud::PointCloudIO;
+
+// Laid out as the lidar detections, four floats without padding.
+struct TestPoint {
+  float x;
+  float y;
+  float z;
+  float intensity;
+
+  void WritePlyHeaderInfo(std::ostream &out) const {
+    out << "property float32 x\n"
+           "property float32 y\n"
+           "property float32 z\n"
+           "property float32 I";
+  }
+};
+
+static const std::string BINARY_HEADER =
+    "ply\n"
+    "format binary_little_endian 1.0\n"
+    "element vertex 3\n"
+    "property float32 x\n"
+    "property float32 y\n"
+    "property float32 z\n"
+    "property float32 I\n"
+    "end_header\n";
+
+static std::vector<TestPoint> MakePoints() {
+  return {{1.0f, 2.0f, 3.0f, 0.5f}, {-1.5f, 0.0f, 42.0f, 1.0f}, {0.25f, -8.0f, 1e6f, 0.0f}};
+}
+
+static void CheckBinaryPly(const std::string &ply, const std::vector<TestPoint> &points) {
+  ASSERT_EQ(ply.size(), BINARY_HEADER.size() + sizeof(TestPoint) * points.size());
+  EXPECT_EQ(ply.substr(0u, BINARY_HEADER.size()), BINARY_HEADER);
+  EXPECT_EQ(std::memcmp(ply.data() + BINARY_HEADER.size(), points.data(), sizeof(TestPoint) * points.size()), 0);
+  // 1.0f, the x of the first point, in little endian.
+  const unsigned char *payload = reinterpret_cast<const unsigned char *>(ply.data() + BINARY_HEADER.size());
+  EXPECT_EQ(payload[0u], 0x00);
+  EXPECT_EQ(payload[3u], 0x3f);
+}
+
+TEST(point_cloud_io, dump_binary) {
+  static_assert(sizeof(TestPoint) == 4u * sizeof(float), "Unexpected padding");
+  const auto points = MakePoints();
+  std::ostringstream out(std::ios::binary);
+  PointCloudIO::DumpBinary(out, points.data(), points.data() + points.size());
+  CheckBinaryPly(out.str(), points);
+}
+
+TEST(point_cloud_io, save_binary_to_disk) {
+  const auto points = MakePoints();
+  const std::string path = PointCloudIO::SaveBinaryToDisk(
+      "test_point_cloud_io.ply", points.data(), points.data() + points.size());
+  std::ifstream in(path, std::ios::binary);
+  const std::string ply{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+  in.close();
+  std::remove(path.c_str());
+  CheckBinaryPly(ply, points);
+}
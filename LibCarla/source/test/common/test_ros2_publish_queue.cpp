@@ -0,0 +1,108 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/ros2/ROS2PublishQueue.h>
+
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using carla::ros2::ROS2PublishQueue;
+using namespace std::chrono_literals;
+
+TEST(ros2_publish_queue, keeps_order_of_each_publisher) {
+  ROS2PublishQueue queue(4u, 1000u);
+  int publishers[3];
+  std::mutex mutex;
+  std::vector<int> published[3];
+  for (auto i = 0; i < 100; ++i) {
+    for (auto j = 0u; j < 3u; ++j) {
+      queue.Post(&publishers[j], [&, i, j]() {
+        std::lock_guard<std::mutex> lock(mutex);
+        published[j].push_back(i);
+      });
+    }
+  }
+  queue.Flush();
+  for (auto j = 0u; j < 3u; ++j) {
+    ASSERT_EQ(published[j].size(), 100u);
+    for (auto i = 0; i < 100; ++i) {
+      ASSERT_EQ(published[j][i], i);
+    }
+  }
+  ASSERT_EQ(queue.GetDroppedSamples(), 0u);
+}
+
+TEST(ros2_publish_queue, never_runs_a_publisher_twice_at_once) {
+  ROS2PublishQueue queue(4u, 1000u);
+  int publisher;
+  std::atomic_int running{0};
+  std::atomic_bool overlapped{false};
+  for (auto i = 0; i < 200; ++i) {
+    queue.Post(&publisher, [&]() {
+      if (++running > 1) {
+        overlapped = true;
+      }
+      std::this_thread::yield();
+      --running;
+    });
+  }
+  queue.Flush();
+  ASSERT_FALSE(overlapped);
+}
+
+TEST(ros2_publish_queue, drops_oldest_samples) {
+  ROS2PublishQueue queue(2u, 2u);
+  int publisher;
+  std::promise<void> started;
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  std::mutex mutex;
+  std::vector<int> published;
+  queue.Post(&publisher, [&]() {
+    started.set_value();
+    released.wait();
+    std::lock_guard<std::mutex> lock(mutex);
+    published.push_back(0);
+  });
+  started.get_future().wait();
+  // the publisher is busy, only the two latest samples wait for it
+  for (auto i = 1; i <= 5; ++i) {
+    queue.Post(&publisher, [&, i]() {
+      std::lock_guard<std::mutex> lock(mutex);
+      published.push_back(i);
+    });
+  }
+  release.set_value();
+  queue.Flush();
+  ASSERT_EQ(published, (std::vector<int>{0, 4, 5}));
+  ASSERT_EQ(queue.GetDroppedSamples(), 3u);
+}
+
+TEST(ros2_publish_queue, publishers_run_in_parallel) {
+  ROS2PublishQueue queue(2u, 2u);
+  int publishers[2];
+  std::atomic_int started{0};
+  std::atomic_int met{0};
+  for (auto &publisher : publishers) {
+    queue.Post(&publisher, [&]() {
+      ++started;
+      const auto timeout = std::chrono::steady_clock::now() + 5s;
+      while ((started < 2) && (std::chrono::steady_clock::now() < timeout)) {
+        std::this_thread::yield();
+      }
+      if (started == 2) {
+        ++met;
+      }
+    });
+  }
+  queue.Flush();
+  ASSERT_EQ(met, 2);
+}
@@ -11,10 +11,14 @@
 #include <carla/streaming/Server.h>
 #include <carla/streaming/detail/Dispatcher.h>
 #include <carla/streaming/detail/tcp/Client.h>
+#include <carla/streaming/detail/tcp/MultiplexedProtocol.h>
 #include <carla/streaming/detail/tcp/Server.h>
 #include <carla/streaming/low_level/Client.h>
 #include <carla/streaming/low_level/Server.h>
 
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
 #include <atomic>
 
 using namespace std::chrono_literals;
@@ -277,3 +281,250 @@ TEST(streaming, multi_stream) {
     }
   }
 }
+
+TEST(streaming, slow_client_drops_messages) {
+  using namespace carla::streaming;
+  using namespace util::buffer;
+  using tcp_socket = boost::asio::ip::tcp;
+  constexpr size_t number_of_messages = 50u;
+  constexpr size_t message_size = 4u * 1024u * 1024u;
+
+  for (auto policy : {detail::DropPolicy::DropNewest, detail::DropPolicy::DropOldest}) {
+    Server srv(TESTING_PORT);
+    srv.SetSendQueueSize(2u);
+    srv.SetDropPolicy(policy);
+    srv.AsyncRun(2u);
+    auto stream = srv.MakeStream();
+
+    std::atomic_size_t message_count{0u};
+    Client c;
+    c.AsyncRun(1u);
+    c.Subscribe(stream.token(), [&](auto buffer) {
+      ASSERT_EQ(buffer.size(), message_size);
+      ++message_count;
+    });
+
+    // A client that subscribes but never reads.
+    io_context_running io;
+    tcp_socket::socket slow_client(io.service);
+    slow_client.connect(srv.GetLocalEndpoint());
+    const auto stream_id = detail::token_type(stream.token()).get_stream_id();
+    boost::asio::write(slow_client, boost::asio::buffer(&stream_id, sizeof(stream_id)));
+    std::this_thread::sleep_for(20ms);
+
+    carla::Buffer buffer(message_size);
+    carla::SharedBufferView view = carla::BufferView::CreateFrom(std::move(buffer));
+    for (auto i = 0u; i < number_of_messages; ++i) {
+      std::this_thread::sleep_for(4ms);
+      carla::SharedBufferView message = view;
+      stream.Write(message);
+    }
+    for (auto i = 0u; (i < 100u) && (message_count < number_of_messages); ++i) {
+      std::this_thread::sleep_for(10ms);
+    }
+
+    // The slow client does not hold back the other one.
+    ASSERT_GE(message_count, number_of_messages - 3u);
+    ASSERT_GT(stream.GetDroppedMessageCount(), 0u);
+  }
+}
+
+TEST(streaming, multiplexed_streams) {
+  using namespace carla::streaming;
+  using namespace util::buffer;
+  constexpr size_t number_of_messages = 100u;
+  constexpr size_t number_of_streams = 8u;
+  const std::string message = "Hi y'all!";
+
+  Server srv(TESTING_PORT);
+  srv.AsyncRun(2u);
+
+  std::vector<Stream> streams;
+  for (auto i = 0u; i < number_of_streams; ++i) {
+    streams.emplace_back(srv.MakeStream());
+  }
+
+  // A multiplexed client and a regular one subscribed to the same streams.
+  std::vector<std::atomic_size_t> multiplexed_count(number_of_streams);
+  std::vector<std::atomic_size_t> regular_count(number_of_streams);
+  Client multiplexed_client;
+  multiplexed_client.SetMultiplexed(true);
+  multiplexed_client.AsyncRun(1u);
+  Client regular_client;
+  regular_client.AsyncRun(1u);
+  for (auto i = 0u; i < number_of_streams; ++i) {
+    multiplexed_count[i] = 0u;
+    regular_count[i] = 0u;
+    multiplexed_client.Subscribe(streams[i].token(), [&, i](auto buffer) {
+      const std::string result = as_string(buffer);
+      ASSERT_EQ(result, message);
+      ++multiplexed_count[i];
+    });
+    regular_client.Subscribe(streams[i].token(), [&, i](auto buffer) {
+      const std::string result = as_string(buffer);
+      ASSERT_EQ(result, message);
+      ++regular_count[i];
+    });
+  }
+
+  carla::Buffer Buf(boost::asio::buffer(message.c_str(), message.size()));
+  carla::SharedBufferView BufView = carla::BufferView::CreateFrom(std::move(Buf));
+  auto write_all = [&]() {
+    for (auto j = 0u; j < number_of_messages; ++j) {
+      std::this_thread::sleep_for(4ms);
+      for (auto &stream : streams) {
+        carla::SharedBufferView View = BufView;
+        stream.Write(View);
+      }
+    }
+    std::this_thread::sleep_for(20ms);
+  };
+
+  std::this_thread::sleep_for(20ms);
+  write_all();
+  for (auto i = 0u; i < number_of_streams; ++i) {
+    ASSERT_GE(multiplexed_count[i], number_of_messages - 3u);
+    ASSERT_GE(regular_count[i], number_of_messages - 3u);
+  }
+
+  // Unsubscribing from a stream keeps the others running.
+  multiplexed_client.UnSubscribe(streams[0u].token());
+  std::this_thread::sleep_for(20ms);
+  const size_t unsubscribed_count = multiplexed_count[0u];
+  write_all();
+  ASSERT_EQ(multiplexed_count[0u], unsubscribed_count);
+  for (auto i = 1u; i < number_of_streams; ++i) {
+    ASSERT_GE(multiplexed_count[i], 2u * number_of_messages - 6u);
+  }
+  ASSERT_GE(regular_count[0u], 2u * number_of_messages - 6u);
+}
+
+TEST(streaming, multiplexed_fallback) {
+  using namespace util::buffer;
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+  using tcp_socket = boost::asio::ip::tcp;
+
+  const std::string message_text = "Hello client!";
+  std::atomic_bool done{false};
+  std::atomic_size_t handshakes{0u};
+  std::atomic_size_t message_count{0u};
+
+  // A server that does not know about multiplexing: closes the connection on
+  // an unknown stream id, and sends messages on any other stream.
+  boost::asio::io_context server_context;
+  tcp_socket::acceptor acceptor(server_context, tcp_socket::endpoint(tcp_socket::v4(), TESTING_PORT));
+  const auto port = acceptor.local_endpoint().port();
+  carla::ThreadGroup server_threads;
+  server_threads.CreateThread([&]() {
+    while (!done) {
+      tcp_socket::socket socket(server_context);
+      boost::system::error_code ec;
+      acceptor.accept(socket, ec);
+      stream_id_type stream_id = 0u;
+      boost::asio::read(socket, boost::asio::buffer(&stream_id, sizeof(stream_id)), ec);
+      if (ec || done) {
+        continue;
+      }
+      if (stream_id == tcp::multiplexed::HANDSHAKE_STREAM_ID) {
+        ++handshakes;
+        continue;
+      }
+      const message_size_type size = static_cast<message_size_type>(message_text.size());
+      while (!ec && !done) {
+        std::this_thread::sleep_for(2ms);
+        boost::asio::write(socket, boost::asio::buffer(&size, sizeof(size)), ec);
+        boost::asio::write(socket, boost::asio::buffer(message_text), ec);
+      }
+    }
+  });
+
+  {
+    io_context_running io;
+    carla::streaming::low_level::Client<tcp::Client> c;
+    c.SetMultiplexed(true);
+    token_type token(42u, make_endpoint<tcp_socket>("127.0.0.1", port));
+    c.Subscribe(io.service, token, [&](auto message) {
+      ASSERT_EQ(as_string(message), message_text);
+      ++message_count;
+    });
+    // The client retries the handshake once per second before falling back.
+    for (auto i = 0u; (i < 500u) && (message_count < 10u); ++i) {
+      std::this_thread::sleep_for(10ms);
+    }
+    io.service.stop();
+  }
+
+  done = true;
+  {
+    // Unblock the accepting thread.
+    tcp_socket::socket socket(server_context);
+    boost::system::error_code ec;
+    socket.connect(acceptor.local_endpoint(), ec);
+  }
+  server_threads.JoinAll();
+
+  ASSERT_EQ(handshakes, tcp::multiplexed::MAX_REFUSED_HANDSHAKES);
+  ASSERT_GE(message_count, 10u);
+}
+
+TEST(streaming, multiplexed_no_fallback_on_reset) {
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+  using tcp_socket = boost::asio::ip::tcp;
+
+  std::atomic_bool done{false};
+  std::atomic_size_t handshakes{0u};
+  std::atomic_size_t stream_connections{0u};
+
+  // A server that resets every handshake, as a flaky network would.
+  boost::asio::io_context server_context;
+  tcp_socket::acceptor acceptor(server_context, tcp_socket::endpoint(tcp_socket::v4(), TESTING_PORT));
+  const auto port = acceptor.local_endpoint().port();
+  carla::ThreadGroup server_threads;
+  server_threads.CreateThread([&]() {
+    while (!done) {
+      tcp_socket::socket socket(server_context);
+      boost::system::error_code ec;
+      acceptor.accept(socket, ec);
+      stream_id_type stream_id = 0u;
+      boost::asio::read(socket, boost::asio::buffer(&stream_id, sizeof(stream_id)), ec);
+      if (ec || done) {
+        continue;
+      }
+      if (stream_id == tcp::multiplexed::HANDSHAKE_STREAM_ID) {
+        ++handshakes;
+        // Closing explicitly, the destructor would drop the linger option.
+        socket.set_option(boost::asio::socket_base::linger(true, 0), ec);
+        socket.close(ec);
+      } else {
+        ++stream_connections;
+      }
+    }
+  });
+
+  {
+    io_context_running io;
+    carla::streaming::low_level::Client<tcp::Client> c;
+    c.SetMultiplexed(true);
+    token_type token(42u, make_endpoint<tcp_socket>("127.0.0.1", port));
+    c.Subscribe(io.service, token, [](auto) {});
+    const auto attempts = tcp::multiplexed::MAX_REFUSED_HANDSHAKES + 1u;
+    for (auto i = 0u; (i < 600u) && (handshakes < attempts); ++i) {
+      std::this_thread::sleep_for(10ms);
+    }
+    io.service.stop();
+  }
+
+  done = true;
+  {
+    // Unblock the accepting thread.
+    tcp_socket::socket socket(server_context);
+    boost::system::error_code ec;
+    socket.connect(acceptor.local_endpoint(), ec);
+  }
+  server_threads.JoinAll();
+
+  ASSERT_GT(handshakes, tcp::multiplexed::MAX_REFUSED_HANDSHAKES);
+  ASSERT_EQ(stream_connections, 0u);
+}
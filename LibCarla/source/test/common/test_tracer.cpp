@@ -0,0 +1,75 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/profiler/Tracer.h>
+
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+using carla::profiler::Tracer;
+
+static size_t count_occurrences(const std::string &text, const std::string &pattern) {
+  size_t count = 0u;
+  for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1u)) {
+    ++count;
+  }
+  return count;
+}
+
+TEST(tracer, nothing_recorded_while_disabled) {
+  Tracer::Disable();
+  Tracer::Clear();
+  {
+    CARLA_TRACE_SCOPE("test", "tracer_disabled_span");
+    CARLA_TRACE_COUNTER("test", "tracer_disabled_counter", 1);
+  }
+  const std::string trace = Tracer::GetChromeTrace();
+  ASSERT_EQ(trace.find("tracer_disabled"), std::string::npos);
+}
+
+TEST(tracer, spans_and_counters_of_every_thread) {
+  Tracer::Enable();
+  Tracer::Clear();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([i]() {
+      Tracer::SetThreadName("tracer_thread_" + std::to_string(i));
+      for (int j = 0; j < 10; ++j) {
+        CARLA_TRACE_SCOPE("test", std::string("tracer_span"));
+        CARLA_TRACE_COUNTER("test", "tracer_counter", j);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  Tracer::Disable();
+  const std::string trace = Tracer::GetChromeTrace();
+  ASSERT_EQ(count_occurrences(trace, "\"name\":\"tracer_span\",\"pid\":1"), 40u);
+  ASSERT_EQ(count_occurrences(trace, "\"name\":\"tracer_counter\",\"pid\":1"), 40u);
+  ASSERT_EQ(count_occurrences(trace, "\"name\":\"tracer_thread_"), 4u);
+  Tracer::Clear();
+  ASSERT_EQ(Tracer::GetChromeTrace().find("tracer_span"), std::string::npos);
+}
+
+TEST(tracer, non_finite_counters_are_null) {
+  Tracer::Enable();
+  Tracer::Clear();
+  CARLA_TRACE_COUNTER("test", "tracer_nan", std::numeric_limits<double>::quiet_NaN());
+  CARLA_TRACE_COUNTER("test", "tracer_inf", std::numeric_limits<double>::infinity());
+  CARLA_TRACE_COUNTER("test", "tracer_finite", 0.5);
+  Tracer::Disable();
+  const std::string trace = Tracer::GetChromeTrace();
+  ASSERT_EQ(count_occurrences(trace, "\"args\":{\"value\":null}"), 2u);
+  ASSERT_EQ(count_occurrences(trace, "\"args\":{\"value\":0.5}"), 1u);
+  ASSERT_EQ(trace.find("\"value\":nan"), std::string::npos);
+  ASSERT_EQ(trace.find("\"value\":inf"), std::string::npos);
+  Tracer::Clear();
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/WorkStealingPool.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using carla::WorkStealingPool;
+
+TEST(work_stealing_pool, every_index_once) {
+  WorkStealingPool pool(4u);
+  ASSERT_EQ(pool.size(), 5u);
+  for (size_t grain_size : {1u, 3u, 64u, 1000u}) {
+    std::vector<std::atomic<int>> visits(997u);
+    for (auto &count : visits) {
+      count = 0;
+    }
+    pool.ParallelFor(0u, visits.size(), grain_size, [&](size_t i) { ++visits[i]; });
+    for (auto &count : visits) {
+      ASSERT_EQ(count, 1);
+    }
+  }
+}
+
+TEST(work_stealing_pool, barrier_between_loops) {
+  WorkStealingPool pool(3u);
+  std::vector<int> first(500u, 0);
+  std::vector<int> second(500u, 0);
+  for (int repetition = 0; repetition < 20; ++repetition) {
+    pool.ParallelFor(0u, first.size(), 7u, [&](size_t i) { first[i] = static_cast<int>(i) + repetition; });
+    // Every element of the first loop must be visible to the second one.
+    pool.ParallelFor(0u, second.size(), 7u, [&](size_t i) {
+      second[i] = first[first.size() - 1u - i];
+    });
+    for (size_t i = 0u; i < second.size(); ++i) {
+      ASSERT_EQ(second[i], static_cast<int>(first.size() - 1u - i) + repetition);
+    }
+  }
+}
+
+TEST(work_stealing_pool, empty_and_nested) {
+  WorkStealingPool pool(2u);
+  std::atomic<int> count{0};
+  pool.ParallelFor(10u, 10u, 1u, [&](size_t) { ++count; });
+  ASSERT_EQ(count, 0);
+  pool.ParallelFor(0u, 8u, 1u, [&](size_t) {
+    pool.ParallelFor(0u, 8u, 1u, [&](size_t) { ++count; });
+  });
+  ASSERT_EQ(count, 64);
+}
+
+TEST(work_stealing_pool, no_workers) {
+  WorkStealingPool pool(0u);
+  std::vector<size_t> order;
+  pool.ParallelFor(0u, 5u, 1u, [&](size_t i) { order.push_back(i); });
+  ASSERT_EQ(order, (std::vector<size_t>{0u, 1u, 2u, 3u, 4u}));
+}
+
+#ifndef LIBCARLA_NO_EXCEPTIONS
+TEST(work_stealing_pool, exception) {
+  WorkStealingPool pool(2u);
+  std::atomic<int> count{0};
+  ASSERT_THROW(pool.ParallelFor(0u, 100u, 1u, [&](size_t i) {
+    ++count;
+    if (i == 42u) {
+      throw std::runtime_error("failed");
+    }
+  }), std::runtime_error);
+  ASSERT_EQ(count, 100);
+  // The pool is still usable afterwards.
+  pool.ParallelFor(0u, 100u, 1u, [&](size_t) { ++count; });
+  ASSERT_EQ(count, 200);
+}
+#endif // LIBCARLA_NO_EXCEPTIONS
@@ -0,0 +1,105 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/geom/Mesh.h>
+#include <carla/geom/MeshExporter.h>
+
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace carla::geom;
+
+static constexpr size_t LANES = 6u;
+static constexpr size_t QUADS_PER_LANE = 80000u;
+
+/// A long curved road, with a strip per lane as road::Map::GenerateMesh does,
+/// about a million vertices.
+static Mesh MakeRoad() {
+  Mesh mesh;
+  for (auto lane = 0u; lane < LANES; ++lane) {
+    mesh.AddMaterial(lane == 0u || lane + 1u == LANES ? "sidewalk" : "road");
+    std::vector<Mesh::vertex_type> strip;
+    strip.reserve(2u * (QUADS_PER_LANE + 1u));
+    for (auto i = 0u; i <= QUADS_PER_LANE; ++i) {
+      const float s = 0.5f * static_cast<float>(i);
+      const float z = 2.0f * std::sin(0.01f * s);
+      strip.emplace_back(s, 3.5f * static_cast<float>(lane), z);
+      strip.emplace_back(s, 3.5f * static_cast<float>(lane + 1u), z);
+    }
+    mesh.AddTriangleStrip(strip);
+    mesh.EndMaterial();
+  }
+  return mesh;
+}
+
+struct BenchmarkResult {
+  size_t bytes = 0u;
+  double ms = 0.0;
+};
+
+template <typename ExportFunction>
+static BenchmarkResult Benchmark(ExportFunction &&export_mesh) {
+  BenchmarkResult result;
+  const auto begin = std::chrono::steady_clock::now();
+  result.bytes = export_mesh();
+  result.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+  return result;
+}
+
+static void Log(const char *name, const BenchmarkResult &result) {
+  carla::logging::log(name, result.bytes / 1024u, "KiB in", result.ms, "ms");
+}
+
+TEST(benchmark_mesh_export, road) {
+  const auto mesh = MakeRoad();
+
+  // the exported bytes are only counted, as if they were sent to a file
+  size_t bytes = 0u;
+  auto count = [&bytes](const unsigned char *, size_t size) { bytes += size; };
+
+  auto obj = Benchmark([&]() {
+    return mesh.GenerateOBJ().size();
+  });
+  auto ply = Benchmark([&]() {
+    bytes = 0u;
+    EXPECT_TRUE(MeshExporter::WritePLY(mesh, count));
+    return bytes;
+  });
+  MeshExportOptions weld;
+  weld.weld_vertices = true;
+  auto ply_welded = Benchmark([&]() {
+    bytes = 0u;
+    EXPECT_TRUE(MeshExporter::WritePLY(mesh, count, weld));
+    return bytes;
+  });
+  auto gltf = Benchmark([&]() {
+    bytes = 0u;
+    EXPECT_TRUE(MeshExporter::WriteGLTF(mesh, "road.bin", count, count));
+    return bytes;
+  });
+  auto gltf_welded = Benchmark([&]() {
+    bytes = 0u;
+    EXPECT_TRUE(MeshExporter::WriteGLTF(mesh, "road.bin", count, count, weld));
+    return bytes;
+  });
+
+  carla::logging::log("vertices", mesh.GetVerticesNum(), "faces", mesh.GetIndexesNum() / 3u);
+  Log("obj:", obj);
+  Log("ply:", ply);
+  Log("ply welded:", ply_welded);
+  Log("gltf:", gltf);
+  Log("gltf welded:", gltf_welded);
+  ASSERT_LT(ply.bytes, obj.bytes);
+  ASSERT_LT(gltf.bytes, obj.bytes);
+  ASSERT_LT(ply_welded.bytes, ply.bytes);
+  ASSERT_LT(gltf_welded.bytes, gltf.bytes);
+  ASSERT_LT(ply.ms, obj.ms);
+  ASSERT_LT(gltf.ms, obj.ms);
+}
@@ -0,0 +1,260 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/Buffer.h>
+#include <carla/multigpu/frameDelta.h>
+#include <carla/multigpu/loadReport.h>
+#include <carla/multigpu/primaryCommands.h>
+#include <carla/multigpu/router.h>
+#include <carla/multigpu/secondary.h>
+#include <carla/streaming/detail/Token.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace carla::multigpu;
+using namespace std::chrono_literals;
+
+// Ports of the benchmarks, one per run so the previous one does not interfere.
+static constexpr uint16_t BENCHMARK_PORT = 20500u;
+
+static constexpr auto FRAME_PERIOD = 10ms;
+
+/// A secondary server that renders each frame in a time proportional to its
+/// number of sensors, like a GPU @a slowdown times slower than the reference
+/// one. It runs in its own threads and stops when destroyed.
+class FakeSecondary {
+public:
+
+  FakeSecondary(uint16_t port, double slowdown)
+    : _state(std::make_shared<State>()),
+      _slowdown(slowdown) {
+    // The commander of a connected Secondary keeps it alive, so its callback
+    // shares the state instead of pointing to this object.
+    auto state = _state;
+    _secondary = std::make_shared<Secondary>("127.0.0.1", port, [state, port](MultiGPUCommand id, carla::Buffer data) {
+      OnCommand(*state, port, id, std::move(data));
+    });
+    _state->secondary = _secondary;
+    _secondary->Connect();
+    _render_thread = std::thread([this]() { Render(); });
+  }
+
+  ~FakeSecondary() {
+    {
+      std::lock_guard<std::mutex> lock(_state->mutex);
+      _state->done = true;
+    }
+    _state->condition.notify_one();
+    _render_thread.join();
+    _secondary->Stop();
+  }
+
+  size_t GetNumberOfSensors() const {
+    return _state->sensors;
+  }
+
+private:
+
+  struct State {
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<carla::Buffer> frames;
+    bool done = false;
+    std::atomic_size_t sensors{0u};
+    std::weak_ptr<Secondary> secondary;
+  };
+
+  static void OnCommand(State &state, uint16_t port, MultiGPUCommand id, carla::Buffer data) {
+    switch (id) {
+      case MultiGPUCommand::SEND_FRAME: {
+        {
+          std::lock_guard<std::mutex> lock(state.mutex);
+          state.frames.emplace_back(std::move(data));
+        }
+        state.condition.notify_one();
+        break;
+      }
+      case MultiGPUCommand::GET_TOKEN: {
+        auto secondary = state.secondary.lock();
+        if (secondary == nullptr) {
+          break;
+        }
+        carla::streaming::detail::token_data token;
+        std::memcpy(&token.stream_id, data.data(), sizeof(token.stream_id));
+        token.port = port;
+        ++state.sensors;
+        secondary->Write(carla::Buffer(reinterpret_cast<unsigned char *>(&token), sizeof(token)));
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  void Render() {
+    using clock = std::chrono::steady_clock;
+    State &state = *_state;
+    uint32_t frame = 0u;
+    std::unique_lock<std::mutex> lock(state.mutex);
+    while (true) {
+      state.condition.wait(lock, [&]() { return state.done || !state.frames.empty(); });
+      if (state.done) {
+        return;
+      }
+      state.frames.pop_front();
+      lock.unlock();
+      const auto begin = clock::now();
+      std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(
+          _slowdown * (1.0 + static_cast<double>(state.sensors))));
+      LoadReport report;
+      report.frame = ++frame;
+      report.frame_time_us = static_cast<uint32_t>(
+          std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - begin).count());
+      lock.lock();
+      report.queue_depth = static_cast<uint32_t>(state.frames.size());
+      lock.unlock();
+      _secondary->GetCommander().SendLoadReport(report);
+      lock.lock();
+    }
+  }
+
+  const std::shared_ptr<State> _state;
+
+  const double _slowdown;
+
+  std::shared_ptr<Secondary> _secondary;
+
+  std::thread _render_thread;
+};
+
+/// Frame data of @a actors, each record an id followed by its transform.
+class FakeFrames {
+public:
+
+  explicit FakeFrames(size_t actors) : _data(actors * 64u) {
+    for (auto &value : _data) {
+      value = static_cast<unsigned char>(_byte(_engine));
+    }
+  }
+
+  /// Move one actor in five.
+  carla::Buffer Next() {
+    for (auto i = 0u; i < _data.size(); i += 5u * 64u) {
+      for (auto j = 4u; j < 28u; ++j) {
+        _data[i + j] = static_cast<unsigned char>(_byte(_engine));
+      }
+    }
+    return carla::Buffer(_data);
+  }
+
+private:
+
+  std::vector<unsigned char> _data;
+
+  std::mt19937 _engine{42u};
+
+  std::uniform_int_distribution<int> _byte{0, 255};
+};
+
+/// Spawns 12 sensors with @a policy on three secondary servers, the last one
+/// three times slower than the others, and returns in @a sensors the number
+/// of sensors placed on each of them.
+static void Benchmark(
+    uint16_t port,
+    PlacementPolicy policy,
+    const char *name,
+    std::vector<size_t> &sensors) {
+  const std::vector<double> slowdowns = {1.0, 1.0, 3.0};
+
+  auto router = std::make_shared<Router>(port);
+  router->SetCallbacks();
+  router->AsyncRun(2u);
+  auto &commander = router->GetCommander();
+  commander.SetPlacementPolicy(policy);
+
+  std::vector<std::unique_ptr<FakeSecondary>> secondaries;
+  for (auto slowdown : slowdowns) {
+    secondaries.emplace_back(std::make_unique<FakeSecondary>(port, slowdown));
+  }
+
+  const auto deadline = std::chrono::steady_clock::now() + 10s;
+  while (router->GetLoads().size() < slowdowns.size()) {
+    ASSERT_LT(std::chrono::steady_clock::now(), deadline) << "the secondary servers did not connect";
+    std::this_thread::sleep_for(100ms);
+  }
+
+  std::atomic_bool done{false};
+  std::atomic_size_t raw_bytes{0u};
+  std::atomic_size_t encoded_bytes{0u};
+  std::thread frames_thread([&]() {
+    FakeFrames frames(500u);
+    FrameDeltaEncoder encoder;
+    while (!done) {
+      auto frame = frames.Next();
+      // measure what the commander sends to a secondary server that has
+      // the previous frame
+      auto delta = encoder.EncodeDelta(frame);
+      raw_bytes += frame.size();
+      encoded_bytes += delta.empty() ? encoder.EncodeKeyFrame(frame).size() : delta.size();
+      encoder.Advance(carla::Buffer(frame.begin(), frame.size()));
+      commander.SendFrameData(std::move(frame));
+      std::this_thread::sleep_for(FRAME_PERIOD);
+    }
+  });
+
+  // spawn the sensors as a client would, giving the loads time to update
+  std::this_thread::sleep_for(500ms);
+  for (auto sensor = 1u; sensor <= 12u; ++sensor) {
+    commander.GetToken(sensor);
+    std::this_thread::sleep_for(250ms);
+  }
+  std::this_thread::sleep_for(1s);
+
+  float worst_frame_time_ms = 0.0f;
+  uint32_t worst_queue_depth = 0u;
+  for (auto &load : router->GetLoads()) {
+    carla::logging::log(name, "secondary frame time", load.frame_time_ms, "ms, queue", load.queue_depth);
+    worst_frame_time_ms = std::max(worst_frame_time_ms, load.frame_time_ms);
+    worst_queue_depth = std::max(worst_queue_depth, load.queue_depth);
+  }
+  carla::logging::log(name, "worst frame time", worst_frame_time_ms, "ms, worst queue", worst_queue_depth);
+  carla::logging::log(name, "frame data", raw_bytes.load(), "bytes, sent", encoded_bytes.load(), "bytes");
+
+  done = true;
+  frames_thread.join();
+
+  sensors.clear();
+  for (auto &secondary : secondaries) {
+    sensors.emplace_back(secondary->GetNumberOfSensors());
+  }
+  carla::logging::log(name, "sensors on the slow secondary", sensors.back(), "of 12");
+}
+
+TEST(benchmark_multigpu, least_loaded_against_round_robin) {
+#ifndef NDEBUG
+  carla::log_info("This test only happens in release (too slow).");
+#else
+  std::vector<size_t> round_robin;
+  Benchmark(BENCHMARK_PORT, PlacementPolicy::RoundRobin, "round robin:", round_robin);
+  std::vector<size_t> least_loaded;
+  Benchmark(BENCHMARK_PORT + 1u, PlacementPolicy::LeastLoaded, "least loaded:", least_loaded);
+  ASSERT_EQ(round_robin.size(), 3u);
+  ASSERT_EQ(least_loaded.size(), 3u);
+  // Fewer sensors on the slow secondary means more on the faster ones.
+  ASSERT_LT(least_loaded.back(), round_robin.back());
+#endif // NDEBUG
+}
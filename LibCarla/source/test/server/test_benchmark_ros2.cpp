@@ -0,0 +1,123 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/Buffer.h>
+#include <carla/BufferView.h>
+#include <carla/ros2/ROS2PublishQueue.h>
+
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using carla::ros2::ROS2PublishQueue;
+using namespace std::chrono_literals;
+
+static constexpr size_t WIDTH = 1920u;
+static constexpr size_t HEIGHT = 1080u;
+static constexpr size_t CAMERAS = 4u;
+static constexpr size_t FRAMES = 60u;
+
+/// Stands for a camera publisher: fills the image of its sample and
+/// serializes it, as Fast DDS does on write.
+class FakeCameraPublisher {
+public:
+
+  /// What the publishers did before: a new, zeroed vector for each image.
+  void SetImageDataInNewVector(const uint8_t *data, size_t size) {
+    std::vector<uint8_t> vector_data;
+    vector_data.resize(size);
+    std::memcpy(&vector_data[0], &data[0], size);
+    _image = std::move(vector_data);
+  }
+
+  /// What the publishers do now: copy into the storage of the last sample.
+  void SetImageData(const uint8_t *data, size_t size) {
+    std::vector<uint8_t> vector_data = std::move(_image);
+    vector_data.assign(data, data + size);
+    _image = std::move(vector_data);
+  }
+
+  void Publish() {
+    _serialized.resize(_image.size());
+    std::memcpy(_serialized.data(), _image.data(), _image.size());
+  }
+
+private:
+
+  std::vector<uint8_t> _image;
+
+  std::vector<uint8_t> _serialized;
+};
+
+static carla::SharedBufferView MakeImage() {
+  std::vector<uint8_t> pixels(WIDTH * HEIGHT * 4u);
+  for (auto i = 0u; i < pixels.size(); ++i) {
+    pixels[i] = static_cast<uint8_t>(i);
+  }
+  return carla::BufferView::CreateFrom(carla::Buffer(pixels));
+}
+
+struct BenchmarkResult {
+  double caller_ms = 0.0;
+  double cpu_ms = 0.0;
+};
+
+template <typename PublishFunction>
+static BenchmarkResult Benchmark(PublishFunction &&publish, ROS2PublishQueue *queue) {
+  auto image = MakeImage();
+  const auto cpu_begin = std::clock();
+  std::chrono::steady_clock::duration caller{0};
+  for (auto frame = 0u; frame < FRAMES; ++frame) {
+    const auto begin = std::chrono::steady_clock::now();
+    for (auto camera = 0u; camera < CAMERAS; ++camera) {
+      publish(camera, image);
+    }
+    caller += std::chrono::steady_clock::now() - begin;
+    // the time the game thread spends in the rest of the frame
+    std::this_thread::sleep_for(16ms);
+  }
+  if (queue != nullptr) {
+    queue->Flush();
+  }
+  const auto cpu_end = std::clock();
+  const double samples = static_cast<double>(FRAMES * CAMERAS);
+  BenchmarkResult result;
+  result.caller_ms = std::chrono::duration<double, std::milli>(caller).count() / samples;
+  result.cpu_ms = 1e3 * static_cast<double>(cpu_end - cpu_begin) / CLOCKS_PER_SEC / samples;
+  return result;
+}
+
+TEST(benchmark_ros2, camera_1920x1080) {
+  std::vector<FakeCameraPublisher> publishers(CAMERAS);
+
+  auto synchronous = Benchmark([&](size_t camera, const carla::SharedBufferView &image) {
+    std::ostringstream log;
+    log << "Sensor SceneCaptureCamera to ROS data: frame." << camera << " buffer." << image->size();
+    auto &publisher = publishers[camera];
+    publisher.SetImageDataInNewVector(image->data(), image->size());
+    publisher.Publish();
+  }, nullptr);
+
+  ROS2PublishQueue queue(2u, 2u);
+  auto queued = Benchmark([&](size_t camera, const carla::SharedBufferView &image) {
+    auto *publisher = &publishers[camera];
+    queue.Post(publisher, [publisher, image]() {
+      publisher->SetImageData(image->data(), image->size());
+      publisher->Publish();
+    });
+  }, &queue);
+
+  carla::logging::log("synchronous: caller", synchronous.caller_ms, "ms, cpu", synchronous.cpu_ms, "ms per camera");
+  carla::logging::log("queued: caller", queued.caller_ms, "ms, cpu", queued.cpu_ms, "ms per camera");
+  carla::logging::log("dropped samples", queue.GetDroppedSamples());
+  ASSERT_LT(queued.caller_ms, synchronous.caller_ms);
+}
@@ -30,13 +30,15 @@ static auto make_special_message(size_t size) {
 class Benchmark {
 public:
 
-  Benchmark(uint16_t port, size_t message_size, double success_ratio)
+  Benchmark(uint16_t port, size_t message_size, double success_ratio, bool multiplexed = false)
     : _server(port),
       _client(),
       _message(make_special_message(message_size)),
       _client_callback(),
       _work_to_do(_client_callback),
-      _success_ratio(success_ratio) {}
+      _success_ratio(success_ratio) {
+    _client.SetMultiplexed(multiplexed);
+  }
 
   void AddStream() {
     Stream stream = _server.MakeStream();
@@ -83,6 +85,7 @@ public:
     const auto threshold =
         static_cast<size_t>(_success_ratio * static_cast<double>(expected_number_of_messages));
 
+    const auto start = std::chrono::steady_clock::now();
     for (auto i = 0u; i < 10; ++i) {
       std::cout << "received " << _number_of_messages_received
                 << " of " << expected_number_of_messages
@@ -94,9 +97,12 @@ public:
       std::this_thread::sleep_for(1s);
     }
 
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+
     _client_callback.stop();
     _threads.JoinAll();
-    std::cout << " done." << std::endl;
+    std::cout << " done in " << elapsed.count() << "ms." << std::endl;
 
 #ifdef NDEBUG
     ASSERT_GE(_number_of_messages_received, threshold);
@@ -136,10 +142,13 @@ static size_t get_max_concurrency() {
 static void benchmark_image(
     const size_t dimensions,
     const size_t number_of_streams = 1u,
-    const double success_ratio = 1.0) {
+    const double success_ratio = 1.0,
+    const bool multiplexed = false) {
   constexpr auto number_of_messages = 100u;
-  carla::logging::log("Benchmark:", number_of_streams, "streams at 90FPS.");
-  Benchmark benchmark(TESTING_PORT, 4u * dimensions, success_ratio);
+  carla::logging::log(
+      "Benchmark:", number_of_streams, "streams at 90FPS",
+      multiplexed ? "over a single connection." : "over a connection each.");
+  Benchmark benchmark(TESTING_PORT, 4u * dimensions, success_ratio, multiplexed);
   benchmark.AddStreams(number_of_streams);
   benchmark.Run(number_of_messages);
 }
@@ -167,3 +176,27 @@ TEST(benchmark_streaming, image_800x600_mt) {
 TEST(benchmark_streaming, image_1920x1080_mt) {
   benchmark_image(1920u * 1080u, get_max_concurrency(), 0.9);
 }
+
+// The same benchmarks with all the streams sharing a single connection.
+
+TEST(benchmark_streaming, image_200x200_mt_multiplexed) {
+  benchmark_image(200u * 200u, get_max_concurrency(), 1.0, true);
+}
+
+TEST(benchmark_streaming, image_800x600_mt_multiplexed) {
+  benchmark_image(800u * 600u, get_max_concurrency(), 0.9, true);
+}
+
+TEST(benchmark_streaming, image_1920x1080_mt_multiplexed) {
+  benchmark_image(1920u * 1080u, get_max_concurrency(), 0.9, true);
+}
+
+// A client with many sensors.
+
+TEST(benchmark_streaming, image_200x200_many_streams) {
+  benchmark_image(200u * 200u, 20u, 0.9);
+}
+
+TEST(benchmark_streaming, image_200x200_many_streams_multiplexed) {
+  benchmark_image(200u * 200u, 20u, 0.9, true);
+}
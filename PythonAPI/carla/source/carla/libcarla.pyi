@@ -800,6 +800,93 @@ class BoundingBox():
     # endregion
 
 
+class BufferAllocator():
+    """Allocates the memory of the sensor data and the other messages received from the simulator. Sizes are rounded up to powers of two and the memory of the buffers destroyed is kept in a free list per size, shared by all the sensors of the process, to be reused by the next ones. The free lists are bounded, so the memory used by a long-running client does not keep growing.
+    """
+
+    # region Methods
+    @staticmethod
+    def get_stats() -> BufferAllocatorStats:
+        """Returns the counters of the allocator.
+
+        Returns:
+            `carla.BufferAllocatorStats`
+        """
+        ...
+
+    @staticmethod
+    def set_max_bytes_held(max_bytes: int):
+        """Bounds the bytes kept in the free lists, 256 MiB by default. Memory above the bound is returned to the system.
+
+        Args:
+            `max_bytes (int)`\n
+        """
+        ...
+
+    @staticmethod
+    def get_max_bytes_held() -> int:
+        """Returns the bound of the bytes kept in the free lists.
+
+        Returns:
+            `int`
+        """
+        ...
+
+    @staticmethod
+    def trim(max_bytes: int = 0):
+        """Returns memory of the free lists to the system, largest blocks first, until at most `max_bytes` are held.
+
+        Args:
+            `max_bytes (int)`\n
+        """
+        ...
+
+    @staticmethod
+    def set_huge_page_threshold(threshold: int):
+        """Buffers of at least `threshold` bytes are backed by transparent huge pages, which makes copying large images faster. Linux only, disabled by default.
+
+        Args:
+            `threshold (int)`: Size in bytes, zero disables huge pages.\n
+        """
+        ...
+
+    @staticmethod
+    def get_huge_page_threshold() -> int:
+        """Returns the size from which buffers are backed by huge pages, zero if disabled.
+
+        Returns:
+            `int`
+        """
+        ...
+    # endregion
+
+
+class BufferAllocatorStats():
+    """Counters of the carla.BufferAllocator, returned by carla.BufferAllocator.get_stats.
+    """
+
+    # region Instance Variables
+    @property
+    def hits(self) -> int:
+        """Buffers allocated with memory from the free lists."""
+    @property
+    def misses(self) -> int:
+        """Buffers allocated with new memory from the system."""
+    @property
+    def evictions(self) -> int:
+        """Blocks returned to the system because the free lists were full."""
+    @property
+    def bytes_held(self) -> int:
+        """Bytes in the free lists, waiting to be reused."""
+    @property
+    def blocks_held(self) -> int:
+        """Blocks in the free lists."""
+    @property
+    def bytes_allocated(self) -> int:
+        """Bytes allocated from the system and not yet returned, including the ones held."""
+    # endregion
+
+
 class CityObjectLabel(int, __CarlaEnum):
     """Enum declaration that contains the different tags available to filter the bounding boxes returned by carla.World.get_level_bbs(). These values correspond to the semantic tag that the elements in the scene have."""
     NONE = 0
@@ -943,7 +1030,7 @@ class Client():
         """
 
     def request_file(self, name: str):
-        """Requests one of the required files returned by `carla.Client.get_required_files`.
+        """Requests one of the required files returned by `carla.Client.get_required_files`. The file is not downloaded again if the cached one has the same size and content hash as the server's. It is transferred in chunks, an interrupted transfer is resumed by the next request.
 
         Args:
             `name (str)`: Name of the file you are requesting.\n
@@ -1021,7 +1108,7 @@ class Client():
 
         Args:
             `folder (str)`: Folder where files required by the client will be downloaded to.\n
-            `download (bool, optional)`: If `True`, downloads files that are not already in cache.. Defaults to True.\n
+            `download (bool, optional)`: If `True`, downloads files that are not already in cache or whose content changed in the server, several at a time. Defaults to True.\n
         """
 
     def get_server_version(self) -> str:
@@ -1076,6 +1163,13 @@ class Client():
             `second (float - seconds)`: New timeout value. Default is 5 seconds.\n
         """
 
+    def set_streaming_multiplexing(self, enabled: bool):
+        """Receives the data of all the sensors listened to afterwards through a single connection to the server, instead of a connection per sensor. Servers not supporting it keep using a connection per sensor.
+
+        Args:
+            `enabled (bool)`: Whether to share the connection. Default is False.\n
+        """
+
     # endregion
 
 
@@ -1202,6 +1296,10 @@ class DVSEventArray():
         """Image width in pixels."""
     @property
     def raw_data(self) -> bytes: ...
+    @property
+    def __array_interface__(self) -> dict:
+        """Read-only NumPy array interface, `numpy.asarray(events)` returns a record array of shape (events,) with fields x, y, t and pol without copying. The array keeps the event array alive."""
+        ...
     # endregion
 
     # region Methods
@@ -1236,6 +1334,54 @@ class DVSEventArray():
     # endregion
 
 
+class DiskWriter():
+    """Writes the images and point clouds saved with `save_to_disk` in background threads, so the sensor callbacks return without waiting for the encoding and the disk. It is disabled by default. The number of writes waiting to be done is bounded, a write requested while the writer is full is dropped, counted, and its `save_to_disk` call returns an empty string instead of blocking the simulation.
+    """
+
+    # region Methods
+    @staticmethod
+    def enable(worker_threads: int = 2, max_pending_writes: int = 64):
+        """Starts writing in the background. If it was already enabled, the pending writes of the previous writer are finished first.
+
+        Args:
+            `worker_threads (int)`: Number of threads writing to disk.\n
+            `max_pending_writes (int)`: Maximum number of writes queued or in progress. Each pending write keeps its sensor data in memory.\n
+        """
+        ...
+
+    @staticmethod
+    def disable():
+        """Waits for the pending writes and goes back to writing in the calling thread. It is called automatically when the interpreter exits."""
+        ...
+
+    @staticmethod
+    def flush():
+        """Waits until every write requested so far is on disk."""
+        ...
+
+    @staticmethod
+    def is_enabled() -> bool: ...
+
+    @staticmethod
+    def get_pending_writes() -> int:
+        """Returns the number of writes queued or in progress.
+
+        Returns:
+            `int`
+        """
+        ...
+
+    @staticmethod
+    def get_dropped_writes() -> int:
+        """Returns the number of writes dropped because the writer was full.
+
+        Returns:
+            `int`
+        """
+        ...
+    # endregion
+
+
 class DebugHelper():
     """
     Helper class part of `carla.World` that defines methods for creating debug shapes. By default, 
@@ -1649,6 +1795,10 @@ class Image(SensorData):
     def raw_data(self) -> bytes:
         """Flattened array of pixel data, use reshape to create an image array."""
         ...
+    @property
+    def __array_interface__(self) -> dict:
+        """Read-only NumPy array interface, `numpy.asarray(image)` returns an array of shape (height, width, 4) of uint8 BGRA values without copying. The array keeps the image alive."""
+        ...
     # endregion
 
     # region Methods
@@ -1660,7 +1810,7 @@ class Image(SensorData):
         """
 
     def save_to_disk(self, path: str, color_converter=ColorConverter.Raw):
-        """Saves the image to disk using a converter pattern stated as `color_converter`. The default conversion pattern is `Raw` that will make no changes to the image.
+        """Saves the image to disk using a converter pattern stated as `color_converter`. The default conversion pattern is `Raw` that will make no changes to the image. While the carla.DiskWriter is enabled, the image is written in the background and this method returns as soon as the write is queued.
 
         Args:
             `path (str)`:Path that will contain the image.\n
@@ -2059,14 +2209,22 @@ class LidarMeasurement(SensorData):
     @property
     def raw_data(self) -> bytes:
         """Received list of 4D points. Each point consists of [x,y,z] coordinates plus the intensity computed for that point."""
+    @property
+    def __array_interface__(self) -> dict:
+        """Read-only NumPy array interface, `numpy.asarray(measurement)` returns an array of shape (points, 4) of float32 [x,y,z,intensity] values without copying. The array keeps the measurement alive."""
+        ...
     # endregion
 
     # region Methods
-    def save_to_disk(self, path: str):
-        """Saves the point cloud to disk as a `.ply` file describing data from 3D scanners. The files generated are ready to be used within `MeshLab`, an open source system for processing said files. Just take into account that axis may differ from Unreal Engine and so, need to be reallocated.
+    def save_to_disk(self, path: str, binary: bool = False) -> str:
+        """Saves the point cloud to disk as a `.ply` file describing data from 3D scanners. The files generated are ready to be used within `MeshLab`, an open source system for processing said files. Just take into account that axis may differ from Unreal Engine and so, need to be reallocated. While the carla.DiskWriter is enabled, the point cloud is written in the background and this method returns as soon as the write is queued.
 
         Args:
-            path (str)
+            `path (str)`\n
+            `binary (bool)`: Write a binary PLY instead of an ASCII one. Binary files are several times smaller and faster to write and load.\n
+
+        Returns:
+            `str`
         """
     # endregion
 
@@ -2597,6 +2755,16 @@ class Map():
         """
         ...
 
+    def get_waypoints(self, locations: Iterable[Location], project_to_road: bool=True, lane_type: LaneType=LaneType.Driving) -> list[Waypoint | None]:
+        """Same as `get_waypoint` for each location in `locations`, returning a list with a waypoint or `None` for each of them. The whole batch is computed without holding the GIL, and is considerably faster than calling `get_waypoint` in a loop.
+
+        Args:
+            `locations (Iterable[Location])`: Locations used as reference for the carla.Waypoint (meters).\n
+            `project_to_road (bool, optional)`: If `True`, the waypoints will be at the center of the closest lane. If `False`, `None` is returned for the locations that do not belong to a road. Defaults to True.\n
+            `lane_type (LaneType, optional)`: Limits the search for nearest lane to one or various lane types that can be flagged. Defaults to LaneType.Driving.\n
+        """
+        ...
+
     def get_waypoint_xodr(self, road_id: int, lane_id: int, s: float) -> Waypoint | None:
         """Returns a waypoint if all the parameters passed are correct. Otherwise, returns `None`.
 
@@ -2741,6 +2909,10 @@ class OpticalFlowImage(SensorData):
     @property
     def raw_data(self) -> bytes:
         """Flattened array of pixel data, use reshape to create an image array."""
+    @property
+    def __array_interface__(self) -> dict:
+        """Read-only NumPy array interface, `numpy.asarray(image)` returns an array of shape (height, width, 2) of float32 flow components without copying. The array keeps the image alive."""
+        ...
     # endregion
 
     # region Getters
@@ -2929,6 +3101,10 @@ class RadarMeasurement(SensorData):
     def raw_data(self) -> bytes:
         """The complete information of the `carla.RadarDetection` the radar has registered.
         """
+    @property
+    def __array_interface__(self) -> dict:
+        """Read-only NumPy array interface, `numpy.asarray(measurement)` returns an array of shape (detections, 4) of float32 [velocity,azimuth,altitude,depth] values without copying. The array keeps the measurement alive."""
+        ...
     # endregion
 
     # region Getters
@@ -3048,14 +3224,22 @@ class SemanticLidarMeasurement(SensorData):
     @property
     def raw_data(self) -> bytes:
         """Received list of raw detection points. Each point consists of [x,y,z] coordinates plus the cosine of the incident angle, the index of the hit actor, and its semantic tag."""
+    @property
+    def __array_interface__(self) -> dict:
+        """Read-only NumPy array interface, `numpy.asarray(measurement)` returns a record array of shape (points,) with fields x, y, z, cos_inc_angle, object_idx and object_tag without copying. The array keeps the measurement alive."""
+        ...
     # endregion
 
     # region Methods
-    def save_to_disk(self, path: str):
-        """Saves the point cloud to disk as a `.ply` file describing data from 3D scanners. The files generated are ready to be used within `MeshLab`, an open-source system for processing said files. Just take into account that axis may differ from Unreal Engine and so, need to be reallocated.
+    def save_to_disk(self, path: str, binary: bool = False) -> str:
+        """Saves the point cloud to disk as a `.ply` file describing data from 3D scanners. The files generated are ready to be used within `MeshLab`, an open-source system for processing said files. Just take into account that axis may differ from Unreal Engine and so, need to be reallocated. While the carla.DiskWriter is enabled, the point cloud is written in the background and this method returns as soon as the write is queued.
 
         Args:
             `path (str)`\n
+            `binary (bool)`: Write a binary PLY instead of an ASCII one. Binary files are several times smaller and faster to write and load.\n
+
+        Returns:
+            `str`
         """
     # endregion
 
@@ -3297,6 +3481,71 @@ class Timestamp():
     # endregion
 
 
+class Tracer():
+    """Records a timeline of what every thread of the client is doing, to find out why a given frame was slow. RPC calls, the streaming client, the episode updates, the Traffic Manager stages and the walker navigation record spans and counters in per-thread ring buffers, where the oldest events are overwritten when full. The timeline is exported in the Chrome trace event format, that can be opened in chrome://tracing or Perfetto. The tracer is disabled by default and costs next to nothing while disabled.
+    """
+
+    # region Methods
+    @staticmethod
+    def enable(events_per_thread: int = 65536):
+        """Starts recording events.
+
+        Args:
+            `events_per_thread (int)`: Number of events kept for each thread, rounded up to a power of two. It applies to threads that record their first event after this call.\n
+        """
+        ...
+
+    @staticmethod
+    def disable():
+        """Stops recording events. The events recorded so far are kept."""
+        ...
+
+    @staticmethod
+    def is_enabled() -> bool:
+        """Returns whether events are being recorded.
+
+        Returns:
+            `bool`
+        """
+        ...
+
+    @staticmethod
+    def clear():
+        """Discards the events recorded so far."""
+        ...
+
+    @staticmethod
+    def set_thread_name(name: str):
+        """Names the calling thread in the exported timeline.
+
+        Args:
+            `name (str)`\n
+        """
+        ...
+
+    @staticmethod
+    def get_chrome_trace() -> str:
+        """Returns the recorded events as a Chrome trace JSON document.
+
+        Returns:
+            `str`
+        """
+        ...
+
+    @staticmethod
+    def save_chrome_trace(path: str) -> bool:
+        """Writes the recorded events as a Chrome trace JSON document. Returns False if the file could not be written.
+
+        Args:
+            `path (str)`: Path of the JSON file to write.\n
+
+        Returns:
+            `bool`
+        """
+        ...
+    # endregion
+
+
 class TrafficLight(TrafficSign):
     """ traffic light actor, considered a specific type of traffic sign. As traffic lights will mostly appear at junctions, they belong to a group which contains the different traffic lights in it. Inside the group, traffic lights are differenciated by their pole index.
 
@@ -3639,6 +3888,13 @@ class TrafficManager():
             mode_switch (bool, optional): If True, the OSM mode is enabled. Defaults to True.
         """
 
+    def set_worker_threads(self, count: int):
+        """Sets the number of threads running the Traffic Manager stages. With more than one thread, vehicles are updated in parallel. Results are still deterministic for a given seed and number of threads.
+
+        Args:
+            count (int): Number of threads, including the Traffic Manager thread. Defaults to 1.
+        """
+
     def set_path(self, actor: Actor, path: list[Location]):
         """Sets a list of locations for a vehicle to follow while controlled by the Traffic Manager.
 
@@ -5108,6 +5364,17 @@ class World():
             `percentage (float)`: Value should be between 0.0 and 1.0. For example, a value of 0.1 would allow 10% of pedestrians to walk on the road.\n
         """
 
+    def set_pedestrians_crowd_settings(self, max_agents: int = 500, tile_size: float = 0.0, worker_threads: int = 1):
+        """Configures the crowd simulating the pedestrians. Splitting the crowd in tiles raises the number of pedestrians beyond `max_agents` and lets each tile be updated in its own thread. Pedestrians crossing a tile border are handed off to the next tile.
+
+        + Note: Should be set before pedestrians are spawned. Changing the settings afterwards moves the pedestrians to the new tiles.
+
+        Args:
+            `max_agents (int)`: Maximum number of agents (pedestrians and the vehicles near them) in each crowd tile.\n
+            `tile_size (float - meters)`: Size of the square tiles the crowd is split in. 0.0 keeps a single crowd for the whole map.\n
+            `worker_threads (int)`: Number of threads updating the crowd tiles in parallel.\n
+        """
+
     def set_pedestrians_seed(self, seed: int):
         """ Sets the seed to use for any random number generated in relation to pedestrians.
 
@@ -5214,6 +5481,13 @@ class WorldSettings():
     def spectator_as_ego(self, value: float):
         ...
 
+    @property
+    def delta_episode_state(self) -> bool:
+        """If enabled, the server sends the state of every actor only in periodic keyframes and, in between, only the actors that were created, changed or destroyed. Reduces bandwidth and client work in episodes with many static actors. By default, the value is set to False."""
+    @delta_episode_state.setter
+    def delta_episode_state(self, value: bool):
+        ...
+
     # region Methods
     def __init__(self,
                  synchronous_mode=False,
@@ -5223,7 +5497,8 @@ class WorldSettings():
                  deterministic_ragdolls=False,
                  tile_stream_distance=3000,
                  actor_active_distance=2000,
-                 spectator_as_ego=True):
+                 spectator_as_ego=True,
+                 delta_episode_state=False):
         """Creates an object containing desired settings that could later be applied through `carla.World` and its method `apply_settings()`.
 
         Args:
@@ -5235,6 +5510,7 @@ class WorldSettings():
             `tile_stream_distance (int, optional)`: Used for large maps only. Configures the maximum distance from the hero vehicle to stream tiled maps (meters). Defaults to 3000.\n
             `actor_active_distance (int, optional)`: Used for large maps only. Configures the distance from the hero vehicle to convert actors to dormant (meters). Defaults to 2000.\n
             `spectator_as_ego (bool, optional)`: Used for large maps only. Defines the influence of the spectator on tile loading in Large Maps. Defaults to True.\n
+            `delta_episode_state (bool, optional)`: Send only the actors that changed between keyframes of the world state. Defaults to False.\n
 
         Returns:
             `WorldSettings`: _description_\n
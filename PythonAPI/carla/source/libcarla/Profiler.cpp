@@ -0,0 +1,67 @@
+// Copyright (c) 2024 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include <carla/BufferAllocator.h>
+#include <carla/PythonUtil.h>
+#include <carla/profiler/Tracer.h>
+
+static std::string GetChromeTrace() {
+  carla::PythonUtil::ReleaseGIL unlock;
+  return carla::profiler::Tracer::GetChromeTrace();
+}
+
+static bool SaveChromeTrace(const std::string &path) {
+  carla::PythonUtil::ReleaseGIL unlock;
+  return carla::profiler::Tracer::SaveChromeTrace(path);
+}
+
+void export_profiler() {
+  using namespace boost::python;
+  using carla::profiler::Tracer;
+
+  class_<Tracer, boost::noncopyable>("Tracer", no_init)
+    .def("enable", &Tracer::Enable, (arg("events_per_thread")=Tracer::DEFAULT_EVENTS_PER_THREAD))
+      .staticmethod("enable")
+    .def("disable", &Tracer::Disable)
+      .staticmethod("disable")
+    .def("is_enabled", &Tracer::IsEnabled)
+      .staticmethod("is_enabled")
+    .def("clear", &Tracer::Clear)
+      .staticmethod("clear")
+    .def("set_thread_name", &Tracer::SetThreadName, (arg("name")))
+      .staticmethod("set_thread_name")
+    .def("get_chrome_trace", &GetChromeTrace)
+      .staticmethod("get_chrome_trace")
+    .def("save_chrome_trace", &SaveChromeTrace, (arg("path")))
+      .staticmethod("save_chrome_trace")
+  ;
+
+  using carla::BufferAllocator;
+
+  class_<BufferAllocator::Stats>("BufferAllocatorStats", no_init)
+    .def_readonly("hits", &BufferAllocator::Stats::hits)
+    .def_readonly("misses", &BufferAllocator::Stats::misses)
+    .def_readonly("evictions", &BufferAllocator::Stats::evictions)
+    .def_readonly("bytes_held", &BufferAllocator::Stats::bytes_held)
+    .def_readonly("blocks_held", &BufferAllocator::Stats::blocks_held)
+    .def_readonly("bytes_allocated", &BufferAllocator::Stats::bytes_allocated)
+  ;
+
+  class_<BufferAllocator, boost::noncopyable>("BufferAllocator", no_init)
+    .def("get_stats", &BufferAllocator::GetStats)
+      .staticmethod("get_stats")
+    .def("set_max_bytes_held", &BufferAllocator::SetMaxBytesHeld, (arg("max_bytes")))
+      .staticmethod("set_max_bytes_held")
+    .def("get_max_bytes_held", &BufferAllocator::GetMaxBytesHeld)
+      .staticmethod("get_max_bytes_held")
+    .def("trim", &BufferAllocator::Trim, (arg("max_bytes")=0u))
+      .staticmethod("trim")
+    .def("set_huge_page_threshold", &BufferAllocator::SetHugePageThreshold, (arg("threshold")))
+      .staticmethod("set_huge_page_threshold")
+    .def("get_huge_page_threshold", &BufferAllocator::GetHugePageThreshold)
+      .staticmethod("get_huge_page_threshold")
+  ;
+}
@@ -4,8 +4,10 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
+#include <carla/DiskWriterPool.h>
+#include <carla/FileSystem.h>
 #include <carla/PythonUtil.h>
-#include <carla/image/ImageConverter.h>
+#include <carla/image/ColorConverterKernels.h>
 #include <carla/image/ImageIO.h>
 #include <carla/image/ImageView.h>
 #include <carla/pointcloud/PointCloudIO.h>
@@ -33,6 +35,7 @@
 #include <cmath>
 #include <vector>
 #include <algorithm>
+#include <memory>
 #include <thread>
 
 namespace carla {
@@ -226,20 +229,129 @@ static auto GetRawDataAsBuffer(T &self) {
   return boost::python::object(boost::python::handle<>(ptr));
 }
 
+/// Type string of a NumPy array interface for values of the given @a kind
+/// and @a size in bytes, in the byte order of this platform.
+static std::string GetArrayTypestr(char kind, size_t size) {
+  static const uint16_t one = 1u;
+  const bool little_endian = *reinterpret_cast<const uint8_t *>(&one) == 1u;
+  const char byte_order = size == 1u ? '|' : (little_endian ? '<' : '>');
+  return byte_order + (kind + std::to_string(size));
+}
+
+/// NumPy array interface viewing the data of @a self without copying.
+/// numpy.asarray keeps a reference to the Python object exposing it, so the
+/// sensor data and its buffer outlive the array. The view is read-only, as
+/// the buffer may be shared with other callbacks of the same sensor.
+template <typename T>
+static boost::python::dict MakeArrayInterface(
+    const T &self,
+    boost::python::tuple shape,
+    boost::python::tuple strides,
+    const std::string &typestr,
+    boost::python::list descr = boost::python::list()) {
+  namespace py = boost::python;
+  py::dict interface;
+  interface["version"] = 3;
+  interface["shape"] = shape;
+  interface["strides"] = strides;
+  interface["typestr"] = typestr;
+  if (py::len(descr) > 0) {
+    interface["descr"] = descr;
+  }
+  interface["data"] = py::make_tuple(reinterpret_cast<uintptr_t>(self.data()), true);
+  return interface;
+}
+
+/// Images are viewed as (height, width, channels) arrays, BGRA for colors.
+static boost::python::dict GetImageArrayInterface(const carla::sensor::data::Image &self) {
+  namespace py = boost::python;
+  using Pixel = carla::sensor::data::Color;
+  static_assert(sizeof(Pixel) == 4u * sizeof(uint8_t), "Unexpected color layout");
+  return MakeArrayInterface(
+      self,
+      py::make_tuple(self.GetHeight(), self.GetWidth(), 4u),
+      py::make_tuple(self.GetWidth() * sizeof(Pixel), sizeof(Pixel), sizeof(uint8_t)),
+      GetArrayTypestr('u', sizeof(uint8_t)));
+}
+
+static boost::python::dict GetOpticalFlowArrayInterface(const carla::sensor::data::OpticalFlowImage &self) {
+  namespace py = boost::python;
+  using Pixel = carla::sensor::data::OpticalFlowPixel;
+  static_assert(sizeof(Pixel) == 2u * sizeof(float), "Unexpected optical flow pixel layout");
+  return MakeArrayInterface(
+      self,
+      py::make_tuple(self.GetHeight(), self.GetWidth(), 2u),
+      py::make_tuple(self.GetWidth() * sizeof(Pixel), sizeof(Pixel), sizeof(float)),
+      GetArrayTypestr('f', sizeof(float)));
+}
+
+/// Arrays of detections made only of floats are viewed as (size, fields)
+/// arrays, e.g. (x, y, z, intensity) for each lidar point.
+template <typename T>
+static boost::python::dict GetFloatDetectionArrayInterface(const T &self) {
+  namespace py = boost::python;
+  using Detection = typename T::value_type;
+  static_assert(sizeof(Detection) % sizeof(float) == 0u, "Unexpected detection layout");
+  return MakeArrayInterface(
+      self,
+      py::make_tuple(self.size(), sizeof(Detection) / sizeof(float)),
+      py::make_tuple(sizeof(Detection), sizeof(float)),
+      GetArrayTypestr('f', sizeof(float)));
+}
+
+/// Arrays of detections with fields of different types are viewed as one
+/// dimensional arrays of records.
+template <typename T>
+static boost::python::dict GetRecordArrayInterface(const T &self, boost::python::list descr) {
+  namespace py = boost::python;
+  using Record = typename T::value_type;
+  return MakeArrayInterface(
+      self,
+      py::make_tuple(self.size()),
+      py::make_tuple(sizeof(Record)),
+      GetArrayTypestr('V', sizeof(Record)),
+      descr);
+}
+
+static boost::python::dict GetSemanticLidarArrayInterface(const carla::sensor::data::SemanticLidarMeasurement &self) {
+  namespace py = boost::python;
+  static_assert(sizeof(carla::sensor::data::SemanticLidarDetection) == 24u, "Unexpected semantic lidar detection layout");
+  py::list descr;
+  descr.append(py::make_tuple("x", GetArrayTypestr('f', 4u)));
+  descr.append(py::make_tuple("y", GetArrayTypestr('f', 4u)));
+  descr.append(py::make_tuple("z", GetArrayTypestr('f', 4u)));
+  descr.append(py::make_tuple("cos_inc_angle", GetArrayTypestr('f', 4u)));
+  descr.append(py::make_tuple("object_idx", GetArrayTypestr('u', 4u)));
+  descr.append(py::make_tuple("object_tag", GetArrayTypestr('u', 4u)));
+  return GetRecordArrayInterface(self, descr);
+}
+
+static boost::python::dict GetDVSArrayInterface(const carla::sensor::data::DVSEventArray &self) {
+  namespace py = boost::python;
+  static_assert(sizeof(carla::sensor::data::DVSEvent) == 13u, "Unexpected DVS event layout");
+  py::list descr;
+  descr.append(py::make_tuple("x", GetArrayTypestr('u', 2u)));
+  descr.append(py::make_tuple("y", GetArrayTypestr('u', 2u)));
+  descr.append(py::make_tuple("t", GetArrayTypestr('i', 8u)));
+  descr.append(py::make_tuple("pol", GetArrayTypestr('b', 1u)));
+  return GetRecordArrayInterface(self, descr);
+}
+
 template <typename T>
 static void ConvertImage(T &self, EColorConverter cc) {
   carla::PythonUtil::ReleaseGIL unlock;
   using namespace carla::image;
-  auto view = ImageView::MakeView(self);
+  auto *begin = self.data();
+  auto *end = begin + self.size();
   switch (cc) {
     case EColorConverter::Depth:
-      ImageConverter::ConvertInPlace(view, ColorConverter::Depth());
+      ColorConverterKernels::ConvertInPlace(begin, end, ColorConverter::Depth());
       break;
     case EColorConverter::LogarithmicDepth:
-      ImageConverter::ConvertInPlace(view, ColorConverter::LogarithmicDepth());
+      ColorConverterKernels::ConvertInPlace(begin, end, ColorConverter::LogarithmicDepth());
       break;
     case EColorConverter::CityScapesPalette:
-      ImageConverter::ConvertInPlace(view, ColorConverter::CityScapesPalette());
+      ColorConverterKernels::ConvertInPlace(begin, end, ColorConverter::CityScapesPalette());
       break;
     case EColorConverter::Raw:
       break; // ignore.
@@ -360,11 +472,74 @@ static FakeImage ColorCodedFlow (
   return result;
 }
 
-template <typename T>
-static std::string SaveImageToDisk(T &self, std::string path, EColorConverter cc) {
+/// Writer shared by every save_to_disk call, null while disabled. Guarded by
+/// the GIL.
+static std::shared_ptr<carla::DiskWriterPool> &GetDiskWriter() {
+  static std::shared_ptr<carla::DiskWriterPool> writer;
+  return writer;
+}
+
+static void DisableDiskWriter() {
+  auto writer = std::move(GetDiskWriter());
+  carla::PythonUtil::ReleaseGIL unlock;
+  // Finish the pending writes before the GIL is acquired again, they may
+  // need it to release the sensor data.
+  writer.reset();
+}
+
+static void EnableDiskWriter(size_t worker_threads, size_t max_pending_writes) {
+  DisableDiskWriter();
+  GetDiskWriter() = std::make_shared<carla::DiskWriterPool>(worker_threads, max_pending_writes);
+}
+
+static void FlushDiskWriter() {
+  auto writer = GetDiskWriter();
+  if (writer != nullptr) {
+    carla::PythonUtil::ReleaseGIL unlock;
+    writer->Flush();
+  }
+}
+
+static bool IsDiskWriterEnabled() {
+  return GetDiskWriter() != nullptr;
+}
+
+static size_t GetDiskWriterPendingWrites() {
+  auto writer = GetDiskWriter();
+  return writer != nullptr ? writer->GetPendingWrites() : 0u;
+}
+
+static size_t GetDiskWriterDroppedWrites() {
+  auto writer = GetDiskWriter();
+  return writer != nullptr ? writer->GetDroppedWrites() : 0u;
+}
+
+/// Write @a self in the disk writer, keeping it alive until written. The path
+/// is validated before returning so the caller knows the final file name.
+/// Return an empty string if the writer was full and the write was dropped.
+template <typename T, typename WriteT>
+static std::string PostDiskWrite(
+    std::shared_ptr<carla::DiskWriterPool> writer,
+    boost::shared_ptr<T> self,
+    std::string path,
+    const char *default_extension,
+    WriteT write) {
+  // The Python object referenced by self needs to be released with the GIL.
+  auto data = carla::SharedPtr<boost::shared_ptr<T>>{
+      new boost::shared_ptr<T>(std::move(self)),
+      carla::PythonUtil::AcquireGILDeleter()};
   carla::PythonUtil::ReleaseGIL unlock;
+  carla::FileSystem::ValidateFilePath(path, default_extension);
+  const bool posted = writer->Post([=]() { write(**data, path); });
+  // Drop our reference while the GIL is released, see DisableDiskWriter.
+  writer.reset();
+  return posted ? path : std::string();
+}
+
+template <typename T>
+static std::string WriteImage(const T &image, std::string path, EColorConverter cc) {
   using namespace carla::image;
-  auto view = ImageView::MakeView(self);
+  auto view = ImageView::MakeView(image);
   switch (cc) {
     case EColorConverter::Raw:
       return ImageIO::WriteView(
@@ -388,9 +563,41 @@ static std::string SaveImageToDisk(T &self, std::string path, EColorConverter cc
 }
 
 template <typename T>
-static std::string SavePointCloudToDisk(T &self, std::string path) {
-  carla::PythonUtil::ReleaseGIL unlock;
-  return carla::pointcloud::PointCloudIO::SaveToDisk(std::move(path), self.begin(), self.end());
+static std::string SaveImageToDisk(boost::shared_ptr<T> self, std::string path, EColorConverter cc) {
+  auto writer = GetDiskWriter();
+  if (writer == nullptr) {
+    carla::PythonUtil::ReleaseGIL unlock;
+    return WriteImage(*self, std::move(path), cc);
+  }
+  return PostDiskWrite(
+      std::move(writer),
+      std::move(self),
+      std::move(path),
+      carla::image::io::any::get_default_extension(),
+      [cc](const T &image, const std::string &final_path) { WriteImage(image, final_path, cc); });
+}
+
+template <typename T>
+static std::string WritePointCloud(const T &self, std::string path, bool binary) {
+  using carla::pointcloud::PointCloudIO;
+  return binary ?
+      PointCloudIO::SaveBinaryToDisk(std::move(path), self.begin(), self.end()) :
+      PointCloudIO::SaveToDisk(std::move(path), self.begin(), self.end());
+}
+
+template <typename T>
+static std::string SavePointCloudToDisk(boost::shared_ptr<T> self, std::string path, bool binary) {
+  auto writer = GetDiskWriter();
+  if (writer == nullptr) {
+    carla::PythonUtil::ReleaseGIL unlock;
+    return WritePointCloud(*self, std::move(path), binary);
+  }
+  return PostDiskWrite(
+      std::move(writer),
+      std::move(self),
+      std::move(path),
+      ".ply",
+      [binary](const T &point_cloud, const std::string &final_path) { WritePointCloud(point_cloud, final_path, binary); });
 }
 
 static boost::python::dict GetCAMData(const carla::sensor::data::CAMData message)
@@ -480,6 +687,7 @@ void export_sensor_data() {
     .add_property("height", &csd::Image::GetHeight)
     .add_property("fov", &csd::Image::GetFOVAngle)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::Image>)
+    .add_property("__array_interface__", &GetImageArrayInterface)
     .def("convert", &ConvertImage<csd::Image>, (arg("color_converter")))
     .def("save_to_disk", &SaveImageToDisk<csd::Image>, (arg("path"), arg("color_converter")=EColorConverter::Raw))
     .def("__len__", &csd::Image::size)
@@ -498,6 +706,7 @@ void export_sensor_data() {
     .add_property("height", &csd::OpticalFlowImage::GetHeight)
     .add_property("fov", &csd::OpticalFlowImage::GetFOVAngle)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::OpticalFlowImage>)
+    .add_property("__array_interface__", &GetOpticalFlowArrayInterface)
     .def("get_color_coded_flow", &ColorCodedFlow)
     .def("__len__", &csd::OpticalFlowImage::size)
     .def("__iter__", iterator<csd::OpticalFlowImage>())
@@ -514,8 +723,9 @@ void export_sensor_data() {
     .add_property("horizontal_angle", &csd::LidarMeasurement::GetHorizontalAngle)
     .add_property("channels", &csd::LidarMeasurement::GetChannelCount)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::LidarMeasurement>)
+    .add_property("__array_interface__", &GetFloatDetectionArrayInterface<csd::LidarMeasurement>)
     .def("get_point_count", &csd::LidarMeasurement::GetPointCount, (arg("channel")))
-    .def("save_to_disk", &SavePointCloudToDisk<csd::LidarMeasurement>, (arg("path")))
+    .def("save_to_disk", &SavePointCloudToDisk<csd::LidarMeasurement>, (arg("path"), arg("binary")=false))
     .def("__len__", &csd::LidarMeasurement::size)
     .def("__iter__", iterator<csd::LidarMeasurement>())
     .def("__getitem__", +[](const csd::LidarMeasurement &self, size_t pos) -> csd::LidarDetection {
@@ -531,8 +741,9 @@ void export_sensor_data() {
     .add_property("horizontal_angle", &csd::SemanticLidarMeasurement::GetHorizontalAngle)
     .add_property("channels", &csd::SemanticLidarMeasurement::GetChannelCount)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::SemanticLidarMeasurement>)
+    .add_property("__array_interface__", &GetSemanticLidarArrayInterface)
     .def("get_point_count", &csd::SemanticLidarMeasurement::GetPointCount, (arg("channel")))
-    .def("save_to_disk", &SavePointCloudToDisk<csd::SemanticLidarMeasurement>, (arg("path")))
+    .def("save_to_disk", &SavePointCloudToDisk<csd::SemanticLidarMeasurement>, (arg("path"), arg("binary")=false))
     .def("__len__", &csd::SemanticLidarMeasurement::size)
     .def("__iter__", iterator<csd::SemanticLidarMeasurement>())
     .def("__getitem__", +[](const csd::SemanticLidarMeasurement &self, size_t pos) -> csd::SemanticLidarDetection {
@@ -580,6 +791,7 @@ void export_sensor_data() {
 
   class_<csd::RadarMeasurement, bases<cs::SensorData>, boost::noncopyable, boost::shared_ptr<csd::RadarMeasurement>>("RadarMeasurement", no_init)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::RadarMeasurement>)
+    .add_property("__array_interface__", &GetFloatDetectionArrayInterface<csd::RadarMeasurement>)
     .def("get_detection_count", &csd::RadarMeasurement::GetDetectionAmount)
     .def("__len__", &csd::RadarMeasurement::size)
     .def("__iter__", iterator<csd::RadarMeasurement>())
@@ -627,6 +839,7 @@ void export_sensor_data() {
     .add_property("height", &csd::DVSEventArray::GetHeight)
     .add_property("fov", &csd::DVSEventArray::GetFOVAngle)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::DVSEventArray>)
+    .add_property("__array_interface__", &GetDVSArrayInterface)
     .def("__len__", &csd::DVSEventArray::size)
     .def("__iter__", iterator<csd::DVSEventArray>())
     .def("__getitem__", +[](const csd::DVSEventArray &self, size_t pos) -> csd::DVSEvent {
@@ -673,4 +886,22 @@ void export_sensor_data() {
       return self.at(pos);
     })
   ;
+
+  class_<carla::DiskWriterPool, boost::noncopyable>("DiskWriter", no_init)
+    .def("enable", &EnableDiskWriter, (arg("worker_threads")=2u, arg("max_pending_writes")=64u))
+      .staticmethod("enable")
+    .def("disable", &DisableDiskWriter)
+      .staticmethod("disable")
+    .def("flush", &FlushDiskWriter)
+      .staticmethod("flush")
+    .def("is_enabled", &IsDiskWriterEnabled)
+      .staticmethod("is_enabled")
+    .def("get_pending_writes", &GetDiskWriterPendingWrites)
+      .staticmethod("get_pending_writes")
+    .def("get_dropped_writes", &GetDiskWriterDroppedWrites)
+      .staticmethod("get_dropped_writes")
+  ;
+
+  // The pending writes need the interpreter to release the sensor data.
+  import("atexit").attr("register")(make_function(&DisableDiskWriter));
 }
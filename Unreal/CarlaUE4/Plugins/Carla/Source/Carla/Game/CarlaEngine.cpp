@@ -23,6 +23,7 @@
 #include <carla/Logging.h>
 #include <carla/multigpu/primaryCommands.h>
 #include <carla/multigpu/commands.h>
+#include <carla/multigpu/loadReport.h>
 #include <carla/multigpu/secondary.h>
 #include <carla/multigpu/secondaryCommands.h>
 #include <carla/ros2/ROS2.h>
@@ -303,11 +304,13 @@ void FCarlaEngine::OnPreTick(UWorld *, ELevelTick TickType, float DeltaSeconds)
     else
     {
       // process frame data
+      const double WaitStart = FPlatformTime::Seconds();
       do
       {
         Server.RunSome(1u);
       }
       while (!FramesToProcess.size());
+      FrameWaitSeconds = FPlatformTime::Seconds() - WaitStart;
     }
 
     // update frame counter
@@ -325,6 +328,20 @@ void FCarlaEngine::OnPreTick(UWorld *, ELevelTick TickType, float DeltaSeconds)
           std::lock_guard<std::mutex> Lock(FrameToProcessMutex);
           FramesToProcess.front().PlayFrameData(CurrentEpisode, MappedId);
           FramesToProcess.erase(FramesToProcess.begin()); // remove first element
+
+          // report the load so the primary server places new sensors on the
+          // least loaded secondary server
+          const double Now = FPlatformTime::Seconds();
+          if (LastFramePlayedTime > 0.0)
+          {
+            carla::multigpu::LoadReport Report;
+            Report.frame = static_cast<uint32_t>(GetFrameCounter());
+            const double FrameSeconds = (Now - LastFramePlayedTime) - FrameWaitSeconds;
+            Report.frame_time_us = static_cast<uint32_t>(1e6 * std::max(FrameSeconds, 0.0));
+            Report.queue_depth = static_cast<uint32_t>(FramesToProcess.size());
+            Secondary->GetCommander().SendLoadReport(Report);
+          }
+          LastFramePlayedTime = Now;
         }
       }
     }
@@ -375,6 +392,10 @@ void FCarlaEngine::OnPostTick(UWorld *World, ELevelTick TickType, float DeltaSec
     }
 
     // send the worldsnapshot
+    if (Server.TakeEpisodeKeyframeRequest())
+    {
+      WorldObserver.RequestKeyframe();
+    }
     WorldObserver.BroadcastTick(*CurrentEpisode, DeltaSeconds, bMapChanged, LightUpdatePending);
     CurrentEpisode->GetSensorManager().PostPhysTick(World, TickType, DeltaSeconds);
     ResetSimulationState();
@@ -135,6 +135,12 @@ private:
 
   std::vector<FFrameData> FramesToProcess;
   std::mutex FrameToProcessMutex;
+
+  /// Time the last frame data was played in a secondary server, and time it
+  /// waited since for the next one, to report its frame time to the primary
+  /// server.
+  double LastFramePlayedTime = 0.0;
+  double FrameWaitSeconds = 0.0;
 };
 
 // Note: this has a circular dependency with FCarlaEngine; it must be included late.
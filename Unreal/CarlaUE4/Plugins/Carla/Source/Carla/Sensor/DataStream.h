@@ -67,6 +67,13 @@ public:
     return Stream->AreClientsListening();
   }
 
+  /// Number of clients that subscribed to this stream so far.
+  size_t GetConnectionCount() const
+  {
+    check(Stream.has_value());
+    return Stream->GetConnectionCount();
+  }
+
 private:
 
   boost::optional<StreamType> Stream;
@@ -185,32 +185,29 @@ void FPixelReader::SendPixelsInRenderThread(TSensor &Sensor, bool use16BitFormat
                 {
                   TRACE_CPUPROFILER_EVENT_SCOPE_STR("ROS2 Send PixelReader");
                   auto StreamId = carla::streaming::detail::token_type(Sensor.GetToken()).get_stream_id();
-                  auto Res = std::async(std::launch::async, [&Sensor, ROS2, &Stream, StreamId, BufView]()
+                  // get resolution of camera
+                  int W = -1, H = -1;
+                  float Fov = -1.0f;
+                  auto WidthOpt = Sensor.GetAttribute("image_size_x");
+                  if (WidthOpt.has_value())
+                    W = FCString::Atoi(*WidthOpt->Value);
+                  auto HeightOpt = Sensor.GetAttribute("image_size_y");
+                  if (HeightOpt.has_value())
+                    H = FCString::Atoi(*HeightOpt->Value);
+                  auto FovOpt = Sensor.GetAttribute("fov");
+                  if (FovOpt.has_value())
+                    Fov = FCString::Atof(*FovOpt->Value);
+                  // send data to ROS2
+                  AActor* ParentActor = Sensor.GetAttachParentActor();
+                  if (ParentActor)
                   {
-                    // get resolution of camera
-                    int W = -1, H = -1;
-                    float Fov = -1.0f;
-                    auto WidthOpt = Sensor.GetAttribute("image_size_x");
-                    if (WidthOpt.has_value())
-                      W = FCString::Atoi(*WidthOpt->Value);
-                    auto HeightOpt = Sensor.GetAttribute("image_size_y");
-                    if (HeightOpt.has_value())
-                      H = FCString::Atoi(*HeightOpt->Value);
-                    auto FovOpt = Sensor.GetAttribute("fov");
-                    if (FovOpt.has_value())
-                      Fov = FCString::Atof(*FovOpt->Value);
-                    // send data to ROS2
-                    AActor* ParentActor = Sensor.GetAttachParentActor();
-                    if (ParentActor)
-                    {
-                      FTransform LocalTransformRelativeToParent = Sensor.GetActorTransform().GetRelativeTransform(ParentActor->GetActorTransform());
-                      ROS2->ProcessDataFromCamera(Stream.GetSensorType(), StreamId, LocalTransformRelativeToParent, W, H, Fov, BufView, &Sensor);
-                    }
-                    else
-                    {
-                      ROS2->ProcessDataFromCamera(Stream.GetSensorType(), StreamId, Stream.GetSensorTransform(), W, H, Fov, BufView, &Sensor);
-                    }
-                  });
+                    FTransform LocalTransformRelativeToParent = Sensor.GetActorTransform().GetRelativeTransform(ParentActor->GetActorTransform());
+                    ROS2->ProcessDataFromCamera(Stream.GetSensorType(), StreamId, LocalTransformRelativeToParent, W, H, Fov, BufView, &Sensor);
+                  }
+                  else
+                  {
+                    ROS2->ProcessDataFromCamera(Stream.GetSensorType(), StreamId, Stream.GetSensorTransform(), W, H, Fov, BufView, &Sensor);
+                  }
                 }
                 #endif
 
@@ -265,34 +265,133 @@ static carla::geom::Vector3D FWorldObserver_GetAcceleration(
   return {Acceleration.X, Acceleration.Y, Acceleration.Z};
 }
 
+static carla::sensor::data::ActorDynamicState FWorldObserver_GetActorDynamicState(
+    const FCarlaActor &View,
+    const FActorRegistry &Registry,
+    const float DeltaSeconds)
+{
+  constexpr float TO_METERS = 1e-2;
+
+  FTransform ActorTransform;
+  FVector Velocity(0.0f);
+  carla::geom::Vector3D AngularVelocity(0.0f, 0.0f, 0.0f);
+  carla::geom::Vector3D Acceleration(0.0f, 0.0f, 0.0f);
+  carla::sensor::data::ActorDynamicState::TypeDependentState State{};
+
+  if(View.IsDormant())
+  {
+    const FActorData* ActorData = View.GetActorData();
+    Velocity = TO_METERS * ActorData->Velocity;
+    AngularVelocity = carla::geom::Vector3D
+                      {ActorData->AngularVelocity.X,
+                       ActorData->AngularVelocity.Y,
+                       ActorData->AngularVelocity.Z};
+    Acceleration = FWorldObserver_GetAcceleration(View, Velocity, DeltaSeconds);
+    State = FWorldObserver_GetDormantActorState(View, Registry);
+  }
+  else
+  {
+    Velocity = TO_METERS * View.GetActor()->GetVelocity();
+    AngularVelocity = FWorldObserver_GetAngularVelocity(*View.GetActor());
+    Acceleration = FWorldObserver_GetAcceleration(View, Velocity, DeltaSeconds);
+    State = FWorldObserver_GetActorState(View, Registry);
+  }
+  ActorTransform = View.GetActorGlobalTransform();
+
+  return {
+    View.GetActorId(),
+    View.GetActorState(),
+    carla::geom::Transform(ActorTransform),
+    carla::geom::Vector3D(Velocity.X, Velocity.Y, Velocity.Z),
+    AngularVelocity,
+    Acceleration,
+    State,
+  };
+}
+
+/// Serialize the state of the episode. If @a SentActors is not null, it is
+/// updated with the actors sent, and unless @a bKeyframe only the actors that
+/// changed with respect to it are sent.
 static carla::Buffer FWorldObserver_Serialize(
     carla::Buffer &&buffer,
     const UCarlaEpisode &Episode,
     float DeltaSeconds,
     bool MapChange,
-    bool PendingLightUpdates)
+    bool PendingLightUpdates,
+    TMap<carla::rpc::ActorId, carla::sensor::data::ActorDynamicState> *SentActors,
+    bool bKeyframe,
+    uint64_t BaseFrame)
 {
   TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
   using Serializer = carla::sensor::s11n::EpisodeStateSerializer;
   using SimulationState = carla::sensor::s11n::EpisodeStateSerializer::SimulationState;
   using ActorDynamicState = carla::sensor::data::ActorDynamicState;
 
+  check(bKeyframe || (SentActors != nullptr));
 
   const FActorRegistry &Registry = Episode.GetActorRegistry();
 
-  auto total_size = sizeof(Serializer::Header) + sizeof(ActorDynamicState) * Registry.Num();
+  // Compute the state of every actor.
+  TArray<ActorDynamicState> Actors;
+  Actors.Reserve(Registry.Num());
+  for (auto& It : Registry)
+  {
+    const FCarlaActor* View = It.Value.Get();
+    check(View);
+    Actors.Emplace(FWorldObserver_GetActorDynamicState(*View, Registry, DeltaSeconds));
+  }
+
+  TArray<carla::rpc::ActorId> DestroyedIds;
+  if (SentActors != nullptr)
+  {
+    if (bKeyframe)
+    {
+      SentActors->Reset();
+      for (const ActorDynamicState &Actor : Actors)
+      {
+        SentActors->Add(Actor.id, Actor);
+      }
+    }
+    else
+    {
+      // Keep only the actors created or changed since they were last sent.
+      int32 ChangedCount = 0;
+      for (const ActorDynamicState &Actor : Actors)
+      {
+        const ActorDynamicState *Sent = SentActors->Find(Actor.id);
+        if ((Sent == nullptr) || Serializer::HasChanged(*Sent, Actor))
+        {
+          SentActors->Add(Actor.id, Actor);
+          Actors[ChangedCount++] = Actor;
+        }
+      }
+      Actors.SetNum(ChangedCount);
+      for (auto It = SentActors->CreateIterator(); It; ++It)
+      {
+        if (Registry.FindCarlaActor(It.Key()) == nullptr)
+        {
+          DestroyedIds.Add(It.Key());
+          It.RemoveCurrent();
+        }
+      }
+    }
+  }
+
+  auto total_size = sizeof(Serializer::Header) + sizeof(ActorDynamicState) * Actors.Num();
+  if (!bKeyframe)
+  {
+    total_size += sizeof(Serializer::DeltaHeader) + sizeof(carla::rpc::ActorId) * DestroyedIds.Num();
+  }
   auto current_size = 0;
   // Set up buffer for writing.
   buffer.reset(total_size);
-  auto write_data = [&current_size, &buffer](const auto &data)
+  auto write_data = [&current_size, &buffer](const void *data, size_t size)
   {
     auto begin = buffer.begin() + current_size;
-    std::memcpy(begin, &data, sizeof(data));
-    current_size += sizeof(data);
+    std::memcpy(begin, data, size);
+    current_size += size;
   };
 
-  constexpr float TO_METERS = 1e-2;
-
   // Write header.
   Serializer::Header header;
   header.episode_id = Episode.GetId();
@@ -304,60 +403,24 @@ static carla::Buffer FWorldObserver_Serialize(
 
   uint8_t simulation_state = (SimulationState::MapChange * MapChange);
   simulation_state |= (SimulationState::PendingLightUpdate * PendingLightUpdates);
+  simulation_state |= (SimulationState::DeltaFrame * !bKeyframe);
 
   header.simulation_state = static_cast<SimulationState>(simulation_state);
 
-  write_data(header);
+  write_data(&header, sizeof(header));
 
-  // Write every actor.
-  for (auto& It : Registry)
+  // Write the base frame and the actors destroyed since.
+  if (!bKeyframe)
   {
-    const FCarlaActor* View = It.Value.Get();
-    const FActorInfo* ActorInfo = View->GetActorInfo();
-
-    FTransform ActorTransform;
-    FVector Velocity(0.0f);
-    carla::geom::Vector3D AngularVelocity(0.0f, 0.0f, 0.0f);
-    carla::geom::Vector3D Acceleration(0.0f, 0.0f, 0.0f);
-    carla::sensor::data::ActorDynamicState::TypeDependentState State{};
-
-
-    check(View);
-
-    if(View->IsDormant())
-    {
-      const FActorData* ActorData = View->GetActorData();
-      Velocity = TO_METERS * ActorData->Velocity;
-      AngularVelocity = carla::geom::Vector3D
-                        {ActorData->AngularVelocity.X,
-                         ActorData->AngularVelocity.Y,
-                         ActorData->AngularVelocity.Z};
-      Acceleration = FWorldObserver_GetAcceleration(*View, Velocity, DeltaSeconds);
-      State = FWorldObserver_GetDormantActorState(*View, Registry);
-    }
-    else
-    {
-      Velocity = TO_METERS * View->GetActor()->GetVelocity();
-      AngularVelocity = FWorldObserver_GetAngularVelocity(*View->GetActor());
-      Acceleration = FWorldObserver_GetAcceleration(*View, Velocity, DeltaSeconds);
-      State = FWorldObserver_GetActorState(*View, Registry);
-    }
-    ActorTransform = View->GetActorGlobalTransform();
-
-    ActorDynamicState info = {
-      View->GetActorId(),
-      View->GetActorState(),
-      carla::geom::Transform(ActorTransform),
-      carla::geom::Vector3D(Velocity.X, Velocity.Y, Velocity.Z),
-      AngularVelocity,
-      Acceleration,
-      State,
-    };
-    write_data(info);
+    Serializer::DeltaHeader delta_header;
+    delta_header.base_frame = BaseFrame;
+    delta_header.destroyed_count = DestroyedIds.Num();
+    write_data(&delta_header, sizeof(delta_header));
+    write_data(DestroyedIds.GetData(), sizeof(carla::rpc::ActorId) * DestroyedIds.Num());
   }
 
-  // Shrink buffer
-  buffer.resize(current_size);
+  // Write every actor.
+  write_data(Actors.GetData(), sizeof(ActorDynamicState) * Actors.Num());
 
   check(buffer.size() == current_size);
 
@@ -375,6 +438,23 @@ void FWorldObserver::BroadcastTick(
   if (!Stream.IsStreamReady())
     return;
 
+  using Serializer = carla::sensor::s11n::EpisodeStateSerializer;
+
+  const bool bDeltaEnabled = Episode.GetSettings().bDeltaEpisodeState;
+  const uint64_t Frame = FCarlaEngine::GetFrameCounter();
+  const size_t ConnectionCount = Stream.GetConnectionCount();
+
+  // Clients that just subscribed, changed map or missed a frame need the
+  // whole state.
+  const bool bKeyframe =
+      !bDeltaEnabled ||
+      !bHasSentDeltaBase ||
+      bKeyframeRequested ||
+      MapChange ||
+      (Episode.GetId() != SentEpisodeId) ||
+      (ConnectionCount != SentConnectionCount) ||
+      (FramesSinceKeyframe + 1u >= Serializer::KEYFRAME_INTERVAL);
+
   auto AsyncStream = Stream.MakeAsyncDataStream(*this, Episode.GetElapsedGameTime());
 
   carla::Buffer buffer = FWorldObserver_Serialize(
@@ -382,7 +462,25 @@ void FWorldObserver::BroadcastTick(
       Episode,
       DeltaSecond,
       MapChange,
-      PendingLightUpdates);
+      PendingLightUpdates,
+      bDeltaEnabled ? &SentActors : nullptr,
+      bKeyframe,
+      SentFrame);
+
+  if (bDeltaEnabled)
+  {
+    bHasSentDeltaBase = true;
+    SentEpisodeId = Episode.GetId();
+    SentFrame = Frame;
+    SentConnectionCount = ConnectionCount;
+    FramesSinceKeyframe = bKeyframe ? 0u : FramesSinceKeyframe + 1u;
+  }
+  else if (bHasSentDeltaBase)
+  {
+    SentActors.Empty();
+    bHasSentDeltaBase = false;
+  }
+  bKeyframeRequested = false;
 
   AsyncStream.SerializeAndSend(*this, std::move(buffer));
 }
@@ -8,6 +8,10 @@
 
 #include "Carla/Sensor/DataStream.h"
 
+#include <compiler/disable-ue4-macros.h>
+#include <carla/sensor/data/ActorDynamicState.h>
+#include <compiler/enable-ue4-macros.h>
+
 class UCarlaEpisode;
 
 /// Serializes and sends all the actors in the current UCarlaEpisode.
@@ -38,6 +42,13 @@ public:
     bool MapChange,
     bool PendingLightUpdate);
 
+  /// Send the whole state in the next tick, for a client that missed a frame
+  /// of the delta encoded state.
+  void RequestKeyframe()
+  {
+    bKeyframeRequested = true;
+  }
+
   /// Dummy. Required for compatibility with other sensors only.
   FTransform GetActorTransform() const
   {
@@ -47,4 +58,20 @@ public:
 private:
 
   FDataMultiStream Stream;
+
+  /// State of the actors as last sent, the base of the next delta frame when
+  /// the episode state is delta encoded.
+  TMap<carla::rpc::ActorId, carla::sensor::data::ActorDynamicState> SentActors;
+
+  bool bHasSentDeltaBase = false;
+
+  bool bKeyframeRequested = false;
+
+  uint64_t SentEpisodeId = 0u;
+
+  uint64_t SentFrame = 0u;
+
+  uint64_t FramesSinceKeyframe = 0u;
+
+  size_t SentConnectionCount = 0u;
 };
@@ -33,8 +33,11 @@
 #include "CarlaServerResponse.h"
 #include "Carla/Util/BoundingBoxCalculator.h"
 #include "Misc/FileHelper.h"
+#include "HAL/PlatformFilemanager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
 
 #include <compiler/disable-ue4-macros.h>
+#include <carla/Fnv1aHash.h>
 #include <carla/Functional.h>
 #include <carla/multigpu/router.h>
 #include <carla/Version.h>
@@ -49,6 +52,7 @@
 #include <carla/rpc/EnvironmentObject.h>
 #include <carla/rpc/EpisodeInfo.h>
 #include <carla/rpc/EpisodeSettings.h>
+#include <carla/rpc/FileInfo.h>
 #include <carla/rpc/LabelledPoint.h>
 #include <carla/rpc/LightState.h>
 #include <carla/rpc/MapInfo.h>
@@ -76,6 +80,7 @@
 #include <carla/rpc/MaterialParameter.h>
 #include <compiler/enable-ue4-macros.h>
 
+#include <algorithm>
 #include <vector>
 #include <atomic>
 #include <map>
@@ -132,6 +137,24 @@ public:
 
   std::atomic_size_t TickCuesReceived { 0u };
 
+  /// Whether a client missed a frame of the delta encoded episode state and
+  /// needs a keyframe.
+  std::atomic_bool EpisodeKeyframeRequested { false };
+
+  /// Content hash of a file transferred, valid while the size and the
+  /// modification time of the file do not change.
+  struct FFileHash
+  {
+    uint64_t Size;
+    FDateTime TimeStamp;
+    uint64_t Hash;
+  };
+
+  /// Hashes of the files transferred, keyed by full path.
+  TMap<FString, FFileHash> FileHashes;
+
+  FCriticalSection FileHashesMutex;
+
 private:
 
   void BindActions();
@@ -278,6 +301,12 @@ void FCarlaServer::FPimpl::BindActions()
     return Current + 1;
   };
 
+  BIND_ASYNC(request_episode_keyframe) << [this]() -> R<void>
+  {
+    EpisodeKeyframeRequested.store(true, std::memory_order_release);
+    return R<void>::Success();
+  };
+
   // ~~ Load new episode ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
   BIND_ASYNC(get_available_maps) << [this]() -> R<std::vector<std::string>>
@@ -537,6 +566,88 @@ void FCarlaServer::FPimpl::BindActions()
     return Result;
   };
 
+  // The file transfer calls only read the content folder, they run in the RPC
+  // threads so large files do not block the game thread.
+
+  BIND_ASYNC(get_file_info) << [this](std::string name) -> R<cr::FileInfo>
+  {
+    if (name.find("..") != std::string::npos)
+    {
+      RESPOND_ERROR("invalid file name");
+    }
+    FString path(FPaths::ConvertRelativePathToFull(FPaths::ProjectContentDir()));
+    path.Append(name.c_str());
+    IPlatformFile &PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    TUniquePtr<IFileHandle> File(PlatformFile.OpenRead(*path));
+    if (!File)
+    {
+      RESPOND_ERROR("unable to open file");
+    }
+
+    cr::FileInfo Info;
+    Info.size = static_cast<uint64_t>(File->Size());
+    const FDateTime TimeStamp = PlatformFile.GetTimeStamp(*path);
+    {
+      // Every client asks for the same files, hash them only when they change.
+      FScopeLock Lock(&FileHashesMutex);
+      const FFileHash *Cached = FileHashes.Find(path);
+      if (Cached != nullptr && Cached->Size == Info.size && Cached->TimeStamp == TimeStamp)
+      {
+        Info.hash = Cached->Hash;
+        return Info;
+      }
+    }
+
+    carla::Fnv1aHash Hash;
+    std::vector<uint8_t> Buffer(1u << 20u);
+    for (uint64_t Remaining = Info.size; Remaining > 0u;)
+    {
+      const auto Size = std::min<uint64_t>(Buffer.size(), Remaining);
+      if (!File->Read(Buffer.data(), static_cast<int64>(Size)))
+      {
+        RESPOND_ERROR("unable to read file");
+      }
+      Hash.Update(Buffer.data(), Size);
+      Remaining -= Size;
+    }
+    Info.hash = Hash.Get();
+    {
+      FScopeLock Lock(&FileHashesMutex);
+      FileHashes.Add(path, FFileHash{Info.size, TimeStamp, Info.hash});
+    }
+    return Info;
+  };
+
+  BIND_ASYNC(request_file_chunk) << [](std::string name, uint64_t offset, uint32_t size) -> R<std::vector<uint8_t>>
+  {
+    constexpr uint32_t MaxChunkSize = 16u << 20u;
+    if (name.find("..") != std::string::npos)
+    {
+      RESPOND_ERROR("invalid file name");
+    }
+    FString path(FPaths::ConvertRelativePathToFull(FPaths::ProjectContentDir()));
+    path.Append(name.c_str());
+    TUniquePtr<IFileHandle> File(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*path));
+    if (!File)
+    {
+      RESPOND_ERROR("unable to open file");
+    }
+    const auto FileSize = static_cast<uint64_t>(File->Size());
+    if (offset > FileSize)
+    {
+      RESPOND_ERROR("offset out of range");
+    }
+
+    std::vector<uint8_t> Result(std::min<uint64_t>({size, MaxChunkSize, FileSize - offset}));
+    if (!Result.empty() &&
+        (!File->Seek(static_cast<int64>(offset)) ||
+         !File->Read(Result.data(), static_cast<int64>(Result.size()))))
+    {
+      RESPOND_ERROR("unable to read file");
+    }
+    return Result;
+  };
+
   BIND_SYNC(get_episode_settings) << [this]() -> R<cr::EpisodeSettings>
   {
     REQUIRE_CARLA_EPISODE();
@@ -3129,6 +3240,34 @@ void FCarlaServer::AsyncRun(uint32 NumberOfWorkerThreads)
   UE_LOG(LogCarla, Log, TEXT("FCarlaServer AsyncRun %d, RPCThreads %d, StreamingThreads %d, SecondaryThreads %d"),
         NumberOfWorkerThreads, RPCThreads, StreamingThreads, SecondaryThreads);
 
+  // Flow control of the streaming sessions.
+  int32_t StreamingQueueSize;
+  if(FParse::Value(FCommandLine::Get(), TEXT("-StreamingQueueSize="), StreamingQueueSize) && StreamingQueueSize > 0)
+  {
+    Pimpl->StreamingServer.SetSendQueueSize(StreamingQueueSize);
+  }
+  FString StreamingDropPolicy;
+  if(FParse::Value(FCommandLine::Get(), TEXT("-StreamingDropPolicy="), StreamingDropPolicy))
+  {
+    using DropPolicy = carla::streaming::detail::DropPolicy;
+    if(StreamingDropPolicy == TEXT("oldest"))
+    {
+      Pimpl->StreamingServer.SetDropPolicy(DropPolicy::DropOldest);
+    }
+    else if(StreamingDropPolicy == TEXT("newest"))
+    {
+      Pimpl->StreamingServer.SetDropPolicy(DropPolicy::DropNewest);
+    }
+    else if(StreamingDropPolicy == TEXT("block"))
+    {
+      Pimpl->StreamingServer.SetDropPolicy(DropPolicy::Block);
+    }
+    else
+    {
+      UE_LOG(LogCarla, Warning, TEXT("Unknown streaming drop policy '%s', expected oldest, newest or block"), *StreamingDropPolicy);
+    }
+  }
+
   Pimpl->Server.AsyncRun(RPCThreads);
   Pimpl->StreamingServer.AsyncRun(StreamingThreads);
   Pimpl->SecondaryServer->AsyncRun(SecondaryThreads);
@@ -3154,6 +3293,11 @@ bool FCarlaServer::TickCueReceived()
   return flag;
 }
 
+bool FCarlaServer::TakeEpisodeKeyframeRequest()
+{
+  return Pimpl->EpisodeKeyframeRequested.exchange(false, std::memory_order_acq_rel);
+}
+
 void FCarlaServer::Stop()
 {
   if (Pimpl)
@@ -40,6 +40,10 @@ public:
   
   bool TickCueReceived();
 
+  /// Return whether a client requested a keyframe of the episode state since
+  /// the last call.
+  bool TakeEpisodeKeyframeRequest();
+
   void Stop();
 
   FDataStream OpenStream() const;
@@ -39,4 +39,7 @@ struct CARLA_API FEpisodeSettings
 
   bool SpectatorAsEgo = true;
 
+  UPROPERTY(EditAnywhere, BlueprintReadWrite)
+  bool bDeltaEpisodeState = false;
+
 };
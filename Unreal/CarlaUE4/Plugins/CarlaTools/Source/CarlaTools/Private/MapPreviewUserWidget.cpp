@@ -31,14 +31,41 @@
 #include "Containers/UnrealString.h"
 #include "Misc/Paths.h"
 
+#include <array>
+#include <cstring>
+
 
 namespace Asio = boost::asio;
-using AsioStreamBuf = boost::asio::streambuf;
 using AsioTCP = boost::asio::ip::tcp;
 using AsioSocket = boost::asio::ip::tcp::socket;
 using AsioAcceptor = boost::asio::ip::tcp::acceptor;
 using AsioEndpoint = boost::asio::ip::tcp::endpoint;
 
+// Binary protocol of the osm renderer, see
+// osm-world-renderer/OsmRenderer/include/OsmRendererProtocol.h. Every message
+// is a uint32 with the size of the payload followed by the payload.
+static constexpr uint8 CMD_CONFIG = 'C';
+static constexpr uint8 CMD_RENDER = 'R';
+static constexpr uint8 CMD_LATLON = 'L';
+static constexpr uint8 CMD_EXIT = 'X';
+static constexpr uint8 STATUS_OK = 0;
+// Top right lat, lon and bottom left lat, lon.
+static constexpr std::size_t CORNERS_SIZE = 4u * sizeof(double);
+
+template <typename T>
+static void AppendValue(std::vector<uint8>& Payload, const T& Value)
+{
+  const uint8* Begin = reinterpret_cast<const uint8*>(&Value);
+  Payload.insert(Payload.end(), Begin, Begin + sizeof(T));
+}
+
+static void AppendString(std::vector<uint8>& Payload, const FString& Value)
+{
+  const std::string Str = std::string(TCHAR_TO_UTF8(*Value));
+  AppendValue(Payload, static_cast<uint32>(Str.size()));
+  Payload.insert(Payload.end(), Str.begin(), Str.end());
+}
+
 void UMapPreviewUserWidget::CreateTexture()
 {
   if(!MapTexture)
@@ -60,8 +87,19 @@ void UMapPreviewUserWidget::ConnectToSocket(FString DatabasePath, FString Styles
   }
 
   // Send a message
-  FString Message = "-C " + DatabasePath + " " + StylesheetPath + " " + FString::FromInt(Size);
-  if( !SendStr(Message) ){
+  std::vector<uint8> Request;
+  Request.push_back(CMD_CONFIG);
+  AppendValue(Request, static_cast<uint32>(Size));
+  AppendString(Request, DatabasePath);
+  AppendString(Request, StylesheetPath);
+
+  std::vector<uint8> Response;
+  if( !SendRequest(Request) || !RecvResponse(Response) ){
+    return;
+  }
+  if(Response[0] != STATUS_OK)
+  {
+    UE_LOG(LogTemp, Error, TEXT("Error configuring the osm renderer"));
     return;
   }
   UE_LOG(LogTemp, Log, TEXT("Configuration Completed"));
@@ -69,71 +107,88 @@ void UMapPreviewUserWidget::ConnectToSocket(FString DatabasePath, FString Styles
 
 void UMapPreviewUserWidget::RenderMap(FString Latitude, FString Longitude, FString Zoom)
 {
-  FString Message = "-R " + Latitude + " " + Longitude + " " + Zoom;
-  if( !SendStr(Message) ){
-    UE_LOG(LogTemp, Log, TEXT("Send Str failed"));
+  std::vector<uint8> Request;
+  Request.push_back(CMD_RENDER);
+  AppendValue(Request, FCString::Atod(*Latitude));
+  AppendValue(Request, FCString::Atod(*Longitude));
+  AppendValue(Request, FCString::Atod(*Zoom));
+
+  std::vector<uint8> Response;
+  if( !SendRequest(Request) || !RecvResponse(Response) ){
+    UE_LOG(LogTemp, Log, TEXT("Render request failed"));
     return;
   }
 
-  TArray<uint8_t> ReceivedData;
-  uint32 ReceivedDataSize = 0;
+  // Status, corners, image size and the pixels.
+  const std::size_t HeaderSize = 1u + CORNERS_SIZE + sizeof(uint32);
+  if(Response[0] != STATUS_OK || Response.size() < HeaderSize)
+  {
+    UE_LOG(LogTemp, Error, TEXT("The osm renderer could not render the map"));
+    return;
+  }
+  SetCornersLatLonCoords(Response.data() + 1);
+
+  uint32 ImageSize = 0;
+  std::memcpy(&ImageSize, Response.data() + 1 + CORNERS_SIZE, sizeof(uint32));
+  UE_LOG(LogTemp, Log, TEXT("Size of Data: %d"), static_cast<int32>(Response.size() - HeaderSize));
 
+  const std::size_t PixelsSize = static_cast<std::size_t>(ImageSize) * ImageSize * 4u;
+  if(Response.size() - HeaderSize != PixelsSize ||
+     static_cast<int32>(ImageSize) != MapTexture->GetSizeX() ||
+     static_cast<int32>(ImageSize) != MapTexture->GetSizeY())
   {
-    SocketPtr->wait(boost::asio::ip::tcp::socket::wait_read);
-    while (SocketPtr->available())
-    {
-      AsioStreamBuf Buffer;
-      std::size_t BytesReceived =
-        Asio::read(*SocketPtr, Buffer, Asio::transfer_at_least(2));
-      TArray<uint8_t> ThisReceivedData;
-      const char* DataPtr = Asio::buffer_cast<const char*>(Buffer.data());
-      for (std::size_t i = 0; i < Buffer.size(); ++i)
-      {
-        ThisReceivedData.Add(DataPtr[i]);
-      }
-      ReceivedData.Append(ThisReceivedData);
-    }
-    UE_LOG(LogTemp, Log, TEXT("Size of Data: %d"), ReceivedData.Num());
+    UE_LOG(LogTemp, Error, TEXT("Received map of size %d does not match the texture"), ImageSize);
+    return;
+  }
 
-    // TODO: Move to function
-    if(ReceivedData.Num() > 0)
+  // TODO: Move to function
+  TArray<uint8> NewData;
+  NewData.Append(Response.data() + HeaderSize, PixelsSize);
+  ENQUEUE_RENDER_COMMAND(UpdateDynamicTextureCode)
+  (
+    [NewData=MoveTemp(NewData), Texture=MapTexture](auto &InRHICmdList) mutable
     {
-      ENQUEUE_RENDER_COMMAND(UpdateDynamicTextureCode)
-      (
-        [NewData=ReceivedData, Texture=MapTexture](auto &InRHICmdList) mutable
-        {
-          UE_LOG(LogTemp, Log, TEXT("RHI: Updating texture"));
-          FUpdateTextureRegion2D Region;
-          Region.SrcX = 0;
-          Region.SrcY = 0;
-          Region.DestX = 0;
-          Region.DestY = 0;
-          Region.Width = Texture->GetSizeX();
-          Region.Height = Texture->GetSizeY();
-
-          FTexture2DResource* Resource = (FTexture2DResource*)Texture->Resource;
-          RHIUpdateTexture2D(Resource->GetTexture2DRHI(), 0, Region, Region.Width * sizeof(uint8_t) * 4, &NewData[0]);
-        }
-      );
+      UE_LOG(LogTemp, Log, TEXT("RHI: Updating texture"));
+      FUpdateTextureRegion2D Region;
+      Region.SrcX = 0;
+      Region.SrcY = 0;
+      Region.DestX = 0;
+      Region.DestY = 0;
+      Region.Width = Texture->GetSizeX();
+      Region.Height = Texture->GetSizeY();
+
+      FTexture2DResource* Resource = (FTexture2DResource*)Texture->Resource;
+      RHIUpdateTexture2D(Resource->GetTexture2DRHI(), 0, Region, Region.Width * sizeof(uint8_t) * 4, &NewData[0]);
     }
-  }
+  );
 }
 
-FString UMapPreviewUserWidget::RecvCornersLatLonCoords()
+bool UMapPreviewUserWidget::RecvCornersLatLonCoords()
 {
-  if( !SendStr("-L") ){
-    UE_LOG(LogTemp, Error, TEXT("Error sending message: num bytes mismatch"));
-    return FString();
+  std::vector<uint8> Request{CMD_LATLON};
+  std::vector<uint8> Response;
+  if( !SendRequest(Request) || !RecvResponse(Response) ){
+    return false;
+  }
+  if(Response[0] != STATUS_OK || Response.size() < 1u + CORNERS_SIZE)
+  {
+    UE_LOG(LogTemp, Error, TEXT("Invalid lat lon response"));
+    return false;
   }
+  SetCornersLatLonCoords(Response.data() + 1);
+  return true;
+}
 
-  AsioStreamBuf Buffer;
-  std::size_t BytesReceived =
-      Asio::read(*SocketPtr, Buffer, Asio::transfer_at_least(2));
-  std::string BytesStr = Asio::buffer_cast<const char*>(Buffer.data());
+void UMapPreviewUserWidget::SetCornersLatLonCoords(const uint8* Corners)
+{
+  double Coords[4];
+  std::memcpy(Coords, Corners, CORNERS_SIZE);
+  UE_LOG(LogTemp, Log, TEXT("Received Coords %f %f %f %f"), Coords[0], Coords[1], Coords[2], Coords[3]);
 
-  FString CoordStr = FString(BytesStr.size(), UTF8_TO_TCHAR(BytesStr.c_str()));
-  UE_LOG(LogTemp, Log, TEXT("Received Coords %s"), *CoordStr);
-  return CoordStr;
+  TopRightLat = Coords[0];
+  TopRightLon = Coords[1];
+  BottomLeftLat = Coords[2];
+  BottomLeftLon = Coords[3];
 }
 
 void UMapPreviewUserWidget::Shutdown()
@@ -149,13 +204,14 @@ void UMapPreviewUserWidget::OpenServer()
 
 void UMapPreviewUserWidget::CloseServer()
 {
-  if( !SendStr("-X") ){
+  std::vector<uint8> Request{CMD_EXIT};
+  if( !SendRequest(Request) ){
     UE_LOG(LogTemp, Error, TEXT("Error sending message"));
     return;
   }
 }
 
-bool UMapPreviewUserWidget::SendStr(FString Msg)
+bool UMapPreviewUserWidget::SendRequest(const std::vector<uint8>& Payload)
 {
   if(!SocketPtr)
   {
@@ -163,18 +219,21 @@ bool UMapPreviewUserWidget::SendStr(FString Msg)
     return false;
   }
 
-  std::string MessageStr = std::string(TCHAR_TO_UTF8(*Msg));
+  const uint32 PayloadSize = static_cast<uint32>(Payload.size());
+  const std::array<Asio::const_buffer, 2> Buffers{
+      Asio::buffer(&PayloadSize, sizeof(PayloadSize)),
+      Asio::buffer(Payload)};
   std::size_t BytesSent = 0;
   try
   {
-    BytesSent = Asio::write(*SocketPtr, Asio::buffer(MessageStr));
+    BytesSent = Asio::write(*SocketPtr, Buffers);
   }
   catch (const boost::system::system_error& e)
   {
     FString ErrorMessage = e.what();
     UE_LOG(LogTemp, Error, TEXT("Error sending message: %s"), *ErrorMessage);
   }
-  if (BytesSent != MessageStr.size())
+  if (BytesSent != sizeof(PayloadSize) + Payload.size())
   {
     UE_LOG(LogTemp, Error, TEXT("Error sending message: num bytes mismatch"));
     return false;
@@ -186,23 +245,40 @@ bool UMapPreviewUserWidget::SendStr(FString Msg)
   }
 }
 
+bool UMapPreviewUserWidget::RecvResponse(std::vector<uint8>& OutPayload)
+{
+  if(!SocketPtr)
+  {
+    UE_LOG(LogTemp, Error, TEXT("Error. No socket."));
+    return false;
+  }
+
+  try
+  {
+    uint32 PayloadSize = 0;
+    Asio::read(*SocketPtr, Asio::buffer(&PayloadSize, sizeof(PayloadSize)));
+    if(PayloadSize == 0)
+    {
+      UE_LOG(LogTemp, Error, TEXT("Error receiving message: empty response"));
+      return false;
+    }
+    OutPayload.resize(PayloadSize);
+    Asio::read(*SocketPtr, Asio::buffer(OutPayload));
+  }
+  catch (const boost::system::system_error& e)
+  {
+    FString ErrorMessage = e.what();
+    UE_LOG(LogTemp, Error, TEXT("Error receiving message: %s"), *ErrorMessage);
+    return false;
+  }
+  return true;
+}
+
 void UMapPreviewUserWidget::UpdateLatLonCoordProperties()
 {
-  FString CoordStr = RecvCornersLatLonCoords();
-  if(CoordStr.Len() == 0)
+  if(!RecvCornersLatLonCoords())
   {
     UE_LOG(LogTemp, Error, TEXT("Error during update of lat lon coord properties. Check osm server connection or use OSMURL to generate map") );
     return;
   }
-  UE_LOG(LogTemp, Log, TEXT("Received laton [%s] with size %d"), *CoordStr, CoordStr.Len());
-
-  TArray<FString> CoordsArray;
-  CoordStr.ParseIntoArray(CoordsArray, TEXT("&"), true);
-
-  ensure(CoordsArray.Num() == 4);
-
-  TopRightLat = FCString::Atof(*CoordsArray[0]);
-  TopRightLon = FCString::Atof(*CoordsArray[1]);
-  BottomLeftLat = FCString::Atof(*CoordsArray[2]);
-  BottomLeftLon = FCString::Atof(*CoordsArray[3]);
 }
@@ -9,6 +9,7 @@ THIRD_PARTY_INCLUDES_START
 #include <boost/asio.hpp>
 THIRD_PARTY_INCLUDES_END
 #include <memory>
+#include <vector>
 
 #include "MapPreviewUserWidget.generated.h"
 
@@ -26,8 +27,10 @@ private:
   std::unique_ptr<boost::asio::ip::tcp::socket> SocketPtr;
 
 
-	bool SendStr(FString Msg);
-	FString RecvCornersLatLonCoords();
+	bool SendRequest(const std::vector<uint8>& Payload);
+	bool RecvResponse(std::vector<uint8>& OutPayload);
+	bool RecvCornersLatLonCoords();
+	void SetCornersLatLonCoords(const uint8* Corners);
 
 public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
@@ -29,6 +29,9 @@ public:
     osmscout::GeoCoord GetBottomLeftCoord();
     osmscout::GeoCoord GetTopRightCoord();
 
+    // Degrees of longitude covered by an image of the given size and zoom.
+    static double GetLonSpan(double ZoomValue, int ImgSize);
+
 private:
     // Rastering
     std::unique_ptr<MapRasterizer> Rasterizer;
@@ -1,15 +1,14 @@
 #ifndef MAP_RASTERIZER_H
 #define MAP_RASTERIZER_H
 
+#include <cstdint>
 #include <string>
 
 class MapRasterizer
 {
 public:
-    void RasterizeSVG(std::uint8_t* OutMap, std::string SvgString, int Size);
-
-private:
-    int BackgroundColor = 0x00000000;
+    // Renders straight into OutMap, Size * Size RGBA pixels.
+    void RasterizeSVG(std::uint8_t* OutMap, const std::string& SvgString, int Size);
 };
 
 #endif
\ No newline at end of file
@@ -4,9 +4,8 @@
 #include <boost/asio.hpp>
 
 #include <string>
-#include <vector>
 #include <memory>
-#include "MapDrawer.h"
+#include "TileRenderer.h"
 
 
 class OsmRenderer 
@@ -15,29 +14,21 @@ private:
   // Boost socket
   boost::asio::io_service io_service;
   std::unique_ptr<boost::asio::ip::tcp::acceptor> SocketAcceptorPtr;
-  std::unique_ptr<boost::asio::ip::tcp::socket> SocketPtr;
 
+  // Renders and caches the tiles requested by every client
+  std::unique_ptr<TileRenderer> Renderer;
 
-  // Map Drawer
-  std::unique_ptr<MapDrawer> Drawer;
-
-  void RunCmd(std::string Cmd);
-
-  std::vector<std::string> SplitCmd (std::string s, std::string delimiter);
-
-  // Command Handlers
-  void RenderMapCmd(std::vector<std::string> CmdArgs, uint8_t* OutMap);
-  void ConfigMapCmd(std::vector<std::string> CmdArgs);
-  void SendLatLonCmd(std::vector<std::string> CmdArgs);
-
+  void AcceptClient();
 
 public:
   std::string GetOsmRendererString() const;
 
   void InitRenderer();
+
+  // Serves clients until one of them sends the exit command.
   void StartLoop();
 
   void ShutDown();
 };
 
-#endif
\ No newline at end of file
+#endif
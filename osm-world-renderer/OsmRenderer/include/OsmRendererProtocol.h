@@ -0,0 +1,98 @@
+#ifndef OSM_RENDERER_PROTOCOL_H
+#define OSM_RENDERER_PROTOCOL_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Binary protocol between the renderer and its clients.
+//
+// Every message, in both directions, is a uint32 with the size of the payload
+// followed by the payload. Values are in the byte order of the host, the
+// renderer and its clients run on the same machine.
+//
+// Requests start with a Command:
+//   Config: uint32 image size, string database path, string stylesheet path
+//   Render: double latitude, double longitude, double zoom
+//   LatLon: nothing
+//   Exit:   nothing
+// where strings are a uint32 length followed by the characters.
+//
+// Responses start with a Status:
+//   Config: nothing
+//   Render: TileCorners, uint32 image size, size * size RGBA pixels
+//   LatLon: TileCorners of the last image rendered for this client
+//   Exit:   no response, the renderer closes
+namespace OsmRendererProtocol
+{
+  enum class Command : std::uint8_t
+  {
+    Config = 'C',
+    Render = 'R',
+    LatLon = 'L',
+    Exit = 'X'
+  };
+
+  enum class Status : std::uint8_t
+  {
+    Ok = 0,
+    Error = 1
+  };
+
+  struct TileCorners
+  {
+    double TopRightLat = 0.0;
+    double TopRightLon = 0.0;
+    double BottomLeftLat = 0.0;
+    double BottomLeftLon = 0.0;
+  };
+
+  // Requests are small, anything bigger is a broken client.
+  constexpr std::uint32_t MAX_REQUEST_SIZE = 64u * 1024u;
+
+  // Reads the values of a request payload in order.
+  class PayloadReader
+  {
+  public:
+    PayloadReader(const std::vector<std::uint8_t>& InPayload)
+      : Payload(InPayload) {}
+
+    template <typename T>
+    bool Read(T& Value)
+    {
+      if(Payload.size() - Offset < sizeof(T))
+      {
+        return false;
+      }
+      std::memcpy(&Value, Payload.data() + Offset, sizeof(T));
+      Offset += sizeof(T);
+      return true;
+    }
+
+    bool Read(std::string& Value)
+    {
+      std::uint32_t Length = 0;
+      if(!Read(Length) || Payload.size() - Offset < Length)
+      {
+        return false;
+      }
+      Value.assign(reinterpret_cast<const char*>(Payload.data() + Offset), Length);
+      Offset += Length;
+      return true;
+    }
+
+  private:
+    const std::vector<std::uint8_t>& Payload;
+    std::size_t Offset = 0;
+  };
+
+  template <typename T>
+  void Write(std::vector<std::uint8_t>& Payload, const T& Value)
+  {
+    const auto* Begin = reinterpret_cast<const std::uint8_t*>(&Value);
+    Payload.insert(Payload.end(), Begin, Begin + sizeof(T));
+  }
+}
+
+#endif
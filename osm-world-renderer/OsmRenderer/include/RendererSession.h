@@ -0,0 +1,58 @@
+#ifndef RENDERER_SESSION_H
+#define RENDERER_SESSION_H
+
+#include "OsmRendererProtocol.h"
+#include "TileCache.h"
+
+#include <boost/asio.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class TileRenderer;
+
+// Connection with a single client. Requests are read asynchronously and
+// answered one at a time, in order; tiles are rendered by the TileRenderer
+// while the io_service keeps serving the other clients.
+class RendererSession : public std::enable_shared_from_this<RendererSession>
+{
+public:
+  RendererSession(
+      boost::asio::ip::tcp::socket InSocket,
+      TileRenderer& InRenderer,
+      std::function<void()> InOnExit);
+
+  void Start();
+
+private:
+  void ReadHeader();
+  void ReadPayload();
+  void HandleRequest();
+
+  void HandleConfig(OsmRendererProtocol::PayloadReader& Reader);
+  void HandleRender(OsmRendererProtocol::PayloadReader& Reader);
+  void HandleLatLon();
+
+  // Sends Status and Body, followed by the pixels of ResponseTile if any.
+  void SendResponse(OsmRendererProtocol::Status ResponseStatus, const std::vector<std::uint8_t>& Body);
+
+  void SendTile(TileRef RenderedTile, std::chrono::steady_clock::time_point RequestTime);
+
+  boost::asio::ip::tcp::socket Socket;
+  TileRenderer& Renderer;
+  std::function<void()> OnExit;
+
+  std::uint32_t RequestSize = 0;
+  std::vector<std::uint8_t> Request;
+
+  std::vector<std::uint8_t> ResponseHeader;
+  // Kept alive until its pixels are sent.
+  TileRef ResponseTile;
+
+  OsmRendererProtocol::TileCorners LastCorners;
+};
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef TILE_CACHE_H
+#define TILE_CACHE_H
+
+#include "OsmRendererProtocol.h"
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Position of a tile in the grid of a zoom level. The grid is square in
+// Mercator coordinates, so panning the same distance in any direction moves
+// the same number of cells.
+struct TileKey
+{
+  std::int64_t X = 0;
+  std::int64_t Y = 0;
+  // Zoom in thousandths.
+  std::int64_t Zoom = 0;
+  // Configuration the tile was rendered with.
+  std::uint64_t Generation = 0;
+
+  bool operator==(const TileKey& Other) const
+  {
+    return X == Other.X && Y == Other.Y && Zoom == Other.Zoom && Generation == Other.Generation;
+  }
+};
+
+struct TileKeyHash
+{
+  std::size_t operator()(const TileKey& Key) const
+  {
+    std::size_t Seed = std::hash<std::int64_t>()(Key.X);
+    auto Combine = [&Seed](std::size_t Value)
+    {
+      Seed ^= Value + 0x9e3779b9 + (Seed << 6) + (Seed >> 2);
+    };
+    Combine(std::hash<std::int64_t>()(Key.Y));
+    Combine(std::hash<std::int64_t>()(Key.Zoom));
+    Combine(std::hash<std::uint64_t>()(Key.Generation));
+    return Seed;
+  }
+};
+
+struct Tile
+{
+  OsmRendererProtocol::TileCorners Corners;
+  std::uint32_t Size = 0;
+  // Size * Size RGBA pixels.
+  std::vector<std::uint8_t> Pixels;
+};
+
+using TileRef = std::shared_ptr<const Tile>;
+
+// Least recently used rasterized tiles. Thread-safe.
+class TileCache
+{
+public:
+  explicit TileCache(std::size_t InMaxTiles);
+
+  // Returns nullptr if the tile is not cached.
+  TileRef Find(const TileKey& Key);
+
+  // Does not count as a use of the tile.
+  bool Contains(const TileKey& Key) const;
+
+  void Insert(const TileKey& Key, TileRef NewTile);
+
+  void Clear();
+
+  std::uint64_t GetHits() const;
+  std::uint64_t GetMisses() const;
+
+private:
+  using EntryList = std::list<std::pair<TileKey, TileRef>>;
+
+  mutable std::mutex Mutex;
+  const std::size_t MaxTiles;
+  // Most recently used first.
+  EntryList Entries;
+  std::unordered_map<TileKey, EntryList::iterator, TileKeyHash> Index;
+  std::uint64_t Hits = 0;
+  std::uint64_t Misses = 0;
+};
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef TILE_RENDERER_H
+#define TILE_RENDERER_H
+
+#include "TileCache.h"
+
+#include <osmscout/GeoCoord.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Renders map tiles in a pool of worker threads, each with its own MapDrawer,
+// and keeps the last ones in a TileCache.
+//
+// Requested coordinates are snapped to a grid of GRID_CELLS_PER_TILE cells per
+// tile width, so panning around the same area reuses the tiles already
+// rendered. After each request the neighbouring cells are prefetched with a
+// lower priority than the tiles clients are waiting for.
+class TileRenderer
+{
+public:
+  using TileCallback = std::function<void(TileRef)>;
+
+  // Renders the tile of Key centred in Center. Called from the worker threads,
+  // may throw.
+  using RenderFunction = std::function<TileRef(const TileKey& Key, const osmscout::GeoCoord& Center)>;
+
+  static constexpr int GRID_CELLS_PER_TILE = 4;
+
+  TileRenderer(std::size_t NumWorkers, std::size_t MaxCachedTiles);
+
+  // Renders the tiles with Render instead of a MapDrawer.
+  TileRenderer(std::size_t NumWorkers, std::size_t MaxCachedTiles, RenderFunction Render);
+
+  ~TileRenderer();
+
+  // Discards the cached tiles, the workers load the new database and
+  // stylesheet before rendering the next tile.
+  void Configure(const std::string& DataBasePath, const std::string& StyleSheetPath, int Size);
+
+  bool IsConfigured() const;
+
+  // Calls OnTile with the tile closest to the given coordinates, right away if
+  // it is cached, otherwise from a worker thread when it is rendered. OnTile
+  // receives nullptr if the tile could not be rendered.
+  void RequestTile(double Lat, double Lon, double ZoomValue, TileCallback OnTile);
+
+  // Tiles queued or being rendered.
+  std::size_t GetNumberOfPendingTiles() const;
+
+  const TileCache& GetCache() const
+  {
+    return Cache;
+  }
+
+private:
+  struct Config
+  {
+    std::string DataBasePath;
+    std::string StyleSheetPath;
+    int Size = 0;
+    std::uint64_t Generation = 0;
+  };
+
+  struct PendingTile
+  {
+    bool Interactive = false;
+    bool Rendering = false;
+    std::vector<TileCallback> Callbacks;
+  };
+
+  static double GetGridStep(double ZoomValue, int Size);
+
+  TileKey MakeKey(double Lat, double Lon, double ZoomValue, const Config& TileConfig) const;
+
+  osmscout::GeoCoord GetTileCenter(const TileKey& Key, const Config& TileConfig) const;
+
+  // Must be called with Mutex locked.
+  void Enqueue(const TileKey& Key, TileCallback OnTile, bool Prefetch);
+
+  void PrefetchNeighbours(const TileKey& Key);
+
+  void WorkerLoop();
+
+  const RenderFunction Render;
+
+  mutable std::mutex Mutex;
+  std::condition_variable Condition;
+  bool Stop = false;
+  std::shared_ptr<const Config> CurrentConfig;
+  std::deque<TileKey> InteractiveQueue;
+  std::deque<TileKey> PrefetchQueue;
+  std::unordered_map<TileKey, PendingTile, TileKeyHash> Pending;
+
+  TileCache Cache;
+
+  std::vector<std::thread> Workers;
+};
+
+#endif
@@ -72,6 +72,20 @@ osmscout::GeoCoord MapDrawer::GetTopRightCoord()
     return osmscout::GeoCoord(0,0);
 }
 
+double MapDrawer::GetLonSpan(double ZoomValue, int ImgSize)
+{
+  osmscout::Magnification Zoom;
+  Zoom.SetMagnification(ZoomValue);
+  osmscout::MercatorProjection SpanProjection;
+  SpanProjection.Set(osmscout::GeoCoord(0,0), Zoom, 96.0f, ImgSize, ImgSize);
+
+  osmscout::GeoCoord Left;
+  osmscout::GeoCoord Right;
+  if(!SpanProjection.PixelToGeo(0, 0, Left) || !SpanProjection.PixelToGeo(ImgSize, 0, Right))
+    return 0.0;
+  return Right.GetLon() - Left.GetLon();
+}
+
 void MapDrawer::LoadDatabaseData()
 {
   // Load Database
@@ -12,7 +12,7 @@
 
 using namespace lunasvg;
 
-void MapRasterizer::RasterizeSVG(std::uint8_t* OutMap, std::string SvgString, int Size)
+void MapRasterizer::RasterizeSVG(std::uint8_t* OutMap, const std::string& SvgString, int Size)
 {
     auto SvgDocument = Document::loadFromData(SvgString);
 
@@ -22,17 +22,12 @@ void MapRasterizer::RasterizeSVG(std::uint8_t* OutMap, std::string SvgString, in
         return;
     }
 
-    Bitmap RasterizedBitmap = SvgDocument->renderToBitmap(Size, Size, BackgroundColor);
-    if(!RasterizedBitmap.valid())
-    {
-        std::cerr << LOG_PRFX << "ERROR: No valid Bitmap" << std::endl;
-        return;
-    }
-    else
-    {
-        std::cout << LOG_PRFX << "Bitmap VALID" << std::endl; 
-    }
-
-    RasterizedBitmap.convertToRGBA();
-    std::memcpy(OutMap, RasterizedBitmap.data(), Size*Size*4*sizeof(uint8_t));
+    // Transparent background, rendered in place instead of into a temporary
+    // bitmap that would then be copied.
+    std::memset(OutMap, 0, Size*Size*4*sizeof(uint8_t));
+    Bitmap OutBitmap(OutMap, Size, Size, Size*4);
+    const double ScaleX = SvgDocument->width() > 0 ? Size / SvgDocument->width() : 1.0;
+    const double ScaleY = SvgDocument->height() > 0 ? Size / SvgDocument->height() : 1.0;
+    SvgDocument->render(OutBitmap, Matrix(ScaleX, 0, 0, ScaleY, 0, 0));
+    OutBitmap.convertToRGBA();
 }
\ No newline at end of file
@@ -1,25 +1,24 @@
 #include "OsmRenderer.h"
 
 #include "OsmRendererMacros.h"
-#include "MapDrawer.h"
+#include "RendererSession.h"
 
-#include <stdexcept>
+#include <algorithm>
 #include <iostream>
-#include <string.h>
-#include <chrono>
-#include <stdlib.h> 
+#include <thread>
 
 #define PORT 5000
-#define BUFFER_SIZE 1024
+#define MAX_CACHED_TILES 256
+#define MAX_RENDER_WORKERS 8
 
 using namespace std;
 
 namespace Asio = boost::asio;
-using AsioStreamBuf = boost::asio::streambuf;
 using AsioTCP = boost::asio::ip::tcp;
 using AsioSocket = boost::asio::ip::tcp::socket;
 using AsioAcceptor = boost::asio::ip::tcp::acceptor;
 using AsioEndpoint = boost::asio::ip::tcp::endpoint;
+using AsioErrorCode = boost::system::error_code;
 
 
 string OsmRenderer::GetOsmRendererString() const
@@ -30,123 +29,50 @@ string OsmRenderer::GetOsmRendererString() const
 void OsmRenderer::InitRenderer() 
 {
   SocketAcceptorPtr = make_unique<AsioAcceptor>(io_service, AsioEndpoint(AsioTCP::v4(), PORT));
-  SocketPtr = make_unique<AsioSocket>(io_service);
+
+  // One thread is left for the sockets.
+  const size_t NumWorkers =
+      std::min<size_t>(std::max<size_t>(std::thread::hardware_concurrency(), 2), MAX_RENDER_WORKERS + 1) - 1;
+  Renderer = make_unique<TileRenderer>(NumWorkers, MAX_CACHED_TILES);
+  std::cout << LOG_PRFX << "Rendering with " << NumWorkers << " workers" << std::endl;
 }
 
 void OsmRenderer::StartLoop()
 {
   std::cout << "┌ Waiting Command..." << std::endl;
-  SocketAcceptorPtr->accept(*SocketPtr);
-  if(!SocketPtr->is_open())
-  {
-    throw runtime_error("Connection not accepted. Socket is not opened.");
-  }
-  while(true)
-  {
-    AsioStreamBuf Buffer;
-    Asio::read(*SocketPtr, Buffer, Asio::transfer_at_least(2));
-
-    string BufferStr = Asio::buffer_cast<const char*>(Buffer.data());
-
-    std::cout << LOG_PRFX << "Received message: " << BufferStr << std::endl;
-
-    RunCmd(BufferStr);
-  }
-}
-
-void OsmRenderer::ShutDown()
-{
-  // TODO Shutdown socket and clear pointers
+  AcceptClient();
+  io_service.run();
 }
 
-void OsmRenderer::RunCmd(string Cmd)
+void OsmRenderer::AcceptClient()
 {
-  string CmdStr = Cmd;
-  vector<string> CmdVector = SplitCmd(CmdStr, " ");
-  
-  string CmdType = CmdVector[CMD_INDEX];
-
-  if(CmdType == "-R")     // Render Command
-  {
-    std::unique_ptr<std::uint8_t> RenderedMap = std::unique_ptr<std::uint8_t>(new uint8_t[Drawer->GetImgSizeSqr() * 4]);
-    RenderMapCmd(CmdVector, RenderedMap.get());
-
-    std::cout << LOG_PRFX << "Sending image data: " << (Drawer->GetImgSizeSqr() * 4 * sizeof(uint8_t)) << " bytes" << std::endl;
-    Asio::write(*SocketPtr, Asio::buffer(RenderedMap.get(), (Drawer->GetImgSizeSqr() * 4 * sizeof(uint8_t))));
-
-    // TODO: delete RenderedMap after is sent
-  }
-  else if(CmdType == "-C")// Configuration Command
+  SocketAcceptorPtr->async_accept([this](const AsioErrorCode& Error, AsioSocket Socket)
   {
-    ConfigMapCmd(CmdVector);
-  }
-  else if(CmdType == "-X")// Exit command
-  {
-    std::cout << "└ Bye!" << std::endl;
-    exit(EXIT_SUCCESS);
-  }
-  else if(CmdType == "-L")
-  {
-    SendLatLonCmd(CmdVector);
-  }
-}
-
-vector<string> OsmRenderer::SplitCmd (string s, string delimiter) {
-    size_t pos_start = 0, pos_end, delim_len = delimiter.length();
-    string token;
-    vector<string> res;
-
-    while ((pos_end = s.find (delimiter, pos_start)) != string::npos) {
-        token = s.substr (pos_start, pos_end - pos_start);
-        pos_start = pos_end + delim_len;
-        res.push_back (token);
+    if(Error)
+    {
+      if(Error != Asio::error::operation_aborted)
+      {
+        std::cerr << LOG_PRFX << "ERROR accepting client: " << Error.message() << std::endl;
+      }
+      return;
     }
-
-    res.push_back (s.substr (pos_start));
-    return res;
+    std::cout << LOG_PRFX << "Client connected" << std::endl;
+    std::make_shared<RendererSession>(std::move(Socket), *Renderer, [this]()
+    {
+      io_service.stop();
+    })->Start();
+    AcceptClient();
+  });
 }
 
-void OsmRenderer::RenderMapCmd(vector<string> CmdArgs, uint8_t* OutMap)
-{
-  std::cout << LOG_PRFX << "Rendering map at [" << stof(CmdArgs[R_CMD_LATITUDE]) << ", "
-    << stof(CmdArgs[R_CMD_LONGITUDE]) << "] with zoom: " << CmdArgs[R_CMD_ZOOM] << std::endl;
-
-  auto start = std::chrono::high_resolution_clock::now();
-  osmscout::GeoCoord Coord(stof(CmdArgs[R_CMD_LATITUDE]), stof(CmdArgs[R_CMD_LONGITUDE]));
-  Drawer->Draw(OutMap, Coord, stod(CmdArgs[R_CMD_ZOOM]));
-  auto stop = std::chrono::high_resolution_clock::now();
-
-  auto ElapsedTime = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start);
-  std::cout << LOG_PRFX << "Elapsed Rendering time: " << ElapsedTime.count() << "ms." << std::endl;
-}
-
-void OsmRenderer::ConfigMapCmd(vector<string> CmdArgs)
+void OsmRenderer::ShutDown()
 {
-  std::cout << LOG_PRFX << "Configuring Renderer:: DATABASE:" 
-       << CmdArgs[C_CMD_DATABASE_PATH] << " STYLESHEET: "
-       << CmdArgs[C_CMD_STYLESHEET_PATH] << " SIZE: " << CmdArgs[C_CMD_IMG_SIZE]<< std::endl;
-  Drawer = std::make_unique<MapDrawer>();
-  Drawer->PreLoad(CmdArgs);
-
-  if(!Drawer)
+  if(SocketAcceptorPtr)
   {
-    std::cout << LOG_PRFX << "--> ERROR creating Drawer"  << std::endl;
-    return;
+    AsioErrorCode Error;
+    SocketAcceptorPtr->close(Error);
+    SocketAcceptorPtr.reset();
   }
-}
-
-void OsmRenderer::SendLatLonCmd(vector<string> CmdArgs)
-{
-  osmscout::GeoCoord TopRightCoord = Drawer->GetTopRightCoord();
-  osmscout::GeoCoord BottomLeftCoord = Drawer->GetBottomLeftCoord();
-
-  std::cout << LOG_PRFX << "TOP: " << TopRightCoord.GetLat() << " -- " << TopRightCoord.GetLon() << std::endl;
-  std::cout << LOG_PRFX << "BOTTOM: " << BottomLeftCoord.GetLat() << " -- " << BottomLeftCoord.GetLon() << std::endl;
-
-  string CoordsStr = to_string(TopRightCoord.GetLat()) + "&" + to_string(TopRightCoord.GetLon()) + 
-      "&" + to_string(BottomLeftCoord.GetLat()) + "&" + to_string(BottomLeftCoord.GetLon()) + "&";
-
-  std::cout << LOG_PRFX << "Sending [" << CoordsStr << "] Size: " << CoordsStr.size() << std::endl;
-  
-  Asio::write(*SocketPtr, Asio::buffer(CoordsStr));
+  // Joins the workers, pending tiles are discarded.
+  Renderer.reset();
 }
@@ -0,0 +1,201 @@
+#include "RendererSession.h"
+
+#include "OsmRendererMacros.h"
+#include "TileRenderer.h"
+
+#include <iostream>
+#include <string>
+
+namespace Asio = boost::asio;
+using AsioSocket = boost::asio::ip::tcp::socket;
+using AsioErrorCode = boost::system::error_code;
+
+using namespace OsmRendererProtocol;
+
+RendererSession::RendererSession(
+    AsioSocket InSocket,
+    TileRenderer& InRenderer,
+    std::function<void()> InOnExit)
+  : Socket(std::move(InSocket)),
+    Renderer(InRenderer),
+    OnExit(std::move(InOnExit))
+{
+}
+
+void RendererSession::Start()
+{
+  ReadHeader();
+}
+
+void RendererSession::ReadHeader()
+{
+  auto Self = shared_from_this();
+  Asio::async_read(Socket, Asio::buffer(&RequestSize, sizeof(RequestSize)),
+      [this, Self](const AsioErrorCode& Error, std::size_t)
+  {
+    if(Error)
+    {
+      // Client disconnected.
+      return;
+    }
+    if(RequestSize == 0 || RequestSize > MAX_REQUEST_SIZE)
+    {
+      std::cerr << LOG_PRFX << "ERROR: Invalid request size " << RequestSize << std::endl;
+      return;
+    }
+    ReadPayload();
+  });
+}
+
+void RendererSession::ReadPayload()
+{
+  Request.resize(RequestSize);
+  auto Self = shared_from_this();
+  Asio::async_read(Socket, Asio::buffer(Request),
+      [this, Self](const AsioErrorCode& Error, std::size_t)
+  {
+    if(!Error)
+    {
+      HandleRequest();
+    }
+  });
+}
+
+void RendererSession::HandleRequest()
+{
+  PayloadReader Reader(Request);
+  Command RequestCommand;
+  Reader.Read(RequestCommand);
+
+  switch(RequestCommand)
+  {
+    case Command::Config:
+      HandleConfig(Reader);
+      break;
+    case Command::Render:
+      HandleRender(Reader);
+      break;
+    case Command::LatLon:
+      HandleLatLon();
+      break;
+    case Command::Exit:
+      std::cout << "└ Bye!" << std::endl;
+      OnExit();
+      break;
+    default:
+      std::cerr << LOG_PRFX << "ERROR: Unknown command " << static_cast<int>(RequestCommand) << std::endl;
+      SendResponse(Status::Error, {});
+      break;
+  }
+}
+
+void RendererSession::HandleConfig(PayloadReader& Reader)
+{
+  std::uint32_t Size = 0;
+  std::string DataBasePath;
+  std::string StyleSheetPath;
+  if(!Reader.Read(Size) || !Reader.Read(DataBasePath) || !Reader.Read(StyleSheetPath) || Size == 0)
+  {
+    std::cerr << LOG_PRFX << "ERROR: Malformed configuration request" << std::endl;
+    SendResponse(Status::Error, {});
+    return;
+  }
+
+  std::cout << LOG_PRFX << "Configuring Renderer:: DATABASE:"
+       << DataBasePath << " STYLESHEET: "
+       << StyleSheetPath << " SIZE: " << Size << std::endl;
+  Renderer.Configure(DataBasePath, StyleSheetPath, static_cast<int>(Size));
+  SendResponse(Status::Ok, {});
+}
+
+void RendererSession::HandleRender(PayloadReader& Reader)
+{
+  double Lat = 0.0;
+  double Lon = 0.0;
+  double Zoom = 0.0;
+  if(!Reader.Read(Lat) || !Reader.Read(Lon) || !Reader.Read(Zoom))
+  {
+    std::cerr << LOG_PRFX << "ERROR: Malformed render request" << std::endl;
+    SendResponse(Status::Error, {});
+    return;
+  }
+
+  std::cout << LOG_PRFX << "Rendering map at [" << Lat << ", "
+    << Lon << "] with zoom: " << Zoom << std::endl;
+
+  auto Self = shared_from_this();
+  const auto RequestTime = std::chrono::steady_clock::now();
+  Renderer.RequestTile(Lat, Lon, Zoom, [this, Self, RequestTime](TileRef RenderedTile)
+  {
+    // May be called from a worker thread, the socket is only used from the
+    // io_service.
+    Asio::post(Socket.get_executor(), [this, Self, RenderedTile, RequestTime]()
+    {
+      SendTile(RenderedTile, RequestTime);
+    });
+  });
+}
+
+void RendererSession::SendTile(TileRef RenderedTile, std::chrono::steady_clock::time_point RequestTime)
+{
+  if(!RenderedTile)
+  {
+    std::cerr << LOG_PRFX << "ERROR: Tile could not be rendered" << std::endl;
+    SendResponse(Status::Error, {});
+    return;
+  }
+
+  auto ElapsedTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - RequestTime);
+  const TileCache& Cache = Renderer.GetCache();
+  std::cout << LOG_PRFX << "Tile ready in " << ElapsedTime.count() << "ms. Cache hits: "
+    << Cache.GetHits() << " misses: " << Cache.GetMisses() << std::endl;
+
+  LastCorners = RenderedTile->Corners;
+
+  std::vector<std::uint8_t> Body;
+  Write(Body, RenderedTile->Corners);
+  Write(Body, RenderedTile->Size);
+  ResponseTile = std::move(RenderedTile);
+  SendResponse(Status::Ok, Body);
+}
+
+void RendererSession::HandleLatLon()
+{
+  std::cout << LOG_PRFX << "TOP: " << LastCorners.TopRightLat << " -- " << LastCorners.TopRightLon << std::endl;
+  std::cout << LOG_PRFX << "BOTTOM: " << LastCorners.BottomLeftLat << " -- " << LastCorners.BottomLeftLon << std::endl;
+
+  std::vector<std::uint8_t> Body;
+  Write(Body, LastCorners);
+  SendResponse(Status::Ok, Body);
+}
+
+void RendererSession::SendResponse(Status ResponseStatus, const std::vector<std::uint8_t>& Body)
+{
+  const std::size_t PixelsSize = ResponseTile ? ResponseTile->Pixels.size() : 0u;
+  const auto PayloadSize = static_cast<std::uint32_t>(sizeof(Status) + Body.size() + PixelsSize);
+
+  ResponseHeader.clear();
+  Write(ResponseHeader, PayloadSize);
+  Write(ResponseHeader, ResponseStatus);
+  ResponseHeader.insert(ResponseHeader.end(), Body.begin(), Body.end());
+
+  // The pixels are sent straight from the cached tile.
+  std::vector<Asio::const_buffer> Buffers;
+  Buffers.emplace_back(Asio::buffer(ResponseHeader));
+  if(ResponseTile)
+  {
+    Buffers.emplace_back(Asio::buffer(ResponseTile->Pixels));
+  }
+
+  auto Self = shared_from_this();
+  Asio::async_write(Socket, Buffers,
+      [this, Self](const AsioErrorCode& Error, std::size_t)
+  {
+    ResponseTile.reset();
+    if(!Error)
+    {
+      ReadHeader();
+    }
+  });
+}
@@ -0,0 +1,66 @@
+#include "TileCache.h"
+
+#include <algorithm>
+
+TileCache::TileCache(std::size_t InMaxTiles)
+  : MaxTiles(std::max<std::size_t>(InMaxTiles, 1))
+{
+}
+
+TileRef TileCache::Find(const TileKey& Key)
+{
+  std::lock_guard<std::mutex> Lock(Mutex);
+  auto It = Index.find(Key);
+  if(It == Index.end())
+  {
+    ++Misses;
+    return nullptr;
+  }
+  ++Hits;
+  Entries.splice(Entries.begin(), Entries, It->second);
+  return It->second->second;
+}
+
+bool TileCache::Contains(const TileKey& Key) const
+{
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return Index.count(Key) > 0;
+}
+
+void TileCache::Insert(const TileKey& Key, TileRef NewTile)
+{
+  std::lock_guard<std::mutex> Lock(Mutex);
+  auto It = Index.find(Key);
+  if(It != Index.end())
+  {
+    It->second->second = std::move(NewTile);
+    Entries.splice(Entries.begin(), Entries, It->second);
+    return;
+  }
+  Entries.emplace_front(Key, std::move(NewTile));
+  Index.emplace(Key, Entries.begin());
+  while(Entries.size() > MaxTiles)
+  {
+    Index.erase(Entries.back().first);
+    Entries.pop_back();
+  }
+}
+
+void TileCache::Clear()
+{
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Entries.clear();
+  Index.clear();
+}
+
+std::uint64_t TileCache::GetHits() const
+{
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return Hits;
+}
+
+std::uint64_t TileCache::GetMisses() const
+{
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return Misses;
+}
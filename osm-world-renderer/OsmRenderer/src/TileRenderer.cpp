@@ -0,0 +1,288 @@
+#include "TileRenderer.h"
+
+#include "MapDrawer.h"
+#include "OsmRendererMacros.h"
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <iostream>
+
+// Prefetches not started yet when this many are queued are dropped, the
+// client has panned somewhere else.
+#define MAX_PREFETCH_QUEUE 32
+
+TileRenderer::TileRenderer(std::size_t NumWorkers, std::size_t MaxCachedTiles)
+  : TileRenderer(NumWorkers, MaxCachedTiles, nullptr)
+{
+}
+
+TileRenderer::TileRenderer(std::size_t NumWorkers, std::size_t MaxCachedTiles, RenderFunction InRender)
+  : Render(std::move(InRender)),
+    Cache(MaxCachedTiles)
+{
+  NumWorkers = std::max<std::size_t>(NumWorkers, 1);
+  for(std::size_t i = 0; i < NumWorkers; ++i)
+  {
+    Workers.emplace_back([this]() { WorkerLoop(); });
+  }
+}
+
+TileRenderer::~TileRenderer()
+{
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Stop = true;
+  }
+  Condition.notify_all();
+  for(std::thread& Worker : Workers)
+  {
+    Worker.join();
+  }
+}
+
+void TileRenderer::Configure(const std::string& DataBasePath, const std::string& StyleSheetPath, int Size)
+{
+  auto NewConfig = std::make_shared<Config>();
+  NewConfig->DataBasePath = DataBasePath;
+  NewConfig->StyleSheetPath = StyleSheetPath;
+  NewConfig->Size = Size;
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    NewConfig->Generation = CurrentConfig ? CurrentConfig->Generation + 1 : 1;
+    CurrentConfig = NewConfig;
+    // The prefetches not started are of the previous configuration and
+    // nobody waits for them, drop them with their pending entries.
+    for(const TileKey& Key : PrefetchQueue)
+    {
+      auto It = Pending.find(Key);
+      if(It != Pending.end() && !It->second.Interactive && !It->second.Rendering)
+      {
+        Pending.erase(It);
+      }
+    }
+    PrefetchQueue.clear();
+  }
+  Cache.Clear();
+}
+
+bool TileRenderer::IsConfigured() const
+{
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return CurrentConfig != nullptr;
+}
+
+std::size_t TileRenderer::GetNumberOfPendingTiles() const
+{
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return Pending.size();
+}
+
+void TileRenderer::RequestTile(double Lat, double Lon, double ZoomValue, TileCallback OnTile)
+{
+  std::shared_ptr<const Config> TileConfig;
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    TileConfig = CurrentConfig;
+  }
+  if(!TileConfig)
+  {
+    OnTile(nullptr);
+    return;
+  }
+
+  const TileKey Key = MakeKey(Lat, Lon, ZoomValue, *TileConfig);
+  TileRef CachedTile = Cache.Find(Key);
+  if(CachedTile)
+  {
+    OnTile(std::move(CachedTile));
+  }
+  else
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Enqueue(Key, std::move(OnTile), false);
+  }
+  PrefetchNeighbours(Key);
+}
+
+double TileRenderer::GetGridStep(double ZoomValue, int Size)
+{
+  return MapDrawer::GetLonSpan(ZoomValue, Size) / GRID_CELLS_PER_TILE;
+}
+
+TileKey TileRenderer::MakeKey(double Lat, double Lon, double ZoomValue, const Config& TileConfig) const
+{
+  TileKey Key;
+  Key.Zoom = std::llround(ZoomValue * 1000.0);
+  Key.Generation = TileConfig.Generation;
+  const double Step = GetGridStep(Key.Zoom / 1000.0, TileConfig.Size);
+  if(Step <= 0.0)
+  {
+    return Key;
+  }
+  // Mercator y in degrees, so both axes have the same scale.
+  const double LatRadians = Lat * M_PI / 180.0;
+  const double MercatorY = std::log(std::tan(M_PI / 4.0 + LatRadians / 2.0)) * 180.0 / M_PI;
+  Key.X = std::llround(Lon / Step);
+  Key.Y = std::llround(MercatorY / Step);
+  return Key;
+}
+
+osmscout::GeoCoord TileRenderer::GetTileCenter(const TileKey& Key, const Config& TileConfig) const
+{
+  const double Step = GetGridStep(Key.Zoom / 1000.0, TileConfig.Size);
+  const double MercatorY = Key.Y * Step * M_PI / 180.0;
+  const double Lat = std::atan(std::sinh(MercatorY)) * 180.0 / M_PI;
+  return osmscout::GeoCoord(Lat, Key.X * Step);
+}
+
+void TileRenderer::Enqueue(const TileKey& Key, TileCallback OnTile, bool Prefetch)
+{
+  auto It = Pending.find(Key);
+  const bool AlreadyQueued = It != Pending.end();
+  PendingTile& Entry = AlreadyQueued ? It->second : Pending[Key];
+  if(OnTile)
+  {
+    Entry.Callbacks.emplace_back(std::move(OnTile));
+  }
+  if(Prefetch)
+  {
+    if(AlreadyQueued)
+    {
+      return;
+    }
+    PrefetchQueue.push_back(Key);
+    while(PrefetchQueue.size() > MAX_PREFETCH_QUEUE)
+    {
+      auto Dropped = Pending.find(PrefetchQueue.front());
+      if(Dropped != Pending.end() && !Dropped->second.Interactive && !Dropped->second.Rendering)
+      {
+        Pending.erase(Dropped);
+      }
+      PrefetchQueue.pop_front();
+    }
+  }
+  else
+  {
+    // A tile being prefetched is already on its way.
+    if(Entry.Interactive || Entry.Rendering)
+    {
+      return;
+    }
+    Entry.Interactive = true;
+    InteractiveQueue.push_back(Key);
+  }
+  Condition.notify_one();
+}
+
+void TileRenderer::PrefetchNeighbours(const TileKey& Key)
+{
+  for(int dY = -1; dY <= 1; ++dY)
+  {
+    for(int dX = -1; dX <= 1; ++dX)
+    {
+      TileKey Neighbour = Key;
+      Neighbour.X += dX;
+      Neighbour.Y += dY;
+      if((dX == 0 && dY == 0) || Cache.Contains(Neighbour))
+      {
+        continue;
+      }
+      std::lock_guard<std::mutex> Lock(Mutex);
+      Enqueue(Neighbour, nullptr, true);
+    }
+  }
+}
+
+void TileRenderer::WorkerLoop()
+{
+  std::unique_ptr<MapDrawer> Drawer;
+  std::uint64_t DrawerGeneration = 0;
+
+  while(true)
+  {
+    TileKey Key;
+    std::shared_ptr<const Config> TileConfig;
+    {
+      std::unique_lock<std::mutex> Lock(Mutex);
+      Condition.wait(Lock, [this]()
+      {
+        return Stop || !InteractiveQueue.empty() || !PrefetchQueue.empty();
+      });
+      if(Stop)
+      {
+        return;
+      }
+      std::deque<TileKey>& Queue = InteractiveQueue.empty() ? PrefetchQueue : InteractiveQueue;
+      Key = Queue.front();
+      Queue.pop_front();
+      auto It = Pending.find(Key);
+      if(It == Pending.end() || It->second.Rendering)
+      {
+        continue;
+      }
+      It->second.Rendering = true;
+      TileConfig = CurrentConfig;
+    }
+
+    TileRef NewTile;
+    if(TileConfig && TileConfig->Generation == Key.Generation)
+    {
+      try
+      {
+        if(Render)
+        {
+          NewTile = Render(Key, GetTileCenter(Key, *TileConfig));
+        }
+        else
+        {
+          if(!Drawer || DrawerGeneration != TileConfig->Generation)
+          {
+            std::vector<std::string> Args(C_CMD_IMG_SIZE + 1);
+            Args[C_CMD_DATABASE_PATH] = TileConfig->DataBasePath;
+            Args[C_CMD_STYLESHEET_PATH] = TileConfig->StyleSheetPath;
+            Args[C_CMD_IMG_SIZE] = std::to_string(TileConfig->Size);
+            Drawer = std::make_unique<MapDrawer>();
+            Drawer->PreLoad(Args);
+            DrawerGeneration = TileConfig->Generation;
+          }
+
+          auto RenderedTile = std::make_shared<Tile>();
+          RenderedTile->Size = static_cast<std::uint32_t>(TileConfig->Size);
+          RenderedTile->Pixels.resize(Drawer->GetImgSizeSqr() * 4);
+          Drawer->Draw(RenderedTile->Pixels.data(), GetTileCenter(Key, *TileConfig), Key.Zoom / 1000.0);
+
+          const osmscout::GeoCoord TopRight = Drawer->GetTopRightCoord();
+          const osmscout::GeoCoord BottomLeft = Drawer->GetBottomLeftCoord();
+          RenderedTile->Corners.TopRightLat = TopRight.GetLat();
+          RenderedTile->Corners.TopRightLon = TopRight.GetLon();
+          RenderedTile->Corners.BottomLeftLat = BottomLeft.GetLat();
+          RenderedTile->Corners.BottomLeftLon = BottomLeft.GetLon();
+
+          NewTile = std::move(RenderedTile);
+        }
+        if(NewTile)
+        {
+          Cache.Insert(Key, NewTile);
+        }
+      }
+      catch(const std::exception& e)
+      {
+        std::cerr << LOG_PRFX << "ERROR rendering tile: " << e.what() << std::endl;
+        Drawer.reset();
+      }
+    }
+
+    std::vector<TileCallback> Callbacks;
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      auto It = Pending.find(Key);
+      Callbacks = std::move(It->second.Callbacks);
+      Pending.erase(It);
+    }
+    for(TileCallback& Callback : Callbacks)
+    {
+      Callback(NewTile);
+    }
+  }
+}
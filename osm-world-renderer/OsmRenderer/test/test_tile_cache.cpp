@@ -0,0 +1,74 @@
+#include "TileCache.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+static TileKey MakeKey(std::int64_t X, std::uint64_t Generation = 1)
+{
+  TileKey Key;
+  Key.X = X;
+  Key.Zoom = 10000;
+  Key.Generation = Generation;
+  return Key;
+}
+
+TEST(tile_cache, evicts_least_recently_used)
+{
+  TileCache Cache(2);
+  const TileRef TileA = std::make_shared<Tile>();
+  const TileRef TileB = std::make_shared<Tile>();
+  const TileRef TileC = std::make_shared<Tile>();
+  Cache.Insert(MakeKey(0), TileA);
+  Cache.Insert(MakeKey(1), TileB);
+
+  // Finding A makes B the least recently used.
+  EXPECT_EQ(Cache.Find(MakeKey(0)), TileA);
+  Cache.Insert(MakeKey(2), TileC);
+  EXPECT_TRUE(Cache.Contains(MakeKey(0)));
+  EXPECT_FALSE(Cache.Contains(MakeKey(1)));
+  EXPECT_TRUE(Cache.Contains(MakeKey(2)));
+
+  // Checking for a tile does not count as a use, A is evicted now.
+  EXPECT_TRUE(Cache.Contains(MakeKey(0)));
+  Cache.Insert(MakeKey(3), TileB);
+  EXPECT_FALSE(Cache.Contains(MakeKey(0)));
+  EXPECT_EQ(Cache.Find(MakeKey(2)), TileC);
+  EXPECT_EQ(Cache.Find(MakeKey(3)), TileB);
+}
+
+TEST(tile_cache, replacing_a_tile_does_not_evict)
+{
+  TileCache Cache(2);
+  const TileRef NewTile = std::make_shared<Tile>();
+  Cache.Insert(MakeKey(0), std::make_shared<Tile>());
+  Cache.Insert(MakeKey(1), std::make_shared<Tile>());
+  Cache.Insert(MakeKey(0), NewTile);
+  EXPECT_EQ(Cache.Find(MakeKey(0)), NewTile);
+  EXPECT_TRUE(Cache.Contains(MakeKey(1)));
+}
+
+TEST(tile_cache, keeps_at_least_one_tile)
+{
+  TileCache Cache(0);
+  const TileRef NewTile = std::make_shared<Tile>();
+  Cache.Insert(MakeKey(0), std::make_shared<Tile>());
+  Cache.Insert(MakeKey(1), NewTile);
+  EXPECT_FALSE(Cache.Contains(MakeKey(0)));
+  EXPECT_EQ(Cache.Find(MakeKey(1)), NewTile);
+}
+
+TEST(tile_cache, counts_hits_and_misses)
+{
+  TileCache Cache(4);
+  Cache.Insert(MakeKey(0), std::make_shared<Tile>());
+  EXPECT_NE(Cache.Find(MakeKey(0)), nullptr);
+  EXPECT_EQ(Cache.Find(MakeKey(1)), nullptr);
+  // Tiles of another configuration are other tiles.
+  EXPECT_EQ(Cache.Find(MakeKey(0, 2)), nullptr);
+  EXPECT_EQ(Cache.GetHits(), 1u);
+  EXPECT_EQ(Cache.GetMisses(), 2u);
+
+  Cache.Clear();
+  EXPECT_FALSE(Cache.Contains(MakeKey(0)));
+}
@@ -0,0 +1,168 @@
+#include "TileRenderer.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#define TEST_TIMEOUT std::chrono::seconds(10)
+
+// Renders empty tiles, blocking until Release is called, and records the
+// tiles rendered.
+class BlockingRender
+{
+public:
+  TileRef operator()(const TileKey& Key, const osmscout::GeoCoord& /*Center*/)
+  {
+    std::unique_lock<std::mutex> Lock(Mutex);
+    Rendered.push_back(Key);
+    Condition.notify_all();
+    Condition.wait(Lock, [this]() { return Released; });
+    return std::make_shared<Tile>();
+  }
+
+  void Release()
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Released = true;
+    Condition.notify_all();
+  }
+
+  bool WaitForRendered(std::size_t Count)
+  {
+    std::unique_lock<std::mutex> Lock(Mutex);
+    return Condition.wait_for(Lock, TEST_TIMEOUT, [&]() { return Rendered.size() >= Count; });
+  }
+
+  std::vector<TileKey> GetRendered()
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    return Rendered;
+  }
+
+private:
+  std::mutex Mutex;
+  std::condition_variable Condition;
+  bool Released = false;
+  std::vector<TileKey> Rendered;
+};
+
+// Collects the tiles passed to the callbacks.
+class TileSink
+{
+public:
+  TileRenderer::TileCallback MakeCallback()
+  {
+    return [this](TileRef NewTile)
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      Tiles.push_back(std::move(NewTile));
+      Condition.notify_all();
+    };
+  }
+
+  bool WaitForTiles(std::size_t Count)
+  {
+    std::unique_lock<std::mutex> Lock(Mutex);
+    return Condition.wait_for(Lock, TEST_TIMEOUT, [&]() { return Tiles.size() >= Count; });
+  }
+
+  std::vector<TileRef> GetTiles()
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    return Tiles;
+  }
+
+private:
+  std::mutex Mutex;
+  std::condition_variable Condition;
+  std::vector<TileRef> Tiles;
+};
+
+static std::size_t CountRendered(const std::vector<TileKey>& Rendered, const TileKey& Key)
+{
+  std::size_t Count = 0;
+  for(const TileKey& RenderedKey : Rendered)
+  {
+    Count += RenderedKey == Key ? 1 : 0;
+  }
+  return Count;
+}
+
+TEST(tile_renderer, not_configured)
+{
+  TileRenderer Renderer(1, 16, [](const TileKey&, const osmscout::GeoCoord&) { return std::make_shared<Tile>(); });
+  TileSink Sink;
+  Renderer.RequestTile(0.0, 0.0, 10.0, Sink.MakeCallback());
+  ASSERT_TRUE(Sink.WaitForTiles(1));
+  EXPECT_EQ(Sink.GetTiles()[0], nullptr);
+}
+
+TEST(tile_renderer, coalesces_requests_of_the_same_tile)
+{
+  BlockingRender Render;
+  TileSink Sink;
+  {
+    TileRenderer Renderer(1, 64, std::ref(Render));
+    Renderer.Configure("database", "stylesheet", 256);
+
+    // The first request keeps the only worker busy, the next ones wait for
+    // the same tile instead of queueing it again.
+    Renderer.RequestTile(41.38, 2.17, 10.0, Sink.MakeCallback());
+    ASSERT_TRUE(Render.WaitForRendered(1));
+    Renderer.RequestTile(41.38, 2.17, 10.0, Sink.MakeCallback());
+    Renderer.RequestTile(41.38, 2.17, 10.0, Sink.MakeCallback());
+    Render.Release();
+    ASSERT_TRUE(Sink.WaitForTiles(3));
+
+    const std::vector<TileRef> Tiles = Sink.GetTiles();
+    ASSERT_NE(Tiles[0], nullptr);
+    EXPECT_EQ(Tiles[1], Tiles[0]);
+    EXPECT_EQ(Tiles[2], Tiles[0]);
+
+    // The tile and its eight prefetched neighbours are rendered once.
+    ASSERT_TRUE(Render.WaitForRendered(9));
+    const TileKey RequestedKey = Render.GetRendered()[0];
+    EXPECT_EQ(CountRendered(Render.GetRendered(), RequestedKey), 1u);
+
+    // The next request is served from the cache right away.
+    const std::uint64_t Hits = Renderer.GetCache().GetHits();
+    Renderer.RequestTile(41.38, 2.17, 10.0, Sink.MakeCallback());
+    EXPECT_EQ(Sink.GetTiles().size(), 4u);
+    EXPECT_EQ(Sink.GetTiles()[3], Tiles[0]);
+    EXPECT_EQ(Renderer.GetCache().GetHits(), Hits + 1);
+  }
+
+  // Joining the workers, nothing is rendered twice.
+  const std::vector<TileKey> Rendered = Render.GetRendered();
+  EXPECT_EQ(Rendered.size(), 9u);
+  for(const TileKey& Key : Rendered)
+  {
+    EXPECT_EQ(CountRendered(Rendered, Key), 1u);
+  }
+}
+
+TEST(tile_renderer, configure_drops_queued_prefetches)
+{
+  BlockingRender Render;
+  TileSink Sink;
+  TileRenderer Renderer(1, 64, std::ref(Render));
+  Renderer.Configure("database", "stylesheet", 256);
+
+  // The only worker renders the requested tile while its eight neighbours
+  // wait in the prefetch queue.
+  Renderer.RequestTile(41.38, 2.17, 10.0, Sink.MakeCallback());
+  ASSERT_TRUE(Render.WaitForRendered(1));
+  EXPECT_EQ(Renderer.GetNumberOfPendingTiles(), 9u);
+
+  // Only the tile being rendered is still pending.
+  Renderer.Configure("database", "stylesheet", 512);
+  EXPECT_EQ(Renderer.GetNumberOfPendingTiles(), 1u);
+
+  Render.Release();
+  ASSERT_TRUE(Sink.WaitForTiles(1));
+  EXPECT_EQ(Render.GetRendered().size(), 1u);
+}
@@ -1,4 +1,59 @@
 import socket
+import struct
+
+# Binary protocol of the renderer, see OsmRenderer/include/OsmRendererProtocol.h:
+# every message is a uint32 with the size of the payload followed by the payload.
+STATUS_OK = 0
+
+
+def send_request(client_socket, payload):
+    client_socket.sendall(struct.pack('=I', len(payload)) + payload)
+
+
+def recv_exact(client_socket, size):
+    data = bytearray()
+    while len(data) < size:
+        chunk = client_socket.recv(size - len(data))
+        if not chunk:
+            raise ConnectionError('Renderer closed the connection')
+        data += chunk
+    return bytes(data)
+
+
+def recv_response(client_socket):
+    size, = struct.unpack('=I', recv_exact(client_socket, 4))
+    payload = recv_exact(client_socket, size)
+    return payload[0], payload[1:]
+
+
+def encode_string(value):
+    data = value.encode()
+    return struct.pack('=I', len(data)) + data
+
+
+def config(client_socket, database, stylesheet, size):
+    send_request(client_socket, b'C' + struct.pack('=I', size) + encode_string(database) + encode_string(stylesheet))
+    status, _ = recv_response(client_socket)
+    return status == STATUS_OK
+
+
+def render(client_socket, lat, lon, zoom):
+    send_request(client_socket, b'R' + struct.pack('=ddd', lat, lon, zoom))
+    status, body = recv_response(client_socket)
+    if status != STATUS_OK:
+        return None, None
+    corners = struct.unpack_from('=dddd', body)
+    size, = struct.unpack_from('=I', body, 32)
+    pixels = body[36:]
+    assert len(pixels) == size * size * 4
+    return corners, pixels
+
+
+def lat_lon(client_socket):
+    send_request(client_socket, b'L')
+    status, body = recv_response(client_socket)
+    return struct.unpack_from('=dddd', body) if status == STATUS_OK else None
+
 
 def client_program():
     host = socket.gethostname()  # as both code is running on same pc
@@ -7,13 +62,26 @@ def client_program():
     client_socket = socket.socket()  # instantiate
     client_socket.connect((host, port))  # connect to the server
 
+    print('Commands: C <database> <stylesheet> <size> | R <lat> <lon> <zoom> | L | X | bye')
     message = input(" -> ")  # take input
 
     while message.lower().strip() != 'bye':
-        client_socket.send(message.encode())  # send message
-        data = client_socket.recv(1024).decode()  # receive response
-
-        print('Received from server: ' + data)  # show in terminal
+        args = message.split()
+        if not args:
+            pass
+        elif args[0] == 'C':
+            print('Configured' if config(client_socket, args[1], args[2], int(args[3])) else 'Error')
+        elif args[0] == 'R':
+            corners, pixels = render(client_socket, float(args[1]), float(args[2]), float(args[3]))
+            if pixels is None:
+                print('Error')
+            else:
+                print('Received %d bytes, corners %s' % (len(pixels), corners))
+        elif args[0] == 'L':
+            print('Corners %s' % (lat_lon(client_socket),))
+        elif args[0] == 'X':
+            send_request(client_socket, b'X')
+            break
 
         message = input(" -> ")  # again take input
 
@@ -21,4 +89,4 @@ def client_program():
 
 
 if __name__ == '__main__':
-    client_program()
\ No newline at end of file
+    client_program()